@@ -28,7 +28,15 @@ namespace binding_factory_library {
 
 /*!
  * A binding factory that produces bindings between ControlIt! parameters
- * and shared memory.
+ * and shared memory.  It handles bindings whose transport type is "SM" and
+ * whose transport data type is "float64".  Each binding is backed by a
+ * SharedMemoryChannel named by the binding's "channel" property.  The
+ * channel has the dimensions of the parameter's current value unless the
+ * "rows" and "cols" properties are specified.
+ *
+ * Real, integer, vector, and matrix parameters are supported.  Input
+ * bindings are polled once per servo cycle and output bindings copy the
+ * parameter into shared memory every time it is set.
  */
 class BindingFactorySM : public controlit::BindingFactory
 {
@@ -88,6 +96,18 @@ protected:
      */
     Binding * createOutputBinding(ros::NodeHandle & nh,
         const controlit::BindingConfig & config, controlit::Parameter * param);
+
+    /*!
+     * Determines the dimensions of the shared memory channel of a binding.
+     *
+     * \param[in] config The binding configuration.
+     * \param[in] param The parameter being bound.
+     * \param[out] rows The number of rows in the channel.
+     * \param[out] cols The number of columns in the channel.
+     * \return Whether the binding can be created by this factory.
+     */
+    bool getChannelDimensions(const controlit::BindingConfig & config,
+        controlit::Parameter * param, size_t & rows, size_t & cols);
 };
 
 } // namespace binding_factory_library
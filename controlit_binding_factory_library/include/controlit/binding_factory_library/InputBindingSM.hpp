@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_BINDING_FACTORY_LIBRARY_INPUT_BINDING_SM_HPP__
+#define __CONTROLIT_BINDING_FACTORY_LIBRARY_INPUT_BINDING_SM_HPP__
+
+#include <memory>
+
+#include <controlit/Binding.hpp>
+#include <controlit/BindingConfig.hpp>
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <controlit/binding_factory_library/SharedMemoryChannel.hpp>
+
+namespace controlit {
+namespace binding_factory_library {
+
+using controlit::addons::eigen::Vector;
+using controlit::addons::eigen::Matrix;
+
+/*!
+ * An input binding between a ControlIt! parameter and a shared memory channel.
+ * The channel is polled by the servo thread once per servo cycle and the
+ * parameter is only set when a new value was written into the channel.
+ */
+class InputBindingSM : public controlit::Binding
+{
+public:
+    /*!
+     * The constructor.
+     *
+     * \param[in] param The parameter being bound.  It must be a real,
+     * integer, vector, or matrix parameter.
+     * \param[in] config The binding configuration.
+     * \param[in] rows The number of rows in the channel.
+     * \param[in] cols The number of columns in the channel.
+     * \throws std::invalid_argument if the channel cannot be opened.
+     */
+    InputBindingSM(controlit::Parameter * param, const controlit::BindingConfig & config,
+        size_t rows, size_t cols) :
+        Binding(param, config), // Call super-class' constructor
+        channel(new SharedMemoryChannel(config.getProperty("channel"), rows, cols))
+    {
+        // Allocate the receive buffer up front so polling never allocates memory.
+        if (param->isType(controlit::PARAMETER_TYPE_MATRIX))
+            matrixBuffer.setZero(rows, cols);
+        else
+            vectorBuffer.setZero(rows * cols);
+    }
+
+    /*!
+     * The destructor.
+     */
+    virtual ~InputBindingSM()
+    {
+    }
+
+    /*!
+     * Copies the latest value in the shared memory channel into the parameter
+     * if it changed since the last poll.
+     */
+    virtual void poll()
+    {
+        if (param->isType(controlit::PARAMETER_TYPE_MATRIX))
+        {
+            if (channel->readIfNew(matrixBuffer.data()))
+                param->set(matrixBuffer);
+        }
+        else if (channel->readIfNew(vectorBuffer.data()))
+        {
+            if (param->isType(controlit::PARAMETER_TYPE_VECTOR))
+                param->set(vectorBuffer);
+            else if (param->isType(controlit::PARAMETER_TYPE_INTEGER))
+                param->set(static_cast<int>(vectorBuffer(0)));
+            else
+                param->set(vectorBuffer(0));
+        }
+    }
+
+protected:
+    /*!
+     * The shared memory channel.
+     */
+    std::unique_ptr<SharedMemoryChannel> channel;
+
+    /*!
+     * The buffers into which values are read.  Scalars use the first
+     * element of vectorBuffer.
+     */
+    Vector vectorBuffer;
+    Matrix matrixBuffer;
+};
+
+} // namespace binding_factory_library
+} // namespace controlit
+
+#endif // __CONTROLIT_BINDING_FACTORY_LIBRARY_INPUT_BINDING_SM_HPP__
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_BINDING_FACTORY_LIBRARY_OUTPUT_BINDING_SM_HPP__
+#define __CONTROLIT_BINDING_FACTORY_LIBRARY_OUTPUT_BINDING_SM_HPP__
+
+#include <memory>
+
+#include <controlit/Binding.hpp>
+#include <controlit/BindingConfig.hpp>
+#include <controlit/logging/RealTimeLogging.hpp>
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <controlit/binding_factory_library/SharedMemoryChannel.hpp>
+
+namespace controlit {
+namespace binding_factory_library {
+
+using controlit::addons::eigen::Vector;
+using controlit::addons::eigen::Matrix;
+
+/*!
+ * An output binding between a ControlIt! parameter and a shared memory channel.
+ * Every time the parameter is set, its value is copied into the channel.
+ */
+class OutputBindingSM : public controlit::Binding
+{
+public:
+    /*!
+     * The constructor.
+     *
+     * \param[in] param The parameter being bound.  It must be a real,
+     * integer, vector, or matrix parameter.
+     * \param[in] config The binding configuration.
+     * \param[in] rows The number of rows in the channel.
+     * \param[in] cols The number of columns in the channel.
+     * \throws std::invalid_argument if the channel cannot be opened.
+     */
+    OutputBindingSM(controlit::Parameter * param, const controlit::BindingConfig & config,
+        size_t rows, size_t cols) :
+        Binding(param, config), // Call super-class' constructor
+        channel(new SharedMemoryChannel(config.getProperty("channel"), rows, cols))
+    {
+        connection = param->addListener(boost::bind(&OutputBindingSM::parameterCallback, this, _1));
+    }
+
+    /*!
+     * The destructor.
+     */
+    virtual ~OutputBindingSM()
+    {
+        connection.disconnect();
+    }
+
+    /*!
+     * Called when the parameter changes.
+     *
+     * \param[in] param The parameter that changed.
+     */
+    virtual void parameterCallback(controlit::Parameter const & param)
+    {
+        if (param.isType(controlit::PARAMETER_TYPE_REAL))
+        {
+            channel->write(controlit::ParameterAccessor<double>::get(&param));
+        }
+        else if (param.isType(controlit::PARAMETER_TYPE_INTEGER))
+        {
+            double value = *controlit::ParameterAccessor<int>::get(&param);
+            channel->write(&value);
+        }
+        else if (param.isType(controlit::PARAMETER_TYPE_VECTOR))
+        {
+            const Vector & value = *controlit::ParameterAccessor<Vector>::get(&param);
+            if (checkSize(value.size(), 1, param))
+                channel->write(value.data());
+        }
+        else if (param.isType(controlit::PARAMETER_TYPE_MATRIX))
+        {
+            const Matrix & value = *controlit::ParameterAccessor<Matrix>::get(&param);
+            if (checkSize(value.rows(), value.cols(), param))
+                channel->write(value.data());
+        }
+    }
+
+protected:
+    /*!
+     * Checks whether a value fits in the channel.
+     *
+     * \return Whether the value has the same number of elements as the channel.
+     */
+    bool checkSize(size_t rows, size_t cols, controlit::Parameter const & param)
+    {
+        if (rows * cols != channel->getSize())
+        {
+            CONTROLIT_ERROR_RT << "Not writing parameter " << param.name() << " to shared memory channel "
+                << channel->getName() << ": the parameter is " << rows << "x" << cols
+                << " but the channel is " << channel->getRows() << "x" << channel->getCols();
+            return false;
+        }
+        return true;
+    }
+
+    /*!
+     * The shared memory channel.
+     */
+    std::unique_ptr<SharedMemoryChannel> channel;
+
+    /*!
+     * The connection to the parameter's update signal.
+     */
+    controlit::Parameter::Connection_t connection;
+};
+
+} // namespace binding_factory_library
+} // namespace controlit
+
+#endif // __CONTROLIT_BINDING_FACTORY_LIBRARY_OUTPUT_BINDING_SM_HPP__
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_BINDING_FACTORY_LIBRARY_SHARED_MEMORY_CHANNEL_HPP__
+#define __CONTROLIT_BINDING_FACTORY_LIBRARY_SHARED_MEMORY_CHANNEL_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace controlit {
+namespace binding_factory_library {
+
+/*!
+ * A fixed-size array of doubles in POSIX shared memory that is protected
+ * by a sequence lock.  Channels are registered by name: every process that
+ * opens a channel with the same name and dimensions shares the same memory.
+ *
+ * The channel holds only the latest value.  There must be at most one writer
+ * per channel, but there may be any number of readers.  Neither reading nor
+ * writing blocks, allocates memory, or makes system calls, so both may be
+ * done by a real-time thread.  A reader that overlaps with a write detects
+ * it and retries, so a reader never sees a partially written value.
+ *
+ * Matrices are stored in column-major order, which is Eigen's default.
+ */
+class SharedMemoryChannel
+{
+public:
+    /*!
+     * Opens the channel, creating it if it does not exist.
+     *
+     * \param[in] name The name of the channel.  The shared memory object is
+     * named "/controlit_" followed by this name.
+     * \param[in] rows The number of rows in the value.
+     * \param[in] cols The number of columns in the value.
+     * \throws std::invalid_argument if the name is invalid or an existing
+     * channel with this name has different dimensions.
+     * \throws std::runtime_error if the shared memory cannot be mapped.
+     */
+    SharedMemoryChannel(const std::string & name, size_t rows, size_t cols);
+
+    /*!
+     * The destructor.  This unmaps the shared memory but does not remove
+     * the channel, so other processes can continue to use it.
+     */
+    ~SharedMemoryChannel();
+
+    /*!
+     * Writes a new value into the channel.
+     *
+     * \param[in] data The value.  It must contain getSize() doubles.
+     */
+    void write(const double * data);
+
+    /*!
+     * Reads the value in the channel if it changed since the last successful
+     * call to this method.
+     *
+     * \param[out] data Where the value should be stored.  It must have
+     * space for getSize() doubles.
+     * \return Whether a new value was stored in data.  This is false if
+     * nothing was written since the last read, or if the writer was busy
+     * writing for the duration of every retry.
+     */
+    bool readIfNew(double * data);
+
+    /*!
+     * Removes a channel so that the next process to open it creates a new one.
+     * Processes that already opened the channel are not affected.
+     *
+     * \param[in] name The name of the channel.
+     * \return Whether the channel was removed.
+     */
+    static bool remove(const std::string & name);
+
+    /*!
+     * \return The name of the channel.
+     */
+    const std::string & getName() const { return name; }
+
+    /*!
+     * \return The number of rows in the value.
+     */
+    size_t getRows() const { return rows; }
+
+    /*!
+     * \return The number of columns in the value.
+     */
+    size_t getCols() const { return cols; }
+
+    /*!
+     * \return The number of doubles in the value.
+     */
+    size_t getSize() const { return rows * cols; }
+
+private:
+    /*!
+     * The layout of the start of the shared memory object.  The value
+     * follows immediately after it.
+     */
+    struct Header
+    {
+        /*!
+         * Set to CHANNEL_MAGIC once the creator has finished initializing
+         * the header.
+         */
+        std::atomic<uint32_t> magic;
+
+        /*!
+         * The dimensions of the value.
+         */
+        uint32_t rows;
+        uint32_t cols;
+
+        /*!
+         * The sequence lock.  It is odd while a write is in progress and is
+         * incremented twice by every write.
+         */
+        std::atomic<uint64_t> sequence;
+    };
+
+    /*!
+     * The size of the header, padded so that the value starts on its own
+     * cache line.
+     */
+    static const size_t HEADER_SIZE = 64;
+
+    /*!
+     * The number of times a read retries if it overlaps with a write.
+     */
+    static const int MAX_READ_ATTEMPTS = 4;
+
+    /*!
+     * \return The name of the POSIX shared memory object of a channel.
+     */
+    static std::string getSharedMemoryName(const std::string & name);
+
+    std::string name;
+    size_t rows;
+    size_t cols;
+
+    /*!
+     * The mapped shared memory.
+     */
+    void * memory;
+    size_t memorySize;
+
+    Header * header;
+    double * value;
+
+    /*!
+     * The sequence number of the last value read by this process.
+     */
+    uint64_t lastReadSequence;
+};
+
+} // namespace binding_factory_library
+} // namespace controlit
+
+#endif // __CONTROLIT_BINDING_FACTORY_LIBRARY_SHARED_MEMORY_CHANNEL_HPP__
@@ -19,8 +19,12 @@
  */
 
 #include <controlit/binding_factory_library/BindingFactorySM.hpp>
+#include <controlit/binding_factory_library/InputBindingSM.hpp>
+#include <controlit/binding_factory_library/OutputBindingSM.hpp>
 #include <controlit/logging/RealTimeLogging.hpp>
 
+#include <stdexcept>
+
 namespace controlit {
 namespace binding_factory_library {
 
@@ -63,18 +67,99 @@ Binding * BindingFactorySM::createBinding(ros::NodeHandle & nh, const BindingCon
     return nullptr;
 }
 
+bool BindingFactorySM::getChannelDimensions(const controlit::BindingConfig & config,
+    controlit::Parameter * param, size_t & rows, size_t & cols)
+{
+    if (config.getTransportDataType() != "float64")
+    {
+        CONTROLIT_WARN << "Shared memory bindings only support transport data type \"float64\"!\n"
+            << "  - " << config.toString("     ");
+        return false;
+    }
+
+    if (!config.hasProperty("channel"))
+    {
+        CONTROLIT_WARN << "Shared memory binding does not specify a channel name!\n"
+            << "  - " << config.toString("     ");
+        return false;
+    }
+
+    // By default the channel has the dimensions of the parameter's current value.
+    if (param->isType(controlit::PARAMETER_TYPE_REAL) || param->isType(controlit::PARAMETER_TYPE_INTEGER))
+    {
+        rows = 1;
+        cols = 1;
+        return true;
+    }
+    else if (param->isType(controlit::PARAMETER_TYPE_VECTOR))
+    {
+        rows = controlit::ParameterAccessor<Vector>::get(param)->size();
+        cols = 1;
+    }
+    else if (param->isType(controlit::PARAMETER_TYPE_MATRIX))
+    {
+        rows = controlit::ParameterAccessor<Matrix>::get(param)->rows();
+        cols = controlit::ParameterAccessor<Matrix>::get(param)->cols();
+    }
+    else
+    {
+        CONTROLIT_WARN << "Shared memory bindings do not support parameters of type "
+            << controlit::Parameter::parameterTypeToString(param->type()) << "!\n"
+            << "  - " << config.toString("     ");
+        return false;
+    }
+
+    if (config.hasProperty("rows"))
+        rows = config.getTypedProperty<size_t>("rows");
+
+    if (config.hasProperty("cols") && param->isType(controlit::PARAMETER_TYPE_MATRIX))
+        cols = config.getTypedProperty<size_t>("cols");
+
+    if (rows * cols == 0)
+    {
+        CONTROLIT_WARN << "Unable to determine the size of the shared memory channel for parameter "
+            << param->name() << ".  Specify the \"rows\" property, and \"cols\" for matrices!\n"
+            << "  - " << config.toString("     ");
+        return false;
+    }
+
+    return true;
+}
+
 Binding * BindingFactorySM::createInputBinding(ros::NodeHandle & nh,
     const controlit::BindingConfig & config, controlit::Parameter * param)
 {
-    // TODO
-    return nullptr;
+    size_t rows, cols;
+    if (!getChannelDimensions(config, param, rows, cols))
+        return nullptr;
+
+    try
+    {
+        return new InputBindingSM(param, config, rows, cols);
+    }
+    catch (std::exception & e)
+    {
+        CONTROLIT_ERROR << "Unable to create shared memory input binding: " << e.what();
+        return nullptr;
+    }
 }
 
 Binding * BindingFactorySM::createOutputBinding(ros::NodeHandle & nh,
     const controlit::BindingConfig & config, controlit::Parameter * param)
 {
-    // TODO
-    return nullptr;
+    size_t rows, cols;
+    if (!getChannelDimensions(config, param, rows, cols))
+        return nullptr;
+
+    try
+    {
+        return new OutputBindingSM(param, config, rows, cols);
+    }
+    catch (std::exception & e)
+    {
+        CONTROLIT_ERROR << "Unable to create shared memory output binding: " << e.what();
+        return nullptr;
+    }
 }
 
 } // namespace binding_factory_library
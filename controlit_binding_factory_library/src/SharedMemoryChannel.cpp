@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/binding_factory_library/SharedMemoryChannel.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace controlit {
+namespace binding_factory_library {
+
+/*!
+ * Identifies an initialized channel.  The last byte is the layout version.
+ */
+#define CHANNEL_MAGIC 0x43495401
+
+/*!
+ * How long to wait for another process to finish creating a channel.
+ */
+#define CHANNEL_CREATION_TIMEOUT_US 1000000
+#define CHANNEL_CREATION_POLL_US 1000
+
+SharedMemoryChannel::SharedMemoryChannel(const std::string & name, size_t rows, size_t cols) :
+    name(name),
+    rows(rows),
+    cols(cols),
+    memory(nullptr),
+    memorySize(HEADER_SIZE + rows * cols * sizeof(double)),
+    header(nullptr),
+    value(nullptr),
+    lastReadSequence(0)
+{
+    static_assert(sizeof(Header) <= HEADER_SIZE, "SharedMemoryChannel header does not fit in HEADER_SIZE");
+
+    if (name.empty() || name.find('/') != std::string::npos)
+        throw std::invalid_argument("Invalid shared memory channel name \"" + name + "\"");
+
+    if (rows * cols == 0)
+        throw std::invalid_argument("Shared memory channel \"" + name + "\" must not be empty");
+
+    std::string shmName = getSharedMemoryName(name);
+
+    // Try to create the channel.  If it already exists, open it instead.
+    bool created = true;
+    int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+
+    if (fd == -1 && errno == EEXIST)
+    {
+        created = false;
+        fd = shm_open(shmName.c_str(), O_RDWR, 0666);
+    }
+
+    if (fd == -1)
+        throw std::runtime_error("Unable to open shared memory channel \"" + name + "\": " + std::strerror(errno));
+
+    if (created)
+    {
+        if (ftruncate(fd, memorySize) == -1)
+        {
+            std::string error = std::strerror(errno);
+            close(fd);
+            shm_unlink(shmName.c_str());
+            throw std::runtime_error("Unable to size shared memory channel \"" + name + "\": " + error);
+        }
+    }
+    else
+    {
+        // The creator may not have sized the channel yet.
+        struct stat status;
+        status.st_size = 0;
+        int waited = 0;
+        while (fstat(fd, &status) == 0 && status.st_size == 0 && waited < CHANNEL_CREATION_TIMEOUT_US)
+        {
+            usleep(CHANNEL_CREATION_POLL_US);
+            waited += CHANNEL_CREATION_POLL_US;
+        }
+
+        if (static_cast<size_t>(status.st_size) != memorySize)
+        {
+            close(fd);
+            std::stringstream ss;
+            ss << "Shared memory channel \"" << name << "\" has size " << status.st_size
+               << " bytes but a " << rows << "x" << cols << " channel requires " << memorySize
+               << " bytes.  Remove /dev/shm" << shmName << " if it is stale.";
+            throw std::invalid_argument(ss.str());
+        }
+    }
+
+    memory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        memory = nullptr;
+        throw std::runtime_error("Unable to map shared memory channel \"" + name + "\": " + std::strerror(errno));
+    }
+
+    header = static_cast<Header *>(memory);
+    value = reinterpret_cast<double *>(static_cast<char *>(memory) + HEADER_SIZE);
+
+    if (created)
+    {
+        new (header) Header;
+        header->rows = rows;
+        header->cols = cols;
+        header->sequence.store(0, std::memory_order_relaxed);
+        header->magic.store(CHANNEL_MAGIC, std::memory_order_release);
+    }
+    else
+    {
+        int waited = 0;
+        while (header->magic.load(std::memory_order_acquire) != CHANNEL_MAGIC && waited < CHANNEL_CREATION_TIMEOUT_US)
+        {
+            usleep(CHANNEL_CREATION_POLL_US);
+            waited += CHANNEL_CREATION_POLL_US;
+        }
+
+        if (header->magic.load(std::memory_order_acquire) != CHANNEL_MAGIC
+            || header->rows != rows || header->cols != cols)
+        {
+            std::stringstream ss;
+            ss << "Shared memory channel \"" << name << "\" is not a valid " << rows << "x" << cols
+               << " channel.  Remove /dev/shm" << shmName << " if it is stale.";
+            munmap(memory, memorySize);
+            memory = nullptr;
+            throw std::invalid_argument(ss.str());
+        }
+    }
+
+    if (!header->sequence.is_lock_free())
+    {
+        munmap(memory, memorySize);
+        memory = nullptr;
+        throw std::runtime_error("Shared memory channels require lock-free 64-bit atomics");
+    }
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+    if (memory != nullptr)
+        munmap(memory, memorySize);
+}
+
+void SharedMemoryChannel::write(const double * data)
+{
+    // Round up to an even number in case a previous writer died mid-write.
+    uint64_t sequence = (header->sequence.load(std::memory_order_relaxed) + 1) & ~static_cast<uint64_t>(1);
+
+    // Mark the value as being written before touching it.
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(value, data, getSize() * sizeof(double));
+
+    // Publish the new value.
+    header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool SharedMemoryChannel::readIfNew(double * data)
+{
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++)
+    {
+        uint64_t before = header->sequence.load(std::memory_order_acquire);
+
+        if (before == lastReadSequence)
+            return false;  // nothing new
+
+        if (before & 1)
+            continue;  // a write is in progress
+
+        std::memcpy(data, value, getSize() * sizeof(double));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = header->sequence.load(std::memory_order_relaxed);
+
+        if (before == after)
+        {
+            lastReadSequence = before;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SharedMemoryChannel::remove(const std::string & name)
+{
+    return shm_unlink(getSharedMemoryName(name).c_str()) == 0;
+}
+
+std::string SharedMemoryChannel::getSharedMemoryName(const std::string & name)
+{
+    return "/controlit_" + name;
+}
+
+} // namespace binding_factory_library
+} // namespace controlit
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <controlit/binding_factory_library/SharedMemoryChannel.hpp>
+
+namespace controlit {
+namespace binding_factory_library {
+
+TEST(SharedMemoryChannelTest, ReadsOnlyNewValues)
+{
+    SharedMemoryChannel::remove("test_reads_only_new_values");
+
+    SharedMemoryChannel writer("test_reads_only_new_values", 3, 1);
+    SharedMemoryChannel reader("test_reads_only_new_values", 3, 1);
+
+    double value[3] = {1, 2, 3};
+    double result[3] = {0, 0, 0};
+
+    EXPECT_FALSE(reader.readIfNew(result)) << "Nothing was written yet";
+
+    writer.write(value);
+    EXPECT_TRUE(reader.readIfNew(result));
+    EXPECT_EQ(1, result[0]);
+    EXPECT_EQ(2, result[1]);
+    EXPECT_EQ(3, result[2]);
+
+    EXPECT_FALSE(reader.readIfNew(result)) << "The value was already read";
+
+    // A reader that opens the channel later still sees the latest value
+    SharedMemoryChannel lateReader("test_reads_only_new_values", 3, 1);
+    EXPECT_TRUE(lateReader.readIfNew(result));
+
+    SharedMemoryChannel::remove("test_reads_only_new_values");
+}
+
+TEST(SharedMemoryChannelTest, RejectsMismatchedDimensions)
+{
+    SharedMemoryChannel::remove("test_rejects_mismatched_dimensions");
+
+    SharedMemoryChannel channel("test_rejects_mismatched_dimensions", 2, 2);
+    EXPECT_THROW(SharedMemoryChannel("test_rejects_mismatched_dimensions", 4, 2), std::invalid_argument);
+    EXPECT_THROW(SharedMemoryChannel("invalid/name", 1, 1), std::invalid_argument);
+
+    SharedMemoryChannel::remove("test_rejects_mismatched_dimensions");
+}
+
+TEST(SharedMemoryChannelTest, NeverReadsPartialWrites)
+{
+    SharedMemoryChannel::remove("test_never_reads_partial_writes");
+
+    const int SIZE = 64;
+    SharedMemoryChannel writer("test_never_reads_partial_writes", SIZE, 1);
+    SharedMemoryChannel reader("test_never_reads_partial_writes", SIZE, 1);
+
+    // Continuously write values whose elements are all equal
+    std::atomic<bool> keepWriting(true);
+    std::thread writerThread([&]()
+    {
+        double value[SIZE];
+        for (int count = 1; keepWriting; count++)
+        {
+            for (int ii = 0; ii < SIZE; ii++)
+                value[ii] = count;
+            writer.write(value);
+        }
+    });
+
+    double result[SIZE];
+    int numReads = 0;
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        if (reader.readIfNew(result))
+        {
+            numReads++;
+            for (int ii = 1; ii < SIZE; ii++)
+                ASSERT_EQ(result[0], result[ii]) << "Read a partially written value";
+        }
+    }
+
+    keepWriting = false;
+    writerThread.join();
+
+    EXPECT_GT(numReads, 0);
+
+    SharedMemoryChannel::remove("test_never_reads_partial_writes");
+}
+
+} // namespace binding_factory_library
+} // namespace controlit
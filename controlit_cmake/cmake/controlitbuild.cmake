@@ -26,3 +26,38 @@ macro(controlit_build_init)
     add_definitions(-DPROJECT_SOURCE_DIR="${PROJECT_SOURCE_DIR}")
 
 endmacro(controlit_build_init)
+
+# Adds a gtest executable named NAME built from the remaining arguments and
+# sets TEST_NAME so that the caller can link it against more libraries.  The
+# tests do not define main(), so they are linked against gtest_main.  This
+# does nothing unless testing is enabled.
+macro(controlit_build_add_test NAME)
+    set(TEST_NAME ${NAME})
+    if (CATKIN_ENABLE_TESTING)
+        catkin_add_gtest(${NAME} ${ARGN})
+        if (TARGET ${NAME})
+            target_link_libraries(${NAME} ${GTEST_MAIN_LIBRARIES})
+        endif (TARGET ${NAME})
+    endif (CATKIN_ENABLE_TESTING)
+endmacro(controlit_build_add_test)
+
+# Adds a gtest executable named NAME built from the SRCS arguments that
+# rostest runs with the LAUNCH_FILE arguments, which is relative to the
+# current source directory and must run the executable as a <test>.  Use
+# this in place of controlit_build_add_test for tests that need a ROS master.
+# Sets TEST_NAME like controlit_build_add_test.  This does nothing unless
+# testing is enabled.
+macro(controlit_build_add_ros_test NAME)
+    include(CMakeParseArguments)
+    cmake_parse_arguments(controlit_build_add_ros_test "" "LAUNCH_FILE" "SRCS" ${ARGN})
+
+    set(TEST_NAME ${NAME})
+    if (CATKIN_ENABLE_TESTING)
+        find_package(rostest REQUIRED)
+        add_rostest_gtest(${NAME} ${controlit_build_add_ros_test_LAUNCH_FILE}
+            ${controlit_build_add_ros_test_SRCS})
+        if (TARGET ${NAME})
+            target_link_libraries(${NAME} ${GTEST_MAIN_LIBRARIES})
+        endif (TARGET ${NAME})
+    endif (CATKIN_ENABLE_TESTING)
+endmacro(controlit_build_add_ros_test)
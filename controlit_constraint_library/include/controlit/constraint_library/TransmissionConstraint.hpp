@@ -61,6 +61,23 @@ public:
      */
     virtual void getJacobian(RigidBodyDynamics::Model & robot, const Vector & Q, Matrix & Jc);
 
+    /*!
+     * The Jacobian of a transmission constraint only has two non-zero
+     * elements: one for the master node and one for the slave node.
+     *
+     * \return true
+     */
+    virtual bool hasSparseJacobian() const { return true; }
+
+    /*!
+     * Obtains the two non-zero elements of this constraint's jacobian matrix.
+     *
+     * \param[in] robot The robot model.
+     * \param[in] Q The current joint state.
+     * \param[out] Jc The non-zero elements of the constraint jacobian.
+     */
+    virtual void getSparseJacobian(RigidBodyDynamics::Model & robot, const Vector & Q, SparseJacobian_t & Jc);
+
 protected:
 
     /*!
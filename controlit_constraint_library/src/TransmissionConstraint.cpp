@@ -62,5 +62,21 @@ void TransmissionConstraint::getJacobian(RigidBodyDynamics::Model & robot, const
     localJcParam->set(Jc);
 }
 
+void TransmissionConstraint::getSparseJacobian(RigidBodyDynamics::Model & robot, const Vector & Q, SparseJacobian_t & Jc)
+{
+    assert(isInitialized());
+
+    Jc.resize(2);
+    Jc[0].row = 0; Jc[0].col = masterNode_ - 1; Jc[0].value = -transmissionRatio;
+    Jc[1].row = 0; Jc[1].col = slaveNode_ - 1;  Jc[1].value = 1;
+
+    // Only the two non-zero elements of localJc change.  It was zeroed in init().
+    localJc(0, masterNode_ - 1) = -transmissionRatio;
+    localJc(0, slaveNode_ - 1) = 1;
+
+    // Publish Jc if it is bound
+    localJcParam->set(localJc);
+}
+
 } // namespace constraint_library
 } // namespace controlit
@@ -27,8 +27,8 @@
 
 using controlit::Constraint;
 using controlit::ConstraintSet;
-using Matrix;
-using Vector;
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
 using RigidBodyDynamics::Math::Vector3d;
 using RigidBodyDynamics::Math::SpatialVector;
 
@@ -118,6 +118,42 @@ TEST_F(ConstraintSetTest, InitTest1)
     EXPECT_TRUE(Jc == expectedJc);
 }
 
+TEST_F(ConstraintSetTest, UIndicesTest)
+{
+    Constraint* TC(new TestTransmissionConstraint( "revolute1DoF_1", //careful using id
+                            "revolute1DoF_2", //careful using id
+                            2.0) );
+    std::unique_ptr<ConstraintSet> CS( new ConstraintSet("transmission_constraint") );
+    CS->addConstraint(TC);
+    CS->init( *(myRobot.get()) );
+
+    // The slave joint is not actuable.  Only the master joint remains.
+    const controlit::SelectionIndices & UIndices = CS->getUIndices();
+    ASSERT_EQ(1u, UIndices.size());
+    EXPECT_EQ(6, UIndices[0]);
+
+    // Both real joints are selected by virtualU.
+    const controlit::SelectionIndices & virtualUIndices = CS->getVirtualUIndices();
+    ASSERT_EQ(2u, virtualUIndices.size());
+    EXPECT_EQ(6, virtualUIndices[0]);
+    EXPECT_EQ(7, virtualUIndices[1]);
+
+    // The index maps must describe the same matrices as the dense accessors.
+    Matrix U;
+    controlit::addons::eigen::selectionToDense(UIndices, myRobot->dof_count, U);
+    EXPECT_TRUE(U == CS->getU());
+
+    Matrix virtualU;
+    controlit::addons::eigen::selectionToDense(virtualUIndices, myRobot->dof_count, virtualU);
+    EXPECT_TRUE(virtualU == CS->getVirtualU());
+
+    // Gathering the rows of a matrix must equal multiplying it by U.
+    Matrix M = Matrix::Random(myRobot->dof_count, myRobot->dof_count);
+    Matrix UM(UIndices.size(), myRobot->dof_count);
+    controlit::addons::eigen::selectRows(UIndices, M, UM);
+    EXPECT_TRUE(UM.isApprox(CS->getU() * M));
+}
+
 TEST_F(ConstraintSetTest, InitTest2)
 {
     Constraint* TC( new TestFlatContactConstraint( "rigid6DoF", //careful using id
@@ -25,8 +25,8 @@
 
 #include "DerivedTestClasses.hpp"
 
-using Matrix;
-using Vector;
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
 using controlit::Constraint;
 
 class ConstraintTest : public ::testing::Test
@@ -69,7 +69,7 @@ struct TestTransmissionConstraint : public controlit::constraint_library::Transm
   {
     this->masterNodeName_ = masterNode;
     this->slaveNodeName_ = slaveNode;
-    this->c_ = c;
+    this->transmissionRatio = c;
   }
 };
 
@@ -28,8 +28,8 @@
 
 using controlit::Constraint;
 using controlit::ConstraintSet;
-using Matrix;
-using Vector;
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
 using controlit::VirtualLinkageModel;
 using RigidBodyDynamics::Math::Vector3d;
 using RigidBodyDynamics::Math::SpatialVector;
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CONTROLLER_LIBRARY_REDUCED_NULLSPACE_HPP__
+#define __CONTROLIT_CONTROLLER_LIBRARY_REDUCED_NULLSPACE_HPP__
+
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+
+namespace controlit {
+namespace controller_library {
+
+using controlit::addons::eigen::Matrix;
+
+/*!
+ * Maintains the null space of the higher priority tasks in WBOSC as a
+ * low-rank correction instead of as a dense # actuable DOFs x # actuable DOFs
+ * matrix.
+ *
+ * WBOSC updates the null space at each priority level as
+ *
+ *   Nhp = (I - W * Jstar^T * Lstar * Jstar) * Nhp
+ *
+ * where W = UNcAiNorm, Jstar = Jbar * Nhp, Jbar = J * UNcBar, and
+ * Lstar = pinv(Jstar * W * Jstar^T).  W is only positive semi-definite when
+ * the robot is constrained, e.g., in double support.  Let W = F * F^T where
+ * F is n x r and r is the rank of W.  F is obtained from the pivoted LDL^T
+ * decomposition of W by discarding the columns whose pivots are zero.  Every
+ * Nhp is then of the form I - F * B where B is r x n, so only B needs to be
+ * stored, and each priority level costs O(n r k) where n is the number of
+ * actuable DOFs and k is the dimension of the task, instead of the O(n^3) of
+ * the dense update.
+ *
+ * The decomposition is computed once per servo cycle.  If W is not positive
+ * semi-definite, reset(...) returns false and the caller should fall back to
+ * the dense formulation.
+ */
+class ReducedNullspace
+{
+public:
+    /*!
+     * The default constructor.
+     */
+    ReducedNullspace();
+
+    /*!
+     * Resets the null space to be the entire space, i.e., Nhp = I.
+     *
+     * \param[in] W The matrix UNcAiNorm.
+     * \return Whether W is positive semi-definite.  If it is not, this object
+     * cannot be used until the next successful call to reset(...).
+     */
+    bool reset(const Matrix & W);
+
+    /*!
+     * Projects a task Jacobian into the null space of the higher priority tasks.
+     *
+     * \param[in] Jbar The task Jacobian times UNcBar.
+     * \param[out] Jstar Where Jbar * Nhp should be stored.
+     * \param[out] inverseLstar Where Jstar * W * Jstar^T should be stored.
+     */
+    void project(const Matrix & Jbar, Matrix & Jstar, Matrix & inverseLstar);
+
+    /*!
+     * Removes the space spanned by the Jacobian given in the most recent call
+     * to project(...) from the null space.  This is exactly
+     * Nhp = (I - W * Jstar^T * Lstar * Jstar) * Nhp, so directions are
+     * only removed if they survive the singular value cutoff used to compute
+     * Lstar.
+     *
+     * \param[in] Lstar The pseudo-inverse of the inverseLstar computed by the
+     * most recent call to project(...).
+     */
+    void update(const Matrix & Lstar);
+
+    /*!
+     * Computes the dense null space matrix.  This is O(n^2 r) and is meant
+     * for testing and debugging.
+     *
+     * \param[out] Nhp Where the dense null space matrix should be stored.
+     */
+    void getNullspace(Matrix & Nhp) const;
+
+    /*!
+     * \return The rank of the W given to the most recent call to reset(...).
+     */
+    int getRank() const { return rank; }
+
+private:
+    /*!
+     * The pivoted LDL^T decomposition of W.
+     */
+    Eigen::LDLT<Matrix> ldlt;
+
+    /*!
+     * The factor F of W = F * F^T.  Only the first rank columns are valid.
+     */
+    Matrix factor;
+
+    /*!
+     * The rank of W, i.e., the number of valid columns in factor.
+     */
+    int rank;
+
+    /*!
+     * The null space of the higher priority tasks is I - F * B.
+     */
+    Matrix B;
+
+    /*!
+     * Whether B is non-zero, i.e., whether update(...) removed anything since
+     * the last call to reset(...).
+     */
+    bool hasHigherPriorityTasks;
+
+    /*!
+     * The Jstar from the most recent call to project(...).
+     */
+    Matrix lastJstar;
+
+    /*!
+     * Jstar * F from the most recent call to project(...).
+     */
+    Matrix JstarF;
+
+    /*!
+     * Scratch space for Jbar * F, Jstar * Nhp, and (Jstar * F)^T * Lstar.
+     */
+    Matrix JbarF;
+    Matrix JstarNhp;
+    Matrix gain;
+};
+
+} // namespace controller_library
+} // namespace controlit
+
+#endif // __CONTROLIT_CONTROLLER_LIBRARY_REDUCED_NULLSPACE_HPP__
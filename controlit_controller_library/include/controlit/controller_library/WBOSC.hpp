@@ -25,6 +25,7 @@
 #include <controlit/Timer.hpp>
 #include <controlit/utility/ContainerUtility.hpp>
 #include <controlit/utility/GravityCompensationPublisher.hpp>
+#include <controlit/controller_library/ReducedNullspace.hpp>
 
 #include "controlit_core/get_parameters.h"
 
@@ -60,6 +61,18 @@ public:
      * \return Whether the command was successfully computed.
      */
     virtual bool computeCommand(ControlModel & model, CompoundTask & compoundTask, Command & command);
+
+    /*!
+     * Makes computeCommand(...) reuse Jstar and Lstar of the lowest
+     * priority levels from previous servo cycles.  The highest priority
+     * level is always recomputed.
+     *
+     * \param[in] numLevels The number of lowest priority levels whose
+     * projections are reused.  Zero recomputes all projections every cycle.
+     * \param[in] maxCycles The maximum number of consecutive cycles for which
+     * the projections are reused before they are recomputed.
+     */
+    virtual void setHeldProjections(size_t numLevels, int maxCycles);
   
     /*!
      * Initializes this controller.  This should only be called once.
@@ -145,8 +158,43 @@ private:
     /*!
      * The null space of all higher priority tasks.
      * Its dimensions are # actuable DOFs x # actuable DOFs.
+     * This is only used when UNcAiNorm is not positive definite.
      */
     Matrix Nhp;
+
+    /*!
+     * The stacked task Jacobians, commands, and command types of each
+     * priority level.  These are kept across servo cycles so that
+     * CompoundTask::getJacobianAndCommand(...) only reallocates them when
+     * the number of enabled task dimensions changes.
+     */
+    CompoundTask::TaskJacobians taskJacobians;
+    CompoundTask::TaskCommands taskCommands;
+    CompoundTask::TaskTypes taskTypes;
+
+    /*!
+     * The null space of all higher priority tasks stored as a low-rank basis.
+     * This is used instead of Nhp whenever UNcAiNorm is positive definite.
+     */
+    ReducedNullspace reducedNullspace;
+
+    /*!
+     * The task Jacobian times UNcBar.
+     * Its dimensions are # task DOFs x # actuable DOFs.
+     */
+    Matrix Jbar;
+
+    /*!
+     * The task Jacobian projected into the null space of higher priority tasks.
+     * Its dimensions are # task DOFs x # actuable DOFs.
+     */
+    Matrix Jstar;
+
+    /*!
+     * The inverse of the operational space mass/inertia.
+     * Its dimensions are # task DOFs x # task DOFs.
+     */
+    Matrix inverseLstar;
   
     /*!
      * The task-level gravity compensation term.
@@ -176,10 +224,32 @@ private:
      */
     Matrix Lstar;
   
+    /*!
+     * The number of lowest priority levels whose projections are reused
+     * and the number of cycles for which they may be reused.
+     */
+    size_t numHeldPriorityLevels;
+    int maxHeldProjectionCycles;
+
+    /*!
+     * The Jstar and Lstar matrices of each priority level from the last
+     * cycle in which the held levels were recomputed.  Only the entries of
+     * the held levels are used.
+     */
+    std::vector<Matrix> heldJstar;
+    std::vector<Matrix> heldLstar;
+
+    /*!
+     * The first held priority level when the held projections were
+     * computed, and the number of cycles for which they have been reused
+     * since.  A negative age means they are not valid.
+     */
+    size_t heldFirstPriority;
+    int heldProjectionAge;
+
     // These are used to prevent dynamic allocation when including
     // virtual linkage model commands
-    Matrix Jlstarbar;
-    Matrix Jlstar;
+    Vector fullEffortCmd;
     Vector pl;
     Vector Fint;
     Vector FintRef;
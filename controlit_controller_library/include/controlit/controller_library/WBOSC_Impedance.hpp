@@ -91,6 +91,13 @@ public:
      * \return Whether the initialization was successful.
      */
     virtual bool reinit(ControlModel & model);
+
+    /*!
+     * The internal model qi and qi_dot is integrated across cycles.
+     *
+     * \return True.
+     */
+    virtual bool hasCycleState() const { return true; }
   
     /*!
      * Updates qi and qi_dot model (i.e., eventual command) to make sure
@@ -155,9 +162,14 @@ private:
     double alpha, beta;
   
     /*!
-     * The underactuation matrix.  This specifies which joints are actuable.
+     * The actuable rows of UNcBar, i.e., U * UNcBar.
+     */
+    Matrix Jstar;
+
+    /*!
+     * The forward dynamics operator Jstar * UNcAiNorm * Jstar^T.
      */
-    Matrix U;
+    Matrix inverseLstar;
   
     /*!
      * This a problem.
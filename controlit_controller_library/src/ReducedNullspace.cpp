@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/controller_library/ReducedNullspace.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace controlit {
+namespace controller_library {
+
+/*!
+ * Pivots of the LDL^T decomposition of W that are smaller than this times the
+ * largest pivot are treated as zero.  Pivots that are more negative than
+ * this mean W is indefinite.
+ */
+#define RANK_EPSILON 1e-10
+
+ReducedNullspace::ReducedNullspace() :
+    rank(0),
+    hasHigherPriorityTasks(false)
+{
+}
+
+bool ReducedNullspace::reset(const Matrix & W)
+{
+    int numDOFs = W.rows();
+
+    rank = 0;
+    hasHigherPriorityTasks = false;
+
+    if (factor.rows() != numDOFs)
+    {
+        factor.resize(numDOFs, numDOFs);
+        B.resize(numDOFs, numDOFs);
+    }
+
+    if (numDOFs == 0)
+        return true;
+
+    // P * W * P^T = L * D * L^T.  Eigen reports a numerical issue for any
+    // negative pivot, including the round-off of the zero pivots of a
+    // positive semi-definite W, so the pivots are checked below instead.
+    ldlt.compute(W);
+
+    const Eigen::Diagonal<const Matrix> D = ldlt.vectorD();
+    double tolerance = RANK_EPSILON * D.cwiseAbs().maxCoeff();
+
+    if (!(tolerance < std::numeric_limits<double>::infinity()))
+        return false;
+
+    // W = F * F^T where F = P^T * L * sqrt(D), keeping only the columns with
+    // non-zero pivots.
+    factor = ldlt.matrixL();
+    for (int ii = 0; ii < numDOFs; ii++)
+    {
+        if (D(ii) < -tolerance)
+            return false;
+
+        if (D(ii) > tolerance)
+        {
+            factor.col(rank) = factor.col(ii) * std::sqrt(D(ii));
+            rank++;
+        }
+    }
+    factor = ldlt.transpositionsP().transpose() * factor;
+
+    B.topRows(rank).setZero();
+    return true;
+}
+
+void ReducedNullspace::project(const Matrix & Jbar, Matrix & Jstar, Matrix & inverseLstar)
+{
+    // Jstar = Jbar * (I - F * B)
+    Jstar = Jbar;
+    if (hasHigherPriorityTasks)
+    {
+        JbarF.noalias() = Jbar * factor.leftCols(rank);
+        Jstar.noalias() -= JbarF * B.topRows(rank);
+    }
+
+    // Jstar * W * Jstar^T = (Jstar * F) * (Jstar * F)^T
+    JstarF.noalias() = Jstar * factor.leftCols(rank);
+    inverseLstar.noalias() = JstarF * JstarF.transpose();
+
+    lastJstar = Jstar;
+}
+
+void ReducedNullspace::update(const Matrix & Lstar)
+{
+    if (lastJstar.rows() == 0 || rank == 0)
+        return;
+
+    // (I - W * Jstar^T * Lstar * Jstar) * (I - F * B)
+    //   = I - F * (B + (Jstar * F)^T * Lstar * Jstar * (I - F * B))
+    JstarNhp = lastJstar;
+    if (hasHigherPriorityTasks)
+        JstarNhp.noalias() -= JstarF * B.topRows(rank);
+
+    gain.noalias() = JstarF.transpose() * Lstar;
+    B.topRows(rank).noalias() += gain * JstarNhp;
+
+    hasHigherPriorityTasks = true;
+}
+
+void ReducedNullspace::getNullspace(Matrix & Nhp) const
+{
+    int numDOFs = factor.rows();
+
+    Nhp.setIdentity(numDOFs, numDOFs);
+    if (hasHigherPriorityTasks)
+        Nhp.noalias() -= factor.leftCols(rank) * B.topRows(rank);
+}
+
+} // namespace controller_library
+} // namespace controlit
@@ -21,7 +21,11 @@
 #include <controlit/controller_library/WBOSC.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
 #include <controlit/addons/eigen/PseudoInverse.hpp>
+#include <controlit/addons/eigen/SelectionMatrix.hpp>
 #include <controlit/Task.hpp>
+#include <controlit/AllocationCheck.hpp>
+
+#include <algorithm>
 
 #include <math.h>
 #include <sys/time.h>
@@ -46,16 +50,30 @@ namespace controller_library {
 
 WBOSC::WBOSC()
     : Controller("Unnamed"),
-      controlitParameters(nullptr)
+      controlitParameters(nullptr),
+      numHeldPriorityLevels(0),
+      maxHeldProjectionCycles(0),
+      heldFirstPriority(0),
+      heldProjectionAge(-1)
 {
 }
 
 WBOSC::WBOSC(std::string const& name)
     : Controller(name),
-      controlitParameters(nullptr)
+      controlitParameters(nullptr),
+      numHeldPriorityLevels(0),
+      maxHeldProjectionCycles(0),
+      heldFirstPriority(0),
+      heldProjectionAge(-1)
 {
 }
 
+void WBOSC::setHeldProjections(size_t numLevels, int maxCycles)
+{
+    numHeldPriorityLevels = numLevels;
+    maxHeldProjectionCycles = maxCycles;
+}
+
 bool WBOSC::init(ros::NodeHandle & nh, ControlModel & model,
     controlit::utility::ControlItParameters * controlitParameters,
     std::shared_ptr<Timer> timer)
@@ -134,8 +152,13 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
     // const Matrix & UNc = model.constraints().getUNc();
     // const Vector & grav = model.getGrav();
 
-    // Initialize Nhp, the null space of higher priority tasks, to be identity.
-    Nhp = identityActuableDOFs;
+    // Initialize the null space of higher priority tasks to be identity.
+    // The reduced formulation requires UNcAiNorm to be positive semi-definite,
+    // which it is even when constraints remove DOFs.  If it is not, e.g., due
+    // to a bad model, fall back to the dense Nhp matrix.
+    bool useReducedNullspace = reducedNullspace.reset(UNcAiNorm);
+    if (!useReducedNullspace)
+        Nhp = identityActuableDOFs;
 
     // CONTROLIT_DEBUG_RT << "Input variables:\n"
     //      " - ControlModel name = " << model.getName() << "\n"
@@ -143,10 +166,6 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
     //      " - Ai = \n" << Ai << "\n"
     //      " - grav = " << grav.transpose();
 
-    CompoundTask::TaskCommands taskCommands;
-    CompoundTask::TaskJacobians taskJacobians;
-    CompoundTask::TaskTypes taskTypes;
-
     #ifdef TIME_TORQUE_CONTROLLER_COMPUTE_COMMAND
     timeBookkeeping = timer->getTime();
     #endif
@@ -162,6 +181,36 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
     size_t internalForceTaskPriority = compoundTask.getInternalForceTaskPriority();
     int numPrevTasks = 0;
 
+    // Determine whether the projections of the lowest priority levels can be
+    // reused.  They can if they were computed for the same held levels and
+    // task dimensions within the last maxHeldProjectionCycles cycles.
+    size_t firstHeldPriority = taskCommands.size();
+    if (numHeldPriorityLevels > 0 && taskCommands.size() > 1)
+        firstHeldPriority = taskCommands.size() - std::min(numHeldPriorityLevels, taskCommands.size() - 1);
+
+    bool reuseHeldProjections = firstHeldPriority < taskCommands.size()
+        && heldProjectionAge >= 0 && heldProjectionAge < maxHeldProjectionCycles
+        && heldFirstPriority == firstHeldPriority && heldJstar.size() == taskCommands.size();
+
+    for (size_t priority = firstHeldPriority; reuseHeldProjections && priority < taskCommands.size(); priority++)
+    {
+        if (taskCommands[priority].size() > 0 && heldJstar[priority].rows() != taskJacobians[priority].rows())
+            reuseHeldProjections = false;
+    }
+
+    if (reuseHeldProjections)
+        heldProjectionAge++;
+    else
+    {
+        heldProjectionAge = -1;
+        if (firstHeldPriority < taskCommands.size() && heldJstar.size() != taskCommands.size())
+        {
+            AllowAllocationScope allowAllocation;
+            heldJstar.resize(taskCommands.size());
+            heldLstar.resize(taskCommands.size());
+        }
+    }
+
     gravityComp.setZero(numDOFs);
 
     #ifdef TIME_TORQUE_CONTROLLER_COMPUTE_COMMAND
@@ -188,55 +237,82 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
             //   << " - size of UNcBar: (" << UNcBar.rows() << "x" << UNcBar.cols() << ")\n"
             //   << " - size of Nhp: (" << Nhp.rows() << "x" << Nhp.cols() << ")";
 
-            // Jstar tells you the feasibility of the task.  In other words it expresses the task space.
-            // For example, if your legs are straight, you cannot move anymore.
-            Matrix Jstar = taskJacobians[priority] * UNcBar * Nhp; //Nhp is identity for top level task.  It is the nullspace of all higher priority tasks
-
-            // CONTROLIT_DEBUG_RT << "Done computing Jstar";
-
-            // CONTROLIT_DEBUG_RT << "Computing inverseLstar:\n"
-            //   << " - Priority: " << priority << "\n"
-            //   << " - size of Jstar: (" << Jstar.rows() << "x" << Jstar.cols() << ")\n"
-            //   << " - size of UNcAiNorm: (" << UNcAiNorm.rows() << "x" << UNcAiNorm.cols() << ")";
-
-            // TODO: Remove this dynamic allocation
-            Matrix inverseLstar = Jstar * UNcAiNorm * Jstar.transpose();
-
-            // Lstar tells you the ability to do something dynamic.
-            // For example, if you spin your arms fast enough, maybe you can lift off the ground.
-            // TODO: Remove this dynamic allocation
-            Lstar.resize(inverseLstar.cols(), inverseLstar.rows());
-
-            // std::cout<<"Lstar["<<priority<<"] = \n"<<Lstar<<std::endl;
+            bool isHeld = priority >= firstHeldPriority;
 
-            // CONTROLIT_DEBUG_RT << "Done computing inverseLstar";
-
-            // CONTROLIT_DEBUG_RT
-            //   // << std::scientific << std::fixed << std::setprecision(std::numeric_limits<double>::digits10 + 1)
-            //   << "Details of matrix to be inverted:\n"
-            //   << " - Priority: " << priority << "\n"
-            //   << " - Matrix being inverted:\n" << inverseLstar << "\n"
-            //   << " - taskJacobians:\n" << taskJacobians[priority] << "\n"
-            //   << " - UNcBar:\n" << UNcBar << "\n"
-            //   << " - Nhp:\n" << Nhp;
-
-            // std::stringstream msgBuff;
-            // for (int ii = 0; ii < inverseLstar.rows(); ii++)
-            // {
-            //   for (int jj = 0; jj < inverseLstar.cols(); jj++)
-            //   {
-            //     if (jj != 0)
-            //       msgBuff << ", ";
-            //     msgBuff << std::scientific << std::fixed << std::setprecision(std::numeric_limits<double>::digits10 + 1) << inverseLstar(ii, jj);
-            //   }
-            //   msgBuff << ",\n";
-            // }
-            // CONTROLIT_DEBUG_RT << "Here's code for initializing the matrix.  Size = " << inverseLstar.rows() << "x" << inverseLstar.cols() << ":\n" << msgBuff.str();
-
-            // ros::Time startMethodCall = ros::Time::now();
-
-            // CONTROLIT_INFO << "Computing pseudoInverse";
-            controlit::addons::eigen::pseudo_inverse(inverseLstar, Lstar); //, compoundTask.getSigmaThreshold());
+            if (isHeld && reuseHeldProjections)
+            {
+                Jstar = heldJstar[priority];
+                Lstar = heldLstar[priority];
+            }
+            else
+            {
+                // Jstar tells you the feasibility of the task.  In other words it expresses the task space.
+                // For example, if your legs are straight, you cannot move anymore.
+                Jbar.noalias() = taskJacobians[priority] * UNcBar;
+
+                if (useReducedNullspace)
+                {
+                    // Computes Jstar = Jbar * Nhp and inverseLstar = Jstar * UNcAiNorm * Jstar^T
+                    // in O(n r k) using the low-rank form of Nhp.
+                    reducedNullspace.project(Jbar, Jstar, inverseLstar);
+                }
+                else
+                {
+                    Jstar.noalias() = Jbar * Nhp; //Nhp is identity for top level task.  It is the nullspace of all higher priority tasks
+                    inverseLstar.noalias() = Jstar * UNcAiNorm * Jstar.transpose();
+                }
+
+                // CONTROLIT_DEBUG_RT << "Done computing Jstar";
+
+                // CONTROLIT_DEBUG_RT << "Computing inverseLstar:\n"
+                //   << " - Priority: " << priority << "\n"
+                //   << " - size of Jstar: (" << Jstar.rows() << "x" << Jstar.cols() << ")\n"
+                //   << " - size of UNcAiNorm: (" << UNcAiNorm.rows() << "x" << UNcAiNorm.cols() << ")";
+
+                // Lstar tells you the ability to do something dynamic.
+                // For example, if you spin your arms fast enough, maybe you can lift off the ground.
+                // TODO: Remove this dynamic allocation
+                Lstar.resize(inverseLstar.cols(), inverseLstar.rows());
+
+                // std::cout<<"Lstar["<<priority<<"] = \n"<<Lstar<<std::endl;
+
+                // CONTROLIT_DEBUG_RT << "Done computing inverseLstar";
+
+                // CONTROLIT_DEBUG_RT
+                //   // << std::scientific << std::fixed << std::setprecision(std::numeric_limits<double>::digits10 + 1)
+                //   << "Details of matrix to be inverted:\n"
+                //   << " - Priority: " << priority << "\n"
+                //   << " - Matrix being inverted:\n" << inverseLstar << "\n"
+                //   << " - taskJacobians:\n" << taskJacobians[priority] << "\n"
+                //   << " - UNcBar:\n" << UNcBar << "\n"
+                //   << " - Nhp:\n" << Nhp;
+
+                // std::stringstream msgBuff;
+                // for (int ii = 0; ii < inverseLstar.rows(); ii++)
+                // {
+                //   for (int jj = 0; jj < inverseLstar.cols(); jj++)
+                //   {
+                //     if (jj != 0)
+                //       msgBuff << ", ";
+                //     msgBuff << std::scientific << std::fixed << std::setprecision(std::numeric_limits<double>::digits10 + 1) << inverseLstar(ii, jj);
+                //   }
+                //   msgBuff << ",\n";
+                // }
+                // CONTROLIT_DEBUG_RT << "Here's code for initializing the matrix.  Size = " << inverseLstar.rows() << "x" << inverseLstar.cols() << ":\n" << msgBuff.str();
+
+                // ros::Time startMethodCall = ros::Time::now();
+
+                // CONTROLIT_INFO << "Computing pseudoInverse";
+                controlit::addons::eigen::pseudo_inverse(inverseLstar, Lstar); //, compoundTask.getSigmaThreshold());
+
+                if (isHeld)
+                {
+                    // The held projections are sized the first time a level is held.
+                    AllowAllocationScope allowAllocation;
+                    heldJstar[priority] = Jstar;
+                    heldLstar[priority] = Lstar;
+                }
+            }
 
             // CONTROLIT_DEBUG_RT << "Done computing Lstar";
 
@@ -317,7 +393,7 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
             else
             {
                 fcomp.setZero(Lstar.rows());
-                fcomp = Lstar * Jstar * UNcAiNorm * command.getEffortCmd();
+                fcomp.noalias() = Lstar * (Jstar * (UNcAiNorm * command.getEffortCmd()));
                 if(taskTypes[priority] == CommandType::ACCELERATION)
                     command.getEffortCmd().noalias() += Jstar.transpose() * (Lstar * taskCommands[priority] + pstar - fcomp);
                 else //CommandType::FORCE
@@ -344,9 +420,14 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
                 return false;
             }
 
-            if (priority < taskCommands.size() - 1) // Avoid last calculation
+            // The null space is not needed below reused levels because all
+            // lower levels are reused too.
+            if (priority < taskCommands.size() - 1 && !(isHeld && reuseHeldProjections)) // Avoid last calculation
             {
-                Nhp = (identityActuableDOFs - UNcAiNorm * Jstar.transpose() * Lstar * Jstar) * Nhp; //check order of projection
+                if (useReducedNullspace)
+                    reducedNullspace.update(Lstar);
+                else
+                    Nhp = (identityActuableDOFs - UNcAiNorm * Jstar.transpose() * Lstar * Jstar) * Nhp; //check order of projection
             }
 
             numPrevTasks++;
@@ -357,6 +438,13 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
         #endif
     }
 
+    // All held levels were recomputed successfully
+    if (!reuseHeldProjections && firstHeldPriority < taskCommands.size())
+    {
+        heldFirstPriority = firstHeldPriority;
+        heldProjectionAge = 0;
+    }
+
     #ifdef TIME_TORQUE_CONTROLLER_COMPUTE_COMMAND
     timer->start(); // reset the timer
     #endif
@@ -411,35 +499,37 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
     // All of the task commands are calculated.  Now add VLM commands if necessary.
     if (model.virtualLinkageModel().exists() && forceTaskEnabled)
     {
-        // Get references to various useful matricies and vectors.
-        const Matrix & Jsbar = model.virtualLinkageModel().getJacobianBar();
-        const Matrix & Wint = model.virtualLinkageModel().getWint();
-        const Matrix & Lstar = model.virtualLinkageModel().getLstar();
-        const Matrix & U = model.virtualLinkageModel().getU();
-
-        Jlstarbar = Lstar * U * Jsbar * Wint.transpose();
-
-        // TODO: Move this into an init method
-        Jlstar.resize(Jlstarbar.cols(), Jlstarbar.rows());
-
-        // CONTROLIT_INFO << "Computing pseudoInverse";
-        controlit::addons::eigen::pseudo_inverse(Jlstarbar, Jlstar); //, compoundTask.getSigmaThreshold());
+        if (!model.virtualLinkageModel().internalForceOperatorsEnabled())
+        {
+            CONTROLIT_ERROR_RT << "The internal force task is enabled but the model does not compute the "
+                "internal force operators!  Call VirtualLinkageModel::setInternalForceOperatorsEnabled(true).";
+            return false;
+        }
 
-        //Matrix Id7(7,7); Id7.setIdentity();
-        //std::cout<<"Jlstar * Jlstarbar = \n"<<(Jlstar * Jlstarbar)<<std::endl;
+        // Get references to various useful matricies and vectors.  The
+        // model-dependent products and the pseudo-inverse Jlstar are
+        // computed by the model update, so only matrix-vector products
+        // remain here.
+        const VirtualLinkageModel & vlm = model.virtualLinkageModel();
+        const Matrix & WintJsbarT = vlm.getWintJsbarT();
+        const Matrix & LstarTJlstarT = vlm.getLstarTJlstarT();
+        const SelectionIndices & UIndices = model.constraints().getUIndices();
 
-        pl = Wint * Jsbar.transpose() * model.getGrav();
+        pl.noalias() = WintJsbarT * model.getGrav();
 
-        Fint = Wint * Jsbar.transpose() * U.transpose() * command.getEffortCmd(); // getEffortCmd() is the sum of all operation and joint space tasks.
+        // U.transpose() * getEffortCmd() scatters the command into the full joint space.
+        // getEffortCmd() is the sum of all operation and joint space tasks.
+        fullEffortCmd.resize(WintJsbarT.cols());
+        controlit::addons::eigen::scatterRows(UIndices, command.getEffortCmd(), fullEffortCmd);
+        Fint.noalias() = WintJsbarT * fullEffortCmd;
 
         if (!containerUtility.checkMagnitude(Fint, INFINITY_THRESHOLD))
         {
             CONTROLIT_ERROR_RT << "Invalid Fint!\n"
                 << std::scientific << std::fixed << std::setprecision(std::numeric_limits<double>::digits10 + 1)
                 << " - effortCmd = " << command.getEffortCmd().transpose() << "\n"
-                   " - U =\n" << U << "\n"
-                   " - Jsbar = " << Jsbar << "\n"
-                   " - Wint = " << Wint;
+                   " - Jsbar = " << vlm.getJacobianBar() << "\n"
+                   " - Wint = " << vlm.getWint();
             return false;
         }
 
@@ -459,7 +549,9 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
         // std::cout<<"norm of UNc.transpose * intCommand = "<<check.norm()<<std::endl;
         //std::cout<<"norm of UNc.transpose * Lstar.transpose = "<<(UNc.transpose() * Lstar.transpose()).norm()<<std::endl;
 
-        command.getEffortCmd().noalias() += Lstar.transpose() * Jlstar.transpose() * (FintRef - Fint + pl); //Check sign of pl.
+        FintRef -= Fint;
+        FintRef += pl;
+        command.getEffortCmd().noalias() += LstarTJlstarT * FintRef; //Check sign of pl.
 
         if (!containerUtility.checkMagnitude(command.getEffortCmd(), INFINITY_THRESHOLD))
         {
@@ -467,12 +559,12 @@ bool WBOSC::computeCommand(ControlModel & model, CompoundTask & compoundTask, Co
                 // << std::scientific << std::fixed << std::setprecision(std::numeric_limits<double>::digits10 + 1)
                 << " - effortCmd = " << command.getEffortCmd().transpose() << "\n"
                    " - Fint = " << Fint.transpose() << "\n"
-                   " - FintRef = " << FintRef.transpose() << "\n"
+                   " - FintRef - Fint + pl = " << FintRef.transpose() << "\n"
                    " - pl = " << pl.transpose() << "\n"
                    " - Q = " << model.getQ().transpose() << "\n"
                    " - Qd = " << model.getQd().transpose() << "\n"
-                   " - Lstar =\n" << Lstar << "\n"
-                   " - Jlstar =\n" << Jlstar << "\n";
+                   " - Lstar =\n" << vlm.getLstar() << "\n"
+                   " - Jlstar =\n" << vlm.getJlstar() << "\n";
             return false;
         }
     }
@@ -21,6 +21,7 @@
 #include <controlit/controller_library/WBOSC_Impedance.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
 #include <controlit/Task.hpp>
+#include <controlit/ScratchArena.hpp>
 
 
 //#include <controlit/ConstraintSet.hpp>
@@ -41,6 +42,7 @@
 #include <controlit/utility/string_utility.hpp>
 
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <controlit/addons/eigen/SelectionMatrix.hpp>
 
 namespace controlit {
 namespace controller_library {
@@ -91,7 +93,6 @@ bool WBOSC_Impedance::init(ros::NodeHandle & nh, ControlModel & model,
     qi_dot.setZero(numDOFs);
     qi_dot_prev.setZero(numDOFs);
     qi_ddot.setZero(numDOFs);
-    model.constraints().getU(U);
   
     qi_prev = model.getLatestJointState()->getJointPosition();
     qi_dot_prev = model.getLatestJointState()->getJointVelocity();
@@ -126,15 +127,24 @@ bool WBOSC_Impedance::computeCommand(ControlModel & model, CompoundTask & compou
   
     // Get references to various useful matricies and vector.
     const Matrix & UNcBar = model.constraints().getUNcBar();
-    const Matrix & U = model.constraints().getU();
+    const SelectionIndices & UIndices = model.constraints().getUIndices();
     const Matrix & UNcAiNorm = model.constraints().getUNcAiNorm();
     const Vector & gravityComp = torqueController->getGravityComp();
   
-    Matrix Jstar = U * UNcBar;
-    Matrix inverseLstar = Jstar * UNcAiNorm * Jstar.transpose();
+    // Jstar = U * UNcBar, i.e., the actuable rows of UNcBar
+    Jstar.resize(UIndices.size(), UNcBar.cols());
+    controlit::addons::eigen::selectRows(UIndices, UNcBar, Jstar);
+
+    // Evaluate the products in scratch memory to avoid allocating temporaries.
+    ScratchArena & arena = ScratchArena::getThreadArena();
+    ScratchArena::MatrixMap JstarUNcAiNorm = arena.getMatrix(Jstar.rows(), UNcAiNorm.cols());
+    JstarUNcAiNorm.noalias() = Jstar * UNcAiNorm;
+    inverseLstar.noalias() = JstarUNcAiNorm * Jstar.transpose();
   
     // forward dyanmics step to turn torque into acceleration
-    qi_ddot = inverseLstar * (command.getEffortCmd() - gravityComp); //hmmmm....what if command already includes internal tensions?
+    ScratchArena::VectorMap effort = arena.getVector(gravityComp.size());
+    effort = command.getEffortCmd() - gravityComp;
+    qi_ddot.noalias() = inverseLstar * effort; //hmmmm....what if command already includes internal tensions?
   
     // Internal velocity update
     ros::Time currTime = ros::Time::now();
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include <rbdl/rbdl.h>
+
+#include <controlit/ContactConstraint.hpp>
+#include <controlit/ControlModel.hpp>
+#include <controlit/ControlModelLibrary.hpp>
+#include <controlit/RobotState.hpp>
+#include <controlit/VirtualLinkageModel.hpp>
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <controlit/addons/eigen/PseudoInverse.hpp>
+#include <controlit/addons/eigen/SelectionMatrix.hpp>
+
+/*!
+ * Checks that the internal force operators that the virtual linkage model
+ * caches on every model update match computing them from the model on
+ * every servo cycle, as WBOSC used to, for a leg touching the ground with
+ * its foot and a wall with its top link.
+ */
+
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
+using controlit::addons::eigen::SelectionIndices;
+using controlit::addons::eigen::pseudo_inverse;
+using controlit::addons::eigen::selectRows;
+using controlit::addons::eigen::scatterRows;
+using controlit::addons::eigen::Matrix3d;
+using RigidBodyDynamics::Math::Vector3d;
+
+namespace {
+
+const double TOLERANCE = 1e-8;
+
+/*!
+ * A six-DOF contact at a fixed point of a body.
+ */
+struct TestContactConstraint : public controlit::ContactConstraint
+{
+    TestContactConstraint(std::string const& masterNode, Vector3d const& pt, Vector3d const& COP,
+                          Vector3d const& contactNormal) :
+        controlit::ContactConstraint("controlit/TestContactConstraint", "__UNNAMED__")
+    {
+        phi_.setIdentity(6, 6);
+        this->constrainedDOFs_ = 6;
+        rxnFrFrame_ = 0;
+        ContactConstraint::setupParameters();
+
+        this->masterNodeName_ = masterNode;
+        this->localCOP_ = pt;
+        this->worldCOP_ = COP;
+        this->goalWorldCOP_ = COP;
+        this->contactNormal_ = contactNormal;
+        this->contactPlanePoint_ = pt;
+        this->sensorLocation_ = pt;
+        this->rxnForceCOM_.setZero(6);
+    }
+
+    virtual void init(RigidBodyDynamics::Model& robot)
+    {
+        Jpv.resize(3, robot.dof_count);
+        Jpw.resize(3, robot.dof_count);
+
+        Constraint::init(robot);
+    }
+
+    virtual void getJacobian(RigidBodyDynamics::Model& robot, const Vector& Q, Matrix& Jc)
+    {
+        RigidBodyDynamics::CalcPointJacobian(robot, Q, masterNode_, localCOP_, Jpv, false);
+        RigidBodyDynamics::CalcPointJacobianW(robot, Q, masterNode_, localCOP_, Jpw, false);
+
+        Jc.topRows(3) = Jpv;
+        Jc.bottomRows(3) = Jpw;
+    }
+
+    virtual Matrix getPhi(const Matrix3d& Rn, const Matrix3d& Rb) { return phi_; }
+
+    Matrix Jpv, Jpw;
+};
+
+} // namespace
+
+class InternalForceOperatorsTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ros::Time::init();
+
+        robotState.reset(new controlit::RobotState());
+        model.reset(controlit::ControlModelLibrary::getLegAndFootModel(robotState));
+
+        // The foot stands on the ground and the top link pushes against a wall.
+        model->constraints().addConstraint(new TestContactConstraint("rigid6DoF",
+            Vector3d(0, 0, 0), Vector3d(0, 0, 0), Vector3d(0, 0, 1)));
+        model->constraints().addConstraint(new TestContactConstraint("revolute1DoF_2",
+            Vector3d(0, 0, 0.5), Vector3d(0.1, 0, 1.5), Vector3d(-1, 0, 0)));
+        model->reinit();
+
+        Vector Q(model->getNActuableDOFs());  Q << 0.1, 0.2;
+        Vector Qd(model->getNActuableDOFs()); Qd << 0.01, -0.02;
+
+        for (int ii = 0; ii < Q.size(); ii++)
+        {
+            robotState->setJointPosition(ii, Q[ii]);
+            robotState->setJointVelocity(ii, Qd[ii]);
+            robotState->setJointAcceleration(ii, 0);
+        }
+
+        model->updateJointState();
+    }
+
+    /*!
+     * Computes the internal force command from the model's own Jsbar, Wint
+     * and Lstar, i.e., everything on the servo thread.
+     */
+    void commandPerCycle(const Vector & effortCmd, const Vector & FintRef, Matrix & Jlstar, Vector & command)
+    {
+        const controlit::VirtualLinkageModel & vlm = model->virtualLinkageModel();
+        const SelectionIndices & UIndices = model->constraints().getUIndices();
+
+        Matrix UJsbar(UIndices.size(), vlm.getJacobianBar().cols());
+        selectRows(UIndices, vlm.getJacobianBar(), UJsbar);
+
+        Matrix Jlstarbar = vlm.getLstar() * UJsbar * vlm.getWint().transpose();
+        Jlstar.resize(Jlstarbar.cols(), Jlstarbar.rows());
+        pseudo_inverse(Jlstarbar, Jlstar);
+
+        Vector pl = vlm.getWint() * vlm.getJacobianBar().transpose() * model->getGrav();
+
+        Vector fullEffortCmd(vlm.getJacobianBar().rows());
+        scatterRows(UIndices, effortCmd, fullEffortCmd);
+        Vector Fint = vlm.getWint() * (vlm.getJacobianBar().transpose() * fullEffortCmd);
+
+        command = effortCmd;
+        command.noalias() += vlm.getLstar().transpose() * Jlstar.transpose() * (FintRef - Fint + pl);
+    }
+
+    /*!
+     * Computes the internal force command from the cached operators, as
+     * WBOSC::computeCommand(...) does.
+     */
+    void commandCached(const Vector & effortCmd, const Vector & FintRef, Vector & command)
+    {
+        const controlit::VirtualLinkageModel & vlm = model->virtualLinkageModel();
+
+        Vector pl = vlm.getWintJsbarT() * model->getGrav();
+
+        Vector fullEffortCmd(vlm.getWintJsbarT().cols());
+        scatterRows(model->constraints().getUIndices(), effortCmd, fullEffortCmd);
+        Vector Fint = vlm.getWintJsbarT() * fullEffortCmd;
+
+        command = effortCmd;
+        command.noalias() += vlm.getLstarTJlstarT() * (FintRef - Fint + pl);
+    }
+
+    std::shared_ptr<controlit::RobotState> robotState;
+    std::unique_ptr<controlit::ControlModel> model;
+};
+
+TEST_F(InternalForceOperatorsTest, CachedOperatorsMatchPerCycle)
+{
+    model->virtualLinkageModel().setInternalForceOperatorsEnabled(true);
+    model->update();
+
+    const controlit::VirtualLinkageModel & vlm = model->virtualLinkageModel();
+    ASSERT_TRUE(vlm.exists());
+    ASSERT_EQ(vlm.getContactCount(), 2);
+
+    Vector effortCmd = Vector::Random(model->getNActuableDOFs());
+    Vector FintRef = Vector::Random(vlm.getWint().rows());
+
+    Matrix Jlstar;
+    Vector expected, command;
+    commandPerCycle(effortCmd, FintRef, Jlstar, expected);
+    commandCached(effortCmd, FintRef, command);
+
+    EXPECT_TRUE(vlm.getJlstar().isApprox(Jlstar, TOLERANCE))
+        << "cached Jlstar:\n" << vlm.getJlstar() << "\nexpected:\n" << Jlstar;
+
+    Matrix WintJsbarT = vlm.getWint() * vlm.getJacobianBar().transpose();
+    EXPECT_TRUE(vlm.getWintJsbarT().isApprox(WintJsbarT, TOLERANCE))
+        << "cached WintJsbarT:\n" << vlm.getWintJsbarT() << "\nexpected:\n" << WintJsbarT;
+
+    EXPECT_TRUE((command - expected).norm() <= TOLERANCE * std::max(1.0, expected.norm()))
+        << "command = " << command.transpose() << "\nexpected: " << expected.transpose();
+}
+
+TEST_F(InternalForceOperatorsTest, OperatorsOnlyComputedWhenEnabled)
+{
+    // Without an internal force task, the model update skips the pseudo-inverse.
+    model->update();
+
+    const controlit::VirtualLinkageModel & vlm = model->virtualLinkageModel();
+    ASSERT_TRUE(vlm.exists());
+    EXPECT_FALSE(vlm.internalForceOperatorsEnabled());
+    EXPECT_EQ(vlm.getJlstar().size(), 0);
+    EXPECT_EQ(vlm.getWintJsbarT().size(), 0);
+
+    // Enabling them takes effect at the next update.
+    model->virtualLinkageModel().setInternalForceOperatorsEnabled(true);
+    model->update();
+
+    Vector effortCmd = Vector::Random(model->getNActuableDOFs());
+    Vector FintRef = Vector::Random(vlm.getWint().rows());
+
+    Matrix Jlstar;
+    Vector expected, command;
+    commandPerCycle(effortCmd, FintRef, Jlstar, expected);
+    commandCached(effortCmd, FintRef, command);
+
+    EXPECT_TRUE((command - expected).norm() <= TOLERANCE * std::max(1.0, expected.norm()))
+        << "command = " << command.transpose() << "\nexpected: " << expected.transpose();
+}
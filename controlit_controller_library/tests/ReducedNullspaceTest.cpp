@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <controlit/controller_library/ReducedNullspace.hpp>
+#include <controlit/addons/eigen/PseudoInverse.hpp>
+
+using controlit::controller_library::ReducedNullspace;
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
+
+namespace {
+
+const int NUM_DOFS = 30;
+const double TOLERANCE = 1e-8;
+
+/*!
+ * Creates a random symmetric positive definite matrix to stand in for UNcAiNorm.
+ */
+Matrix randomSPD(int size)
+{
+    Matrix M = Matrix::Random(size, size);
+    return M * M.transpose() + size * Matrix::Identity(size, size);
+}
+
+/*!
+ * Creates a random symmetric positive semi-definite matrix of the given rank.
+ */
+Matrix randomPSD(int size, int rank)
+{
+    Matrix F = Matrix::Random(size, rank);
+    return F * F.transpose();
+}
+
+/*!
+ * Compares two matrices relative to their magnitude, or absolutely when
+ * the expected matrix is zero, e.g., for a task with nothing left to do.
+ */
+template<typename DerivedA, typename DerivedB>
+bool nearlyEqual(const Eigen::MatrixBase<DerivedA> & actual, const Eigen::MatrixBase<DerivedB> & expected)
+{
+    return (actual - expected).norm() <= TOLERANCE * std::max(1.0, expected.norm());
+}
+
+/*!
+ * Runs the WBOSC task hierarchy using both the dense and the reduced null
+ * space and compares the resulting torques and null spaces.
+ */
+void compareHierarchies(const Matrix & W, const std::vector<Matrix> & Jbars,
+    const std::vector<Vector> & commands)
+{
+    Matrix denseNhp = Matrix::Identity(NUM_DOFS, NUM_DOFS);
+    Vector denseEffort = Vector::Zero(NUM_DOFS);
+    Vector reducedEffort = Vector::Zero(NUM_DOFS);
+
+    ReducedNullspace nullspace;
+    ASSERT_TRUE(nullspace.reset(W));
+
+    Matrix Jstar, inverseLstar, Lstar, reducedNhp;
+
+    for (size_t priority = 0; priority < Jbars.size(); priority++)
+    {
+        // The dense formulation
+        Matrix denseJstar = Jbars[priority] * denseNhp;
+        Matrix denseInverseLstar = denseJstar * W * denseJstar.transpose();
+        Matrix denseLstar(denseInverseLstar.cols(), denseInverseLstar.rows());
+        controlit::addons::eigen::pseudo_inverse(denseInverseLstar, denseLstar);
+
+        Vector denseFcomp = denseLstar * denseJstar * W * denseEffort;
+        denseEffort += denseJstar.transpose() * (denseLstar * commands[priority] - denseFcomp);
+        denseNhp = (Matrix::Identity(NUM_DOFS, NUM_DOFS) - W * denseJstar.transpose() * denseLstar * denseJstar) * denseNhp;
+
+        // The reduced formulation
+        nullspace.project(Jbars[priority], Jstar, inverseLstar);
+        Lstar.resize(inverseLstar.cols(), inverseLstar.rows());
+        controlit::addons::eigen::pseudo_inverse(inverseLstar, Lstar);
+
+        EXPECT_TRUE(nearlyEqual(Jstar, denseJstar)) << "Jstar differs at priority " << priority;
+        EXPECT_TRUE(nearlyEqual(inverseLstar, denseInverseLstar)) << "inverseLstar differs at priority " << priority;
+
+        Vector reducedFcomp = Lstar * (Jstar * (W * reducedEffort));
+        reducedEffort += Jstar.transpose() * (Lstar * commands[priority] - reducedFcomp);
+        nullspace.update(Lstar);
+
+        nullspace.getNullspace(reducedNhp);
+        EXPECT_TRUE(nearlyEqual(reducedNhp, denseNhp)) << "Nhp differs at priority " << priority;
+    }
+
+    EXPECT_TRUE(nearlyEqual(reducedEffort, denseEffort))
+        << "dense effort: " << denseEffort.transpose() << "\n"
+        << "reduced effort: " << reducedEffort.transpose();
+}
+
+} // namespace
+
+TEST(ReducedNullspaceTest, DeepHierarchy)
+{
+    Matrix W = randomSPD(NUM_DOFS);
+
+    // Eight priority levels of differing dimensions
+    int taskDims[] = {6, 3, 3, 6, 3, 1, 2, 4};
+
+    std::vector<Matrix> Jbars;
+    std::vector<Vector> commands;
+    for (int ii = 0; ii < 8; ii++)
+    {
+        Jbars.push_back(Matrix::Random(taskDims[ii], NUM_DOFS));
+        commands.push_back(Vector::Random(taskDims[ii]));
+    }
+
+    compareHierarchies(W, Jbars, commands);
+}
+
+TEST(ReducedNullspaceTest, RedundantAndSaturatedTasks)
+{
+    Matrix W = randomSPD(NUM_DOFS);
+
+    std::vector<Matrix> Jbars;
+    std::vector<Vector> commands;
+
+    // A task with linearly dependent rows
+    Matrix J1 = Matrix::Random(4, NUM_DOFS);
+    J1.row(3) = J1.row(0) + 2 * J1.row(1);
+    Jbars.push_back(J1);
+
+    // A task that is entirely within the space of the first task
+    Jbars.push_back(Matrix::Random(2, 4) * J1);
+
+    // A task that uses up the remaining DOFs
+    Jbars.push_back(Matrix::Random(NUM_DOFS, NUM_DOFS));
+
+    // A task with nothing left to do
+    Jbars.push_back(Matrix::Random(3, NUM_DOFS));
+
+    for (size_t ii = 0; ii < Jbars.size(); ii++)
+        commands.push_back(Vector::Random(Jbars[ii].rows()));
+
+    compareHierarchies(W, Jbars, commands);
+}
+
+TEST(ReducedNullspaceTest, RankDeficientMatrix)
+{
+    // In double support UNcAiNorm loses the DOFs removed by the constraints,
+    // so it is only positive semi-definite.
+    int ranks[] = {NUM_DOFS - 12, NUM_DOFS - 6, 1};
+
+    for (int ii = 0; ii < 3; ii++)
+    {
+        Matrix W = randomPSD(NUM_DOFS, ranks[ii]);
+
+        ReducedNullspace nullspace;
+        ASSERT_TRUE(nullspace.reset(W));
+        EXPECT_EQ(ranks[ii], nullspace.getRank());
+
+        int taskDims[] = {6, 6, 3, 3, 6, 2};
+
+        std::vector<Matrix> Jbars;
+        std::vector<Vector> commands;
+        for (int jj = 0; jj < 6; jj++)
+        {
+            Jbars.push_back(Matrix::Random(taskDims[jj], NUM_DOFS));
+            commands.push_back(Vector::Random(taskDims[jj]));
+        }
+
+        compareHierarchies(W, Jbars, commands);
+    }
+}
+
+TEST(ReducedNullspaceTest, RejectsIndefiniteMatrix)
+{
+    Matrix W = randomSPD(NUM_DOFS);
+    W(0, 0) = -1;
+
+    ReducedNullspace nullspace;
+    EXPECT_FALSE(nullspace.reset(W));
+}
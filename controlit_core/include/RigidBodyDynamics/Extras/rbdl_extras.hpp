@@ -210,6 +210,26 @@ void calcRxnFrCOM(RigidBodyDynamics::Model& robot,
     std::vector<Math::VectorNd> & FrCOM,
     double sigmaThreshold = 0.0001);
 
+/*!
+ * Computes the expected reaction forces at the COM of the bodies in contact with the
+ * environment based on a robot model.  This is the same as the method above except
+ * the underactuation matrix is given by its index map.  See
+ * ConstraintSet::getUIndices().
+ *
+ * \param[in] UIndices The index map of the underactuation matrix.  Its length is
+ * # actuable DOFs.  Element ii is the index of the ii'th actuable joint in the
+ * RBDL model.
+ */
+void calcRxnFrCOM(RigidBodyDynamics::Model& robot,
+    const Math::VectorNd& Q,
+    const Math::MatrixNd& Ainv,
+    const std::vector<int>& UIndices,
+    const Math::VectorNd& grav,
+    const std::vector<unsigned int>& body_id,
+    const Math::VectorNd& Tau,
+    std::vector<Math::VectorNd> & FrCOM,
+    double sigmaThreshold = 0.0001);
+
 /*!
  * Computes the expected reaction forces at an arbitrary point on the bodies in contact
  * with the environment based on a robot model.
@@ -420,6 +440,340 @@ void calcCOPfromFr(RigidBodyDynamics::Model& robot,
     const Frame& contactNormalFrame = Frame::WORLD,
     const Frame& contactPlanePointFrame = Frame::WORLD,
     const Frame& COPFrame = Frame::LOCAL);
+/*!
+ * Computes the kinematics, the joint space inertia matrix, and the
+ * gravity and Coriolis/centrifugal joint torques of a robot in one forward
+ * and one backward pass over its bodies.  This replaces the sequence
+ * UpdateKinematicsCustom(Q), CompositeRigidBodyAlgorithm(...),
+ * InverseDynamics(Q, Qd, 0) and UpdateKinematicsCustom(Q, Qd, Qdd), each
+ * of which traverses the whole tree, and keeps the gravity and Coriolis
+ * torques separate rather than summing them like InverseDynamics does.
+ *
+ * The per-body quantities are stored as structure-of-arrays matrices whose
+ * columns are indexed by body ID.  They are allocated by init(...) so
+ * update(...) does not allocate memory.
+ *
+ * Only models whose movable bodies are all connected by single-DOF revolute
+ * or prismatic joints are supported.  This includes multi-DOF joints that
+ * RBDL splits into chains of single-DOF joints, like the 6-DOF virtual
+ * joint to the world.  isSupported() returns false for other models and
+ * the caller should use RBDL's own algorithms instead.
+ */
+class FusedDynamics
+{
+public:
+  /*!
+   * The constructor.
+   */
+  FusedDynamics();
+
+  /*!
+   * Caches the structure and inertias of a robot model.  This must be
+   * called again whenever the model's structure or inertias change.
+   *
+   * \param[in] robot The robot model.
+   * \return Whether the model is supported.
+   */
+  bool init(RigidBodyDynamics::Model & robot);
+
+  /*!
+   * \return Whether the model passed to the last call to init(...) is supported.
+   */
+  bool isSupported() const { return supported; }
+
+  /*!
+   * Updates the kinematics of the robot model and computes its dynamics.
+   * Afterwards, the transforms, velocities, and accelerations stored in
+   * the model are the same as after calling UpdateKinematicsCustom(robot,
+   * &Q, &Qd, &Qdd).
+   *
+   * \param[in] robot The robot model.  It must be the one passed to init(...).
+   * \param[in] Q The generalized joint positions.
+   * \param[in] Qd The generalized joint velocities.
+   * \param[in] Qdd The generalized joint accelerations.  They only affect
+   * the accelerations stored in the model.
+   * \param[out] H Where the joint space inertia matrix is stored.  It must
+   * be sized dof_count x dof_count.  Pass NULL to skip computing it.
+   * \param[out] gravity Where the joint torques due to gravity are stored.
+   * \param[out] coriolis Where the Coriolis and centrifugal joint torques
+   * are stored.
+   */
+  void update(RigidBodyDynamics::Model & robot, const Math::VectorNd & Q,
+    const Math::VectorNd & Qd, const Math::VectorNd & Qdd,
+    Math::MatrixNd * H, Math::VectorNd & gravity, Math::VectorNd & coriolis);
+
+private:
+  /*!
+   * Whether the last model passed to init(...) is supported.
+   */
+  bool supported;
+
+  /*!
+   * The number of bodies including the root body.
+   */
+  size_t numBodies;
+
+  /*!
+   * The parent of each body.
+   */
+  std::vector<unsigned int> parent;
+
+  /*!
+   * Whether each body's joint is revolute.  Otherwise it is prismatic.
+   */
+  std::vector<bool> revolute;
+
+  /*!
+   * The motion subspace of each body's joint.
+   */
+  Eigen::Matrix<double, 6, Eigen::Dynamic> S;
+
+  /*!
+   * The mass, first mass moment (mass times the COM), and rotational
+   * inertia about the body frame origin of each body.  The 3x3 inertia of
+   * body i is the i'th 3x3 block of bodyInertia.
+   */
+  Math::VectorNd bodyMass;
+  Eigen::Matrix<double, 3, Eigen::Dynamic> bodyMoment;
+  Eigen::Matrix<double, 3, Eigen::Dynamic> bodyInertia;
+
+  /*!
+   * The composite rigid body inertias in the same layout as the body inertias.
+   */
+  Math::VectorNd compositeMass;
+  Eigen::Matrix<double, 3, Eigen::Dynamic> compositeMoment;
+  Eigen::Matrix<double, 3, Eigen::Dynamic> compositeInertia;
+
+  /*!
+   * The spatial velocity and acceleration of each body, and its
+   * acceleration when Qdd is zero.
+   */
+  Eigen::Matrix<double, 6, Eigen::Dynamic> velocity;
+  Eigen::Matrix<double, 6, Eigen::Dynamic> acceleration;
+  Eigen::Matrix<double, 6, Eigen::Dynamic> biasAcceleration;
+
+  /*!
+   * The spatial forces acting on each body due to gravity and due to
+   * its velocity.
+   */
+  Eigen::Matrix<double, 6, Eigen::Dynamic> gravityForce;
+  Eigen::Matrix<double, 6, Eigen::Dynamic> coriolisForce;
+};
+
+/*!
+ * Estimates the reaction wrenches and centers of pressure (COPs) of a set of
+ * bodies in contact with the environment.  It computes the same quantities as
+ * calcRxnFrCOM(...), calcRxnFr(...) and calcCOPfromFrCOM(...), but all of its
+ * storage is allocated by init(...).  The kinematics of each body are computed
+ * once per update and shared by the wrench and COP computations, and the
+ * wrenches of all bodies are computed together using only matrix-vector
+ * products.
+ *
+ * The typical use within a servo or model update is:
+ *
+ *   estimator.updateKinematics(robot, Q);
+ *   estimator.estimateWrenches(Ainv, grav, UIndices, Tau);
+ *   estimator.computeCOPs(contactNormal, contactPlanePoint, Frame::WORLD);
+ *
+ * calcRxnFrCOM(...) and calcRxnFr(...) use a thread-local estimator, so they
+ * only allocate when the robot model or the contact bodies change.
+ */
+class ContactWrenchEstimator
+{
+public:
+  /*!
+   * The constructor.
+   */
+  ContactWrenchEstimator();
+
+  /*!
+   * Allocates the storage for a set of contact bodies.
+   *
+   * \param[in] robot The robot model.
+   * \param[in] body_id The IDs of the bodies that are in contact.
+   * \param[in] body_frame_point The points in the body frames at which
+   * getWrench(...) returns the reaction wrenches, e.g., the contact points.
+   * If empty, the COMs of the bodies are used.
+   */
+  void init(RigidBodyDynamics::Model & robot,
+    const std::vector<unsigned int> & body_id,
+    const std::vector<Math::Vector3d> & body_frame_point = std::vector<Math::Vector3d>());
+
+  /*!
+   * \return Whether init(...) was called with the given robot model and
+   * contact bodies, and with the COMs of the bodies as the wrench points.
+   */
+  bool isInitialized(const RigidBodyDynamics::Model & robot,
+    const std::vector<unsigned int> & body_id) const;
+
+  /*!
+   * Computes the positions and orientations of the contact bodies.  The
+   * kinematics of the model must be up to date.
+   *
+   * \param[in] robot The robot model passed to init(...).
+   * \param[in] Q The generalized joint positions.
+   */
+  void updatePoses(RigidBodyDynamics::Model & robot, const Math::VectorNd & Q);
+
+  /*!
+   * Computes the positions, orientations and COM Jacobians of the contact
+   * bodies.  The kinematics of the model must be up to date.
+   *
+   * \param[in] robot The robot model passed to init(...).
+   * \param[in] Q The generalized joint positions.
+   */
+  void updateKinematics(RigidBodyDynamics::Model & robot, const Math::VectorNd & Q);
+
+  /*!
+   * Estimates the reaction wrenches at the COMs of the contact bodies using
+   * the Jacobian computed by updateKinematics(...).
+   *
+   * \param[in] Ainv The inverse of the joint space inertia matrix.
+   * \param[in] grav The joint space gravity vector.
+   * \param[in] UIndices The index map of the underactuation matrix.  See
+   * ConstraintSet::getUIndices().
+   * \param[in] Tau The actuable joint efforts.
+   */
+  void estimateWrenches(const Math::MatrixNd & Ainv, const Math::VectorNd & grav,
+    const std::vector<int> & UIndices, const Math::VectorNd & Tau);
+
+  /*!
+   * The same as the method above except the command is given in the full
+   * joint space, i.e., U.transpose() * Tau.
+   *
+   * \param[in] fullTau The joint efforts.  Its length is # DOFs.
+   */
+  void estimateWrenches(const Math::MatrixNd & Ainv, const Math::VectorNd & grav,
+    const Math::VectorNd & fullTau);
+
+  /*!
+   * Estimates the reaction wrenches using a Jacobian computed elsewhere, for
+   * example the contact Jacobian of the constraint set.  The Jacobian of
+   * each contact body must be evaluated at the point passed to init(...).
+   * The reaction at each point is shifted to the COM of the body, so
+   * getWrenchCOM(...), getWrench(...) and computeCOPs(...) may all be used
+   * afterwards.  updatePoses(...) or updateKinematics(...) must be called
+   * first.
+   *
+   * \param[in] J The stacked Jacobians of the contact bodies.  Its
+   * dimensions are (sum of contactDOFs) x # DOFs.
+   * \param[in] contactDOFs The number of rows of J of each contact body.
+   * It is 3 for a point contact, whose rows are the linear Jacobian and
+   * which cannot exert a moment, or 6 for a contact whose rows are the
+   * linear followed by the angular Jacobian.
+   * \param[in] Ainv The inverse of the joint space inertia matrix.
+   * \param[in] grav The joint space gravity vector.
+   * \param[in] UIndices The index map of the underactuation matrix.
+   * \param[in] Tau The actuable joint efforts.
+   */
+  void estimateWrenches(const Math::MatrixNd & J, const std::vector<unsigned int> & contactDOFs,
+    const Math::MatrixNd & Ainv, const Math::VectorNd & grav,
+    const std::vector<int> & UIndices, const Math::VectorNd & Tau);
+
+  /*!
+   * Computes the COP of each contact body in the world frame from the
+   * wrenches at the COMs.  This uses the COM positions computed by
+   * updatePoses(...) or updateKinematics(...), so one of them must be
+   * called with the same joint positions as the wrench estimation.
+   *
+   * \param[in] contactNormal The contact normal of each body.
+   * \param[in] contactPlanePoint A point on the contact plane of each body.
+   * \param[in] contactFrame The frame of the contact normals and points.
+   */
+  void computeCOPs(const std::vector<Math::Vector3d> & contactNormal,
+    const std::vector<Math::Vector3d> & contactPlanePoint, const Frame & contactFrame);
+
+  /*!
+   * \return The number of contact bodies.
+   */
+  size_t getNumContacts() const { return bodyId.size(); }
+
+  /*!
+   * \return The stacked 6-row COM Jacobians of the contact bodies, with the
+   * linear part first.  This is computed by updateKinematics(...).
+   */
+  const Math::MatrixNd & getJacobian() const { return Jcom; }
+
+  /*!
+   * \return The reaction wrench (force followed by moment) at the COM of
+   * contact body ii in the world frame.
+   */
+  Eigen::VectorBlock<const Math::VectorNd, 6> getWrenchCOM(size_t ii) const
+  {
+    return wrenchCOM.segment<6>(6 * ii);
+  }
+
+  /*!
+   * \return The reaction wrench at the point of contact body ii passed to
+   * init(...) in the world frame.
+   */
+  Eigen::VectorBlock<const Math::VectorNd, 6> getWrench(size_t ii) const
+  {
+    return wrench.segment<6>(6 * ii);
+  }
+
+  /*!
+   * \return The COP of contact body ii in the world frame.
+   */
+  const Math::Vector3d & getCOP(size_t ii) const { return cop[ii]; }
+
+  /*!
+   * \return The position of the COM of contact body ii in the world frame.
+   */
+  const Math::Vector3d & getCOMPosition(size_t ii) const { return comPosition[ii]; }
+
+private:
+  /*!
+   * Computes wrench from wrenchCOM.
+   */
+  void shiftWrenches();
+
+  /*!
+   * The robot model passed to init(...).
+   */
+  const RigidBodyDynamics::Model * robotModel;
+
+  /*!
+   * The contact bodies and the points at which the wrenches are reported,
+   * and whether those points are the COMs of the bodies.
+   */
+  std::vector<unsigned int> bodyId;
+  std::vector<Math::Vector3d> bodyPoint;
+  bool pointsAreCOMs;
+
+  /*!
+   * The orientation (world to body), origin, COM, and wrench point of each
+   * contact body in the world frame.
+   */
+  std::vector<Math::Matrix3d> orientation;
+  std::vector<Math::Vector3d> origin;
+  std::vector<Math::Vector3d> comPosition;
+  std::vector<Math::Vector3d> pointPosition;
+
+  /*!
+   * The stacked COM Jacobians and the per-body scratch Jacobians.
+   */
+  Math::MatrixNd Jcom;
+  Math::MatrixNd Jv;
+  Math::MatrixNd Jw;
+
+  /*!
+   * Intermediate results of the wrench estimation.
+   */
+  Math::VectorNd fullTau;
+  Math::VectorNd jointSpace;
+  Math::VectorNd jointSpace2;
+  Math::VectorNd taskSpace;
+  Math::VectorNd pointRxn;
+
+  /*!
+   * The results.
+   */
+  Math::VectorNd wrenchCOM;
+  Math::VectorNd wrench;
+  std::vector<Math::Vector3d> cop;
+};
+
 } // namespace Extras
 } // namespace RigidBodyDynamics
 
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_ALLOCATION_CHECK_HPP__
+#define __CONTROLIT_CORE_ALLOCATION_CHECK_HPP__
+
+namespace controlit {
+
+/*!
+ * Forbids the calling thread from allocating heap memory while this object
+ * is in scope.  This is used to verify that the servo thread does not call
+ * malloc.
+ *
+ * The check only takes effect when ControlIt is built with
+ * CONTROLIT_CHECK_SERVO_ALLOCATIONS defined, in which case malloc, calloc,
+ * realloc, and posix_memalign are interposed and abort the process with a
+ * message if they are called within a NoAllocationScope.  Otherwise this
+ * class does nothing.  Attach a debugger to find the offending allocation.
+ *
+ * Scopes may be nested.
+ */
+class NoAllocationScope
+{
+public:
+    /*!
+     * The constructor.
+     *
+     * \param[in] enabled Whether to forbid allocations.  This allows the
+     * check to be skipped without restructuring the calling code, e.g.,
+     * during the first servo cycles while buffers are still being sized.
+     */
+    explicit NoAllocationScope(bool enabled = true);
+
+    /*!
+     * The destructor.  Allows allocations again unless an enclosing scope
+     * forbids them.
+     */
+    ~NoAllocationScope();
+
+    /*!
+     * \return Whether allocations are checked in this build.
+     */
+    static bool isCheckEnabled();
+
+    /*!
+     * \return Whether the calling thread is currently forbidden from
+     * allocating memory.
+     */
+    static bool isActive();
+
+private:
+    NoAllocationScope(const NoAllocationScope &) = delete;
+    NoAllocationScope & operator=(const NoAllocationScope &) = delete;
+
+    bool enabled;
+};
+
+/*!
+ * Temporarily allows allocations within a NoAllocationScope.  This marks
+ * code that is known to allocate but has not been moved off of the servo
+ * thread yet.
+ */
+class AllowAllocationScope
+{
+public:
+    /*!
+     * The constructor.
+     */
+    AllowAllocationScope();
+
+    /*!
+     * The destructor.
+     */
+    ~AllowAllocationScope();
+
+private:
+    AllowAllocationScope(const AllowAllocationScope &) = delete;
+    AllowAllocationScope & operator=(const AllowAllocationScope &) = delete;
+
+    int savedDepth;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_ALLOCATION_CHECK_HPP__
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_BATCH_EVALUATOR_HPP__
+#define __CONTROLIT_CORE_BATCH_EVALUATOR_HPP__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <controlit/addons/cpp/ThreadPool.hpp>
+#include <controlit/Command.hpp>
+#include <controlit/CompoundTask.hpp>
+#include <controlit/ControlModel.hpp>
+#include <controlit/Controller.hpp>
+#include <controlit/ControllerFactory.hpp>
+#include <controlit/CompoundTaskFactory.hpp>
+#include <controlit/Parameter.hpp>
+#include <controlit/RobotState.hpp>
+#include <controlit/SingleThreadedTaskUpdater.hpp>
+#include <controlit/utility/ControlItParameters.hpp>
+
+namespace controlit {
+
+using controlit::addons::eigen::Vector;
+using controlit::addons::eigen::Matrix;
+
+/*!
+ * A batch of robot states and task goals.  Each column of the matrices
+ * is one sample.
+ */
+struct BatchInput
+{
+    /*!
+     * The joint positions, including the virtual joints.  This has
+     * getNumDOFs() rows.
+     */
+    Matrix Q;
+
+    /*!
+     * The joint velocities, including the virtual joints.  This has
+     * getNumDOFs() rows.
+     */
+    Matrix Qd;
+
+    /*!
+     * The values of the goal parameters in the order in which they were
+     * added by addGoalParameter(...).  Each matrix has as many rows as its
+     * parameter has elements.
+     */
+    std::vector<Matrix> goals;
+};
+
+/*!
+ * The results of evaluating a batch.  Each column of the matrices is one
+ * sample.
+ */
+struct BatchOutput
+{
+    /*!
+     * The effort commands.  This has getNumActuatedDOFs() rows.
+     */
+    Matrix effort;
+
+    /*!
+     * Whether the command of each sample was computed.  The efforts of
+     * the failed samples are zero.
+     */
+    std::vector<unsigned char> success;
+
+    /*!
+     * The wall clock time it took to evaluate the batch in seconds.
+     */
+    double duration;
+
+    /*!
+     * The number of samples evaluated per second.
+     */
+    double samplesPerSecond;
+};
+
+/*!
+ * Evaluates the controller for batches of robot states and task goals
+ * offline, e.g., to tune gains or to benchmark the controller.  Each
+ * sample updates the control model, updates the states of all tasks, and
+ * computes the command, independent of the other samples.
+ *
+ * The samples are split among a number of workers, each of which owns a
+ * clone of the control model, the compound task, and the controller, so
+ * the workers never share state.  The calling thread is worker zero.
+ *
+ * Since a worker evaluates many samples in sequence, the output of a
+ * sample would depend on the samples before it, and thus on the number of
+ * workers, if the controller or a task kept state across cycles.  Such
+ * configurations are rejected by init(...): controllers whose
+ * hasCycleState() is true and tasks whose PD controllers have integralOn
+ * set.  Held projections are disabled.
+ *
+ * The controller and its tasks are loaded from the same ROS parameters as
+ * the Coordinator's, but no robot interface or servo clock is needed.
+ * ROS must be initialized because the controllers publish diagnostics.
+ */
+class BatchEvaluator
+{
+public:
+    /*!
+     * The constructor.
+     */
+    BatchEvaluator();
+
+    /*!
+     * The destructor.
+     */
+    ~BatchEvaluator();
+
+    /*!
+     * Initializes this evaluator using the parameters in the namespace of
+     * the node handle.
+     *
+     * \param[in] nh The ROS node handle.
+     * \param[in] numWorkers The number of workers, including the calling
+     * thread.
+     * \return Whether the initialization was successful.  This is false
+     * if the controller or a task keeps state across cycles.
+     */
+    bool init(ros::NodeHandle & nh, size_t numWorkers);
+
+    /*!
+     * Adds a task parameter that is set from BatchInput::goals before each
+     * sample is evaluated.  It must be a real or vector parameter.
+     *
+     * \param[in] name The name of the parameter, e.g.,
+     * "RightHandPosition.goalPosition".
+     * \return Whether the parameter was added.
+     */
+    bool addGoalParameter(const std::string & name);
+
+    /*!
+     * Evaluates a batch.  This is not thread safe.
+     *
+     * \param[in] input The samples to evaluate.
+     * \param[out] output The results.
+     * \return Whether the input was valid.  Samples whose command could
+     * not be computed are reported in BatchOutput::success.
+     */
+    bool evaluate(const BatchInput & input, BatchOutput & output);
+
+    /*!
+     * \return The number of DOFs, including the virtual DOFs.
+     */
+    int getNumDOFs() const;
+
+    /*!
+     * \return The number of actuated DOFs.
+     */
+    int getNumActuatedDOFs() const;
+
+    /*!
+     * \return The names of the actuated joints in the order of the effort
+     * commands.
+     */
+    const std::vector<std::string> & getActuatedJointNames() const;
+
+    /*!
+     * \return The number of workers.
+     */
+    size_t getNumWorkers() const { return workers.size(); }
+
+private:
+    /*!
+     * The clones of the controller used by one worker.
+     */
+    struct Worker
+    {
+        RobotState robotState;
+        std::unique_ptr<ControlModel> model;
+        std::unique_ptr<CompoundTask> compoundTask;
+        SingleThreadedTaskUpdater taskUpdater;
+        std::unique_ptr<Controller> controller;
+        Command command;
+
+        /*!
+         * The goal parameters of this worker's compound task.
+         */
+        std::vector<Parameter *> goals;
+
+        /*!
+         * Holds the value of each vector goal parameter.
+         */
+        std::vector<Vector> goalBuffers;
+
+        /*!
+         * Holds the joint state of the current sample.
+         */
+        Vector Q, Qd, Qdd;
+    };
+
+    /*!
+     * Creates the clones of a worker.
+     *
+     * \param[in] nh The ROS node handle.
+     * \param[in] worker The worker to initialize.
+     * \return Whether the initialization was successful.
+     */
+    bool initWorker(ros::NodeHandle & nh, Worker & worker);
+
+    /*!
+     * Checks that the samples evaluated by a worker do not affect each
+     * other.
+     *
+     * \param[in] worker The worker to check.
+     * \return Whether neither the controller nor a task keeps state
+     * across cycles.
+     */
+    bool checkStateless(Worker & worker) const;
+
+    /*!
+     * Evaluates a worker's share of the current batch.  This does not
+     * throw; a sample that throws is reported as failed.
+     *
+     * \param[in] index The index of the worker.
+     */
+    void runJob(size_t index);
+
+    /*!
+     * Evaluates a single sample.
+     *
+     * \param[in] worker The worker to use.
+     * \param[in] sample The index of the sample in the current batch.
+     * \return Whether the command was computed.
+     */
+    bool evaluateSample(Worker & worker, size_t sample);
+
+    /*!
+     * Whether this evaluator is initialized.
+     */
+    bool initialized;
+
+    /*!
+     * The parameters shared by all workers.  The controllers only read
+     * them while computing commands.
+     */
+    controlit::utility::ControlItParameters controlitParameters;
+
+    /*!
+     * Creates the controllers.  This must outlive them.
+     */
+    ControllerFactory controllerFactory;
+
+    /*!
+     * Creates the compound tasks.
+     */
+    CompoundTaskFactory compoundTaskFactory;
+
+    /*!
+     * The URDF and YAML descriptions from which the workers are cloned.
+     */
+    std::string urdfDescription;
+    std::string yamlParameters;
+
+    /*!
+     * The names of the goal parameters.
+     */
+    std::vector<std::string> goalNames;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /*!
+     * Runs the jobs of workers 1 to N - 1.
+     */
+    std::unique_ptr<controlit::addons::cpp::ThreadPool> threadPool;
+    std::vector<controlit::addons::cpp::ThreadPool::Job_t> jobs;
+
+    /*!
+     * The number of jobs that the helper threads have yet to finish.
+     */
+    std::atomic<size_t> pendingJobs;
+
+    /*!
+     * The batch that is being evaluated.
+     */
+    const BatchInput * currentInput;
+    BatchOutput * currentOutput;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_BATCH_EVALUATOR_HPP__
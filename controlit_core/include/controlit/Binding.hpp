@@ -50,6 +50,14 @@ public:
      */
     bool isForParameter(const Parameter * param) const;
 
+    /*!
+     * Checks the transport layer for new data and applies it to the parameter.
+     * This is called once per servo cycle by the servo thread.  Bindings that
+     * receive data asynchronously, e.g., through ROS callbacks, do not need to
+     * override this method.
+     */
+    virtual void poll() {}
+
     /*!
      * \return A string representation of this class.
      */
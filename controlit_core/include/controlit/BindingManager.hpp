@@ -83,6 +83,12 @@ public:
      */
     virtual bool unbindParameters(ParameterReflection & pr);
 
+    /*!
+     * Polls every binding for new data.  This is called once per servo cycle
+     * by the servo thread.
+     */
+    void pollBindings();
+
 private:
 
     /*!
@@ -21,7 +21,9 @@
 #ifndef __CONTROLIT_CORE_COMPOUND_TASK_HPP__
 #define __CONTROLIT_CORE_COMPOUND_TASK_HPP__
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
@@ -30,6 +32,8 @@
 #include <controlit/ReflectionRegistry.hpp>
 #include <controlit/TaskUpdater.hpp>
 #include <controlit/BindingManager.hpp>
+#include <controlit/ParallelLoop.hpp>
+#include <controlit/addons/cpp/ThreadPool.hpp>
 #include <yaml-cpp/yaml.h>
 
 namespace controlit {
@@ -194,10 +198,62 @@ public:
      * \param taskTypes[out] The type of the commands at each priority level.
      * All tasks at a particular priority level are assumed to be of the same type.
      *
+     * The method runs in two phases.  First the commands of all enabled
+     * tasks are computed, in parallel if helpers were configured via
+     * setCommandThreads(...) or setCommandWorkerPool(...).  Then the task Jacobians and commands are
+     * copied directly into the per-level matrices and vectors.  The output
+     * containers are only resized when the number of enabled task dimensions
+     * changes, so callers should keep them across servo cycles.
+     *
      * \return Whether the method call was successful.
      */
     bool getJacobianAndCommand(ControlModel & model, TaskJacobians & Jt,
-        TaskCommands & Command, TaskTypes & Type) const;
+        TaskCommands & Command, TaskTypes & Type);
+
+    /*!
+     * Configures the helper threads used to compute task commands in parallel.
+     * Task commands are computed serially on the calling thread by default.
+     *
+     * Note that Task::getCommand(...) must be safe to call concurrently on
+     * different tasks when helper threads are used.  In particular it should
+     * not update the kinematics stored in the ControlModel.  A task may set
+     * its own parameters, e.g., its error or integral term, since
+     * Parameter::set(...) is serialized with the input bindings that write
+     * the same parameter.
+     *
+     * \param[in] numThreads The number of helper threads.  The servo thread
+     * also computes task commands so zero means serial operation.
+     * \param[in] cpus The CPUs to which the helper threads should be pinned.
+     * Helper thread i is pinned to cpus[i % cpus.size()].  If this is empty
+     * the helper threads are not pinned.
+     * \return Whether the helper threads were successfully created and pinned.
+     */
+    bool setCommandThreads(size_t numThreads, const std::vector<int> & cpus);
+
+    /*!
+     * Computes task commands in parallel on jobs of a worker pool that is
+     * shared with other controllers instead of on threads of this object.
+     * The same restrictions on Task::getCommand(...) apply as with
+     * setCommandThreads(...).
+     *
+     * \param[in] pool The worker pool.
+     * \param[in] account The account of the controller that owns this object.
+     * \param[in] numHelpers The number of jobs that help the servo thread.
+     */
+    void setCommandWorkerPool(WorkerPool * pool, WorkerPool::Account * account, size_t numHelpers);
+
+    /*!
+     * Gets the version of the stacked Jacobian of a priority level, as written
+     * by the most recent call to getJacobianAndCommand(...).  The version
+     * changes whenever the set of enabled tasks at the level changes or one of
+     * their Jacobians changes, so callers can reuse products computed from an
+     * unchanged stacked Jacobian.  Unchanged stacked Jacobians are not copied
+     * again, so callers must not modify the Jacobian matrices between calls.
+     *
+     * \param[in] priorityLevel The priority level.
+     * \return The version of the stacked Jacobian at the priority level.
+     */
+    unsigned long long getJacobianVersion(size_t priorityLevel) const;
   
     /*!
      * Dumps the state of this CompoundTask into a string.
@@ -238,6 +294,104 @@ private:
      * from a scalar into a vector, if necessary.
      */
     int numActuableDOFs;
+
+    /*!
+     * Computes the commands of the tasks in enabledTasks, storing them in
+     * taskCommandBuffer.  This is the first phase of getJacobianAndCommand(...).
+     *
+     * \param[in] model The robot model.
+     * \return Whether every task command was successfully computed.
+     */
+    bool computeTaskCommands(ControlModel & model);
+
+    /*!
+     * Computes the command of an enabled task.
+     *
+     * \param[in] task The index of the task in enabledTasks.
+     * \param[in] helper Whether this runs on a helper rather than on the
+     * servo thread.
+     */
+    void runCommandJob(size_t task, bool helper);
+
+    /*!
+     * Computes the task commands on the servo thread and the helpers.
+     * This must be declared before commandThreadPool, which must be
+     * destroyed first.
+     */
+    ParallelLoop commandHelpers;
+
+    /*!
+     * The body of the loop run by commandHelpers.  It is created once so
+     * that no memory is allocated when the loop runs.
+     */
+    ParallelLoop::Body commandBody;
+
+    /*!
+     * The helper threads that compute task commands.  This is nullptr when
+     * task commands are computed serially or by worker pool jobs.
+     */
+    std::unique_ptr<controlit::addons::cpp::ThreadPool> commandThreadPool;
+
+    /*!
+     * The model passed to the current call to getJacobianAndCommand(...).
+     */
+    ControlModel * commandModel;
+
+    /*!
+     * The tasks that are enabled during the current servo cycle, in order
+     * of priority.  This is captured once per cycle so that both phases of
+     * getJacobianAndCommand(...) see the same set of tasks.
+     */
+    std::vector<Task *> enabledTasks;
+
+    /*!
+     * The index into enabledTasks of the first task at each priority level.
+     * Its length is one greater than the number of priority levels.
+     */
+    std::vector<size_t> levelOffsets;
+
+    /*!
+     * The commands of the enabled tasks.  Element i belongs to enabledTasks[i].
+     */
+    std::vector<TaskCommand> taskCommandBuffer;
+
+    /*!
+     * Whether the command of each enabled task was successfully computed.
+     */
+    std::vector<char> commandSucceeded;
+
+    /*!
+     * Records what was last stacked into the Jacobian of a priority level.
+     */
+    struct StackedLevel
+    {
+        StackedLevel() : data(nullptr), version(0) {}
+
+        /*!
+         * The tasks whose Jacobians were stacked, in order.
+         */
+        std::vector<Task *> tasks;
+
+        /*!
+         * The Jacobian versions of the tasks when they were stacked.
+         */
+        std::vector<unsigned long long> versions;
+
+        /*!
+         * The storage of the matrix into which the Jacobians were stacked.
+         */
+        const double * data;
+
+        /*!
+         * The version of the stacked Jacobian.
+         */
+        unsigned long long version;
+    };
+
+    /*!
+     * What was last stacked into the Jacobian of each priority level.
+     */
+    std::vector<StackedLevel> stackedLevels;
 };
 
 } // namespace controlit
@@ -22,6 +22,7 @@
 #define __CONTROLIT_CORE_CONSTRAINT_HPP__
 
 #include <string>
+#include <vector>
 #include <rbdl/rbdl.h>
 #include <yaml-cpp/yaml.h>
 
@@ -34,6 +35,24 @@ namespace controlit {
  */
 class Constraint : public PlanElement
 {
+public:
+
+    /*!
+     * A non-zero element of a sparse constraint Jacobian.  The row is
+     * relative to the first row of this constraint's Jacobian.
+     */
+    struct JacobianEntry
+    {
+        unsigned int row;
+        unsigned int col;
+        double value;
+    };
+
+    /*!
+     * The non-zero elements of a sparse constraint Jacobian.
+     */
+    typedef std::vector<JacobianEntry> SparseJacobian_t;
+
 protected:
 
     /*!
@@ -145,6 +164,26 @@ public:
      */
     virtual void getJacobian(RigidBodyDynamics::Model& robot, const Vector& Q, Matrix& Jc) = 0;
 
+    /*!
+     * Returns true if this constraint's Jacobian has a fixed sparsity pattern
+     * between calls to init(...).  Such constraints provide their Jacobian
+     * through getSparseJacobian(...), which allows the constraint set to
+     * update only the non-zero elements.
+     *
+     * \return Whether getSparseJacobian(...) is implemented.
+     */
+    virtual bool hasSparseJacobian() const { return false; }
+
+    /*!
+     * An accessor for the non-zero elements of the constraint's Jacobian matrix.
+     * Only valid if hasSparseJacobian() returns true.
+     *
+     * \param[in] robot the robot model.
+     * \param[in] Q The current joint state of the robot.
+     * \param[out] Jc The non-zero elements of the constraint's Jacobian matrix.
+     */
+    virtual void getSparseJacobian(RigidBodyDynamics::Model& robot, const Vector& Q, SparseJacobian_t & Jc) {}
+
 protected:
 
     /*!
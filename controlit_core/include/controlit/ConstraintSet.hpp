@@ -26,13 +26,16 @@
 #include <rbdl/rbdl.h>
 
 #include <controlit/ReflectionRegistry.hpp>
+#include <controlit/Constraint.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <controlit/addons/eigen/SelectionMatrix.hpp>
 
 namespace controlit {
 
-class Constraint;
 class ConstraintFactory;
 
+using controlit::addons::eigen::SelectionIndices;
+
 /*!
  * A container class for constraint objects.
  */
@@ -90,6 +93,35 @@ public:
      * \param[in] Ainv The current Ainv.
      */
     void update(RigidBodyDynamics::Model & robot, const Vector & Q, const Matrix & Ainv);
+
+    /*!
+     * The steps of update(...), for callers that run them concurrently.
+     * beginUpdate(...) must be called first.  Then updateJacobian(...) is
+     * called for every constraint, possibly concurrently for different
+     * constraints.  Finally updateProjections(...) is called.
+     *
+     * \param[in] robot The RBDL model.
+     */
+    void beginUpdate(RigidBodyDynamics::Model & robot);
+
+    /*!
+     * Updates the rows of Jc that belong to one constraint.  This does
+     * nothing if the constraint is disabled.  It does not update the
+     * kinematics of the robot model, so it may run concurrently with other
+     * computations that only read the model.
+     *
+     * \param[in] robot The RBDL model.
+     * \param[in] Q The current joint positions.
+     * \param[in] index The index of the constraint in getConstraintSet().
+     */
+    void updateJacobian(RigidBodyDynamics::Model & robot, const Vector & Q, size_t index);
+
+    /*!
+     * Updates JcBar, Nc, UNc, UNcAiNorm and UNcBar from Jc.
+     *
+     * \param[in] Ainv The current Ainv.
+     */
+    void updateProjections(const Matrix & Ainv);
   
     /*!
      * Gets the constraint set.
@@ -150,6 +182,16 @@ public:
      * \return The underactution matrix U.
      */
     const Matrix& getU() const {return U_;}
+
+    /*!
+     * Gets the index map of U.  Element ii is the column of the one
+     * in row ii of U, i.e., the index of the ii'th actuable DOF within
+     * the full joint vector.  Use this with the functions in
+     * controlit/addons/eigen/SelectionMatrix.hpp instead of multiplying by U.
+     *
+     * \return The index map of the underactuation matrix.
+     */
+    const SelectionIndices & getUIndices() const {return UIndices_;}
   
   
     /*!
@@ -169,6 +211,14 @@ public:
      * \return The underactution matrix virtualU.
      */
     const Matrix& getVirtualU() const {return virtualU_;}
+
+    /*!
+     * Gets the index map of virtualU.  Element ii is the index of the
+     * ii'th real DOF within the full joint vector.
+     *
+     * \return The index map of virtualU.
+     */
+    const SelectionIndices & getVirtualUIndices() const {return virtualUIndices_;}
   
     /*!
      * Gets Jc, the Jacobian matrix of the constraints.
@@ -304,15 +354,22 @@ public:
      * in the text dump.
      */
     void dump(std::ostream& os, std::string const& prefix) const;
-  
-private:
+
     /*!
-     * Recomputes the constraint Jacobian.
+     * Determines whether the set of enabled constraints have changed
+     * since init(...) was last called.
      *
-     * \param robot The robot model.
+     * \return true if the set of enabled constraints have changed.
      */
-    void updateJc(RigidBodyDynamics::Model& robot, const Vector& Q);
+    bool enableSetChanged();
   
+private:
+    /*!
+     * The ModelPredictor overwrites UNcBar_ and UNcAiNorm_ with their
+     * predicted values.
+     */
+    friend class ModelPredictor;
+
     /*!
      * Resizes member matrix variables.
      *
@@ -364,6 +421,16 @@ private:
      * Its dimensions are: (# real DOFs x # DOFs)
      */
     Matrix virtualU_;
+
+    /*!
+     * The index map of U_.  Its length is the number of actuable DOFs.
+     */
+    SelectionIndices UIndices_;
+
+    /*!
+     * The index map of virtualU_.  Its length is the number of real DOFs.
+     */
+    SelectionIndices virtualUIndices_;
   
     /*!
      * The concatenated Jacobian of the constraints in this constraint set.
@@ -399,6 +466,33 @@ private:
      * Dynamically consistent psuedo-inverse of U*Nc (???)
      */
     Matrix UNcBar_;
+
+    /*!
+     * The product Ainv * UNc_.transpose().  It is shared by the
+     * computations of UNcAiNorm_ and UNcBar_.
+     * Its dimensions are: (# DOFs x # actuable DOFs)
+     */
+    Matrix AinvUNcT_;
+
+    /*!
+     * Storage for the Jacobians of the enabled constraints that do not have
+     * a sparse Jacobian.  It is indexed the same way as constraintSet_.
+     * This avoids allocating a new matrix for every constraint in every update.
+     */
+    std::vector<Matrix> constraintJacobians_;
+
+    /*!
+     * Storage for the non-zero elements of the sparse constraint Jacobians.
+     * It is indexed the same way as constraintSet_ so that the Jacobians of
+     * different constraints can be updated concurrently.
+     */
+    std::vector<Constraint::SparseJacobian_t> sparseJacobians_;
+
+    /*!
+     * The first row of each enabled constraint in Jc_, or -1 for disabled
+     * constraints.  It is indexed the same way as constraintSet_.
+     */
+    std::vector<int> constraintRows_;
   
     /*!
      * Identity matrix with size = # columns in Jc_.
@@ -426,14 +520,6 @@ private:
      */
     ActuatedJointIds_t actuatedJointIndices;
   
-    /*!
-     * Determines whether the set of enabled constraints have changed
-     * since init(...) was last called.
-     *
-     * \return true if the set of enabled constraints have changed.
-     */
-    bool enableSetChanged();
-  
     /*!
      * This holds the enabled state of the constraints at the time when init(..) was
      * called. It is used by method enableSetChanged().
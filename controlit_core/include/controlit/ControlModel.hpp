@@ -31,6 +31,9 @@
 #include <controlit/RobotState.hpp>
 #include <controlit/ConstraintSet.hpp>
 #include <controlit/VirtualLinkageModel.hpp>
+#include <controlit/GeneratedDynamicsFactory.hpp>
+#include <controlit/ModelUpdateGraph.hpp>
+#include <RigidBodyDynamics/Extras/rbdl_extras.hpp>
 #include <controlit/utility/ControlItParameters.hpp>
 
 // For checking validity of 'A' matrix after it is updated
@@ -193,6 +196,35 @@ public:
    */
   RigidBodyDynamics::Model const& rbdlModel() const;
 
+  /*!
+   * \return The dynamics generated for this robot, or nullptr if they are
+   * not in use.  Their calcPointJacobian(...) may be used in place of RBDL's
+   * CalcPointJacobian(...) after update() is called.
+   */
+  GeneratedDynamics * getGeneratedDynamics() { return generatedDynamics_.get(); }
+
+  /*!
+   * Sets the threads that run the independent steps of update() concurrently.
+   *
+   * \param[in] pool The thread pool, or nullptr to run update() on the
+   * calling thread only.  It must not be used by anything else while
+   * update() runs.
+   */
+  void setUpdateThreadPool(controlit::addons::cpp::ThreadPool * pool) { updateGraph_.setThreadPool(pool); }
+
+  /*!
+   * Runs the independent steps of update() concurrently on jobs of a worker
+   * pool that is shared with other controllers.
+   *
+   * \param[in] pool The worker pool.
+   * \param[in] account The account of the jobs.
+   * \param[in] numHelpers The number of jobs that help the calling thread.
+   */
+  void setUpdateWorkerPool(WorkerPool * pool, WorkerPool::Account * account, size_t numHelpers)
+  {
+    updateGraph_.setWorkerPool(pool, account, numHelpers);
+  }
+
   //! Convienence function to grab the link name to joint name map
   LinkNameToJointNameMap_t& linkNameToJointNameMap();
   LinkNameToJointNameMap_t const& linkNameToJointNameMap() const;
@@ -214,6 +246,28 @@ public:
    */
   void update();
 
+  /*!
+   * Partially updates this control model.  Only the kinematics and the
+   * gravity vector are recomputed.  The inertia matrix and the constraint
+   * set and virtual linkage model keep the values from the last call to
+   * update(), so this should only be used while the joint positions remain
+   * close to getFullUpdateQ().  The same preconditions as update() apply.
+   *
+   * If the ModelPredictor overwrote the constraint set's projection matrices
+   * since the last call to update(), they no longer match any joint state,
+   * so a full update is done instead.
+   */
+  void updateGravity();
+
+  /*!
+   * Returns the joint positions at the last call to update().  These are
+   * the joint positions at which the inertia matrix and the constraint
+   * set were computed.
+   *
+   * \return The joint positions at the last full update.
+   */
+  inline const Vector & getFullUpdateQ() const {return fullUpdateQ_;}
+
   /*!
    * Updates the state of the robot's joints (both real and virtual).
    * This uses the information contained within member variable 'latestJointState'.
@@ -264,7 +318,12 @@ public:
    * \note The cost of this method includes a memory allocation and copy operation!
    * \return A vector containing the joint positions of the actuable joints.
    */
-  inline const Vector getActuableQ() const { return constraints_->getU() * Q_; }
+  inline const Vector getActuableQ() const
+  {
+    Vector actuableQ(getNActuableDOFs());
+    controlit::addons::eigen::selectRows(constraints_->getUIndices(), Q_, actuableQ);
+    return actuableQ;
+  }
 
   /*!
    * Returns the joint velocities (both virtual and real).
@@ -280,7 +339,12 @@ public:
    * \note The cost of this method includes a memory allocation and copy operation!
    * \return A vector containing the velocities of the actuable joints.
    */
-  inline const Vector getActuableQd() const { return constraints_->getU() * Qd_; }
+  inline const Vector getActuableQd() const
+  {
+    Vector actuableQd(getNActuableDOFs());
+    controlit::addons::eigen::selectRows(constraints_->getUIndices(), Qd_, actuableQd);
+    return actuableQd;
+  }
 
   /*!
    * Returns the joint accelerations (both virtual and real).
@@ -324,6 +388,24 @@ public:
    */
   inline Vector const & getGrav() const {return grav_;}
 
+  /*!
+   * Returns the part of the gravity vector that is due to gravity alone.
+   * The rest of it, getCoriolis(), is due to the Coriolis and centrifugal
+   * forces.  The gravity mask is applied to both.  They are not
+   * extrapolated by the ModelPredictor.
+   *
+   * \return A reference to the joint torques due to gravity.
+   */
+  inline Vector const & getGravOnly() const {return gravOnly_;}
+
+  /*!
+   * Returns the part of the gravity vector that is due to the Coriolis and
+   * centrifugal forces.
+   *
+   * \return A reference to the Coriolis and centrifugal joint torques.
+   */
+  inline Vector const & getCoriolis() const {return coriolis_;}
+
   /*!
    * Obtains the Frame ID from the name of the body or its joint
    * (also allowing for "world").
@@ -442,6 +524,15 @@ public:
    */
   void getLatestFullState(Vector & Q, Vector & Qd);
 
+  /*!
+   * A version of getLatestFullState(...) that stores the joint state in
+   * memory that the caller provides, e.g., from a ScratchArena.
+   *
+   * \param Q[out] the joint position.  Its size must be getNumDOFs().
+   * \param Qd[out] the joint velocity.  Its size must be getNumDOFs().
+   */
+  void getLatestFullState(Eigen::Ref<Vector> Q, Eigen::Ref<Vector> Qd);
+
   /*!
    * Returns the age of this ControlModel.  The age is the amount of
    * time that has passed since the joint states were last updated.
@@ -487,7 +578,37 @@ public:
    */
   void setStale() { isStale_ = true; }
 
+  /*!
+   * Returns whether the ModelPredictor overwrote the gravity vector and the
+   * constraint set's projection matrices with predicted values since the
+   * last call to update().
+   */
+  bool hasPredictedValues() const { return hasPredictedValues_; }
+
 private:
+  /*!
+   * The ModelPredictor overwrites grav_ with its predicted value.
+   */
+  friend class ModelPredictor;
+
+  /*!
+   * Computes gravOnly_ and coriolis_ and updates the kinematics using RBDL's
+   * algorithms.  This is used when neither generatedDynamics_ nor fusedDynamics_
+   * support the model.
+   */
+  void updateGravAndCoriolisRBDL();
+
+  /*!
+   * Builds updateGraph_.  It has one step per constraint, so reinit()
+   * rebuilds it.
+   */
+  void buildUpdateGraph();
+
+  /*!
+   * Applies gravMask_ to gravOnly_ and coriolis_ and sets grav_ to their sum.
+   */
+  void applyGravMask();
+
   /*!
    * Whether the init(...) method was called.
    */
@@ -500,6 +621,12 @@ private:
    */
   bool isStale_;
 
+  /*!
+   * Whether the ModelPredictor overwrote grav_ and the constraint set's
+   * projection matrices since the last call to update().
+   */
+  bool hasPredictedValues_;
+
   /*!
    * A pointer to the latest robot state.  Note that this is potentially
    * newer than the values in Q_, Qd_, and Qdd_.
@@ -566,11 +693,53 @@ private:
    */
   Vector grav_;
 
+  /*!
+   * The parts of grav_ due to gravity and due to the Coriolis and centrifugal forces.
+   */
+  Vector gravOnly_;
+  Vector coriolis_;
+
   /*!
    * A "mask" on the grav_ vector to turn gravity compensation off for some joints but not for others
    */
   Vector gravMask_;
 
+  /*!
+   * Computes the kinematics, A_, gravOnly_, and coriolis_ in a single pass
+   * over the RBDL model when the model is supported.
+   */
+  RigidBodyDynamics::Extras::FusedDynamics fusedDynamics_;
+
+  /*!
+   * The steps of update() that follow the dynamics computation: Ainv_, the
+   * ConstraintSet, and the VirtualLinkageModel.
+   */
+  ModelUpdateGraph updateGraph_;
+
+  /*!
+   * Loads the generated dynamics plugin named by the
+   * controlit/generated_dynamics_type parameter.  It is declared before
+   * generatedDynamics_ so that it outlives the plugin instance.
+   */
+  std::unique_ptr<GeneratedDynamicsFactory> generatedDynamicsFactory_;
+
+  /*!
+   * The dynamics generated for this specific robot, or nullptr if no
+   * generated dynamics are configured or they do not match the model.
+   * When present, these are used instead of fusedDynamics_.
+   */
+  std::unique_ptr<GeneratedDynamics> generatedDynamics_;
+
+  /*!
+   * The joint positions at the last full update.
+   */
+  Vector fullUpdateQ_;
+
+  /*!
+   * A vector of zeros for computing the gravity vector with RBDL.
+   */
+  Vector zeroQdd_;
+
   /*!
    * The constraint set.
    */
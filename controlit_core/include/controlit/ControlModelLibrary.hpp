@@ -22,6 +22,7 @@
 #define __CONTROLIT_CONTROL_MODEL_LIBRARY_HPP__
 
 #include <controlit/ContactConstraint.hpp>
+#include <controlit/utility/ControlItParameters.hpp>
 #include <RigidBodyDynamics/Extras/rbdl_extras.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
 #include <rbdl/rbdl.h>
@@ -30,7 +31,7 @@ namespace controlit {
 
 using RigidBodyDynamics::Math::SpatialVector;
 using RigidBodyDynamics::Math::Xtrans;
-// using RigidBodyDynamics::Math::Vector3d;
+using controlit::addons::eigen::Vector3d;
 
 struct ControlModelLibrary
 {
@@ -100,11 +101,15 @@ struct ControlModelLibrary
     // Build a constraint set
     ConstraintSet * constraintSet = new ConstraintSet;
 
-    robotState->init(model->dof_count - joint1.mDoFCount); // subtract the number of virtual joints
+    // The control model keeps a pointer to its parameters, so they must
+    // outlive every model this library creates
+    static controlit::utility::ControlItParameters params;
 
     // Create and initialize the control model
     controlit::ControlModel * controlModel = new controlit::ControlModel();
-    controlModel->init(model, robotState, linkNameToJointNameMap, constraintSet);
+    controlModel->init(model, robotState.get(), linkNameToJointNameMap, constraintSet, &params);
+
+    robotState->init(controlModel->getRealJointNamesVector());
 
     // Create some fake data
     // Vector Q(controlModel->rbdlModel().dof_count); Q.setZero(); Q(6) = 0.2;
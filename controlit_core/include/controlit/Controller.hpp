@@ -71,6 +71,28 @@ public:
      * \return Whether the command was successfully computed.
      */
     virtual bool computeCommand(ControlModel & model, CompoundTask & compoundTask, Command & command) = 0;
+
+    /*!
+     * Makes the controller reuse the projected Jacobians of the lowest task
+     * priority levels from previous servo cycles instead of recomputing
+     * them every cycle.  This sheds load when the servo loop overruns.
+     * Controllers that do not project the tasks ignore this.
+     *
+     * \param[in] numLevels The number of lowest priority levels whose
+     * projections are reused.  Zero recomputes all projections every cycle.
+     * \param[in] maxCycles The maximum number of consecutive cycles for which
+     * the projections are reused before they are recomputed.
+     */
+    virtual void setHeldProjections(size_t numLevels, int maxCycles) {}
+
+    /*!
+     * Whether the command depends on the previous servo cycles, e.g.,
+     * because the controller integrates an internal model over time.
+     * Such controllers cannot evaluate independent samples.
+     *
+     * \return Whether this controller keeps state across cycles.
+     */
+    virtual bool hasCycleState() const { return false; }
     
     /*!
      * Prints a string description of this class to the supplied output
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_CONTROLLER_CLOCK_HPP__
+#define __CONTROLIT_CORE_CONTROLLER_CLOCK_HPP__
+
+#include <chrono>
+#include <cstdint>
+
+namespace controlit {
+
+using std::chrono::high_resolution_clock;
+
+/*!
+ * The process-wide source of time for the parts of the controller whose
+ * results depend on time, e.g., timers, robot state timestamps, and the
+ * task update schedule.
+ *
+ * By default this is the wall clock.  When the controller runs in lockstep
+ * with a simulator, it is a simulated clock that only advances when the
+ * simulator steps the controller, which makes the controller's results
+ * independent of how fast the simulation runs.
+ */
+class ControllerClock
+{
+public:
+    /*!
+     * Switches between the wall clock and the simulated clock.  The
+     * simulated clock starts at zero.  This should be called before the
+     * controller is initialized.
+     *
+     * \param[in] simulated Whether to use the simulated clock.
+     */
+    static void setSimulated(bool simulated);
+
+    /*!
+     * \return Whether the simulated clock is used.
+     */
+    static bool isSimulated();
+
+    /*!
+     * Sets the simulated time.  This is called by the servo clock that
+     * steps the controller.
+     *
+     * \param[in] nanoseconds The simulated time in nanoseconds.
+     */
+    static void setSimulatedTime(int64_t nanoseconds);
+
+    /*!
+     * \return The simulated time in nanoseconds.
+     */
+    static int64_t getSimulatedTime();
+
+    /*!
+     * \return The current time in seconds.  The epoch is arbitrary, so only
+     * differences between times are meaningful.  The wall clock is monotonic.
+     */
+    static double getTime();
+
+    /*!
+     * \return The current time as a time point, for timestamps that are
+     * stored as time points.
+     */
+    static high_resolution_clock::time_point now();
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_CONTROLLER_CLOCK_HPP__
@@ -26,7 +26,6 @@
 #include <sensor_msgs/JointState.h>
 #include <std_msgs/Float64.h>
 
-#include <tf/transform_broadcaster.h>
 #include <tf/transform_listener.h>
 #include <tf/message_filter.h>
 #include <message_filters/subscriber.h>
@@ -46,6 +45,10 @@
 #include <controlit/Controller.hpp>
 #include <controlit/RobotState.hpp>
 #include <controlit/TaskUpdater.hpp>
+#include <controlit/TrajectoryEngine.hpp>
+#include <controlit/LoadGovernor.hpp>
+#include <controlit/ModelPredictor.hpp>
+#include <controlit/TelemetryPublisher.hpp>
 #include <controlit/SingleThreadedTaskUpdater.hpp>
 
 #include <controlit/utility/ContainerUtility.hpp>
@@ -92,10 +95,37 @@ public:
     ~Coordinator();
 
     /*!
-     * Initializes this coordinator.
+     * Initializes this coordinator using the parameters in the namespace
+     * of the default ROS node handle.
      */
     bool init();
 
+    /*!
+     * Initializes this coordinator.
+     *
+     * \param[in] nh The ROS node handle whose namespace contains the
+     * controller's parameters.  The controller's diagnostics are
+     * published in this namespace.
+     * \return Whether the initialization was successful.
+     */
+    bool init(ros::NodeHandle & nh);
+
+    /*!
+     * Makes the model and task updates run on a worker pool that is shared
+     * with other controllers in the same process.  This must be called
+     * before init(...).  The controller's CPU quota on the pool is set by
+     * parameter controlit/worker_cpu_quota.
+     *
+     * \param[in] pool The worker pool.
+     */
+    void setWorkerPool(WorkerPool * pool) { workerPool = pool; }
+
+    /*!
+     * \return The controller's account on the worker pool, or nullptr if
+     * no worker pool is used.
+     */
+    WorkerPool::Account * getWorkerAccount() { return workerAccount; }
+
     /*!
      * Starts the servo loop.
      */
@@ -163,6 +193,21 @@ public:
      */
     const controlit::Command * getLastCommand() const { return & command; };
 
+    /*!
+     * Gets the time spent in each stage of the most recent servo cycle, in
+     * the order read, publish odometry, model update, compute command, emit
+     * events, and write, followed by the total compute time of the cycle.
+     *
+     * \param[out] latencies Where to store the latencies in seconds.
+     */
+    void getServoLatencies(Vector & latencies) const;
+
+    /*!
+     * \return The compound task, whose parameters may be bound to transport
+     * layers, or nullptr if the controller is not initialized.
+     */
+    CompoundTask * getCompoundTask() { return compoundTask.get(); }
+
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
     // QUICK HACK TO ALLOW CONTROLLER TO TALK TO ROBOT VIA ROS TOPICS
@@ -227,6 +272,12 @@ private:
      */
     void servoUpdate();
 
+    /*!
+     * \return The state arrival event of the robot interface, or nullptr if
+     * the robot interface does not provide one.
+     */
+    StateEvent * getStateEvent();
+
     /*!
      * Computes the command by passing the current stat to the controller.
      * Saves the command in variable 'command'.
@@ -262,6 +313,20 @@ private:
      */
     void updateModel();
 
+    /*!
+     * Applies the degradation steps chosen by the load governor to the
+     * task updater and the controller.  The telemetry and event decimation
+     * are applied by servoUpdate().
+     */
+    void applyDegradation();
+
+    /*!
+     * \param[in] step A degradation step that decimates part of the servo loop.
+     * \param[in] decimation The decimation while the step is applied.
+     * \return Whether that part of the servo loop should run in this cycle.
+     */
+    bool isDecimatedCycle(DegradationStep step, int decimation) const;
+
     /*!
      * Prints the model details.  This includes a table with two columns:
      * (1) the name of the joint and (2) the joint's index within the RBDL
@@ -305,23 +370,33 @@ private:
            latencyComputeCmd, latencyEvents, latencyWrite, latencyServo;
 
     /*!
-     * Real-time safe publisher for joint state messages.
+     * Publishes the odometry transform and the joint states outside of
+     * the servo thread.
      */
-    controlit::addons::ros::RealtimePublisherHeader<sensor_msgs::JointState>
-        jointStatePublisher;
+    TelemetryPublisher telemetryPublisher;
 
     /*!
-     * This is used for publishing the odometry transforms on topic /tf.
-     * It connects the world to the robot.
+     * For publishing the model staleness information.
      */
-    tf::TransformBroadcaster tfBroadcaster;
+    controlit::addons::ros::RealtimePublisher<std_msgs::Float64>
+        modelStalenessPublisher;
 
+    /*!
+     * For publishing the accuracy of the model predictor.  The data is
+     * [predicted gravity error, held gravity error, predicted projection error,
+     * held projection error, extrapolation, applied].
+     */
+    controlit::addons::ros::RealtimePublisher<std_msgs::Float64MultiArray>
+        modelPredictionErrorPublisher;
 
     /*!
-     * For publishing the model staleness information.
+     * For publishing the task update statistics.  The data is the effective
+     * update rate in Hz of each task followed by the staleness in seconds of
+     * each task's state, with the tasks in the order they were added to the
+     * TaskUpdater.
      */
-    controlit::addons::ros::RealtimePublisher<std_msgs::Float64>
-        modelStalenessPublisher;
+    controlit::addons::ros::RealtimePublisher<std_msgs::Float64MultiArray>
+        taskUpdateRatePublisher;
 
     /*!
      * Real-time safe publisher for servo computational latency messages.
@@ -335,6 +410,18 @@ private:
     controlit::addons::ros::RealtimePublisher<std_msgs::Float64>
         servoFrequencyPublisher;
 
+    /*!
+     * For publishing the changes of the degradation level.  The data is
+     * [degradation level, number of level changes, servo load].
+     */
+    controlit::addons::ros::RealtimePublisher<std_msgs::Float64MultiArray>
+        degradationPublisher;
+
+    /*!
+     * Degrades the servo loop while it overruns.
+     */
+    LoadGovernor loadGovernor;
+
     /*!
      * The time when the servo loop last executed in seconds
      */
@@ -408,6 +495,46 @@ private:
      */
     std::unique_ptr<controlit::Controller> controller;
 
+    /*!
+     * Interpolates the goal trajectories of the tasks.  This is declared
+     * after the compound task so that it is destroyed first.
+     */
+    TrajectoryEngine trajectoryEngine;
+
+    /*!
+     * Extrapolates the active control model to the latest joint positions.
+     */
+    ModelPredictor modelPredictor;
+
+    /*!
+     * Whether the model predictor is used.
+     */
+    bool predictModel;
+
+    /*!
+     * The worker pool shared with other controllers and this controller's
+     * account on it, or nullptr if each update has its own thread.
+     */
+    WorkerPool * workerPool;
+    WorkerPool::Account * workerAccount;
+
+    /*!
+     * Whether a change of the degradation level has yet to be published.
+     */
+    bool degradationChangePending;
+
+    /*!
+     * The number of servo cycles executed.  This is used to decimate the
+     * telemetry and the events.
+     */
+    unsigned long servoCycleCount;
+
+    /*!
+     * The number of servo cycles executed, up to the number after which the
+     * servo thread must not allocate memory.
+     */
+    int numServoCycles;
+
     /*!
      * The parameter binding manager.  This manages connections between parameters
      * and various transport layers.
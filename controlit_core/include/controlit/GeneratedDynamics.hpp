@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_GENERATED_DYNAMICS_HPP__
+#define __CONTROLIT_CORE_GENERATED_DYNAMICS_HPP__
+
+#include <vector>
+
+#include <rbdl/rbdl.h>
+
+namespace controlit {
+
+/*!
+ * Computes the kinematics and dynamics of one specific robot using C++ code
+ * that is generated from the robot's URDF by the generate_dynamics tool:
+ *
+ *   rosrun controlit_core generate_dynamics robot.urdf --class my_robot::MyRobotDynamics --output-dir src
+ *
+ * The generated code computes the same quantities as
+ * RigidBodyDynamics::Extras::FusedDynamics, but the loops over the bodies are
+ * unrolled, the robot's joint axes, joint placements and inertias are
+ * compile-time constants, and all storage has a fixed size.
+ *
+ * Generated classes are pluginlib plugins of this base class, so the package
+ * that compiles them must export its plugin description with a
+ * <controlit_core plugin="..."/> tag.  A ControlModel
+ * uses the plugin named by ROS parameter "controlit/generated_dynamics_type"
+ * in place of FusedDynamics, provided the plugin matches the robot model that
+ * was loaded from the robot description.  Otherwise it logs a warning and
+ * falls back to the generic computation.
+ */
+class GeneratedDynamics
+{
+public:
+    typedef Eigen::Matrix<double, 6, 1> SpatialVector6d;
+
+    /*!
+     * The destructor.
+     */
+    virtual ~GeneratedDynamics() {}
+
+    /*!
+     * \return The number of DOFs of the robot the code was generated for.
+     */
+    virtual unsigned int getNumDOFs() const = 0;
+
+    /*!
+     * Checks whether the code was generated from the given robot model, i.e.,
+     * whether the structure, joint axes, joint placements and inertias of the
+     * model are those the code was generated from.
+     *
+     * \param[in] robot The robot model.
+     * \return Whether the code computes the dynamics of the robot model.
+     */
+    bool matches(const RigidBodyDynamics::Model & robot) const;
+
+    /*!
+     * Updates the kinematics of the robot model and computes its dynamics.
+     * Afterwards, the transforms, velocities, and accelerations stored in
+     * the model are the same as after calling UpdateKinematicsCustom(robot,
+     * &Q, &Qd, &Qdd).
+     *
+     * \param[in] robot The robot model.  It must match this object.
+     * \param[in] Q The generalized joint positions.
+     * \param[in] Qd The generalized joint velocities.
+     * \param[in] Qdd The generalized joint accelerations.  They only affect
+     * the accelerations stored in the model.
+     * \param[out] H Where the joint space inertia matrix is stored.  It must
+     * be sized dof_count x dof_count.  Pass NULL to skip computing it.
+     * \param[out] gravity Where the joint torques due to gravity are stored.
+     * \param[out] coriolis Where the Coriolis and centrifugal joint torques
+     * are stored.
+     */
+    virtual void update(RigidBodyDynamics::Model & robot,
+        const RigidBodyDynamics::Math::VectorNd & Q,
+        const RigidBodyDynamics::Math::VectorNd & Qd,
+        const RigidBodyDynamics::Math::VectorNd & Qdd,
+        RigidBodyDynamics::Math::MatrixNd * H,
+        RigidBodyDynamics::Math::VectorNd & gravity,
+        RigidBodyDynamics::Math::VectorNd & coriolis) = 0;
+
+    /*!
+     * Computes the Jacobians of a point on a body using the kinematics of the
+     * last call to update(...).  These equal the Jacobians computed by
+     * CalcPointJacobian(...) and CalcPointJacobianW(...) without updating the
+     * kinematics.
+     *
+     * \param[in] robot The robot model.  It must match this object.
+     * \param[in] bodyId The ID of the body.  This may be a fixed body.
+     * \param[in] point The point in body coordinates.
+     * \param[out] Jv The 3 x dof_count linear velocity Jacobian of the point
+     * in base coordinates.
+     * \param[out] Jw The 3 x dof_count angular velocity Jacobian of the body
+     * in base coordinates.
+     */
+    void calcPointJacobian(const RigidBodyDynamics::Model & robot, unsigned int bodyId,
+        const RigidBodyDynamics::Math::Vector3d & point,
+        RigidBodyDynamics::Math::MatrixNd & Jv, RigidBodyDynamics::Math::MatrixNd & Jw) const;
+
+    /*!
+     * Flattens the parts of a robot model that generated code depends on into
+     * an array.  The generator stores this array in the generated code so
+     * matches(...) can compare it with the model at run time.
+     *
+     * \param[in] robot The robot model.
+     * \param[out] data The flattened model.
+     * \return Whether code can be generated for the model.  This requires
+     * every joint to be a single-DOF revolute or prismatic joint, which
+     * includes RBDL's decomposition of multi-DOF joints.
+     */
+    static bool getModelData(const RigidBodyDynamics::Model & robot, std::vector<double> & data);
+
+protected:
+    /*!
+     * Provides the flattened model the code was generated from.
+     *
+     * \param[out] data The flattened model.
+     * \param[out] size The number of elements in data.
+     */
+    virtual void getGeneratedModelData(const double * & data, size_t & size) const = 0;
+
+    /*!
+     * Implements calcPointJacobian(...) for movable bodies.
+     */
+    virtual void calcMovablePointJacobian(unsigned int bodyId,
+        const RigidBodyDynamics::Math::Vector3d & point,
+        RigidBodyDynamics::Math::MatrixNd & Jv, RigidBodyDynamics::Math::MatrixNd & Jw) const = 0;
+
+    /*!
+     * The spatial algebra used by the generated code.  A transform is given
+     * by its rotation E and translation r as in RBDL's SpatialTransform.
+     */
+    static SpatialVector6d applyMotion(const Eigen::Matrix3d & E, const Eigen::Vector3d & r,
+        const SpatialVector6d & m)
+    {
+        SpatialVector6d result;
+        result.head<3>() = E * m.head<3>();
+        result.tail<3>() = E * (m.tail<3>() - r.cross(m.head<3>()));
+        return result;
+    }
+
+    static SpatialVector6d applyForceTranspose(const Eigen::Matrix3d & E, const Eigen::Vector3d & r,
+        const SpatialVector6d & f)
+    {
+        Eigen::Vector3d n = E.transpose() * f.head<3>();
+        Eigen::Vector3d fl = E.transpose() * f.tail<3>();
+
+        SpatialVector6d result;
+        result.head<3>() = n + r.cross(fl);
+        result.tail<3>() = fl;
+        return result;
+    }
+
+    static SpatialVector6d crossMotion(const SpatialVector6d & v, const SpatialVector6d & m)
+    {
+        SpatialVector6d result;
+        result.head<3>() = v.head<3>().cross(m.head<3>());
+        result.tail<3>() = v.head<3>().cross(m.tail<3>()) + v.tail<3>().cross(m.head<3>());
+        return result;
+    }
+
+    static SpatialVector6d crossForce(const SpatialVector6d & v, const SpatialVector6d & f)
+    {
+        SpatialVector6d result;
+        result.head<3>() = v.head<3>().cross(f.head<3>()) + v.tail<3>().cross(f.tail<3>());
+        result.tail<3>() = v.head<3>().cross(f.tail<3>());
+        return result;
+    }
+
+    /*!
+     * Multiplies a motion vector by a spatial inertia given as its mass,
+     * first mass moment, and rotational inertia about the frame's origin.
+     */
+    static SpatialVector6d multiplyInertia(double mass, const Eigen::Vector3d & h,
+        const Eigen::Matrix3d & I, const SpatialVector6d & m)
+    {
+        SpatialVector6d result;
+        result.head<3>() = I * m.head<3>() + h.cross(m.tail<3>());
+        result.tail<3>() = mass * m.tail<3>() - h.cross(m.head<3>());
+        return result;
+    }
+
+    /*!
+     * Adds the spatial inertia of a child body, given in the child's frame,
+     * to that of its parent.
+     */
+    static void addChildInertia(const Eigen::Matrix3d & E, const Eigen::Vector3d & r,
+        double childMass, const Eigen::Vector3d & childMoment, const Eigen::Matrix3d & childInertia,
+        double & mass, Eigen::Vector3d & moment, Eigen::Matrix3d & inertia)
+    {
+        Eigen::Vector3d h = E.transpose() * childMoment;
+        Eigen::Matrix3d rx = RigidBodyDynamics::Math::VectorCrossMatrix(r);
+        Eigen::Matrix3d hx = RigidBodyDynamics::Math::VectorCrossMatrix(h);
+
+        mass += childMass;
+        moment += h + childMass * r;
+        inertia += E.transpose() * childInertia * E - hx * rx - rx * hx - childMass * rx * rx;
+    }
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_GENERATED_DYNAMICS_HPP__
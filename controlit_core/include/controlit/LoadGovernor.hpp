@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_LOAD_GOVERNOR_HPP__
+#define __CONTROLIT_CORE_LOAD_GOVERNOR_HPP__
+
+#include <string>
+#include <vector>
+
+namespace controlit {
+
+/*!
+ * The ways in which the servo loop can shed load.
+ */
+enum class DegradationStep : int
+{
+    /*!
+     * Limit how often the states of low priority tasks are updated.
+     */
+    TASK_UPDATES,
+
+    /*!
+     * Reuse the projected Jacobians of the lowest task priority levels
+     * from previous servo cycles.
+     */
+    PROJECTIONS,
+
+    /*!
+     * Publish the telemetry and diagnostics less often.
+     */
+    TELEMETRY,
+
+    /*!
+     * Evaluate the task and constraint events less often.
+     */
+    EVENTS
+};
+
+/*!
+ * The configuration of the LoadGovernor.
+ */
+struct DegradationConfig
+{
+    /*!
+     * The default constructor.  The default configuration has no steps,
+     * which disables the governor.
+     */
+    DegradationConfig();
+
+    /*!
+     * Converts the name of a step into a step.  The names are
+     * "task_updates", "projections", "telemetry" and "events".
+     *
+     * \param[in] name The name of the step.
+     * \param[out] step The step.
+     * \return Whether the name is valid.
+     */
+    static bool parseStep(const std::string & name, DegradationStep & step);
+
+    /*!
+     * \param[in] step The step.
+     * \return The name of the step.
+     */
+    static std::string getStepName(DegradationStep step);
+
+    /*!
+     * The steps in the order in which they are applied.  They are
+     * restored in reverse order.
+     */
+    std::vector<DegradationStep> steps;
+
+    /*!
+     * A servo cycle overruns when its compute time exceeds this fraction
+     * of the servo period.
+     */
+    double overrunThreshold;
+
+    /*!
+     * A servo cycle has headroom when its compute time is below this
+     * fraction of the servo period.
+     */
+    double headroomThreshold;
+
+    /*!
+     * The number of overrunning cycles, net of the cycles that do not
+     * overrun, after which the next step is applied.
+     */
+    int overrunCycles;
+
+    /*!
+     * The number of consecutive cycles with headroom after which the last
+     * applied step is restored.
+     */
+    int headroomCycles;
+
+    /*!
+     * The minimum time in seconds between updates of the states of the
+     * low priority tasks while step TASK_UPDATES is applied, and the
+     * highest update priority of the tasks that are limited.
+     */
+    double taskUpdatePeriod;
+    int taskUpdatePriority;
+
+    /*!
+     * The number of lowest task priority levels whose projected Jacobians
+     * are reused while step PROJECTIONS is applied, and the maximum number
+     * of servo cycles for which they are reused before being recomputed.
+     */
+    int heldPriorityLevels;
+    int heldProjectionCycles;
+
+    /*!
+     * While step TELEMETRY or EVENTS is applied, the telemetry is
+     * published or the events are evaluated once every this many cycles.
+     */
+    int telemetryDecimation;
+    int eventDecimation;
+};
+
+/*!
+ * Degrades the servo loop step by step while its compute time overruns
+ * and restores it when there is headroom again.  The thresholds and
+ * cycle counts provide hysteresis so that the mode does not oscillate.
+ *
+ * The governor only decides the degradation level.  The Coordinator
+ * applies the steps to the task updater, the controller and itself.  All
+ * methods are called by the servo thread.
+ */
+class LoadGovernor
+{
+public:
+    /*!
+     * The constructor.
+     */
+    LoadGovernor();
+
+    /*!
+     * Initializes this governor.
+     *
+     * \param[in] config The configuration.
+     * \param[in] servoPeriod The servo period in seconds.
+     */
+    void init(const DegradationConfig & config, double servoPeriod);
+
+    /*!
+     * \return Whether the governor has any steps to apply.
+     */
+    bool isEnabled() const { return !config.steps.empty(); }
+
+    /*!
+     * Records the compute time of a servo cycle and changes the
+     * degradation level if necessary.
+     *
+     * \param[in] computeTime The compute time of the cycle in seconds.
+     * \return Whether the degradation level changed.
+     */
+    bool update(double computeTime);
+
+    /*!
+     * \return The number of steps that are applied.
+     */
+    int getLevel() const { return level; }
+
+    /*!
+     * \return The number of times the degradation level changed.
+     */
+    unsigned long getNumLevelChanges() const { return numLevelChanges; }
+
+    /*!
+     * \return The compute time of the latest cycle as a fraction of the
+     * servo period.
+     */
+    double getLoad() const { return load; }
+
+    /*!
+     * \param[in] step The step.
+     * \return Whether the step is applied.
+     */
+    bool isApplied(DegradationStep step) const;
+
+    /*!
+     * \return The configuration.
+     */
+    const DegradationConfig & getConfig() const { return config; }
+
+private:
+    /*!
+     * The configuration.
+     */
+    DegradationConfig config;
+
+    /*!
+     * The servo period in seconds.
+     */
+    double servoPeriod;
+
+    /*!
+     * The number of steps that are applied.
+     */
+    int level;
+
+    /*!
+     * The net number of overrunning cycles and the number of consecutive
+     * cycles with headroom since the level last changed.
+     */
+    int overrunCount;
+    int headroomCount;
+
+    /*!
+     * The number of times the level changed.
+     */
+    unsigned long numLevelChanges;
+
+    /*!
+     * The compute time of the latest cycle as a fraction of the servo period.
+     */
+    double load;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_LOAD_GOVERNOR_HPP__
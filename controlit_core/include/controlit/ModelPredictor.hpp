@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_MODEL_PREDICTOR_HPP__
+#define __CONTROLIT_CORE_MODEL_PREDICTOR_HPP__
+
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+
+namespace controlit {
+
+using controlit::addons::eigen::Vector;
+using controlit::addons::eigen::Matrix;
+
+class ControlModel;
+
+/*!
+ * Compensates for the age of the active control model by extrapolating the
+ * gravity vector and the constraint projection matrices UNcBar and UNcAiNorm
+ * from the joint positions at which the model was last updated to the
+ * latest joint positions.
+ *
+ * The predictor keeps the two most recent model snapshots.  The difference
+ * between them is a finite-difference estimate of the derivative of each
+ * quantity along dQ = Q_k - Q_{k-1}.  The latest joint positions Q are
+ * projected onto dQ to obtain the extrapolation
+ *
+ *   alpha = dQ^T (Q - Q_k) / dQ^T dQ
+ *
+ * which is clamped to [0, maxExtrapolation], and each quantity X is
+ * predicted as X_k + alpha * (X_k - X_{k-1}).  Motion orthogonal to dQ is
+ * not compensated.
+ *
+ * Each time a new snapshot arrives, the prediction made from the previous
+ * two snapshots at the new joint positions is compared with the new
+ * snapshot.  The relative errors of the prediction and of holding the
+ * previous snapshot are tracked as exponential moving averages.  The
+ * prediction is only applied while it is more accurate than holding.
+ *
+ * All storage is allocated by init(...), so the other methods may be
+ * called by the servo thread.
+ */
+class ModelPredictor
+{
+public:
+    /*!
+     * The constructor.
+     */
+    ModelPredictor();
+
+    /*!
+     * Allocates the snapshots.
+     *
+     * \param[in] numDOFs The number of DOFs (real and virtual).
+     * \param[in] numActuableDOFs The number of actuable DOFs.
+     * \param[in] maxExtrapolation The largest alpha that may be used, in units
+     * of the distance between the last two snapshots.
+     */
+    void init(int numDOFs, int numActuableDOFs, double maxExtrapolation);
+
+    /*!
+     * Discards the snapshots, e.g., when the controller is restarted.
+     */
+    void reset();
+
+    /*!
+     * Adds a snapshot and updates the prediction error statistics.
+     *
+     * \param[in] Q The joint positions at which the snapshot was computed.
+     * \param[in] grav The gravity vector.
+     * \param[in] UNcBar The dynamically consistent inverse of UNc.
+     * \param[in] UNcAiNorm The Ai-norm of UNc.
+     */
+    void addSnapshot(const Vector & Q, const Vector & grav,
+        const Matrix & UNcBar, const Matrix & UNcAiNorm);
+
+    /*!
+     * Predicts the model quantities at the given joint positions.  If there
+     * are fewer than two snapshots or the prediction is disabled, the latest
+     * snapshot is stored.
+     *
+     * \param[in] Q The joint positions.
+     * \param[out] grav Where the gravity vector should be stored.
+     * \param[out] UNcBar Where UNcBar should be stored.
+     * \param[out] UNcAiNorm Where UNcAiNorm should be stored.
+     */
+    void predict(const Vector & Q, Vector & grav, Matrix & UNcBar, Matrix & UNcAiNorm);
+
+    /*!
+     * Adds the state of a control model that was just swapped in as a
+     * snapshot.  This must be called before predict(ControlModel &) modifies
+     * the model.
+     *
+     * \param[in] model The new active control model.
+     */
+    void addSnapshot(const ControlModel & model);
+
+    /*!
+     * Overwrites the gravity vector and projection matrices of the active
+     * control model with their predicted values at the latest joint positions.
+     * This only writes to the model if the prediction changed since the
+     * previous call.  While the model holds predicted values,
+     * ControlModel::hasPredictedValues() is true, so that it is fully
+     * updated before it is used again.
+     *
+     * \param[in] model The active control model.
+     */
+    void predict(ControlModel & model);
+
+    /*!
+     * \return Whether the prediction is being applied.
+     */
+    bool isApplied() const;
+
+    /*!
+     * \return The alpha used by the most recent prediction.
+     */
+    double getExtrapolation() const { return extrapolation; }
+
+    /*!
+     * \return The average relative error of the predicted gravity vector.
+     */
+    double getGravityError() const { return gravityError; }
+
+    /*!
+     * \return The average relative error of the held gravity vector.
+     */
+    double getHeldGravityError() const { return heldGravityError; }
+
+    /*!
+     * \return The average relative error of the predicted UNcBar and UNcAiNorm.
+     */
+    double getProjectionError() const { return projectionError; }
+
+    /*!
+     * \return The average relative error of the held UNcBar and UNcAiNorm.
+     */
+    double getHeldProjectionError() const { return heldProjectionError; }
+
+private:
+    /*!
+     * The model quantities at one point in time.
+     */
+    struct Snapshot
+    {
+        Vector Q;
+        Vector grav;
+        Matrix UNcBar;
+        Matrix UNcAiNorm;
+        bool valid;
+    };
+
+    /*!
+     * \return The clamped extrapolation from the latest snapshot to Q.
+     */
+    double computeExtrapolation(const Vector & Q) const;
+
+    /*!
+     * Stores latest + alpha * (latest - previous) in the output arguments.
+     */
+    void extrapolate(double alpha, Vector & grav, Matrix & UNcBar, Matrix & UNcAiNorm) const;
+
+    /*!
+     * \return The relative error of a predicted gravity vector.  The mean
+     * relative error of the predicted projection matrices is stored in
+     * relativeProjectionError.
+     */
+    static double relativeError(const Vector & grav, const Matrix & UNcBar, const Matrix & UNcAiNorm,
+        const Vector & actualGrav, const Matrix & actualUNcBar, const Matrix & actualUNcAiNorm,
+        double & relativeProjectionError);
+
+    double maxExtrapolation;
+
+    /*!
+     * The two most recent snapshots.
+     */
+    Snapshot latest;
+    Snapshot previous;
+
+    /*!
+     * Scratch space for checking the prediction against a new snapshot.
+     */
+    Vector predictedGrav;
+    Matrix predictedUNcBar;
+    Matrix predictedUNcAiNorm;
+
+    /*!
+     * Scratch space for the latest joint state.
+     */
+    Vector latestQ;
+    Vector latestQd;
+
+    /*!
+     * The alpha used by the most recent prediction, and whether the
+     * prediction was written to the model.
+     */
+    double extrapolation;
+    bool applied;
+
+    /*!
+     * The number of predictions checked against a new snapshot.
+     */
+    int numComparisons;
+
+    /*!
+     * Exponential moving averages of the relative errors.
+     */
+    double gravityError;
+    double heldGravityError;
+    double projectionError;
+    double heldProjectionError;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_MODEL_PREDICTOR_HPP__
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_MODEL_UPDATE_GRAPH_HPP__
+#define __CONTROLIT_CORE_MODEL_UPDATE_GRAPH_HPP__
+
+#include <functional>
+#include <vector>
+
+#include <controlit/ParallelLoop.hpp>
+
+namespace controlit {
+
+/*!
+ * A static graph of the steps of a model update.  The steps are grouped
+ * into stages that run one after the other.  The steps within a stage must
+ * be independent of each other, so they run concurrently on the threads of
+ * a thread pool or on the jobs of a worker pool, with the calling thread
+ * taking a share of them.  Without helpers every step runs on the calling
+ * thread, in the order in which the steps were added.
+ *
+ * The graph is built once when the model is initialized.  Running it
+ * neither builds nor resizes anything.
+ */
+class ModelUpdateGraph
+{
+public:
+    typedef std::function<void()> Step;
+
+    /*!
+     * The constructor.
+     */
+    ModelUpdateGraph();
+
+    /*!
+     * Sets the threads on which the steps of a stage run concurrently.
+     * The pool may be shared by several graphs as long as they do not run
+     * at the same time.
+     *
+     * \param[in] pool The thread pool, or nullptr to run every step on the
+     * calling thread.
+     */
+    void setThreadPool(controlit::addons::cpp::ThreadPool * pool);
+
+    /*!
+     * Runs the steps of a stage concurrently on jobs of a worker pool that
+     * is shared with other controllers.  See ParallelLoop.
+     *
+     * \param[in] pool The worker pool.
+     * \param[in] account The account of the jobs.
+     * \param[in] numHelpers The number of jobs that help the calling thread.
+     */
+    void setWorkerPool(WorkerPool * pool, WorkerPool::Account * account, size_t numHelpers);
+
+    /*!
+     * Removes all stages.
+     */
+    void clear();
+
+    /*!
+     * Adds a stage that runs after the previously added stages.
+     *
+     * \return The index of the new stage.
+     */
+    size_t addStage();
+
+    /*!
+     * Adds a step to a stage.
+     *
+     * \param[in] stage The index of the stage.
+     * \param[in] step The step.  It must not depend on any other step in
+     * the same stage.
+     */
+    void addStep(size_t stage, Step step);
+
+    /*!
+     * Runs every stage, returning once all steps have finished.
+     */
+    void run();
+
+    /*!
+     * \return The number of stages.
+     */
+    size_t getNumStages() const { return stages.size(); }
+
+    /*!
+     * \return The number of steps in a stage.
+     */
+    size_t getNumSteps(size_t stage) const { return stages[stage].size(); }
+
+private:
+    /*!
+     * The steps of each stage.
+     */
+    std::vector<std::vector<Step>> stages;
+
+    /*!
+     * Runs the steps of a stage on the calling thread and the helpers.
+     */
+    ParallelLoop helpers;
+
+    /*!
+     * The body of the loop over the steps of the current stage.  It is
+     * created once so that no memory is allocated when a stage runs.
+     */
+    ParallelLoop::Body stepBody;
+
+    /*!
+     * The stage that is running.
+     */
+    const std::vector<Step> * currentStage;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_MODEL_UPDATE_GRAPH_HPP__
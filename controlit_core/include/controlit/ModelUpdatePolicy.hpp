@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_MODEL_UPDATE_POLICY_HPP__
+#define __CONTROLIT_CORE_MODEL_UPDATE_POLICY_HPP__
+
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+
+namespace controlit {
+
+using controlit::addons::eigen::Vector;
+
+/*!
+ * Decides how much of a control model to recompute based on how far the
+ * joint state moved since the model was last computed.
+ *
+ * - SKIP: the joint positions and velocities moved less than the skip
+ *   thresholds since the last computed model, so that model remains active.
+ * - PARTIAL: the joint positions are within the partial threshold of the
+ *   positions at which the model being updated last had a full update.  Only
+ *   the kinematics and the gravity vector are recomputed.  The inertia matrix
+ *   and the constraint and virtual linkage quantities are reused.
+ * - FULL: everything is recomputed.
+ *
+ * A full update is always done if the model is stale or the set of enabled
+ * constraints changed.  All distances are the largest absolute change of any
+ * DOF.  A threshold of zero disables the corresponding kind of update, so by
+ * default every update is full.
+ *
+ * The policy also estimates the CPU time saved by skipped and partial
+ * updates based on the average durations of the full and partial updates.
+ */
+class ModelUpdatePolicy
+{
+public:
+    /*!
+     * The kinds of model updates.
+     */
+    enum class Decision : int {SKIP, PARTIAL, FULL};
+
+    /*!
+     * The constructor.
+     */
+    ModelUpdatePolicy();
+
+    /*!
+     * Initializes this policy.
+     *
+     * \param[in] numDOFs The number of DOFs (real and virtual).
+     * \param[in] skipPositionThreshold The largest position change for which
+     * the update may be skipped.
+     * \param[in] skipVelocityThreshold The largest velocity change for which
+     * the update may be skipped.  Both skip thresholds must be positive to
+     * enable skipping.
+     * \param[in] partialPositionThreshold The largest position change since
+     * the last full update for which only a partial update is needed.
+     */
+    void init(int numDOFs, double skipPositionThreshold, double skipVelocityThreshold,
+        double partialPositionThreshold);
+
+    /*!
+     * Forgets the last computed model, so that the next update is not skipped.
+     */
+    void reset();
+
+    /*!
+     * Decides how to update a model.  Unless the decision is SKIP, the given
+     * joint state becomes that of the last computed model.
+     *
+     * \param[in] Q The joint positions the model will be updated to.
+     * \param[in] Qd The joint velocities the model will be updated to.
+     * \param[in] fullUpdateQ The joint positions at the last full update of
+     * the model being updated.
+     * \param[in] fullUpdateValid Whether fullUpdateQ is valid, i.e., whether the
+     * model had a full update since it became stale.
+     * \param[in] constraintsChanged Whether the set of enabled constraints of
+     * the model changed since its last full update.
+     * \return The decision.
+     */
+    Decision decide(const Vector & Q, const Vector & Qd, const Vector & fullUpdateQ,
+        bool fullUpdateValid, bool constraintsChanged);
+
+    /*!
+     * Records the time it took to carry out a decision.
+     *
+     * \param[in] decision The decision.
+     * \param[in] duration The duration in seconds.
+     */
+    void recordUpdate(Decision decision, double duration);
+
+    /*!
+     * \return Whether any update is ever skipped or partial.
+     */
+    bool isEnabled() const;
+
+    /*!
+     * \return The number of decisions recorded since the statistics were reset.
+     */
+    int getNumDecisions() const { return numDecisions[0] + numDecisions[1] + numDecisions[2]; }
+
+    /*!
+     * \return The fraction of the recorded decisions that were the given decision.
+     */
+    double getRatio(Decision decision) const;
+
+    /*!
+     * \return The average duration of the full and partial updates in seconds.
+     */
+    double getAverageFullDuration() const { return averageDuration[static_cast<int>(Decision::FULL)]; }
+    double getAveragePartialDuration() const { return averageDuration[static_cast<int>(Decision::PARTIAL)]; }
+
+    /*!
+     * \return The estimated fraction of the CPU time that would have been
+     * spent on full updates that was saved since the statistics were reset.
+     */
+    double getSavedFraction() const;
+
+    /*!
+     * Resets the decision counts and saved time.  The average durations
+     * are kept.
+     */
+    void resetStatistics();
+
+private:
+    double skipPositionThreshold;
+    double skipVelocityThreshold;
+    double partialPositionThreshold;
+
+    /*!
+     * The joint state of the last computed model.
+     */
+    Vector lastQ;
+    Vector lastQd;
+    bool lastValid;
+
+    /*!
+     * The number of each decision and the time spent carrying them out,
+     * indexed by Decision.
+     */
+    int numDecisions[3];
+    double totalDuration[3];
+
+    /*!
+     * Exponential moving averages of the duration of each decision.
+     */
+    double averageDuration[3];
+    bool averageValid[3];
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_MODEL_UPDATE_POLICY_HPP__
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_PARALLEL_LOOP_HPP__
+#define __CONTROLIT_CORE_PARALLEL_LOOP_HPP__
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <controlit/WorkerPool.hpp>
+#include <controlit/addons/cpp/ThreadPool.hpp>
+
+namespace controlit {
+
+/*!
+ * Runs the iterations of a loop on the calling thread and on helpers.  The
+ * helpers are either the threads of a ThreadPool or jobs of a WorkerPool
+ * account, so the helpers of a controller can be shared with the other
+ * controllers in the process.  The iterations are claimed one at a time,
+ * so whichever thread is free takes the next one.
+ *
+ * When the helpers are WorkerPool jobs, the calling thread only waits for
+ * the helpers that started running.  Helpers that are still queued behind
+ * the jobs of other controllers are withdrawn once the calling thread has
+ * run the remaining iterations itself, so a busy pool costs parallelism
+ * but never blocks the calling thread.
+ *
+ * Running the loop neither allocates memory nor blocks on a lock.  A
+ * ParallelLoop may be shared by several callers as long as they do not run
+ * it at the same time.
+ */
+class ParallelLoop
+{
+public:
+    /*!
+     * The body of the loop.
+     *
+     * \param[in] iteration The index of the iteration.
+     * \param[in] helper Whether the iteration runs on a helper rather than
+     * on the calling thread.
+     */
+    typedef std::function<void(size_t iteration, bool helper)> Body;
+
+    /*!
+     * The constructor.  By default every iteration runs on the calling thread.
+     */
+    ParallelLoop();
+
+    /*!
+     * Runs the helpers on the threads of a thread pool.  The pool must be
+     * destroyed before this loop.
+     *
+     * \param[in] pool The thread pool, or nullptr to run every iteration on
+     * the calling thread.
+     */
+    void setThreadPool(controlit::addons::cpp::ThreadPool * pool);
+
+    /*!
+     * Runs the helpers as jobs of a worker pool.  The jobs remain in the
+     * pool until it is destroyed, so this should only be called once.
+     *
+     * \param[in] pool The worker pool.
+     * \param[in] account The account of the helper jobs.
+     * \param[in] numHelpers The number of helper jobs.
+     */
+    void setWorkerPool(WorkerPool * pool, WorkerPool::Account * account, size_t numHelpers);
+
+    /*!
+     * \return The maximum number of helpers that run iterations concurrently
+     * with the calling thread.
+     */
+    size_t getNumHelpers() const;
+
+    /*!
+     * Runs the loop, returning once every iteration has finished.
+     *
+     * \param[in] numIterations The number of iterations.
+     * \param[in] body The body of the loop.  Iterations must not depend on
+     * each other.
+     */
+    void run(size_t numIterations, const Body & body);
+
+private:
+    /*!
+     * Runs iterations until there are none left.
+     *
+     * \param[in] helper Whether this is called by a helper.
+     */
+    void runIterations(bool helper);
+
+    /*!
+     * Executed by each helper.
+     */
+    void runHelper();
+
+    /*!
+     * The thread pool that runs the helpers, or nullptr.
+     */
+    controlit::addons::cpp::ThreadPool * threadPool;
+
+    /*!
+     * The job that is queued on threadPool for each helper.  It is created
+     * once so that no memory is allocated when it is queued.
+     */
+    controlit::addons::cpp::ThreadPool::Job_t helperJob;
+
+    /*!
+     * The worker pool jobs that run the helpers, if any.
+     */
+    std::vector<WorkerPool::Job *> workerJobs;
+
+    /*!
+     * The body and the number of iterations of the running loop.
+     */
+    const Body * body;
+    size_t numIterations;
+
+    /*!
+     * The index of the next iteration to run.
+     */
+    std::atomic<size_t> nextIteration;
+
+    /*!
+     * The number of helpers of the running loop that have not finished.
+     */
+    std::atomic<size_t> pendingHelpers;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_PARALLEL_LOOP_HPP__
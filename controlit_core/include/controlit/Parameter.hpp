@@ -32,6 +32,7 @@
 
 #include <sstream>
 #include <map>
+#include <mutex>
 #include <vector>
 
 #include <controlit/BindingConfig.hpp>
@@ -201,6 +202,14 @@ protected:
      * Flags indicating special properties of the parameter.
      */
     unsigned int const flags_;
+
+    /*!
+     * Serializes the calls to set(...).  The value of a parameter may be
+     * set by the servo thread, the task command threads, and the threads
+     * that receive the input bindings at the same time.  It is held while
+     * the listeners are notified so that they see the value that was set.
+     */
+    std::mutex setMutex_;
 };
 
 // TODO: Change to a shared_ptr!
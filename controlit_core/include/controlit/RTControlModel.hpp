@@ -25,12 +25,16 @@
 #include <thread>
 #include <condition_variable>
 #include <chrono>
+#include <memory>
 
 #include <ros/ros.h>
 
 #include <controlit/ControlModel.hpp>
 #include <controlit/Constraint.hpp>
 #include <controlit/BindingManager.hpp>
+#include <controlit/ModelUpdatePolicy.hpp>
+#include <controlit/WorkerPool.hpp>
+#include <controlit/addons/cpp/ThreadPool.hpp>
 
 #include <controlit/addons/ros/RealTimePublisher.hpp>
 
@@ -110,6 +114,14 @@ public:
      */
     virtual void setGravMask(const std::vector<std::string> & mask);
 
+    /*!
+     * Sets whether the virtual linkage models of all control models used
+     * internally within this class compute the internal force operators.
+     *
+     * \param enabled Whether there is an internal force task.
+     */
+    virtual void setInternalForceOperatorsEnabled(bool enabled);
+
     /*!
      * Adds a listener to the constraint set of every control model
      * used internally within this class.
@@ -118,6 +130,18 @@ public:
      */
     virtual void addListenerToConstraintSet(boost::function<void(std::string const &)> listener);
 
+    /*!
+     * Makes the inactive control model be updated by a worker pool that is
+     * shared with other controllers instead of by a child thread of this
+     * object.  The model update threads, if any, are replaced by jobs of
+     * the same pool.  This must be called after init(...) and before
+     * startThread().
+     *
+     * \param[in] pool The worker pool.
+     * \param[in] account The account of the controller that owns this object.
+     */
+    virtual void setWorkerPool(WorkerPool * pool, WorkerPool::Account * account);
+
     /*!
      * Starts the child thread that updates the inactive control model.
      */
@@ -195,11 +219,33 @@ protected:
      */
     void updateLoop();
 
+    /*!
+     * Updates the inactive control model and sets the state accordingly.
+     * The caller must hold the mutex.
+     */
+    void updateOnce();
+
+    /*!
+     * This is executed by the worker pool whenever the servo thread requests
+     * a model update.
+     */
+    void runPooledUpdate();
+
     /*!
      * Swaps the inactive and active control models.
      */
     void swap();
 
+    /*!
+     * Updates a control model as decided by the model update policy.
+     *
+     * \param[in] model The control model to update.  Its joint state must
+     * already be updated.
+     * \return Whether the model was updated.  If not, the update was skipped
+     * and the previously computed model should continue to be used.
+     */
+    bool updateModel(ControlModel * model);
+
     bool getConstraintJacobiansHandler(
         controlit_core::get_constraint_set_jacobians::Request  &req,
         controlit_core::get_constraint_set_jacobians::Response &res);
@@ -266,6 +312,24 @@ protected:
      */
     std::thread thread;
 
+    /*!
+     * The job that updates the inactive ControlModel, or nullptr if the
+     * thread updates it instead.
+     */
+    WorkerPool::Job * workerJob;
+
+    /*!
+     * The threads that help update the inactive ControlModel, or nullptr if
+     * it is updated serially.
+     */
+    std::unique_ptr<controlit::addons::cpp::ThreadPool> updateThreadPool;
+
+    /*!
+     * The number of threads or worker pool jobs that help update the
+     * inactive ControlModel.
+     */
+    size_t numUpdateHelpers;
+
     /*!
      * For publishing the model staleness information.
      */
@@ -278,6 +342,17 @@ protected:
     controlit::addons::ros::RealtimePublisher<std_msgs::Float64MultiArray>
         gravityPublisher;
 
+    /*!
+     * Decides whether each model update is skipped, partial, or full.
+     */
+    ModelUpdatePolicy updatePolicy;
+
+    /*!
+     * For publishing the model update policy statistics.
+     */
+    controlit::addons::ros::RealtimePublisher<std_msgs::Float64MultiArray>
+        updatePolicyPublisher;
+
     /*!
      * The service that provides the constraint jacobian matrices.
      */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_REAL_TIME_CONFIG_HPP__
+#define __CONTROLIT_CORE_REAL_TIME_CONFIG_HPP__
+
+#include <functional>
+#include <map>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+namespace controlit {
+
+/*!
+ * The scheduling policy, priority and CPU set requested for a thread.
+ */
+struct ThreadPlacement
+{
+    /*!
+     * The default constructor.  The default placement leaves the thread
+     * in the default time-sharing class on any CPU.
+     */
+    ThreadPlacement();
+
+    /*!
+     * The scheduling policy, either "other", "fifo" or "rr".
+     */
+    std::string policy;
+
+    /*!
+     * The priority within the policy.  This must be zero for policy
+     * "other" and 1 to 99 for "fifo" and "rr".
+     */
+    int priority;
+
+    /*!
+     * The CPUs on which the thread may run.  If empty, the thread may
+     * run on any CPU.
+     */
+    std::vector<int> cpus;
+};
+
+/*!
+ * The process-wide real-time configuration.  It holds the placements of
+ * the named ControlIt! threads and locks the process' memory.
+ *
+ * The names of the threads are:
+ *
+ *   - "servo": The servo clock's thread.
+ *   - "model_update": The RTControlModel update thread.
+ *   - "task_update": The TaskUpdater thread.
+ *   - "publisher": The threads of the global thread pool that publishes
+ *     the real-time ROS messages.
+ *   - "udp_rx": The receive thread of the UDP robot interface.
+ *   - "telemetry": The thread that publishes the odometry transform and
+ *     the joint states.
+ *
+ * Each thread applies its placement when it starts.  Threads that cannot
+ * get their requested placement, usually because the process lacks the
+ * CAP_SYS_NICE capability or a CPU does not exist, keep running with the
+ * default placement and are reported to the failure handler.
+ */
+class RealTimeConfig
+{
+public:
+    /*!
+     * Sets the configuration.  This should be called before any of the
+     * named threads are started.
+     *
+     * \param[in] placements The placements of the named threads.
+     * \param[in] lockMemory Whether lockMemory() locks the process' memory.
+     * \param[in] prefaultStackSize The number of bytes of stack to prefault
+     * in each named thread when memory is locked.
+     * \param[in] failureHandler Called with a description of each thread
+     * that does not get its requested placement.  It is called by the
+     * thread being placed before it enters its loop.
+     */
+    static void configure(const std::map<std::string, ThreadPlacement> & placements,
+        bool lockMemory, size_t prefaultStackSize,
+        std::function<void(const std::string &)> failureHandler);
+
+    /*!
+     * Locks all current and future memory of the process into RAM and
+     * prefaults the calling thread's stack.  This is done after all of the
+     * controller's buffers are allocated so that the servo thread never
+     * page faults.  It does nothing unless memory locking is configured.
+     *
+     * \return Whether the memory was locked.
+     */
+    static bool lockMemory();
+
+    /*!
+     * Applies the placement of a named thread to the calling thread.  If
+     * memory locking is configured, the thread's stack is also prefaulted.
+     *
+     * \param[in] name The name of the thread.
+     * \return Whether the thread got its requested placement.  This is true
+     * if no placement is configured for the thread.
+     */
+    static bool placeCurrentThread(const std::string & name);
+
+    /*!
+     * Applies the placement of a named thread to another thread.
+     *
+     * \param[in] name The name of the thread.
+     * \param[in] thread The thread.
+     * \return Whether the thread got its requested placement.
+     */
+    static bool placeThread(const std::string & name, pthread_t thread);
+
+    /*!
+     * \return Descriptions of the threads that did not get their requested
+     * placements.
+     */
+    static std::vector<std::string> getFailures();
+
+    /*!
+     * Converts a policy name into a POSIX scheduling policy.
+     *
+     * \param[in] name The policy name.
+     * \param[out] policy The POSIX policy.
+     * \return Whether the name is valid.
+     */
+    static bool parsePolicy(const std::string & name, int & policy);
+
+    /*!
+     * The names of the threads that can be placed.
+     */
+    static const std::vector<std::string> THREAD_NAMES;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_REAL_TIME_CONFIG_HPP__
@@ -25,6 +25,7 @@
 #include <std_msgs/Float64.h>
 
 #include <controlit/Timer.hpp>
+#include <controlit/StateEvent.hpp>
 #include <controlit/OdometryStateReceiver.hpp>
 #include <controlit/addons/ros/RealTimePublisherHeader.hpp>
 
@@ -87,6 +88,14 @@ public:
      */
     virtual std::shared_ptr<Timer> getTimer();
 
+    /*!
+     * Returns the event that is notified each time a new robot state arrives.
+     * The default implementation returns nullptr, meaning this robot interface
+     * does not signal state arrivals.  Child classes that receive state
+     * asynchronously should override this method.
+     */
+    virtual StateEvent * getStateEvent() { return nullptr; }
+
 protected:
 
     /*!
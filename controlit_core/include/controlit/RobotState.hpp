@@ -117,6 +117,16 @@ public:
    */
   bool setRobotBaseState(Eigen::Vector3d const& x, Eigen::Quaterniond const& q, Vector const& x_dot);
 
+  /*!
+   * Sets the virtual joint positions and velocities directly, i.e., the
+   * x-y-z translation followed by the 3-2-1 Euler angles and their rates.
+   *
+   * \param position The virtual joint positions.
+   * \param velocity The virtual joint velocities.
+   * \return Whether the virtual joint state was successfully set.
+   */
+  bool setVirtualJointState(Eigen::Ref<const Vector> position, Eigen::Ref<const Vector> velocity);
+
   /*!
    * Returns the index of the joint with the specified name.
    *
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_SCRATCH_ARENA_HPP__
+#define __CONTROLIT_CORE_SCRATCH_ARENA_HPP__
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+
+namespace controlit {
+
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
+
+/*!
+ * A bump allocator for the temporary matrices and vectors that are needed
+ * while computing a servo cycle.  Each thread has its own arena, which is
+ * obtained by calling getThreadArena().  Memory is requested by calling
+ * getMatrix(...) or getVector(...), which return Eigen maps onto the arena,
+ * and is released all at once by reset().  The servo thread's arena is reset
+ * at the start of every servo cycle, so the scratch memory may be used until
+ * the end of the cycle in which it was requested.
+ *
+ * Requests that do not fit in the arena are served from the heap.  The
+ * next reset() grows the arena to fit everything that was requested since
+ * the previous reset, so after the first few cycles the arena no longer
+ * allocates memory.
+ *
+ * Scratch memory is not initialized.
+ */
+class ScratchArena
+{
+public:
+    /*!
+     * The types returned by getMatrix(...) and getVector(...).
+     */
+    typedef Eigen::Map<Matrix, Eigen::Aligned> MatrixMap;
+    typedef Eigen::Map<Vector, Eigen::Aligned> VectorMap;
+
+    /*!
+     * The default capacity of an arena in bytes.
+     */
+    static const size_t DEFAULT_CAPACITY = 256 * 1024;
+
+    /*!
+     * The alignment of the memory returned by allocate(...) in bytes.
+     */
+    static const size_t ALIGNMENT = 32;
+
+    /*!
+     * The constructor.
+     *
+     * \param[in] capacity The initial capacity in bytes.
+     */
+    explicit ScratchArena(size_t capacity = DEFAULT_CAPACITY);
+
+    /*!
+     * \return The arena of the calling thread.
+     */
+    static ScratchArena & getThreadArena();
+
+    /*!
+     * Releases all of the memory that was requested from this arena.  If
+     * any request did not fit since the previous reset, the arena is grown
+     * so that it would have fit.
+     */
+    void reset();
+
+    /*!
+     * Requests uninitialized memory for an array of doubles.
+     *
+     * \param[in] size The number of doubles.
+     * \return The memory, aligned to ALIGNMENT bytes.
+     */
+    double * allocate(size_t size);
+
+    /*!
+     * Requests a scratch matrix.
+     *
+     * \param[in] rows The number of rows.
+     * \param[in] cols The number of columns.
+     * \return An uninitialized matrix that is valid until the next reset().
+     */
+    MatrixMap getMatrix(int rows, int cols)
+    {
+        return MatrixMap(allocate(static_cast<size_t>(rows) * cols), rows, cols);
+    }
+
+    /*!
+     * Requests a scratch vector.
+     *
+     * \param[in] size The number of elements.
+     * \return An uninitialized vector that is valid until the next reset().
+     */
+    VectorMap getVector(int size)
+    {
+        return VectorMap(allocate(size), size);
+    }
+
+    /*!
+     * \return The capacity of this arena in bytes.
+     */
+    size_t getCapacity() const { return capacity; }
+
+    /*!
+     * \return The largest number of bytes that were requested between two
+     * resets.
+     */
+    size_t getHighWaterMark() const { return highWaterMark; }
+
+    /*!
+     * \return The number of requests that did not fit in the arena and were
+     * served from the heap.
+     */
+    size_t getNumOverflows() const { return numOverflows; }
+
+private:
+    /*!
+     * Allocates a block of memory from the heap with room for aligning it.
+     */
+    static char * allocateBlock(size_t size, std::unique_ptr<char[]> & block);
+
+    /*!
+     * The arena's memory.
+     */
+    std::unique_ptr<char[]> buffer;
+    char * base;
+    size_t capacity;
+
+    /*!
+     * The number of bytes of the arena that are in use.
+     */
+    size_t used;
+
+    /*!
+     * The number of bytes that were requested since the last reset,
+     * including those that did not fit in the arena.
+     */
+    size_t requested;
+
+    size_t highWaterMark;
+    size_t numOverflows;
+
+    /*!
+     * The heap memory used for requests that did not fit.
+     */
+    std::vector<std::unique_ptr<char[]>> overflowBlocks;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_SCRATCH_ARENA_HPP__
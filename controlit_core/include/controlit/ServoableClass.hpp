@@ -22,6 +22,7 @@
 #define __CONTROLIT_CORE_SERVOABLE_CLASS_HPP__
 
 #include <ros/ros.h>
+#include <controlit/StateEvent.hpp>
 
 namespace controlit {
 
@@ -41,6 +42,13 @@ public:
      * Called each time the servo loop should execute.
      */
     virtual void servoUpdate() = 0;
+
+    /*!
+     * Returns the event that signals the arrival of a new robot state.
+     * Event-driven servo clocks start a servo cycle when this event occurs.
+     * The default implementation returns nullptr, meaning no such event exists.
+     */
+    virtual StateEvent * getStateEvent() { return nullptr; }
 };
 
 } // namespace controlit
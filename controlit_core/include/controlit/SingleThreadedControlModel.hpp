@@ -59,6 +59,12 @@ public:
      */
     virtual void setGravMask(std::vector<std::string> mask);
 
+    /*!
+     * Overrides the parent class' method.  Doesn't do anything
+     * since the model is updated by the servo thread.
+     */
+    virtual void setWorkerPool(WorkerPool * pool, WorkerPool::Account * account) {}
+
     /*!
      * Overrides the parent class' method.  Doesn't do anything
      * since there's only one thread in this implementation.
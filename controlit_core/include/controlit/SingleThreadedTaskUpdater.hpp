@@ -42,6 +42,11 @@ public:
    */
   ~SingleThreadedTaskUpdater();
 
+  /*!
+   * Overrides parent class to do nothing.
+   */
+  virtual void setWorkerPool(WorkerPool * pool, WorkerPool::Account * account) {}
+
   /*!
    * Overrides parent class to do nothing.
    */
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_SNAPSHOT_BUFFER_HPP__
+#define __CONTROLIT_CORE_SNAPSHOT_BUFFER_HPP__
+
+#include <atomic>
+
+namespace controlit {
+
+/*!
+ * Passes snapshots of a value from one writer thread to one reader thread
+ * without locks.  It is a triple buffer: the writer fills the back buffer
+ * and swaps it with the middle buffer, and the reader swaps the middle
+ * buffer with the front buffer whenever the writer has published a new
+ * snapshot.  Neither thread ever waits for the other, so the writer may
+ * be the servo thread.  The reader only sees the latest snapshot;
+ * snapshots published between two reads are dropped.
+ *
+ * The buffers are default constructed.  Values that hold memory, e.g.,
+ * Eigen vectors, should be sized through getBuffer(...) before the
+ * threads start so that neither thread allocates memory.
+ */
+template<class T>
+class SnapshotBuffer
+{
+public:
+    /*!
+     * The constructor.
+     */
+    SnapshotBuffer() :
+        middle(1),
+        back(0),
+        front(2)
+    {
+    }
+
+    /*!
+     * \return The buffer that the writer should fill.  It is only valid
+     * until the next call to publish().
+     */
+    T & getWriteBuffer()
+    {
+        return buffers[back];
+    }
+
+    /*!
+     * Publishes the write buffer as the latest snapshot.  This is called
+     * by the writer.
+     */
+    void publish()
+    {
+        back = middle.exchange(back | NEW_SNAPSHOT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /*!
+     * Makes the latest snapshot available through getReadBuffer().  This
+     * is called by the reader.
+     *
+     * \return Whether a snapshot was published since the previous call.
+     */
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & NEW_SNAPSHOT))
+            return false;
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    /*!
+     * \return The snapshot obtained by the last successful call to update().
+     */
+    const T & getReadBuffer() const
+    {
+        return buffers[front];
+    }
+
+    /*!
+     * Provides access to all of the buffers, e.g., to size them.  This must
+     * not be called while the threads are using the buffer.
+     *
+     * \param[in] index The index of the buffer, from 0 to 2.
+     * \return The buffer.
+     */
+    T & getBuffer(int index)
+    {
+        return buffers[index];
+    }
+
+private:
+    /*!
+     * The bit of the middle index that is set when the middle buffer holds
+     * a snapshot that the reader has not yet obtained.
+     */
+    static const int NEW_SNAPSHOT = 4;
+    static const int INDEX_MASK = 3;
+
+    T buffers[3];
+
+    /*!
+     * The index of the buffer that is exchanged between the threads.
+     */
+    std::atomic<int> middle;
+
+    /*!
+     * The index of the buffer owned by the writer.
+     */
+    int back;
+
+    /*!
+     * The index of the buffer owned by the reader.
+     */
+    int front;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_SNAPSHOT_BUFFER_HPP__
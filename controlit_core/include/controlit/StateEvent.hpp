@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_STATE_EVENT_HPP__
+#define __CONTROLIT_CORE_STATE_EVENT_HPP__
+
+#include <atomic>
+#include <cstdint>
+
+namespace controlit {
+
+/*!
+ * Signals the arrival of a new robot state.  A robot interface calls notify()
+ * from the thread that receives the state, and the servo thread calls
+ * wait(...) to start a servo cycle as soon as the state arrives.
+ *
+ * This is implemented using a Linux eventfd, so neither notify() nor wait(...)
+ * allocate memory or take locks.  Notifications that occur before wait(...)
+ * is called are not lost, but multiple notifications are merged into one.
+ */
+class StateEvent
+{
+public:
+    /*!
+     * The constructor.
+     */
+    StateEvent();
+
+    /*!
+     * The destructor.
+     */
+    ~StateEvent();
+
+    /*!
+     * Signals that a new state arrived and records the time at which it did.
+     */
+    void notify();
+
+    /*!
+     * Waits for a new state to arrive.
+     *
+     * \param[in] timeout The maximum time to wait in seconds.
+     * \return Whether a new state arrived since the previous call.  This is
+     * false if the timeout expired.
+     */
+    bool wait(double timeout);
+
+    /*!
+     * \return The time of the most recent call to notify() in the same
+     * time base as now(), or zero if notify() was never called.
+     */
+    double getNotifyTime() const;
+
+    /*!
+     * \return The current time of CLOCK_MONOTONIC in seconds.
+     */
+    static double now();
+
+private:
+    /*!
+     * The eventfd.
+     */
+    int fd;
+
+    /*!
+     * The CLOCK_MONOTONIC time of the most recent notification in nanoseconds.
+     */
+    std::atomic<int64_t> notifyTimeNS;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_STATE_EVENT_HPP__
@@ -141,6 +141,44 @@ public:
      *   - # cols = # DOFs (real + virtual)
      */
     bool getJacobian(Matrix & Jt);
+
+    /*!
+     * Copies the task's Jacobian matrix into a block of rows within a larger
+     * matrix.  This is used to stack the Jacobians of all tasks at a priority
+     * level without creating intermediate copies.
+     *
+     * \param[out] Jt The matrix into which to copy the task's Jacobian.
+     * It must have at least startRow + getJacobianRows() rows and the same
+     * number of columns as the task's Jacobian.
+     * \param[in] startRow The first row of Jt to write.
+     * \return Whether the copy was successful.
+     */
+    bool getJacobian(Matrix & Jt, int startRow);
+
+    /*!
+     * \return The number of rows in the task's Jacobian matrix, i.e., the
+     * number of task space dimensions.
+     */
+    int getJacobianRows() const;
+
+    /*!
+     * Gets a read-only view of the task's Jacobian matrix without copying it.
+     * The view refers to the active TaskState and remains valid until the
+     * next call to checkUpdatedState(), so it should only be used by the
+     * servo thread within a single servo cycle.
+     *
+     * \return A const reference to the active task Jacobian.
+     */
+    const Matrix & getJacobianView() const;
+
+    /*!
+     * Gets the version of the active task Jacobian.  The version only changes
+     * when a state update produces a Jacobian that differs from the previous
+     * one, so callers can cache results computed from an unchanged Jacobian.
+     *
+     * \return The version of the active task Jacobian.
+     */
+    unsigned long long getJacobianVersion() const;
   
     /*!
      * Obtains the task's command.
@@ -150,6 +188,20 @@ public:
      */
     virtual bool getCommand(ControlModel & model, TaskCommand & command) = 0;
   
+    /*!
+     * \return The minimum time in seconds between updates of this task's
+     * state.  A value of zero means the state is updated every time the
+     * control model changes.
+     */
+    double getUpdatePeriod() const { return updatePeriod; }
+
+    /*!
+     * \return The priority of this task's state updates.  Tasks with higher
+     * priorities are updated first.  Tasks with equal priorities are updated
+     * in order of increasing update period.
+     */
+    int getUpdatePriority() const { return updatePriority; }
+
     /*!
      * Gets the command type to determine if this is a force or task command.
      */
@@ -190,6 +242,16 @@ protected:
      */
     int tare;
 
+    /*!
+     * The minimum time in seconds between updates of this task's state.
+     */
+    double updatePeriod;
+
+    /*!
+     * The priority of this task's state updates.
+     */
+    int updatePriority;
+
 private:
 
     /*!
@@ -230,6 +292,11 @@ private:
      * The task's active state, which is read by the MainServo thread.
      */
     TaskState * activeState;
+
+    /*!
+     * The most recently assigned TaskState version.
+     */
+    unsigned long long latestStateVersion;
 };
 
 } // namespace controlit
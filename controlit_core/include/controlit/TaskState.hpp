@@ -51,6 +51,29 @@ public:
    */
   Matrix & getJacobian();
 
+  /*!
+   * A read-only accessor of the task's Jacobian matrix.
+   *
+   * \return A const reference to the task's Jacobian matrix.
+   */
+  const Matrix & getJacobian() const;
+
+  /*!
+   * Sets the version of this state.  This is called by the Task after
+   * updating this state and before making it the active state.
+   *
+   * \param[in] version The new version.
+   */
+  void setVersion(unsigned long long version);
+
+  /*!
+   * The version of this state.  The version changes every time the state is
+   * updated so users can tell whether the Jacobian may have changed.
+   *
+   * \return The version of this state.
+   */
+  unsigned long long getVersion() const;
+
   /*!
    * Sets a flag indicating that the task Jacobian marix was set.
    */
@@ -81,6 +104,11 @@ private:
    */
   bool taskJacobianSet;
 
+  /*!
+   * The version of this state.
+   */
+  unsigned long long version;
+
 };
 
 } // namespace controlit
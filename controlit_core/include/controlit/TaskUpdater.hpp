@@ -22,6 +22,8 @@
 #define __CONTROLIT_TASK_UPDATER_HPP__
 
 #include <controlit/Task.hpp>
+#include <controlit/WorkerPool.hpp>
+#include <atomic>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
@@ -51,6 +53,16 @@ public:
    */
   virtual void addTask(Task * task);
 
+  /*!
+   * Makes the task states be updated by a worker pool that is shared with
+   * other controllers instead of by a child thread of this object.  This
+   * must be called before startThread().
+   *
+   * \param[in] pool The worker pool.
+   * \param[in] account The account of the controller that owns this object.
+   */
+  virtual void setWorkerPool(WorkerPool * pool, WorkerPool::Account * account);
+
   /*!
    * Starts the child thread that updates the inactive states of the tasks.
    */
@@ -81,6 +93,44 @@ public:
    */
   virtual State getState() { return state; }
 
+  /*!
+   * \return The tasks updated by this TaskUpdater in the order in which
+   * they were added.
+   */
+  const std::vector<Task *> & getTasks() const { return taskSet; }
+
+  /*!
+   * Gets the rate at which a task's state is actually being updated.  This
+   * may be called by any thread while the tasks are being updated.
+   *
+   * \param[in] index The index of the task within getTasks().
+   * \return The filtered update rate in Hz, or zero if the task's state was
+   * updated fewer than two times.
+   */
+  double getEffectiveUpdateRate(size_t index) const;
+
+  /*!
+   * Gets the age of a task's state.  This may be called by any thread
+   * while the tasks are being updated.
+   *
+   * \param[in] index The index of the task within getTasks().
+   * \return The time in seconds since the task's state was last updated,
+   * or infinity if it was never updated by this TaskUpdater.
+   */
+  double getStaleness(size_t index) const;
+
+  /*!
+   * Limits how often the states of low priority tasks are updated.  This
+   * sheds load when the servo loop overruns.  It may be called by the
+   * servo thread while the tasks are being updated.
+   *
+   * \param[in] period The minimum time in seconds between updates of the
+   * state of each limited task.  Zero removes the limit.
+   * \param[in] maxPriority Only the tasks whose update priority is at most
+   * this value are limited.
+   */
+  void setMinUpdatePeriod(double period, int maxPriority);
+
 protected:
   /*!
    * This is executed by the child thread that updates the inactive
@@ -88,6 +138,54 @@ protected:
    */
   void updateLoop();
 
+  /*!
+   * Updates the inactive states of the tasks and sets the state to IDLE.
+   * The caller must hold the mutex.
+   */
+  void updateOnce();
+
+  /*!
+   * This is executed by the worker pool whenever the servo thread requests
+   * a task update.
+   */
+  void runPooledUpdate();
+
+  /*!
+   * \return The current time in seconds according to the ControllerClock.
+   * This is only used to schedule the task updates, so its epoch is arbitrary.
+   */
+  virtual double getCurrentTime() const;
+
+  /*!
+   * Sorts updateOrder so that tasks with higher priorities come first,
+   * followed by tasks with shorter update periods.  The priorities and
+   * periods are parameters that may change at runtime, so this is done
+   * before every update.
+   */
+  void sortUpdateOrder();
+
+  /*!
+   * \param[in] index The index of the task within taskSet.
+   * \param[in] now The current time in seconds.
+   * \return Whether the task's update period has elapsed.
+   */
+  bool isUpdateDue(size_t index, double now) const;
+
+  /*!
+   * \param[in] index The index of the task within taskSet.
+   * \return The task's update period, including the limit set by
+   * setMinUpdatePeriod(...).
+   */
+  double getUpdatePeriod(size_t index) const;
+
+  /*!
+   * Records that a task's state was updated and schedules its next update.
+   *
+   * \param[in] index The index of the task within taskSet.
+   * \param[in] now The current time in seconds.
+   */
+  void recordUpdate(size_t index, double now);
+
   /*!
    * The control mode to use when updating the tasks.
    */
@@ -111,6 +209,69 @@ protected:
    */
   std::vector<Task *> taskSet;
 
+  /*!
+   * The update schedule of a task.
+   */
+  struct TaskSchedule
+  {
+    /*!
+     * The default constructor.
+     */
+    TaskSchedule();
+
+    /*!
+     * The copy constructor.  This is needed by std::vector because the
+     * atomic members cannot be copied.  It must not be called while the
+     * tasks are being updated.
+     */
+    TaskSchedule(const TaskSchedule & other);
+
+    /*!
+     * The time at which the task's state should next be updated.
+     */
+    double nextUpdateTime;
+
+    /*!
+     * The time at which the task's state was last updated.
+     */
+    double lastUpdateTime;
+
+    /*!
+     * The filtered rate at which the task's state is updated in Hz.
+     */
+    double effectiveRate;
+
+    /*!
+     * The number of times the task's state was updated.
+     */
+    size_t numUpdates;
+
+    /*!
+     * Copies of effectiveRate and lastUpdateTime that other threads may
+     * read while the task updater writes the fields above.  The update
+     * time is negative infinity until the task's state is first updated.
+     */
+    std::atomic<double> publishedRate;
+    std::atomic<double> publishedUpdateTime;
+  };
+
+  /*!
+   * The update schedule of each task in taskSet.
+   */
+  std::vector<TaskSchedule> schedule;
+
+  /*!
+   * The indices of the tasks in taskSet in the order in which they are
+   * updated.
+   */
+  std::vector<size_t> updateOrder;
+
+  /*!
+   * The limit set by setMinUpdatePeriod(...).
+   */
+  std::atomic<double> minUpdatePeriod;
+  std::atomic<int> minUpdatePeriodMaxPriority;
+
   /*!
    * Whether the child thread should continue to run.
    */
@@ -138,6 +299,12 @@ protected:
    */
   std::thread thread;
 
+  /*!
+   * The job that updates the tasks' states, or nullptr if the child thread
+   * updates them instead.
+   */
+  WorkerPool::Job * workerJob;
+
   /*!
    * The number of times the tasks were updated.
    */
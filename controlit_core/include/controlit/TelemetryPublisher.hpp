@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_TELEMETRY_PUBLISHER_HPP__
+#define __CONTROLIT_CORE_TELEMETRY_PUBLISHER_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ros/ros.h>
+#include <sensor_msgs/JointState.h>
+#include <geometry_msgs/TransformStamped.h>
+#include <tf/transform_broadcaster.h>
+
+#include <controlit/RobotState.hpp>
+#include <controlit/SnapshotBuffer.hpp>
+
+namespace controlit {
+
+/*!
+ * The part of the robot state that is published as telemetry.  The
+ * vectors are sized when the TelemetryPublisher is initialized.
+ */
+struct TelemetrySnapshot
+{
+    /*!
+     * The ControllerClock time at which the snapshot was taken.
+     */
+    double time;
+
+    /*!
+     * The virtual joint positions in x, y, z, yaw, pitch, roll order.
+     */
+    double virtualJointPosition[NUM_VIRTUAL_DOFS];
+
+    /*!
+     * The positions, velocities and efforts of the real joints.
+     */
+    Vector jointPosition;
+    Vector jointVelocity;
+    Vector jointEffort;
+};
+
+/*!
+ * Publishes the odometry transform on /tf and the joint states on
+ * /joint_states.  The servo thread only copies the robot state into a
+ * snapshot by calling write(...).  A child thread publishes the latest
+ * snapshot at a fixed rate, so the servo thread neither allocates memory
+ * nor calls into ROS.
+ */
+class TelemetryPublisher
+{
+public:
+    /*!
+     * The constructor.
+     */
+    TelemetryPublisher();
+
+    /*!
+     * The destructor.  Stops the child thread if it is running.
+     */
+    ~TelemetryPublisher();
+
+    /*!
+     * Initializes this publisher.
+     *
+     * \param[in] nh The ROS node handle used to advertise the joint states.
+     * \param[in] jointNames The names of the real joints.
+     * \param[in] baseLinkName The name of the robot's base link, which is
+     * the child frame of the odometry transform.
+     * \param[in] rate The rate in Hz at which to publish.
+     * \return Whether the initialization was successful.
+     */
+    bool init(ros::NodeHandle & nh, const std::vector<std::string> & jointNames,
+        const std::string & baseLinkName, double rate);
+
+    /*!
+     * Records the robot state to be published.  This is called by the
+     * servo thread and does not block or allocate memory.
+     *
+     * \param[in] state The robot state.
+     */
+    void write(const RobotState & state);
+
+    /*!
+     * Starts the child thread that publishes the telemetry.
+     */
+    void startThread();
+
+    /*!
+     * Stops the child thread that publishes the telemetry.
+     */
+    void stopThread();
+
+private:
+    /*!
+     * This is executed by the child thread.
+     */
+    void publishLoop();
+
+    /*!
+     * Publishes a snapshot.
+     *
+     * \param[in] snapshot The snapshot to publish.
+     */
+    void publish(const TelemetrySnapshot & snapshot);
+
+    /*!
+     * Passes the snapshots from the servo thread to the child thread.
+     */
+    SnapshotBuffer<TelemetrySnapshot> snapshots;
+
+    /*!
+     * The rate at which to publish.
+     */
+    double rate;
+
+    /*!
+     * Publishes the joint states and the message that it publishes.
+     */
+    ros::Publisher jointStatePublisher;
+    sensor_msgs::JointState jointStateMsg;
+
+    /*!
+     * Publishes the odometry transform on topic /tf, which connects the
+     * world to the robot, and the transform that it publishes.
+     */
+    tf::TransformBroadcaster tfBroadcaster;
+    geometry_msgs::TransformStamped odometryTransform;
+
+    /*!
+     * Whether the child thread should continue to run.
+     */
+    bool keepRunning;
+
+    /*!
+     * Wakes up the child thread when it should stop.
+     */
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    /*!
+     * The child thread.
+     */
+    std::thread thread;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_TELEMETRY_PUBLISHER_HPP__
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_TRAJECTORY_HPP__
+#define __CONTROLIT_CORE_TRAJECTORY_HPP__
+
+#include <vector>
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+
+namespace controlit {
+
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
+
+/*!
+ * A multi-dimensional trajectory through a sequence of waypoints.
+ *
+ * Every interpolation type is stored as a sequence of segments, each of which
+ * is a polynomial of degree five or less in every dimension.  The memory for
+ * the segments is allocated by reserve(...), after which neither
+ * setWaypoints(...) nor evaluate(...) allocate memory.  This allows a
+ * trajectory to be built by one thread, swapped with swap(...), and evaluated
+ * by the servo thread.
+ */
+class Trajectory
+{
+public:
+    /*!
+     * The ways in which the waypoints can be connected.
+     */
+    enum InterpolationType
+    {
+        /*!
+         * Moves from waypoint to waypoint with a trapezoidal velocity profile
+         * that respects the velocity and acceleration limits.  The robot comes
+         * to rest at every waypoint.  All dimensions start and stop together.
+         * A waypoint is reached at its time or as soon as the limits permit,
+         * whichever is later.
+         */
+        TRAPEZOID_VELOCITY = 0,
+
+        /*!
+         * A cubic spline with continuous acceleration that starts and ends
+         * at rest.
+         */
+        CUBIC_SPLINE = 1,
+
+        /*!
+         * A quintic spline with the same knot velocities and accelerations as
+         * the cubic spline, except that the acceleration is zero at the start
+         * and end.  This avoids the jumps in acceleration at the ends of the
+         * cubic spline.
+         */
+        QUINTIC_SPLINE = 2,
+
+        /*!
+         * A minimum-jerk motion between each pair of waypoints.  The robot
+         * comes to rest at every waypoint.
+         */
+        MINIMUM_JERK = 3
+    };
+
+    /*!
+     * The number of coefficients in each dimension of a segment.
+     */
+    static const int NUM_COEFFICIENTS = 6;
+
+    /*!
+     * The default constructor.  The trajectory has no capacity until
+     * reserve(...) is called.
+     */
+    Trajectory();
+
+    /*!
+     * Allocates the memory used by the trajectory and clears it.
+     *
+     * \param[in] numDims The number of dimensions.
+     * \param[in] maxSegments The maximum number of segments.  A trapezoid
+     * velocity trajectory uses up to three segments per pair of waypoints.
+     * The other interpolation types use one.
+     */
+    void reserve(int numDims, int maxSegments);
+
+    /*!
+     * Replaces this trajectory with one through the specified waypoints.
+     * This does not allocate memory.
+     *
+     * \param[in] type How the waypoints should be connected.
+     * \param[in] times The time of each waypoint in seconds relative to the
+     * start of the trajectory.  The first time must be zero and the times
+     * must be increasing.  For TRAPEZOID_VELOCITY the times may be equal,
+     * in which case the waypoints are reached as soon as possible.
+     * \param[in] waypoints The waypoints.  Each column is a waypoint.
+     * \param[in] maxVelocity The velocity limit of each dimension.  This is
+     * only used by TRAPEZOID_VELOCITY.
+     * \param[in] maxAcceleration The acceleration limit of each dimension.
+     * This is only used by TRAPEZOID_VELOCITY.
+     * \return Whether the trajectory was created.  If not, the trajectory
+     * is empty.
+     */
+    bool setWaypoints(InterpolationType type, const std::vector<double> & times,
+        const Matrix & waypoints, const Vector & maxVelocity, const Vector & maxAcceleration);
+
+    /*!
+     * Removes all segments from this trajectory.
+     */
+    void clear();
+
+    /*!
+     * Evaluates the trajectory.  Before the start, the trajectory is at the
+     * first waypoint.  After the end, it is at rest at the last waypoint.
+     * This does not allocate memory as long as position and velocity are
+     * already of size getNumDims().
+     *
+     * \param[in] time The time relative to the start of the trajectory.
+     * This is fastest when the time increases between calls.
+     * \param[out] position Where the position should be stored.
+     * \param[out] velocity Where the velocity should be stored.
+     * \return Whether the trajectory has any segments.
+     */
+    bool evaluate(double time, Vector & position, Vector & velocity);
+
+    /*!
+     * Exchanges the contents of two trajectories without copying or
+     * allocating memory.
+     */
+    void swap(Trajectory & other);
+
+    /*!
+     * \return Whether this trajectory has any segments.
+     */
+    bool empty() const { return numSegments == 0; }
+
+    /*!
+     * \return The number of dimensions.
+     */
+    int getNumDims() const { return numDims; }
+
+    /*!
+     * \return The number of segments in this trajectory.
+     */
+    int getNumSegments() const { return numSegments; }
+
+    /*!
+     * \return The maximum number of segments this trajectory can hold.
+     */
+    int getMaxSegments() const { return coefficients.cols(); }
+
+    /*!
+     * \return The duration of the trajectory in seconds.
+     */
+    double getDuration() const { return numSegments == 0 ? 0 : segmentTimes[numSegments]; }
+
+private:
+    /*!
+     * Adds a segment to the end of the trajectory.
+     *
+     * \param[in] duration The duration of the segment.
+     * \return The coefficients of the new segment, or nullptr if there is
+     * no room for another segment.
+     */
+    double * addSegment(double duration);
+
+    /*!
+     * Adds a quintic segment that interpolates the position, velocity, and
+     * acceleration at both ends.
+     *
+     * \return Whether there was room for the segment.
+     */
+    bool addQuinticSegment(double duration,
+        const Eigen::Ref<const Vector> & p0, const Eigen::Ref<const Vector> & v0, const Eigen::Ref<const Vector> & a0,
+        const Eigen::Ref<const Vector> & p1, const Eigen::Ref<const Vector> & v1, const Eigen::Ref<const Vector> & a1);
+
+    bool buildTrapezoid(const std::vector<double> & times, const Matrix & waypoints,
+        const Vector & maxVelocity, const Vector & maxAcceleration);
+
+    bool buildSpline(InterpolationType type, const std::vector<double> & times, const Matrix & waypoints);
+
+    bool buildMinimumJerk(const std::vector<double> & times, const Matrix & waypoints);
+
+    /*!
+     * The number of dimensions.
+     */
+    int numDims;
+
+    /*!
+     * The number of segments in use.
+     */
+    int numSegments;
+
+    /*!
+     * The polynomial coefficients of the segments.  Column s holds segment s.
+     * Within a column, the coefficients of each dimension are contiguous and
+     * in increasing order of degree.  The polynomials are in terms of the
+     * time since the start of the segment.
+     */
+    Matrix coefficients;
+
+    /*!
+     * The start time of each segment followed by the end time of the last one.
+     */
+    std::vector<double> segmentTimes;
+
+    /*!
+     * The segment that was most recently evaluated.
+     */
+    int currentSegment;
+
+    /*!
+     * Scratch space used while building splines.  Each column belongs to
+     * a waypoint.
+     */
+    Matrix knotVelocities;
+    Matrix knotAccelerations;
+
+    /*!
+     * The modified super-diagonal used when solving for the knot velocities.
+     */
+    Vector splineScratch;
+
+    /*!
+     * A vector of zeros with one element per dimension.
+     */
+    Vector zero;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_TRAJECTORY_HPP__
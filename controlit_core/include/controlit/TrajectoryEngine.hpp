@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_TRAJECTORY_ENGINE_HPP__
+#define __CONTROLIT_CORE_TRAJECTORY_ENGINE_HPP__
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+
+#include <controlit/CompoundTask.hpp>
+#include <controlit/Parameter.hpp>
+#include <controlit/Timer.hpp>
+#include <controlit/Trajectory.hpp>
+#include <controlit_core/GoalTrajectory.h>
+
+namespace controlit {
+
+/*!
+ * Makes tasks follow trajectories that are interpolated on the servo thread.
+ *
+ * Trajectories are received as controlit_core/GoalTrajectory messages on the
+ * "goal_trajectory" topic.  One message describes an entire motion, which
+ * replaces a stream of goal updates.  The message is converted into segments
+ * by the ROS callback thread and handed to the servo thread, which evaluates
+ * the trajectory and sets the task's goalPosition and goalVelocity parameters
+ * each cycle.
+ *
+ * Every task with a goalPosition vector parameter can follow a trajectory.
+ * The memory for its trajectories is allocated by init(...), so the servo
+ * thread neither allocates memory nor blocks.
+ */
+class TrajectoryEngine
+{
+public:
+    /*!
+     * The default constructor.
+     */
+    TrajectoryEngine();
+
+    /*!
+     * The destructor.
+     */
+    ~TrajectoryEngine();
+
+    /*!
+     * Allocates the trajectories of the tasks in the compound task and
+     * subscribes to the trajectory topic.  This must be called after the
+     * compound task is initialized since that determines the sizes of the
+     * goal parameters.
+     *
+     * \param[in] nh The ROS node handle.
+     * \param[in] compoundTask The compound task.  It must outlive this object.
+     * \param[in] timer The timer used to measure the progress along the
+     * trajectories.  It should use the same clock as the robot interface.
+     * \param[in] maxSegments The maximum number of segments per trajectory.
+     * \return Whether the initialization was successful.
+     */
+    bool init(ros::NodeHandle & nh, CompoundTask & compoundTask, std::shared_ptr<Timer> timer, int maxSegments);
+
+    /*!
+     * Starts any newly received trajectories and updates the goals of the
+     * tasks that are following a trajectory.  This should be called by the
+     * servo thread before the command is computed.
+     */
+    void update();
+
+    /*!
+     * \return The number of tasks that can follow trajectories.
+     */
+    size_t getNumTasks() const { return channels.size(); }
+
+private:
+    /*!
+     * The trajectories of a single task.
+     */
+    struct Channel
+    {
+        /*!
+         * The parameters that are set by the trajectory.  The goal velocity
+         * is nullptr if the task does not have one.
+         */
+        Parameter * goalPosition;
+        Parameter * goalVelocity;
+
+        /*!
+         * The trajectory that is being followed.  This is only accessed by
+         * the servo thread.
+         */
+        Trajectory active;
+
+        /*!
+         * A trajectory that was received but not yet started.  It is built
+         * by the ROS callback thread.
+         */
+        Trajectory pending;
+        bool hasPending;
+
+        /*!
+         * Protects the pending trajectory.  The servo thread only ever tries
+         * to lock it, so it starts a trajectory one cycle late rather than
+         * wait for one to be built.
+         */
+        std::mutex mutex;
+
+        /*!
+         * Whether the active trajectory is being followed, and the time at
+         * which it started.
+         */
+        bool following;
+        double startTime;
+
+        /*!
+         * Preallocated space for the goals set by the active trajectory.
+         */
+        Vector position;
+        Vector velocity;
+    };
+
+    /*!
+     * Converts a received message into a pending trajectory.
+     */
+    void trajectoryCallback(const controlit_core::GoalTrajectory::ConstPtr & msg);
+
+    /*!
+     * The channels indexed by task name.
+     */
+    std::map<std::string, std::unique_ptr<Channel>> channels;
+
+    /*!
+     * The channels in an order that can be iterated by the servo thread.
+     */
+    std::vector<Channel *> channelList;
+
+    /*!
+     * Measures the time since init(...) was called.
+     */
+    std::shared_ptr<Timer> timer;
+
+    ros::Subscriber trajectorySubscriber;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_TRAJECTORY_ENGINE_HPP__
@@ -80,11 +80,36 @@ public:
      */
     void update(RigidBodyDynamics::Model& robot, ConstraintSet& updatedConstraints, const Vector& Q, Matrix const& Ainv);
 
+    /*!
+     * The two steps of update(...), for callers that run them concurrently
+     * with the constraint set's update.  updateContacts(...) only needs the
+     * constraint Jacobian, so it may run concurrently with
+     * ConstraintSet::updateProjections(...).  updateProjections(...) must
+     * run after both.
+     */
+    void updateContacts(RigidBodyDynamics::Model& robot, ConstraintSet& updatedConstraints, const Vector& Q, Matrix const& Ainv);
+    void updateProjections(ConstraintSet& updatedConstraints);
+
     /*!
      * Determines whether it is valid to do calculations with this VLM
      */
     bool exists() const {return exists_;}
 
+    /*!
+     * Sets whether updateProjections(...) computes Jlstar, Lstar^T * Jlstar^T
+     * and Wint * JcBar^T.  Only internal force tasks use them and they
+     * require a pseudo-inverse, so this is disabled by default.  A change
+     * takes effect at the next update.
+     *
+     * \param[in] enabled Whether to compute the internal force operators.
+     */
+    void setInternalForceOperatorsEnabled(bool enabled) {internalForceOperatorsEnabled_ = enabled;}
+
+    /*!
+     * Whether updateProjections(...) computes the internal force operators.
+     */
+    bool internalForceOperatorsEnabled() const {return internalForceOperatorsEnabled_;}
+
     /*!
      * Retruns the threshold for singular values
      */
@@ -240,6 +265,31 @@ public:
      */
     const Matrix& getLstar() const {return Lstar_;}
 
+    /*!
+     * Gets Jlstar, the pseudo-inverse of Lstar * U * JcBar * Wint^T, which
+     * maps internal forces to actuable torques.  This and the two operators
+     * below are only updated if internalForceOperatorsEnabled().
+     *
+     * \return Jlstar This is where the result is stored.
+     */
+    const Matrix& getJlstar() const {return Jlstar_;}
+
+    /*!
+     * Gets Lstar^T * Jlstar^T, which maps an internal force error to the
+     * torques that correct it.
+     *
+     * \return LstarTJlstarT This is where the result is stored.
+     */
+    const Matrix& getLstarTJlstarT() const {return LstarTJlstarT_;}
+
+    /*!
+     * Gets Wint * JcBar^T, which maps joint torques to the internal forces
+     * they produce.
+     *
+     * \return WintJsbarT This is where the result is stored.
+     */
+    const Matrix& getWintJsbarT() const {return WintJsbarT_;}
+
     /*!
      * Gets FrSensor, the concatenated force sensor info in global frame
      *
@@ -269,6 +319,13 @@ private:
      */
     bool updateJc(ConstraintSet& constraints);
 
+     /*!
+     * Updates Jlstar_, LstarTJlstarT_ and WintJsbarT_ from Lstar_, JcBar_
+     * and Wint_.  These only change with the model, so computing them here
+     * leaves only matrix-vector products for the servo thread.
+     */
+    void updateInternalForceOperators(ConstraintSet& constraints);
+
      /*!
      * Updates Wint_ and (by default) Phi_
      */
@@ -308,6 +365,7 @@ private:
      */
     bool initialized_;
     bool exists_; //Use to check whether this is even valid
+    bool internalForceOperatorsEnabled_; //Whether Jlstar_, LstarTJlstarT_ and WintJsbarT_ are updated
     double sigmaThreshold_; //For SVD--singular values
     Matrix Wint_; //Internal part of grasp matrix for Fr at COP
     Matrix WintSensor_; //Internal part of grasp matrix for Fr at Sensor location
@@ -319,11 +377,16 @@ private:
     Matrix UNc_; //U_*Nc_
     Matrix UNcBar_; //Dynamically consistent psuedo-inverse of U*Nc
     Matrix Lstar_; //Id_{gamma} - UNc_*UNcBar_
+    Matrix Jlstar_; //Pseudo-inverse of Lstar_*U_*JcBar_*Wint_^T
+    Matrix LstarTJlstarT_; //Lstar_^T*Jlstar_^T
+    Matrix WintJsbarT_; //Wint_*JcBar_^T
     Vector FrSensor_; //Convenient to store 6*contactConstraintCount Fr_ in the right order here, since ContactConstraints are hooked up to contact sensors
 
     /*!
      * Utility variables for internal calulcations
      */
+    Matrix UJsbar_; //Actuable rows of JcBar_
+    Matrix Jlstarbar_; //Lstar_*U_*JcBar_*Wint_^T
     Matrix JcFull_; //Full Jacobian of constraints including transmission constraints
     Matrix Id_col;  //Identity with size of columns in Jc_
     Matrix Id_row;  //Identity with size of rows in Jc_
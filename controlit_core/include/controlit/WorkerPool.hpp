@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_CORE_WORKER_POOL_HPP__
+#define __CONTROLIT_CORE_WORKER_POOL_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <semaphore.h>
+
+namespace controlit {
+
+/*!
+ * A pool of worker threads that is shared by the model and task updates of
+ * several controllers running in the same process.  Each worker may be
+ * pinned to a CPU core.
+ *
+ * The work is organized into jobs, and every job belongs to an account.
+ * There is typically one account per controller.  A job is a function that
+ * is run once by some worker after each time it is submitted.  Submitting a
+ * job that is still pending has no effect, and a job never runs on two
+ * workers at once.
+ *
+ * Each account may be given a CPU quota, which is the fraction of one core
+ * its jobs may use per accounting period.  Once an account exhausts its
+ * quota, its pending jobs wait for the next accounting period so that one
+ * controller cannot starve the others.  The queueing latency and run time
+ * of each account's jobs are recorded.
+ */
+class WorkerPool
+{
+public:
+    /*!
+     * The usage of an account since its statistics were last reset.
+     */
+    struct Statistics
+    {
+        Statistics();
+
+        /*!
+         * The number of jobs that were run.
+         */
+        size_t numJobs;
+
+        /*!
+         * The total and maximum time in seconds from the submission of a job
+         * until it started running.
+         */
+        double totalQueueLatency;
+        double maxQueueLatency;
+
+        /*!
+         * The total and maximum time in seconds that the jobs ran.
+         */
+        double totalRunTime;
+        double maxRunTime;
+
+        /*!
+         * The number of submissions that were delayed because the account
+         * exhausted its quota.
+         */
+        size_t numThrottled;
+
+        /*!
+         * The time in seconds over which these statistics were collected.
+         */
+        double duration;
+    };
+
+    /*!
+     * An account whose jobs share a CPU quota.
+     */
+    class Account
+    {
+    public:
+        /*!
+         * \return The name of this account.
+         */
+        const std::string & getName() const { return name; }
+
+        /*!
+         * \return The fraction of one core this account may use per
+         * accounting period, or zero if it is unlimited.
+         */
+        double getQuota() const { return quota; }
+
+    private:
+        friend class WorkerPool;
+
+        Account(const std::string & name, double quota);
+
+        std::string name;
+        double quota;
+
+        /*!
+         * The CPU time in nanoseconds used during the current accounting period.
+         */
+        int64_t usedNS;
+
+        /*!
+         * When the statistics were last reset, in nanoseconds.
+         */
+        int64_t statisticsStartNS;
+
+        Statistics statistics;
+    };
+
+    /*!
+     * A function that is run by the pool whenever it is submitted.
+     */
+    class Job
+    {
+    public:
+        /*!
+         * Marks this job as pending and wakes up a worker.  This neither
+         * blocks nor allocates memory, so it may be called by the servo thread.
+         */
+        void submit();
+
+        /*!
+         * Withdraws the submission of this job if no worker has started
+         * running it yet.  Like submit(), this neither blocks nor allocates
+         * memory.
+         *
+         * \return Whether the submission was withdrawn.  If not, the job is
+         * either not pending or a worker is about to run it.
+         */
+        bool cancel();
+
+    private:
+        friend class WorkerPool;
+
+        Job(WorkerPool & pool, Account & account, std::function<void()> function);
+
+        WorkerPool & pool;
+        Account & account;
+        std::function<void()> function;
+
+        /*!
+         * Whether the job was submitted and has not started running yet.
+         */
+        std::atomic<bool> pending;
+
+        /*!
+         * When the pending job was submitted, in nanoseconds.
+         */
+        std::atomic<int64_t> submitTimeNS;
+
+        /*!
+         * Whether a worker is running the job.
+         */
+        bool running;
+
+        /*!
+         * Whether the pending job was delayed by its account's quota.
+         */
+        bool throttled;
+    };
+
+    /*!
+     * The constructor.
+     */
+    WorkerPool();
+
+    /*!
+     * The destructor.  Stops the workers.
+     */
+    ~WorkerPool();
+
+    /*!
+     * Initializes this pool.
+     *
+     * \param[in] numWorkers The number of worker threads.
+     * \param[in] cores The CPU cores to pin the workers to.  Worker i is
+     * pinned to cores[i % cores.size()].  If this is empty the workers are
+     * not pinned.
+     * \param[in] accountingPeriod The period in seconds over which the CPU
+     * quotas are enforced.
+     * \return Whether the initialization was successful.
+     */
+    bool init(size_t numWorkers, const std::vector<int> & cores, double accountingPeriod);
+
+    /*!
+     * Adds an account.  The account remains valid until this pool is destroyed.
+     *
+     * \param[in] name The name of the account.
+     * \param[in] quota The fraction of one core the account's jobs may use
+     * per accounting period, or zero for no limit.
+     * \return The account.
+     */
+    Account * addAccount(const std::string & name, double quota);
+
+    /*!
+     * Adds a job.  The job remains valid until this pool is destroyed.
+     *
+     * \param[in] account The account the job belongs to.
+     * \param[in] function The function to run whenever the job is submitted.
+     * \return The job.
+     */
+    Job * addJob(Account * account, std::function<void()> function);
+
+    /*!
+     * Starts the workers.
+     *
+     * \return Whether the workers were started and pinned to their cores.
+     */
+    bool start();
+
+    /*!
+     * Stops the workers after they finish the jobs they are running.
+     * Pending jobs are not run.
+     */
+    void stop();
+
+    /*!
+     * Gets the statistics of an account.
+     *
+     * \param[in] account The account.
+     * \param[in] reset Whether to reset the account's statistics.
+     * \return The statistics.
+     */
+    Statistics getStatistics(Account * account, bool reset);
+
+    /*!
+     * \return The current time of the monotonic clock in nanoseconds.
+     */
+    static int64_t now();
+
+private:
+    /*!
+     * Executed by each worker thread.
+     */
+    void workerLoop();
+
+    /*!
+     * Claims the next pending job that may run.  The caller must hold mutex.
+     *
+     * \param[in] nowNS The current time.
+     * \return The job, or nullptr if no pending job may run.
+     */
+    Job * claimJob(int64_t nowNS);
+
+    /*!
+     * Waits until a job is submitted or until a deadline passes.
+     *
+     * \param[in] deadlineNS The deadline on the monotonic clock.
+     */
+    void waitForSubmission(int64_t deadlineNS);
+
+    bool initialized;
+    bool started;
+
+    /*!
+     * Whether the workers should exit.
+     */
+    bool stopping;
+
+    size_t numWorkers;
+    std::vector<int> cores;
+    int64_t accountingPeriodNS;
+
+    /*!
+     * When the current accounting period started.
+     */
+    int64_t periodStartNS;
+
+    /*!
+     * Whether a pending job is waiting for the next accounting period.
+     */
+    bool hasThrottledJob;
+
+    /*!
+     * The index of the job to consider first when claiming a job, so that
+     * the jobs take turns.
+     */
+    size_t nextJob;
+
+    std::vector<std::unique_ptr<Account>> accounts;
+    std::vector<std::unique_ptr<Job>> jobs;
+
+    /*!
+     * Protects everything above except the jobs' pending flags and
+     * submission times.
+     */
+    std::mutex mutex;
+
+    /*!
+     * Posted whenever a job is submitted.
+     */
+    sem_t semaphore;
+
+    std::vector<std::thread> workers;
+};
+
+} // namespace controlit
+
+#endif // __CONTROLIT_CORE_WORKER_POOL_HPP__
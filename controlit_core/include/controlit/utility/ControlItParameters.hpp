@@ -21,10 +21,13 @@
 #ifndef __CONTROLIT_CORE_CONTROLIT_PARAMETERS_HPP__
 #define __CONTROLIT_CORE_CONTROLIT_PARAMETERS_HPP__
 
+#include <map>
 #include <vector>
 #include "ros/ros.h"
 
 #include <controlit/parser/Header.hpp>
+#include <controlit/LoadGovernor.hpp>
+#include <controlit/RealTimeConfig.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
 #include <controlit/addons/ros/ROSParameterAccessor.hpp>
 
@@ -169,6 +172,103 @@ public:
      */
     bool useSingleThreadedTaskUpdater() { return useSingleThreadedTaskUpdater_; }
 
+    /*!
+     * \return Whether the controller runs in lockstep with a simulator.  In
+     * this mode the servo cycles are started by ServoClockLockstep::step(...),
+     * the model and tasks are updated within each servo cycle, and the
+     * controller uses simulated time.
+     */
+    bool useLockstep() { return lockstep; }
+
+    /*!
+     * \return The number of helper threads used to compute task commands.
+     * Zero means task commands are computed serially on the servo thread.
+     * With a shared worker pool, this is the number of helper jobs instead.
+     */
+    int getNumTaskCommandThreads() { return numTaskCommandThreads; }
+
+    /*!
+     * \return The CPUs to which the task command threads should be pinned.
+     */
+    const std::vector<int> & getTaskCommandThreadCPUs() { return taskCommandThreadCPUs; }
+
+    /*!
+     * \return The number of helper threads used to run the independent
+     * steps of each model update concurrently.  Zero means the model is
+     * updated serially.  With a shared worker pool, this is the number of
+     * helper jobs instead.
+     */
+    int getNumModelUpdateThreads() { return numModelUpdateThreads; }
+
+    /*!
+     * \return The CPUs to which the model update threads should be pinned.
+     */
+    const std::vector<int> & getModelUpdateThreadCPUs() { return modelUpdateThreadCPUs; }
+
+    /*!
+     * \return The maximum number of segments in a goal trajectory.
+     * Zero means tasks cannot follow goal trajectories.
+     */
+    int getMaxTrajectorySegments() { return maxTrajectorySegments; }
+
+    /*!
+     * \return How far the control model may be extrapolated to the latest
+     * joint positions, in units of the distance between the last two model
+     * updates.  Zero means the control model is not extrapolated.
+     */
+    double getMaxModelExtrapolation() { return maxModelExtrapolation; }
+
+    /*!
+     * \return The rate in Hz at which the odometry transform and the joint
+     * states are published.
+     */
+    double getTelemetryRate() { return telemetryRate; }
+
+    /*!
+     * \return The thresholds used by the ModelUpdatePolicy.  Zero disables
+     * the corresponding kind of update.
+     */
+    double getModelUpdateSkipPositionThreshold() { return modelUpdateSkipPositionThreshold; }
+    double getModelUpdateSkipVelocityThreshold() { return modelUpdateSkipVelocityThreshold; }
+    double getModelUpdatePartialPositionThreshold() { return modelUpdatePartialPositionThreshold; }
+
+    /*!
+     * \return The fraction of one core that the model and task updates may
+     * use when they run on a worker pool shared with other controllers.
+     * Zero means there is no limit.
+     */
+    double getWorkerCPUQuota() { return workerCPUQuota; }
+
+    /*!
+     * \return Whether to lock the process' memory into RAM once the
+     * controller is initialized.
+     */
+    bool getLockMemory() { return lockMemory; }
+
+    /*!
+     * \return The number of bytes of stack to prefault in each ControlIt!
+     * thread when memory is locked.
+     */
+    int getPrefaultStackSize() { return prefaultStackSize; }
+
+    /*!
+     * \return The scheduling policies, priorities and CPU sets requested
+     * for the ControlIt! threads, indexed by thread name.
+     */
+    const std::map<std::string, ThreadPlacement> & getThreadPlacements() { return threadPlacements; }
+
+    /*!
+     * \return The name of the GeneratedDynamics plugin that computes the
+     * robot's dynamics, or an empty string if they are computed from the
+     * generic RBDL model.
+     */
+    const std::string & getGeneratedDynamicsType() { return generatedDynamicsType; }
+
+    /*!
+     * \return How the servo loop sheds load when it overruns.
+     */
+    const DegradationConfig & getDegradationConfig() { return degradation; }
+
     /*!
      * \return Whether to use a single threaded sensor updater
      */
@@ -302,6 +402,18 @@ private:
 
     bool loadControlModelSingleThreadedOption(ros::NodeHandle & nh);
     bool loadTaskUpdaterSingleThreadedOption(ros::NodeHandle & nh);
+    bool loadLockstepOption(ros::NodeHandle & nh);
+    bool loadTaskCommandThreads(ros::NodeHandle & nh);
+    bool loadModelUpdateThreads(ros::NodeHandle & nh);
+    bool loadMaxTrajectorySegments(ros::NodeHandle & nh);
+    bool loadMaxModelExtrapolation(ros::NodeHandle & nh);
+    bool loadTelemetryRate(ros::NodeHandle & nh);
+    bool loadModelUpdateThresholds(ros::NodeHandle & nh);
+    bool loadWorkerCPUQuota(ros::NodeHandle & nh);
+    bool loadMemoryLocking(ros::NodeHandle & nh);
+    bool loadThreadPlacements(ros::NodeHandle & nh);
+    bool loadGeneratedDynamicsType(ros::NodeHandle & nh);
+    bool loadDegradation(ros::NodeHandle & nh);
     // bool loadSingleThreadedSensorUpdater();
     bool loadUpdateRate(ros::NodeHandle & nh);
     bool loadMaxEffortCmd(ros::NodeHandle & nh);
@@ -392,6 +504,83 @@ private:
      */
     bool useSingleThreadedTaskUpdater_;
 
+    /*!
+     * Whether the controller runs in lockstep with a simulator.
+     */
+    bool lockstep;
+
+    /*!
+     * The number of helper threads used to compute task commands.
+     */
+    int numTaskCommandThreads;
+
+    /*!
+     * The CPUs to which the task command threads are pinned.
+     */
+    std::vector<int> taskCommandThreadCPUs;
+
+    /*!
+     * The number of helper threads used to update the model.
+     */
+    int numModelUpdateThreads;
+
+    /*!
+     * The CPUs to which the model update threads are pinned.
+     */
+    std::vector<int> modelUpdateThreadCPUs;
+
+    /*!
+     * The maximum number of segments in a goal trajectory.
+     */
+    int maxTrajectorySegments;
+
+    /*!
+     * The maximum extrapolation of the control model.
+     */
+    double maxModelExtrapolation;
+
+    /*!
+     * The rate at which the telemetry is published.
+     */
+    double telemetryRate;
+
+    /*!
+     * The largest joint position and velocity changes for which a model
+     * update is skipped, and the largest joint position change since the
+     * last full model update for which only a partial update is done.
+     */
+    double modelUpdateSkipPositionThreshold;
+    double modelUpdateSkipVelocityThreshold;
+    double modelUpdatePartialPositionThreshold;
+
+    /*!
+     * The CPU quota of the model and task updates on a shared worker pool.
+     */
+    double workerCPUQuota;
+
+    /*!
+     * Whether to lock the process' memory and how much of each thread's
+     * stack to prefault.
+     */
+    bool lockMemory;
+    int prefaultStackSize;
+
+    /*!
+     * The placements of the ControlIt! threads.  Threads without an entry
+     * keep the default placement.
+     */
+    std::map<std::string, ThreadPlacement> threadPlacements;
+
+    /*!
+     * The name of the GeneratedDynamics plugin to use, if any.
+     */
+    std::string generatedDynamicsType;
+
+    /*!
+     * The configuration of the LoadGovernor.
+     */
+    DegradationConfig degradation;
+
     /*!
      * The gravity vector in m/s^2.  It should have a length of 3 (x, y, z).
      * By default it is (0, 0, -9.81).
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/AllocationCheck.hpp>
+
+#ifdef CONTROLIT_CHECK_SERVO_ALLOCATIONS
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+// The glibc allocator, which the interposed functions forward to.
+extern "C" void * __libc_malloc(size_t size);
+extern "C" void * __libc_calloc(size_t num, size_t size);
+extern "C" void * __libc_realloc(void * ptr, size_t size);
+extern "C" void * __libc_memalign(size_t alignment, size_t size);
+#endif
+
+namespace controlit {
+
+namespace {
+
+/*!
+ * The number of enabled NoAllocationScopes of the calling thread.  The
+ * initial-exec model ensures accessing it never allocates, which would
+ * recurse into the interposed malloc.
+ */
+__thread int noAllocationDepth __attribute__((tls_model("initial-exec"))) = 0;
+
+} // namespace
+
+NoAllocationScope::NoAllocationScope(bool enabled) :
+    enabled(enabled)
+{
+    if (enabled)
+        noAllocationDepth++;
+}
+
+NoAllocationScope::~NoAllocationScope()
+{
+    if (enabled)
+        noAllocationDepth--;
+}
+
+bool NoAllocationScope::isCheckEnabled()
+{
+#ifdef CONTROLIT_CHECK_SERVO_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool NoAllocationScope::isActive()
+{
+    return noAllocationDepth > 0;
+}
+
+AllowAllocationScope::AllowAllocationScope() :
+    savedDepth(noAllocationDepth)
+{
+    noAllocationDepth = 0;
+}
+
+AllowAllocationScope::~AllowAllocationScope()
+{
+    noAllocationDepth = savedDepth;
+}
+
+} // namespace controlit
+
+#ifdef CONTROLIT_CHECK_SERVO_ALLOCATIONS
+
+namespace {
+
+/*!
+ * Aborts if the calling thread is within a NoAllocationScope.  The message
+ * is written directly to stderr since the logging facilities may allocate.
+ */
+inline void checkAllocation(const char * function)
+{
+    if (controlit::noAllocationDepth > 0)
+    {
+        controlit::noAllocationDepth = 0;
+
+        const char * prefix = "ControlIt: ";
+        const char * suffix = " was called within a NoAllocationScope\n";
+        ssize_t result;
+        result = write(STDERR_FILENO, prefix, strlen(prefix));
+        result = write(STDERR_FILENO, function, strlen(function));
+        result = write(STDERR_FILENO, suffix, strlen(suffix));
+        (void)result;
+
+        abort();
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+void * malloc(size_t size)
+{
+    checkAllocation("malloc");
+    return __libc_malloc(size);
+}
+
+void * calloc(size_t num, size_t size)
+{
+    checkAllocation("calloc");
+    return __libc_calloc(num, size);
+}
+
+void * realloc(void * ptr, size_t size)
+{
+    checkAllocation("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void ** ptr, size_t alignment, size_t size)
+{
+    checkAllocation("posix_memalign");
+    void * memory = __libc_memalign(alignment, size);
+    if (memory == nullptr)
+        return ENOMEM;
+    *ptr = memory;
+    return 0;
+}
+
+} // extern "C"
+
+#endif // CONTROLIT_CHECK_SERVO_ALLOCATIONS
@@ -0,0 +1,425 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/BatchEvaluator.hpp>
+
+#include <chrono>
+#include <thread>
+
+#include <controlit/Task.hpp>
+#include <controlit/TimerChrono.hpp>
+#include <controlit/ScratchArena.hpp>
+#include <controlit/logging/RealTimeLogging.hpp>
+
+namespace controlit {
+
+// Uncomment one of the following lines to enable/disable detailed debug statements.
+#define PRINT_INFO_STATEMENT(ss)
+// #define PRINT_INFO_STATEMENT(ss) CONTROLIT_INFO << ss;
+
+BatchEvaluator::BatchEvaluator() :
+    initialized(false),
+    pendingJobs(0),
+    currentInput(nullptr),
+    currentOutput(nullptr)
+{
+}
+
+BatchEvaluator::~BatchEvaluator()
+{
+    // Stop the helper threads before destroying the workers they use.
+    threadPool.reset();
+}
+
+bool BatchEvaluator::init(ros::NodeHandle & nh, size_t numWorkers)
+{
+    if (initialized)
+    {
+        CONTROLIT_ERROR << "Already initialized!";
+        return false;
+    }
+
+    if (numWorkers == 0)
+    {
+        CONTROLIT_ERROR << "At least one worker is required!";
+        return false;
+    }
+
+    if (!nh.getParam("controlit/robot_description", urdfDescription))
+    {
+        CONTROLIT_ERROR << "Parameter '" << nh.getNamespace() << "/controlit/robot_description' is not set!";
+        return false;
+    }
+
+    if (!nh.getParam("controlit/parameters", yamlParameters))
+    {
+        CONTROLIT_ERROR << "Parameter '" << nh.getNamespace() << "/controlit/parameters' is not set";
+        return false;
+    }
+
+    if (!controlitParameters.init(nh))
+        return false;
+
+    // The workers are created one at a time since creating a model saves
+    // the joint limits in the shared parameters.
+    try
+    {
+        for (size_t ii = 0; ii < numWorkers; ii++)
+        {
+            PRINT_INFO_STATEMENT("Initializing worker " << ii << "...");
+
+            workers.emplace_back(new Worker());
+            if (!initWorker(nh, *workers.back()))
+            {
+                CONTROLIT_ERROR << "Failed to initialize worker " << ii;
+                workers.clear();
+                return false;
+            }
+
+            if (ii == 0 && (!controlitParameters.checkParameters() || !checkStateless(*workers[0])))
+            {
+                workers.clear();
+                return false;
+            }
+        }
+    }
+    catch (std::exception & err)
+    {
+        CONTROLIT_ERROR << "Exception thrown during initialization: " << err.what();
+        workers.clear();
+        return false;
+    }
+
+    // Worker zero is the calling thread, so the helper threads are workers 1 to numWorkers - 1.
+    if (numWorkers > 1)
+    {
+        threadPool.reset(new controlit::addons::cpp::ThreadPool(numWorkers - 1));
+
+        for (size_t ii = 1; ii < numWorkers; ii++)
+            jobs.push_back([this, ii]() { runJob(ii); });
+    }
+
+    initialized = true;
+    return true;
+}
+
+bool BatchEvaluator::initWorker(ros::NodeHandle & nh, Worker & worker)
+{
+    worker.model.reset(ControlModel::createModel(urdfDescription, yamlParameters,
+        &worker.robotState, &controlitParameters));
+
+    if (worker.model == nullptr)
+    {
+        CONTROLIT_ERROR << "Failed to create the control model";
+        return false;
+    }
+
+    // Apply the same parameters as the Coordinator.
+    const Vector & gravityVector = controlitParameters.getGravityVector();
+    worker.model->rbdlModel().gravity.set(gravityVector(0), gravityVector(1), gravityVector(2));
+
+    if (controlitParameters.hasCoupledJointGroups())
+        worker.model->setAMask(controlitParameters.getCoupledJointGroups());
+
+    if (controlitParameters.hasGravCompMask())
+        worker.model->setGravMask(controlitParameters.getGravCompMask());
+
+    worker.robotState.init(worker.model->getRealJointNamesVector());
+    worker.command.init(worker.model->getActuatedJointNamesVector());
+
+    worker.compoundTask.reset(compoundTaskFactory.loadFromString(yamlParameters));
+    if (worker.compoundTask == nullptr)
+    {
+        CONTROLIT_ERROR << "Failed to load the compound task";
+        return false;
+    }
+
+    if (!worker.compoundTask->init(*worker.model))
+    {
+        CONTROLIT_ERROR << "Failed to initialize the compound task";
+        return false;
+    }
+
+    worker.compoundTask->addTasksToUpdater(&worker.taskUpdater);
+
+    // Every sample updates the model, which then computes the internal force operators if needed.
+    worker.model->virtualLinkageModel().setInternalForceOperatorsEnabled(
+        worker.compoundTask->hasInternalForceTask());
+
+    worker.controller.reset(controllerFactory.createController(controlitParameters.getControllerType()));
+    if (worker.controller == nullptr)
+    {
+        CONTROLIT_ERROR << "Failed to create a whole body controller of type \""
+            << controlitParameters.getControllerType() << "\"!";
+        return false;
+    }
+
+    if (!worker.controller->init(nh, *worker.model, &controlitParameters, std::make_shared<TimerChrono>()))
+    {
+        CONTROLIT_ERROR << "Failed to initialize the controller";
+        return false;
+    }
+
+    // Reusing projections from previous samples would make the samples depend on each other.
+    worker.controller->setHeldProjections(0, 0);
+
+    worker.Q.setZero(worker.model->getNumDOFs());
+    worker.Qd.setZero(worker.model->getNumDOFs());
+    worker.Qdd.setZero(worker.model->getNumDOFs());
+
+    // Goal parameters that were added before this worker was created.
+    for (auto & name : goalNames)
+    {
+        worker.goals.push_back(worker.compoundTask->lookupParameter(name));
+        worker.goalBuffers.push_back(Vector());
+    }
+
+    return true;
+}
+
+bool BatchEvaluator::checkStateless(Worker & worker) const
+{
+    if (worker.controller->hasCycleState())
+    {
+        CONTROLIT_ERROR << "Controller of type \"" << controlitParameters.getControllerType()
+            << "\" keeps state across cycles and cannot evaluate independent samples";
+        return false;
+    }
+
+    for (Task * task : worker.taskUpdater.getTasks())
+    {
+        Parameter * integralOn = task->lookupParameter("integralOn", PARAMETER_TYPE_INTEGER);
+        if (integralOn != nullptr && *integralOn->getInteger() != 0)
+        {
+            CONTROLIT_ERROR << "Task \"" << task->getInstanceName() << "\" integrates its error across cycles "
+                << "and cannot evaluate independent samples.  Set its integralOn parameter to 0.";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool BatchEvaluator::addGoalParameter(const std::string & name)
+{
+    if (!initialized)
+    {
+        CONTROLIT_ERROR << "Not initialized!";
+        return false;
+    }
+
+    Parameter * param = workers[0]->compoundTask->lookupParameter(name);
+    if (param == nullptr)
+    {
+        CONTROLIT_ERROR << "Unknown parameter \"" << name << "\"";
+        return false;
+    }
+
+    if (!param->isType(PARAMETER_TYPE_REAL) && !param->isType(PARAMETER_TYPE_VECTOR))
+    {
+        CONTROLIT_ERROR << "Parameter \"" << name << "\" is of type "
+            << Parameter::parameterTypeToString(param->type())
+            << " but goal parameters must be reals or vectors";
+        return false;
+    }
+
+    goalNames.push_back(name);
+
+    for (auto & worker : workers)
+    {
+        worker->goals.push_back(worker->compoundTask->lookupParameter(name));
+        worker->goalBuffers.push_back(Vector());
+    }
+
+    return true;
+}
+
+bool BatchEvaluator::evaluate(const BatchInput & input, BatchOutput & output)
+{
+    if (!initialized)
+    {
+        CONTROLIT_ERROR << "Not initialized!";
+        return false;
+    }
+
+    size_t numSamples = input.Q.cols();
+
+    if (input.Q.rows() != getNumDOFs() || input.Qd.rows() != getNumDOFs()
+        || (size_t)input.Qd.cols() != numSamples)
+    {
+        CONTROLIT_ERROR << "The joint states must be " << getNumDOFs() << " x N matrices, got "
+            << input.Q.rows() << " x " << input.Q.cols() << " positions and "
+            << input.Qd.rows() << " x " << input.Qd.cols() << " velocities";
+        return false;
+    }
+
+    if (input.goals.size() != goalNames.size())
+    {
+        CONTROLIT_ERROR << "Expected " << goalNames.size() << " goal matrices, got " << input.goals.size();
+        return false;
+    }
+
+    for (size_t ii = 0; ii < goalNames.size(); ii++)
+    {
+        Parameter * param = workers[0]->goals[ii];
+        int size = param->isType(PARAMETER_TYPE_REAL) ? 1 : param->getVector()->size();
+
+        if (input.goals[ii].rows() != size || (size_t)input.goals[ii].cols() != numSamples)
+        {
+            CONTROLIT_ERROR << "The goals of \"" << goalNames[ii] << "\" must be a "
+                << size << " x " << numSamples << " matrix, got "
+                << input.goals[ii].rows() << " x " << input.goals[ii].cols();
+            return false;
+        }
+    }
+
+    output.effort.setZero(getNumActuatedDOFs(), numSamples);
+    output.success.assign(numSamples, 0);
+
+    currentInput = &input;
+    currentOutput = &output;
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (threadPool != nullptr)
+    {
+        pendingJobs = jobs.size();
+
+        threadPool->lock();
+        for (auto & job : jobs)
+            threadPool->addJob(job);
+        threadPool->unlock();
+    }
+
+    // The calling thread evaluates its share of the samples while the
+    // helper threads evaluate theirs.
+    runJob(0);
+
+    while (pendingJobs > 0)
+        std::this_thread::yield();
+
+    output.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    output.samplesPerSecond = output.duration > 0 ? numSamples / output.duration : 0;
+
+    currentInput = nullptr;
+    currentOutput = nullptr;
+
+    return true;
+}
+
+void BatchEvaluator::runJob(size_t index)
+{
+    // Each worker evaluates a contiguous range of samples so that it
+    // writes to its own columns of the output.
+    size_t numSamples = currentInput->Q.cols();
+    size_t begin = index * numSamples / workers.size();
+    size_t end = (index + 1) * numSamples / workers.size();
+
+    // Catch everything so that a helper thread always reports that its job
+    // finished.  Otherwise evaluate(...) would wait for it forever.
+    for (size_t sample = begin; sample < end; sample++)
+    {
+        try
+        {
+            currentOutput->success[sample] = evaluateSample(*workers[index], sample);
+        }
+        catch (std::exception & err)
+        {
+            CONTROLIT_ERROR << "Exception thrown while evaluating sample " << sample << ": " << err.what();
+            currentOutput->success[sample] = false;
+        }
+        catch (...)
+        {
+            CONTROLIT_ERROR << "Unknown exception thrown while evaluating sample " << sample;
+            currentOutput->success[sample] = false;
+        }
+    }
+
+    if (index != 0)
+        pendingJobs--;
+}
+
+bool BatchEvaluator::evaluateSample(Worker & worker, size_t sample)
+{
+    ScratchArena::getThreadArena().reset();
+
+    for (size_t ii = 0; ii < worker.goals.size(); ii++)
+    {
+        if (worker.goals[ii]->isType(PARAMETER_TYPE_REAL))
+            worker.goals[ii]->set(currentInput->goals[ii](0, sample));
+        else
+        {
+            worker.goalBuffers[ii] = currentInput->goals[ii].col(sample);
+            worker.goals[ii]->set(worker.goalBuffers[ii]);
+        }
+    }
+
+    worker.Q = currentInput->Q.col(sample);
+    worker.Qd = currentInput->Qd.col(sample);
+
+    // Some tasks and controllers read the joint state from the robot state.
+    int numVirtualDOFs = worker.model->getNumVirtualDOFs();
+    if (numVirtualDOFs > 0 && !worker.robotState.setVirtualJointState(
+        worker.Q.head(numVirtualDOFs), worker.Qd.head(numVirtualDOFs)))
+    {
+        return false;
+    }
+
+    for (int ii = 0; ii < worker.model->getNumRealDOFs(); ii++)
+    {
+        worker.robotState.setJointPosition(ii, worker.Q(numVirtualDOFs + ii));
+        worker.robotState.setJointVelocity(ii, worker.Qd(numVirtualDOFs + ii));
+    }
+
+    worker.model->setFullJointState(worker.Q, worker.Qd, worker.Qdd);
+    worker.model->update();
+
+    // Update every task for every sample, regardless of its update period.
+    for (Task * task : worker.taskUpdater.getTasks())
+    {
+        if (!task->updateState(worker.model.get()))
+            return false;
+
+        task->checkUpdatedState();
+    }
+
+    if (!worker.controller->computeCommand(*worker.model, *worker.compoundTask, worker.command))
+        return false;
+
+    currentOutput->effort.col(sample) = worker.command.getEffortCmd();
+    return true;
+}
+
+int BatchEvaluator::getNumDOFs() const
+{
+    return workers.empty() ? 0 : workers[0]->model->getNumDOFs();
+}
+
+int BatchEvaluator::getNumActuatedDOFs() const
+{
+    return workers.empty() ? 0 : workers[0]->model->getActuatedJointNamesVector().size();
+}
+
+const std::vector<std::string> & BatchEvaluator::getActuatedJointNames() const
+{
+    return workers[0]->model->getActuatedJointNamesVector();
+}
+
+} // namespace controlit
@@ -133,6 +133,12 @@ bool BindingManager::bindParameters(ros::NodeHandle & nh, controlit::ParameterRe
     return true;
 }
 
+void BindingManager::pollBindings()
+{
+    for (auto & binding : bindings)
+        binding->poll();
+}
+
 bool BindingManager::unbindParameters(ParameterReflection & pr)
 {
     // Go through each of the binding config parameters within the supplied parameter
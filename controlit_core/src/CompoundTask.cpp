@@ -18,10 +18,12 @@
  * <http://www.gnu.org/licenses/>
  */
 
+#include <algorithm>
 #include <limits>
 #include <controlit/CompoundTask.hpp>
 #include <controlit/Task.hpp>
 #include <controlit/ControlModel.hpp>
+#include <controlit/ScratchArena.hpp>
 #include <controlit/parser/yaml_parser.hpp>
 #include <controlit/TaskFactory.hpp>
 #include <controlit/BindingManager.hpp>
@@ -42,17 +44,21 @@ namespace controlit {
 CompoundTask::CompoundTask() :
     ReflectionRegistry("compound_task", "__UNNAMED_COMPOUND_TASK_INSTANCE__"),
     hasIntForceTask(false),
-    intForceTaskPriority(0)
+    intForceTaskPriority(0),
+    commandModel(nullptr)
 {
     taskFactory.reset(new TaskFactory);
+    commandBody = [this](size_t task, bool helper) { runCommandJob(task, helper); };
 }
 
 CompoundTask::CompoundTask(std::string const& name) :
     ReflectionRegistry("compound_task", name),
     hasIntForceTask(false),
-    intForceTaskPriority(0)
+    intForceTaskPriority(0),
+    commandModel(nullptr)
 {
     taskFactory.reset(new TaskFactory);
+    commandBody = [this](size_t task, bool helper) { runCommandJob(task, helper); };
 }
 
 CompoundTask::~CompoundTask()
@@ -341,197 +347,221 @@ bool CompoundTask::addTasksToUpdater(TaskUpdater * taskUpdater)
     return true;
 }
 
+unsigned long long CompoundTask::getJacobianVersion(size_t priorityLevel) const
+{
+    if (priorityLevel >= stackedLevels.size())
+        return 0;
+
+    return stackedLevels[priorityLevel].version;
+}
+
+bool CompoundTask::setCommandThreads(size_t numThreads, const std::vector<int> & cpus)
+{
+    commandHelpers.setThreadPool(nullptr);
+    commandThreadPool.reset();
+
+    if (numThreads == 0)
+        return true;
+
+    commandThreadPool.reset(new controlit::addons::cpp::ThreadPool(numThreads));
+
+    if (!cpus.empty() && !commandThreadPool->setAffinity(cpus))
+    {
+        commandThreadPool.reset();
+        return false;
+    }
+
+    commandHelpers.setThreadPool(commandThreadPool.get());
+    return true;
+}
+
+void CompoundTask::setCommandWorkerPool(WorkerPool * pool, WorkerPool::Account * account, size_t numHelpers)
+{
+    commandHelpers.setThreadPool(nullptr);
+    commandThreadPool.reset();
+    commandHelpers.setWorkerPool(pool, account, numHelpers);
+}
+
+void CompoundTask::runCommandJob(size_t task, bool helper)
+{
+    // The servo thread resets its own arena at the start of each cycle.
+    // A helper's arena only holds temporaries of the task's getCommand(...).
+    if (helper)
+        ScratchArena::getThreadArena().reset();
+
+    commandSucceeded[task] = enabledTasks[task]->getCommand(*commandModel, taskCommandBuffer[task]);
+}
+
+bool CompoundTask::computeTaskCommands(ControlModel & model)
+{
+    size_t numTasks = enabledTasks.size();
+
+    // TaskCommand holds an Eigen vector so only grow the buffer.
+    // Shrinking and regrowing it would reallocate the commands.
+    if (taskCommandBuffer.size() < numTasks)
+        taskCommandBuffer.resize(numTasks);
+
+    if (commandSucceeded.size() < numTasks)
+        commandSucceeded.resize(numTasks);
+
+    commandModel = &model;
+
+    // The servo thread computes its share of the task commands while the
+    // helpers compute theirs.
+    commandHelpers.run(numTasks, commandBody);
+
+    for (size_t ii = 0; ii < numTasks; ii++)
+    {
+        if (!commandSucceeded[ii])
+        {
+            CONTROLIT_PR_ERROR_RT << "Failed to get command of task " << enabledTasks[ii]->getInstanceName();
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool CompoundTask::getJacobianAndCommand(ControlModel& model, TaskJacobians& Jt,
-    TaskCommands& Command, TaskTypes& Type) const
+    TaskCommands& Command, TaskTypes& Type)
 {
     // #define TIME_COMPOUND_TASK_GET_JT_AND_COMMAND 1
-  
+
     // Ensure the output vectors have the correct length
     size_t taskTableSize = taskTable.size();
 
     if (Jt.size() != taskTableSize)
-    {
-        // Jt.clear();
         Jt.resize(taskTableSize);
-    }
 
     if (Command.size() != taskTableSize)
-    {
-        // Command.clear();
         Command.resize(taskTableSize);
-    }
 
     if (Type.size() != taskTableSize)
-    {
-        // Type.clear();
         Type.resize(taskTableSize);
-    }
 
-    size_t priorityLevel = 0;  // Keeps track of which priority level we are working with.
-  
     #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND
-    std::vector<ros::Time> latencyGetJacobianAndCommand;
-    latencyGetJacobianAndCommand.push_back(ros::Time::now());
+    ros::Time startGetEnabledTasks = ros::Time::now();
     #endif
-  
-    for(auto& taskList : taskTable) // For each priority level
+
+    // Capture the enabled tasks at each priority level.  Only the first task
+    // in the internal force priority level is used.
+    enabledTasks.clear();
+    levelOffsets.clear();
+
+    size_t priorityLevel = 0;
+    for (auto & taskList : taskTable)
     {
-        if(!hasIntForceTask || priorityLevel != intForceTaskPriority)
+        levelOffsets.push_back(enabledTasks.size());
+
+        if (hasIntForceTask && priorityLevel == intForceTaskPriority)
         {
-      
-            // #define TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_LEVEL 1
-      
-            #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_LEVEL
-            ros::Time startGetNumEnabledTasks = ros::Time::now();
-            #endif
-      
-            // Get the number of enabled tasks at the current priority level
-            int numTasks = numEnabledTasks(taskList, priorityLevel);
-      
-            #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_LEVEL
-            ros::Time startInitVars = ros::Time::now();
-            #endif
-      
-            // Create cumulative force and jacobian data structures
-            std::vector<TaskCommand> cumCmd;   cumCmd.resize(numTasks);
-            std::vector<Matrix> cumJacobian;   cumJacobian.resize(numTasks);
-      
-            size_t numJacobianRows = 0;  // The total number of rows in the Jacobian matrix
-            size_t cumIndx = 0; // Which position in the cumulative force and jacobian to which to write
-      
-            #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_LEVEL
-            ros::Time startGetJacobianAndCommand = ros::Time::now();
-            #endif
-      
-            size_t taskIndex = 0;
-            // Go through each task in the taskList and, if it is enabled,
-            // grab its command and jacobian.
-            for (auto& task : taskList)
+            if (taskList[0]->isEnabled())
+                enabledTasks.push_back(taskList[0].get());
+        }
+        else
+        {
+            for (auto & task : taskList)
             {
                 if (task->isEnabled())
-                {
-                    // #define TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_TASK 1
-          
-                    #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_TASK
-                    ros::Time startGetJacobian = ros::Time::now();
-                    #endif
-          
-                    //NOTE: some TASKS will have incorrect calculations if the order of this changes!!!
-                    if (!task->getJacobian(cumJacobian[cumIndx])) return false;
-          
-                    #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_TASK
-                    ros::Time startGetTaskCommand = ros::Time::now();
-                    #endif
-          
-                    if (!task->getCommand(model, cumCmd[cumIndx])) return false;
-          
-                    #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_TASK
-                    ros::Time endGetTaskCommand = ros::Time::now();
-          
-                    if (priorityLevel == 1 && taskIndex == 0)
-                    {
-                        PRINT_DEBUG_STATEMENT_RT_ALWAYS("getJacobianAndCommand Priority 1 Task 0 Latency Results (ms):\n"
-                          " - getJacobian: " << (startGetTaskCommand - startGetJacobian).toSec() * 1000 << "\n"
-                          " - getTaskCommand: " << (endGetTaskCommand - startGetTaskCommand).toSec() * 1000);
-                    }
-                    #endif
-          
-          //          CONTROLIT_PR_INFO_RT << "State from Task " << cumIndx << ":\n"
-          //               " - task jacobian:\n" << cumJacobian[cumIndx] << "\n"
-          //               " - task command: " << cumCmd[cumIndx].command.transpose();
-          
-          
-                    numJacobianRows += cumJacobian[cumIndx].rows();
-                    cumIndx++;
-                }
-        
-                taskIndex++;
+                    enabledTasks.push_back(task.get());
             }
-      
-            #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_LEVEL
-            ros::Time startResizeDestVars = ros::Time::now();
-            #endif
-      
-            // std::cout<<"numJacobianRows = "<<numJacobianRows<<std::endl;
-            Jt[priorityLevel].resize(numJacobianRows, model.getNumDOFs());
+        }
+
+        priorityLevel++;
+    }
+    levelOffsets.push_back(enabledTasks.size());
+
+    #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND
+    ros::Time startComputeCommands = ros::Time::now();
+    #endif
+
+    // Phase one: compute the task commands.
+    if (!computeTaskCommands(model)) return false;
+
+    #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND
+    ros::Time startStackResults = ros::Time::now();
+    #endif
+
+    // Phase two: stack the task Jacobians and commands of each priority level.
+    // The internal force priority level was reduced to its first task above
+    // so it is handled like every other level.
+    int numDOFs = model.getNumDOFs();
+
+    if (stackedLevels.size() != taskTableSize)
+        stackedLevels.resize(taskTableSize);
+
+    for (priorityLevel = 0; priorityLevel < taskTableSize; priorityLevel++)
+    {
+        size_t firstTask = levelOffsets[priorityLevel];
+        size_t endTask = levelOffsets[priorityLevel + 1];
+        StackedLevel & stackedLevel = stackedLevels[priorityLevel];
+
+        int numJacobianRows = 0;  // The total number of rows in the Jacobian matrix
+        for (size_t ii = firstTask; ii < endTask; ii++)
+            numJacobianRows += enabledTasks[ii]->getJacobianRows();
+
+        // Only reallocate when the number of enabled task dimensions changes.
+        if (Jt[priorityLevel].rows() != numJacobianRows || Jt[priorityLevel].cols() != numDOFs)
+            Jt[priorityLevel].resize(numJacobianRows, numDOFs);
+
+        if (Command[priorityLevel].size() != numJacobianRows)
             Command[priorityLevel].resize(numJacobianRows);
-      
-            #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_LEVEL
-            ros::Time startSaveResults = ros::Time::now();
-            #endif
-      
-            if(numJacobianRows > 0)
-            {
-                size_t rowIndex = 0;
-                for(size_t ii = 0; ii < cumJacobian.size(); ii++)
-                {
-                    size_t numRows = cumJacobian[ii].rows();
-                    Jt[priorityLevel].block(rowIndex, 0, numRows, cumJacobian[ii].cols()) = cumJacobian[ii];
-          
-                    // CONTROLIT_PR_INFO_RT << "About to save command:\n"
-                    //      " - rowIndex = " << rowIndex << "\n"
-                    //      " - numRows = " << numRows << "\n"
-                    //      " - ii = " << ii << "\n"
-                    //      " - size of cumCmd[" << ii << "].command.size() = " << cumCmd[ii].command.size();
-          
-                    Command[priorityLevel].block(rowIndex, 0, numRows, 1) = cumCmd[ii].command;
-                    Type[priorityLevel] = cumCmd[ii].type;
-                    rowIndex += numRows;
-                }
-            }
-      
-            #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND_SPECIFIC_LEVEL
-            ros::Time endSaveResults = ros::Time::now();
-      
-            if (priorityLevel == 1)
-            {
-                PRINT_DEBUG_STATEMENT_RT_ALWAYS("getJacobianAndCommand Priority 1 Latency Results (ms):\n"
-                  " - getNumEnabledTasks: " << (startInitVars - startGetNumEnabledTasks).toSec() * 1000 << "\n"
-                  " - initVars: " << (startGetJacobianAndCommand - startInitVars).toSec() * 1000 << "\n"
-                  " - getJacobianAndCommand: " << (startResizeDestVars - startGetJacobianAndCommand).toSec() * 1000 << "\n"
-                  " - resizeDestVars: " << (startSaveResults - startResizeDestVars).toSec() * 1000 << "\n"
-                  " - saveResults: " << (endSaveResults - startSaveResults).toSec() * 1000
-                );
-            }
-            #endif
+
+        // The stacked Jacobian can be reused if it was built in the same
+        // matrix from the same versions of the same tasks.
+        bool jacobianChanged = stackedLevel.data != Jt[priorityLevel].data()
+            || stackedLevel.tasks.size() != endTask - firstTask;
+
+        for (size_t ii = firstTask; ii < endTask && !jacobianChanged; ii++)
+        {
+            jacobianChanged = stackedLevel.tasks[ii - firstTask] != enabledTasks[ii]
+                || stackedLevel.versions[ii - firstTask] != enabledTasks[ii]->getJacobianVersion();
         }
-        else if (hasIntForceTask && priorityLevel == intForceTaskPriority)
+
+        if (jacobianChanged)
         {
-            std::shared_ptr<Task> task = taskList[0];
-      
-            if (task->isEnabled())
+            stackedLevel.tasks.assign(enabledTasks.begin() + firstTask, enabledTasks.begin() + endTask);
+            stackedLevel.versions.clear();
+            stackedLevel.data = Jt[priorityLevel].data();
+            stackedLevel.version++;
+        }
+
+        int rowIndex = 0;
+        for (size_t ii = firstTask; ii < endTask; ii++)
+        {
+            const TaskCommand & taskCommand = taskCommandBuffer[ii];
+            int numRows = taskCommand.command.size();
+
+            if (numRows != enabledTasks[ii]->getJacobianRows())
             {
-                Jt[intForceTaskPriority].resize(model.virtualLinkageModel().getWint().rows(), model.getNumDOFs());
-                Command[intForceTaskPriority].resize(model.virtualLinkageModel().getWint().rows());
-                TaskCommand intForceCommand;
-                task->getJacobian(Jt[priorityLevel]);
-                task->getCommand(model, intForceCommand);
-                Command[intForceTaskPriority] = intForceCommand.command;
-                Type[intForceTaskPriority] = intForceCommand.type;
+                CONTROLIT_PR_ERROR_RT << "Command of task " << enabledTasks[ii]->getInstanceName()
+                    << " has " << numRows << " elements but its Jacobian has "
+                    << enabledTasks[ii]->getJacobianRows() << " rows";
+                stackedLevel.data = nullptr;
+                return false;
             }
+
+            if (jacobianChanged)
+            {
+                Jt[priorityLevel].middleRows(rowIndex, numRows) = enabledTasks[ii]->getJacobianView();
+                stackedLevel.versions.push_back(enabledTasks[ii]->getJacobianVersion());
+            }
+
+            Command[priorityLevel].segment(rowIndex, numRows) = taskCommand.command;
+            Type[priorityLevel] = taskCommand.type;
+            rowIndex += numRows;
         }
-    
-        priorityLevel++;
-        // taskListCount++;
-    
-        #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND
-        latencyGetJacobianAndCommand.push_back(ros::Time::now());
-        #endif
     }
-    
+
     #ifdef TIME_COMPOUND_TASK_GET_JT_AND_COMMAND
-    std::stringstream msgBuff;
-    for (size_t ii = 0; ii < latencyGetJacobianAndCommand.size() - 1; ii++)
-    {
-        msgBuff << " - getJacobianAndCommandPriority" << ii << ": " << (latencyGetJacobianAndCommand[ii + 1] - latencyGetJacobianAndCommand[ii]).toSec() * 1000;
-        if (ii < latencyGetJacobianAndCommand.size() - 2)
-            msgBuff << "\n";
-    }
-    PRINT_DEBUG_STATEMENT_RT_ALWAYS("CompoundTak getJacobianAndCommand Latency Results (ms):\n" << msgBuff.str());
+    ros::Time endStackResults = ros::Time::now();
+
+    PRINT_DEBUG_STATEMENT_RT_ALWAYS("CompoundTask getJacobianAndCommand Latency Results (ms):\n"
+        " - getEnabledTasks: " << (startComputeCommands - startGetEnabledTasks).toSec() * 1000 << "\n"
+        " - computeCommands: " << (startStackResults - startComputeCommands).toSec() * 1000 << "\n"
+        " - stackResults: " << (endStackResults - startStackResults).toSec() * 1000);
     #endif
-  
-    // CONTROLIT_PR_INFO_RT << "Latency of method call: " << (ros::Time::now() - startMethodCall).toSec() * 1000;
-  
+
     return true;
 }
 
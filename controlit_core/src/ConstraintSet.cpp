@@ -190,6 +190,10 @@ bool ConstraintSet::init(RigidBodyDynamics::Model & robot)
     // Also compute:
     //  - consDOFCount_: the number of constrained DOFs
     //  - unactDOFcount_: the number of unactuatuated DOFs
+    // These are reset first since init(...) is called again whenever the
+    // set of enabled constraints changes.
+    consDOFcount_ = 0;
+    unactDOFcount_ = 0;
     std::set<int> slaveIds;
     for (auto const& constraint : constraintSet_)
     {
@@ -223,29 +227,50 @@ bool ConstraintSet::init(RigidBodyDynamics::Model & robot)
     // Resize internal storage.. this is just silly. Too many confusingly named variables
     this->resize(robot.dof_count, consDOFcount_, unactDOFcount_, virtualDOFcount_);
 
-    // Set U
+    // Set the index maps of U and virtualU.  Row ii of U selects
+    // column UIndices_[ii] of the full joint vector.
     // !!!WARNING!! No check for constraints in series!!!!!!
-    int ii = 0; //row
+    UIndices_.clear();
+    virtualUIndices_.clear();
     for(size_t jj = virtualDOFcount_; jj < robot.dof_count; jj++) //columns
     {
         auto id = slaveIds.find(jj+1); //RBDL index starts at 1, not 0
         if(id == slaveIds.end()) //node IS actuated
-        {
-            U_(ii++, jj) = 1.0;
-            continue;
-        }
-    }
+            UIndices_.push_back(jj);
 
-    // Set virtualU
-    ii = 0; //row
-    for(size_t jj = virtualDOFcount_; jj < robot.dof_count; jj++) //columns
-    {
-        virtualU_(ii++, jj) = 1.0;
+        virtualUIndices_.push_back(jj);
     }
 
+    // The dense versions of U and virtualU are only kept for the accessors.
+    // The update path uses the index maps.
+    controlit::addons::eigen::selectionToDense(UIndices_, robot.dof_count, U_);
+    controlit::addons::eigen::selectionToDense(virtualUIndices_, robot.dof_count, virtualU_);
+
     if(getNConstraints() == 0)  // If there are no constraints, set UNc_ to be U_
         UNc_ = U_;
 
+    // Allocate storage for the Jacobians of the enabled dense constraints
+    // and determine where the rows of each enabled constraint are in Jc_.
+    constraintJacobians_.resize(constraintSet_.size());
+    sparseJacobians_.resize(constraintSet_.size());
+    constraintRows_.resize(constraintSet_.size());
+    int r = 0; //row counter
+    for (size_t ii = 0; ii < constraintSet_.size(); ii++)
+    {
+        if (constraintSet_[ii]->isEnabled() && !constraintSet_[ii]->hasSparseJacobian())
+            constraintJacobians_[ii].setZero(constraintSet_[ii]->getNConstrainedDOFs(), robot.dof_count);
+        else
+            constraintJacobians_[ii].resize(0, 0);
+
+        if (constraintSet_[ii]->isEnabled())
+        {
+            constraintRows_[ii] = r;
+            r += constraintSet_[ii]->getNConstrainedDOFs();
+        }
+        else
+            constraintRows_[ii] = -1;
+    }
+
     initialized_ = true;
 
     // PRINT_DEBUG_STATEMENT("init complete. virtual DOF: " << virtualDOFcount_
@@ -279,15 +304,56 @@ bool ConstraintSet::enableSetChanged()
 }
 
 void ConstraintSet::update(RigidBodyDynamics::Model& robot, const Vector& Q, const Matrix& Ainv)
+{
+    beginUpdate(robot);
+
+    for (size_t ii = 0; ii < constraintSet_.size(); ii++)
+        updateJacobian(robot, Q, ii);
+
+    updateProjections(Ainv);
+}
+
+void ConstraintSet::beginUpdate(RigidBodyDynamics::Model& robot)
 {
     // Check if the enable/disable state of the constraints have changed.
     // If they have, re-initialize this constraint set.
     if (enableSetChanged())
         init(robot);
+}
+
+void ConstraintSet::updateJacobian(RigidBodyDynamics::Model& robot, const Vector& Q, size_t index)
+{
+    // Use the enable state at the time of init(...) so that the rows match
+    // the size of Jc_ even if the constraint was toggled since then.
+    int r = constraintRows_[index];
+    if (r < 0)
+        return;
+
+    Constraint & constraint = *constraintSet_[index];
 
-    if(getNConstraints() != 0) // non-empty constraint set, need to update Jc and Jc-derived quantities
+    if (constraint.hasSparseJacobian())
+    {
+        // The sparsity pattern does not change between calls to init(...),
+        // and the rows of Jc_ were zeroed by resize(...).  Thus only the
+        // non-zero elements need to be written.
+        Constraint::SparseJacobian_t & sparseJacobian = sparseJacobians_[index];
+        constraint.getSparseJacobian(robot, Q, sparseJacobian);
+
+        for (auto const & entry : sparseJacobian)
+            Jc_(r + entry.row, entry.col) = entry.value;
+    }
+    else
+    {
+        Matrix & Jci = constraintJacobians_[index];
+        constraint.getJacobian(robot, Q, Jci);
+        Jc_.middleRows(r, Jci.rows()) = Jci;
+    }
+}
+
+void ConstraintSet::updateProjections(const Matrix& Ainv)
+{
+    if(getNConstraints() != 0) // non-empty constraint set, need to update Jc-derived quantities
     {
-        updateJc(robot, Q);
         //update JcBar_
         Matrix temp1 = Jc_ * Ainv * Jc_.transpose();  // a version of Jc weighted by Ainv
         Matrix lambda1(temp1.cols(), temp1.rows());
@@ -297,18 +363,29 @@ void ConstraintSet::update(RigidBodyDynamics::Model& robot, const Vector& Q, con
         JcBar_ = Ainv * Jc_.transpose() * lambda1;
         //update Nc_
         Nc_ = Id_col - JcBar_ * Jc_;
-        //update UNc_
-        UNc_ = U_ * Nc_;
+        //update UNc_ = U_ * Nc_ by gathering the actuable rows of Nc_
+        controlit::addons::eigen::selectRows(UIndices_, Nc_, UNc_);
+
+        //update UNcAiNorm_ = UNc_ * Ainv * UNc_.transpose()
+        AinvUNcT_.noalias() = Ainv * UNc_.transpose();
+        UNcAiNorm_.noalias() = UNc_ * AinvUNcT_; // dimensions # actuable DOFs x # actuable DOFs
+    }
+    else
+    {
+        // UNc_ equals U_, which is a pure selection.  UNc_ * Ainv * UNc_.transpose()
+        // is therefore a principal sub-matrix of Ainv and Ainv * UNc_.transpose()
+        // is a subset of the columns of Ainv.
+        controlit::addons::eigen::selectCols(Ainv, UIndices_, AinvUNcT_);
+        controlit::addons::eigen::selectRowsCols(UIndices_, Ainv, UNcAiNorm_);
     }
 
     //update UNcBar_
-    UNcAiNorm_ = UNc_ * Ainv * UNc_.transpose(); // dimensions # actuable DOFs x # actuable DOFs
     Matrix lambda2(UNcAiNorm_.cols(), UNcAiNorm_.rows());
     // pseudoInverse(UNcAiNorm_, sigmaThreshold_, lambda2, 0);
     // CONTROLIT_INFO << "Computing pseudoInverse";
     controlit::addons::eigen::pseudo_inverse(UNcAiNorm_, lambda2); //, sigmaThreshold_);
 
-    UNcBar_ = Ainv * UNc_.transpose() * lambda2;
+    UNcBar_.noalias() = AinvUNcT_ * lambda2;
 
   //   PRINT_DEBUG_STATEMENT(": Computed UNcBar:\n"
   //        " - UNcBar = \n" << UNcBar_ << "\n"
@@ -471,25 +548,6 @@ unsigned int ConstraintSet::getNConstrainedDOFs() const
     return consDOFcount_;
 }
 
-void ConstraintSet::updateJc(RigidBodyDynamics::Model& robot, const Vector& Q)
-{
-    //assert(initialized_);
-
-    int r = 0; //row counter
-    for (auto & constraint : constraintSet_)
-    {
-        if (constraint->isEnabled())
-        {
-            //TODO: constraints store and initialize their own jacobian matrix!
-            Matrix Jci(constraint->getNConstrainedDOFs(), robot.dof_count);
-            constraint->getJacobian(robot, Q, Jci);
-
-            for(size_t ii = 0; ii < constraint->getNConstrainedDOFs(); ii++)
-                Jc_.row(r++) = Jci.row(ii);
-        }
-    }
-}
-
 void ConstraintSet::resize(unsigned int dof, unsigned int consDOFcount,
   unsigned int unactDOFcount, unsigned int virtualDOFcount)
 {
@@ -505,6 +563,7 @@ void ConstraintSet::resize(unsigned int dof, unsigned int consDOFcount,
     UNc_.setZero(U_.rows(), Nc_.cols());
     UNcAiNorm_.setZero(UNc_.rows(), UNc_.rows());
     UNcBar_.setZero(UNc_.cols(), UNc_.rows());
+    AinvUNcT_.setZero(UNc_.cols(), UNc_.rows());
 
     Id_col.setIdentity(dof, dof);
     Id_row.setIdentity(consDOFcount, consDOFcount);
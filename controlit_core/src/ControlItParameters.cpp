@@ -23,6 +23,7 @@
 #include <controlit/addons/ros/ROSParameterAccessor.hpp>
 #include <controlit/logging/RealTimeLogging.hpp>
 #include <boost/lexical_cast.hpp>
+#include <sched.h>
 
 namespace controlit {
 namespace utility {
@@ -38,11 +39,31 @@ namespace utility {
 #define PARAM_WBC_CONTROLLER_TYPE               "controlit/whole_body_controller_type"
 #define PARAM_USE_SINGLE_THREADED_CONTROL_MODEL "controlit/use_single_threaded_control_model"
 #define PARAM_USE_SINGLE_THREADED_TASK_UPDATER  "controlit/use_single_threaded_task_updater"
+#define PARAM_LOCKSTEP                          "controlit/lockstep"
+#define PARAM_NUM_TASK_COMMAND_THREADS          "controlit/num_task_command_threads"
+#define PARAM_TASK_COMMAND_THREAD_CPUS          "controlit/task_command_thread_cpus"
+#define PARAM_NUM_MODEL_UPDATE_THREADS          "controlit/num_model_update_threads"
+#define PARAM_MODEL_UPDATE_THREAD_CPUS          "controlit/model_update_thread_cpus"
+#define PARAM_MAX_TRAJECTORY_SEGMENTS           "controlit/max_trajectory_segments"
+#define PARAM_MAX_MODEL_EXTRAPOLATION           "controlit/max_model_extrapolation"
+#define PARAM_TELEMETRY_RATE                    "controlit/telemetry_rate"
+#define PARAM_MODEL_UPDATE_SKIP_POSITION        "controlit/model_update_skip_position_threshold"
+#define PARAM_MODEL_UPDATE_SKIP_VELOCITY        "controlit/model_update_skip_velocity_threshold"
+#define PARAM_MODEL_UPDATE_PARTIAL_POSITION     "controlit/model_update_partial_position_threshold"
+#define PARAM_WORKER_CPU_QUOTA                  "controlit/worker_cpu_quota"
+#define PARAM_LOCK_MEMORY                       "controlit/lock_memory"
+#define PARAM_PREFAULT_STACK_SIZE               "controlit/prefault_stack_size"
+#define PARAM_THREADS                           "controlit/threads"
+#define PARAM_GENERATED_DYNAMICS_TYPE           "controlit/generated_dynamics_type"
+#define PARAM_DEGRADATION                       "controlit/degradation"
 #define PARAM_GRAVITY_VECTOR                    "controlit/gravity_vector"
 #define PARAM_COUPLED_JOINT_GROUPS              "controlit/coupled_joint_groups"
 #define PARAM_GRAVITY_COMP_MASK                 "controlit/gravity_compensation_mask"
 #define PARAM_MODEL_BASE_LINK_NAME              "controlit/model_base_link_name"
 
+// The servo clock that is used in lockstep mode
+#define LOCKSTEP_SERVO_CLOCK_TYPE "controlit_servo_clock/ServoClockLockstep"
+
 // #define TORQUE_OFFSETS_PARAMETER "controlit/torque_offsets"
 // #define TORQUE_SCALING_FACTORS   "controlit/torque_scaling_factors"
 
@@ -77,6 +98,19 @@ ControlItParameters::ControlItParameters() :
   
     useSingleThreadedControlModel_(false),
     useSingleThreadedTaskUpdater_(false),
+    lockstep(false),
+    numTaskCommandThreads(0),
+    numModelUpdateThreads(0),
+    maxTrajectorySegments(256),
+    maxModelExtrapolation(0),
+    telemetryRate(100),
+    modelUpdateSkipPositionThreshold(0),
+    modelUpdateSkipVelocityThreshold(0),
+    modelUpdatePartialPositionThreshold(0),
+    workerCPUQuota(0),
+    lockMemory(false),
+    prefaultStackSize(256 * 1024),
+    generatedDynamicsType(""),
     // useSingleThreadedSensorUpdater_(false),
   
     // maxEffortCmd(1e4),  // any effort command above 1e4 is considered invalid
@@ -143,6 +177,18 @@ bool ControlItParameters::loadParameters(ros::NodeHandle & nh)
     if (!loadControllerType(nh)) return false;
     if (!loadControlModelSingleThreadedOption(nh)) return false;
     if (!loadTaskUpdaterSingleThreadedOption(nh)) return false;
+    if (!loadLockstepOption(nh)) return false;
+    if (!loadTaskCommandThreads(nh)) return false;
+    if (!loadModelUpdateThreads(nh)) return false;
+    if (!loadMaxTrajectorySegments(nh)) return false;
+    if (!loadMaxModelExtrapolation(nh)) return false;
+    if (!loadTelemetryRate(nh)) return false;
+    if (!loadModelUpdateThresholds(nh)) return false;
+    if (!loadWorkerCPUQuota(nh)) return false;
+    if (!loadMemoryLocking(nh)) return false;
+    if (!loadThreadPlacements(nh)) return false;
+    if (!loadGeneratedDynamicsType(nh)) return false;
+    if (!loadDegradation(nh)) return false;
     // if (!loadMaxEffortCmd(nh)) return false;
     // if (!loadTorqueOffsets(nh)) return false;
     // if (!loadTorqueScalingFactors(nh)) return false;
@@ -219,6 +265,269 @@ bool ControlItParameters::loadTaskUpdaterSingleThreadedOption(ros::NodeHandle &
     return true;
 }
 
+bool ControlItParameters::loadLockstepOption(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_LOCKSTEP, lockstep);
+
+    if (lockstep)
+    {
+        // The model and tasks must be updated within each servo cycle, and
+        // the servo cycles must be started by the simulator.
+        useSingleThreadedControlModel_ = true;
+        useSingleThreadedTaskUpdater_ = true;
+
+        if (servoClockType != LOCKSTEP_SERVO_CLOCK_TYPE)
+        {
+            CONTROLIT_INFO << "Lockstep mode is enabled, using servo clock \""
+                << LOCKSTEP_SERVO_CLOCK_TYPE << "\" instead of \"" << servoClockType << "\".";
+            servoClockType = LOCKSTEP_SERVO_CLOCK_TYPE;
+        }
+    }
+
+    return true;
+}
+
+bool ControlItParameters::loadTaskCommandThreads(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_NUM_TASK_COMMAND_THREADS, numTaskCommandThreads);
+    nh.getParam(PARAM_TASK_COMMAND_THREAD_CPUS, taskCommandThreadCPUs);
+
+    if (numTaskCommandThreads < 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << PARAM_NUM_TASK_COMMAND_THREADS
+            << "' must not be negative, got " << numTaskCommandThreads << ".";
+        return false;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadModelUpdateThreads(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_NUM_MODEL_UPDATE_THREADS, numModelUpdateThreads);
+    nh.getParam(PARAM_MODEL_UPDATE_THREAD_CPUS, modelUpdateThreadCPUs);
+
+    if (numModelUpdateThreads < 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << PARAM_NUM_MODEL_UPDATE_THREADS
+            << "' must not be negative, got " << numModelUpdateThreads << ".";
+        return false;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadMaxTrajectorySegments(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_MAX_TRAJECTORY_SEGMENTS, maxTrajectorySegments);
+
+    if (maxTrajectorySegments < 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << PARAM_MAX_TRAJECTORY_SEGMENTS
+            << "' must not be negative, got " << maxTrajectorySegments << ".";
+        return false;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadMaxModelExtrapolation(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_MAX_MODEL_EXTRAPOLATION, maxModelExtrapolation);
+
+    if (maxModelExtrapolation < 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << PARAM_MAX_MODEL_EXTRAPOLATION
+            << "' must not be negative, got " << maxModelExtrapolation << ".";
+        return false;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadTelemetryRate(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_TELEMETRY_RATE, telemetryRate);
+
+    if (telemetryRate <= 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << PARAM_TELEMETRY_RATE
+            << "' must be positive, got " << telemetryRate << ".";
+        return false;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadModelUpdateThresholds(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_MODEL_UPDATE_SKIP_POSITION, modelUpdateSkipPositionThreshold);
+    nh.getParam(PARAM_MODEL_UPDATE_SKIP_VELOCITY, modelUpdateSkipVelocityThreshold);
+    nh.getParam(PARAM_MODEL_UPDATE_PARTIAL_POSITION, modelUpdatePartialPositionThreshold);
+
+    if (modelUpdateSkipPositionThreshold < 0 || modelUpdateSkipVelocityThreshold < 0
+        || modelUpdatePartialPositionThreshold < 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameters '" << paramInterface->getNamespace() << "/" << PARAM_MODEL_UPDATE_SKIP_POSITION
+            << "', '" << paramInterface->getNamespace() << "/" << PARAM_MODEL_UPDATE_SKIP_VELOCITY
+            << "', and '" << paramInterface->getNamespace() << "/" << PARAM_MODEL_UPDATE_PARTIAL_POSITION
+            << "' must not be negative.";
+        return false;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadWorkerCPUQuota(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_WORKER_CPU_QUOTA, workerCPUQuota);
+
+    if (workerCPUQuota < 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << PARAM_WORKER_CPU_QUOTA
+            << "' must not be negative, got " << workerCPUQuota << ".";
+        return false;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadMemoryLocking(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_LOCK_MEMORY, lockMemory);
+    nh.getParam(PARAM_PREFAULT_STACK_SIZE, prefaultStackSize);
+
+    if (prefaultStackSize < 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << PARAM_PREFAULT_STACK_SIZE
+            << "' must not be negative, got " << prefaultStackSize << ".";
+        return false;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadThreadPlacements(ros::NodeHandle & nh)
+{
+    threadPlacements.clear();
+
+    // Each thread's placement is in parameters controlit/threads/[name]/{policy, priority, cpus}
+    for (auto & name : RealTimeConfig::THREAD_NAMES)
+    {
+        std::string prefix = std::string(PARAM_THREADS) + "/" + name;
+        if (!nh.hasParam(prefix)) continue;
+
+        ThreadPlacement placement;
+        nh.getParam(prefix + "/policy", placement.policy);
+        nh.getParam(prefix + "/priority", placement.priority);
+        nh.getParam(prefix + "/cpus", placement.cpus);
+
+        int policy;
+        if (!RealTimeConfig::parsePolicy(placement.policy, policy))
+        {
+            CONTROLIT_ERROR
+                << "ROS parameter '" << paramInterface->getNamespace() << "/" << prefix
+                << "/policy' must be \"other\", \"fifo\" or \"rr\", got \"" << placement.policy << "\".";
+            return false;
+        }
+
+        if (placement.priority < sched_get_priority_min(policy) || placement.priority > sched_get_priority_max(policy))
+        {
+            CONTROLIT_ERROR
+                << "ROS parameter '" << paramInterface->getNamespace() << "/" << prefix
+                << "/priority' must be between " << sched_get_priority_min(policy) << " and "
+                << sched_get_priority_max(policy) << " for policy " << placement.policy
+                << ", got " << placement.priority << ".";
+            return false;
+        }
+
+        for (auto cpu : placement.cpus)
+        {
+            if (cpu < 0 || cpu >= CPU_SETSIZE)
+            {
+                CONTROLIT_ERROR
+                    << "ROS parameter '" << paramInterface->getNamespace() << "/" << prefix
+                    << "/cpus' contains invalid CPU " << cpu << ".";
+                return false;
+            }
+        }
+
+        threadPlacements[name] = placement;
+    }
+    return true;
+}
+
+bool ControlItParameters::loadGeneratedDynamicsType(ros::NodeHandle & nh)
+{
+    nh.getParam(PARAM_GENERATED_DYNAMICS_TYPE, generatedDynamicsType);
+    return true;
+}
+
+bool ControlItParameters::loadDegradation(ros::NodeHandle & nh)
+{
+    degradation = DegradationConfig();
+
+    // The degradation is configured by parameters controlit/degradation/[name]
+    std::string prefix = std::string(PARAM_DEGRADATION) + "/";
+
+    std::vector<std::string> stepNames;
+    nh.getParam(prefix + "steps", stepNames);
+
+    for (auto & name : stepNames)
+    {
+        DegradationStep step;
+        if (!DegradationConfig::parseStep(name, step))
+        {
+            CONTROLIT_ERROR
+                << "ROS parameter '" << paramInterface->getNamespace() << "/" << prefix
+                << "steps' contains invalid step \"" << name << "\".  Valid steps are "
+                << "\"task_updates\", \"projections\", \"telemetry\" and \"events\".";
+            return false;
+        }
+        degradation.steps.push_back(step);
+    }
+
+    nh.getParam(prefix + "overrun_threshold", degradation.overrunThreshold);
+    nh.getParam(prefix + "headroom_threshold", degradation.headroomThreshold);
+    nh.getParam(prefix + "overrun_cycles", degradation.overrunCycles);
+    nh.getParam(prefix + "headroom_cycles", degradation.headroomCycles);
+    nh.getParam(prefix + "task_update_period", degradation.taskUpdatePeriod);
+    nh.getParam(prefix + "task_update_priority", degradation.taskUpdatePriority);
+    nh.getParam(prefix + "held_priority_levels", degradation.heldPriorityLevels);
+    nh.getParam(prefix + "held_projection_cycles", degradation.heldProjectionCycles);
+    nh.getParam(prefix + "telemetry_decimation", degradation.telemetryDecimation);
+    nh.getParam(prefix + "event_decimation", degradation.eventDecimation);
+
+    if (degradation.headroomThreshold <= 0 || degradation.headroomThreshold >= degradation.overrunThreshold)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << prefix
+            << "headroom_threshold' must be positive and below the overrun threshold "
+            << degradation.overrunThreshold << ", got " << degradation.headroomThreshold << ".";
+        return false;
+    }
+
+    if (degradation.overrunCycles < 1 || degradation.headroomCycles < 1
+        || degradation.heldPriorityLevels < 1 || degradation.heldProjectionCycles < 1
+        || degradation.telemetryDecimation < 1 || degradation.eventDecimation < 1)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameters '" << paramInterface->getNamespace() << "/" << prefix
+            << "{overrun_cycles, headroom_cycles, held_priority_levels, held_projection_cycles, "
+            << "telemetry_decimation, event_decimation}' must be positive.";
+        return false;
+    }
+
+    if (degradation.taskUpdatePeriod < 0)
+    {
+        CONTROLIT_ERROR
+            << "ROS parameter '" << paramInterface->getNamespace() << "/" << prefix
+            << "task_update_period' must not be negative, got " << degradation.taskUpdatePeriod << ".";
+        return false;
+    }
+    return true;
+}
+
 bool ControlItParameters::loadGravityVector()
 {
     paramInterface->loadParameter(PARAM_GRAVITY_VECTOR, gravityVector);
@@ -375,6 +684,98 @@ bool ControlItParameters::saveParameters(diagnostic_msgs::DiagnosticStatus & sta
     kv.value = useSingleThreadedTaskUpdater_ ? "single-threaded" : "multi-threaded";
     statusMsg.values.push_back(kv);
 
+    kv.key = "lockstep";
+    kv.value = lockstep ? "true" : "false";
+    statusMsg.values.push_back(kv);
+
+    kv.key = "task command threads";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << numTaskCommandThreads))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "task command thread CPUs";
+    {
+        std::ostringstream cpus;
+        for (size_t ii = 0; ii < taskCommandThreadCPUs.size(); ii++)
+            cpus << (ii > 0 ? ", " : "") << taskCommandThreadCPUs[ii];
+        kv.value = taskCommandThreadCPUs.empty() ? "any" : cpus.str();
+    }
+    statusMsg.values.push_back(kv);
+
+    kv.key = "model update threads";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << numModelUpdateThreads))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "model update thread CPUs";
+    {
+        std::ostringstream cpus;
+        for (size_t ii = 0; ii < modelUpdateThreadCPUs.size(); ii++)
+            cpus << (ii > 0 ? ", " : "") << modelUpdateThreadCPUs[ii];
+        kv.value = modelUpdateThreadCPUs.empty() ? "any" : cpus.str();
+    }
+    statusMsg.values.push_back(kv);
+
+    kv.key = "max trajectory segments";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << maxTrajectorySegments))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "max model extrapolation";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << maxModelExtrapolation))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "telemetry rate";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << telemetryRate))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "model update skip position threshold";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << modelUpdateSkipPositionThreshold))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "model update skip velocity threshold";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << modelUpdateSkipVelocityThreshold))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "model update partial position threshold";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << modelUpdatePartialPositionThreshold))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "worker CPU quota";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << workerCPUQuota))->str();
+    statusMsg.values.push_back(kv);
+
+    kv.key = "lock memory";
+    kv.value = lockMemory ? "true" : "false";
+    statusMsg.values.push_back(kv);
+
+    kv.key = "prefault stack size";
+    kv.value = static_cast<std::ostringstream*>(&(std::ostringstream() << prefaultStackSize))->str();
+    statusMsg.values.push_back(kv);
+
+    for (auto & placement : threadPlacements)
+    {
+        std::ostringstream value;
+        value << placement.second.policy << ", priority " << placement.second.priority << ", CPUs ";
+        for (size_t ii = 0; ii < placement.second.cpus.size(); ii++)
+            value << (ii > 0 ? ", " : "") << placement.second.cpus[ii];
+        if (placement.second.cpus.empty()) value << "any";
+
+        kv.key = placement.first + " thread placement";
+        kv.value = value.str();
+        statusMsg.values.push_back(kv);
+    }
+
+    kv.key = "generated dynamics type";
+    kv.value = generatedDynamicsType.empty() ? "none" : generatedDynamicsType;
+    statusMsg.values.push_back(kv);
+
+    kv.key = "degradation steps";
+    {
+        std::ostringstream steps;
+        for (size_t ii = 0; ii < degradation.steps.size(); ii++)
+            steps << (ii > 0 ? ", " : "") << DegradationConfig::getStepName(degradation.steps[ii]);
+        kv.value = degradation.steps.empty() ? "none" : steps.str();
+    }
+    statusMsg.values.push_back(kv);
+
     // kv.key = "sensor updater threading type";
     // kv.value = useSingleThreadedSensorUpdater_ ? "single-threaded" : "multi-threaded";
     // statusMsg.values.push_back(kv);
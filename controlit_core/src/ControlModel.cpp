@@ -24,6 +24,7 @@
 
 #include <controlit/ControlModel.hpp>
 #include <controlit/ConstraintSetFactory.hpp>
+#include <controlit/ControllerClock.hpp>
 #include <controlit_robot_models/rbdl_robot_urdfreader.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
 
@@ -46,6 +47,7 @@ namespace controlit {
 ControlModel::ControlModel() :
     initialized_(false),
     isStale_(true),
+    hasPredictedValues_(false),
     name("DEFAULT_MODEL"),
     params(nullptr)
 {
@@ -235,10 +237,50 @@ bool ControlModel::reinit()
     UnmolestedAinv_.setZero(numDOFs, numDOFs);
     AMask_.setOnes(numDOFs, numDOFs);
     grav_.setZero(numDOFs);
+    gravOnly_.setZero(numDOFs);
+    coriolis_.setZero(numDOFs);
     gravMask_.setOnes(numDOFs);
+    fullUpdateQ_.setZero(numDOFs);
+    zeroQdd_.setZero(numDOFs);
+
+    if (!fusedDynamics_.init(*(rbdlModel_.get())))
+    {
+        CONTROLIT_WARN << "The robot model contains joints that are not supported by the fused "
+                          "dynamics computation.  Falling back to RBDL's algorithms.";
+    }
+
+    if (params != nullptr && !params->getGeneratedDynamicsType().empty())
+    {
+        if (generatedDynamics_ == nullptr)
+        {
+            if (generatedDynamicsFactory_ == nullptr)
+                generatedDynamicsFactory_.reset(new GeneratedDynamicsFactory());
+
+            generatedDynamics_.reset(generatedDynamicsFactory_->create(params->getGeneratedDynamicsType()));
+        }
+
+        if (generatedDynamics_ == nullptr)
+        {
+            CONTROLIT_WARN << "Unable to load generated dynamics \"" << params->getGeneratedDynamicsType()
+                           << "\".  Falling back to the general dynamics computation.";
+        }
+        else if (!generatedDynamics_->matches(*(rbdlModel_.get())))
+        {
+            CONTROLIT_WARN << "The generated dynamics \"" << params->getGeneratedDynamicsType()
+                           << "\" were generated for a different robot model.  Regenerate them "
+                              "from the current URDF.  Falling back to the general dynamics computation.";
+            generatedDynamics_.reset();
+        }
+        else
+        {
+            CONTROLIT_INFO << "Using generated dynamics \"" << params->getGeneratedDynamicsType() << "\".";
+        }
+    }
+
+    buildUpdateGraph();
 
     // Initialize the joint state time stamp to be now
-    jointStateTimeStamp = high_resolution_clock::now();
+    jointStateTimeStamp = ControllerClock::now();
 
     // Update the vector that contains the actuated joint names
     actuatedJointNames.clear();
@@ -434,34 +476,36 @@ void ControlModel::update()
   
     assert(initialized_);
   
-    /*
-     * Selectively update the kinematics of the robot model.
-     * In this case, only update the joint positions, not the
-     * joint velocities or accelerations.
-     *
-     * QUESTION 1: Is it necessary to set the joint velocities
-     * and accelerations to zero to properly compute gravity
-     * and the inertia matrix?
-     *
-     * QUESTION 2: Why don't we remove this method call and instead
-     * change the last parameter of the next method call to be true?
-     *
-     * See: http://rbdl.bitbucket.org/de/d92/group__kinematics__group.html#gab748e2c620c3129e94e0c6665cd6638d
-     */
-     RigidBodyDynamics::UpdateKinematicsCustom(*(rbdlModel_.get()), &Q_, NULL, NULL);
-     // RigidBodyDynamics::UpdateKinematics(*(rbdlModel_.get()), Q_, Qd_, Qdd_);
-  
-    /*
-     * Compute the joint space inertia matrix by using the Composite Rigid Body Algorithm.
-     * In this case, the matrix 'A' is the joint state inertia matrix, which is
-     * where the results are stored.
-     *
-     * The last parameter specifies whether to update the kinematics.  It is false
-     * since the kinematics were just updated.
-     *
-     * See: http://rbdl.bitbucket.org/d6/d63/group__dynamics__group.html#ga673f38a3cb6fce883ec5d52ad6f3f6e0
-     */
-    RigidBodyDynamics::CompositeRigidBodyAlgorithm(*(rbdlModel_.get()), Q_, A_, false);
+    if (generatedDynamics_ != nullptr)
+    {
+        /*
+         * Same as below, but with the passes unrolled for this specific robot.
+         */
+        generatedDynamics_->update(*(rbdlModel_.get()), Q_, Qd_, Qdd_, &A_, gravOnly_, coriolis_);
+    }
+    else if (fusedDynamics_.isSupported())
+    {
+        /*
+         * Compute the kinematics, the joint space inertia matrix 'A', and the
+         * gravity and Coriolis vectors in one forward and one backward pass
+         * over the robot's bodies.  Afterwards the RBDL model's kinematics are
+         * the same as after UpdateKinematicsCustom(&Q_, &Qd_, &Qdd_).
+         */
+        fusedDynamics_.update(*(rbdlModel_.get()), Q_, Qd_, Qdd_, &A_, gravOnly_, coriolis_);
+    }
+    else
+    {
+        /*
+         * Compute the joint space inertia matrix by using the Composite Rigid Body Algorithm.
+         * The kinematics are updated with the joint positions only.
+         *
+         * See: http://rbdl.bitbucket.org/d6/d63/group__dynamics__group.html#ga673f38a3cb6fce883ec5d52ad6f3f6e0
+         */
+        RigidBodyDynamics::UpdateKinematicsCustom(*(rbdlModel_.get()), &Q_, NULL, NULL);
+        RigidBodyDynamics::CompositeRigidBodyAlgorithm(*(rbdlModel_.get()), Q_, A_, false);
+
+        updateGravAndCoriolisRBDL();
+    }
   
     // Account for rotor inertias
     // CONTROLIT_INFO_RT << "Inertia matrix prior to adding rotor inertia:\n" << A_;
@@ -488,26 +532,107 @@ void ControlModel::update()
     controlit_assert_msg(controlit::addons::eigen::checkRange(A_, -INFINITY_THRESHOLD, INFINITY_THRESHOLD), "Invalid 'A' matrix after update.");
   #endif
   
-    // Compute gravity
-    // RigidBodyDynamics::InverseDynamics(*(rbdlModel_.get()), Q_, Vector::Zero(Q_.size()), Vector::Zero(Q_.size()), grav_);
-    RigidBodyDynamics::InverseDynamics(*(rbdlModel_.get()), Q_, Qd_, Vector::Zero(Q_.size()), grav_);
-  
     /*!
      * Apply a mask on the gravity vector.  This is used to remove
      * the force of gravity from certain links on the robot.
      */
-    grav_ = gravMask_.cwiseProduct(grav_);
+    applyGravMask();
   
     // PRINT_DEBUG_STATEMENT("After applying gravity mask:\n"
     //   " - grav_ = " << grav_.transpose());
   
+    // std::cout<<"first 6 dofs = "<<Q_.head(6).transpose()<<std::endl;
+
     /*!
+     * Update Ainv_, the ConstraintSet, and the VirtualLinkageModel.  See
+     * buildUpdateGraph() for the order of the steps and which of them run
+     * concurrently.
+     */
+    constraints_->beginUpdate(*(rbdlModel_.get()));
+    updateGraph_.run();
+  
+    fullUpdateQ_ = Q_;
+    isStale_ = false;
+    hasPredictedValues_ = false;
+}
+
+void ControlModel::buildUpdateGraph()
+{
+    updateGraph_.clear();
+
+    /*
      * Update Ainv_, the inverse of A.  The inverse of A is useful for
      * computing how the robot will accerate given the application
      * of a particular torque or force.
+     *
+     * The constraint Jacobians only depend on the kinematics, so they are
+     * computed at the same time.
      */
-     Ainv_ = A_.inverse(); // TODO: be smarter and do this faster!
-  
+    size_t stage = updateGraph_.addStage();
+    updateGraph_.addStep(stage, [this]() { Ainv_ = A_.inverse(); }); // TODO: be smarter and do this faster!
+
+    for (size_t ii = 0; ii < constraints_->getConstraintSet().size(); ii++)
+    {
+        updateGraph_.addStep(stage, [this, ii]()
+        {
+            constraints_->updateJacobian(*(rbdlModel_.get()), Q_, ii);
+        });
+    }
+
+    /*
+     * The projections of the ConstraintSet and the contact quantities of the
+     * VirtualLinkageModel both depend on the constraint Jacobian and Ainv_.
+     */
+    stage = updateGraph_.addStage();
+    updateGraph_.addStep(stage, [this]() { constraints_->updateProjections(Ainv_); });
+    updateGraph_.addStep(stage, [this]()
+    {
+        virtualLinkageModel_->updateContacts(*(rbdlModel_.get()), *(constraints_.get()), Q_, Ainv_);
+    });
+
+    /*
+     * The projections of the VirtualLinkageModel may reuse those of the ConstraintSet.
+     */
+    stage = updateGraph_.addStage();
+    updateGraph_.addStep(stage, [this]() { virtualLinkageModel_->updateProjections(*(constraints_.get())); });
+}
+
+void ControlModel::updateGravity()
+{
+    PRINT_DEBUG_STATEMENT("Method called!\n"
+      " - name = " << name << "\n"
+      " - Q: " << Q_.transpose() << "\n"
+      " - Qd: " << Qd_.transpose())
+
+    assert(initialized_);
+
+    // Do not keep predicted projection matrices, otherwise the prediction
+    // error compounds across model updates.
+    if (hasPredictedValues_)
+    {
+        update();
+        return;
+    }
+
+    if (generatedDynamics_ != nullptr)
+        generatedDynamics_->update(*(rbdlModel_.get()), Q_, Qd_, Qdd_, NULL, gravOnly_, coriolis_);
+    else if (fusedDynamics_.isSupported())
+        fusedDynamics_.update(*(rbdlModel_.get()), Q_, Qd_, Qdd_, NULL, gravOnly_, coriolis_);
+    else
+        updateGravAndCoriolisRBDL();
+
+    applyGravMask();
+}
+
+void ControlModel::updateGravAndCoriolisRBDL()
+{
+    // InverseDynamics updates the kinematics using Q_ and Qd_
+    RigidBodyDynamics::InverseDynamics(*(rbdlModel_.get()), Q_, Qd_, zeroQdd_, coriolis_);
+
+    // Without joint velocities only gravity remains
+    RigidBodyDynamics::InverseDynamics(*(rbdlModel_.get()), Q_, zeroQdd_, zeroQdd_, gravOnly_);
+    coriolis_ -= gravOnly_;
+
     /*
      * Update the kinematics of the robot model.
      * In this case, update the joint positions, velocities, and accelerations.
@@ -515,19 +640,13 @@ void ControlModel::update()
      * See: http://rbdl.bitbucket.org/de/d92/group__kinematics__group.html#gab748e2c620c3129e94e0c6665cd6638d
      */
     RigidBodyDynamics::UpdateKinematicsCustom(*(rbdlModel_.get()), &Q_, &Qd_, &Qdd_);
-    // std::cout<<"first 6 dofs = "<<Q_.head(6).transpose()<<std::endl;
-  
-    /*!
-     * Update the ConstraintSet.  This includes updating the constraint Jacobian matrix.
-     */
-    constraints_->update(*(rbdlModel_.get()), Q_, Ainv_);
-  
-    /*!
-     * Update the VirtualLinkageModel.
-     */
-    virtualLinkageModel_->update(*(rbdlModel_.get()), *(constraints_.get()), Q_, Ainv_);
-  
-    isStale_ = false;
+}
+
+void ControlModel::applyGravMask()
+{
+    gravOnly_ = gravMask_.cwiseProduct(gravOnly_);
+    coriolis_ = gravMask_.cwiseProduct(coriolis_);
+    grav_ = gravOnly_ + coriolis_;
 }
 
 void ControlModel::updateJointState()
@@ -571,7 +690,14 @@ void ControlModel::getLatestFullState(Vector & Q, Vector & Qd)
   
     if (Qd.size() != getNumDOFs())
         Qd.resize(getNumDOFs());
-  
+
+    getLatestFullState(Eigen::Ref<Vector>(Q), Eigen::Ref<Vector>(Qd));
+}
+
+void ControlModel::getLatestFullState(Eigen::Ref<Vector> Q, Eigen::Ref<Vector> Qd)
+{
+    assert(Q.size() == getNumDOFs() && Qd.size() == getNumDOFs());
+
     int numVirtualDOFs = getNumVirtualDOFs();
   
     // Save the latest virtual DOF state
@@ -929,7 +1055,7 @@ bool ControlModel::getLinkAndJointNames(std::string & linkNames, std::string & j
 
 double ControlModel::getAge()
 {
-    high_resolution_clock::time_point currTime = high_resolution_clock::now();
+    high_resolution_clock::time_point currTime = ControllerClock::now();
     std::chrono::nanoseconds timeSpan = duration_cast<std::chrono::nanoseconds>(
         currTime - jointStateTimeStamp);
     return timeSpan.count() / 1e9;
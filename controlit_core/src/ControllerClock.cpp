@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/ControllerClock.hpp>
+
+#include <atomic>
+
+namespace controlit {
+
+namespace {
+
+std::atomic<bool> useSimulatedClock(false);
+std::atomic<int64_t> simulatedTimeNS(0);
+
+} // namespace
+
+void ControllerClock::setSimulated(bool simulated)
+{
+    simulatedTimeNS.store(0);
+    useSimulatedClock.store(simulated);
+}
+
+bool ControllerClock::isSimulated()
+{
+    return useSimulatedClock.load(std::memory_order_relaxed);
+}
+
+void ControllerClock::setSimulatedTime(int64_t nanoseconds)
+{
+    simulatedTimeNS.store(nanoseconds, std::memory_order_release);
+}
+
+int64_t ControllerClock::getSimulatedTime()
+{
+    return simulatedTimeNS.load(std::memory_order_acquire);
+}
+
+double ControllerClock::getTime()
+{
+    if (isSimulated())
+        return getSimulatedTime() / 1e9;
+
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+high_resolution_clock::time_point ControllerClock::now()
+{
+    if (isSimulated())
+    {
+        return high_resolution_clock::time_point(
+            std::chrono::duration_cast<high_resolution_clock::duration>(
+                std::chrono::nanoseconds(getSimulatedTime())));
+    }
+
+    return high_resolution_clock::now();
+}
+
+} // namespace controlit
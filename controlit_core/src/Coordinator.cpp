@@ -27,10 +27,16 @@
 #include <controlit/Constraint.hpp>
 #include <controlit/ConstraintSet.hpp>
 #include <controlit/Controller.hpp>
+#include <controlit/ControllerClock.hpp>
+#include <controlit/TimerChrono.hpp>
+#include <controlit/AllocationCheck.hpp>
+#include <controlit/ScratchArena.hpp>
 #include <controlit/CompoundTaskFactory.hpp>
 #include <controlit_robot_models/rbdl_robot_urdfreader.hpp>
 #include <controlit/utility/string_utility.hpp>
 #include <controlit/Diagnostics.hpp>
+#include <controlit/RealTimeConfig.hpp>
+#include <controlit/addons/cpp/GlobalThreadPool.hpp>
 
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -55,6 +61,12 @@ namespace controlit {
 // #define PRINT_INFO_STATEMENT_RT(ss) CONTROLIT_INFO_RT << ss;
 
 #define PRINT_INFO_STATEMENT_RT_ALWAYS(ss) CONTROLIT_INFO_RT << ss;
+
+/*!
+ * The number of servo cycles during which the servo thread may allocate
+ * memory, e.g., to size the scratch arena and lazily allocated buffers.
+ */
+#define ALLOCATION_CHECK_WARMUP_CYCLES 100
 // #define PRINT_INFO_STATEMENT_RT_ALWAYS(ss) std::cout << ss << std::endl;
 
 #define NUM_SERVO_UPDATE_INTERNAL_LATENCIES 7
@@ -66,19 +78,28 @@ namespace controlit {
 #define INDEX_LATENCY_WRITE 5
 #define INDEX_LATENCY_SERVO 6
 
+#define NUM_MODEL_PREDICTION_ERRORS 6
+
+#define NUM_DEGRADATION_VALUES 3
+#define INDEX_DEGRADATION_LEVEL 0
+#define INDEX_DEGRADATION_NUM_CHANGES 1
+#define INDEX_DEGRADATION_LOAD 2
+
 Coordinator::Coordinator() :
     model(nullptr),
-    jointStatePublisher("/joint_states", 1),
-    modelStalenessPublisher("diagnostics/modelStaleness", 1),
-    servoComputeLatencyPublisher("diagnostics/servoComputeLatency", 1),
-    servoFrequencyPublisher("diagnostics/servoFrequency", 1),
     initialized(false),
     running(false),
     taskUpdater(nullptr),
     servoClock(nullptr),
     robotInterface(nullptr),
     compoundTask(nullptr),
-    controller(nullptr)
+    controller(nullptr),
+    predictModel(false),
+    workerPool(nullptr),
+    workerAccount(nullptr),
+    degradationChangePending(false),
+    servoCycleCount(0),
+    numServoCycles(0)
     // isFirstState(true),
     // isFirstCommand(true)
 {
@@ -104,20 +125,36 @@ Coordinator::~Coordinator()
 }
 
 bool Coordinator::init()
+{
+    // Create the ROS node handle
+    ros::NodeHandle nh;
+    return init(nh);
+}
+
+bool Coordinator::init(ros::NodeHandle & nh)
 {
     PRINT_INFO_STATEMENT("Method called, initialized = " <<  (initialized ? "true" : "false"))
 
     // Ensure this controller is only initialized once.
     assert(!initialized);
 
-    // Create the ROS node handle
-    ros::NodeHandle nh;
-
     PRINT_INFO_STATEMENT("Initializing ControlIt! controller named \"" <<  nh.getNamespace() << "\"...")
 
     // Load the parameters
     if (!loadParameters(nh)) return false;
 
+    // In lockstep mode, time only advances when the simulator steps the controller
+    if (controlitParameters.useLockstep())
+    {
+        PRINT_INFO_STATEMENT("Running in lockstep with a simulator.");
+        ControllerClock::setSimulated(true);
+    }
+
+    // Configure the placement of the threads, which is applied as each thread starts
+    RealTimeConfig::configure(controlitParameters.getThreadPlacements(),
+        controlitParameters.getLockMemory(), controlitParameters.getPrefaultStackSize(),
+        std::bind(&Diagnostics::publishWarning, &diagnostics, std::placeholders::_1));
+
     // Instantiate the control model, which may be single or multi threaded.
     if (controlitParameters.useSingleThreadedControlModel())
     {
@@ -130,6 +167,14 @@ bool Coordinator::init()
         model = new RTControlModel();
     }
 
+    // Publish the diagnostics in the controller's namespace
+    modelStalenessPublisher.init(nh, "diagnostics/modelStaleness", 1);
+    modelPredictionErrorPublisher.init(nh, "diagnostics/modelPredictionError", 1);
+    taskUpdateRatePublisher.init(nh, "diagnostics/taskUpdateRate", 1);
+    servoComputeLatencyPublisher.init(nh, "diagnostics/servoComputeLatency", 1);
+    servoFrequencyPublisher.init(nh, "diagnostics/servoFrequency", 1);
+    degradationPublisher.init(nh, "diagnostics/degradation", 1);
+
     // Initialize diagnostics and the parameter binding manager.
     diagnostics.init(nh, this);
     bindingManager.init(nh);
@@ -145,6 +190,19 @@ bool Coordinator::init()
         // PRINT_INFO_STATEMENT("Loading sensor set...");
         // if (!loadSensorSet(nh)) return false;
 
+        // Run the model and task updates on the shared worker pool
+        if (workerPool != nullptr)
+        {
+            PRINT_INFO_STATEMENT("Using shared worker pool...");
+            workerAccount = workerPool->addAccount(nh.getNamespace(), controlitParameters.getWorkerCPUQuota());
+            model->setWorkerPool(workerPool, workerAccount);
+            taskUpdater->setWorkerPool(workerPool, workerAccount);
+
+            if (controlitParameters.getNumTaskCommandThreads() > 0)
+                compoundTask->setCommandWorkerPool(workerPool, workerAccount,
+                    controlitParameters.getNumTaskCommandThreads());
+        }
+
         PRINT_INFO_STATEMENT("Applying parameters...");
         if (!applyParameters()) return false;
 
@@ -180,7 +238,14 @@ bool Coordinator::init()
         if (robotInterface->init(nh, model))
         {
             servoFreqTimer = robotInterface->getTimer();
-            servoLatencyTimer = robotInterface->getTimer();
+
+            // In simulated time a servo cycle takes no time, so measure its
+            // compute latency on the wall clock.
+            if (ControllerClock::isSimulated())
+                servoLatencyTimer.reset(new TimerChrono());
+            else
+                servoLatencyTimer = robotInterface->getTimer();
+
             PRINT_INFO_STATEMENT("Done initializing robot interface...");
         }
         else
@@ -198,6 +263,27 @@ bool Coordinator::init()
     PRINT_INFO_STATEMENT("Initializing controller");
     controller->init(nh, *model->get(), & controlitParameters, robotInterface->getTimer());
 
+    // Allow the tasks to follow goal trajectories
+    if (controlitParameters.getMaxTrajectorySegments() > 0)
+    {
+        PRINT_INFO_STATEMENT("Initializing trajectory engine");
+        if (!trajectoryEngine.init(nh, *compoundTask, robotInterface->getTimer(),
+            controlitParameters.getMaxTrajectorySegments()))
+        {
+            CONTROLIT_ERROR_RT << "Unable to initialize trajectory engine!";
+            return false;
+        }
+    }
+
+    // Allow the control model to be extrapolated between model updates
+    predictModel = controlitParameters.getMaxModelExtrapolation() > 0;
+    if (predictModel)
+    {
+        PRINT_INFO_STATEMENT("Initializing model predictor");
+        modelPredictor.init(model->get()->getNumDOFs(), model->get()->getNActuableDOFs(),
+            controlitParameters.getMaxModelExtrapolation());
+    }
+
     // Create and initialize the servoClock
     std::string servoClockType = controlitParameters.getServoClockType();
     PRINT_INFO_STATEMENT("Creating servo clock of type \"" << servoClockType << "\"...");
@@ -228,6 +314,23 @@ bool Coordinator::init()
     modelStalenessPublisher.msg_.data = 0;
     modelStalenessPublisher.unlockAndPublish();
 
+    // Create a real-time publisher of the model prediction error
+    while (!modelPredictionErrorPublisher.trylock()) usleep(200);
+    modelPredictionErrorPublisher.msg_.layout.dim.resize(1);
+    modelPredictionErrorPublisher.msg_.layout.dim[0].stride = NUM_MODEL_PREDICTION_ERRORS;
+    modelPredictionErrorPublisher.msg_.layout.dim[0].size = NUM_MODEL_PREDICTION_ERRORS;
+    modelPredictionErrorPublisher.msg_.data.resize(NUM_MODEL_PREDICTION_ERRORS);
+    modelPredictionErrorPublisher.unlockAndPublish();
+
+    // Create a real-time publisher of the task update statistics
+    size_t numTasks = taskUpdater->getTasks().size();
+    while (!taskUpdateRatePublisher.trylock()) usleep(200);
+    taskUpdateRatePublisher.msg_.layout.dim.resize(1);
+    taskUpdateRatePublisher.msg_.layout.dim[0].stride = 2 * numTasks;
+    taskUpdateRatePublisher.msg_.layout.dim[0].size = 2 * numTasks;
+    taskUpdateRatePublisher.msg_.data.resize(2 * numTasks);
+    taskUpdateRatePublisher.unlockAndPublish();
+
     // Create a real-time publisher of the servo compute latency
     while (!servoComputeLatencyPublisher.trylock()) usleep(200);
     servoComputeLatencyPublisher.msg_.layout.dim.resize(NUM_SERVO_UPDATE_INTERNAL_LATENCIES);
@@ -243,22 +346,33 @@ bool Coordinator::init()
     servoFrequencyPublisher.msg_.data = 0;
     servoFrequencyPublisher.unlockAndPublish();
 
-    // Create a real-time publisher of the joint states. This information is used by
-    // robot_state_publisher to publish the transforms for RViz visualization.
-    while (!jointStatePublisher.trylock()) usleep(200);
-
-    const std::vector<std::string> & jointNames = model->get()->getRealJointNamesVector();
-
-    for (auto & name : jointNames)
+    // Create a real-time publisher of the degradation level
+    while (!degradationPublisher.trylock()) usleep(200);
+    degradationPublisher.msg_.layout.dim.resize(1);
+    degradationPublisher.msg_.layout.dim[0].stride = NUM_DEGRADATION_VALUES;
+    degradationPublisher.msg_.layout.dim[0].size = NUM_DEGRADATION_VALUES;
+    degradationPublisher.msg_.data.resize(NUM_DEGRADATION_VALUES);
+    degradationPublisher.unlockAndPublish();
+
+    // Shed load when the servo loop overruns.  This is not done in lockstep
+    // mode since the results would then depend on the wall clock.
+    if (!controlitParameters.useLockstep())
+        loadGovernor.init(controlitParameters.getDegradationConfig(), 1.0 / controlitParameters.getServoFrequency());
+
+    // Publish the odometry transform and the joint states outside of the servo thread
+    if (!telemetryPublisher.init(nh, model->get()->getRealJointNamesVector(),
+        model->get()->getBaseLinkName(), controlitParameters.getTelemetryRate()))
     {
-        jointStatePublisher.msg_.name.push_back(name);
-        jointStatePublisher.msg_.position.push_back(0.0);  // allocate memory for the joint states
-        jointStatePublisher.msg_.velocity.push_back(0.0);
-        jointStatePublisher.msg_.effort.push_back(0.0);
+        CONTROLIT_ERROR_RT << "Unable to initialize telemetry publisher!";
+        return false;
     }
 
-    jointStatePublisher.unlockAndPublish();
+    // Place the threads that publish the real-time messages
+    for (auto thread : controlit::addons::cpp::get_thread_pool_native_handles())
+        RealTimeConfig::placeThread("publisher", thread);
 
+    // Now that all buffers are allocated, lock them into memory
+    RealTimeConfig::lockMemory();
 
     // Create a service for getting the controller configuration
     getControllerConfigService = nh.advertiseService("diagnostics/getControllerConfiguration",
@@ -326,6 +440,9 @@ bool Coordinator::start()
     // Start the task updater thread
     taskUpdater->startThread();
 
+    // Start the telemetry thread
+    telemetryPublisher.startThread();
+
     running = true;
 
     CONTROLIT_INFO_RT << "Starting whole body controller...";
@@ -335,10 +452,23 @@ bool Coordinator::start()
     return true;
 }
 
+StateEvent * Coordinator::getStateEvent()
+{
+    if (robotInterface.get() == nullptr) return nullptr;
+    return robotInterface->getStateEvent();
+}
+
 // This is called by the ServoClock once after it is started.
 void Coordinator::servoInit()
 {
     forceUpdateControlModel(model->get());     // Update the active control model
+
+    if (predictModel)
+    {
+        modelPredictor.reset();
+        modelPredictor.addSnapshot(*model->get());
+    }
+
     servoFreqTimer->start();                   // Start the servo frequency timer. First measurement will be wrong but can be ignored.
 }
 
@@ -347,11 +477,27 @@ void Coordinator::servoUpdate()
 {
     // #define TIME_CONTROLIT_CONTROLLER_UPDATE 1
 
+    // Release the scratch memory of the previous cycle.
+    ScratchArena::getThreadArena().reset();
+
+    // Once warmed up, the servo thread must not allocate memory.  This is only
+    // checked when compiled with CONTROLIT_CHECK_SERVO_ALLOCATIONS.
+    NoAllocationScope noAllocation(numServoCycles >= ALLOCATION_CHECK_WARMUP_CYCLES);
+    if (numServoCycles < ALLOCATION_CHECK_WARMUP_CYCLES)
+        numServoCycles++;
+
     // Start recording the servo compute time.
     servoLatencyTimer->start();
 
+    // Determine which decimated parts of the servo loop run in this cycle.
+    servoCycleCount++;
+    bool publishTelemetry = isDecimatedCycle(DegradationStep::TELEMETRY,
+        loadGovernor.getConfig().telemetryDecimation);
+    bool evaluateEvents = isDecimatedCycle(DegradationStep::EVENTS,
+        loadGovernor.getConfig().eventDecimation);
+
     // If possible, publish the servo frequency.
-    if(servoFrequencyPublisher.trylock())
+    if(publishTelemetry && servoFrequencyPublisher.trylock())
     {
         double elapsedTime = servoFreqTimer->getTime();
         servoFrequencyPublisher.msg_.data = 1.0 / elapsedTime;
@@ -398,47 +544,9 @@ void Coordinator::servoUpdate()
 
     latencyRead = servoLatencyTimer->getTime();
 
-    // Publish the current joint states
-    if(jointStatePublisher.trylock())
-    {
-        const Vector & jointPosition = latestRobotState.getJointPosition();
-        const Vector & jointVelocity = latestRobotState.getJointVelocity();
-        const Vector & jointEffort = latestRobotState.getJointEffort();
-
-        for (int ii = 0; ii < jointPosition.size(); ii++)
-        {
-            jointStatePublisher.msg_.position[ii] = jointPosition[ii];
-            jointStatePublisher.msg_.velocity[ii] = jointVelocity[ii];
-            jointStatePublisher.msg_.effort[ii] = jointEffort[ii];
-        }
-
-        jointStatePublisher.unlockAndPublish();
-    }
-
-    // Publish the odometry information.  This is the state of the virtual 6 DOFs that connect the
-    // robot to the world.
-    geometry_msgs::TransformStamped odom_trans;
-
-    odom_trans.header.frame_id = "world";
-    odom_trans.child_frame_id = model->get()->getBaseLinkName();
-
-    odom_trans.header.stamp = ros::Time::now();
-    odom_trans.transform.translation.x = latestRobotState.getVirtualJointPosition()(0, 0); // x
-    odom_trans.transform.translation.y = latestRobotState.getVirtualJointPosition()(1, 0); // y
-    odom_trans.transform.translation.z = latestRobotState.getVirtualJointPosition()(2, 0); // z
-
-    // The virtual DOFs in latestRobotState are stored in x,y,z,y,p,r order
-    tf::Quaternion virtualDOFQuat = tf::createQuaternionFromRPY(
-        latestRobotState.getVirtualJointPosition()(5, 0),  // roll
-        latestRobotState.getVirtualJointPosition()(4, 0),  // pitch
-        latestRobotState.getVirtualJointPosition()(3, 0)); // yaw
-
-    odom_trans.transform.rotation.x = virtualDOFQuat.x();
-    odom_trans.transform.rotation.y = virtualDOFQuat.y();
-    odom_trans.transform.rotation.z = virtualDOFQuat.z();
-    odom_trans.transform.rotation.w = virtualDOFQuat.w();
-
-    tfBroadcaster.sendTransform(odom_trans);
+    // Hand the odometry and joint states to the telemetry thread, which publishes them
+    if (publishTelemetry)
+        telemetryPublisher.write(latestRobotState);
 
     latencyPublishOdom = servoLatencyTimer->getTime();
 
@@ -463,6 +571,12 @@ void Coordinator::servoUpdate()
             << "Aborting this round of the servo loop!";
     }
 
+    // Apply new values received by polled parameter bindings, e.g., shared memory
+    bindingManager.pollBindings();
+
+    // Advance the goal trajectories
+    trajectoryEngine.update();
+
     // Compute command
     computeCommand();
 
@@ -473,7 +587,8 @@ void Coordinator::servoUpdate()
     // #endif
 
     // Emit events
-    emitEvents();
+    if (evaluateEvents)
+        emitEvents();
 
     latencyEvents = servoLatencyTimer->getTime();
 
@@ -540,11 +655,25 @@ void Coordinator::servoUpdate()
     PRINT_INFO_STATEMENT_RT("Gravity:\n" << controlit::utility::prettyPrintJointSpaceCommand(model->get()->getActuatedJointNamesVector(),
         model->get()->getGrav().segment(model->get()->getNumVirtualDOFs(), model->get()->getNActuableDOFs()), "  "))
 
-    // If possible, publish the servo compute latency measurement.
-    if(servoComputeLatencyPublisher.trylock())
+    latencyServo = servoLatencyTimer->getTime();
+
+    // Degrade or restore the servo loop depending on its compute time.
+    if (loadGovernor.update(latencyServo))
+        applyDegradation();
+
+    // Report every change of the degradation level.
+    if (degradationChangePending && degradationPublisher.trylock())
     {
-        latencyServo = servoLatencyTimer->getTime();
+        degradationPublisher.msg_.data[INDEX_DEGRADATION_LEVEL] = loadGovernor.getLevel();
+        degradationPublisher.msg_.data[INDEX_DEGRADATION_NUM_CHANGES] = loadGovernor.getNumLevelChanges();
+        degradationPublisher.msg_.data[INDEX_DEGRADATION_LOAD] = loadGovernor.getLoad();
+        degradationPublisher.unlockAndPublish();
+        degradationChangePending = false;
+    }
 
+    // If possible, publish the servo compute latency measurement.
+    if(publishTelemetry && servoComputeLatencyPublisher.trylock())
+    {
         // CONTROLIT_INFO << "Computing servo compute latency...";
         servoComputeLatencyPublisher.msg_.data[INDEX_LATENCY_READ]            = latencyRead;
         servoComputeLatencyPublisher.msg_.data[INDEX_LATENCY_PUBLISH_ODOM]    = latencyPublishOdom - latencyRead;
@@ -558,6 +687,44 @@ void Coordinator::servoUpdate()
     }
 }
 
+void Coordinator::getServoLatencies(Vector & latencies) const
+{
+    latencies.resize(NUM_SERVO_UPDATE_INTERNAL_LATENCIES);
+    latencies[INDEX_LATENCY_READ]            = latencyRead;
+    latencies[INDEX_LATENCY_PUBLISH_ODOM]    = latencyPublishOdom - latencyRead;
+    latencies[INDEX_LATENCY_MODEL_UDPATE]    = latencyModelUpdate - latencyPublishOdom;
+    latencies[INDEX_LATENCY_COMPUTE_COMMAND] = latencyComputeCmd - latencyModelUpdate;
+    latencies[INDEX_LATENCY_EVENTS]          = latencyEvents - latencyComputeCmd;
+    latencies[INDEX_LATENCY_WRITE]           = latencyWrite - latencyEvents;
+    latencies[INDEX_LATENCY_SERVO]           = latencyServo;
+}
+
+void Coordinator::applyDegradation()
+{
+    const DegradationConfig & config = loadGovernor.getConfig();
+
+    if (loadGovernor.isApplied(DegradationStep::TASK_UPDATES))
+        taskUpdater->setMinUpdatePeriod(config.taskUpdatePeriod, config.taskUpdatePriority);
+    else
+        taskUpdater->setMinUpdatePeriod(0, config.taskUpdatePriority);
+
+    if (loadGovernor.isApplied(DegradationStep::PROJECTIONS))
+        controller->setHeldProjections(config.heldPriorityLevels, config.heldProjectionCycles);
+    else
+        controller->setHeldProjections(0, 0);
+
+    CONTROLIT_WARN_RT << "Changed the degradation level to " << loadGovernor.getLevel()
+        << " of " << config.steps.size() << " at a servo load of "
+        << loadGovernor.getLoad() * 100 << "%.";
+
+    degradationChangePending = true;
+}
+
+bool Coordinator::isDecimatedCycle(DegradationStep step, int decimation) const
+{
+    return !loadGovernor.isApplied(step) || servoCycleCount % decimation == 0;
+}
+
 bool Coordinator::stop()
 {
     PRINT_INFO_STATEMENT("Method Called!")
@@ -567,6 +734,7 @@ bool Coordinator::stop()
     if (!servoClock->stop()) return false;
     if (model != nullptr) model->stopThread();
     if (taskUpdater != nullptr) taskUpdater->stopThread();
+    telemetryPublisher.stopThread();
     // if (sensorSetUpdater != nullptr) sensorSetUpdater->stopThread();
 
     model->setStale();  // Mark the control models as being stale to prevent stale models from being used when the controller spins back up
@@ -660,6 +828,22 @@ bool Coordinator::loadCompoundTask(ros::NodeHandle &nh)
         return false;
     }
 
+    // The internal force operators are only needed by an internal force task.
+    // start() updates the active model again before the first servo cycle.
+    model->setInternalForceOperatorsEnabled(compoundTask->hasInternalForceTask());
+
+    // Compute the task commands in parallel if requested.  A shared worker
+    // pool, if any, computes them instead of threads of this controller.
+    if (controlitParameters.getNumTaskCommandThreads() > 0 && workerPool == nullptr)
+    {
+        PRINT_INFO_STATEMENT("Using " << controlitParameters.getNumTaskCommandThreads() << " task command threads.");
+        if (!compoundTask->setCommandThreads(controlitParameters.getNumTaskCommandThreads(),
+            controlitParameters.getTaskCommandThreadCPUs()))
+        {
+            CONTROLIT_WARN_RT << "Failed to pin the task command threads, computing task commands serially.";
+        }
+    }
+
     // Bind parameters to ROS topics
     try
     {
@@ -853,12 +1037,47 @@ void Coordinator::checkForTaskAndModelUpdates()
         // Note that when this occurs, some of the updated tasks are missed.
         taskUpdater->checkTasksForUpdates();
 
+        // The task update statistics are atomics, so they can be read while the tasks are being updated
+        if (taskUpdateRatePublisher.trylock())
+        {
+            size_t numTasks = taskUpdater->getTasks().size();
+            for (size_t ii = 0; ii < numTasks; ii++)
+            {
+                taskUpdateRatePublisher.msg_.data[ii] = taskUpdater->getEffectiveUpdateRate(ii);
+                taskUpdateRatePublisher.msg_.data[numTasks + ii] = taskUpdater->getStaleness(ii);
+            }
+            taskUpdateRatePublisher.unlockAndPublish();
+        }
+
         // Check if we can swap the ControlModel
         bool updateOccured = model->checkUpdate();
 
         if (updateOccured)
+        {
             taskUpdater->updateTasks(model->get());
+
+            if (predictModel)
+            {
+                modelPredictor.addSnapshot(*model->get());
+
+                if (modelPredictionErrorPublisher.trylock())
+                {
+                    modelPredictionErrorPublisher.msg_.data[0] = modelPredictor.getGravityError();
+                    modelPredictionErrorPublisher.msg_.data[1] = modelPredictor.getHeldGravityError();
+                    modelPredictionErrorPublisher.msg_.data[2] = modelPredictor.getProjectionError();
+                    modelPredictionErrorPublisher.msg_.data[3] = modelPredictor.getHeldProjectionError();
+                    modelPredictionErrorPublisher.msg_.data[4] = modelPredictor.getExtrapolation();
+                    modelPredictionErrorPublisher.msg_.data[5] = modelPredictor.isApplied() ? 1 : 0;
+                    modelPredictionErrorPublisher.unlockAndPublish();
+                }
+            }
+        }
     }
+
+    // The model may be swapped only when the TaskUpdater is IDLE, but the
+    // latest joint state changes every cycle.
+    if (predictModel)
+        modelPredictor.predict(*model->get());
 }
 
 bool Coordinator::emitEvents()
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/GeneratedDynamics.hpp>
+
+#include <cmath>
+
+namespace controlit {
+
+/*!
+ * The relative tolerance with which matches(...) compares the model data.
+ * The generator prints every value with enough digits to reproduce it exactly.
+ */
+#define MODEL_DATA_TOLERANCE 1e-12
+
+bool GeneratedDynamics::matches(const RigidBodyDynamics::Model & robot) const
+{
+    std::vector<double> actual;
+    if (!getModelData(robot, actual))
+        return false;
+
+    const double * expected;
+    size_t size;
+    getGeneratedModelData(expected, size);
+
+    if (actual.size() != size)
+        return false;
+
+    for (size_t ii = 0; ii < size; ii++)
+    {
+        if (std::abs(actual[ii] - expected[ii]) > MODEL_DATA_TOLERANCE * (1 + std::abs(expected[ii])))
+            return false;
+    }
+
+    return true;
+}
+
+void GeneratedDynamics::calcPointJacobian(const RigidBodyDynamics::Model & robot, unsigned int bodyId,
+    const RigidBodyDynamics::Math::Vector3d & point,
+    RigidBodyDynamics::Math::MatrixNd & Jv, RigidBodyDynamics::Math::MatrixNd & Jw) const
+{
+    if (bodyId >= robot.fixed_body_discriminator)
+    {
+        // Express the point in the frame of the fixed body's movable parent
+        const RigidBodyDynamics::FixedBody & fixedBody =
+            robot.mFixedBodies[bodyId - robot.fixed_body_discriminator];
+
+        RigidBodyDynamics::Math::Vector3d parentPoint =
+            fixedBody.mParentTransform.E.transpose() * point + fixedBody.mParentTransform.r;
+
+        calcMovablePointJacobian(fixedBody.mMovableParent, parentPoint, Jv, Jw);
+    }
+    else
+        calcMovablePointJacobian(bodyId, point, Jv, Jw);
+}
+
+bool GeneratedDynamics::getModelData(const RigidBodyDynamics::Model & robot, std::vector<double> & data)
+{
+    size_t numBodies = robot.mBodies.size();
+
+    // Each movable body must add exactly one DOF so body i moves joint i - 1
+    bool supported = numBodies > 1 && numBodies - 1 == robot.dof_count;
+
+    data.clear();
+    data.push_back(numBodies);
+    data.push_back(robot.dof_count);
+
+    for (size_t ii = 1; ii < numBodies; ii++)
+    {
+        const RigidBodyDynamics::Math::SpatialVector & S = robot.S[ii];
+
+        bool angular = S.head<3>().norm() > 0;
+        bool linear = S.tail<3>().norm() > 0;
+
+        if (robot.mJoints[ii].mDoFCount != 1 || angular == linear)
+            supported = false;
+
+        const RigidBodyDynamics::Math::SpatialTransform & X_T = robot.X_T[ii];
+        const RigidBodyDynamics::Body & body = robot.mBodies[ii];
+
+        data.push_back(robot.lambda[ii]);
+        data.insert(data.end(), S.data(), S.data() + 6);
+        data.insert(data.end(), X_T.E.data(), X_T.E.data() + 9);
+        data.insert(data.end(), X_T.r.data(), X_T.r.data() + 3);
+        data.push_back(body.mMass);
+        data.insert(data.end(), body.mCenterOfMass.data(), body.mCenterOfMass.data() + 3);
+        data.insert(data.end(), body.mInertia.data(), body.mInertia.data() + 9);
+    }
+
+    return supported;
+}
+
+} // namespace controlit
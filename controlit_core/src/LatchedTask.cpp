@@ -68,10 +68,13 @@ bool LatchedTask::init(const ControlModel & model)
 
 void LatchedTask::updateLatch(ControlModel * model)
 {
+    // The model has already updated the kinematics and the command helpers
+    // share it, so the frame lookups below must not update it again.
+
     //The latch has just been turned on, grab the current frame
     if(!isLatched && latchOn_)
     {
-        latchedTranslation = RigidBodyDynamics::CalcBodyToBaseCoordinates(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), true);
+        latchedTranslation = RigidBodyDynamics::CalcBodyToBaseCoordinates(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), false);
         latchedRotation  = RigidBodyDynamics::CalcBodyWorldOrientation(model->rbdlModel(), model->getQ(), frameId_, false);
         isLatched = true;
         return;
@@ -87,7 +90,7 @@ void LatchedTask::updateLatch(ControlModel * model)
     //The latch should be reset (and turned on) to the current frame.
     if(resetLatch_)
     {
-        latchedTranslation = RigidBodyDynamics::CalcBodyToBaseCoordinates(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), true);
+        latchedTranslation = RigidBodyDynamics::CalcBodyToBaseCoordinates(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), false);
         latchedRotation  = RigidBodyDynamics::CalcBodyWorldOrientation(model->rbdlModel(), model->getQ(), frameId_, false);
         // Just in case
         isLatched = true;
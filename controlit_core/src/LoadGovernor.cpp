@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/LoadGovernor.hpp>
+
+#include <algorithm>
+
+namespace controlit {
+
+DegradationConfig::DegradationConfig() :
+    overrunThreshold(0.9),
+    headroomThreshold(0.6),
+    overrunCycles(20),
+    headroomCycles(1000),
+    taskUpdatePeriod(0.05),
+    taskUpdatePriority(0),
+    heldPriorityLevels(1),
+    heldProjectionCycles(10),
+    telemetryDecimation(10),
+    eventDecimation(10)
+{
+}
+
+bool DegradationConfig::parseStep(const std::string & name, DegradationStep & step)
+{
+    if (name == "task_updates")
+        step = DegradationStep::TASK_UPDATES;
+    else if (name == "projections")
+        step = DegradationStep::PROJECTIONS;
+    else if (name == "telemetry")
+        step = DegradationStep::TELEMETRY;
+    else if (name == "events")
+        step = DegradationStep::EVENTS;
+    else
+        return false;
+
+    return true;
+}
+
+std::string DegradationConfig::getStepName(DegradationStep step)
+{
+    switch (step)
+    {
+        case DegradationStep::TASK_UPDATES: return "task_updates";
+        case DegradationStep::PROJECTIONS: return "projections";
+        case DegradationStep::TELEMETRY: return "telemetry";
+        case DegradationStep::EVENTS: return "events";
+        default: return "unknown";
+    }
+}
+
+LoadGovernor::LoadGovernor() :
+    servoPeriod(0),
+    level(0),
+    overrunCount(0),
+    headroomCount(0),
+    numLevelChanges(0),
+    load(0)
+{
+}
+
+void LoadGovernor::init(const DegradationConfig & config, double servoPeriod)
+{
+    this->config = config;
+    this->servoPeriod = servoPeriod;
+    level = 0;
+    overrunCount = 0;
+    headroomCount = 0;
+    numLevelChanges = 0;
+    load = 0;
+}
+
+bool LoadGovernor::update(double computeTime)
+{
+    if (!isEnabled() || servoPeriod <= 0) return false;
+
+    load = computeTime / servoPeriod;
+
+    // Overruns accumulate so that occasional good cycles do not hide a
+    // sustained overload, but headroom must be consecutive before a step
+    // is restored.
+    if (load > config.overrunThreshold)
+    {
+        overrunCount++;
+        headroomCount = 0;
+    }
+    else
+    {
+        overrunCount = std::max(overrunCount - 1, 0);
+
+        if (load < config.headroomThreshold)
+            headroomCount++;
+        else
+            headroomCount = 0;
+    }
+
+    int numSteps = static_cast<int>(config.steps.size());
+
+    if (overrunCount >= config.overrunCycles && level < numSteps)
+    {
+        level++;
+    }
+    else if (headroomCount >= config.headroomCycles && level > 0)
+    {
+        level--;
+    }
+    else
+        return false;
+
+    overrunCount = 0;
+    headroomCount = 0;
+    numLevelChanges++;
+    return true;
+}
+
+bool LoadGovernor::isApplied(DegradationStep step) const
+{
+    for (int ii = 0; ii < level; ii++)
+    {
+        if (config.steps[ii] == step)
+            return true;
+    }
+    return false;
+}
+
+} // namespace controlit
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/ModelPredictor.hpp>
+
+#include <algorithm>
+#include <controlit/ControlModel.hpp>
+#include <controlit/ConstraintSet.hpp>
+#include <controlit/logging/RealTimeLogging.hpp>
+
+namespace controlit {
+
+// Uncomment one of the following lines to enable/disable detailed debug statements.
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+#define PRINT_DEBUG_STATEMENT_RT(ss)
+// #define PRINT_DEBUG_STATEMENT_RT(ss) CONTROLIT_DEBUG_RT << ss;
+
+/*!
+ * Snapshots closer than this in joint space (in radians or meters) are
+ * too close to estimate a derivative from.
+ */
+#define MIN_SNAPSHOT_DISTANCE 1e-6
+
+/*!
+ * The weight of the newest error in the moving averages.
+ */
+#define ERROR_SMOOTHING 0.1
+
+/*!
+ * The number of predictions that must be checked before the prediction
+ * may be applied.
+ */
+#define MIN_COMPARISONS 3
+
+ModelPredictor::ModelPredictor() :
+    maxExtrapolation(0),
+    extrapolation(0),
+    applied(false),
+    numComparisons(0),
+    gravityError(0),
+    heldGravityError(0),
+    projectionError(0),
+    heldProjectionError(0)
+{
+    latest.valid = false;
+    previous.valid = false;
+}
+
+void ModelPredictor::init(int numDOFs, int numActuableDOFs, double maxExtrapolation)
+{
+    this->maxExtrapolation = maxExtrapolation;
+
+    Snapshot * snapshots[] = {&latest, &previous};
+    for (Snapshot * snapshot : snapshots)
+    {
+        snapshot->Q.setZero(numDOFs);
+        snapshot->grav.setZero(numDOFs);
+        snapshot->UNcBar.setZero(numDOFs, numActuableDOFs);
+        snapshot->UNcAiNorm.setZero(numActuableDOFs, numActuableDOFs);
+    }
+
+    predictedGrav.setZero(numDOFs);
+    predictedUNcBar.setZero(numDOFs, numActuableDOFs);
+    predictedUNcAiNorm.setZero(numActuableDOFs, numActuableDOFs);
+
+    latestQ.setZero(numDOFs);
+    latestQd.setZero(numDOFs);
+
+    reset();
+}
+
+void ModelPredictor::reset()
+{
+    latest.valid = false;
+    previous.valid = false;
+    extrapolation = 0;
+    applied = false;
+    numComparisons = 0;
+    gravityError = 0;
+    heldGravityError = 0;
+    projectionError = 0;
+    heldProjectionError = 0;
+}
+
+void ModelPredictor::addSnapshot(const Vector & Q, const Vector & grav,
+    const Matrix & UNcBar, const Matrix & UNcAiNorm)
+{
+    if (Q.size() != latest.Q.size() || grav.size() != latest.grav.size()
+        || UNcBar.rows() != latest.UNcBar.rows() || UNcBar.cols() != latest.UNcBar.cols()
+        || UNcAiNorm.rows() != latest.UNcAiNorm.rows() || UNcAiNorm.cols() != latest.UNcAiNorm.cols())
+    {
+        CONTROLIT_ERROR_RT << "Snapshot dimensions do not match those given to init(...).  Ignoring it.";
+        return;
+    }
+
+    // Check how well the previous two snapshots predict the new one
+    if (latest.valid && previous.valid)
+    {
+        extrapolate(computeExtrapolation(Q), predictedGrav, predictedUNcBar, predictedUNcAiNorm);
+
+        double predictedProjection, heldProjection;
+        double predictedGravity = relativeError(predictedGrav, predictedUNcBar, predictedUNcAiNorm,
+            grav, UNcBar, UNcAiNorm, predictedProjection);
+        double heldGravity = relativeError(latest.grav, latest.UNcBar, latest.UNcAiNorm,
+            grav, UNcBar, UNcAiNorm, heldProjection);
+
+        double smoothing = numComparisons == 0 ? 1 : ERROR_SMOOTHING;
+        gravityError += smoothing * (predictedGravity - gravityError);
+        heldGravityError += smoothing * (heldGravity - heldGravityError);
+        projectionError += smoothing * (predictedProjection - projectionError);
+        heldProjectionError += smoothing * (heldProjection - heldProjectionError);
+
+        numComparisons++;
+    }
+
+    // The new snapshot replaces the oldest one.  Swapping the members of
+    // dynamically sized Eigen objects only swaps their pointers.
+    latest.Q.swap(previous.Q);
+    latest.grav.swap(previous.grav);
+    latest.UNcBar.swap(previous.UNcBar);
+    latest.UNcAiNorm.swap(previous.UNcAiNorm);
+    previous.valid = latest.valid;
+
+    latest.Q = Q;
+    latest.grav = grav;
+    latest.UNcBar = UNcBar;
+    latest.UNcAiNorm = UNcAiNorm;
+    latest.valid = true;
+}
+
+void ModelPredictor::predict(const Vector & Q, Vector & grav, Matrix & UNcBar, Matrix & UNcAiNorm)
+{
+    extrapolation = isApplied() ? computeExtrapolation(Q) : 0;
+    extrapolate(extrapolation, grav, UNcBar, UNcAiNorm);
+}
+
+void ModelPredictor::addSnapshot(const ControlModel & model)
+{
+    addSnapshot(model.getQ(), model.getGrav(),
+        model.constraints().getUNcBar(), model.constraints().getUNcAiNorm());
+
+    // The new model has not been modified yet
+    applied = false;
+}
+
+void ModelPredictor::predict(ControlModel & model)
+{
+    if (!latest.valid) return;
+
+    model.getLatestFullState(latestQ, latestQd);
+
+    extrapolation = isApplied() ? computeExtrapolation(latestQ) : 0;
+
+    // The model already holds the latest snapshot
+    if (extrapolation == 0 && !applied) return;
+
+    extrapolate(extrapolation, model.grav_,
+        model.constraints_->UNcBar_, model.constraints_->UNcAiNorm_);
+
+    applied = extrapolation != 0;
+    model.hasPredictedValues_ = applied;
+}
+
+bool ModelPredictor::isApplied() const
+{
+    return latest.valid && previous.valid && maxExtrapolation > 0
+        && numComparisons >= MIN_COMPARISONS
+        && gravityError + projectionError < heldGravityError + heldProjectionError;
+}
+
+double ModelPredictor::computeExtrapolation(const Vector & Q) const
+{
+    if (!latest.valid || !previous.valid) return 0;
+
+    double distanceSquared = (latest.Q - previous.Q).squaredNorm();
+
+    if (distanceSquared < MIN_SNAPSHOT_DISTANCE * MIN_SNAPSHOT_DISTANCE) return 0;
+
+    double alpha = (latest.Q - previous.Q).dot(Q - latest.Q) / distanceSquared;
+
+    return std::max(0.0, std::min(alpha, maxExtrapolation));
+}
+
+void ModelPredictor::extrapolate(double alpha, Vector & grav, Matrix & UNcBar, Matrix & UNcAiNorm) const
+{
+    if (alpha == 0)
+    {
+        grav = latest.grav;
+        UNcBar = latest.UNcBar;
+        UNcAiNorm = latest.UNcAiNorm;
+    }
+    else
+    {
+        grav = (1 + alpha) * latest.grav - alpha * previous.grav;
+        UNcBar = (1 + alpha) * latest.UNcBar - alpha * previous.UNcBar;
+        UNcAiNorm = (1 + alpha) * latest.UNcAiNorm - alpha * previous.UNcAiNorm;
+    }
+}
+
+double ModelPredictor::relativeError(const Vector & grav, const Matrix & UNcBar, const Matrix & UNcAiNorm,
+    const Vector & actualGrav, const Matrix & actualUNcBar, const Matrix & actualUNcAiNorm,
+    double & relativeProjectionError)
+{
+    const double epsilon = 1e-12;
+
+    relativeProjectionError = 0.5 * ((UNcBar - actualUNcBar).norm() / std::max(actualUNcBar.norm(), epsilon)
+        + (UNcAiNorm - actualUNcAiNorm).norm() / std::max(actualUNcAiNorm.norm(), epsilon));
+
+    return (grav - actualGrav).norm() / std::max(actualGrav.norm(), epsilon);
+}
+
+} // namespace controlit
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/ModelUpdateGraph.hpp>
+
+namespace controlit {
+
+ModelUpdateGraph::ModelUpdateGraph() :
+    currentStage(nullptr)
+{
+    stepBody = [this](size_t step, bool helper) { (*currentStage)[step](); };
+}
+
+void ModelUpdateGraph::setThreadPool(controlit::addons::cpp::ThreadPool * pool)
+{
+    helpers.setThreadPool(pool);
+}
+
+void ModelUpdateGraph::setWorkerPool(WorkerPool * pool, WorkerPool::Account * account, size_t numHelpers)
+{
+    helpers.setWorkerPool(pool, account, numHelpers);
+}
+
+void ModelUpdateGraph::clear()
+{
+    stages.clear();
+}
+
+size_t ModelUpdateGraph::addStage()
+{
+    stages.push_back(std::vector<Step>());
+    return stages.size() - 1;
+}
+
+void ModelUpdateGraph::addStep(size_t stage, Step step)
+{
+    stages[stage].push_back(step);
+}
+
+void ModelUpdateGraph::run()
+{
+    for (auto & stage : stages)
+    {
+        currentStage = &stage;
+        helpers.run(stage.size(), stepBody);
+    }
+
+    currentStage = nullptr;
+}
+
+} // namespace controlit
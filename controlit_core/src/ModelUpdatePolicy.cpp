@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/ModelUpdatePolicy.hpp>
+
+#include <algorithm>
+
+namespace controlit {
+
+/*!
+ * The weight of the newest duration in the moving averages.
+ */
+#define DURATION_SMOOTHING 0.05
+
+ModelUpdatePolicy::ModelUpdatePolicy() :
+    skipPositionThreshold(0),
+    skipVelocityThreshold(0),
+    partialPositionThreshold(0),
+    lastValid(false)
+{
+    std::fill(averageDuration, averageDuration + 3, 0);
+    std::fill(averageValid, averageValid + 3, false);
+    resetStatistics();
+}
+
+void ModelUpdatePolicy::init(int numDOFs, double skipPositionThreshold, double skipVelocityThreshold,
+    double partialPositionThreshold)
+{
+    this->skipPositionThreshold = skipPositionThreshold;
+    this->skipVelocityThreshold = skipVelocityThreshold;
+    this->partialPositionThreshold = partialPositionThreshold;
+
+    lastQ.setZero(numDOFs);
+    lastQd.setZero(numDOFs);
+    reset();
+}
+
+void ModelUpdatePolicy::reset()
+{
+    lastValid = false;
+}
+
+ModelUpdatePolicy::Decision ModelUpdatePolicy::decide(const Vector & Q, const Vector & Qd,
+    const Vector & fullUpdateQ, bool fullUpdateValid, bool constraintsChanged)
+{
+    Decision decision = Decision::FULL;
+
+    if (isEnabled() && fullUpdateValid && !constraintsChanged
+        && Q.size() == lastQ.size() && fullUpdateQ.size() == Q.size())
+    {
+        if (lastValid && skipPositionThreshold > 0 && skipVelocityThreshold > 0
+            && (Q - lastQ).cwiseAbs().maxCoeff() <= skipPositionThreshold
+            && (Qd - lastQd).cwiseAbs().maxCoeff() <= skipVelocityThreshold)
+        {
+            decision = Decision::SKIP;
+        }
+        else if (partialPositionThreshold > 0
+            && (Q - fullUpdateQ).cwiseAbs().maxCoeff() <= partialPositionThreshold)
+        {
+            decision = Decision::PARTIAL;
+        }
+    }
+
+    if (decision != Decision::SKIP && Q.size() == lastQ.size())
+    {
+        lastQ = Q;
+        lastQd = Qd;
+        lastValid = true;
+    }
+
+    return decision;
+}
+
+void ModelUpdatePolicy::recordUpdate(Decision decision, double duration)
+{
+    int index = static_cast<int>(decision);
+
+    numDecisions[index]++;
+    totalDuration[index] += duration;
+
+    if (averageValid[index])
+        averageDuration[index] += DURATION_SMOOTHING * (duration - averageDuration[index]);
+    else
+        averageDuration[index] = duration;
+
+    averageValid[index] = true;
+}
+
+bool ModelUpdatePolicy::isEnabled() const
+{
+    return (skipPositionThreshold > 0 && skipVelocityThreshold > 0) || partialPositionThreshold > 0;
+}
+
+double ModelUpdatePolicy::getRatio(Decision decision) const
+{
+    int total = getNumDecisions();
+    return total > 0 ? static_cast<double>(numDecisions[static_cast<int>(decision)]) / total : 0;
+}
+
+double ModelUpdatePolicy::getSavedFraction() const
+{
+    // Without a full update there is nothing to compare against
+    if (!averageValid[static_cast<int>(Decision::FULL)]) return 0;
+
+    double fullDuration = getAverageFullDuration();
+
+    // A skipped update saves a full update and a partial update saves the
+    // difference between the two
+    double saved = numDecisions[static_cast<int>(Decision::SKIP)] * fullDuration
+        + numDecisions[static_cast<int>(Decision::PARTIAL)] * std::max(0.0, fullDuration - getAveragePartialDuration());
+
+    double spent = totalDuration[0] + totalDuration[1] + totalDuration[2];
+
+    return saved + spent > 0 ? saved / (saved + spent) : 0;
+}
+
+void ModelUpdatePolicy::resetStatistics()
+{
+    std::fill(numDecisions, numDecisions + 3, 0);
+    std::fill(totalDuration, totalDuration + 3, 0);
+}
+
+} // namespace controlit
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/ParallelLoop.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace controlit {
+
+ParallelLoop::ParallelLoop() :
+    threadPool(nullptr),
+    body(nullptr),
+    numIterations(0),
+    nextIteration(0),
+    pendingHelpers(0)
+{
+    helperJob = [this]() { runHelper(); };
+}
+
+void ParallelLoop::setThreadPool(controlit::addons::cpp::ThreadPool * pool)
+{
+    threadPool = pool;
+    workerJobs.clear();
+}
+
+void ParallelLoop::setWorkerPool(WorkerPool * pool, WorkerPool::Account * account, size_t numHelpers)
+{
+    threadPool = nullptr;
+    workerJobs.clear();
+
+    for (size_t ii = 0; ii < numHelpers; ii++)
+        workerJobs.push_back(pool->addJob(account, [this]() { runHelper(); }));
+}
+
+size_t ParallelLoop::getNumHelpers() const
+{
+    return threadPool != nullptr ? threadPool->size() : workerJobs.size();
+}
+
+void ParallelLoop::run(size_t numIterations, const Body & body)
+{
+    this->body = &body;
+    this->numIterations = numIterations;
+    nextIteration = 0;
+
+    // Only use as many helpers as there are iterations to share with them.
+    size_t numHelpers = numIterations > 1 ? std::min(getNumHelpers(), numIterations - 1) : 0;
+
+    if (numHelpers > 0)
+    {
+        pendingHelpers = numHelpers;
+
+        if (threadPool != nullptr)
+        {
+            // unlock() wakes every worker, whereas addJobAndUnlock(...) only
+            // wakes one of them.
+            threadPool->lock();
+            for (size_t ii = 0; ii < numHelpers; ii++)
+                threadPool->addJob(helperJob);
+            threadPool->unlock();
+        }
+        else
+        {
+            for (size_t ii = 0; ii < numHelpers; ii++)
+                workerJobs[ii]->submit();
+        }
+    }
+
+    // The calling thread runs iterations while the helpers run theirs.
+    runIterations(false);
+
+    // Every iteration has been claimed, so the helpers that have not started
+    // would have nothing left to do.  The threads of a thread pool are
+    // dedicated to this loop and start promptly, whereas the jobs of a
+    // worker pool may be queued behind other controllers' jobs.
+    if (numHelpers > 0 && threadPool == nullptr)
+    {
+        for (size_t ii = 0; ii < numHelpers; ii++)
+        {
+            if (workerJobs[ii]->cancel())
+                pendingHelpers--;
+        }
+    }
+
+    while (pendingHelpers > 0)
+        std::this_thread::yield();
+
+    this->body = nullptr;
+}
+
+void ParallelLoop::runIterations(bool helper)
+{
+    for (size_t ii = nextIteration++; ii < numIterations; ii = nextIteration++)
+        (*body)(ii, helper);
+}
+
+void ParallelLoop::runHelper()
+{
+    runIterations(true);
+    pendingHelpers--;
+}
+
+} // namespace controlit
@@ -241,6 +241,7 @@ bool SizeTParameter::set(size_t const& sizeT)
         return false;
     } 
   
+    std::lock_guard<std::mutex> lock(setMutex_);
     *sizeT_ = sizeT;
     notifyListeners(*this);
     return true;
@@ -287,6 +288,7 @@ bool UnsignedIntegerParameter::set(unsigned int const & unsignedInteger)
         return false;
     } 
     
+    std::lock_guard<std::mutex> lock(setMutex_);
     *unsignedInteger_ = unsignedInteger;
     notifyListeners(*this);
     return true;
@@ -328,6 +330,7 @@ bool IntegerParameter::set(int const& integer)
         return false;
     } 
 
+    std::lock_guard<std::mutex> lock(setMutex_);
     *integer_ = integer;
     notifyListeners(*this);
     return true;
@@ -371,6 +374,7 @@ bool StringParameter::set(std::string const& value)
         return false;
     } 
   
+    std::lock_guard<std::mutex> lock(setMutex_);
     *string_ = value;
     notifyListeners(*this);
     return true;
@@ -412,6 +416,7 @@ bool RealParameter::set(double const & real)
         return false;
     } 
 
+    std::lock_guard<std::mutex> lock(setMutex_);
     *real_ = real;
     notifyListeners(*this);
     return true;
@@ -452,6 +457,7 @@ bool VectorParameter::set(Vector const& vector)
         return false;
     } 
 
+    std::lock_guard<std::mutex> lock(setMutex_);
     *vector_ = vector;
     notifyListeners(*this);
     return true;
@@ -514,6 +520,7 @@ bool MatrixParameter::set(Matrix const& matrix)
         return false;
     } 
   
+    std::lock_guard<std::mutex> lock(setMutex_);
     *matrix_ = matrix;
     notifyListeners(*this);
     return true;
@@ -578,6 +585,7 @@ bool ListParameter::set(std::vector<std::string> const& list)
         return false;
     } 
 
+    std::lock_guard<std::mutex> lock(setMutex_);
     *list_ = list;
     notifyListeners(*this);
     return true;
@@ -637,6 +645,7 @@ bool JointStateParameter::set(JointState const& jointState)
         return false;
     } 
   
+    std::lock_guard<std::mutex> lock(setMutex_);
     *jointState_ = jointState;
     notifyListeners(*this);
     return true;
@@ -744,6 +753,7 @@ bool BindingConfigParameter::set(BindingConfig const& binding)
         return false;
     } 
 
+    std::lock_guard<std::mutex> lock(setMutex_);
     *binding_ = binding;
     notifyListeners(*this);
     return true;
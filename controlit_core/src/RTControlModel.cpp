@@ -21,6 +21,7 @@
 #include <controlit/RTControlModel.hpp>
 
 #include <controlit/Constraint.hpp>
+#include <controlit/RealTimeConfig.hpp>
 #include <controlit/logging/RealTimeLogging.hpp>
 
 using std::chrono::high_resolution_clock;
@@ -40,6 +41,14 @@ namespace controlit {
 
 #define QUEUE_SIZE 1
 
+// The statistics published by updatePolicyPublisher are
+// [skip ratio, partial ratio, full ratio, average full update duration,
+//  average partial update duration, estimated fraction of CPU time saved]
+#define NUM_UPDATE_POLICY_STATISTICS 6
+
+// The number of model update decisions per published window
+#define UPDATE_POLICY_WINDOW 100
+
 RTControlModel::RTControlModel() :
     state(State::IDLE),
     isRunning(false),
@@ -48,8 +57,11 @@ RTControlModel::RTControlModel() :
     activeModel(nullptr),
     inactiveModel(nullptr),
     parameterBindingManager(nullptr),
+    workerJob(nullptr),
+    numUpdateHelpers(0),
     modelUpdateLatencyPublisher("diagnostics/modelUpdateLatency", QUEUE_SIZE),
-    gravityPublisher("diagnostics/gravityVector", QUEUE_SIZE)
+    gravityPublisher("diagnostics/gravityVector", QUEUE_SIZE),
+    updatePolicyPublisher("diagnostics/modelUpdatePolicy", QUEUE_SIZE)
 {
     PRINT_DEBUG_STATEMENT("Method Called!")
 }
@@ -103,6 +115,27 @@ bool RTControlModel::init(ros::NodeHandle & nh, RobotState * latestRobotState,
     activeModel->setName(std::string("ControlModel1"));
     inactiveModel->setName(std::string("ControlModel2"));
 
+    // Run the independent steps of each model update concurrently if
+    // requested.  Only the inactive model is updated at any time, so both
+    // models share the threads.
+    numUpdateHelpers = params->getNumModelUpdateThreads();
+
+    if (numUpdateHelpers > 0)
+    {
+        CONTROLIT_INFO << "Using " << params->getNumModelUpdateThreads() << " model update threads.";
+        updateThreadPool.reset(new controlit::addons::cpp::ThreadPool(params->getNumModelUpdateThreads()));
+
+        if (!params->getModelUpdateThreadCPUs().empty()
+            && !updateThreadPool->setAffinity(params->getModelUpdateThreadCPUs()))
+        {
+            CONTROLIT_WARN << "Failed to pin the model update threads, updating the model serially.";
+            updateThreadPool.reset();
+        }
+
+        activeModel->setUpdateThreadPool(updateThreadPool.get());
+        inactiveModel->setUpdateThreadPool(updateThreadPool.get());
+    }
+
     try
     {
         parameterBindingManager->bindParameters(nh, activeModel->constraints());
@@ -139,6 +172,19 @@ bool RTControlModel::init(ros::NodeHandle & nh, RobotState * latestRobotState,
     modelUpdateLatencyPublisher.msg_.data = 0;
     modelUpdateLatencyPublisher.unlockAndPublish();
 
+    // Decide how much of each model update is needed
+    updatePolicy.init(activeModel->getNumDOFs(),
+        params->getModelUpdateSkipPositionThreshold(),
+        params->getModelUpdateSkipVelocityThreshold(),
+        params->getModelUpdatePartialPositionThreshold());
+
+    while (!updatePolicyPublisher.trylock()) usleep(200);
+    updatePolicyPublisher.msg_.layout.dim.resize(1);
+    updatePolicyPublisher.msg_.layout.dim[0].stride = NUM_UPDATE_POLICY_STATISTICS;
+    updatePolicyPublisher.msg_.layout.dim[0].size = NUM_UPDATE_POLICY_STATISTICS;
+    updatePolicyPublisher.msg_.data.resize(NUM_UPDATE_POLICY_STATISTICS);
+    updatePolicyPublisher.unlockAndPublish();
+
     // Create the service handlers
     constraintJacobianService = nh.advertiseService("diagnostics/getConstraintJacobianMatrices",
         &RTControlModel::getConstraintJacobiansHandler, this);
@@ -151,6 +197,7 @@ void RTControlModel::setStale()
 {
     activeModel->setStale();
     inactiveModel->setStale();
+    updatePolicy.reset();
 }
 
 void RTControlModel::setGravityVector(const Vector & gravityVector)
@@ -171,6 +218,12 @@ void RTControlModel::setGravMask(const std::vector<std::string> & mask)
   inactiveModel->setGravMask(mask);
 }
 
+void RTControlModel::setInternalForceOperatorsEnabled(bool enabled)
+{
+    activeModel->virtualLinkageModel().setInternalForceOperatorsEnabled(enabled);
+    inactiveModel->virtualLinkageModel().setInternalForceOperatorsEnabled(enabled);
+}
+
 void RTControlModel::addListenerToConstraintSet(boost::function<void(std::string const&)> listener)
 {
     activeModel->constraints().addListener(listener);
@@ -186,7 +239,15 @@ void RTControlModel::startThread()
     assert(initialized);
 
     keepRunning = true;
-    thread = std::thread(&RTControlModel::updateLoop, this);
+
+    if (workerJob != nullptr)
+    {
+        // The model updates are run by the worker pool
+        state = State::IDLE;
+        isRunning = true;
+    }
+    else
+        thread = std::thread(&RTControlModel::updateLoop, this);
 
     // // Set the affinity of the main thread to cpu 1
     // cpu_set_t cpuset;
@@ -250,6 +311,14 @@ void RTControlModel::stopThread()
 
     keepRunning = false;
 
+    if (workerJob != nullptr)
+    {
+        // Holding the mutex ensures the worker pool is not updating the model
+        isRunning = false;
+        mutex.unlock();
+        return;
+    }
+
     PRINT_DEBUG_STATEMENT("Calling cv.notify_one()")
 
     cv.notify_one();  // So the model update thread can exit
@@ -364,7 +433,8 @@ void RTControlModel::unlockAndUpdate()
     ros::Time startNotifyOne = ros::Time::now();
     #endif
 
-    cv.notify_one();
+    if (workerJob == nullptr)
+        cv.notify_one();
 
     PRINT_DEBUG_STATEMENT_RT("Releasing lock.")
 
@@ -374,6 +444,9 @@ void RTControlModel::unlockAndUpdate()
 
     mutex.unlock();
 
+    if (workerJob != nullptr)
+        workerJob->submit();
+
     #ifdef TIME_UNLOCK_AND_UPDATE
     ros::Time endMutexUnlock = ros::Time::now();
     #endif
@@ -461,6 +534,8 @@ void RTControlModel::updateLoop()
     PRINT_DEBUG_STATEMENT("Method Called\n"
         " - std::this_thread::get_id = " << std::this_thread::get_id())
 
+    RealTimeConfig::placeCurrentThread("model_update");
+
     isRunning = true;
     state = State::IDLE;
 
@@ -511,43 +586,122 @@ void RTControlModel::updateLoop()
 
         // We have everything we need to proceed with an update
         if (keepRunning)
-        {
-            PRINT_DEBUG_STATEMENT("Updating the inactive model!")
+            updateOnce();
+    }
 
-            // controlModelUpdateStat.startTimer();
+    PRINT_DEBUG_STATEMENT("Stopping RTControlModel child thread.  "
+        "Number of updates: " << numUpdates);
 
-            // inactiveModel->checkForSysIdUpdates();
+    // numUpdates = 0;
+    isRunning = false;
+}
 
-            modelUpdateStartTime = high_resolution_clock::now();
+void RTControlModel::updateOnce()
+{
+    PRINT_DEBUG_STATEMENT("Updating the inactive model!")
 
-            // Do the big model update!
-            inactiveModel->update();
+    // controlModelUpdateStat.startTimer();
 
-            modelUpdateEndTime = high_resolution_clock::now();
+    // inactiveModel->checkForSysIdUpdates();
 
-            // controlModelUpdateStat.stopTimer();
+    modelUpdateStartTime = high_resolution_clock::now();
 
+    // Do the big model update, unless the joint state barely changed
+    bool updated = updateModel(inactiveModel);
 
-            PRINT_DEBUG_STATEMENT("Done updating the inactive model. Setting the state to be UPDATED_MODEL_READY!")
+    modelUpdateEndTime = high_resolution_clock::now();
 
-            state = State::UPDATED_MODEL_READY;
+    // controlModelUpdateStat.stopTimer();
 
-            if (modelUpdateLatencyPublisher.trylock())
-            {
-                std::chrono::nanoseconds timeSpan
-                    = duration_cast<std::chrono::nanoseconds>(modelUpdateEndTime - modelUpdateStartTime);
-                double period = timeSpan.count() / 1e9;
-                modelUpdateLatencyPublisher.msg_.data = period;
-                modelUpdateLatencyPublisher.unlockAndPublish();
-            }
-        }
+    if (!updated)
+    {
+        PRINT_DEBUG_STATEMENT("Skipped updating the inactive model. Setting the state to be IDLE!")
+
+        state = State::IDLE;
+        return;
     }
 
-    PRINT_DEBUG_STATEMENT("Stopping RTControlModel child thread.  "
-        "Number of updates: " << numUpdates);
+    PRINT_DEBUG_STATEMENT("Done updating the inactive model. Setting the state to be UPDATED_MODEL_READY!")
 
-    // numUpdates = 0;
-    isRunning = false;
+    state = State::UPDATED_MODEL_READY;
+
+    if (modelUpdateLatencyPublisher.trylock())
+    {
+        std::chrono::nanoseconds timeSpan
+            = duration_cast<std::chrono::nanoseconds>(modelUpdateEndTime - modelUpdateStartTime);
+        double period = timeSpan.count() / 1e9;
+        modelUpdateLatencyPublisher.msg_.data = period;
+        modelUpdateLatencyPublisher.unlockAndPublish();
+    }
+}
+
+void RTControlModel::runPooledUpdate()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (keepRunning && state == State::UPDATING_MODEL)
+        updateOnce();
+}
+
+void RTControlModel::setWorkerPool(WorkerPool * pool, WorkerPool::Account * account)
+{
+    assert(!isRunning);
+    workerJob = pool->addJob(account, std::bind(&RTControlModel::runPooledUpdate, this));
+
+    // The pool's workers also help update the model, so that the
+    // controllers in the process do not each need threads of their own.
+    if (numUpdateHelpers > 0)
+    {
+        updateThreadPool.reset();
+        activeModel->setUpdateWorkerPool(pool, account, numUpdateHelpers);
+        inactiveModel->setUpdateWorkerPool(pool, account, numUpdateHelpers);
+    }
+}
+
+bool RTControlModel::updateModel(ControlModel * model)
+{
+    if (!updatePolicy.isEnabled())
+    {
+        model->update();
+        return true;
+    }
+
+    high_resolution_clock::time_point startTime = high_resolution_clock::now();
+
+    // A model holding predicted values must be fully updated, since a partial
+    // update would keep the predicted projection matrices.
+    ModelUpdatePolicy::Decision decision = updatePolicy.decide(
+        model->getQ(), model->getQd(), model->getFullUpdateQ(),
+        !model->isStale() && !model->hasPredictedValues(),
+        model->constraints().enableSetChanged());
+
+    switch (decision)
+    {
+        case ModelUpdatePolicy::Decision::FULL: model->update(); break;
+        case ModelUpdatePolicy::Decision::PARTIAL: model->updateGravity(); break;
+        case ModelUpdatePolicy::Decision::SKIP: break;
+    }
+
+    std::chrono::nanoseconds timeSpan = duration_cast<std::chrono::nanoseconds>(
+        high_resolution_clock::now() - startTime);
+    updatePolicy.recordUpdate(decision, timeSpan.count() / 1e9);
+
+    // Publish the statistics of each window of decisions
+    if (updatePolicy.getNumDecisions() >= UPDATE_POLICY_WINDOW && updatePolicyPublisher.trylock())
+    {
+        std::vector<double> & data = updatePolicyPublisher.msg_.data;
+        data[0] = updatePolicy.getRatio(ModelUpdatePolicy::Decision::SKIP);
+        data[1] = updatePolicy.getRatio(ModelUpdatePolicy::Decision::PARTIAL);
+        data[2] = updatePolicy.getRatio(ModelUpdatePolicy::Decision::FULL);
+        data[3] = updatePolicy.getAverageFullDuration();
+        data[4] = updatePolicy.getAveragePartialDuration();
+        data[5] = updatePolicy.getSavedFraction();
+        updatePolicyPublisher.unlockAndPublish();
+
+        updatePolicy.resetStatistics();
+    }
+
+    return decision != ModelUpdatePolicy::Decision::SKIP;
 }
 
 void RTControlModel::swap()
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/RealTimeConfig.hpp>
+
+#include <controlit/logging/RealTimeLogging.hpp>
+#include <alloca.h>
+#include <cerrno>
+#include <cstring>
+#include <malloc.h>
+#include <mutex>
+#include <sched.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace controlit {
+
+// Uncomment one of the following lines to enable/disable detailed debug statements.
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+/*!
+ * The maximum length of a thread name, excluding the terminating null.
+ */
+#define MAX_THREAD_NAME_LENGTH 15
+
+const std::vector<std::string> RealTimeConfig::THREAD_NAMES = {
+    "servo", "model_update", "task_update", "publisher", "udp_rx", "telemetry"};
+
+namespace {
+
+/*!
+ * The configuration shared by all threads in the process.
+ */
+struct Configuration
+{
+    Configuration() : lockMemory(false), prefaultStackSize(0), isMemoryLocked(false) {}
+
+    std::mutex mutex;
+    std::map<std::string, ThreadPlacement> placements;
+    bool lockMemory;
+    size_t prefaultStackSize;
+    bool isMemoryLocked;
+    std::function<void(const std::string &)> failureHandler;
+    std::vector<std::string> failures;
+};
+
+Configuration & getConfiguration()
+{
+    static Configuration configuration;
+    return configuration;
+}
+
+/*!
+ * Touches each page of the given amount of the calling thread's stack so
+ * that the pages are mapped before the thread's loop starts.
+ */
+void prefaultStack(size_t size)
+{
+    if (size == 0) return;
+
+    volatile char * stack = static_cast<volatile char *>(alloca(size));
+    long pageSize = sysconf(_SC_PAGESIZE);
+
+    for (size_t ii = 0; ii < size; ii += pageSize)
+        stack[ii] = 0;
+}
+
+/*!
+ * Applies a placement to a thread.
+ *
+ * \param[in] thread The thread.
+ * \param[in] placement The placement.
+ * \param[out] error Set to a description of the error, if any.
+ * \return Whether the placement was applied.
+ */
+bool applyPlacement(pthread_t thread, const ThreadPlacement & placement, std::string & error)
+{
+    bool result = true;
+    std::stringstream ss;
+
+    int policy;
+    if (!RealTimeConfig::parsePolicy(placement.policy, policy))
+    {
+        ss << "unknown scheduling policy \"" << placement.policy << "\"";
+        error = ss.str();
+        return false;
+    }
+
+    struct sched_param param;
+    param.sched_priority = placement.priority;
+
+    int err = pthread_setschedparam(thread, policy, &param);
+    if (err != 0)
+    {
+        ss << "could not set scheduling policy " << placement.policy << " with priority "
+           << placement.priority << " (" << std::strerror(err) << ")";
+        result = false;
+    }
+
+    if (!placement.cpus.empty())
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (auto cpu : placement.cpus)
+            CPU_SET(cpu, &cpuSet);
+
+        err = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuSet);
+        if (err != 0)
+        {
+            ss << (result ? "" : "; ") << "could not set the CPU affinity (" << std::strerror(err) << ")";
+            result = false;
+        }
+    }
+
+    error = ss.str();
+    return result;
+}
+
+} // namespace
+
+ThreadPlacement::ThreadPlacement() :
+    policy("other"),
+    priority(0)
+{
+}
+
+void RealTimeConfig::configure(const std::map<std::string, ThreadPlacement> & placements,
+    bool lockMemory, size_t prefaultStackSize,
+    std::function<void(const std::string &)> failureHandler)
+{
+    Configuration & config = getConfiguration();
+    std::lock_guard<std::mutex> lock(config.mutex);
+
+    config.placements = placements;
+    config.lockMemory = lockMemory;
+    config.prefaultStackSize = prefaultStackSize;
+    config.failureHandler = failureHandler;
+}
+
+bool RealTimeConfig::lockMemory()
+{
+    Configuration & config = getConfiguration();
+    std::lock_guard<std::mutex> lock(config.mutex);
+
+    if (!config.lockMemory || config.isMemoryLocked) return config.isMemoryLocked;
+
+    // Keep freed memory in the process and serve all allocations from the
+    // heap so that memory freed and allocated again is not faulted in again.
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+
+    // MCL_CURRENT faults in every page that is already mapped, which
+    // includes all of the buffers the controller allocated during
+    // initialization.
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        std::string error = std::string("Unable to lock memory: ") + std::strerror(errno)
+            + ".  Ensure the process has the CAP_IPC_LOCK capability or a sufficient memlock limit.";
+        CONTROLIT_WARN << error;
+        config.failures.push_back(error);
+        if (config.failureHandler) config.failureHandler(error);
+        return false;
+    }
+
+    prefaultStack(config.prefaultStackSize);
+
+    config.isMemoryLocked = true;
+    return true;
+}
+
+bool RealTimeConfig::placeCurrentThread(const std::string & name)
+{
+    size_t prefaultStackSize = 0;
+    {
+        Configuration & config = getConfiguration();
+        std::lock_guard<std::mutex> lock(config.mutex);
+        if (config.lockMemory) prefaultStackSize = config.prefaultStackSize;
+    }
+
+    prefaultStack(prefaultStackSize);
+
+    return placeThread(name, pthread_self());
+}
+
+bool RealTimeConfig::placeThread(const std::string & name, pthread_t thread)
+{
+    // Name the thread so it can be identified by tools like top and ps
+    pthread_setname_np(thread, ("cit_" + name).substr(0, MAX_THREAD_NAME_LENGTH).c_str());
+
+    Configuration & config = getConfiguration();
+    std::lock_guard<std::mutex> lock(config.mutex);
+
+    auto placement = config.placements.find(name);
+    if (placement == config.placements.end()) return true;
+
+    std::string error;
+    if (applyPlacement(thread, placement->second, error))
+    {
+        PRINT_DEBUG_STATEMENT("Placed thread " << name << " with policy " << placement->second.policy
+            << " and priority " << placement->second.priority);
+        return true;
+    }
+
+    std::string failure = "Thread \"" + name + "\" did not get its requested placement: " + error;
+    CONTROLIT_WARN << failure;
+    config.failures.push_back(failure);
+    if (config.failureHandler) config.failureHandler(failure);
+    return false;
+}
+
+std::vector<std::string> RealTimeConfig::getFailures()
+{
+    Configuration & config = getConfiguration();
+    std::lock_guard<std::mutex> lock(config.mutex);
+    return config.failures;
+}
+
+bool RealTimeConfig::parsePolicy(const std::string & name, int & policy)
+{
+    if (name == "other")
+        policy = SCHED_OTHER;
+    else if (name == "fifo")
+        policy = SCHED_FIFO;
+    else if (name == "rr")
+        policy = SCHED_RR;
+    else
+        return false;
+
+    return true;
+}
+
+} // namespace controlit
@@ -25,6 +25,8 @@
 #include <controlit/RTControlModel.hpp>
 #include <controlit/TimerROS.hpp>
 #include <controlit/TimerChrono.hpp>
+#include <controlit/TimerSimulated.hpp>
+#include <controlit/ControllerClock.hpp>
 
 namespace controlit {
 
@@ -183,7 +185,9 @@ bool RobotInterface::write(const Command & command)
 std::shared_ptr<Timer> RobotInterface::getTimer()
 {
     std::shared_ptr<Timer> timerPtr;
-    if (useROSTimer)
+    if (ControllerClock::isSimulated())
+        timerPtr.reset(new TimerSimulated());
+    else if (useROSTimer)
         timerPtr.reset(new TimerROS());
     else
         timerPtr.reset(new TimerChrono());
@@ -19,6 +19,7 @@
  */
 
 #include <controlit/RobotState.hpp>
+#include <controlit/ControllerClock.hpp>
 #include <controlit/logging/RealTimeLogging.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
 // #include <drc/eigen/addons.hpp>
@@ -74,7 +75,7 @@ int RobotState::getJointIndex(const std::string name) const
 
 void RobotState::resetTimestamp()
 {
-    timestamp = high_resolution_clock::now();
+    timestamp = ControllerClock::now();
 }
 
 const high_resolution_clock::time_point & RobotState::getTimestamp() const
@@ -155,7 +156,7 @@ bool RobotState::setRobotBaseState(Vector3d const& x, Quaternion const& q,
     // Virual link is a x-y-z translation, then a 3-2-1 orientation as specified in
     // its construction. See construct_model() in rbdl_robot_urdfreader.cpp. Specifically
     // how 'floating' joints are handled.
-    Vector eulerAngles = R_world_vtip.eulerAngles(2,1,0);
+    Vector3d eulerAngles = R_world_vtip.eulerAngles(2,1,0);
 
     // Have everything we need to set the position/orientation from measured data
     virtualJointPosition.topRows(3) = x;
@@ -214,6 +215,20 @@ bool RobotState::setRobotBaseState(Vector3d const& x, Quaternion const& q,
     return true;
 }
 
+bool RobotState::setVirtualJointState(Eigen::Ref<const Vector> position, Eigen::Ref<const Vector> velocity)
+{
+    if (position.size() != NUM_VIRTUAL_DOFS || velocity.size() != NUM_VIRTUAL_DOFS)
+    {
+        CONTROLIT_ERROR << "Expected " << NUM_VIRTUAL_DOFS << " virtual joint positions and velocities, got "
+          << position.size() << " and " << velocity.size();
+        return false;
+    }
+
+    virtualJointPosition = position;
+    virtualJointVelocity = velocity;
+    return true;
+}
+
 const std::vector<std::string> & RobotState::getJointNames() const
 {
     return jointNames;
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/ScratchArena.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace controlit {
+
+const size_t ScratchArena::DEFAULT_CAPACITY;
+const size_t ScratchArena::ALIGNMENT;
+
+namespace {
+
+/*!
+ * \return The size rounded up to a multiple of the alignment.
+ */
+size_t alignSize(size_t size)
+{
+    return (size + ScratchArena::ALIGNMENT - 1) & ~(ScratchArena::ALIGNMENT - 1);
+}
+
+} // namespace
+
+ScratchArena::ScratchArena(size_t capacity) :
+    base(nullptr),
+    capacity(alignSize(capacity)),
+    used(0),
+    requested(0),
+    highWaterMark(0),
+    numOverflows(0)
+{
+    base = allocateBlock(this->capacity, buffer);
+}
+
+ScratchArena & ScratchArena::getThreadArena()
+{
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+void ScratchArena::reset()
+{
+    if (requested > capacity)
+    {
+        // Grow by at least half so that a slowly growing working set does
+        // not cause an allocation every cycle.
+        capacity = alignSize(std::max(requested, capacity + capacity / 2));
+        base = allocateBlock(capacity, buffer);
+    }
+
+    overflowBlocks.clear();
+    used = 0;
+    requested = 0;
+}
+
+double * ScratchArena::allocate(size_t size)
+{
+    size_t numBytes = alignSize(size * sizeof(double));
+
+    requested += numBytes;
+    if (requested > highWaterMark)
+        highWaterMark = requested;
+
+    if (used + numBytes <= capacity)
+    {
+        char * memory = base + used;
+        used += numBytes;
+        return reinterpret_cast<double *>(memory);
+    }
+
+    numOverflows++;
+    overflowBlocks.push_back(std::unique_ptr<char[]>());
+    return reinterpret_cast<double *>(allocateBlock(numBytes, overflowBlocks.back()));
+}
+
+char * ScratchArena::allocateBlock(size_t size, std::unique_ptr<char[]> & block)
+{
+    block.reset(new char[size + ALIGNMENT]);
+
+    uintptr_t address = reinterpret_cast<uintptr_t>(block.get());
+    return block.get() + (alignSize(address) - address);
+}
+
+} // namespace controlit
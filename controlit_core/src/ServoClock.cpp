@@ -20,6 +20,7 @@
 
 #include <controlit/ServoClock.hpp>
 
+#include <controlit/RealTimeConfig.hpp>
 #include <controlit/logging/RealTimeLogging.hpp>
 
 // Uncomment one of the following lines to enable/disable detailed debug statements.
@@ -32,6 +33,7 @@
 namespace controlit {
 
 ServoClock::ServoClock() :
+    servoableClass(nullptr),
     callServoInit(true),
     continueRunning(false),
     isInitialized(false),
@@ -111,6 +113,7 @@ bool ServoClock::stop()
 
 void ServoClock::updateLoop()
 {
+    RealTimeConfig::placeCurrentThread("servo");
     updateLoopImpl();
 }
 
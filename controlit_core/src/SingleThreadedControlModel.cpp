@@ -85,7 +85,7 @@ void SingleThreadedControlModel::unlockAndUpdate()
     // ros::Time startTime = ros::Time::now();
 
     // Do the actual update!
-    activeModel->update();
+    updateModel(activeModel);
 
     // double elapsedTime = (ros::Time::now() - startTime).toSec();
 
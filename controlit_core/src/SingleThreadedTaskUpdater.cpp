@@ -45,13 +45,22 @@ SingleThreadedTaskUpdater::~SingleThreadedTaskUpdater()
 void SingleThreadedTaskUpdater::updateTasks(ControlModel * model)
 {
     // In the single threaded version, go through and update the inactive state of
-    // each task then swap the active and inactive states of the task.
+    // each task that is due then swap the active and inactive states of the task.
 
     PRINT_DEBUG_STATEMENT_RT("Method called!")
 
-    for(std::vector<Task *>::iterator it = taskSet.begin(); it != taskSet.end(); ++it)
+    double now = getCurrentTime();
+
+    sortUpdateOrder();
+
+    for (size_t ii = 0; ii < updateOrder.size(); ii++)
     {
-        Task * currTask = (*it);
+        size_t index = updateOrder[ii];
+
+        // Skip tasks whose update period has not yet elapsed
+        if (!isUpdateDue(index, now)) continue;
+
+        Task * currTask = taskSet[index];
 
         PRINT_DEBUG_STATEMENT("Updating the inactive state of task \""
             << currTask->getInstanceName() << "\", which is of type "
@@ -63,6 +72,8 @@ void SingleThreadedTaskUpdater::updateTasks(ControlModel * model)
             << currTask->getInstanceName() << "\"")
 
         currTask->checkUpdatedState();
+
+        recordUpdate(index, now);
     }
 
     PRINT_DEBUG_STATEMENT("Done updating the tasks")
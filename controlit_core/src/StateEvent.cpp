@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/StateEvent.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <controlit/logging/RealTimeLogging.hpp>
+
+namespace controlit {
+
+static int64_t monotonicNS()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+StateEvent::StateEvent() :
+    fd(eventfd(0, EFD_NONBLOCK)),
+    notifyTimeNS(0)
+{
+    if (fd == -1)
+        CONTROLIT_ERROR << "Unable to create eventfd: " << std::strerror(errno);
+}
+
+StateEvent::~StateEvent()
+{
+    if (fd != -1) close(fd);
+}
+
+void StateEvent::notify()
+{
+    notifyTimeNS.store(monotonicNS(), std::memory_order_release);
+
+    // This can only fail if the counter overflows, which requires 2^64 - 2
+    // unread notifications, so the result is ignored.
+    uint64_t one = 1;
+    if (fd != -1)
+    {
+        ssize_t written = ::write(fd, &one, sizeof(one));
+        (void) written;
+    }
+}
+
+bool StateEvent::wait(double timeout)
+{
+    if (fd == -1) return false;
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    // poll has a resolution of one millisecond, so use ppoll
+    struct timespec ts;
+    double seconds = std::max(0.0, timeout);
+    ts.tv_sec = static_cast<time_t>(seconds);
+    ts.tv_nsec = static_cast<long>((seconds - ts.tv_sec) * 1e9);
+
+    int result = ppoll(&pfd, 1, &ts, nullptr);
+
+    if (result <= 0)
+        return false;  // timed out or interrupted
+
+    // Reset the counter
+    uint64_t count;
+    return ::read(fd, &count, sizeof(count)) == sizeof(count);
+}
+
+double StateEvent::getNotifyTime() const
+{
+    return notifyTimeNS.load(std::memory_order_acquire) * 1e-9;
+}
+
+double StateEvent::now()
+{
+    return monotonicNS() * 1e-9;
+}
+
+} // namespace controlit
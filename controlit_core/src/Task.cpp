@@ -39,10 +39,13 @@ Task::Task() :
     PlanElement("Task", "__UNDEFINED_TASK_NAME__"),
     commandType_(controlit::ACCELERATION),
     tare(0),
+    updatePeriod(0),
+    updatePriority(0),
     stateUpdateStatus(StateUpdateStatus::IDLE),
     initialized(false),
     inactiveState(nullptr),
-    activeState(nullptr)
+    activeState(nullptr),
+    latestStateVersion(0)
 {
     setupParameters();
 }
@@ -52,10 +55,13 @@ Task::Task(std::string const& typeName, CommandType commandType,
     PlanElement("Task", typeName),
     commandType_(commandType),
     tare(0),
+    updatePeriod(0),
+    updatePriority(0),
     stateUpdateStatus(StateUpdateStatus::IDLE),
     initialized(false),
     inactiveState(inactiveState),
-    activeState(activeState)
+    activeState(activeState),
+    latestStateVersion(0)
 {
     setupParameters();
 }
@@ -82,6 +88,8 @@ Task::~Task()
 void Task::setupParameters()
 {
     declareParameter("tare", &tare);  
+    declareParameter("updatePeriod", &updatePeriod);
+    declareParameter("updatePriority", &updatePriority);
 }
 
 bool Task::init(ControlModel & model)
@@ -94,6 +102,10 @@ bool Task::reinit(ControlModel & model)
 {
     updateStateImpl(&model, inactiveState);
     updateStateImpl(&model, activeState);
+
+    // Both states were just recomputed, so treat them as new.
+    inactiveState->setVersion(++latestStateVersion);
+    activeState->setVersion(++latestStateVersion);
   
     initialized = true;
   
@@ -125,6 +137,22 @@ bool Task::updateState(ControlModel * model)
     
         // In the line below, updateStateImpl() is implemented by subclasses
         bool result = updateStateImpl(model, inactiveState);
+
+        // Only assign a new version if the Jacobian changed.  The active state
+        // is only read by the servo thread so it is safe to compare against it.
+        const Matrix & activeJacobian = activeState->getJacobian();
+        const Matrix & updatedJacobian = inactiveState->getJacobian();
+
+        if (updatedJacobian.rows() == activeJacobian.rows()
+            && updatedJacobian.cols() == activeJacobian.cols()
+            && updatedJacobian == activeJacobian)
+        {
+            inactiveState->setVersion(activeState->getVersion());
+        }
+        else
+        {
+            inactiveState->setVersion(++latestStateVersion);
+        }
     
         PRINT_DEBUG_STATEMENT("Changing stateUpdateStatus of task to be UPDATED_STATE_READY")
     
@@ -206,6 +234,43 @@ bool Task::getJacobian(Matrix & taskJacobian)
     return true;
 }
 
+bool Task::getJacobian(Matrix & Jt, int startRow)
+{
+    assert(activeState != nullptr);
+
+    const Matrix & taskJacobian = activeState->getJacobian();
+
+    if (startRow + taskJacobian.rows() > Jt.rows() || taskJacobian.cols() != Jt.cols())
+    {
+        CONTROLIT_PR_ERROR_RT << "Unable to copy task Jacobian into rows "
+            << startRow << " to " << startRow + taskJacobian.rows() - 1 << " of a "
+            << Jt.rows() << "x" << Jt.cols() << " matrix!";
+        return false;
+    }
+
+    Jt.middleRows(startRow, taskJacobian.rows()) = taskJacobian;
+
+    return true;
+}
+
+int Task::getJacobianRows() const
+{
+    assert(activeState != nullptr);
+    return activeState->getJacobian().rows();
+}
+
+const Matrix & Task::getJacobianView() const
+{
+    assert(activeState != nullptr);
+    return static_cast<const TaskState *>(activeState)->getJacobian();
+}
+
+unsigned long long Task::getJacobianVersion() const
+{
+    assert(activeState != nullptr);
+    return activeState->getVersion();
+}
+
 std::string Task::stateUpdateStatusToString(StateUpdateStatus state)
 {
     switch(state)
@@ -23,7 +23,8 @@
 namespace controlit {
 
 TaskState::TaskState() :
-  taskJacobianSet(false)
+  taskJacobianSet(false),
+  version(0)
 {
 }
 
@@ -36,6 +37,21 @@ Matrix & TaskState::getJacobian()
   return taskJacobian;
 }
 
+const Matrix & TaskState::getJacobian() const
+{
+  return taskJacobian;
+}
+
+void TaskState::setVersion(unsigned long long version)
+{
+  this->version = version;
+}
+
+unsigned long long TaskState::getVersion() const
+{
+  return version;
+}
+
 void TaskState::setTaskJacobianFlag()
 {
 	taskJacobianSet = true;
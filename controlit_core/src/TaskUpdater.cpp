@@ -20,6 +20,12 @@
 
 #include <controlit/TaskUpdater.hpp>
 
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+
+#include <controlit/ControllerClock.hpp>
+#include <controlit/RealTimeConfig.hpp>
 #include <controlit/logging/RealTimeLogging.hpp>
 
 namespace controlit {
@@ -35,13 +41,17 @@ namespace controlit {
 #define PRINT_WARNING_RT(ss) CONTROLIT_WARN_RT << ss;
 
 #define MAX_NUM_FAILURES 3 // The number of consecutive failures at obtaining the lock before a warning message is printed.
+#define UPDATE_RATE_FILTER_GAIN 0.1 // The weight of the latest sample in the filtered update rate of each task.
 
 TaskUpdater::TaskUpdater() :
     state(State::IDLE),
+    minUpdatePeriod(0),
+    minUpdatePeriodMaxPriority(0),
     keepRunning(false),
     isRunning(false),
     numUpdates(0),
-    failureCount(0)
+    failureCount(0),
+    workerJob(nullptr)
 {
 }
 
@@ -59,6 +69,10 @@ void TaskUpdater::addTask(Task * task)
 
     taskSet.push_back(task);
 
+    schedule.push_back(TaskSchedule());
+
+    updateOrder.push_back(updateOrder.size());
+
     PRINT_DEBUG_STATEMENT("Done.")
 }
 
@@ -69,7 +83,15 @@ void TaskUpdater::startThread()
     // Should we add a check on whether the thread is already running?
 
     keepRunning = true;
-    thread = std::thread(&TaskUpdater::updateLoop, this);
+
+    if (workerJob != nullptr)
+    {
+        // The task states are updated by the worker pool
+        state = State::IDLE;
+        isRunning = true;
+    }
+    else
+        thread = std::thread(&TaskUpdater::updateLoop, this);
 
     PRINT_DEBUG_STATEMENT("Done.")
 }
@@ -101,6 +123,16 @@ void TaskUpdater::stopThread()
 
     keepRunning = false;
 
+    if (workerJob != nullptr)
+    {
+        // Holding the mutex ensures the worker pool is not updating the tasks
+        state = State::IDLE;
+        numUpdates = 0;
+        isRunning = false;
+        mutex.unlock();
+        return;
+    }
+
     PRINT_DEBUG_STATEMENT("Calling cv.notify_one().")
 
     cv.notify_one();  // So the publishing loop can exit
@@ -138,11 +170,15 @@ void TaskUpdater::updateTasks(ControlModel * model)
 
             PRINT_DEBUG_STATEMENT_RT("Calling notify_one() on the condition variable.")
 
-            cv.notify_one();
+            if (workerJob == nullptr)
+                cv.notify_one();
 
             PRINT_DEBUG_STATEMENT_RT("Releasing lock.")
 
             mutex.unlock();
+
+            if (workerJob != nullptr)
+                workerJob->submit();
         }
         else
         {
@@ -186,6 +222,8 @@ void TaskUpdater::updateLoop()
     PRINT_DEBUG_STATEMENT("Method Called\n"
         " - std::this_thread::get_id = " << std::this_thread::get_id())
 
+    RealTimeConfig::placeCurrentThread("task_update");
+
     isRunning = true;
     state = State::IDLE;
 
@@ -212,53 +250,193 @@ void TaskUpdater::updateLoop()
 
         // We have everything we need to proceed with an update
         if (keepRunning)
-        {
-            PRINT_DEBUG_STATEMENT("Updating the inactive state of the tasks!")
+            updateOnce();
+    }
 
-            // #define TIME_TASK_STATE_UPDATE 1
+    PRINT_DEBUG_STATEMENT("Stopping TaskUpdater::update() thread.  Number of updates: " << numUpdates);
 
-            #ifdef TIME_TASK_STATE_UPDATE
-            ros::Time startTaskUpdate = ros::Time::now();
-            #endif
+    // Reset some local variables
+    state = State::IDLE;
+    numUpdates = 0;
+    isRunning = false;
+}
 
-            for(std::vector<Task *>::iterator it = taskSet.begin(); it != taskSet.end(); ++it)
-            {
-                Task * currTask = (*it);
+void TaskUpdater::updateOnce()
+{
+    PRINT_DEBUG_STATEMENT("Updating the inactive state of the tasks!")
 
-                PRINT_DEBUG_STATEMENT("Updating the inactive state of task \""
-                    << currTask->getInstanceName() << "\", which is of type "
-                    << currTask->getTypeName())
+    // #define TIME_TASK_STATE_UPDATE 1
 
-                currTask->updateState(model);
+    #ifdef TIME_TASK_STATE_UPDATE
+    ros::Time startTaskUpdate = ros::Time::now();
+    #endif
 
-                if (currTask->isSensing())
-                    currTask->sense(*model);
-            }
+    double now = getCurrentTime();
 
-            #ifdef TIME_TASK_STATE_UPDATE
-            ros::Time stopTaskUpdate = ros::Time::now();
-            #endif
+    sortUpdateOrder();
 
-            numUpdates++;
+    for (size_t ii = 0; ii < updateOrder.size(); ii++)
+    {
+        size_t index = updateOrder[ii];
 
-            PRINT_DEBUG_STATEMENT("Done updating the tasks, # updates = " << numUpdates << ".  "
-                "Setting the status to be IDLE!")
+        // Skip tasks whose update period has not yet elapsed.  Their inactive
+        // state is not touched, so checkTasksForUpdates() keeps their active state.
+        if (!isUpdateDue(index, now)) continue;
 
-            state = State::IDLE;
+        Task * currTask = taskSet[index];
 
-            #ifdef TIME_TASK_STATE_UPDATE
-            CONTROLIT_INFO << "Latency Results (ms):\n"
-                        " - taskUpdate: " << (stopTaskUpdate - startTaskUpdate).toSec() * 1000;
-            #endif
-        }
+        PRINT_DEBUG_STATEMENT("Updating the inactive state of task \""
+            << currTask->getInstanceName() << "\", which is of type "
+            << currTask->getTypeName())
+
+        currTask->updateState(model);
+
+        if (currTask->isSensing())
+            currTask->sense(*model);
+
+        recordUpdate(index, now);
     }
 
-    PRINT_DEBUG_STATEMENT("Stopping TaskUpdater::update() thread.  Number of updates: " << numUpdates);
+    #ifdef TIME_TASK_STATE_UPDATE
+    ros::Time stopTaskUpdate = ros::Time::now();
+    #endif
+
+    numUpdates++;
+
+    PRINT_DEBUG_STATEMENT("Done updating the tasks, # updates = " << numUpdates << ".  "
+        "Setting the status to be IDLE!")
 
-    // Reset some local variables
     state = State::IDLE;
-    numUpdates = 0;
-    isRunning = false;
+
+    #ifdef TIME_TASK_STATE_UPDATE
+    CONTROLIT_INFO << "Latency Results (ms):\n"
+                " - taskUpdate: " << (stopTaskUpdate - startTaskUpdate).toSec() * 1000;
+    #endif
+}
+
+void TaskUpdater::runPooledUpdate()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (keepRunning && state == State::UPDATING_TASK_STATE)
+        updateOnce();
+}
+
+void TaskUpdater::setWorkerPool(WorkerPool * pool, WorkerPool::Account * account)
+{
+    assert(!isRunning);
+    workerJob = pool->addJob(account, std::bind(&TaskUpdater::runPooledUpdate, this));
+}
+
+double TaskUpdater::getEffectiveUpdateRate(size_t index) const
+{
+    assert(index < schedule.size());
+    return schedule[index].publishedRate.load(std::memory_order_relaxed);
+}
+
+double TaskUpdater::getStaleness(size_t index) const
+{
+    assert(index < schedule.size());
+
+    // This is infinite if the task's state was never updated.
+    return getCurrentTime() - schedule[index].publishedUpdateTime.load(std::memory_order_relaxed);
+}
+
+void TaskUpdater::setMinUpdatePeriod(double period, int maxPriority)
+{
+    minUpdatePeriodMaxPriority.store(maxPriority, std::memory_order_relaxed);
+    minUpdatePeriod.store(period, std::memory_order_release);
+}
+
+double TaskUpdater::getCurrentTime() const
+{
+    return ControllerClock::getTime();
+}
+
+void TaskUpdater::sortUpdateOrder()
+{
+    // This is a rate-monotonic order with the task priority taking precedence.
+    // The index breaks ties so that the order is deterministic.
+    std::sort(updateOrder.begin(), updateOrder.end(), [this](size_t a, size_t b)
+    {
+        const Task * taskA = taskSet[a];
+        const Task * taskB = taskSet[b];
+
+        if (taskA->getUpdatePriority() != taskB->getUpdatePriority())
+            return taskA->getUpdatePriority() > taskB->getUpdatePriority();
+
+        if (taskA->getUpdatePeriod() != taskB->getUpdatePeriod())
+            return taskA->getUpdatePeriod() < taskB->getUpdatePeriod();
+
+        return a < b;
+    });
+}
+
+bool TaskUpdater::isUpdateDue(size_t index, double now) const
+{
+    return getUpdatePeriod(index) <= 0 || now >= schedule[index].nextUpdateTime;
+}
+
+double TaskUpdater::getUpdatePeriod(size_t index) const
+{
+    double period = taskSet[index]->getUpdatePeriod();
+
+    double minPeriod = minUpdatePeriod.load(std::memory_order_acquire);
+    if (period < minPeriod
+        && taskSet[index]->getUpdatePriority() <= minUpdatePeriodMaxPriority.load(std::memory_order_relaxed))
+    {
+        period = minPeriod;
+    }
+
+    return period;
+}
+
+void TaskUpdater::recordUpdate(size_t index, double now)
+{
+    TaskSchedule & taskSchedule = schedule[index];
+
+    if (taskSchedule.numUpdates > 0 && now > taskSchedule.lastUpdateTime)
+    {
+        double rate = 1.0 / (now - taskSchedule.lastUpdateTime);
+
+        if (taskSchedule.numUpdates == 1)
+            taskSchedule.effectiveRate = rate;
+        else
+            taskSchedule.effectiveRate += UPDATE_RATE_FILTER_GAIN * (rate - taskSchedule.effectiveRate);
+    }
+
+    taskSchedule.lastUpdateTime = now;
+    taskSchedule.numUpdates++;
+
+    taskSchedule.publishedRate.store(taskSchedule.effectiveRate, std::memory_order_relaxed);
+    taskSchedule.publishedUpdateTime.store(now, std::memory_order_relaxed);
+
+    // Advance by whole periods so that the update times do not drift, but
+    // do not try to catch up on updates that were missed.
+    double period = getUpdatePeriod(index);
+    taskSchedule.nextUpdateTime += period;
+    if (taskSchedule.nextUpdateTime <= now)
+        taskSchedule.nextUpdateTime = now + period;
+}
+
+TaskUpdater::TaskSchedule::TaskSchedule() :
+    nextUpdateTime(-std::numeric_limits<double>::infinity()),
+    lastUpdateTime(0),
+    effectiveRate(0),
+    numUpdates(0),
+    publishedRate(0),
+    publishedUpdateTime(-std::numeric_limits<double>::infinity())
+{
+}
+
+TaskUpdater::TaskSchedule::TaskSchedule(const TaskSchedule & other) :
+    nextUpdateTime(other.nextUpdateTime),
+    lastUpdateTime(other.lastUpdateTime),
+    effectiveRate(other.effectiveRate),
+    numUpdates(other.numUpdates),
+    publishedRate(other.publishedRate.load()),
+    publishedUpdateTime(other.publishedUpdateTime.load())
+{
 }
 
 std::string TaskUpdater::stateToString(State state) const
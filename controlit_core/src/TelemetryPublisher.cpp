@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/TelemetryPublisher.hpp>
+
+#include <chrono>
+
+#include <controlit/ControllerClock.hpp>
+#include <controlit/RealTimeConfig.hpp>
+#include <controlit/logging/RealTimeLogging.hpp>
+
+namespace controlit {
+
+TelemetryPublisher::TelemetryPublisher() :
+    rate(0),
+    keepRunning(false)
+{
+}
+
+TelemetryPublisher::~TelemetryPublisher()
+{
+    stopThread();
+}
+
+bool TelemetryPublisher::init(ros::NodeHandle & nh, const std::vector<std::string> & jointNames,
+    const std::string & baseLinkName, double rate)
+{
+    if (rate <= 0)
+    {
+        CONTROLIT_ERROR << "Invalid telemetry rate " << rate << " Hz.";
+        return false;
+    }
+
+    this->rate = rate;
+
+    // Allocate the snapshots before the servo thread starts writing them
+    for (int ii = 0; ii < 3; ii++)
+    {
+        TelemetrySnapshot & snapshot = snapshots.getBuffer(ii);
+        snapshot.time = 0;
+        for (int jj = 0; jj < NUM_VIRTUAL_DOFS; jj++)
+            snapshot.virtualJointPosition[jj] = 0;
+        snapshot.jointPosition.setZero(jointNames.size());
+        snapshot.jointVelocity.setZero(jointNames.size());
+        snapshot.jointEffort.setZero(jointNames.size());
+    }
+
+    // This information is used by robot_state_publisher to publish the
+    // transforms for RViz visualization.
+    jointStatePublisher = nh.advertise<sensor_msgs::JointState>("/joint_states", 1);
+
+    jointStateMsg.name = jointNames;
+    jointStateMsg.position.assign(jointNames.size(), 0.0);
+    jointStateMsg.velocity.assign(jointNames.size(), 0.0);
+    jointStateMsg.effort.assign(jointNames.size(), 0.0);
+
+    odometryTransform.header.frame_id = "world";
+    odometryTransform.child_frame_id = baseLinkName;
+
+    return true;
+}
+
+void TelemetryPublisher::write(const RobotState & state)
+{
+    TelemetrySnapshot & snapshot = snapshots.getWriteBuffer();
+
+    snapshot.time = ControllerClock::getTime();
+
+    for (int ii = 0; ii < NUM_VIRTUAL_DOFS; ii++)
+        snapshot.virtualJointPosition[ii] = state.getVirtualJointPosition()(ii);
+
+    snapshot.jointPosition = state.getJointPosition();
+    snapshot.jointVelocity = state.getJointVelocity();
+    snapshot.jointEffort = state.getJointEffort();
+
+    snapshots.publish();
+}
+
+void TelemetryPublisher::startThread()
+{
+    if (thread.joinable()) return;
+
+    keepRunning = true;
+    thread = std::thread(&TelemetryPublisher::publishLoop, this);
+}
+
+void TelemetryPublisher::stopThread()
+{
+    if (!thread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        keepRunning = false;
+    }
+
+    cv.notify_one();
+    thread.join();
+}
+
+void TelemetryPublisher::publishLoop()
+{
+    RealTimeConfig::placeCurrentThread("telemetry");
+
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / rate));
+    auto nextPublishTime = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lk(mutex);
+
+    while (keepRunning)
+    {
+        // Do not try to catch up after falling behind, e.g., while ROS was busy
+        nextPublishTime += period;
+        auto now = std::chrono::steady_clock::now();
+        if (nextPublishTime < now)
+            nextPublishTime = now;
+
+        cv.wait_until(lk, nextPublishTime, [this] { return !keepRunning; });
+
+        if (keepRunning && snapshots.update())
+            publish(snapshots.getReadBuffer());
+    }
+}
+
+void TelemetryPublisher::publish(const TelemetrySnapshot & snapshot)
+{
+    // Stamp the messages with the time at which the snapshot was taken
+    ros::Time stamp = ros::Time::now();
+    double age = ControllerClock::getTime() - snapshot.time;
+    if (age > 0 && age < stamp.toSec())
+        stamp -= ros::Duration(age);
+
+    for (int ii = 0; ii < snapshot.jointPosition.size(); ii++)
+    {
+        jointStateMsg.position[ii] = snapshot.jointPosition[ii];
+        jointStateMsg.velocity[ii] = snapshot.jointVelocity[ii];
+        jointStateMsg.effort[ii] = snapshot.jointEffort[ii];
+    }
+
+    jointStateMsg.header.stamp = stamp;
+    jointStatePublisher.publish(jointStateMsg);
+
+    // Publish the odometry information.  This is the state of the virtual
+    // 6 DOFs that connect the robot to the world.
+    odometryTransform.header.stamp = stamp;
+    odometryTransform.transform.translation.x = snapshot.virtualJointPosition[0];
+    odometryTransform.transform.translation.y = snapshot.virtualJointPosition[1];
+    odometryTransform.transform.translation.z = snapshot.virtualJointPosition[2];
+
+    // The virtual DOFs are stored in x,y,z,y,p,r order
+    tf::Quaternion virtualDOFQuat = tf::createQuaternionFromRPY(
+        snapshot.virtualJointPosition[5],  // roll
+        snapshot.virtualJointPosition[4],  // pitch
+        snapshot.virtualJointPosition[3]); // yaw
+
+    odometryTransform.transform.rotation.x = virtualDOFQuat.x();
+    odometryTransform.transform.rotation.y = virtualDOFQuat.y();
+    odometryTransform.transform.rotation.z = virtualDOFQuat.z();
+    odometryTransform.transform.rotation.w = virtualDOFQuat.w();
+
+    tfBroadcaster.sendTransform(odometryTransform);
+}
+
+} // namespace controlit
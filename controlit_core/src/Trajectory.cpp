@@ -0,0 +1,417 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/Trajectory.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <controlit/logging/RealTimeLogging.hpp>
+
+namespace controlit {
+
+// Uncomment the appropriate lines below for enabling/disabling the printing of debug statements
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+Trajectory::Trajectory() :
+    numDims(0),
+    numSegments(0),
+    currentSegment(0)
+{
+}
+
+void Trajectory::reserve(int numDims, int maxSegments)
+{
+    this->numDims = numDims;
+
+    coefficients.setZero(NUM_COEFFICIENTS * numDims, maxSegments);
+    segmentTimes.assign(maxSegments + 1, 0);
+
+    knotVelocities.setZero(numDims, maxSegments + 1);
+    knotAccelerations.setZero(numDims, maxSegments + 1);
+    splineScratch.setZero(maxSegments + 1);
+    zero.setZero(numDims);
+
+    clear();
+}
+
+void Trajectory::clear()
+{
+    numSegments = 0;
+    currentSegment = 0;
+}
+
+bool Trajectory::setWaypoints(InterpolationType type, const std::vector<double> & times,
+    const Matrix & waypoints, const Vector & maxVelocity, const Vector & maxAcceleration)
+{
+    clear();
+
+    if (waypoints.rows() != numDims)
+    {
+        CONTROLIT_ERROR << "Waypoints have " << waypoints.rows() << " dimensions, expected " << numDims << ".";
+        return false;
+    }
+
+    if (waypoints.cols() < 2 || static_cast<size_t>(waypoints.cols()) != times.size())
+    {
+        CONTROLIT_ERROR << "Expected at least two waypoints with one time each, got "
+            << waypoints.cols() << " waypoints and " << times.size() << " times.";
+        return false;
+    }
+
+    if (waypoints.cols() > knotVelocities.cols())
+    {
+        CONTROLIT_ERROR << "Too many waypoints (" << waypoints.cols() << "), the maximum is "
+            << knotVelocities.cols() << ".";
+        return false;
+    }
+
+    if (times[0] != 0)
+    {
+        CONTROLIT_ERROR << "The first waypoint must be at time zero, got " << times[0] << ".";
+        return false;
+    }
+
+    for (size_t ii = 1; ii < times.size(); ii++)
+    {
+        if (!(times[ii] > times[ii - 1]) && !(type == TRAPEZOID_VELOCITY && times[ii] == times[ii - 1]))
+        {
+            CONTROLIT_ERROR << "Waypoint times must be increasing, but waypoint " << ii
+                << " is at time " << times[ii] << " and waypoint " << ii - 1 << " is at time " << times[ii - 1] << ".";
+            return false;
+        }
+    }
+
+    bool result = false;
+
+    switch (type)
+    {
+        case TRAPEZOID_VELOCITY:
+            result = buildTrapezoid(times, waypoints, maxVelocity, maxAcceleration);
+            break;
+        case CUBIC_SPLINE:
+        case QUINTIC_SPLINE:
+            result = buildSpline(type, times, waypoints);
+            break;
+        case MINIMUM_JERK:
+            result = buildMinimumJerk(times, waypoints);
+            break;
+        default:
+            CONTROLIT_ERROR << "Unknown interpolation type " << type << ".";
+    }
+
+    if (!result) clear();
+
+    PRINT_DEBUG_STATEMENT("Created a trajectory with " << numSegments << " segments lasting " << getDuration() << "s.")
+
+    return result;
+}
+
+bool Trajectory::buildTrapezoid(const std::vector<double> & times, const Matrix & waypoints,
+    const Vector & maxVelocity, const Vector & maxAcceleration)
+{
+    if (maxVelocity.size() != numDims || maxAcceleration.size() != numDims
+        || (maxVelocity.array() <= 0).any() || (maxAcceleration.array() <= 0).any())
+    {
+        CONTROLIT_ERROR << "A trapezoid velocity trajectory requires a positive velocity and "
+            << "acceleration limit for each of the " << numDims << " dimensions.";
+        return false;
+    }
+
+    for (int ii = 0; ii < waypoints.cols() - 1; ii++)
+    {
+        // All dimensions share the same acceleration time ta and the same time
+        // D = T - ta at which they start decelerating.  Dimension d then moves
+        // with velocity delta_d / D and acceleration delta_d / (D * ta), so the
+        // limits require D >= delta_d / vmax_d and D * ta >= delta_d / amax_d.
+        // The minimum T = D + ta is at D = ta = sqrt(max(delta_d / amax_d))
+        // unless the velocity limit forces D to be larger.
+        double minCruiseEnd = 0;
+        double minArea = 0;
+        for (int dd = 0; dd < numDims; dd++)
+        {
+            double distance = std::abs(waypoints(dd, ii + 1) - waypoints(dd, ii));
+            minCruiseEnd = std::max(minCruiseEnd, distance / maxVelocity[dd]);
+            minArea = std::max(minArea, distance / maxAcceleration[dd]);
+        }
+
+        double accelTime = std::sqrt(minArea);
+        double cruiseEnd = accelTime;
+        if (cruiseEnd < minCruiseEnd)
+        {
+            cruiseEnd = minCruiseEnd;
+            accelTime = minArea / minCruiseEnd;
+        }
+
+        double duration = cruiseEnd + accelTime;
+        double requestedDuration = times[ii + 1] - segmentTimes[numSegments];
+
+        if (duration == 0)
+        {
+            if (requestedDuration <= 0)
+                continue;  // a repeated waypoint
+
+            // The waypoints are equal but the robot should wait here
+            double * segment = addSegment(requestedDuration);
+            if (segment == nullptr) return false;
+            for (int dd = 0; dd < numDims; dd++)
+                segment[dd * NUM_COEFFICIENTS] = waypoints(dd, ii);
+            continue;
+        }
+
+        // Slow down uniformly if the waypoint time is later than the limits require
+        if (requestedDuration > duration)
+        {
+            double scale = requestedDuration / duration;
+            accelTime *= scale;
+            cruiseEnd *= scale;
+        }
+
+        double * accelSegment = addSegment(accelTime);
+        if (accelSegment == nullptr) return false;
+
+        double * cruiseSegment = nullptr;
+        if (cruiseEnd > accelTime)
+        {
+            cruiseSegment = addSegment(cruiseEnd - accelTime);
+            if (cruiseSegment == nullptr) return false;
+        }
+
+        double * decelSegment = addSegment(accelTime);
+        if (decelSegment == nullptr) return false;
+
+        for (int dd = 0; dd < numDims; dd++)
+        {
+            double start = waypoints(dd, ii);
+            double end = waypoints(dd, ii + 1);
+            double velocity = (end - start) / cruiseEnd;
+            double acceleration = velocity / accelTime;
+
+            accelSegment[dd * NUM_COEFFICIENTS] = start;
+            accelSegment[dd * NUM_COEFFICIENTS + 2] = 0.5 * acceleration;
+
+            if (cruiseSegment != nullptr)
+            {
+                cruiseSegment[dd * NUM_COEFFICIENTS] = start + 0.5 * velocity * accelTime;
+                cruiseSegment[dd * NUM_COEFFICIENTS + 1] = velocity;
+            }
+
+            decelSegment[dd * NUM_COEFFICIENTS] = end - 0.5 * velocity * accelTime;
+            decelSegment[dd * NUM_COEFFICIENTS + 1] = velocity;
+            decelSegment[dd * NUM_COEFFICIENTS + 2] = -0.5 * acceleration;
+        }
+    }
+
+    // All of the waypoints are the same and have the same time
+    if (numSegments == 0)
+    {
+        double * segment = addSegment(0);
+        if (segment == nullptr) return false;
+        for (int dd = 0; dd < numDims; dd++)
+            segment[dd * NUM_COEFFICIENTS] = waypoints(dd, 0);
+    }
+
+    return true;
+}
+
+bool Trajectory::buildSpline(InterpolationType type, const std::vector<double> & times, const Matrix & waypoints)
+{
+    int last = waypoints.cols() - 1;
+
+    // Solve for the knot velocities that make the acceleration continuous.
+    // With Hermite cubics between the knots, the acceleration at knot i is
+    // continuous if
+    //
+    //   v[i-1] / h[i-1] + 2 * (1 / h[i-1] + 1 / h[i]) * v[i] + v[i+1] / h[i]
+    //     = 3 * (delta[i-1] / h[i-1]^2 + delta[i] / h[i]^2)
+    //
+    // where h[i] is the duration of segment i and delta[i] is its displacement.
+    // The velocities at the ends are zero.  This tridiagonal system is solved
+    // using the Thomas algorithm, which stores the modified right hand side in
+    // knotVelocities and the modified super-diagonal in splineScratch.
+    knotVelocities.col(0).setZero();
+    knotVelocities.col(last).setZero();
+    splineScratch[0] = 0;
+
+    for (int ii = 1; ii < last; ii++)
+    {
+        double hPrev = times[ii] - times[ii - 1];
+        double hNext = times[ii + 1] - times[ii];
+
+        double sub = 1 / hPrev;
+        double super = 1 / hNext;
+        double pivot = 2 * (sub + super) - sub * splineScratch[ii - 1];
+
+        splineScratch[ii] = super / pivot;
+        knotVelocities.col(ii) = (3 * ((waypoints.col(ii) - waypoints.col(ii - 1)) / (hPrev * hPrev)
+            + (waypoints.col(ii + 1) - waypoints.col(ii)) / (hNext * hNext))
+            - sub * knotVelocities.col(ii - 1)) / pivot;
+    }
+
+    for (int ii = last - 2; ii > 0; ii--)
+        knotVelocities.col(ii) -= splineScratch[ii] * knotVelocities.col(ii + 1);
+
+    // The knot accelerations of the cubic spline
+    for (int ii = 0; ii < last; ii++)
+    {
+        double h = times[ii + 1] - times[ii];
+        knotAccelerations.col(ii) = 6 * (waypoints.col(ii + 1) - waypoints.col(ii)) / (h * h)
+            - (4 * knotVelocities.col(ii) + 2 * knotVelocities.col(ii + 1)) / h;
+    }
+
+    double h = times[last] - times[last - 1];
+    knotAccelerations.col(last) = -6 * (waypoints.col(last) - waypoints.col(last - 1)) / (h * h)
+        + (2 * knotVelocities.col(last - 1) + 4 * knotVelocities.col(last)) / h;
+
+    if (type == QUINTIC_SPLINE)
+    {
+        knotAccelerations.col(0).setZero();
+        knotAccelerations.col(last).setZero();
+    }
+
+    // A quintic Hermite segment with the knot values of a cubic spline is
+    // that cubic, so both splines are stored as quintics.
+    for (int ii = 0; ii < last; ii++)
+    {
+        if (!addQuinticSegment(times[ii + 1] - times[ii],
+            waypoints.col(ii), knotVelocities.col(ii), knotAccelerations.col(ii),
+            waypoints.col(ii + 1), knotVelocities.col(ii + 1), knotAccelerations.col(ii + 1)))
+            return false;
+    }
+
+    return true;
+}
+
+bool Trajectory::buildMinimumJerk(const std::vector<double> & times, const Matrix & waypoints)
+{
+    for (int ii = 0; ii < waypoints.cols() - 1; ii++)
+    {
+        if (!addQuinticSegment(times[ii + 1] - times[ii],
+            waypoints.col(ii), zero, zero, waypoints.col(ii + 1), zero, zero))
+            return false;
+    }
+
+    return true;
+}
+
+double * Trajectory::addSegment(double duration)
+{
+    if (numSegments >= coefficients.cols())
+    {
+        CONTROLIT_ERROR << "The trajectory requires more than the maximum of " << coefficients.cols() << " segments.";
+        return nullptr;
+    }
+
+    segmentTimes[numSegments + 1] = segmentTimes[numSegments] + duration;
+    coefficients.col(numSegments).setZero();
+    return coefficients.col(numSegments++).data();
+}
+
+bool Trajectory::addQuinticSegment(double duration,
+    const Eigen::Ref<const Vector> & p0, const Eigen::Ref<const Vector> & v0, const Eigen::Ref<const Vector> & a0,
+    const Eigen::Ref<const Vector> & p1, const Eigen::Ref<const Vector> & v1, const Eigen::Ref<const Vector> & a1)
+{
+    double * segment = addSegment(duration);
+    if (segment == nullptr) return false;
+
+    double h = duration;
+    double h2 = h * h;
+
+    for (int dd = 0; dd < numDims; dd++)
+    {
+        double delta = p1[dd] - p0[dd];
+        double * c = segment + dd * NUM_COEFFICIENTS;
+
+        c[0] = p0[dd];
+        c[1] = v0[dd];
+        c[2] = 0.5 * a0[dd];
+        c[3] = (20 * delta - (8 * v1[dd] + 12 * v0[dd]) * h - (3 * a0[dd] - a1[dd]) * h2) / (2 * h2 * h);
+        c[4] = (-30 * delta + (14 * v1[dd] + 16 * v0[dd]) * h + (3 * a0[dd] - 2 * a1[dd]) * h2) / (2 * h2 * h2);
+        c[5] = (12 * delta - 6 * (v1[dd] + v0[dd]) * h + (a1[dd] - a0[dd]) * h2) / (2 * h2 * h2 * h);
+    }
+
+    return true;
+}
+
+bool Trajectory::evaluate(double time, Vector & position, Vector & velocity)
+{
+    if (numSegments == 0) return false;
+
+    position.resize(numDims);
+    velocity.resize(numDims);
+
+    double duration = segmentTimes[numSegments];
+
+    if (time >= duration)
+    {
+        // Hold the end of the last segment
+        currentSegment = numSegments - 1;
+        time = duration;
+    }
+    else if (time < segmentTimes[currentSegment])
+    {
+        // Time went backwards, search from the start
+        currentSegment = 0;
+    }
+
+    while (currentSegment < numSegments - 1 && time >= segmentTimes[currentSegment + 1])
+        currentSegment++;
+
+    double tau = std::max(0.0, time - segmentTimes[currentSegment]);
+    const double * segment = coefficients.col(currentSegment).data();
+
+    // Evaluate the polynomials using Horner's method
+    for (int dd = 0; dd < numDims; dd++)
+    {
+        const double * c = segment + dd * NUM_COEFFICIENTS;
+
+        double p = c[NUM_COEFFICIENTS - 1];
+        double v = (NUM_COEFFICIENTS - 1) * c[NUM_COEFFICIENTS - 1];
+
+        for (int kk = NUM_COEFFICIENTS - 2; kk >= 0; kk--)
+        {
+            p = p * tau + c[kk];
+            if (kk > 0) v = v * tau + kk * c[kk];
+        }
+
+        position[dd] = p;
+        velocity[dd] = v;
+    }
+
+    if (time >= duration) velocity.setZero();
+
+    return true;
+}
+
+void Trajectory::swap(Trajectory & other)
+{
+    std::swap(numDims, other.numDims);
+    std::swap(numSegments, other.numSegments);
+    std::swap(currentSegment, other.currentSegment);
+    coefficients.swap(other.coefficients);
+    segmentTimes.swap(other.segmentTimes);
+    knotVelocities.swap(other.knotVelocities);
+    knotAccelerations.swap(other.knotAccelerations);
+    splineScratch.swap(other.splineScratch);
+    zero.swap(other.zero);
+}
+
+} // namespace controlit
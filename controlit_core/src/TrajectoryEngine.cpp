@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/TrajectoryEngine.hpp>
+
+#include <controlit/logging/RealTimeLogging.hpp>
+
+namespace controlit {
+
+// Uncomment the appropriate lines below for enabling/disabling the printing of debug statements
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+#define PRINT_DEBUG_STATEMENT_RT(ss)
+// #define PRINT_DEBUG_STATEMENT_RT(ss) CONTROLIT_DEBUG_RT << ss;
+
+#define TRAJECTORY_TOPIC "goal_trajectory"
+
+TrajectoryEngine::TrajectoryEngine()
+{
+}
+
+TrajectoryEngine::~TrajectoryEngine()
+{
+    // Stop receiving trajectories before the channels are destroyed
+    trajectorySubscriber.shutdown();
+}
+
+bool TrajectoryEngine::init(ros::NodeHandle & nh, CompoundTask & compoundTask, std::shared_ptr<Timer> timer, int maxSegments)
+{
+    this->timer = timer;
+
+    for (auto & collection : compoundTask.getParameterCollections())
+    {
+        if (!collection.second->hasParameter("goalPosition"))
+            continue;
+
+        Parameter * goalPosition = collection.second->lookupParameter("goalPosition", PARAMETER_TYPE_VECTOR);
+
+        if (goalPosition == nullptr)
+            continue;
+
+        int numDims = goalPosition->getVector()->size();
+
+        std::unique_ptr<Channel> channel(new Channel());
+        channel->goalPosition = goalPosition;
+        channel->goalVelocity = collection.second->hasParameter("goalVelocity")
+            ? collection.second->lookupParameter("goalVelocity", PARAMETER_TYPE_VECTOR) : nullptr;
+        channel->hasPending = false;
+        channel->following = false;
+        channel->startTime = 0;
+        channel->active.reserve(numDims, maxSegments);
+        channel->pending.reserve(numDims, maxSegments);
+        channel->position.setZero(numDims);
+        channel->velocity.setZero(numDims);
+
+        if (channel->goalVelocity != nullptr && channel->goalVelocity->getVector()->size() != numDims)
+        {
+            CONTROLIT_WARN << "Task \"" << collection.first << "\" has a goalVelocity of size "
+                << channel->goalVelocity->getVector()->size() << " but a goalPosition of size " << numDims
+                << ".  Its trajectories will only set its goalPosition.";
+            channel->goalVelocity = nullptr;
+        }
+
+        PRINT_DEBUG_STATEMENT("Task \"" << collection.first << "\" can follow " << numDims << "-dimensional trajectories.")
+
+        channelList.push_back(channel.get());
+        channels[collection.first] = std::move(channel);
+    }
+
+    timer->start();
+
+    trajectorySubscriber = nh.subscribe(TRAJECTORY_TOPIC, 10, & TrajectoryEngine::trajectoryCallback, this);
+
+    return true;
+}
+
+void TrajectoryEngine::trajectoryCallback(const controlit_core::GoalTrajectory::ConstPtr & msg)
+{
+    auto channelIter = channels.find(msg->task);
+    if (channelIter == channels.end())
+    {
+        CONTROLIT_ERROR << "Received a trajectory for unknown task \"" << msg->task
+            << "\".  Only tasks with a goalPosition can follow trajectories.";
+        return;
+    }
+
+    Channel & channel = *(channelIter->second);
+    size_t numDims = channel.position.size();
+
+    if (msg->times.empty() || msg->waypoints.size() != msg->times.size() * numDims)
+    {
+        CONTROLIT_ERROR << "Trajectory for task \"" << msg->task << "\" has " << msg->times.size()
+            << " times and " << msg->waypoints.size() << " waypoint values, but each waypoint must have "
+            << numDims << " values.";
+        return;
+    }
+
+    Matrix waypoints = Eigen::Map<const Matrix>(msg->waypoints.data(), numDims, msg->times.size());
+    Vector maxVelocity = Eigen::Map<const Vector>(msg->max_velocity.data(), msg->max_velocity.size());
+    Vector maxAcceleration = Eigen::Map<const Vector>(msg->max_acceleration.data(), msg->max_acceleration.size());
+
+    std::lock_guard<std::mutex> lock(channel.mutex);
+
+    channel.hasPending = channel.pending.setWaypoints(
+        static_cast<Trajectory::InterpolationType>(msg->interpolation), msg->times, waypoints, maxVelocity, maxAcceleration);
+
+    if (!channel.hasPending)
+        CONTROLIT_ERROR << "Rejected trajectory for task \"" << msg->task << "\".";
+}
+
+void TrajectoryEngine::update()
+{
+    if (channelList.empty()) return;
+
+    double time = timer->getTime();
+
+    for (auto channel : channelList)
+    {
+        if (channel->mutex.try_lock())
+        {
+            if (channel->hasPending)
+            {
+                channel->active.swap(channel->pending);
+                channel->hasPending = false;
+                channel->following = true;
+                channel->startTime = time;
+                PRINT_DEBUG_STATEMENT_RT("Starting a trajectory lasting " << channel->active.getDuration() << "s.")
+            }
+            channel->mutex.unlock();
+        }
+
+        if (!channel->following)
+            continue;
+
+        double elapsedTime = time - channel->startTime;
+        channel->active.evaluate(elapsedTime, channel->position, channel->velocity);
+
+        channel->goalPosition->set(channel->position);
+        if (channel->goalVelocity != nullptr)
+            channel->goalVelocity->set(channel->velocity);
+
+        // Stop once the goals have been set to the end of the trajectory
+        if (elapsedTime >= channel->active.getDuration())
+            channel->following = false;
+    }
+}
+
+} // namespace controlit
@@ -26,6 +26,7 @@
 #include <RigidBodyDynamics/Extras/rbdl_extras.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
 #include <controlit/addons/eigen/PseudoInverse.hpp>
+#include <controlit/addons/eigen/SelectionMatrix.hpp>
 
 #include <controlit/parser/yaml_parser.hpp>
 #include <controlit/logging/RealTimeLogging.hpp>
@@ -37,11 +38,11 @@ using controlit::addons::eigen::Vector3d;
 using controlit::addons::eigen::Matrix3d;
 
 VirtualLinkageModel::VirtualLinkageModel() : 
-    initialized_(false), exists_(true)
+    initialized_(false), exists_(true), internalForceOperatorsEnabled_(false)
 {}
 
 VirtualLinkageModel::VirtualLinkageModel(std::string name) :
-    initialized_(false), exists_(true)
+    initialized_(false), exists_(true), internalForceOperatorsEnabled_(false)
 {}
 
 VirtualLinkageModel::~VirtualLinkageModel()
@@ -184,6 +185,13 @@ bool VirtualLinkageModel::enableSetChanged(ConstraintSet& updatedConstraints)
 
 void VirtualLinkageModel::update(RigidBodyDynamics::Model& robot, ConstraintSet& updatedConstraints,
     const Vector& Q, Matrix const& Ainv)
+{
+    updateContacts(robot, updatedConstraints, Q, Ainv);
+    updateProjections(updatedConstraints);
+}
+
+void VirtualLinkageModel::updateContacts(RigidBodyDynamics::Model& robot, ConstraintSet& updatedConstraints,
+    const Vector& Q, Matrix const& Ainv)
 {
     // Ensure init() was called prior to calling this method.
     assert(initialized_);
@@ -209,8 +217,8 @@ void VirtualLinkageModel::update(RigidBodyDynamics::Model& robot, ConstraintSet&
         JcBar_ = Ainv * Jc_.transpose() * lambda1;
         //update Nc_
         Nc_ = Id_col - JcBar_ * Jc_;
-        //update UNc_
-        UNc_ = U_ * Nc_;
+        //update UNc_ = U_ * Nc_ by gathering the actuable rows of Nc_
+        controlit::addons::eigen::selectRows(updatedConstraints.getUIndices(), Nc_, UNc_);
         //update UNcBar_
         Matrix temp2 = UNc_ * Ainv * UNc_.transpose();
         Matrix lambda2(temp2.cols(), temp2.rows());
@@ -218,7 +226,14 @@ void VirtualLinkageModel::update(RigidBodyDynamics::Model& robot, ConstraintSet&
         pseudo_inverse(temp2, lambda2); //, sigmaThreshold_);
         UNcBar_ = Ainv * UNc_.transpose() * lambda2;
     }
-    else
+}
+
+void VirtualLinkageModel::updateProjections(ConstraintSet& updatedConstraints)
+{
+    if(!exists_)
+        return;
+  
+    if(updatedConstraints.getNConstraints() == contactConstraintCount_)
     {
         // No need to repeat the calcuations if Jc_ = JcFull_
         updatedConstraints.getJacobianBar(JcBar_);
@@ -230,6 +245,25 @@ void VirtualLinkageModel::update(RigidBodyDynamics::Model& robot, ConstraintSet&
     //update Lstar_
     Lstar_ = Id_gamma - UNc_*UNcBar_;
     Matrix check = UNc_.transpose() * Lstar_;
+
+    if (internalForceOperatorsEnabled_)
+        updateInternalForceOperators(updatedConstraints);
+}
+
+void VirtualLinkageModel::updateInternalForceOperators(ConstraintSet& constraints)
+{
+    // U * JcBar_ is the actuable rows of JcBar_
+    const SelectionIndices & UIndices = constraints.getUIndices();
+    UJsbar_.resize(UIndices.size(), JcBar_.cols());
+    controlit::addons::eigen::selectRows(UIndices, JcBar_, UJsbar_);
+
+    Jlstarbar_.noalias() = Lstar_ * UJsbar_ * Wint_.transpose();
+
+    Jlstar_.resize(Jlstarbar_.cols(), Jlstarbar_.rows());
+    pseudo_inverse(Jlstarbar_, Jlstar_); //, sigmaThreshold_);
+
+    LstarTJlstarT_.noalias() = Lstar_.transpose() * Jlstar_.transpose();
+    WintJsbarT_.noalias() = Wint_ * JcBar_.transpose();
 }
 
 void VirtualLinkageModel::getWint(Matrix& Wint) const
@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/WorkerPool.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include <controlit/logging/RealTimeLogging.hpp>
+
+namespace controlit {
+
+// Uncomment one of the following lines to enable/disable detailed debug statements.
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+/*!
+ * How long an idle worker waits before checking whether it should stop.
+ */
+#define IDLE_TIMEOUT_NS 100000000LL
+
+WorkerPool::Statistics::Statistics() :
+    numJobs(0),
+    totalQueueLatency(0),
+    maxQueueLatency(0),
+    totalRunTime(0),
+    maxRunTime(0),
+    numThrottled(0),
+    duration(0)
+{
+}
+
+WorkerPool::Account::Account(const std::string & name, double quota) :
+    name(name),
+    quota(quota),
+    usedNS(0),
+    statisticsStartNS(WorkerPool::now())
+{
+}
+
+WorkerPool::Job::Job(WorkerPool & pool, Account & account, std::function<void()> function) :
+    pool(pool),
+    account(account),
+    function(function),
+    pending(false),
+    submitTimeNS(0),
+    running(false),
+    throttled(false)
+{
+}
+
+void WorkerPool::Job::submit()
+{
+    // Record the submission time before the job can be claimed
+    if (!pending.load(std::memory_order_acquire))
+        submitTimeNS.store(WorkerPool::now(), std::memory_order_relaxed);
+
+    if (!pending.exchange(true, std::memory_order_acq_rel))
+        sem_post(&pool.semaphore);
+}
+
+bool WorkerPool::Job::cancel()
+{
+    // Workers claim a job by clearing the same flag, so only one of them
+    // and this method can succeed.
+    return pending.exchange(false, std::memory_order_acq_rel);
+}
+
+WorkerPool::WorkerPool() :
+    initialized(false),
+    started(false),
+    stopping(false),
+    numWorkers(0),
+    accountingPeriodNS(0),
+    periodStartNS(0),
+    hasThrottledJob(false),
+    nextJob(0)
+{
+    sem_init(&semaphore, 0, 0);
+}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+    sem_destroy(&semaphore);
+}
+
+bool WorkerPool::init(size_t numWorkers, const std::vector<int> & cores, double accountingPeriod)
+{
+    if (initialized)
+    {
+        CONTROLIT_ERROR << "Attempted to initialize twice.";
+        return false;
+    }
+
+    if (numWorkers == 0 || accountingPeriod <= 0)
+    {
+        CONTROLIT_ERROR << "Invalid worker pool configuration: " << numWorkers
+            << " workers, accounting period " << accountingPeriod << "s.";
+        return false;
+    }
+
+    this->numWorkers = numWorkers;
+    this->cores = cores;
+    accountingPeriodNS = static_cast<int64_t>(accountingPeriod * 1e9);
+
+    initialized = true;
+    return true;
+}
+
+WorkerPool::Account * WorkerPool::addAccount(const std::string & name, double quota)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    accounts.emplace_back(new Account(name, quota));
+    return accounts.back().get();
+}
+
+WorkerPool::Job * WorkerPool::addJob(Account * account, std::function<void()> function)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.emplace_back(new Job(*this, *account, function));
+    return jobs.back().get();
+}
+
+bool WorkerPool::start()
+{
+    if (!initialized || started)
+    {
+        CONTROLIT_ERROR << "Attempted to start without initializing or after already starting.";
+        return false;
+    }
+
+    stopping = false;
+    periodStartNS = now();
+
+    bool result = true;
+    for (size_t ii = 0; ii < numWorkers; ii++)
+    {
+        workers.emplace_back(&WorkerPool::workerLoop, this);
+
+        if (!cores.empty())
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(cores[ii % cores.size()], &cpuSet);
+
+            int error = pthread_setaffinity_np(workers.back().native_handle(), sizeof(cpu_set_t), &cpuSet);
+            if (error != 0)
+            {
+                CONTROLIT_ERROR << "Unable to pin worker " << ii << " to core "
+                    << cores[ii % cores.size()] << ": " << std::strerror(error);
+                result = false;
+            }
+        }
+    }
+
+    started = true;
+    return result;
+}
+
+void WorkerPool::stop()
+{
+    if (!started) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    for (size_t ii = 0; ii < workers.size(); ii++)
+        sem_post(&semaphore);
+
+    for (size_t ii = 0; ii < workers.size(); ii++)
+        workers[ii].join();
+
+    workers.clear();
+    started = false;
+}
+
+WorkerPool::Statistics WorkerPool::getStatistics(Account * account, bool reset)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int64_t nowNS = now();
+    Statistics statistics = account->statistics;
+    statistics.duration = (nowNS - account->statisticsStartNS) / 1e9;
+
+    if (reset)
+    {
+        account->statistics = Statistics();
+        account->statisticsStartNS = nowNS;
+    }
+
+    return statistics;
+}
+
+int64_t WorkerPool::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+void WorkerPool::workerLoop()
+{
+    PRINT_DEBUG_STATEMENT("Worker started on CPU " << sched_getcpu())
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping)
+    {
+        int64_t startNS = now();
+        Job * job = claimJob(startNS);
+
+        if (job == nullptr)
+        {
+            // Throttled jobs may run again at the start of the next accounting period
+            int64_t deadlineNS = hasThrottledJob ? periodStartNS + accountingPeriodNS
+                                                 : startNS + IDLE_TIMEOUT_NS;
+            lock.unlock();
+            waitForSubmission(deadlineNS);
+            lock.lock();
+            continue;
+        }
+
+        lock.unlock();
+        job->function();
+        int64_t endNS = now();
+        lock.lock();
+
+        Account & account = job->account;
+        account.usedNS += endNS - startNS;
+
+        double queueLatency = (startNS - job->submitTimeNS.load(std::memory_order_relaxed)) / 1e9;
+        double runTime = (endNS - startNS) / 1e9;
+
+        Statistics & statistics = account.statistics;
+        statistics.numJobs++;
+        statistics.totalQueueLatency += queueLatency;
+        statistics.maxQueueLatency = std::max(statistics.maxQueueLatency, queueLatency);
+        statistics.totalRunTime += runTime;
+        statistics.maxRunTime = std::max(statistics.maxRunTime, runTime);
+
+        job->running = false;
+    }
+}
+
+WorkerPool::Job * WorkerPool::claimJob(int64_t nowNS)
+{
+    // Start a new accounting period
+    if (nowNS >= periodStartNS + accountingPeriodNS)
+    {
+        periodStartNS += ((nowNS - periodStartNS) / accountingPeriodNS) * accountingPeriodNS;
+
+        for (size_t ii = 0; ii < accounts.size(); ii++)
+            accounts[ii]->usedNS = 0;
+    }
+
+    hasThrottledJob = false;
+
+    for (size_t ii = 0; ii < jobs.size(); ii++)
+    {
+        Job * job = jobs[(nextJob + ii) % jobs.size()].get();
+
+        if (job->running || !job->pending.load(std::memory_order_acquire))
+            continue;
+
+        Account & account = job->account;
+        if (account.quota > 0 && account.usedNS >= account.quota * accountingPeriodNS)
+        {
+            if (!job->throttled)
+            {
+                job->throttled = true;
+                account.statistics.numThrottled++;
+            }
+
+            hasThrottledJob = true;
+            continue;
+        }
+
+        if (!job->pending.exchange(false, std::memory_order_acq_rel))
+            continue;
+
+        job->throttled = false;
+        job->running = true;
+        nextJob = (nextJob + ii + 1) % jobs.size();
+        return job;
+    }
+
+    return nullptr;
+}
+
+void WorkerPool::waitForSubmission(int64_t deadlineNS)
+{
+    // sem_timedwait uses the realtime clock
+    int64_t timeoutNS = std::max<int64_t>(deadlineNS - now(), 0);
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    int64_t nsec = deadline.tv_nsec + timeoutNS;
+    deadline.tv_sec += nsec / 1000000000LL;
+    deadline.tv_nsec = nsec % 1000000000LL;
+
+    while (sem_timedwait(&semaphore, &deadline) == -1 && errno == EINTR)
+        continue;
+}
+
+} // namespace controlit
@@ -20,12 +20,14 @@
 
 #include <RigidBodyDynamics/Extras/rbdl_extras.hpp>
 #include <rbdl/rbdl_mathutils.h>
+#include <cassert>
 #include <math.h>
 
 #include <rbdl/Dynamics.h>
 #include <rbdl/Kinematics.h>
 #include <controlit/ControlModel.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <controlit/addons/eigen/SelectionMatrix.hpp>
 #include <controlit/utility/ContainerUtility.hpp>
 
 #include <controlit/logging/RealTimeLogging.hpp>
@@ -308,59 +310,133 @@ Math::Matrix3d calcRFromV1toV2(const Math::Vector3d & v1, const Math::Vector3d &
 // }
 
 //Functions for approximating reaction forces.
-void calcRxnFrCOM(RigidBodyDynamics::Model& robot,
+
+namespace {
+
+/*!
+ * Computes the stacked reaction wrenches Jsbar.transpose() * (grav - fullTau),
+ * where Jsbar = Ainv * J.transpose() * (J * Ainv * J.transpose()).  The
+ * product is evaluated right-to-left so only matrix-vector products are
+ * formed.  Vectors y and w are scratch space of length # DOFs, and z and
+ * fullRxn must have length J.rows().  y and w are not allocated if they are
+ * already the right size.
+ */
+void calcRxnFromJacobian(const Math::MatrixNd & J,
+  const Math::MatrixNd & Ainv,
+  const Math::VectorNd & grav,
+  const Math::VectorNd & fullTau,
+  Math::VectorNd & y,
+  Math::VectorNd & w,
+  Eigen::Ref<Eigen::VectorXd> z,
+  Eigen::Ref<Eigen::VectorXd> fullRxn)
+{
+  // Jsbar.transpose() = (J * Ainv * J.transpose()) * J * Ainv since Ainv and
+  // J * Ainv * J.transpose() are symmetric.
+  w = grav - fullTau;
+  y.noalias() = Ainv * w;
+  z.noalias() = J * y;
+  w.noalias() = J.transpose() * z;
+  y.noalias() = Ainv * w;
+  fullRxn.noalias() = J * y;
+}
+
+/*!
+ * Computes the center of pressure of a body in contact given the reaction
+ * force and moment at its COM.  All vectors are in the same frame.
+ *
+ * \param[in] fi The reaction force.
+ * \param[in] mi The reaction moment at the COM.
+ * \param[in] ni The contact normal.
+ * \param[in] p0i A point on the contact plane.
+ * \param[in] gi The location of the COM.
+ * \return The center of pressure.
+ */
+Math::Vector3d solveCOP(const Math::Vector3d & fi, const Math::Vector3d & mi,
+  const Math::Vector3d & ni, const Math::Vector3d & p0i, const Math::Vector3d & gi)
+{
+  Math::Matrix3d Si = Math::Matrix3d::Identity() - ni * ni.transpose();
+  Math::Matrix3d SiHatMapFi = Si * RigidBodyDynamics::Math::VectorCrossMatrix(fi);
+
+  // The COP is the point on the contact plane at which the tangential
+  // reaction moment vanishes.  Solve the resulting 4x3 system in the
+  // least squares sense.
+  Eigen::Matrix<double, 4, 3> LHSi;
+  LHSi.topRows<3>() = SiHatMapFi;
+  LHSi.row(3) = ni.transpose();
+
+  Eigen::Vector4d rhsi;
+  rhsi.head<3>() = -Si * mi + SiHatMapFi * gi;
+  rhsi(3) = ni.dot(p0i);
+
+  Math::Matrix3d tempLHS = LHSi.transpose() * LHSi;
+  return tempLHS.inverse() * (LHSi.transpose() * rhsi);
+}
+
+} // namespace
+
+/*!
+ * Computes the reaction forces at the COMs of the bodies in contact given
+ * the command expressed in the full joint space, i.e., U.transpose() * Tau.
+ * A thread-local ContactWrenchEstimator holds the intermediate results, so
+ * nothing is allocated unless the robot model or the contact bodies changed
+ * since the previous call on this thread, or FrCOM has the wrong size.
+ */
+static void calcRxnFrCOMFullTau(RigidBodyDynamics::Model& robot,
   const Math::VectorNd& Q,
   const Math::MatrixNd& Ainv,
-  const Math::MatrixNd& U,
   const Math::VectorNd& grav,
   const std::vector<unsigned int>& body_id,
-  const Math::VectorNd& Tau,
-  std::vector<Math::VectorNd> & FrCOM,
-  double sigmaThreshold)
+  const Math::VectorNd& fullTau,
+  std::vector<Math::VectorNd> & FrCOM)
 {
-  if(FrCOM.size() != body_id.size())
-    FrCOM.clear();
+  static thread_local ContactWrenchEstimator estimator;
+
+  if (!estimator.isInitialized(robot, body_id))
+    estimator.init(robot, body_id);
 
-  Math::MatrixNd Jcom(6 * body_id.size(), robot.dof_count);
-  Math::MatrixNd Jvi(3, robot.dof_count); //Jvi.setZero();
-  Math::MatrixNd Jwi(3, robot.dof_count);
-  int rowct = 0;
+  estimator.updateKinematics(robot, Q);
+  estimator.estimateWrenches(Ainv, grav, fullTau);
+
+  if(FrCOM.size() != body_id.size())
+    FrCOM.resize(body_id.size());
 
   for(size_t ii = 0; ii < body_id.size(); ii++)
   {
-    RigidBodyDynamics::CalcPointJacobian(robot, Q, body_id[ii], robot.mBodies[body_id[ii]].mCenterOfMass, Jvi, false);
-    RigidBodyDynamics::CalcPointJacobianW(robot, Q, body_id[ii], robot.mBodies[body_id[ii]].mCenterOfMass, Jwi, false);
-
-    for(int iv = 0; iv < 3; iv++)
-      Jcom.row(rowct++) = Jvi.row(iv);
-    for(int iw = 0; iw < 3; iw++)
-      Jcom.row(rowct++) = Jwi.row(iw);
+    if (FrCOM[ii].size() != 6)
+      FrCOM[ii].resize(6);
+    FrCOM[ii] = estimator.getWrenchCOM(ii);
   }
+}
 
-  Math::MatrixNd temp = Jcom * Ainv * Jcom.transpose();
-  //Math::MatrixNd lambda;
-  //controlit::pseudoInverse(temp, sigmaThreshold, lambda);
-  Math::MatrixNd Jsbar = Ainv * Jcom.transpose() * temp;
-  Math::VectorNd fullRxn = -Jsbar.transpose() * U.transpose() * Tau + Jsbar.transpose() * grav;
+void calcRxnFrCOM(RigidBodyDynamics::Model& robot,
+  const Math::VectorNd& Q,
+  const Math::MatrixNd& Ainv,
+  const Math::MatrixNd& U,
+  const Math::VectorNd& grav,
+  const std::vector<unsigned int>& body_id,
+  const Math::VectorNd& Tau,
+  std::vector<Math::VectorNd> & FrCOM,
+  double sigmaThreshold)
+{
+  Math::VectorNd fullTau = U.transpose() * Tau;
+  calcRxnFrCOMFullTau(robot, Q, Ainv, grav, body_id, fullTau, FrCOM);
+}
 
-  // If FrCOM is empty, append to the end of it.  Otherwise, modify it directly.
-  // Note that the size check at the very beginning of this method ensures
-  // that FrCOM is the expected size.
-  Math::VectorNd Fri(6);
-  bool empty = false;
-  if(FrCOM.size() == 0)
-    empty = true;
+void calcRxnFrCOM(RigidBodyDynamics::Model& robot,
+  const Math::VectorNd& Q,
+  const Math::MatrixNd& Ainv,
+  const std::vector<int>& UIndices,
+  const Math::VectorNd& grav,
+  const std::vector<unsigned int>& body_id,
+  const Math::VectorNd& Tau,
+  std::vector<Math::VectorNd> & FrCOM,
+  double sigmaThreshold)
+{
+  // U.transpose() * Tau scatters the actuable efforts into the full joint space.
+  Math::VectorNd fullTau(robot.dof_count);
+  controlit::addons::eigen::scatterRows(UIndices, Tau, fullTau);
 
-  rowct = 0;
-  for(size_t ii = 0; ii < body_id.size(); ii++)
-  {
-    for(int ir = 0; ir < 6; ir++)
-      Fri[ir] = fullRxn[rowct++];
-    if(empty)
-      FrCOM.push_back(Fri);
-    else
-      FrCOM[ii] = Fri;
-  }
+  calcRxnFrCOMFullTau(robot, Q, Ainv, grav, body_id, fullTau, FrCOM);
 }
 
 void calcRxnFr(RigidBodyDynamics::Model& robot,
@@ -424,11 +500,8 @@ void calcCOPfromFrCOM(RigidBodyDynamics::Model& robot,
     empty = true;
 
   //Set up utility matrixes for COP calculation
-  Math::Matrix3d Id, hatMapFi, Ri, Si, SiHatMapFi;
-  Id.setZero(); Id(0, 0) = 1.0; Id(1, 1) = 1.0; Id(2, 2) = 1.0;
-  Math::MatrixNd LHSi(4, 3);
-  Math::Vector3d f, m, fi, mi, ni, p0i, pi, gi, SiMi, SiHatMapFiG;
-  Math::VectorNd rhsi(4);
+  Math::Matrix3d Ri;
+  Math::Vector3d f, m, fi, mi, ni, p0i, pi, gi;
 
   for(size_t ii = 0; ii < body_id.size(); ii++)
   {
@@ -457,25 +530,7 @@ void calcCOPfromFrCOM(RigidBodyDynamics::Model& robot,
       p0i = RigidBodyDynamics::CalcBodyToBaseCoordinates(robot, Q, body_id[ii], p0i, false);
 
     //Now that everything is in the same reference frame, compute COP in that frame
-    hatMapFi = RigidBodyDynamics::Math::VectorCrossMatrix(fi);
-    Si = Id - ni * ni.transpose();
-
-    SiHatMapFi = Si * hatMapFi;
-    SiHatMapFiG = SiHatMapFi * gi;
-    SiMi = Si * mi;
-
-    LHSi.row(0) = SiHatMapFi.row(0);
-    LHSi.row(1) = SiHatMapFi.row(1);
-    LHSi.row(2) = SiHatMapFi.row(2);
-    LHSi.row(3) = ni.transpose();
-
-    rhsi(0) = -SiMi(0) + SiHatMapFiG(0);
-    rhsi(1) = -SiMi(1) + SiHatMapFiG(1);
-    rhsi(2) = -SiMi(2) + SiHatMapFiG(2);
-    rhsi(3) = ni.transpose() * p0i;
-
-    Math::Matrix3d tempLHS = LHSi.transpose() * LHSi;
-    pi = tempLHS.inverse() * LHSi.transpose() * rhsi;
+    pi = solveCOP(fi, mi, ni, p0i, gi);
 
     if(empty)
       COP.push_back(pi);
@@ -515,11 +570,8 @@ void calcCOPfromFr(RigidBodyDynamics::Model& robot,
     calcRi = false;
 
   //Set up utility functions
-  Math::Matrix3d Id, hatMapFi, Ri, Si, SiHatMapFi;
-  Id.setZero(); Id(0, 0) = 1.0; Id(1, 1) = 1.0; Id(2, 2) = 1.0;
-  Math::MatrixNd LHSi(4, 3);
-  Math::Vector3d f, m, fi, mi, ni, p0i, pi, gi, SiMi, SiHatMapFiG;
-  Math::VectorNd rhsi(4);
+  Math::Matrix3d Ri;
+  Math::Vector3d f, m, fi, mi, ni, p0i, pi, gi;
 
   for(size_t ii = 0; ii < body_id.size(); ii++)
   {
@@ -555,28 +607,7 @@ void calcCOPfromFr(RigidBodyDynamics::Model& robot,
       p0i = contactPlanePoint[ii];
 
     //Now that everything is in the same reference frame, compute COP in that frame
-    hatMapFi = RigidBodyDynamics::Math::VectorCrossMatrix(fi);
-    Si = Id - ni * ni.transpose();
-
-    //std::cout<<"Si is : "<<std::endl<<Si<<std::endl;
-
-    SiHatMapFi = Si * hatMapFi;
-    SiHatMapFiG = SiHatMapFi * gi;
-    SiMi = Si * mi;
-
-    LHSi.row(0) = SiHatMapFi.row(0);
-    LHSi.row(1) = SiHatMapFi.row(1);
-    LHSi.row(2) = SiHatMapFi.row(2);
-    LHSi.row(3) = ni.transpose();
-
-    rhsi(0) = -SiMi(0) + SiHatMapFiG(0);
-    rhsi(1) = -SiMi(1) + SiHatMapFiG(1);
-    rhsi(2) = -SiMi(2) + SiHatMapFiG(2);
-    rhsi(3) = ni.transpose() * p0i;
-
-
-    Math::Matrix3d tempLHS = LHSi.transpose() * LHSi;
-    pi = tempLHS.inverse() * LHSi.transpose() * rhsi;
+    pi = solveCOP(fi, mi, ni, p0i, gi);
 
     if(empty)
       COP.push_back(pi);
@@ -603,11 +634,8 @@ void calcCOPfromFrCOM(RigidBodyDynamics::Model& robot,
 {
   //All actual calculations will be done in the WORLD frame.
   //Set up utility matrixes for COP calculation
-  Math::Matrix3d Id, hatMapFi, Ri, Si, SiHatMapFi;
-  Id.setZero(); Id(0, 0) = 1.0; Id(1, 1) = 1.0; Id(2, 2) = 1.0;
-  Math::MatrixNd LHSi(4,3);
-  Math::Vector3d f, m, fi, mi, ni, p0i, pi, gi, SiMi, SiHatMapFiG;
-  Math::VectorNd rhsi(4);
+  Math::Matrix3d Ri;
+  Math::Vector3d f, m, fi, mi, ni, p0i, pi, gi;
 
   //TODO: make this an input when done testing!
   //double M = robot.mBodies[body_id].mMass/2;
@@ -638,44 +666,7 @@ void calcCOPfromFrCOM(RigidBodyDynamics::Model& robot,
     p0i = RigidBodyDynamics::CalcBodyToBaseCoordinates(robot, Q, body_id, p0i, false);
 
   //Now that everything is in the same reference frame, compute COP in that frame
-  hatMapFi = RigidBodyDynamics::Math::VectorCrossMatrix(fi);
-  Si = Id - ni * ni.transpose();
-
-  SiHatMapFi = Si * hatMapFi;
-  SiHatMapFiG = SiHatMapFi * gi;
-  SiMi = Si * mi;
-
-  LHSi.row(0) = SiHatMapFi.row(0);
-  LHSi.row(1) = SiHatMapFi.row(1);
-  LHSi.row(2) = SiHatMapFi.row(2);
-  LHSi.row(3) = ni.transpose();
-
-  rhsi(0) = -SiMi(0) + SiHatMapFiG(0);
-  rhsi(1) = -SiMi(1) + SiHatMapFiG(1);
-  rhsi(2) = -SiMi(2) + SiHatMapFiG(2);
-  rhsi(3) = ni.transpose() * p0i;
-
-  Math::Matrix3d tempLHS = LHSi.transpose() * LHSi;
-  pi = tempLHS.inverse() * LHSi.transpose() * rhsi;
-
-  /*check equivialent solution.....*/
-  Math::MatrixNd LHSch(3, 3), I23;  I23.setZero(2, 3);
-  I23(0, 0) = 1; I23(1, 1) = 1;
-  Math::VectorNd rhsch(3);
-
-  Math::Matrix3d RzTon;
-  RzTon = RigidBodyDynamics::Extras::calcRFromV1toV2(Eigen::Vector3d::UnitZ(), ni);
-  LHSch.topRows(2) = I23 * RzTon.transpose() * SiHatMapFi;
-  LHSch.bottomRows(1) = ni.transpose();
-  rhsch.head(2) = I23 * RzTon.transpose() * (-SiMi + SiHatMapFiG);
-  rhsch.tail(1) = ni.transpose() * p0i;
-  // Math::Vector3d COPch = LHSch.inverse()*rhsch;
-
-  //std::cout<<"supposed cop = "<<pi.transpose()<<std::endl;
-  //std::cout<<"check cop = "<<COPch.transpose()<<std::endl;
-
-  /*std::cout<<"Si*mi+SiHatMapFi*pi-SiHatMapFiG : \n"<<Si*mi+SiHatMapFi*pi-SiHatMapFiG<<std::endl;
-  std::cout<<"mi+HatMapFi*pi-HatMapFiG : \n"<<mi+hatMapFi*pi-hatMapFi*gi<<std::endl;*/
+  pi = solveCOP(fi, mi, ni, p0i, gi);
 
   COP = pi;
 
@@ -702,11 +693,8 @@ void calcCOPfromFr(RigidBodyDynamics::Model& robot,
     calcRi = false;
 
   //Set up utility functions
-  Math::Matrix3d Id, hatMapFi, Ri, Si, SiHatMapFi;
-  Id.setZero(); Id(0, 0) = 1.0; Id(1, 1) = 1.0; Id(2, 2) = 1.0;
-  Math::MatrixNd LHSi(4, 3);
-  Math::Vector3d f, m, fi, mi, ni, p0i, pi, gi, SiMi, SiHatMapFiG;
-  Math::VectorNd rhsi(4);
+  Math::Matrix3d Ri;
+  Math::Vector3d f, m, fi, mi, ni, p0i, pi, gi;
 
   gi = body_frame_point; //COM location in body frame
   if(calcRi)
@@ -740,34 +728,176 @@ void calcCOPfromFr(RigidBodyDynamics::Model& robot,
     p0i = contactPlanePoint;
 
   //Now that everything is in the same reference frame, compute COP in that frame
-  hatMapFi = RigidBodyDynamics::Math::VectorCrossMatrix(fi);
-  Si = Id - ni * ni.transpose();
+  pi = solveCOP(fi, mi, ni, p0i, gi);
 
-  //std::cout<<"Si is : "<<std::endl<<Si<<std::endl;
+  if(COPFrame == Frame::LOCAL)
+    COP = pi;
 
-  SiHatMapFi = Si * hatMapFi;
-  SiHatMapFiG = SiHatMapFi * gi;
-  SiMi = Si * mi;
+  if(COPFrame == Frame::WORLD) //if we want the COP in the world frame, put it there.
+    COP = RigidBodyDynamics::CalcBodyToBaseCoordinates(robot, Q, body_id, pi, false);
+}
 
-  LHSi.row(0) = SiHatMapFi.row(0);
-  LHSi.row(1) = SiHatMapFi.row(1);
-  LHSi.row(2) = SiHatMapFi.row(2);
-  LHSi.row(3) = ni.transpose();
+// Contact wrench estimation
 
-  rhsi(0) = -SiMi(0) + SiHatMapFiG(0);
-  rhsi(1) = -SiMi(1) + SiHatMapFiG(1);
-  rhsi(2) = -SiMi(2) + SiHatMapFiG(2);
-  rhsi(3) = ni.transpose() * p0i;
+ContactWrenchEstimator::ContactWrenchEstimator() :
+  robotModel(NULL),
+  pointsAreCOMs(false)
+{
+}
 
+void ContactWrenchEstimator::init(RigidBodyDynamics::Model & robot,
+  const std::vector<unsigned int> & body_id,
+  const std::vector<Math::Vector3d> & body_frame_point)
+{
+  assert(body_frame_point.empty() || body_frame_point.size() == body_id.size());
+
+  size_t numContacts = body_id.size();
+
+  robotModel = &robot;
+  pointsAreCOMs = body_frame_point.empty();
+  bodyId = body_id;
+  bodyPoint.resize(numContacts);
+  for (size_t ii = 0; ii < numContacts; ii++)
+    bodyPoint[ii] = body_frame_point.empty() ? robot.mBodies[body_id[ii]].mCenterOfMass : body_frame_point[ii];
+
+  orientation.assign(numContacts, Math::Matrix3d::Identity());
+  origin.assign(numContacts, Math::Vector3d::Zero());
+  comPosition.assign(numContacts, Math::Vector3d::Zero());
+  pointPosition.assign(numContacts, Math::Vector3d::Zero());
+  cop.assign(numContacts, Math::Vector3d::Zero());
+
+  Jcom.setZero(6 * numContacts, robot.dof_count);
+  Jv.setZero(3, robot.dof_count);
+  Jw.setZero(3, robot.dof_count);
+
+  fullTau.setZero(robot.dof_count);
+  jointSpace.setZero(robot.dof_count);
+  jointSpace2.setZero(robot.dof_count);
+  taskSpace.setZero(6 * numContacts);
+  pointRxn.setZero(6 * numContacts);
+
+  wrenchCOM.setZero(6 * numContacts);
+  wrench.setZero(6 * numContacts);
+}
 
-  Math::Matrix3d tempLHS = LHSi.transpose() * LHSi;
-  pi = tempLHS.inverse() * LHSi.transpose() * rhsi;
+bool ContactWrenchEstimator::isInitialized(const RigidBodyDynamics::Model & robot,
+  const std::vector<unsigned int> & body_id) const
+{
+  return robotModel == &robot && pointsAreCOMs && bodyId == body_id
+    && Jcom.cols() == static_cast<int>(robot.dof_count);
+}
 
-  if(COPFrame == Frame::LOCAL)
-    COP = pi;
+void ContactWrenchEstimator::updatePoses(RigidBodyDynamics::Model & robot, const Math::VectorNd & Q)
+{
+  for (size_t ii = 0; ii < bodyId.size(); ii++)
+  {
+    unsigned int id = bodyId[ii];
 
-  if(COPFrame == Frame::WORLD) //if we want the COP in the world frame, put it there.
-    COP = RigidBodyDynamics::CalcBodyToBaseCoordinates(robot, Q, body_id, pi, false);
+    // The remaining points of the body are derived from its pose
+    orientation[ii] = RigidBodyDynamics::CalcBodyWorldOrientation(robot, Q, id, false);
+    origin[ii] = RigidBodyDynamics::CalcBodyToBaseCoordinates(robot, Q, id, Math::Vector3d::Zero(), false);
+    comPosition[ii] = origin[ii] + orientation[ii].transpose() * robot.mBodies[id].mCenterOfMass;
+    pointPosition[ii] = origin[ii] + orientation[ii].transpose() * bodyPoint[ii];
+  }
+}
+
+void ContactWrenchEstimator::updateKinematics(RigidBodyDynamics::Model & robot, const Math::VectorNd & Q)
+{
+  updatePoses(robot, Q);
+
+  for (size_t ii = 0; ii < bodyId.size(); ii++)
+  {
+    unsigned int id = bodyId[ii];
+    const Math::Vector3d & com = robot.mBodies[id].mCenterOfMass;
+
+    RigidBodyDynamics::CalcPointJacobian(robot, Q, id, com, Jv, false);
+    RigidBodyDynamics::CalcPointJacobianW(robot, Q, id, com, Jw, false);
+
+    Jcom.middleRows<3>(6 * ii) = Jv;
+    Jcom.middleRows<3>(6 * ii + 3) = Jw;
+  }
+}
+
+void ContactWrenchEstimator::estimateWrenches(const Math::MatrixNd & Ainv, const Math::VectorNd & grav,
+  const std::vector<int> & UIndices, const Math::VectorNd & Tau)
+{
+  controlit::addons::eigen::scatterRows(UIndices, Tau, fullTau);
+  calcRxnFromJacobian(Jcom, Ainv, grav, fullTau, jointSpace, jointSpace2, taskSpace, wrenchCOM);
+  shiftWrenches();
+}
+
+void ContactWrenchEstimator::estimateWrenches(const Math::MatrixNd & Ainv, const Math::VectorNd & grav,
+  const Math::VectorNd & fullTau)
+{
+  calcRxnFromJacobian(Jcom, Ainv, grav, fullTau, jointSpace, jointSpace2, taskSpace, wrenchCOM);
+  shiftWrenches();
+}
+
+void ContactWrenchEstimator::estimateWrenches(const Math::MatrixNd & J,
+  const std::vector<unsigned int> & contactDOFs, const Math::MatrixNd & Ainv,
+  const Math::VectorNd & grav, const std::vector<int> & UIndices, const Math::VectorNd & Tau)
+{
+  assert(contactDOFs.size() == bodyId.size() && J.rows() <= wrenchCOM.size());
+
+  controlit::addons::eigen::scatterRows(UIndices, Tau, fullTau);
+  calcRxnFromJacobian(J, Ainv, grav, fullTau, jointSpace, jointSpace2,
+    taskSpace.head(J.rows()), pointRxn.head(J.rows()));
+
+  // Expand the reaction at each point to a wrench and shift it to the COM.
+  // The moment about the COM is the moment about the point plus the moment
+  // of the force about the COM.
+  int row = 0;
+  for (size_t ii = 0; ii < bodyId.size(); ii++)
+  {
+    assert(contactDOFs[ii] == 3 || contactDOFs[ii] == 6);
+
+    wrench.segment<3>(6 * ii) = pointRxn.segment<3>(row);
+    if (contactDOFs[ii] == 6)
+      wrench.segment<3>(6 * ii + 3) = pointRxn.segment<3>(row + 3);
+    else
+      wrench.segment<3>(6 * ii + 3).setZero();
+    row += contactDOFs[ii];
+
+    Math::Vector3d fi = wrench.segment<3>(6 * ii);
+    wrenchCOM.segment<3>(6 * ii) = fi;
+    wrenchCOM.segment<3>(6 * ii + 3) = wrench.segment<3>(6 * ii + 3)
+      + (pointPosition[ii] - comPosition[ii]).cross(fi);
+  }
+
+  assert(row == J.rows());
+}
+
+void ContactWrenchEstimator::shiftWrenches()
+{
+  wrench = wrenchCOM;
+
+  // The moment about the point is the moment about the COM plus the moment
+  // of the force about the point.
+  for (size_t ii = 0; ii < bodyId.size(); ii++)
+  {
+    Math::Vector3d fi = wrenchCOM.segment<3>(6 * ii);
+    wrench.segment<3>(6 * ii + 3) += (comPosition[ii] - pointPosition[ii]).cross(fi);
+  }
+}
+
+void ContactWrenchEstimator::computeCOPs(const std::vector<Math::Vector3d> & contactNormal,
+  const std::vector<Math::Vector3d> & contactPlanePoint, const Frame & contactFrame)
+{
+  assert(contactNormal.size() == bodyId.size() && contactPlanePoint.size() == bodyId.size());
+
+  for (size_t ii = 0; ii < bodyId.size(); ii++)
+  {
+    Math::Vector3d ni = contactNormal[ii];
+    Math::Vector3d p0i = contactPlanePoint[ii];
+
+    if (contactFrame == Frame::LOCAL)
+    {
+      ni = orientation[ii].transpose() * ni;
+      p0i = origin[ii] + orientation[ii].transpose() * p0i;
+    }
+
+    cop[ii] = solveCOP(wrenchCOM.segment<3>(6 * ii), wrenchCOM.segment<3>(6 * ii + 3), ni, p0i, comPosition[ii]);
+  }
 }
 
 // Dynamics
@@ -783,5 +913,240 @@ void calcTau(ControlModel& robot, Vector & Tau, std::vector<SpatialVector> * f_e
 }
 */
 
+// Fused kinematics and dynamics
+
+namespace {
+
+typedef Eigen::Matrix<double, 6, 1> SpatialVector6d;
+
+/*!
+ * Transforms a spatial motion vector from the parent frame to the child frame.
+ */
+inline SpatialVector6d applyMotion(const Math::SpatialTransform & X, const SpatialVector6d & m)
+{
+  SpatialVector6d result;
+  result.head<3>() = X.E * m.head<3>();
+  result.tail<3>() = X.E * (m.tail<3>() - X.r.cross(m.head<3>()));
+  return result;
+}
+
+/*!
+ * Transforms a spatial force vector from the child frame to the parent frame.
+ */
+inline SpatialVector6d applyForceTranspose(const Math::SpatialTransform & X, const SpatialVector6d & f)
+{
+  Eigen::Vector3d n = X.E.transpose() * f.head<3>();
+  Eigen::Vector3d fl = X.E.transpose() * f.tail<3>();
+
+  SpatialVector6d result;
+  result.head<3>() = n + X.r.cross(fl);
+  result.tail<3>() = fl;
+  return result;
+}
+
+/*!
+ * The spatial cross product of two motion vectors.
+ */
+inline SpatialVector6d crossMotion(const SpatialVector6d & v, const SpatialVector6d & m)
+{
+  SpatialVector6d result;
+  result.head<3>() = v.head<3>().cross(m.head<3>());
+  result.tail<3>() = v.head<3>().cross(m.tail<3>()) + v.tail<3>().cross(m.head<3>());
+  return result;
+}
+
+/*!
+ * The spatial cross product of a motion vector and a force vector.
+ */
+inline SpatialVector6d crossForce(const SpatialVector6d & v, const SpatialVector6d & f)
+{
+  SpatialVector6d result;
+  result.head<3>() = v.head<3>().cross(f.head<3>()) + v.tail<3>().cross(f.tail<3>());
+  result.tail<3>() = v.head<3>().cross(f.tail<3>());
+  return result;
+}
+
+/*!
+ * Multiplies a motion vector by a spatial inertia given as its mass, first
+ * mass moment, and rotational inertia about the frame's origin.
+ */
+template<typename MomentType, typename InertiaType>
+inline SpatialVector6d multiplyInertia(double mass, const MomentType & h,
+  const InertiaType & I, const SpatialVector6d & m)
+{
+  SpatialVector6d result;
+  result.head<3>() = I * m.head<3>() + h.cross(m.tail<3>());
+  result.tail<3>() = mass * m.tail<3>() - h.cross(m.head<3>());
+  return result;
+}
+
+} // namespace
+
+FusedDynamics::FusedDynamics() :
+  supported(false),
+  numBodies(0)
+{
+}
+
+bool FusedDynamics::init(RigidBodyDynamics::Model & robot)
+{
+  numBodies = robot.mBodies.size();
+
+  // Each movable body must add exactly one DOF so body i moves joint i - 1
+  supported = numBodies > 1 && numBodies - 1 == robot.dof_count;
+
+  parent.assign(numBodies, 0);
+  revolute.assign(numBodies, false);
+
+  S.setZero(6, numBodies);
+  bodyMass.setZero(numBodies);
+  bodyMoment.setZero(3, numBodies);
+  bodyInertia.setZero(3, 3 * numBodies);
+  compositeMass.setZero(numBodies);
+  compositeMoment.setZero(3, numBodies);
+  compositeInertia.setZero(3, 3 * numBodies);
+  velocity.setZero(6, numBodies);
+  biasAcceleration.setZero(6, numBodies);
+  acceleration.setZero(6, numBodies);
+  gravityForce.setZero(6, numBodies);
+  coriolisForce.setZero(6, numBodies);
+
+  for (unsigned int ii = 1; ii < numBodies; ii++)
+  {
+    parent[ii] = robot.lambda[ii];
+    S.col(ii) = robot.S[ii];
+
+    bool angular = S.col(ii).head<3>().norm() > 0;
+    bool linear = S.col(ii).tail<3>().norm() > 0;
+
+    if (robot.mJoints[ii].mDoFCount != 1 || angular == linear)
+      supported = false;
+
+    revolute[ii] = angular;
+
+    // Move the body's rotational inertia from its COM to its origin
+    const RigidBodyDynamics::Body & body = robot.mBodies[ii];
+    Eigen::Vector3d com = body.mCenterOfMass;
+
+    bodyMass(ii) = body.mMass;
+    bodyMoment.col(ii) = body.mMass * com;
+    bodyInertia.block<3, 3>(0, 3 * ii) = body.mInertia
+      + body.mMass * (com.squaredNorm() * Eigen::Matrix3d::Identity() - com * com.transpose());
+  }
+
+  return supported;
+}
+
+void FusedDynamics::update(RigidBodyDynamics::Model & robot, const Math::VectorNd & Q,
+  const Math::VectorNd & Qd, const Math::VectorNd & Qdd,
+  Math::MatrixNd * H, Math::VectorNd & gravity, Math::VectorNd & coriolis)
+{
+  assert(supported && robot.mBodies.size() == numBodies);
+  assert(Q.size() == (int)numBodies - 1 && Qd.size() == Q.size() && Qdd.size() == Q.size());
+  assert(gravity.size() == Q.size() && coriolis.size() == Q.size());
+
+  Eigen::Vector3d g = robot.gravity;
+
+  // Forward pass: kinematics and the forces each body needs
+  for (unsigned int ii = 1; ii < numBodies; ii++)
+  {
+    unsigned int lambda = parent[ii];
+
+    Math::SpatialTransform XJ;
+    if (revolute[ii])
+      XJ = Math::Xrot(Q[ii - 1], Math::Vector3d(S.col(ii).head<3>()));
+    else
+      XJ = Math::Xtrans(Math::Vector3d(S.col(ii).tail<3>() * Q[ii - 1]));
+
+    robot.X_lambda[ii] = XJ * robot.X_T[ii];
+    const Math::SpatialTransform & X = robot.X_lambda[ii];
+
+    if (lambda != 0)
+      robot.X_base[ii] = X * robot.X_base[lambda];
+    else
+      robot.X_base[ii] = X;
+
+    SpatialVector6d vJ = S.col(ii) * Qd[ii - 1];
+    velocity.col(ii) = applyMotion(X, velocity.col(lambda)) + vJ;
+
+    SpatialVector6d c = crossMotion(velocity.col(ii), vJ);
+    biasAcceleration.col(ii) = applyMotion(X, biasAcceleration.col(lambda)) + c;
+    acceleration.col(ii) = applyMotion(X, acceleration.col(lambda)) + c + S.col(ii) * Qdd[ii - 1];
+
+    robot.v[ii] = velocity.col(ii);
+    robot.c[ii] = c;
+    robot.a[ii] = acceleration.col(ii);
+
+    // Gravity is an upward acceleration of the root body
+    SpatialVector6d gravityAcceleration;
+    gravityAcceleration.head<3>().setZero();
+    gravityAcceleration.tail<3>() = -(robot.X_base[ii].E * g);
+
+    double mass = bodyMass(ii);
+    auto h = bodyMoment.col(ii);
+    auto I = bodyInertia.block<3, 3>(0, 3 * ii);
+
+    gravityForce.col(ii) = multiplyInertia(mass, h, I, gravityAcceleration);
+    coriolisForce.col(ii) = multiplyInertia(mass, h, I, biasAcceleration.col(ii))
+      + crossForce(velocity.col(ii), multiplyInertia(mass, h, I, velocity.col(ii)));
+  }
+
+  if (H != NULL)
+  {
+    H->setZero();
+    compositeMass = bodyMass;
+    compositeMoment = bodyMoment;
+    compositeInertia = bodyInertia;
+  }
+
+  // Backward pass: project the forces onto the joints and accumulate them and
+  // the composite inertias in the parent bodies
+  for (unsigned int ii = numBodies - 1; ii > 0; ii--)
+  {
+    unsigned int lambda = parent[ii];
+    const Math::SpatialTransform & X = robot.X_lambda[ii];
+
+    gravity[ii - 1] = S.col(ii).dot(gravityForce.col(ii));
+    coriolis[ii - 1] = S.col(ii).dot(coriolisForce.col(ii));
+
+    if (lambda != 0)
+    {
+      gravityForce.col(lambda) += applyForceTranspose(X, gravityForce.col(ii));
+      coriolisForce.col(lambda) += applyForceTranspose(X, coriolisForce.col(ii));
+    }
+
+    if (H == NULL)
+      continue;
+
+    // All of this body's descendants have been added to its composite inertia
+    SpatialVector6d F = multiplyInertia(compositeMass(ii), compositeMoment.col(ii),
+      compositeInertia.block<3, 3>(0, 3 * ii), S.col(ii));
+
+    (*H)(ii - 1, ii - 1) = S.col(ii).dot(F);
+
+    unsigned int jj = ii;
+    while (parent[jj] != 0)
+    {
+      F = applyForceTranspose(robot.X_lambda[jj], F);
+      jj = parent[jj];
+      (*H)(ii - 1, jj - 1) = (*H)(jj - 1, ii - 1) = S.col(jj).dot(F);
+    }
+
+    if (lambda != 0)
+    {
+      Eigen::Vector3d h = X.E.transpose() * compositeMoment.col(ii);
+      Eigen::Matrix3d rx = Math::VectorCrossMatrix(X.r);
+      Eigen::Matrix3d hx = Math::VectorCrossMatrix(h);
+      double mass = compositeMass(ii);
+
+      compositeMass(lambda) += mass;
+      compositeMoment.col(lambda) += h + mass * X.r;
+      compositeInertia.block<3, 3>(0, 3 * lambda) +=
+        X.E.transpose() * compositeInertia.block<3, 3>(0, 3 * ii) * X.E
+        - hx * rx - rx * hx - mass * rx * rx;
+    }
+  }
+}
+
 } // namespace Extras
 } // namespace RigidBodyDynamics
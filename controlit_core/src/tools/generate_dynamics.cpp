@@ -0,0 +1,818 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * Generates a GeneratedDynamics plugin for one robot from its URDF.  See
+ * controlit/GeneratedDynamics.hpp.
+ */
+
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/positional_options.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+
+#include <rbdl/rbdl.h>
+#include <controlit_robot_models/rbdl_robot_urdfreader.hpp>
+#include <controlit/GeneratedDynamics.hpp>
+
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace po = boost::program_options;
+
+using RigidBodyDynamics::Math::Vector3d;
+using RigidBodyDynamics::Math::Matrix3d;
+using RigidBodyDynamics::Math::SpatialVector;
+
+namespace {
+
+void usage()
+{
+    std::cout << "Usage: generate_dynamics [options] filename.urdf" << std::endl;
+}
+
+/*!
+ * Prints a number with enough digits to reproduce it exactly.
+ */
+std::string literal(double value)
+{
+    if (value == 0)
+        return "0";
+
+    std::ostringstream ss;
+    ss.precision(17);
+    ss << value;
+
+    std::string result = ss.str();
+    if (result.find_first_of(".e") == std::string::npos)
+        result += ".0";
+    return result;
+}
+
+std::string literal(const Vector3d & v)
+{
+    return "Eigen::Vector3d(" + literal(v[0]) + ", " + literal(v[1]) + ", " + literal(v[2]) + ")";
+}
+
+std::string literal(const Matrix3d & m)
+{
+    std::string result = "(Eigen::Matrix3d() << ";
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 3; col++)
+            result += (row + col > 0 ? ", " : "") + literal(m(row, col));
+    return result + ").finished()";
+}
+
+/*!
+ * Prints the product of a constant and a variable, omitting trivial factors.
+ */
+std::string product(double constant, const std::string & variable)
+{
+    if (constant == 0) return "0";
+    if (constant == 1) return variable;
+    if (constant == -1) return "-" + variable;
+    return literal(constant) + " * " + variable;
+}
+
+/*!
+ * Prints the term " + constant * variable" with the sign of the constant.
+ */
+std::string sum(double constant, const std::string & variable)
+{
+    if (constant == 0) return "";
+    if (constant < 0) return " - " + product(-constant, variable);
+    return " + " + product(constant, variable);
+}
+
+/*!
+ * Prints the dot product of a constant vector and a variable vector.
+ */
+template<typename VectorType>
+std::string dot(const VectorType & constant, const std::string & variable)
+{
+    std::string result;
+    for (int ii = 0; ii < constant.size(); ii++)
+    {
+        if (constant[ii] == 0)
+            continue;
+
+        std::string element = variable + "(" + std::to_string(ii) + ")";
+        if (result.empty())
+            result = product(constant[ii], element);
+        else
+            result += sum(constant[ii], element);
+    }
+    return result.empty() ? "0" : result;
+}
+
+/*!
+ * Prints a comma initializer for the spatial vector S * variable.
+ */
+std::string scaledSpatialVector(const SpatialVector & S, const std::string & variable)
+{
+    std::string result;
+    for (int ii = 0; ii < 6; ii++)
+        result += (ii > 0 ? ", " : "") + product(S[ii], variable);
+    return result;
+}
+
+/*!
+ * Prints a comma initializer for a constant spatial vector.
+ */
+std::string spatialLiteral(const SpatialVector & S)
+{
+    std::string result;
+    for (int ii = 0; ii < 6; ii++)
+        result += (ii > 0 ? ", " : "") + literal(S[ii]);
+    return result;
+}
+
+/*!
+ * \return The index of the unit vector equal to axis, or -1 if there is none.
+ */
+int unitAxis(const Vector3d & axis)
+{
+    for (int ii = 0; ii < 3; ii++)
+    {
+        if (axis[ii] == 1 && axis[(ii + 1) % 3] == 0 && axis[(ii + 2) % 3] == 0)
+            return ii;
+    }
+    return -1;
+}
+
+/*!
+ * Prints the rotation of RBDL's Xrot(angle, axis) given the sine and
+ * cosine of the angle in variables s and c.
+ */
+std::string jointRotation(const Vector3d & axis)
+{
+    switch (unitAxis(axis))
+    {
+        case 0: return "(Eigen::Matrix3d() << 1, 0, 0, 0, c, s, 0, -s, c).finished()";
+        case 1: return "(Eigen::Matrix3d() << c, 0, -s, 0, 1, 0, s, 0, c).finished()";
+        case 2: return "(Eigen::Matrix3d() << c, s, 0, -s, c, 0, 0, 0, 1).finished()";
+    }
+
+    std::string xx = literal(axis[0] * axis[0]), yy = literal(axis[1] * axis[1]), zz = literal(axis[2] * axis[2]);
+    std::string xy = literal(axis[0] * axis[1]), xz = literal(axis[0] * axis[2]), yz = literal(axis[1] * axis[2]);
+
+    return "(Eigen::Matrix3d() <<\n"
+        "            " + xx + " * (1 - c) + c, " + xy + " * (1 - c)" + sum(axis[2], "s") + ", " + xz + " * (1 - c)" + sum(-axis[1], "s") + ",\n"
+        "            " + xy + " * (1 - c)" + sum(-axis[2], "s") + ", " + yy + " * (1 - c) + c, " + yz + " * (1 - c)" + sum(axis[0], "s") + ",\n"
+        "            " + xz + " * (1 - c)" + sum(axis[1], "s") + ", " + yz + " * (1 - c)" + sum(-axis[0], "s") + ", " + zz + " * (1 - c) + c).finished()";
+}
+
+/*!
+ * Writes the header and source of a GeneratedDynamics plugin for a robot model.
+ */
+class DynamicsWriter
+{
+public:
+    DynamicsWriter(const RigidBodyDynamics::Model & robot, const std::string & qualifiedClassName,
+        const std::string & urdfName) :
+        robot(robot),
+        urdfName(urdfName),
+        numBodies(robot.mBodies.size())
+    {
+        size_t separator = qualifiedClassName.rfind("::");
+        if (separator == std::string::npos)
+            className = qualifiedClassName;
+        else
+        {
+            className = qualifiedClassName.substr(separator + 2);
+
+            std::string namespaces = qualifiedClassName.substr(0, separator);
+            size_t start = 0;
+            while (start <= namespaces.size())
+            {
+                size_t end = namespaces.find("::", start);
+                if (end == std::string::npos) end = namespaces.size();
+                namespaceNames.push_back(namespaces.substr(start, end - start));
+                start = end + 2;
+            }
+        }
+
+        // Precompute the constant properties of each body
+        revolute.assign(numBodies, false);
+        axis.assign(numBodies, Vector3d::Zero());
+        mass.assign(numBodies, 0);
+        moment.assign(numBodies, Vector3d::Zero());
+        inertia.assign(numBodies, Matrix3d::Zero());
+        subtreeHasMass.assign(numBodies, false);
+
+        for (size_t ii = 1; ii < numBodies; ii++)
+        {
+            revolute[ii] = robot.S[ii].head<3>().norm() > 0;
+            axis[ii] = revolute[ii] ? Vector3d(robot.S[ii].head<3>()) : Vector3d(robot.S[ii].tail<3>());
+
+            // Move the body's rotational inertia from its COM to its origin
+            const RigidBodyDynamics::Body & body = robot.mBodies[ii];
+            Vector3d com = body.mCenterOfMass;
+
+            mass[ii] = body.mMass;
+            moment[ii] = body.mMass * com;
+            inertia[ii] = body.mInertia
+                + body.mMass * (com.squaredNorm() * Matrix3d::Identity() - com * com.transpose());
+        }
+
+        for (size_t ii = numBodies - 1; ii > 0; ii--)
+        {
+            if (hasMass(ii))
+                subtreeHasMass[ii] = true;
+
+            if (subtreeHasMass[ii] && robot.lambda[ii] != 0)
+                subtreeHasMass[robot.lambda[ii]] = true;
+        }
+    }
+
+    void writeHeader(std::ostream & os) const
+    {
+        std::string guard = "__GENERATED_DYNAMICS_";
+        for (auto & name : namespaceNames) guard += toUpper(name) + "_";
+        guard += toUpper(className) + "_HPP__";
+
+        os << "// Generated by generate_dynamics from " << urdfName << ".  Do not edit.\n"
+           << "\n"
+           << "#ifndef " << guard << "\n"
+           << "#define " << guard << "\n"
+           << "\n"
+           << "#include <controlit/GeneratedDynamics.hpp>\n"
+           << "\n";
+
+        for (auto & name : namespaceNames) os << "namespace " << name << " {\n";
+
+        os << "\n"
+           << "/*!\n"
+           << " * The dynamics of the robot described by " << urdfName << ".\n"
+           << " */\n"
+           << "class " << className << " : public controlit::GeneratedDynamics\n"
+           << "{\n"
+           << "public:\n"
+           << "    " << className << "();\n"
+           << "\n"
+           << "    virtual unsigned int getNumDOFs() const { return NUM_DOFS; }\n"
+           << "\n"
+           << "    virtual void update(RigidBodyDynamics::Model & robot,\n"
+           << "        const RigidBodyDynamics::Math::VectorNd & Q,\n"
+           << "        const RigidBodyDynamics::Math::VectorNd & Qd,\n"
+           << "        const RigidBodyDynamics::Math::VectorNd & Qdd,\n"
+           << "        RigidBodyDynamics::Math::MatrixNd * H,\n"
+           << "        RigidBodyDynamics::Math::VectorNd & gravity,\n"
+           << "        RigidBodyDynamics::Math::VectorNd & coriolis);\n"
+           << "\n"
+           << "    EIGEN_MAKE_ALIGNED_OPERATOR_NEW\n"
+           << "\n"
+           << "protected:\n"
+           << "    virtual void getGeneratedModelData(const double * & data, size_t & size) const;\n"
+           << "\n"
+           << "    virtual void calcMovablePointJacobian(unsigned int bodyId,\n"
+           << "        const RigidBodyDynamics::Math::Vector3d & point,\n"
+           << "        RigidBodyDynamics::Math::MatrixNd & Jv, RigidBodyDynamics::Math::MatrixNd & Jw) const;\n"
+           << "\n"
+           << "private:\n"
+           << "    static const unsigned int NUM_BODIES = " << numBodies << ";\n"
+           << "    static const unsigned int NUM_DOFS = " << numBodies - 1 << ";\n"
+           << "\n"
+           << "    // The transform of each body relative to its parent and to the base\n"
+           << "    Eigen::Matrix3d E[NUM_BODIES];\n"
+           << "    Eigen::Vector3d r[NUM_BODIES];\n"
+           << "    Eigen::Matrix3d baseE[NUM_BODIES];\n"
+           << "    Eigen::Vector3d baseR[NUM_BODIES];\n"
+           << "\n"
+           << "    // The spatial velocity and acceleration of each body, and its\n"
+           << "    // acceleration when Qdd is zero\n"
+           << "    SpatialVector6d velocity[NUM_BODIES];\n"
+           << "    SpatialVector6d acceleration[NUM_BODIES];\n"
+           << "    SpatialVector6d biasAcceleration[NUM_BODIES];\n"
+           << "\n"
+           << "    // The spatial forces acting on each body due to gravity and due to its velocity\n"
+           << "    SpatialVector6d gravityForce[NUM_BODIES];\n"
+           << "    SpatialVector6d coriolisForce[NUM_BODIES];\n"
+           << "\n"
+           << "    // The composite rigid body inertias\n"
+           << "    double compositeMass[NUM_BODIES];\n"
+           << "    Eigen::Vector3d compositeMoment[NUM_BODIES];\n"
+           << "    Eigen::Matrix3d compositeInertia[NUM_BODIES];\n"
+           << "};\n"
+           << "\n";
+
+        for (auto it = namespaceNames.rbegin(); it != namespaceNames.rend(); it++)
+            os << "} // namespace " << *it << "\n";
+
+        os << "\n"
+           << "#endif // " << guard << "\n";
+    }
+
+    void writeSource(std::ostream & os, const std::string & headerName) const
+    {
+        std::string qualifiedName;
+        for (auto & name : namespaceNames) qualifiedName += name + "::";
+        qualifiedName += className;
+
+        os << "// Generated by generate_dynamics from " << urdfName << ".  Do not edit.\n"
+           << "\n"
+           << "#include \"" << headerName << "\"\n"
+           << "\n"
+           << "#include <cassert>\n"
+           << "#include <cmath>\n"
+           << "#include <pluginlib/class_list_macros.h>\n"
+           << "\n";
+
+        for (auto & name : namespaceNames) os << "namespace " << name << " {\n";
+        os << "\n";
+
+        writeModelData(os);
+        writeConstructor(os);
+        writeUpdate(os);
+        writeJacobian(os);
+
+        for (auto it = namespaceNames.rbegin(); it != namespaceNames.rend(); it++)
+            os << "} // namespace " << *it << "\n";
+
+        os << "\n"
+           << "PLUGINLIB_EXPORT_CLASS(" << qualifiedName << ", controlit::GeneratedDynamics);\n";
+    }
+
+private:
+    static std::string toUpper(std::string s)
+    {
+        for (auto & c : s) c = toupper(c);
+        return s;
+    }
+
+    bool hasMass(size_t body) const
+    {
+        return mass[body] != 0 || moment[body].norm() != 0 || inertia[body].norm() != 0;
+    }
+
+    std::string bodyComment(size_t body) const
+    {
+        std::string name = robot.GetBodyName(body);
+        std::ostringstream ss;
+        ss << "Body " << body;
+        if (!name.empty()) ss << " \"" << name << "\"";
+        ss << ", " << (revolute[body] ? "revolute" : "prismatic") << " joint " << body - 1
+           << ", parent " << robot.lambda[body];
+        return ss.str();
+    }
+
+    void writeModelData(std::ostream & os) const
+    {
+        std::vector<double> data;
+        controlit::GeneratedDynamics::getModelData(robot, data);
+
+        os << "namespace {\n"
+           << "\n"
+           << "// The model this code was generated from.  See GeneratedDynamics::getModelData(...).\n"
+           << "const double MODEL_DATA[] = {";
+        for (size_t ii = 0; ii < data.size(); ii++)
+            os << (ii % 8 == 0 ? "\n    " : " ") << literal(data[ii]) << (ii + 1 < data.size() ? "," : "");
+        os << "\n};\n"
+           << "\n"
+           << "} // namespace\n"
+           << "\n";
+    }
+
+    void writeConstructor(std::ostream & os) const
+    {
+        os << className << "::" << className << "()\n"
+           << "{\n"
+           << "    // The root body does not move\n"
+           << "    for (unsigned int ii = 0; ii < NUM_BODIES; ii++)\n"
+           << "    {\n"
+           << "        E[ii].setIdentity();\n"
+           << "        r[ii].setZero();\n"
+           << "        baseE[ii].setIdentity();\n"
+           << "        baseR[ii].setZero();\n"
+           << "        velocity[ii].setZero();\n"
+           << "        acceleration[ii].setZero();\n"
+           << "        biasAcceleration[ii].setZero();\n"
+           << "        gravityForce[ii].setZero();\n"
+           << "        coriolisForce[ii].setZero();\n"
+           << "        compositeMass[ii] = 0;\n"
+           << "        compositeMoment[ii].setZero();\n"
+           << "        compositeInertia[ii].setZero();\n"
+           << "    }\n"
+           << "}\n"
+           << "\n"
+           << "void " << className << "::getGeneratedModelData(const double * & data, size_t & size) const\n"
+           << "{\n"
+           << "    data = MODEL_DATA;\n"
+           << "    size = sizeof(MODEL_DATA) / sizeof(MODEL_DATA[0]);\n"
+           << "}\n"
+           << "\n";
+    }
+
+    void writeUpdate(std::ostream & os) const
+    {
+        os << "void " << className << "::update(RigidBodyDynamics::Model & robot,\n"
+           << "    const RigidBodyDynamics::Math::VectorNd & Q,\n"
+           << "    const RigidBodyDynamics::Math::VectorNd & Qd,\n"
+           << "    const RigidBodyDynamics::Math::VectorNd & Qdd,\n"
+           << "    RigidBodyDynamics::Math::MatrixNd * H,\n"
+           << "    RigidBodyDynamics::Math::VectorNd & gravity,\n"
+           << "    RigidBodyDynamics::Math::VectorNd & coriolis)\n"
+           << "{\n"
+           << "    assert(robot.mBodies.size() == NUM_BODIES);\n"
+           << "    assert(Q.size() == NUM_DOFS && Qd.size() == NUM_DOFS && Qdd.size() == NUM_DOFS);\n"
+           << "    assert(gravity.size() == NUM_DOFS && coriolis.size() == NUM_DOFS);\n"
+           << "\n"
+           << "    const Eigen::Vector3d g = robot.gravity;\n"
+           << "\n"
+           << "    // Forward pass: kinematics and the forces each body needs\n";
+
+        for (size_t ii = 1; ii < numBodies; ii++)
+            writeForwardBody(os, ii);
+
+        os << "    // Backward pass: project the forces onto the joints and accumulate them in the parent bodies\n";
+
+        for (size_t ii = numBodies - 1; ii > 0; ii--)
+            writeBackwardBody(os, ii);
+
+        os << "    if (H == NULL)\n"
+           << "        return;\n"
+           << "\n"
+           << "    H->setZero();\n"
+           << "\n"
+           << "    // The composite rigid body inertias start as the body inertias\n";
+
+        for (size_t ii = 1; ii < numBodies; ii++)
+        {
+            if (!subtreeHasMass[ii])
+                continue;
+
+            os << "    compositeMass[" << ii << "] = " << literal(mass[ii]) << ";\n"
+               << "    compositeMoment[" << ii << "] = " << literal(moment[ii]) << ";\n"
+               << "    compositeInertia[" << ii << "] = " << literal(inertia[ii]) << ";\n";
+        }
+
+        os << "\n"
+           << "    // Composite rigid body algorithm\n"
+           << "    SpatialVector6d F;\n"
+           << "\n";
+
+        for (size_t ii = numBodies - 1; ii > 0; ii--)
+            writeCompositeBody(os, ii);
+
+        os << "}\n"
+           << "\n";
+    }
+
+    void writeForwardBody(std::ostream & os, size_t ii) const
+    {
+        unsigned int lambda = robot.lambda[ii];
+        const Matrix3d & ET = robot.X_T[ii].E;
+        const Vector3d & rT = robot.X_T[ii].r;
+        bool identityET = ET == Matrix3d::Identity();
+        std::string i = std::to_string(ii);
+        std::string p = std::to_string(lambda);
+        std::string j = std::to_string(ii - 1);
+
+        os << "    // " << bodyComment(ii) << "\n"
+           << "    {\n";
+
+        // The transform from the parent, X_lambda = XJ * X_T
+        if (revolute[ii])
+        {
+            os << "        const double s = std::sin(Q[" << j << "]);\n"
+               << "        const double c = std::cos(Q[" << j << "]);\n"
+               << "        E[" << i << "] = " << jointRotation(axis[ii])
+               << (identityET ? "" : " * " + literal(ET)) << ";\n"
+               << "        r[" << i << "] = " << literal(rT) << ";\n";
+        }
+        else
+        {
+            Vector3d translation = ET.transpose() * axis[ii];
+            os << "        E[" << i << "] = " << (identityET ? "Eigen::Matrix3d::Identity()" : literal(ET)) << ";\n"
+               << "        r[" << i << "] = " << literal(rT) << " + Q[" << j << "] * " << literal(translation) << ";\n";
+        }
+
+        if (lambda == 0)
+        {
+            os << "        baseE[" << i << "] = E[" << i << "];\n"
+               << "        baseR[" << i << "] = r[" << i << "];\n";
+        }
+        else
+        {
+            os << "        baseE[" << i << "] = E[" << i << "] * baseE[" << p << "];\n"
+               << "        baseR[" << i << "] = baseR[" << p << "] + baseE[" << p << "].transpose() * r[" << i << "];\n";
+        }
+
+        // Velocities and accelerations
+        const SpatialVector & S = robot.S[ii];
+
+        os << "\n"
+           << "        SpatialVector6d vJ;\n"
+           << "        vJ << " << scaledSpatialVector(S, "Qd[" + j + "]") << ";\n"
+           << "        SpatialVector6d aJ;\n"
+           << "        aJ << " << scaledSpatialVector(S, "Qdd[" + j + "]") << ";\n";
+
+        if (lambda == 0)
+        {
+            os << "        velocity[" << i << "] = vJ;\n"
+               << "        SpatialVector6d bias = crossMotion(velocity[" << i << "], vJ);\n"
+               << "        biasAcceleration[" << i << "] = bias;\n"
+               << "        acceleration[" << i << "] = bias + aJ;\n";
+        }
+        else
+        {
+            os << "        velocity[" << i << "] = applyMotion(E[" << i << "], r[" << i << "], velocity[" << p << "]) + vJ;\n"
+               << "        SpatialVector6d bias = crossMotion(velocity[" << i << "], vJ);\n"
+               << "        biasAcceleration[" << i << "] = applyMotion(E[" << i << "], r[" << i << "], biasAcceleration[" << p << "]) + bias;\n"
+               << "        acceleration[" << i << "] = applyMotion(E[" << i << "], r[" << i << "], acceleration[" << p << "]) + bias + aJ;\n";
+        }
+
+        os << "\n"
+           << "        robot.X_lambda[" << i << "].E = E[" << i << "];\n"
+           << "        robot.X_lambda[" << i << "].r = r[" << i << "];\n"
+           << "        robot.X_base[" << i << "].E = baseE[" << i << "];\n"
+           << "        robot.X_base[" << i << "].r = baseR[" << i << "];\n"
+           << "        robot.v[" << i << "] = velocity[" << i << "];\n"
+           << "        robot.c[" << i << "] = bias;\n"
+           << "        robot.a[" << i << "] = acceleration[" << i << "];\n";
+
+        // Body forces.  Gravity is an upward acceleration of the root body.
+        if (hasMass(ii))
+        {
+            os << "\n"
+               << "        const double mass = " << literal(mass[ii]) << ";\n"
+               << "        const Eigen::Vector3d h = " << literal(moment[ii]) << ";\n"
+               << "        const Eigen::Matrix3d I = " << literal(inertia[ii]) << ";\n"
+               << "\n"
+               << "        SpatialVector6d gravityAcceleration;\n"
+               << "        gravityAcceleration.head<3>().setZero();\n"
+               << "        gravityAcceleration.tail<3>() = -(baseE[" << i << "] * g);\n"
+               << "\n"
+               << "        gravityForce[" << i << "] = multiplyInertia(mass, h, I, gravityAcceleration);\n"
+               << "        coriolisForce[" << i << "] = multiplyInertia(mass, h, I, biasAcceleration[" << i << "])\n"
+               << "            + crossForce(velocity[" << i << "], multiplyInertia(mass, h, I, velocity[" << i << "]));\n";
+        }
+        else
+        {
+            os << "\n"
+               << "        gravityForce[" << i << "].setZero();\n"
+               << "        coriolisForce[" << i << "].setZero();\n";
+        }
+
+        os << "    }\n"
+           << "\n";
+    }
+
+    void writeBackwardBody(std::ostream & os, size_t ii) const
+    {
+        unsigned int lambda = robot.lambda[ii];
+        std::string i = std::to_string(ii);
+        std::string p = std::to_string(lambda);
+
+        os << "    // " << bodyComment(ii) << "\n"
+           << "    gravity[" << ii - 1 << "] = " << dot(robot.S[ii], "gravityForce[" + i + "]") << ";\n"
+           << "    coriolis[" << ii - 1 << "] = " << dot(robot.S[ii], "coriolisForce[" + i + "]") << ";\n";
+
+        if (lambda != 0)
+        {
+            os << "    gravityForce[" << p << "] += applyForceTranspose(E[" << i << "], r[" << i << "], gravityForce[" << i << "]);\n"
+               << "    coriolisForce[" << p << "] += applyForceTranspose(E[" << i << "], r[" << i << "], coriolisForce[" << i << "]);\n";
+        }
+
+        os << "\n";
+    }
+
+    void writeCompositeBody(std::ostream & os, size_t ii) const
+    {
+        // Bodies without mass in their subtree do not contribute to H
+        if (!subtreeHasMass[ii])
+            return;
+
+        unsigned int lambda = robot.lambda[ii];
+        std::string i = std::to_string(ii);
+        std::string j = std::to_string(ii - 1);
+
+        // All of this body's descendants have been added to its composite inertia
+        os << "    // " << bodyComment(ii) << "\n"
+           << "    F = multiplyInertia(compositeMass[" << i << "], compositeMoment[" << i << "], compositeInertia[" << i << "],\n"
+           << "        (SpatialVector6d() << " << spatialLiteral(robot.S[ii]) << ").finished());\n"
+           << "    (*H)(" << j << ", " << j << ") = " << dot(robot.S[ii], "F") << ";\n";
+
+        unsigned int jj = ii;
+        while (robot.lambda[jj] != 0)
+        {
+            os << "    F = applyForceTranspose(E[" << jj << "], r[" << jj << "], F);\n";
+            jj = robot.lambda[jj];
+            os << "    (*H)(" << j << ", " << jj - 1 << ") = (*H)(" << jj - 1 << ", " << j << ") = "
+               << dot(robot.S[jj], "F") << ";\n";
+        }
+
+        if (lambda != 0)
+        {
+            os << "    addChildInertia(E[" << i << "], r[" << i << "],\n"
+               << "        compositeMass[" << i << "], compositeMoment[" << i << "], compositeInertia[" << i << "],\n"
+               << "        compositeMass[" << lambda << "], compositeMoment[" << lambda << "], compositeInertia[" << lambda << "]);\n";
+        }
+
+        os << "\n";
+    }
+
+    void writeJacobian(std::ostream & os) const
+    {
+        os << "void " << className << "::calcMovablePointJacobian(unsigned int bodyId,\n"
+           << "    const RigidBodyDynamics::Math::Vector3d & point,\n"
+           << "    RigidBodyDynamics::Math::MatrixNd & Jv, RigidBodyDynamics::Math::MatrixNd & Jw) const\n"
+           << "{\n"
+           << "    Jv.setZero(3, NUM_DOFS);\n"
+           << "    Jw.setZero(3, NUM_DOFS);\n"
+           << "\n"
+           << "    switch (bodyId)\n"
+           << "    {\n";
+
+        for (size_t ii = 1; ii < numBodies; ii++)
+        {
+            os << "        case " << ii << ":\n"
+               << "        {\n";
+
+            // The point only enters the columns of revolute joints
+            bool hasRevoluteAncestor = false;
+            for (unsigned int jj = ii; jj != 0; jj = robot.lambda[jj])
+                hasRevoluteAncestor = hasRevoluteAncestor || revolute[jj];
+
+            if (hasRevoluteAncestor)
+                os << "            const Eigen::Vector3d p = baseR[" << ii << "] + baseE[" << ii << "].transpose() * point;\n";
+
+            os << "            Eigen::Vector3d axis;\n";
+
+            // Only the joints between the body and the root move the point
+            for (unsigned int jj = ii; jj != 0; jj = robot.lambda[jj])
+            {
+                std::string baseAxis;
+                int unit = unitAxis(axis[jj]);
+                if (unit >= 0)
+                    baseAxis = "baseE[" + std::to_string(jj) + "].row(" + std::to_string(unit) + ").transpose()";
+                else
+                    baseAxis = "baseE[" + std::to_string(jj) + "].transpose() * " + literal(axis[jj]);
+
+                os << "            axis = " << baseAxis << ";\n";
+
+                if (revolute[jj])
+                {
+                    os << "            Jw.col(" << jj - 1 << ") = axis;\n"
+                       << "            Jv.col(" << jj - 1 << ") = axis.cross(p - baseR[" << jj << "]);\n";
+                }
+                else
+                    os << "            Jv.col(" << jj - 1 << ") = axis;\n";
+            }
+
+            os << "            break;\n"
+               << "        }\n";
+        }
+
+        os << "        default:\n"
+           << "            break;\n"
+           << "    }\n"
+           << "}\n"
+           << "\n";
+    }
+
+    const RigidBodyDynamics::Model & robot;
+    std::string urdfName;
+    std::string className;
+    std::vector<std::string> namespaceNames;
+
+    size_t numBodies;
+    std::vector<bool> revolute;
+    std::vector<Vector3d> axis;
+    std::vector<double> mass;
+    std::vector<Vector3d> moment;
+    std::vector<Matrix3d> inertia;
+    std::vector<bool> subtreeHasMass;
+};
+
+} // namespace
+
+int main (int argc, char *argv[])
+{
+    // Input file to parse
+    std::string filename;
+    std::string qualifiedClassName;
+    std::string outputDir;
+
+    // Generic options
+    po::options_description generic("Generic options");
+    generic.add_options()
+        ("help",                "produce help message")
+        ("verbose,v",           "enable additional output")
+    ;
+
+    // Configuration options
+    po::options_description config("Configuration");
+    config.add_options()
+        ("class,c",      po::value<std::string>(&qualifiedClassName)->default_value("GeneratedRobotDynamics"),
+                         "the name of the generated class including its namespaces")
+        ("output-dir,o", po::value<std::string>(&outputDir)->default_value("."),
+                         "the directory in which to write the generated header and source")
+    ;
+
+    // Hidden options
+    po::options_description hidden("Hidden options");
+    hidden.add_options()
+        ("input-file",          po::value<std::string>(&filename),  "input file")
+    ;
+
+    // Declare the position options
+    po::positional_options_description p;
+    p.add("input-file", -1);
+
+    // Concatenate options together
+    po::options_description cmdline_options;
+    cmdline_options.add(generic).add(config).add(hidden);
+
+    po::options_description visible("Allowed options");
+    visible.add(generic).add(config);
+
+    // Parse command line arguments
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc, argv).
+        options(cmdline_options).positional(p).run(), vm);
+    po::notify(vm);
+
+    if (vm.count("help"))
+    {
+        usage();
+        std::cout << visible << std::endl;
+        return 1;
+    }
+
+    if (!vm.count("input-file"))
+    {
+        std::cerr << "Please specify and input file." << std::endl;
+        std::cout << std::endl;
+        usage();
+        return -1;
+    }
+
+    // Get verbosity
+    bool verbose = false;
+    if (vm.count("verbose")) verbose = true;
+
+    RigidBodyDynamics::Model robot;
+
+    std::map<std::string, std::string> l2jmap;
+
+    if (!controlit::rbdl_robot_urdfreader::read_urdf_model_from_file(filename, &robot, &l2jmap, verbose))
+    {
+        std::cerr << "Loading of urdf robot failed!" << std::endl;
+        return -1;
+    }
+
+    std::vector<double> modelData;
+    if (!controlit::GeneratedDynamics::getModelData(robot, modelData))
+    {
+        std::cerr << "The robot model contains joints that are not supported by generated dynamics.  "
+                     "Only single-DOF revolute and prismatic joints are supported." << std::endl;
+        return -1;
+    }
+
+    std::string className = qualifiedClassName.substr(qualifiedClassName.rfind(':') + 1);
+    std::string urdfName = filename.substr(filename.rfind('/') + 1);
+    std::string headerName = className + ".hpp";
+
+    DynamicsWriter writer(robot, qualifiedClassName, urdfName);
+
+    std::ofstream header((outputDir + "/" + headerName).c_str());
+    writer.writeHeader(header);
+
+    std::ofstream source((outputDir + "/" + className + ".cpp").c_str());
+    writer.writeSource(source, headerName);
+
+    if (!header || !source)
+    {
+        std::cerr << "Unable to write the generated code to " << outputDir << std::endl;
+        return -1;
+    }
+
+    if (verbose)
+        std::cout << "Generated " << qualifiedClassName << " in " << outputDir << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <ros/package.h> // for ros::package::getPath(...)
+#include <ros/ros.h>
+
+#include <controlit/BatchEvaluator.hpp>
+#include <controlit/logging/RealTimeLogging.hpp>
+
+using controlit::BatchEvaluator;
+using controlit::BatchInput;
+using controlit::BatchOutput;
+using controlit::addons::eigen::Matrix;
+
+#define CONTROLLER_TYPE "controlit_wbc/WBOSC"
+#define GOAL_PARAMETER "JPosTask.goalPosition"
+#define NUM_SAMPLES 23
+
+class BatchEvaluatorTest : public ::testing::Test
+{
+protected:
+
+    std::string readFileInPackage(std::string packageName, std::string filePath)
+    {
+        std::string packageDir = ros::package::getPath(packageName);
+
+        if (packageDir.compare("") == 0)
+        {
+            CONTROLIT_ERROR << "Could not find package \"" << packageName << "\"!";
+            return "";
+        }
+
+        std::ifstream file(packageDir + filePath);
+        if (!file.is_open())
+        {
+            CONTROLIT_ERROR << "Unable to open file " << packageDir << filePath;
+            return "";
+        }
+
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    }
+
+    virtual void SetUp()
+    {
+        // The evaluators keep their parameters on the parameter server that
+        // rostest starts
+        if (!ros::isInitialized())
+        {
+            int argc = 0;
+            ros::init(argc, NULL, "BatchEvaluatorTest");
+        }
+
+        robotDescription = readFileInPackage("controlit_core", "/tests/core/testData/TorqueControllerTest_V1_pinned_wbc.urdf");
+        parameters = readFileInPackage("controlit_core", "/tests/core/testData/TorqueControllerTest_Parameters_CartPos.yaml");
+
+        ASSERT_FALSE(robotDescription.empty());
+        ASSERT_FALSE(parameters.empty());
+    }
+
+    /*!
+     * Initializes an evaluator from parameters in its own namespace so that
+     * several evaluators can exist at the same time.
+     */
+    bool initEvaluator(BatchEvaluator & evaluator, size_t numWorkers,
+        const std::string & yamlParameters, const std::string & controllerType = CONTROLLER_TYPE)
+    {
+        std::stringstream ns;
+        ns << "batch_evaluator_test_" << namespaceCount++;
+
+        ros::NodeHandle nh(ns.str());
+        nh.setParam("controlit/robot_description", robotDescription);
+        nh.setParam("controlit/parameters", yamlParameters);
+        nh.setParam("controlit/servo_clock_type", "controlit_servo_clock/ServoClockChrono");
+        nh.setParam("controlit/servo_frequency", 1000.0);
+        nh.setParam("controlit/robot_interface_type", "");
+        nh.setParam("controlit/whole_body_controller_type", controllerType);
+
+        return evaluator.init(nh, numWorkers);
+    }
+
+    /*!
+     * Creates a batch of small random joint states and joint position goals.
+     */
+    void createInput(BatchEvaluator & evaluator, BatchInput & input)
+    {
+        std::srand(0);
+
+        input.Q = 0.2 * Matrix::Random(evaluator.getNumDOFs(), NUM_SAMPLES);
+        input.Qd = 0.5 * Matrix::Random(evaluator.getNumDOFs(), NUM_SAMPLES);
+        input.goals.assign(1, 0.3 * Matrix::Random(evaluator.getNumActuatedDOFs(), NUM_SAMPLES));
+    }
+
+    std::string robotDescription;
+    std::string parameters;
+    int namespaceCount = 0;
+};
+
+TEST_F(BatchEvaluatorTest, OutputIndependentOfNumWorkers)
+{
+    BatchEvaluator single, parallel;
+    ASSERT_TRUE(initEvaluator(single, 1, parameters));
+    ASSERT_TRUE(initEvaluator(parallel, 4, parameters));
+    ASSERT_TRUE(single.addGoalParameter(GOAL_PARAMETER));
+    ASSERT_TRUE(parallel.addGoalParameter(GOAL_PARAMETER));
+
+    BatchInput input;
+    createInput(single, input);
+
+    BatchOutput singleOutput, parallelOutput;
+    ASSERT_TRUE(single.evaluate(input, singleOutput));
+    ASSERT_TRUE(parallel.evaluate(input, parallelOutput));
+
+    for (size_t ii = 0; ii < NUM_SAMPLES; ii++)
+    {
+        EXPECT_TRUE(singleOutput.success[ii]) << "Sample " << ii << " failed";
+        EXPECT_TRUE(parallelOutput.success[ii]) << "Sample " << ii << " failed";
+    }
+
+    EXPECT_LT((singleOutput.effort - parallelOutput.effort).cwiseAbs().maxCoeff(), 1e-9)
+        << "Single worker:\n" << singleOutput.effort << "\nFour workers:\n" << parallelOutput.effort;
+
+    // Reversing the samples changes which samples each worker evaluates
+    // and in which order, which must not change their results.
+    BatchInput reversed;
+    reversed.Q = input.Q.rowwise().reverse();
+    reversed.Qd = input.Qd.rowwise().reverse();
+    reversed.goals.assign(1, input.goals[0].rowwise().reverse());
+
+    BatchOutput reversedOutput;
+    ASSERT_TRUE(parallel.evaluate(reversed, reversedOutput));
+
+    EXPECT_LT((singleOutput.effort - reversedOutput.effort.rowwise().reverse()).cwiseAbs().maxCoeff(), 1e-9);
+}
+
+TEST_F(BatchEvaluatorTest, InvalidInit)
+{
+    BatchEvaluator zeroWorkers;
+    EXPECT_FALSE(initEvaluator(zeroWorkers, 0, parameters));
+
+    BatchEvaluator evaluator;
+    ASSERT_TRUE(initEvaluator(evaluator, 2, parameters));
+    EXPECT_FALSE(initEvaluator(evaluator, 2, parameters)) << "Initialized twice";
+}
+
+TEST_F(BatchEvaluatorTest, RejectsStatefulConfigurations)
+{
+    BatchEvaluator impedance;
+    EXPECT_FALSE(initEvaluator(impedance, 2, parameters, "controlit_wbc/WBOSC_Impedance"));
+
+    // Enable the integral term of the joint position task.
+    std::string taskHeader = "name: JPosTask     # Arbitrary instance name\n    parameters:\n";
+    size_t pos = parameters.find(taskHeader);
+    ASSERT_NE(pos, std::string::npos);
+
+    std::string integralParameters = parameters;
+    integralParameters.insert(pos + taskHeader.size(),
+        "      - name: integralOn\n"
+        "        type: integer\n"
+        "        value: 1\n"
+        "      - name: integralPeriod\n"
+        "        type: real\n"
+        "        value: 0.01\n"
+        "      - name: dt\n"
+        "        type: real\n"
+        "        value: 0.001\n");
+
+    BatchEvaluator integral;
+    EXPECT_FALSE(initEvaluator(integral, 2, integralParameters));
+}
+
+TEST_F(BatchEvaluatorTest, InvalidGoalParameters)
+{
+    BatchEvaluator uninitialized;
+    EXPECT_FALSE(uninitialized.addGoalParameter(GOAL_PARAMETER));
+
+    BatchEvaluator evaluator;
+    ASSERT_TRUE(initEvaluator(evaluator, 2, parameters));
+
+    EXPECT_FALSE(evaluator.addGoalParameter("JPosTask.noSuchParameter"));
+    EXPECT_FALSE(evaluator.addGoalParameter("JPosTask.tare")) << "Accepted an integer goal";
+    EXPECT_TRUE(evaluator.addGoalParameter(GOAL_PARAMETER));
+}
+
+TEST_F(BatchEvaluatorTest, InvalidInput)
+{
+    BatchEvaluator evaluator;
+    BatchInput input;
+    BatchOutput output;
+
+    EXPECT_FALSE(evaluator.evaluate(input, output)) << "Evaluated without being initialized";
+
+    ASSERT_TRUE(initEvaluator(evaluator, 2, parameters));
+    ASSERT_TRUE(evaluator.addGoalParameter(GOAL_PARAMETER));
+
+    createInput(evaluator, input);
+    ASSERT_TRUE(evaluator.evaluate(input, output));
+
+    BatchInput invalid = input;
+    invalid.Q = input.Q.topRows(evaluator.getNumDOFs() - 1);
+    EXPECT_FALSE(evaluator.evaluate(invalid, output)) << "Accepted positions with too few rows";
+
+    invalid = input;
+    invalid.Qd = input.Qd.leftCols(NUM_SAMPLES - 1);
+    EXPECT_FALSE(evaluator.evaluate(invalid, output)) << "Accepted fewer velocities than positions";
+
+    invalid = input;
+    invalid.goals.clear();
+    EXPECT_FALSE(evaluator.evaluate(invalid, output)) << "Accepted a missing goal";
+
+    invalid = input;
+    invalid.goals[0] = input.goals[0].topRows(3);
+    EXPECT_FALSE(evaluator.evaluate(invalid, output)) << "Accepted goals of the wrong size";
+
+    invalid = input;
+    invalid.goals[0] = input.goals[0].leftCols(1);
+    EXPECT_FALSE(evaluator.evaluate(invalid, output)) << "Accepted goals for too few samples";
+}
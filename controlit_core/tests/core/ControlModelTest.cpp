@@ -1,32 +1,33 @@
 #include <gtest/gtest.h>
-#include <resource_retriever/retriever.h>
+
+#include <fstream>
+#include <sstream>
+#include <tuple>
+#include <boost/math/constants/constants.hpp>
 
 #include <controlit/RobotState.hpp>
 #include <controlit/ControlModel.hpp>
+#include <controlit/ModelPredictor.hpp>
 #include <controlit/utility/ControlItParameters.hpp>
 
-// #include <drc/common/math_utilities.hpp>
-
 using controlit::utility::ControlItParameters;
+using controlit::addons::eigen::Vector;
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Matrix3d;
+using controlit::addons::eigen::Quaternion;
 
-bool loadResource(std::string const& resourceUrl, std::string& contents)
+bool loadFile(std::string const& fileName, std::string& contents)
 {
-    resource_retriever::MemoryResource resource;
-
-    try
-    {
-        resource_retriever::Retriever r;
-        resource = r.get(resourceUrl);
-    }
-    catch (resource_retriever::Exception& e)
+    std::ifstream file(fileName.c_str());
+    if (!file.is_open())
     {
-        CONTROLIT_WARN << "Failed to retrieve file: " << resourceUrl;
+        CONTROLIT_WARN << "Failed to open file: " << fileName;
         return false;
     }
 
-    // Convert loaded resource to string
-    contents.resize(resource.size);
-    memcpy(&contents[0], resource.data.get(), resource.size);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
 
     return true;
 }
@@ -86,7 +87,7 @@ struct TestData
     };
 };
 
-bool testQuaternionEquality(drc::common::Quaternion const& q1, drc::common::Quaternion const& q2)
+bool testQuaternionEquality(Quaternion const& q1, Quaternion const& q2)
 {
     if ((q1.w() > 0 && q2.w() > 0) ||
         (q1.w() <= 0 && q2.w() <= 0))
@@ -115,7 +116,7 @@ bool testQuaternionEquality(drc::common::Quaternion const& q1, drc::common::Quat
     return false;
 }
 
-bool testVectorEquality(drc::common::Vector const& x1, drc::common::Vector const& x2)
+bool testVectorEquality(Vector const& x1, Vector const& x2)
 {
     if (x1.rows() != x2.rows())
     {
@@ -140,20 +141,17 @@ protected:
     virtual void SetUp()
     {
         // Load the robot description
-        std::string robotDescriptionUri = "package://controlit/tests/core/testData/controlModel_robotDescription.urdf";
+        std::string robotDescriptionFile = PROJECT_SOURCE_DIR "/tests/core/testData/controlModel_robotDescription.urdf";
         std::string robotDescription;
-        EXPECT_TRUE(controlit::addons::ros::loadResource(robotDescriptionUri, robotDescription))
-            << "Failed to load resource '" << robotDescriptionUri << "'";
-
-        // Instantiate a ControlItParameters object
-        ControlItParameters controlitParams;
+        ASSERT_TRUE(loadFile(robotDescriptionFile, robotDescription))
+            << "Failed to load file '" << robotDescriptionFile << "'";
 
         // Create a control model
         robotState.reset(new controlit::RobotState());
-        controlModel.reset(controlit::ControlModel::createModel(robotDescription, "", robotState, &controlitParams));
-        EXPECT_TRUE(controlModel.get() != nullptr) << "ControlModel::createModel() returned a NULL pointer.";
+        controlModel.reset(controlit::ControlModel::createModel(robotDescription, "", robotState.get(), &controlitParams));
+        ASSERT_TRUE(controlModel.get() != nullptr) << "ControlModel::createModel() returned a NULL pointer.";
 
-        robotState->init(controlModel->getNActuableDOFs());
+        robotState->init(controlModel->getRealJointNamesVector());
 
         // Get the 'rigid6DoF' body ID
         bodyId = controlModel->rbdlModel().GetBodyId("rigid6DoF");
@@ -166,6 +164,7 @@ protected:
     {
     }
 
+    ControlItParameters controlitParams;
     std::shared_ptr<controlit::RobotState> robotState;
     std::shared_ptr<controlit::ControlModel> controlModel;
 
@@ -192,24 +191,24 @@ TEST_F(ControlModelTest, VirtualLinkOrientationTest)
         // NOTE: Creating this data is independent of the Euler sequence convention used by ControlModel,
         // the URDF -> RBLD parser, or your grandmother. Just want to create an arbitrary quaternion as
         // if it came from an IMU.
-        drc::common::Quaternion quat_testcase = Eigen::AngleAxisd(a1, Eigen::Vector3d::UnitZ())
+        Quaternion quat_testcase = Eigen::AngleAxisd(a1, Eigen::Vector3d::UnitZ())
                             * Eigen::AngleAxisd(a2, Eigen::Vector3d::UnitX())
                             * Eigen::AngleAxisd(a3, Eigen::Vector3d::UnitZ());
 
         // Give the control model the desired orientation
-        robotState->setRobotBaseState(Eigen::Vector3d::Zero(), quat_testcase, drc::common::Vector::Zero(6));
+        robotState->setRobotBaseState(Eigen::Vector3d::Zero(), quat_testcase, Vector::Zero(6));
         controlModel->updateJointState();
         controlModel->update();
 
         // Now ask RBDL for the orientation of the rigid6Dof body.
-        drc::common::Matrix3d R_rbdl = RigidBodyDynamics::CalcBodyWorldOrientation(controlModel->rbdlModel(),
+        Matrix3d R_rbdl = RigidBodyDynamics::CalcBodyWorldOrientation(controlModel->rbdlModel(),
             controlModel->getQ(), bodyId, false);
 
         // NOTE! RBDL returns NOT the transform of the body coordinates in the world frame but the transpose..
         // so the other way around. It returns the world frame w.r.t the body frame. Retarded.
         // Or said in another retarded way, it uses a right (or left handed?) notation. Who cares... non-conventional.
         // So compute its transpose before computing the quaternion to do the check.
-        drc::common::Quaternion quat_rbdl( R_rbdl.transpose() );
+        Quaternion quat_rbdl( R_rbdl.transpose() );
 
         EXPECT_TRUE( testQuaternionEquality(quat_testcase, quat_rbdl) ) << "Failed test case " << testNumber++ << std::endl
            << "    quat_testcase: " << quat_testcase.w() << ", " << quat_testcase.x() << ", " << quat_testcase.y() << ", " << quat_testcase.z() << std::endl
@@ -232,7 +231,7 @@ TEST_F(ControlModelTest, VirtualLinkAngularVelocityTest)
         // NOTE: Creating this data is independent of the Euler sequence convention used by ControlModel,
         // the URDF -> RBLD parser, or your grandmother. Just want to create an arbitrary quaternion as
         // if it came from an IMU.
-        drc::common::Quaternion quat_testcase = Eigen::AngleAxisd(a1, Eigen::Vector3d::UnitZ())
+        Quaternion quat_testcase = Eigen::AngleAxisd(a1, Eigen::Vector3d::UnitZ())
                             * Eigen::AngleAxisd(a2, Eigen::Vector3d::UnitX())
                             * Eigen::AngleAxisd(a3, Eigen::Vector3d::UnitZ());
 
@@ -242,7 +241,7 @@ TEST_F(ControlModelTest, VirtualLinkAngularVelocityTest)
         TestData::AngularVelocity w1(0), w2(0), w3(0);
         std::tie(v1, v2, v3, w1, w2, w3) = twistData;
 
-        drc::common::Vector x_dot_test = drc::common::Vector::Zero(6);
+        Vector x_dot_test = Vector::Zero(6);
         x_dot_test(0) = v1;
         x_dot_test(1) = v2;
         x_dot_test(2) = v3;
@@ -256,21 +255,66 @@ TEST_F(ControlModelTest, VirtualLinkAngularVelocityTest)
         controlModel->update();
 
         // To check, we will get the jacobian and compute what we sent in.
-        drc::common::Matrix Jv(3, controlModel->getNumDOFs());
+        Matrix Jv(3, controlModel->getNumDOFs());
         RigidBodyDynamics::CalcPointJacobian(controlModel->rbdlModel(),
             controlModel->getQ(), bodyId, Eigen::Vector3d::Zero(), Jv, false);
-        drc::common::Matrix Jw(3, controlModel->getNumDOFs());
+        Matrix Jw(3, controlModel->getNumDOFs());
         RigidBodyDynamics::CalcPointJacobianW(controlModel->rbdlModel(),
             controlModel->getQ(), bodyId, Eigen::Vector3d::Zero(), Jw, false);
 
-        drc::common::Matrix J(6, controlModel->getNumDOFs());
+        Matrix J(6, controlModel->getNumDOFs());
         J.topRows(3) = Jv;
         J.bottomRows(3) = Jw;
-        drc::common::Vector x_dot_check = J * controlModel->getQd();
+        Vector x_dot_check = J * controlModel->getQd();
 
         EXPECT_TRUE(x_dot_test.isApprox(x_dot_check, 1e-6))
             << "Failed test case " << testNumber++ << std::endl
             << "    x_dot_test: " << x_dot_test.transpose() << std::endl
             << "    x_dot_check: " << x_dot_check.transpose() << std::endl;
     }
-}
\ No newline at end of file
+}
+
+TEST_F(ControlModelTest, PartialUpdateDiscardsPredictedValues)
+{
+    robotState->setRobotBaseState(Eigen::Vector3d::Zero(), Quaternion::Identity(),
+        Vector::Zero(6));
+    controlModel->updateJointState();
+    controlModel->update();
+
+    // The values of a FULL update
+    Vector Q = controlModel->getQ();
+    Vector grav = controlModel->getGrav();
+    Matrix UNcBar = controlModel->constraints().getUNcBar();
+    Matrix UNcAiNorm = controlModel->constraints().getUNcAiNorm();
+
+    // Give the predictor snapshots that change linearly along dQ, ending one
+    // step before Q at the FULL update's values.  It extrapolates to Q and
+    // overwrites the model with the FULL update's values plus one.
+    controlit::ModelPredictor predictor;
+    predictor.init(controlModel->getNumDOFs(), controlModel->getNActuableDOFs(), 1.0);
+
+    Vector dQ = Vector::Zero(Q.size());
+    dQ(0) = 0.01;
+
+    for (int ii = 5; ii > 0; ii--)
+    {
+        predictor.addSnapshot(Q - ii * dQ,
+            grav - (ii - 1) * Vector::Ones(grav.size()),
+            UNcBar - (ii - 1) * Matrix::Ones(UNcBar.rows(), UNcBar.cols()),
+            UNcAiNorm - (ii - 1) * Matrix::Ones(UNcAiNorm.rows(), UNcAiNorm.cols()));
+    }
+
+    ASSERT_TRUE(predictor.isApplied());
+
+    predictor.predict(*controlModel);
+    ASSERT_TRUE(controlModel->hasPredictedValues());
+    EXPECT_FALSE(controlModel->constraints().getUNcBar().isApprox(UNcBar));
+
+    // A PARTIAL update must not keep the predicted projection matrices
+    controlModel->updateGravity();
+
+    EXPECT_FALSE(controlModel->hasPredictedValues());
+    EXPECT_TRUE(controlModel->getGrav().isApprox(grav));
+    EXPECT_TRUE(controlModel->constraints().getUNcBar().isApprox(UNcBar));
+    EXPECT_TRUE(controlModel->constraints().getUNcAiNorm().isApprox(UNcAiNorm));
+}
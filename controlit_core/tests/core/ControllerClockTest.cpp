@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <controlit/ControllerClock.hpp>
+#include <controlit/TimerSimulated.hpp>
+
+using controlit::ControllerClock;
+using controlit::TimerSimulated;
+
+TEST(ControllerClockTest, SimulatedTime)
+{
+    ControllerClock::setSimulated(true);
+
+    EXPECT_TRUE(ControllerClock::isSimulated());
+    EXPECT_EQ(0, ControllerClock::getSimulatedTime());
+
+    TimerSimulated timer;
+    timer.start();
+
+    ControllerClock::setSimulatedTime(2500000);
+
+    EXPECT_DOUBLE_EQ(0.0025, ControllerClock::getTime());
+    EXPECT_DOUBLE_EQ(0.0025, timer.getTime());
+    EXPECT_EQ(2500000, std::chrono::duration_cast<std::chrono::nanoseconds>(
+        ControllerClock::now().time_since_epoch()).count());
+
+    // The simulated time restarts at zero
+    ControllerClock::setSimulated(false);
+    ControllerClock::setSimulated(true);
+    EXPECT_EQ(0, ControllerClock::getSimulatedTime());
+
+    ControllerClock::setSimulated(false);
+}
+
+TEST(ControllerClockTest, WallTime)
+{
+    ControllerClock::setSimulated(false);
+
+    // The simulated time is ignored while the wall clock is used
+    ControllerClock::setSimulatedTime(1000000000);
+
+    double startTime = ControllerClock::getTime();
+    EXPECT_GT(startTime, 0);
+    EXPECT_GE(ControllerClock::getTime(), startTime);
+}
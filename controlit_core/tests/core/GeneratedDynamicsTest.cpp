@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <rbdl/rbdl.h>
+#include <controlit_robot_models/rbdl_robot_urdfreader.hpp>
+#include <controlit/GeneratedDynamics.hpp>
+
+// Generated at build time from GENERATED_DYNAMICS_TEST_URDF by generate_dynamics
+#include "TestRobotDynamics.hpp"
+
+#include <cstdlib>
+
+using RigidBodyDynamics::Math::Vector3d;
+using RigidBodyDynamics::Math::VectorNd;
+using RigidBodyDynamics::Math::MatrixNd;
+
+/*----------------------------------------------------------------------------
+ * Generated dynamics tests
+ *--------------------------------------------------------------------------*/
+class GeneratedDynamicsTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    std::map<std::string, std::string> l2jmap;
+    ASSERT_TRUE(controlit::rbdl_robot_urdfreader::read_urdf_model_from_file(
+      GENERATED_DYNAMICS_TEST_URDF, &model, &l2jmap, false));
+
+    srand(0);
+  }
+
+  double random() { return 2.0 * rand() / RAND_MAX - 1.0; }
+
+  RigidBodyDynamics::Model model;
+  controlit_test::TestRobotDynamics generatedDynamics;
+};
+
+TEST_F(GeneratedDynamicsTest, MatchesModel)
+{
+  EXPECT_EQ(generatedDynamics.getNumDOFs(), model.dof_count);
+  EXPECT_TRUE(generatedDynamics.matches(model));
+
+  // A changed inertial parameter means the code must be regenerated
+  model.mBodies[model.mBodies.size() - 1].mMass += 0.1;
+  EXPECT_FALSE(generatedDynamics.matches(model));
+}
+
+TEST_F(GeneratedDynamicsTest, ConsistentWithRBDL)
+{
+  size_t numDOFs = model.dof_count;
+  VectorNd zero = VectorNd::Zero(numDOFs);
+
+  for (int trial = 0; trial < 100; trial++)
+  {
+    VectorNd Q(numDOFs), Qd(numDOFs), Qdd(numDOFs);
+    for (size_t ii = 0; ii < numDOFs; ii++)
+    {
+      Q[ii] = 3 * random();
+      Qd[ii] = random();
+      Qdd[ii] = random();
+    }
+
+    // Compute the expected values using RBDL
+    MatrixNd expectedA = MatrixNd::Zero(numDOFs, numDOFs);
+    RigidBodyDynamics::CompositeRigidBodyAlgorithm(model, Q, expectedA, true);
+
+    VectorNd expectedGrav(numDOFs), expectedCoriolis(numDOFs);
+    RigidBodyDynamics::InverseDynamics(model, Q, zero, zero, expectedGrav);
+    RigidBodyDynamics::InverseDynamics(model, Q, Qd, zero, expectedCoriolis);
+    expectedCoriolis -= expectedGrav;
+
+    RigidBodyDynamics::UpdateKinematicsCustom(model, &Q, &Qd, &Qdd);
+
+    std::vector<MatrixNd> expectedJv, expectedJw;
+    Vector3d point(random(), random(), random());
+    for (unsigned int bodyId = 1; bodyId < model.mBodies.size(); bodyId++)
+    {
+      MatrixNd Jv = MatrixNd::Zero(3, numDOFs), Jw = MatrixNd::Zero(3, numDOFs);
+      RigidBodyDynamics::CalcPointJacobian(model, Q, bodyId, point, Jv, false);
+      RigidBodyDynamics::CalcPointJacobianW(model, Q, bodyId, point, Jw, false);
+      expectedJv.push_back(Jv);
+      expectedJw.push_back(Jw);
+    }
+
+    // Reset the kinematics so the generated code must update them
+    RigidBodyDynamics::UpdateKinematicsCustom(model, &zero, &zero, &zero);
+
+    MatrixNd A(numDOFs, numDOFs);
+    VectorNd grav(numDOFs), coriolis(numDOFs);
+    generatedDynamics.update(model, Q, Qd, Qdd, &A, grav, coriolis);
+
+    ASSERT_TRUE((A - expectedA).norm() < 1e-10)
+      << "A =\n" << A << "\nexpected:\n" << expectedA;
+    ASSERT_TRUE((grav - expectedGrav).norm() < 1e-10)
+      << "grav = " << grav.transpose() << ", expected: " << expectedGrav.transpose();
+    ASSERT_TRUE((coriolis - expectedCoriolis).norm() < 1e-10)
+      << "coriolis = " << coriolis.transpose() << ", expected: " << expectedCoriolis.transpose();
+
+    // The RBDL model's kinematics must be the same as after UpdateKinematicsCustom(...)
+    for (unsigned int bodyId = 1; bodyId < model.mBodies.size(); bodyId++)
+    {
+      MatrixNd Jv, Jw;
+      generatedDynamics.calcPointJacobian(model, bodyId, point, Jv, Jw);
+
+      ASSERT_TRUE((Jv - expectedJv[bodyId - 1]).norm() < 1e-10)
+        << "Body " << bodyId << " Jv =\n" << Jv << "\nexpected:\n" << expectedJv[bodyId - 1];
+      ASSERT_TRUE((Jw - expectedJw[bodyId - 1]).norm() < 1e-10)
+        << "Body " << bodyId << " Jw =\n" << Jw << "\nexpected:\n" << expectedJw[bodyId - 1];
+
+      MatrixNd Jrbdl = MatrixNd::Zero(3, numDOFs);
+      RigidBodyDynamics::CalcPointJacobian(model, Q, bodyId, point, Jrbdl, false);
+      ASSERT_TRUE((Jrbdl - expectedJv[bodyId - 1]).norm() < 1e-10)
+        << "The kinematics of body " << bodyId << " were not updated.";
+    }
+
+    // The inertia matrix is optional
+    VectorNd grav2(numDOFs), coriolis2(numDOFs);
+    generatedDynamics.update(model, Q, Qd, Qdd, NULL, grav2, coriolis2);
+
+    ASSERT_TRUE(grav2 == grav && coriolis2 == coriolis);
+  }
+}
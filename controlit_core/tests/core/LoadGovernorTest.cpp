@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <controlit/LoadGovernor.hpp>
+
+using controlit::DegradationConfig;
+using controlit::DegradationStep;
+using controlit::LoadGovernor;
+
+namespace {
+
+const double SERVO_PERIOD = 0.001;
+
+DegradationConfig createConfig()
+{
+    DegradationConfig config;
+    config.steps.push_back(DegradationStep::TELEMETRY);
+    config.steps.push_back(DegradationStep::TASK_UPDATES);
+    config.overrunThreshold = 0.9;
+    config.headroomThreshold = 0.5;
+    config.overrunCycles = 5;
+    config.headroomCycles = 10;
+    return config;
+}
+
+/*!
+ * Runs the governor for a number of cycles with the same compute time.
+ *
+ * \return The number of times the level changed.
+ */
+int runCycles(LoadGovernor & governor, int numCycles, double load)
+{
+    int numChanges = 0;
+    for (int ii = 0; ii < numCycles; ii++)
+    {
+        if (governor.update(load * SERVO_PERIOD))
+            numChanges++;
+    }
+    return numChanges;
+}
+
+} // namespace
+
+TEST(LoadGovernorTest, ParsesStepNames)
+{
+    DegradationStep step;
+    for (auto name : {"task_updates", "projections", "telemetry", "events"})
+    {
+        EXPECT_TRUE(DegradationConfig::parseStep(name, step));
+        EXPECT_EQ(name, DegradationConfig::getStepName(step));
+    }
+
+    EXPECT_FALSE(DegradationConfig::parseStep("everything", step));
+}
+
+TEST(LoadGovernorTest, DisabledWithoutSteps)
+{
+    LoadGovernor governor;
+    governor.init(DegradationConfig(), SERVO_PERIOD);
+
+    EXPECT_FALSE(governor.isEnabled());
+    EXPECT_EQ(0, runCycles(governor, 100, 2.0));
+    EXPECT_EQ(0, governor.getLevel());
+}
+
+TEST(LoadGovernorTest, DegradesUnderSustainedOverrun)
+{
+    LoadGovernor governor;
+    governor.init(createConfig(), SERVO_PERIOD);
+
+    // Isolated overruns do not degrade the loop
+    for (int ii = 0; ii < 50; ii++)
+    {
+        EXPECT_FALSE(governor.update(1.5 * SERVO_PERIOD));
+        EXPECT_FALSE(governor.update(0.7 * SERVO_PERIOD));
+    }
+    EXPECT_EQ(0, governor.getLevel());
+
+    // Sustained overruns apply the steps in order
+    EXPECT_EQ(1, runCycles(governor, 5, 1.5));
+    EXPECT_EQ(1, governor.getLevel());
+    EXPECT_TRUE(governor.isApplied(DegradationStep::TELEMETRY));
+    EXPECT_FALSE(governor.isApplied(DegradationStep::TASK_UPDATES));
+
+    EXPECT_EQ(1, runCycles(governor, 5, 1.5));
+    EXPECT_EQ(2, governor.getLevel());
+    EXPECT_TRUE(governor.isApplied(DegradationStep::TASK_UPDATES));
+    EXPECT_FALSE(governor.isApplied(DegradationStep::EVENTS));
+
+    // There are no more steps to apply
+    EXPECT_EQ(0, runCycles(governor, 100, 1.5));
+    EXPECT_EQ(2, governor.getLevel());
+    EXPECT_EQ(2u, governor.getNumLevelChanges());
+    EXPECT_DOUBLE_EQ(1.5, governor.getLoad());
+}
+
+TEST(LoadGovernorTest, RestoresWithHysteresis)
+{
+    LoadGovernor governor;
+    governor.init(createConfig(), SERVO_PERIOD);
+
+    runCycles(governor, 10, 1.5);
+    ASSERT_EQ(2, governor.getLevel());
+
+    // A load between the thresholds keeps the level
+    EXPECT_EQ(0, runCycles(governor, 100, 0.7));
+    EXPECT_EQ(2, governor.getLevel());
+
+    // Headroom must be consecutive
+    runCycles(governor, 9, 0.3);
+    runCycles(governor, 1, 0.7);
+    runCycles(governor, 9, 0.3);
+    EXPECT_EQ(2, governor.getLevel());
+
+    // The steps are restored in reverse order
+    EXPECT_EQ(1, runCycles(governor, 10, 0.3));
+    EXPECT_EQ(1, governor.getLevel());
+    EXPECT_TRUE(governor.isApplied(DegradationStep::TELEMETRY));
+    EXPECT_FALSE(governor.isApplied(DegradationStep::TASK_UPDATES));
+
+    EXPECT_EQ(1, runCycles(governor, 10, 0.3));
+    EXPECT_EQ(0, governor.getLevel());
+    EXPECT_FALSE(governor.isApplied(DegradationStep::TELEMETRY));
+    EXPECT_EQ(4u, governor.getNumLevelChanges());
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <controlit/ModelPredictor.hpp>
+
+using controlit::ModelPredictor;
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
+
+namespace {
+
+const int NUM_DOFS = 8;
+const int NUM_ACTUABLE_DOFS = 6;
+const double TOLERANCE = 1e-10;
+
+/*!
+ * A model whose quantities are affine functions of the joint positions.
+ */
+class AffineModel
+{
+public:
+    AffineModel() :
+        grav0(Vector::Random(NUM_DOFS)),
+        gravSlope(Matrix::Random(NUM_DOFS, NUM_DOFS)),
+        UNcBar0(Matrix::Random(NUM_DOFS, NUM_ACTUABLE_DOFS)),
+        UNcBarSlope(Matrix::Random(NUM_DOFS, NUM_ACTUABLE_DOFS)),
+        UNcAiNorm0(Matrix::Random(NUM_ACTUABLE_DOFS, NUM_ACTUABLE_DOFS)),
+        UNcAiNormSlope(Matrix::Random(NUM_ACTUABLE_DOFS, NUM_ACTUABLE_DOFS))
+    {
+    }
+
+    /*!
+     * Evaluates the model.  The matrices only vary with the first joint.
+     */
+    void evaluate(const Vector & Q, Vector & grav, Matrix & UNcBar, Matrix & UNcAiNorm) const
+    {
+        grav = grav0 + gravSlope * Q;
+        UNcBar = UNcBar0 + Q(0) * UNcBarSlope;
+        UNcAiNorm = UNcAiNorm0 + Q(0) * UNcAiNormSlope;
+    }
+
+    void addSnapshot(ModelPredictor & predictor, const Vector & Q) const
+    {
+        Vector grav;
+        Matrix UNcBar, UNcAiNorm;
+        evaluate(Q, grav, UNcBar, UNcAiNorm);
+        predictor.addSnapshot(Q, grav, UNcBar, UNcAiNorm);
+    }
+
+private:
+    Vector grav0;
+    Matrix gravSlope;
+    Matrix UNcBar0, UNcBarSlope;
+    Matrix UNcAiNorm0, UNcAiNormSlope;
+};
+
+} // namespace
+
+TEST(ModelPredictorTest, PredictsAffineModelAlongMotion)
+{
+    AffineModel model;
+    ModelPredictor predictor;
+    predictor.init(NUM_DOFS, NUM_ACTUABLE_DOFS, 2);
+
+    // Move along a straight line in joint space
+    Vector direction = Vector::Random(NUM_DOFS);
+    for (int ii = 0; ii < 5; ii++)
+        model.addSnapshot(predictor, ii * 0.01 * direction);
+
+    EXPECT_TRUE(predictor.isApplied());
+    EXPECT_NEAR(predictor.getGravityError(), 0, TOLERANCE);
+    EXPECT_GT(predictor.getHeldGravityError(), 0);
+
+    // Half way to where the next update would be
+    Vector Q = 4.5 * 0.01 * direction;
+
+    Vector grav, expectedGrav;
+    Matrix UNcBar, UNcAiNorm, expectedUNcBar, expectedUNcAiNorm;
+    predictor.predict(Q, grav, UNcBar, UNcAiNorm);
+    model.evaluate(Q, expectedGrav, expectedUNcBar, expectedUNcAiNorm);
+
+    EXPECT_NEAR(predictor.getExtrapolation(), 0.5, TOLERANCE);
+    EXPECT_TRUE(grav.isApprox(expectedGrav, TOLERANCE));
+    EXPECT_TRUE(UNcBar.isApprox(expectedUNcBar, TOLERANCE));
+    EXPECT_TRUE(UNcAiNorm.isApprox(expectedUNcAiNorm, TOLERANCE));
+}
+
+TEST(ModelPredictorTest, ClampsExtrapolation)
+{
+    AffineModel model;
+    ModelPredictor predictor;
+    predictor.init(NUM_DOFS, NUM_ACTUABLE_DOFS, 1);
+
+    Vector direction = Vector::Random(NUM_DOFS);
+    for (int ii = 0; ii < 5; ii++)
+        model.addSnapshot(predictor, ii * 0.01 * direction);
+
+    Vector grav;
+    Matrix UNcBar, UNcAiNorm;
+
+    // Far beyond the maximum extrapolation
+    predictor.predict(10 * 0.01 * direction, grav, UNcBar, UNcAiNorm);
+    EXPECT_EQ(predictor.getExtrapolation(), 1);
+
+    // Moving backwards is not extrapolated
+    predictor.predict(3 * 0.01 * direction, grav, UNcBar, UNcAiNorm);
+    EXPECT_EQ(predictor.getExtrapolation(), 0);
+
+    Vector expectedGrav;
+    Matrix expectedUNcBar, expectedUNcAiNorm;
+    model.evaluate(4 * 0.01 * direction, expectedGrav, expectedUNcBar, expectedUNcAiNorm);
+    EXPECT_TRUE(grav.isApprox(expectedGrav, TOLERANCE));
+}
+
+TEST(ModelPredictorTest, HoldsWhenPredictionIsWorse)
+{
+    ModelPredictor predictor;
+    predictor.init(NUM_DOFS, NUM_ACTUABLE_DOFS, 2);
+
+    // Snapshots that alternate between two models, so the extrapolation
+    // always overshoots
+    AffineModel model;
+    Vector direction = Vector::Random(NUM_DOFS);
+    for (int ii = 0; ii < 10; ii++)
+    {
+        Vector Q = ii * 0.01 * direction;
+        Vector grav;
+        Matrix UNcBar, UNcAiNorm;
+        model.evaluate(Q, grav, UNcBar, UNcAiNorm);
+        if (ii % 2) grav *= 2;
+        predictor.addSnapshot(Q, grav, UNcBar, UNcAiNorm);
+    }
+
+    EXPECT_FALSE(predictor.isApplied());
+    EXPECT_GT(predictor.getGravityError(), predictor.getHeldGravityError());
+
+    Vector grav;
+    Matrix UNcBar, UNcAiNorm;
+    predictor.predict(9.5 * 0.01 * direction, grav, UNcBar, UNcAiNorm);
+    EXPECT_EQ(predictor.getExtrapolation(), 0);
+}
+
+TEST(ModelPredictorTest, NeedsTwoSnapshots)
+{
+    AffineModel model;
+    ModelPredictor predictor;
+    predictor.init(NUM_DOFS, NUM_ACTUABLE_DOFS, 2);
+
+    Vector Q = Vector::Random(NUM_DOFS);
+    model.addSnapshot(predictor, Q);
+    EXPECT_FALSE(predictor.isApplied());
+
+    Vector grav, expectedGrav;
+    Matrix UNcBar, UNcAiNorm, expectedUNcBar, expectedUNcAiNorm;
+    predictor.predict(2 * Q, grav, UNcBar, UNcAiNorm);
+    model.evaluate(Q, expectedGrav, expectedUNcBar, expectedUNcAiNorm);
+
+    EXPECT_TRUE(grav.isApprox(expectedGrav, TOLERANCE));
+    EXPECT_TRUE(UNcBar.isApprox(expectedUNcBar, TOLERANCE));
+}
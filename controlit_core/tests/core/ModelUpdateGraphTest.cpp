@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <controlit/ModelUpdateGraph.hpp>
+
+using controlit::ModelUpdateGraph;
+using controlit::addons::cpp::ThreadPool;
+
+namespace {
+
+/*!
+ * Builds a graph of numStages stages with numSteps steps each.  Each step
+ * records the stage it belongs to in order.
+ */
+void buildGraph(ModelUpdateGraph & graph, size_t numStages, size_t numSteps,
+    std::vector<size_t> & order, std::mutex & orderMutex)
+{
+    for (size_t stage = 0; stage < numStages; stage++)
+    {
+        EXPECT_EQ(stage, graph.addStage());
+
+        for (size_t step = 0; step < numSteps; step++)
+        {
+            graph.addStep(stage, [stage, &order, &orderMutex]()
+            {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back(stage);
+            });
+        }
+    }
+}
+
+} // namespace
+
+TEST(ModelUpdateGraphTest, RunsSeriallyWithoutThreadPool)
+{
+    ModelUpdateGraph graph;
+    std::vector<size_t> order;
+    std::mutex orderMutex;
+
+    buildGraph(graph, 3, 4, order, orderMutex);
+    EXPECT_EQ(3u, graph.getNumStages());
+    EXPECT_EQ(4u, graph.getNumSteps(1));
+
+    graph.run();
+
+    ASSERT_EQ(12u, order.size());
+    for (size_t ii = 0; ii < order.size(); ii++)
+        EXPECT_EQ(ii / 4, order[ii]);
+}
+
+TEST(ModelUpdateGraphTest, StagesRunInOrder)
+{
+    ThreadPool pool(3);
+    ModelUpdateGraph graph;
+    graph.setThreadPool(&pool);
+
+    std::vector<size_t> order;
+    std::mutex orderMutex;
+    buildGraph(graph, 4, 8, order, orderMutex);
+
+    for (int run = 0; run < 100; run++)
+    {
+        order.clear();
+        graph.run();
+
+        // Every step of a stage finishes before the next stage starts.
+        ASSERT_EQ(32u, order.size());
+        for (size_t ii = 0; ii < order.size(); ii++)
+            ASSERT_EQ(ii / 8, order[ii]);
+    }
+}
+
+TEST(ModelUpdateGraphTest, StagesRunInOrderOnWorkerPool)
+{
+    controlit::WorkerPool pool;
+    ASSERT_TRUE(pool.init(3, std::vector<int>(), 0.01));
+
+    ModelUpdateGraph graph;
+    graph.setWorkerPool(&pool, pool.addAccount("controller", 0), 3);
+
+    std::vector<size_t> order;
+    std::mutex orderMutex;
+    buildGraph(graph, 4, 8, order, orderMutex);
+
+    ASSERT_TRUE(pool.start());
+
+    for (int run = 0; run < 100; run++)
+    {
+        order.clear();
+        graph.run();
+
+        ASSERT_EQ(32u, order.size());
+        for (size_t ii = 0; ii < order.size(); ii++)
+            ASSERT_EQ(ii / 8, order[ii]);
+    }
+
+    pool.stop();
+}
+
+TEST(ModelUpdateGraphTest, StepsRunConcurrently)
+{
+    ThreadPool pool(3);
+    ModelUpdateGraph graph;
+    graph.setThreadPool(&pool);
+
+    std::mutex threadsMutex;
+    std::set<std::thread::id> threads;
+    std::atomic<int> running(0), maxRunning(0);
+
+    size_t stage = graph.addStage();
+    for (int step = 0; step < 4; step++)
+    {
+        graph.addStep(stage, [&]()
+        {
+            int now = ++running;
+            int max = maxRunning;
+            while (now > max && !maxRunning.compare_exchange_weak(max, now)) {}
+
+            {
+                std::lock_guard<std::mutex> lock(threadsMutex);
+                threads.insert(std::this_thread::get_id());
+            }
+
+            // Wait for the other steps so that no thread can take two of them.
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (maxRunning < 4 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+
+            running--;
+        });
+    }
+
+    graph.run();
+
+    // The calling thread and the three helpers each run one step.
+    EXPECT_EQ(4u, threads.size());
+    EXPECT_EQ(4, maxRunning);
+    EXPECT_TRUE(threads.count(std::this_thread::get_id()) == 1);
+}
+
+TEST(ModelUpdateGraphTest, Rebuild)
+{
+    ThreadPool pool(2);
+    ModelUpdateGraph graph;
+    graph.setThreadPool(&pool);
+
+    std::atomic<int> count(0);
+    size_t stage = graph.addStage();
+    graph.addStep(stage, [&]() { count += 1; });
+    graph.addStep(stage, [&]() { count += 10; });
+    graph.run();
+    EXPECT_EQ(11, count);
+
+    graph.clear();
+    EXPECT_EQ(0u, graph.getNumStages());
+
+    stage = graph.addStage();
+    graph.addStep(stage, [&]() { count += 100; });
+    graph.run();
+    EXPECT_EQ(111, count);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <controlit/ModelUpdatePolicy.hpp>
+
+using controlit::ModelUpdatePolicy;
+using controlit::addons::eigen::Vector;
+
+typedef ModelUpdatePolicy::Decision Decision;
+
+namespace {
+
+const int NUM_DOFS = 10;
+
+} // namespace
+
+TEST(ModelUpdatePolicyTest, DisabledByDefault)
+{
+    ModelUpdatePolicy policy;
+    policy.init(NUM_DOFS, 0, 0, 0);
+
+    Vector Q = Vector::Zero(NUM_DOFS);
+    Vector Qd = Vector::Zero(NUM_DOFS);
+
+    EXPECT_FALSE(policy.isEnabled());
+    EXPECT_EQ(policy.decide(Q, Qd, Q, true, false), Decision::FULL);
+    EXPECT_EQ(policy.decide(Q, Qd, Q, true, false), Decision::FULL);
+}
+
+TEST(ModelUpdatePolicyTest, SkipsQuasiStaticStates)
+{
+    ModelUpdatePolicy policy;
+    policy.init(NUM_DOFS, 1e-3, 1e-2, 0);
+
+    Vector Q = Vector::Random(NUM_DOFS);
+    Vector Qd = Vector::Zero(NUM_DOFS);
+
+    // Nothing was computed yet
+    EXPECT_EQ(policy.decide(Q, Qd, Q, true, false), Decision::FULL);
+
+    // Small motions are skipped, as long as the accumulated motion since the
+    // last computed model stays below the threshold
+    Vector Q2 = Q;
+    Q2(3) += 0.6e-3;
+    EXPECT_EQ(policy.decide(Q2, Qd, Q, true, false), Decision::SKIP);
+    Q2(3) += 0.6e-3;
+    EXPECT_EQ(policy.decide(Q2, Qd, Q, true, false), Decision::FULL);
+    EXPECT_EQ(policy.decide(Q2, Qd, Q2, true, false), Decision::SKIP);
+
+    // So are small changes in velocity
+    Vector Qd2 = Qd;
+    Qd2(0) = 0.5e-2;
+    EXPECT_EQ(policy.decide(Q2, Qd2, Q2, true, false), Decision::SKIP);
+    Qd2(0) = 2e-2;
+    EXPECT_EQ(policy.decide(Q2, Qd2, Q2, true, false), Decision::FULL);
+}
+
+TEST(ModelUpdatePolicyTest, PartialUpdatesNearLastFullUpdate)
+{
+    ModelUpdatePolicy policy;
+    policy.init(NUM_DOFS, 0, 0, 1e-2);
+
+    Vector fullUpdateQ = Vector::Random(NUM_DOFS);
+    Vector Qd = Vector::Random(NUM_DOFS);
+
+    Vector Q = fullUpdateQ;
+    Q(5) += 0.5e-2;
+    EXPECT_EQ(policy.decide(Q, Qd, fullUpdateQ, true, false), Decision::PARTIAL);
+
+    Q(5) += 1e-2;
+    EXPECT_EQ(policy.decide(Q, Qd, fullUpdateQ, true, false), Decision::FULL);
+}
+
+TEST(ModelUpdatePolicyTest, FullUpdateWhenStaleOrConstraintsChange)
+{
+    ModelUpdatePolicy policy;
+    policy.init(NUM_DOFS, 1e-3, 1e-3, 1e-2);
+
+    Vector Q = Vector::Random(NUM_DOFS);
+    Vector Qd = Vector::Zero(NUM_DOFS);
+
+    EXPECT_EQ(policy.decide(Q, Qd, Q, false, false), Decision::FULL);
+    EXPECT_EQ(policy.decide(Q, Qd, Q, true, true), Decision::FULL);
+    EXPECT_EQ(policy.decide(Q, Qd, Q, true, false), Decision::SKIP);
+
+    // After a reset, e.g., when the controller restarts, nothing is skipped
+    policy.reset();
+    EXPECT_EQ(policy.decide(Q, Qd, Q, true, false), Decision::PARTIAL);
+}
+
+TEST(ModelUpdatePolicyTest, EstimatesSavedTime)
+{
+    ModelUpdatePolicy policy;
+    policy.init(NUM_DOFS, 1e-3, 1e-3, 1e-2);
+
+    // One full update, two partial updates, and seven skipped updates
+    policy.recordUpdate(Decision::FULL, 1e-3);
+    for (int ii = 0; ii < 2; ii++) policy.recordUpdate(Decision::PARTIAL, 0.2e-3);
+    for (int ii = 0; ii < 7; ii++) policy.recordUpdate(Decision::SKIP, 0);
+
+    EXPECT_EQ(policy.getNumDecisions(), 10);
+    EXPECT_DOUBLE_EQ(policy.getRatio(Decision::SKIP), 0.7);
+    EXPECT_DOUBLE_EQ(policy.getRatio(Decision::PARTIAL), 0.2);
+    EXPECT_DOUBLE_EQ(policy.getRatio(Decision::FULL), 0.1);
+
+    // Ten full updates would have taken 10ms, but only 1.4ms was spent
+    EXPECT_NEAR(policy.getSavedFraction(), 8.6 / 10, 1e-12);
+
+    policy.resetStatistics();
+    EXPECT_EQ(policy.getNumDecisions(), 0);
+    EXPECT_DOUBLE_EQ(policy.getAverageFullDuration(), 1e-3);
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <controlit/ParallelLoop.hpp>
+
+using controlit::ParallelLoop;
+using controlit::WorkerPool;
+using controlit::addons::cpp::ThreadPool;
+
+namespace {
+
+/*!
+ * Waits up to one second for a condition to become true.
+ */
+template<typename Condition>
+bool waitFor(Condition condition)
+{
+    for (int ii = 0; ii < 1000 && !condition(); ii++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return condition();
+}
+
+/*!
+ * Runs a loop many times and checks that every iteration runs exactly once.
+ */
+void checkIterations(ParallelLoop & loop)
+{
+    std::vector<std::atomic<int>> counts(16);
+
+    ParallelLoop::Body body = [&counts](size_t iteration, bool helper) { counts[iteration]++; };
+
+    for (int run = 1; run <= 100; run++)
+    {
+        loop.run(counts.size(), body);
+
+        for (size_t ii = 0; ii < counts.size(); ii++)
+            ASSERT_EQ(run, counts[ii]) << "iteration " << ii;
+    }
+}
+
+/*!
+ * Runs a loop whose iterations wait for each other, so that each one runs
+ * on a different thread, and returns the number of threads.
+ */
+size_t countConcurrentThreads(ParallelLoop & loop, size_t numIterations)
+{
+    std::mutex threadsMutex;
+    std::set<std::thread::id> threads;
+    std::atomic<size_t> numStarted(0);
+    std::thread::id caller = std::this_thread::get_id();
+
+    loop.run(numIterations, [&](size_t iteration, bool helper)
+    {
+        EXPECT_EQ(helper, std::this_thread::get_id() != caller);
+
+        {
+            std::lock_guard<std::mutex> lock(threadsMutex);
+            threads.insert(std::this_thread::get_id());
+        }
+
+        numStarted++;
+        waitFor([&numStarted, numIterations] { return numStarted == numIterations; });
+    });
+
+    return threads.size();
+}
+
+} // namespace
+
+TEST(ParallelLoopTest, RunsSeriallyWithoutHelpers)
+{
+    ParallelLoop loop;
+    EXPECT_EQ(0u, loop.getNumHelpers());
+
+    std::vector<size_t> order;
+    loop.run(5, [&order](size_t iteration, bool helper)
+    {
+        EXPECT_FALSE(helper);
+        order.push_back(iteration);
+    });
+
+    EXPECT_EQ(std::vector<size_t>({0, 1, 2, 3, 4}), order);
+
+    // An empty loop returns immediately.
+    loop.run(0, [](size_t, bool) { FAIL(); });
+}
+
+TEST(ParallelLoopTest, RunsEveryIterationOnceOnThreadPool)
+{
+    ThreadPool pool(3);
+    ParallelLoop loop;
+    loop.setThreadPool(&pool);
+    EXPECT_EQ(3u, loop.getNumHelpers());
+
+    checkIterations(loop);
+    EXPECT_EQ(4u, countConcurrentThreads(loop, 4));
+}
+
+TEST(ParallelLoopTest, RunsEveryIterationOnceOnWorkerPool)
+{
+    WorkerPool pool;
+    ASSERT_TRUE(pool.init(3, std::vector<int>(), 0.01));
+
+    ParallelLoop loop;
+    loop.setWorkerPool(&pool, pool.addAccount("controller", 0), 3);
+    EXPECT_EQ(3u, loop.getNumHelpers());
+
+    ASSERT_TRUE(pool.start());
+
+    checkIterations(loop);
+    EXPECT_EQ(4u, countConcurrentThreads(loop, 4));
+
+    pool.stop();
+}
+
+TEST(ParallelLoopTest, DoesNotWaitForBusyWorkerPool)
+{
+    WorkerPool pool;
+    ASSERT_TRUE(pool.init(1, std::vector<int>(), 0.01));
+
+    // Another controller's job occupies the only worker.
+    std::atomic<bool> release(false);
+    std::atomic<int> blockerCount(0);
+    WorkerPool::Job * blocker = pool.addJob(pool.addAccount("other", 0), [&release, &blockerCount]
+    {
+        blockerCount++;
+        while (!release) std::this_thread::yield();
+    });
+
+    ParallelLoop loop;
+    loop.setWorkerPool(&pool, pool.addAccount("controller", 0), 2);
+
+    ASSERT_TRUE(pool.start());
+
+    blocker->submit();
+    ASSERT_TRUE(waitFor([&blockerCount] { return blockerCount == 1; }));
+
+    std::atomic<int> numHelperIterations(0);
+    std::vector<int> counts(8);
+    ParallelLoop::Body body = [&](size_t iteration, bool helper)
+    {
+        counts[iteration]++;
+        if (helper) numHelperIterations++;
+    };
+
+    // The calling thread runs every iteration.
+    loop.run(counts.size(), body);
+    for (size_t ii = 0; ii < counts.size(); ii++)
+        EXPECT_EQ(1, counts[ii]);
+    EXPECT_EQ(0, numHelperIterations);
+
+    // The withdrawn helpers do not run once the worker is free.
+    release = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(0, numHelperIterations);
+
+    loop.run(counts.size(), body);
+    for (size_t ii = 0; ii < counts.size(); ii++)
+        EXPECT_EQ(2, counts[ii]);
+
+    pool.stop();
+}
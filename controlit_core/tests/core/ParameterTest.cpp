@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include <controlit/ParameterListener.hpp>
 #include <controlit/Parameter.hpp>
 
@@ -42,13 +44,13 @@ controlit::Parameter* createParameter<std::string>(const std::string& name, std:
 template<>
 controlit::Parameter* createParameter<Vector>(const std::string& name, Vector* value)
 {
-  return new VectorParameter(name, controlit::Parameter::Flag::Default, value);
+  return new controlit::VectorParameter(name, controlit::Parameter::Flag::Default, value);
 }
 
 template<>
 controlit::Parameter* createParameter<Matrix>(const std::string& name, Matrix* value)
 {
-  return new MatrixParameter(name, controlit::Parameter::Flag::Default, value);
+  return new controlit::MatrixParameter(name, controlit::Parameter::Flag::Default, value);
 }
 
 template<>
@@ -88,8 +90,8 @@ TEST_F(ParameterTest, SetValue)
   EXPECT_TRUE(param_test::testSetParameter<Matrix>(Matrix::Zero(2,2)));
   EXPECT_TRUE(param_test::testSetParameter<Vector>(Vector::Zero(3)));
   EXPECT_TRUE(param_test::testSetParameter<std::vector<std::string> >(std::vector<std::string>(3,"test")));
-  controlit::BindingConfig binding = controlit::BindingConfig("ROS", "/joint_states", "geometry_msgs::JointState", controlit::BindingConfig::Input);
-  binding.addParameter("a_param");
+  controlit::BindingConfig binding = controlit::BindingConfig("ROS", "sensor_msgs/JointState", "/joint_states", controlit::BindingConfig::Input);
+  binding.setParameter("a_param");
   EXPECT_TRUE(param_test::testSetParameter<controlit::BindingConfig>(binding));
 }
 
@@ -128,3 +130,63 @@ TEST_F(ParameterTest, ParameterListener)
 
   delete p;
 }
+
+/*!
+ * Records whether a vector parameter was ever seen with a torn value, i.e.,
+ * with elements from two different calls to set(...).
+ */
+class VectorConsistencyListener
+{
+public:
+  VectorConsistencyListener() : numUpdates(0), numTorn(0) {}
+
+  virtual void update(controlit::Parameter const& param)
+  {
+    const Vector & value = *(param.getVector());
+
+    // Each writer sets a vector whose size equals its elements.
+    for (int ii = 0; ii < value.size(); ii++)
+    {
+      if (value[ii] != value.size())
+      {
+        numTorn++;
+        break;
+      }
+    }
+
+    numUpdates++;
+  }
+
+  int numUpdates;
+  int numTorn;
+};
+
+TEST_F(ParameterTest, ConcurrentSets)
+{
+  Vector aVector(Vector::Constant(2, 2));
+  controlit::Parameter* p = param_test::createParameter<Vector>("aVector", &aVector);
+
+  VectorConsistencyListener l;
+  p->addListener(boost::bind(&VectorConsistencyListener::update, &l, _1));
+
+  // E.g., a task command thread setting a task's error while a ROS input
+  // binding sets the same parameter.
+  const int NUM_SETS = 10000;
+  std::thread writer([p]()
+  {
+    Vector value(Vector::Constant(3, 3));
+    for (int ii = 0; ii < NUM_SETS; ii++)
+      p->set(value);
+  });
+
+  Vector value(Vector::Constant(5, 5));
+  for (int ii = 0; ii < NUM_SETS; ii++)
+    p->set(value);
+
+  writer.join();
+
+  EXPECT_EQ(2 * NUM_SETS, l.numUpdates);
+  EXPECT_EQ(0, l.numTorn);
+
+  delete p;
+}
@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
+#include <iomanip>
+#include <boost/math/constants/constants.hpp>
 #include <RigidBodyDynamics/Extras/rbdl_extras.hpp>
 #include <controlit/ControlModel.hpp>
 #include <controlit/RobotState.hpp>
 #include <controlit/addons/eigen/LinearAlgebra.hpp>
-#include <drc/common/math_utilities.hpp>
+#include <controlit/utility/ControlItParameters.hpp>
 
 using RigidBodyDynamics::Math::Vector3d;
 using RigidBodyDynamics::Math::VectorNd;
@@ -13,6 +15,7 @@ using RigidBodyDynamics::Math::SpatialVector;
 using RigidBodyDynamics::Math::Xtrans;
 
 using controlit::RobotState;
+using controlit::addons::eigen::Quaternion;
 
 /*----------------------------------------------------------------------------
  * rbdl_extras tests
@@ -78,13 +81,13 @@ protected:
     // revolute1DoF_1's frame's (0, 0, 0.5).
     model->AppendBody(Xtrans(Vector3d(0, 0, 0.5)), joint_c, body_c, "revolute1DoF_2");
 
-    // Make a RobotState object
-    robotState.reset(new RobotState);
-    robotState->init(model->dof_count);
-
     // Make a ControlModel object
+    robotState.reset(new RobotState);
     controlModel.reset(new controlit::ControlModel());
-    controlModel->init(model, robotState, l2jmap, new controlit::ConstraintSet());
+    controlModel->init(model, robotState.get(), l2jmap, new controlit::ConstraintSet(), &params);
+
+    // The robot state holds the real joints of the model
+    robotState->init(controlModel->getRealJointNamesVector());
   }
 
   virtual void TearDown()
@@ -92,6 +95,7 @@ protected:
     // controlModel.reset();
   }
 
+  controlit::utility::ControlItParameters params;
   std::shared_ptr<controlit::RobotState> robotState;
   std::unique_ptr<controlit::ControlModel> controlModel;
 };
@@ -115,14 +119,12 @@ TEST_F(RbdlExtrasTest, COMTest)
   // Vector Qd(controlModel->getNumDOFs() - 6); Qd.setZero();
   // Vector Qdd(controlModel->getNumDOFs() - 6); Qdd.setZero();
 
-  // RobotState robotState;
-  robotState->init(controlModel->getNActuableDOFs());
   robotState->setJointPosition(1, boost::math::constants::pi<double>() / 2);
 
   // Specify the robot's base state
   Vector3d position; position.setZero();
   Vector twist(6); twist.setZero();
-  drc::common::aliases::Quaternion orientation;
+  Quaternion orientation;
   orientation.setIdentity();
 
   robotState->setRobotBaseState(position, orientation, twist);
@@ -289,3 +291,210 @@ TEST_F(RbdlExtrasTest, COMTest)
     << std::scientific << std::fixed << std::setprecision(std::numeric_limits<double>::digits10 + 1)
     << "check.norm() = " << check.norm() << " exceeds 1e-10!";
 }
+
+TEST_F(RbdlExtrasTest, FusedDynamicsTest)
+{
+  RigidBodyDynamics::Model & model = controlModel->rbdlModel();
+
+  RigidBodyDynamics::Extras::FusedDynamics fusedDynamics;
+  ASSERT_TRUE(fusedDynamics.init(model));
+
+  // Move every joint including the virtual ones
+  VectorNd Q(model.dof_count), Qd(model.dof_count), Qdd(model.dof_count);
+  for (size_t ii = 0; ii < model.dof_count; ii++)
+  {
+    Q[ii] = 0.1 * (ii + 1);
+    Qd[ii] = 0.2 - 0.05 * ii;
+    Qdd[ii] = 0.3 * ii;
+  }
+
+  VectorNd zero = VectorNd::Zero(model.dof_count);
+
+  // Compute the expected values using RBDL
+  MatrixNd expectedA = MatrixNd::Zero(model.dof_count, model.dof_count);
+  RigidBodyDynamics::CompositeRigidBodyAlgorithm(model, Q, expectedA, true);
+
+  VectorNd expectedGrav(model.dof_count), expectedCoriolis(model.dof_count);
+  RigidBodyDynamics::InverseDynamics(model, Q, zero, zero, expectedGrav);
+  RigidBodyDynamics::InverseDynamics(model, Q, Qd, zero, expectedCoriolis);
+  expectedCoriolis -= expectedGrav;
+
+  RigidBodyDynamics::UpdateKinematicsCustom(model, &Q, &Qd, &Qdd);
+  Vector3d expectedPoint = RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q,
+    model.GetBodyId("revolute1DoF_2"), Vector3d(0, 0, 0.25), false);
+  Vector3d expectedPointVel = RigidBodyDynamics::CalcPointVelocity(model, Q, Qd,
+    model.GetBodyId("revolute1DoF_2"), Vector3d(0, 0, 0.25), false);
+
+  // Reset the kinematics so the fused computation must update them
+  RigidBodyDynamics::UpdateKinematicsCustom(model, &zero, &zero, &zero);
+
+  MatrixNd A(model.dof_count, model.dof_count);
+  VectorNd grav(model.dof_count), coriolis(model.dof_count);
+  fusedDynamics.update(model, Q, Qd, Qdd, &A, grav, coriolis);
+
+  EXPECT_TRUE((A - expectedA).norm() < 1e-10)
+    << "A =\n" << A << "\nexpected:\n" << expectedA;
+  EXPECT_TRUE((grav - expectedGrav).norm() < 1e-10)
+    << "grav = " << grav.transpose() << ", expected: " << expectedGrav.transpose();
+  EXPECT_TRUE((coriolis - expectedCoriolis).norm() < 1e-10)
+    << "coriolis = " << coriolis.transpose() << ", expected: " << expectedCoriolis.transpose();
+
+  Vector3d point = RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q,
+    model.GetBodyId("revolute1DoF_2"), Vector3d(0, 0, 0.25), false);
+  Vector3d pointVel = RigidBodyDynamics::CalcPointVelocity(model, Q, Qd,
+    model.GetBodyId("revolute1DoF_2"), Vector3d(0, 0, 0.25), false);
+
+  EXPECT_TRUE((point - expectedPoint).norm() < 1e-10)
+    << "point = " << point.transpose() << ", expected: " << expectedPoint.transpose();
+  EXPECT_TRUE((pointVel - expectedPointVel).norm() < 1e-10)
+    << "pointVel = " << pointVel.transpose() << ", expected: " << expectedPointVel.transpose();
+
+  // The inertia matrix is optional
+  VectorNd grav2(model.dof_count), coriolis2(model.dof_count);
+  fusedDynamics.update(model, Q, Qd, Qdd, NULL, grav2, coriolis2);
+
+  EXPECT_TRUE(grav2 == grav && coriolis2 == coriolis);
+}
+
+TEST_F(RbdlExtrasTest, ContactWrenchEstimatorTest)
+{
+  robotState->setJointPosition(1, boost::math::constants::pi<double>() / 2);
+
+  Vector3d position; position.setZero();
+  Vector twist(6); twist.setZero();
+  Quaternion orientation;
+  orientation.setIdentity();
+  robotState->setRobotBaseState(position, orientation, twist);
+
+  controlModel->updateJointState();
+  controlModel->update();
+
+  RigidBodyDynamics::Model & model = controlModel->rbdlModel();
+  std::vector<unsigned int> body_id; body_id.push_back(model.GetBodyId("revolute1DoF_2"));
+
+  VectorNd Tau(controlModel->getNActuableDOFs());
+  Tau << 0, 1;
+  MatrixNd U(controlModel->getNActuableDOFs(), controlModel->getNumDOFs());
+  U << 0, 0, 0, 0, 0, 0, 1, 0,
+       0, 0, 0, 0, 0, 0, 0, 1;
+
+  // Compute the expected values using the allocating functions
+  std::vector<VectorNd> expectedFrCOM;
+  RigidBodyDynamics::Extras::calcRxnFrCOM(model, controlModel->getQ(),
+    controlModel->getAinv(), U, controlModel->getGrav(), body_id, Tau, expectedFrCOM);
+
+  std::vector<VectorNd> contactNormal; contactNormal.push_back(Vector3d(0, 0, 1));
+  std::vector<VectorNd> contactPlanePoint; contactPlanePoint.push_back(Vector3d(0, 0, 0.5));
+  std::vector<VectorNd> expectedCOP;
+  RigidBodyDynamics::Extras::calcCOPfromFrCOM(model, controlModel->getQ(), body_id, expectedFrCOM,
+    contactNormal, contactPlanePoint, expectedCOP,
+    RigidBodyDynamics::Extras::Frame::WORLD,
+    RigidBodyDynamics::Extras::Frame::WORLD,
+    RigidBodyDynamics::Extras::Frame::WORLD,
+    RigidBodyDynamics::Extras::Frame::WORLD);
+
+  // Compute the expected wrench at the COP, which is given in the body frame
+  std::vector<Vector3d> copLocal;
+  copLocal.push_back(RigidBodyDynamics::CalcBaseToBodyCoordinates(model, controlModel->getQ(),
+    body_id[0], Vector3d(expectedCOP[0]), false));
+  std::vector<VectorNd> copLocalNd(copLocal.begin(), copLocal.end());
+
+  std::vector<VectorNd> expectedFrCOP;
+  RigidBodyDynamics::Extras::calcRxnFr(model, controlModel->getQ(),
+    controlModel->getAinv(), U, controlModel->getGrav(), body_id, copLocalNd, Tau, expectedFrCOP);
+
+  RigidBodyDynamics::Extras::ContactWrenchEstimator estimator;
+  estimator.init(model, body_id, copLocal);
+  estimator.updateKinematics(model, controlModel->getQ());
+
+  std::vector<int> UIndices; UIndices.push_back(6); UIndices.push_back(7);
+  estimator.estimateWrenches(controlModel->getAinv(), controlModel->getGrav(), UIndices, Tau);
+
+  std::vector<Vector3d> normals; normals.push_back(Vector3d(0, 0, 1));
+  std::vector<Vector3d> planePoints; planePoints.push_back(Vector3d(0, 0, 0.5));
+  estimator.computeCOPs(normals, planePoints, RigidBodyDynamics::Extras::Frame::WORLD);
+
+  ASSERT_EQ(1u, estimator.getNumContacts());
+  EXPECT_LT((estimator.getWrenchCOM(0) - expectedFrCOM[0]).norm(), 1e-10)
+    << "wrench at COM = " << estimator.getWrenchCOM(0).transpose()
+    << ", expected: " << expectedFrCOM[0].transpose();
+  EXPECT_LT((estimator.getCOP(0) - expectedCOP[0]).norm(), 1e-10)
+    << "COP = " << estimator.getCOP(0).transpose() << ", expected: " << expectedCOP[0].transpose();
+  EXPECT_LT((estimator.getWrench(0) - expectedFrCOP[0]).norm(), 1e-10)
+    << "wrench at COP = " << estimator.getWrench(0).transpose()
+    << ", expected: " << expectedFrCOP[0].transpose();
+}
+
+TEST_F(RbdlExtrasTest, ContactWrenchEstimatorJacobianTest)
+{
+  robotState->setJointPosition(1, boost::math::constants::pi<double>() / 2);
+
+  Vector3d position; position.setZero();
+  Vector twist(6); twist.setZero();
+  Quaternion orientation;
+  orientation.setIdentity();
+  robotState->setRobotBaseState(position, orientation, twist);
+
+  controlModel->updateJointState();
+  controlModel->update();
+
+  RigidBodyDynamics::Model & model = controlModel->rbdlModel();
+  std::vector<unsigned int> body_id; body_id.push_back(model.GetBodyId("revolute1DoF_2"));
+
+  VectorNd Tau(controlModel->getNActuableDOFs());
+  Tau << 0, 1;
+  std::vector<int> UIndices; UIndices.push_back(6); UIndices.push_back(7);
+
+  std::vector<Vector3d> normals; normals.push_back(Vector3d(0, 0, 1));
+  std::vector<Vector3d> planePoints; planePoints.push_back(Vector3d(0, 0, 0.5));
+
+  // A 6-row Jacobian evaluated at the COM gives the same results as the
+  // estimator's own Jacobian
+  RigidBodyDynamics::Extras::ContactWrenchEstimator expected;
+  expected.init(model, body_id);
+  expected.updateKinematics(model, controlModel->getQ());
+  expected.estimateWrenches(controlModel->getAinv(), controlModel->getGrav(), UIndices, Tau);
+  expected.computeCOPs(normals, planePoints, RigidBodyDynamics::Extras::Frame::WORLD);
+
+  std::vector<unsigned int> flatContact(1, 6);
+  RigidBodyDynamics::Extras::ContactWrenchEstimator estimator;
+  estimator.init(model, body_id);
+  estimator.updatePoses(model, controlModel->getQ());
+  estimator.estimateWrenches(expected.getJacobian(), flatContact,
+    controlModel->getAinv(), controlModel->getGrav(), UIndices, Tau);
+  estimator.computeCOPs(normals, planePoints, RigidBodyDynamics::Extras::Frame::WORLD);
+
+  EXPECT_LT((estimator.getWrenchCOM(0) - expected.getWrenchCOM(0)).norm(), 1e-10);
+  EXPECT_LT((estimator.getWrench(0) - expected.getWrench(0)).norm(), 1e-10);
+  EXPECT_LT((estimator.getCOP(0) - expected.getCOP(0)).norm(), 1e-10);
+
+  // A point contact away from the COM exerts only a force at the point,
+  // which is a force and a moment at the COM
+  Vector3d point(0.1, 0, -0.05);
+  std::vector<Vector3d> points; points.push_back(point);
+
+  MatrixNd Jv(3, model.dof_count); Jv.setZero();
+  RigidBodyDynamics::CalcPointJacobian(model, controlModel->getQ(), body_id[0], point, Jv, false);
+
+  VectorNd fullTau = VectorNd::Zero(model.dof_count);
+  fullTau(6) = Tau(0);
+  fullTau(7) = Tau(1);
+  VectorNd force = (Jv * controlModel->getAinv() * Jv.transpose()) * Jv * controlModel->getAinv()
+    * (controlModel->getGrav() - fullTau);
+
+  std::vector<unsigned int> pointContact(1, 3);
+  RigidBodyDynamics::Extras::ContactWrenchEstimator pointEstimator;
+  pointEstimator.init(model, body_id, points);
+  pointEstimator.updatePoses(model, controlModel->getQ());
+  pointEstimator.estimateWrenches(Jv, pointContact,
+    controlModel->getAinv(), controlModel->getGrav(), UIndices, Tau);
+
+  Vector3d worldPoint = RigidBodyDynamics::CalcBodyToBaseCoordinates(model, controlModel->getQ(),
+    body_id[0], point, false);
+  Vector3d moment = (worldPoint - pointEstimator.getCOMPosition(0)).cross(Vector3d(force));
+
+  EXPECT_LT((pointEstimator.getWrench(0).head<3>() - force).norm(), 1e-10);
+  EXPECT_LT(pointEstimator.getWrench(0).tail<3>().norm(), 1e-10);
+  EXPECT_LT((pointEstimator.getWrenchCOM(0).head<3>() - force).norm(), 1e-10);
+  EXPECT_LT((pointEstimator.getWrenchCOM(0).tail<3>() - moment).norm(), 1e-10);
+}
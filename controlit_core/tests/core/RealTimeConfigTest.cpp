@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <controlit/RealTimeConfig.hpp>
+
+using controlit::RealTimeConfig;
+using controlit::ThreadPlacement;
+
+TEST(RealTimeConfigTest, ParsesPolicies)
+{
+    int policy;
+    EXPECT_TRUE(RealTimeConfig::parsePolicy("other", policy));
+    EXPECT_EQ(SCHED_OTHER, policy);
+    EXPECT_TRUE(RealTimeConfig::parsePolicy("fifo", policy));
+    EXPECT_EQ(SCHED_FIFO, policy);
+    EXPECT_TRUE(RealTimeConfig::parsePolicy("rr", policy));
+    EXPECT_EQ(SCHED_RR, policy);
+    EXPECT_FALSE(RealTimeConfig::parsePolicy("deadline", policy));
+}
+
+TEST(RealTimeConfigTest, PlacesThreadsAndReportsFailures)
+{
+    std::map<std::string, ThreadPlacement> placements;
+
+    // Pinning to CPU zero in the default class should always succeed
+    ThreadPlacement valid;
+    valid.cpus.push_back(0);
+    placements["model_update"] = valid;
+
+    // A CPU that does not exist cannot be used
+    ThreadPlacement invalid;
+    invalid.cpus.push_back(CPU_SETSIZE - 1);
+    placements["task_update"] = invalid;
+
+    std::vector<std::string> reported;
+    RealTimeConfig::configure(placements, false, 0,
+        [&reported](const std::string & failure) { reported.push_back(failure); });
+
+    bool modelUpdatePlaced = false;
+    std::thread modelUpdate([&modelUpdatePlaced]() {
+        modelUpdatePlaced = RealTimeConfig::placeCurrentThread("model_update");
+    });
+    modelUpdate.join();
+
+    bool taskUpdatePlaced = true;
+    std::thread taskUpdate([&taskUpdatePlaced]() {
+        taskUpdatePlaced = RealTimeConfig::placeCurrentThread("task_update");
+    });
+    taskUpdate.join();
+
+    // Threads without a placement keep the default placement
+    EXPECT_TRUE(RealTimeConfig::placeCurrentThread("servo"));
+
+    EXPECT_TRUE(modelUpdatePlaced);
+    EXPECT_FALSE(taskUpdatePlaced);
+    ASSERT_EQ(1u, reported.size());
+    EXPECT_NE(std::string::npos, reported[0].find("task_update"));
+    EXPECT_EQ(1u, RealTimeConfig::getFailures().size());
+
+    // Memory is only locked if configured
+    EXPECT_FALSE(RealTimeConfig::lockMemory());
+
+    RealTimeConfig::configure(std::map<std::string, ThreadPlacement>(), false, 0, nullptr);
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include <controlit/AllocationCheck.hpp>
+#include <controlit/ScratchArena.hpp>
+
+using controlit::AllowAllocationScope;
+using controlit::NoAllocationScope;
+using controlit::ScratchArena;
+
+TEST(ScratchArenaTest, AlignedAndDisjoint)
+{
+    ScratchArena arena(1024);
+
+    ScratchArena::MatrixMap A = arena.getMatrix(3, 5);
+    ScratchArena::VectorMap b = arena.getVector(7);
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(A.data()) % ScratchArena::ALIGNMENT, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b.data()) % ScratchArena::ALIGNMENT, 0u);
+    EXPECT_GE(b.data(), A.data() + A.size());
+
+    A.setConstant(1);
+    b.setConstant(2);
+    EXPECT_EQ(A.sum(), 15);
+    EXPECT_EQ(b.sum(), 14);
+}
+
+TEST(ScratchArenaTest, ResetReusesMemory)
+{
+    ScratchArena arena(1024);
+
+    double * first = arena.getVector(10).data();
+    arena.reset();
+    EXPECT_EQ(arena.getVector(10).data(), first);
+    EXPECT_EQ(arena.getNumOverflows(), 0u);
+}
+
+TEST(ScratchArenaTest, GrowsToHighWaterMark)
+{
+    ScratchArena arena(1024);
+
+    // Exceed the capacity.  The overflow is served from the heap.
+    ScratchArena::MatrixMap A = arena.getMatrix(20, 20);
+    A.setZero();
+    EXPECT_EQ(arena.getNumOverflows(), 1u);
+    EXPECT_GT(arena.getHighWaterMark(), 1024u);
+
+    // After a reset the same request fits.
+    arena.reset();
+    EXPECT_GE(arena.getCapacity(), arena.getHighWaterMark());
+    arena.getMatrix(20, 20).setZero();
+    EXPECT_EQ(arena.getNumOverflows(), 1u);
+}
+
+TEST(ScratchArenaTest, ThreadArena)
+{
+    EXPECT_EQ(&ScratchArena::getThreadArena(), &ScratchArena::getThreadArena());
+}
+
+TEST(ScratchArenaTest, NoAllocationScopeNesting)
+{
+    EXPECT_FALSE(NoAllocationScope::isActive());
+    {
+        NoAllocationScope disabled(false);
+        EXPECT_FALSE(NoAllocationScope::isActive());
+
+        NoAllocationScope outer;
+        {
+            NoAllocationScope inner;
+            EXPECT_TRUE(NoAllocationScope::isActive());
+        }
+        EXPECT_TRUE(NoAllocationScope::isActive());
+
+        {
+            AllowAllocationScope allow;
+            EXPECT_FALSE(NoAllocationScope::isActive());
+        }
+        EXPECT_TRUE(NoAllocationScope::isActive());
+    }
+    EXPECT_FALSE(NoAllocationScope::isActive());
+}
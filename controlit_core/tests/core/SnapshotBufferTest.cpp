@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include <controlit/SnapshotBuffer.hpp>
+
+using controlit::SnapshotBuffer;
+
+namespace {
+
+/*!
+ * A snapshot whose fields are all written with the same value, so a torn
+ * snapshot can be detected.
+ */
+struct TestSnapshot
+{
+    long values[16];
+};
+
+} // namespace
+
+TEST(SnapshotBufferTest, NothingToReadInitially)
+{
+    SnapshotBuffer<int> buffer;
+    EXPECT_FALSE(buffer.update());
+}
+
+TEST(SnapshotBufferTest, ReadsLatestSnapshot)
+{
+    SnapshotBuffer<int> buffer;
+
+    buffer.getWriteBuffer() = 1;
+    buffer.publish();
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(1, buffer.getReadBuffer());
+
+    // Nothing new was published
+    EXPECT_FALSE(buffer.update());
+    EXPECT_EQ(1, buffer.getReadBuffer());
+
+    // Only the latest of several snapshots is read
+    for (int ii = 2; ii <= 5; ii++)
+    {
+        buffer.getWriteBuffer() = ii;
+        buffer.publish();
+    }
+
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(5, buffer.getReadBuffer());
+    EXPECT_FALSE(buffer.update());
+}
+
+TEST(SnapshotBufferTest, SnapshotsAreNotTorn)
+{
+    const long NUM_SNAPSHOTS = 200000;
+
+    SnapshotBuffer<TestSnapshot> buffer;
+
+    std::thread writer([&buffer, NUM_SNAPSHOTS]()
+    {
+        for (long ii = 1; ii <= NUM_SNAPSHOTS; ii++)
+        {
+            TestSnapshot & snapshot = buffer.getWriteBuffer();
+            for (auto & value : snapshot.values)
+                value = ii;
+            buffer.publish();
+        }
+    });
+
+    long lastValue = 0;
+    while (lastValue < NUM_SNAPSHOTS)
+    {
+        if (!buffer.update()) continue;
+
+        const TestSnapshot & snapshot = buffer.getReadBuffer();
+        for (auto & value : snapshot.values)
+            ASSERT_EQ(snapshot.values[0], value);
+
+        // Snapshots may be skipped but never go back in time
+        ASSERT_GT(snapshot.values[0], lastValue);
+        lastValue = snapshot.values[0];
+    }
+
+    writer.join();
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <controlit/SingleThreadedTaskUpdater.hpp>
+
+using controlit::ControlModel;
+using controlit::SingleThreadedTaskUpdater;
+using controlit::Task;
+using controlit::TaskCommand;
+using controlit::TaskState;
+
+namespace {
+
+/*!
+ * A task that records the order in which its state is updated.
+ */
+class RecordingTask : public Task
+{
+public:
+    RecordingTask(int id, double period, int priority, std::vector<int> & updates) :
+        Task("RecordingTask", controlit::ACCELERATION, new TaskState(), new TaskState()),
+        id(id),
+        updates(updates)
+    {
+        updatePeriod = period;
+        updatePriority = priority;
+    }
+
+    virtual bool getCommand(ControlModel & model, TaskCommand & command) { return true; }
+
+protected:
+    virtual bool updateStateImpl(ControlModel * model, TaskState * taskState)
+    {
+        updates.push_back(id);
+        return true;
+    }
+
+private:
+    int id;
+    std::vector<int> & updates;
+};
+
+/*!
+ * A task updater whose time is set by the test.
+ */
+class ManualClockTaskUpdater : public SingleThreadedTaskUpdater
+{
+public:
+    ManualClockTaskUpdater() : time(0) {}
+
+    double time;
+
+protected:
+    virtual double getCurrentTime() const { return time; }
+};
+
+} // namespace
+
+TEST(TaskUpdaterTest, UpdatesTasksAtTheirPeriods)
+{
+    std::vector<int> updates;
+    RecordingTask everyUpdate(0, 0, 0, updates);
+    RecordingTask fast(1, 0.5, 0, updates);
+    RecordingTask slow(2, 1.0, 0, updates);
+
+    ManualClockTaskUpdater taskUpdater;
+    taskUpdater.addTask(&slow);
+    taskUpdater.addTask(&fast);
+    taskUpdater.addTask(&everyUpdate);
+
+    // Update the model at 8 Hz for 5 seconds
+    for (int ii = 0; ii <= 40; ii++)
+    {
+        taskUpdater.time = ii * 0.125;
+        taskUpdater.updateTasks(nullptr);
+    }
+
+    int counts[3] = {0, 0, 0};
+    for (size_t ii = 0; ii < updates.size(); ii++)
+        counts[updates[ii]]++;
+
+    EXPECT_EQ(41, counts[0]);
+    EXPECT_EQ(11, counts[1]);
+    EXPECT_EQ(6, counts[2]);
+
+    // The statistics are in the order in which the tasks were added
+    EXPECT_DOUBLE_EQ(1.0, taskUpdater.getEffectiveUpdateRate(0));
+    EXPECT_DOUBLE_EQ(2.0, taskUpdater.getEffectiveUpdateRate(1));
+    EXPECT_DOUBLE_EQ(8.0, taskUpdater.getEffectiveUpdateRate(2));
+
+    taskUpdater.time = 5.25;
+    EXPECT_DOUBLE_EQ(0.25, taskUpdater.getStaleness(0));
+    EXPECT_DOUBLE_EQ(0.25, taskUpdater.getStaleness(1));
+    EXPECT_DOUBLE_EQ(0.25, taskUpdater.getStaleness(2));
+}
+
+TEST(TaskUpdaterTest, UpdatesTasksInPriorityOrder)
+{
+    std::vector<int> updates;
+    RecordingTask slow(0, 1.0, 0, updates);
+    RecordingTask fast(1, 0.5, 0, updates);
+    RecordingTask everyUpdate(2, 0, 0, updates);
+    RecordingTask critical(3, 1.0, 1, updates);
+
+    ManualClockTaskUpdater taskUpdater;
+    taskUpdater.addTask(&slow);
+    taskUpdater.addTask(&fast);
+    taskUpdater.addTask(&everyUpdate);
+    taskUpdater.addTask(&critical);
+
+    EXPECT_TRUE(std::isinf(taskUpdater.getStaleness(0)));
+
+    taskUpdater.updateTasks(nullptr);
+
+    // Higher priorities first, then shorter periods
+    ASSERT_EQ(4u, updates.size());
+    EXPECT_EQ(3, updates[0]);
+    EXPECT_EQ(2, updates[1]);
+    EXPECT_EQ(1, updates[2]);
+    EXPECT_EQ(0, updates[3]);
+
+    // Only the task without a period is due immediately afterwards
+    updates.clear();
+    taskUpdater.time = 0.25;
+    taskUpdater.updateTasks(nullptr);
+
+    ASSERT_EQ(1u, updates.size());
+    EXPECT_EQ(2, updates[0]);
+}
+
+TEST(TaskUpdaterTest, LimitsLowPriorityUpdates)
+{
+    std::vector<int> updates;
+    RecordingTask lowPriority(0, 0, 0, updates);
+    RecordingTask highPriority(1, 0, 1, updates);
+
+    ManualClockTaskUpdater taskUpdater;
+    taskUpdater.addTask(&lowPriority);
+    taskUpdater.addTask(&highPriority);
+
+    // Limit the task with priority 0 to 2 Hz while the model is updated at 8 Hz
+    taskUpdater.setMinUpdatePeriod(0.5, 0);
+
+    for (int ii = 0; ii < 8; ii++)
+    {
+        taskUpdater.time = ii * 0.125;
+        taskUpdater.updateTasks(nullptr);
+    }
+
+    int counts[2] = {0, 0};
+    for (size_t ii = 0; ii < updates.size(); ii++)
+        counts[updates[ii]]++;
+
+    EXPECT_EQ(2, counts[0]);
+    EXPECT_EQ(8, counts[1]);
+
+    // Removing the limit updates the task every time again
+    updates.clear();
+    taskUpdater.setMinUpdatePeriod(0, 0);
+
+    for (int ii = 8; ii < 12; ii++)
+    {
+        taskUpdater.time = ii * 0.125;
+        taskUpdater.updateTasks(nullptr);
+    }
+
+    counts[0] = counts[1] = 0;
+    for (size_t ii = 0; ii < updates.size(); ii++)
+        counts[updates[ii]]++;
+
+    EXPECT_EQ(4, counts[0]);
+    EXPECT_EQ(4, counts[1]);
+}
+
+TEST(TaskUpdaterTest, StatisticsCanBeReadWhileUpdating)
+{
+    std::vector<int> updates;
+    RecordingTask everyUpdate(0, 0, 0, updates);
+
+    ManualClockTaskUpdater taskUpdater;
+    taskUpdater.addTask(&everyUpdate);
+
+    std::atomic<bool> done(false);
+
+    // Update the model at 8 Hz on another thread, as the updater thread does
+    std::thread updaterThread([&]()
+    {
+        for (int ii = 0; ii < 10000; ii++)
+        {
+            taskUpdater.time = ii * 0.125;
+            taskUpdater.updateTasks(nullptr);
+        }
+        done = true;
+    });
+
+    // The servo thread only ever sees a complete rate
+    while (!done)
+    {
+        double rate = taskUpdater.getEffectiveUpdateRate(0);
+        EXPECT_TRUE(rate == 0 || rate == 8.0) << "rate = " << rate;
+    }
+
+    updaterThread.join();
+
+    EXPECT_DOUBLE_EQ(8.0, taskUpdater.getEffectiveUpdateRate(0));
+}
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <controlit/Trajectory.hpp>
+
+using controlit::Trajectory;
+using controlit::Matrix;
+using controlit::Vector;
+
+namespace {
+
+const double TOLERANCE = 1e-9;
+const double TIME_STEP = 1e-4;
+
+/*!
+ * Samples the trajectory and checks that the position is continuous and
+ * that the velocity is the derivative of the position.
+ *
+ * \return The maximum absolute velocity and acceleration of each dimension.
+ */
+void checkSmoothness(Trajectory & trajectory, Vector & maxVelocity, Vector & maxAcceleration)
+{
+    int numDims = trajectory.getNumDims();
+    Vector position(numDims), velocity(numDims);
+    Vector prevPosition(numDims), prevVelocity(numDims);
+
+    maxVelocity.setZero(numDims);
+    maxAcceleration.setZero(numDims);
+
+    ASSERT_TRUE(trajectory.evaluate(0, prevPosition, prevVelocity));
+
+    for (double time = TIME_STEP; time <= trajectory.getDuration() + TIME_STEP; time += TIME_STEP)
+    {
+        ASSERT_TRUE(trajectory.evaluate(time, position, velocity));
+
+        Vector finiteDifference = (position - prevPosition) / TIME_STEP;
+        Vector averageVelocity = 0.5 * (velocity + prevVelocity);
+        EXPECT_TRUE((finiteDifference - averageVelocity).norm() < 1e-3 * std::max(1.0, averageVelocity.norm()))
+            << "Position and velocity are inconsistent at time " << time << ":\n"
+            << " - finite difference: " << finiteDifference.transpose() << "\n"
+            << " - velocity: " << averageVelocity.transpose();
+
+        maxVelocity = maxVelocity.cwiseMax(velocity.cwiseAbs());
+        maxAcceleration = maxAcceleration.cwiseMax(((velocity - prevVelocity) / TIME_STEP).cwiseAbs());
+
+        prevPosition = position;
+        prevVelocity = velocity;
+    }
+}
+
+/*!
+ * Checks that the trajectory is at the specified waypoint at the specified time.
+ */
+void expectAtWaypoint(Trajectory & trajectory, double time, const Vector & waypoint)
+{
+    Vector position, velocity;
+    ASSERT_TRUE(trajectory.evaluate(time, position, velocity));
+    EXPECT_TRUE((position - waypoint).norm() < TOLERANCE)
+        << "At time " << time << " the position is " << position.transpose()
+        << " but the waypoint is " << waypoint.transpose();
+}
+
+} // namespace
+
+TEST(TrajectoryTest, TrapezoidVelocity)
+{
+    Trajectory trajectory;
+    trajectory.reserve(3, 16);
+
+    Matrix waypoints(3, 3);
+    waypoints << 0,  2,  2,
+                 0, -1,  1,
+                 1,  1,  0.9;
+
+    Vector maxVelocity(3), maxAcceleration(3);
+    maxVelocity << 1, 1, 1;
+    maxAcceleration << 2, 4, 4;
+
+    // The second waypoint is reached as soon as possible and the third one later.
+    std::vector<double> times = {0, 0, 10};
+    ASSERT_TRUE(trajectory.setWaypoints(Trajectory::TRAPEZOID_VELOCITY, times, waypoints, maxVelocity, maxAcceleration));
+
+    // Dimension 0 moves 2 with vmax = 1 and amax = 2, so it accelerates for
+    // 0.5s, cruises for 1.5s, and decelerates for 0.5s.
+    EXPECT_EQ(trajectory.getNumSegments(), 6);
+    EXPECT_NEAR(trajectory.getDuration(), 10, TOLERANCE);
+
+    expectAtWaypoint(trajectory, 0, waypoints.col(0));
+    expectAtWaypoint(trajectory, 2.5, waypoints.col(1));
+    expectAtWaypoint(trajectory, 10, waypoints.col(2));
+    expectAtWaypoint(trajectory, 11, waypoints.col(2));
+
+    Vector position, velocity;
+    trajectory.evaluate(1.0, position, velocity);
+    EXPECT_NEAR(velocity[0], 1, TOLERANCE);
+    EXPECT_NEAR(velocity[1], -0.5, TOLERANCE);
+
+    Vector peakVelocity, peakAcceleration;
+    checkSmoothness(trajectory, peakVelocity, peakAcceleration);
+
+    EXPECT_TRUE((peakVelocity.array() <= maxVelocity.array() + TOLERANCE).all())
+        << "Peak velocity " << peakVelocity.transpose() << " exceeds " << maxVelocity.transpose();
+    EXPECT_TRUE((peakAcceleration.array() <= maxAcceleration.array() + 1e-3).all())
+        << "Peak acceleration " << peakAcceleration.transpose() << " exceeds " << maxAcceleration.transpose();
+
+    // The robot is at rest at every waypoint
+    trajectory.evaluate(2.5, position, velocity);
+    EXPECT_NEAR(velocity.norm(), 0, TOLERANCE);
+    trajectory.evaluate(10, position, velocity);
+    EXPECT_NEAR(velocity.norm(), 0, TOLERANCE);
+}
+
+TEST(TrajectoryTest, TrapezoidVelocityTriangle)
+{
+    Trajectory trajectory;
+    trajectory.reserve(1, 16);
+
+    Matrix waypoints(1, 2);
+    waypoints << 0, 1;
+
+    Vector maxVelocity(1), maxAcceleration(1);
+    maxVelocity << 10;
+    maxAcceleration << 1;
+
+    // The velocity limit is never reached, so the profile is a triangle.
+    std::vector<double> times = {0, 0};
+    ASSERT_TRUE(trajectory.setWaypoints(Trajectory::TRAPEZOID_VELOCITY, times, waypoints, maxVelocity, maxAcceleration));
+    EXPECT_EQ(trajectory.getNumSegments(), 2);
+    EXPECT_NEAR(trajectory.getDuration(), 2, TOLERANCE);
+
+    Vector position, velocity;
+    trajectory.evaluate(1, position, velocity);
+    EXPECT_NEAR(position[0], 0.5, TOLERANCE);
+    EXPECT_NEAR(velocity[0], 1, TOLERANCE);
+}
+
+TEST(TrajectoryTest, Splines)
+{
+    Matrix waypoints(2, 5);
+    waypoints << 0, 1, 3, 2, 2,
+                 0, 0, -1, 1, 0;
+    std::vector<double> times = {0, 1, 1.5, 3, 4};
+
+    Trajectory::InterpolationType types[] = {Trajectory::CUBIC_SPLINE, Trajectory::QUINTIC_SPLINE};
+
+    for (auto type : types)
+    {
+        Trajectory trajectory;
+        trajectory.reserve(2, 8);
+
+        ASSERT_TRUE(trajectory.setWaypoints(type, times, waypoints, Vector(), Vector()));
+        EXPECT_EQ(trajectory.getNumSegments(), 4);
+
+        for (size_t ii = 0; ii < times.size(); ii++)
+            expectAtWaypoint(trajectory, times[ii], waypoints.col(ii));
+
+        Vector peakVelocity, peakAcceleration;
+        checkSmoothness(trajectory, peakVelocity, peakAcceleration);
+
+        // The trajectory starts and ends at rest
+        Vector position, velocity;
+        trajectory.evaluate(0, position, velocity);
+        EXPECT_NEAR(velocity.norm(), 0, TOLERANCE);
+        trajectory.evaluate(4, position, velocity);
+        EXPECT_NEAR(velocity.norm(), 0, TOLERANCE);
+
+        // The acceleration is continuous at the interior knots
+        for (size_t ii = 1; ii < times.size() - 1; ii++)
+        {
+            Vector before, after, unused;
+            trajectory.evaluate(times[ii] - 2 * TIME_STEP, unused, before);
+            trajectory.evaluate(times[ii] - TIME_STEP, unused, after);
+            Vector accelBefore = (after - before) / TIME_STEP;
+
+            trajectory.evaluate(times[ii] + TIME_STEP, unused, before);
+            trajectory.evaluate(times[ii] + 2 * TIME_STEP, unused, after);
+            Vector accelAfter = (after - before) / TIME_STEP;
+
+            EXPECT_TRUE((accelBefore - accelAfter).norm() < 0.1)
+                << "Acceleration jumps at knot " << ii << " from " << accelBefore.transpose()
+                << " to " << accelAfter.transpose();
+        }
+
+        // Only the quintic spline starts with zero acceleration
+        Vector start, next;
+        trajectory.evaluate(0, position, start);
+        trajectory.evaluate(TIME_STEP, position, next);
+        double startAcceleration = ((next - start) / TIME_STEP).norm();
+
+        if (type == Trajectory::QUINTIC_SPLINE)
+            EXPECT_LT(startAcceleration, 1e-2);
+        else
+            EXPECT_GT(startAcceleration, 1);
+    }
+}
+
+TEST(TrajectoryTest, CubicSplineReproducesCubic)
+{
+    // p(t) = 3t^2 - 2t^3 is at rest at t = 0 and t = 1, so a cubic spline
+    // through samples of it must reproduce it exactly.
+    std::vector<double> times = {0, 0.3, 0.5, 0.8, 1};
+    Matrix waypoints(1, times.size());
+    for (size_t ii = 0; ii < times.size(); ii++)
+        waypoints(0, ii) = 3 * std::pow(times[ii], 2) - 2 * std::pow(times[ii], 3);
+
+    Trajectory trajectory;
+    trajectory.reserve(1, 8);
+    ASSERT_TRUE(trajectory.setWaypoints(Trajectory::CUBIC_SPLINE, times, waypoints, Vector(), Vector()));
+
+    Vector position, velocity;
+    for (double time = 0; time <= 1; time += 0.01)
+    {
+        trajectory.evaluate(time, position, velocity);
+        EXPECT_NEAR(position[0], 3 * time * time - 2 * time * time * time, TOLERANCE) << "at time " << time;
+        EXPECT_NEAR(velocity[0], 6 * time - 6 * time * time, TOLERANCE) << "at time " << time;
+    }
+}
+
+TEST(TrajectoryTest, MinimumJerk)
+{
+    Trajectory trajectory;
+    trajectory.reserve(1, 4);
+
+    Matrix waypoints(1, 3);
+    waypoints << 0, 2, 1;
+    std::vector<double> times = {0, 2, 3};
+
+    ASSERT_TRUE(trajectory.setWaypoints(Trajectory::MINIMUM_JERK, times, waypoints, Vector(), Vector()));
+
+    // The midpoint of a minimum-jerk motion is halfway there at 15 / 8 of
+    // the average velocity.
+    Vector position, velocity;
+    trajectory.evaluate(1, position, velocity);
+    EXPECT_NEAR(position[0], 1, TOLERANCE);
+    EXPECT_NEAR(velocity[0], 1.875, TOLERANCE);
+
+    trajectory.evaluate(2, position, velocity);
+    EXPECT_NEAR(position[0], 2, TOLERANCE);
+    EXPECT_NEAR(velocity[0], 0, TOLERANCE);
+
+    Vector peakVelocity, peakAcceleration;
+    checkSmoothness(trajectory, peakVelocity, peakAcceleration);
+}
+
+TEST(TrajectoryTest, RejectsInvalidWaypoints)
+{
+    Trajectory trajectory;
+    trajectory.reserve(2, 2);
+
+    Matrix waypoints = Matrix::Random(2, 3);
+    Vector limits = Vector::Ones(2);
+    Vector position, velocity;
+
+    // Times that do not increase
+    EXPECT_FALSE(trajectory.setWaypoints(Trajectory::CUBIC_SPLINE, {0, 1, 1}, waypoints, limits, limits));
+    EXPECT_FALSE(trajectory.setWaypoints(Trajectory::TRAPEZOID_VELOCITY, {0, 1, 0.5}, waypoints, limits, limits));
+
+    // A trajectory that does not start at time zero
+    EXPECT_FALSE(trajectory.setWaypoints(Trajectory::MINIMUM_JERK, {1, 2, 3}, waypoints, limits, limits));
+
+    // The wrong number of dimensions
+    EXPECT_FALSE(trajectory.setWaypoints(Trajectory::MINIMUM_JERK, {0, 1, 2}, Matrix::Random(3, 3), limits, limits));
+
+    // Missing limits
+    EXPECT_FALSE(trajectory.setWaypoints(Trajectory::TRAPEZOID_VELOCITY, {0, 1, 2}, waypoints, Vector(), Vector()));
+
+    // Too many segments
+    EXPECT_FALSE(trajectory.setWaypoints(Trajectory::TRAPEZOID_VELOCITY, {0, 1, 2}, waypoints, limits, limits));
+
+    EXPECT_TRUE(trajectory.empty());
+    EXPECT_FALSE(trajectory.evaluate(0, position, velocity));
+
+    EXPECT_TRUE(trajectory.setWaypoints(Trajectory::MINIMUM_JERK, {0, 1, 2}, waypoints, limits, limits));
+}
+
+TEST(TrajectoryTest, Swap)
+{
+    Trajectory active, pending;
+    active.reserve(2, 4);
+    pending.reserve(2, 4);
+
+    Matrix waypoints(2, 2);
+    waypoints << 0, 1,
+                 0, 1;
+    ASSERT_TRUE(pending.setWaypoints(Trajectory::MINIMUM_JERK, {0, 1}, waypoints, Vector(), Vector()));
+
+    active.swap(pending);
+    EXPECT_EQ(active.getNumSegments(), 1);
+    EXPECT_TRUE(pending.empty());
+    EXPECT_EQ(pending.getMaxSegments(), 4);
+
+    expectAtWaypoint(active, 1, waypoints.col(1));
+}
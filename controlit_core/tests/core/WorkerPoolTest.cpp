@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <controlit/WorkerPool.hpp>
+
+using controlit::WorkerPool;
+
+namespace {
+
+/*!
+ * Waits up to one second for a condition to become true.
+ */
+template<typename Condition>
+bool waitFor(Condition condition)
+{
+    for (int ii = 0; ii < 1000 && !condition(); ii++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return condition();
+}
+
+/*!
+ * Keeps the CPU busy for a number of nanoseconds.
+ */
+void spin(int64_t durationNS)
+{
+    int64_t endNS = WorkerPool::now() + durationNS;
+    while (WorkerPool::now() < endNS)
+        continue;
+}
+
+} // namespace
+
+TEST(WorkerPoolTest, RunsSubmittedJobs)
+{
+    WorkerPool pool;
+    ASSERT_TRUE(pool.init(2, std::vector<int>(), 0.01));
+
+    std::atomic<int> count1(0), count2(0);
+    WorkerPool::Account * account1 = pool.addAccount("controller1", 0);
+    WorkerPool::Account * account2 = pool.addAccount("controller2", 0);
+    WorkerPool::Job * job1 = pool.addJob(account1, [&count1] { count1++; });
+    WorkerPool::Job * job2 = pool.addJob(account2, [&count2] { count2++; });
+
+    ASSERT_TRUE(pool.start());
+
+    job1->submit();
+    EXPECT_TRUE(waitFor([&count1] { return count1 == 1; }));
+
+    job2->submit();
+    EXPECT_TRUE(waitFor([&count2] { return count2 == 1; }));
+
+    for (int ii = 2; ii <= 10; ii++)
+    {
+        job1->submit();
+        EXPECT_TRUE(waitFor([&count1, ii] { return count1 == ii; }));
+    }
+
+    EXPECT_EQ(count2, 1);
+
+    WorkerPool::Statistics statistics = pool.getStatistics(account1, true);
+    EXPECT_EQ(statistics.numJobs, 10u);
+    EXPECT_EQ(statistics.numThrottled, 0u);
+    EXPECT_GE(statistics.maxQueueLatency, 0);
+    EXPECT_GT(statistics.duration, 0);
+
+    EXPECT_EQ(pool.getStatistics(account1, false).numJobs, 0u);
+    EXPECT_EQ(pool.getStatistics(account2, false).numJobs, 1u);
+}
+
+TEST(WorkerPoolTest, CoalescesPendingSubmissions)
+{
+    WorkerPool pool;
+    ASSERT_TRUE(pool.init(1, std::vector<int>(), 0.01));
+
+    std::atomic<bool> release(false);
+    std::atomic<int> blockerCount(0), count(0);
+
+    WorkerPool::Account * account = pool.addAccount("controller", 0);
+    WorkerPool::Job * blocker = pool.addJob(account, [&release, &blockerCount]
+    {
+        blockerCount++;
+        while (!release) std::this_thread::yield();
+    });
+    WorkerPool::Job * job = pool.addJob(account, [&count] { count++; });
+
+    ASSERT_TRUE(pool.start());
+
+    // Occupy the only worker while the job is submitted several times
+    blocker->submit();
+    ASSERT_TRUE(waitFor([&blockerCount] { return blockerCount == 1; }));
+
+    job->submit();
+    job->submit();
+    job->submit();
+
+    release = true;
+    EXPECT_TRUE(waitFor([&count] { return count == 1; }));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(count, 1);
+}
+
+TEST(WorkerPoolTest, CancelsPendingSubmissions)
+{
+    WorkerPool pool;
+    ASSERT_TRUE(pool.init(1, std::vector<int>(), 0.01));
+
+    std::atomic<bool> release(false);
+    std::atomic<int> blockerCount(0), count(0);
+
+    WorkerPool::Account * account = pool.addAccount("controller", 0);
+    WorkerPool::Job * blocker = pool.addJob(account, [&release, &blockerCount]
+    {
+        blockerCount++;
+        while (!release) std::this_thread::yield();
+    });
+    WorkerPool::Job * job = pool.addJob(account, [&count] { count++; });
+
+    ASSERT_TRUE(pool.start());
+
+    // A job that is not pending cannot be withdrawn
+    EXPECT_FALSE(job->cancel());
+
+    // Occupy the only worker so that the job stays pending
+    blocker->submit();
+    ASSERT_TRUE(waitFor([&blockerCount] { return blockerCount == 1; }));
+
+    job->submit();
+    EXPECT_TRUE(job->cancel());
+    EXPECT_FALSE(job->cancel());
+
+    release = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(count, 0);
+
+    // Once a worker claimed the job it can no longer be withdrawn
+    job->submit();
+    EXPECT_TRUE(waitFor([&count] { return count == 1; }));
+    EXPECT_FALSE(job->cancel());
+}
+
+TEST(WorkerPoolTest, EnforcesQuota)
+{
+    const double PERIOD = 0.02;
+    const int64_t JOB_DURATION_NS = 2000000;
+
+    WorkerPool pool;
+    ASSERT_TRUE(pool.init(1, std::vector<int>(), PERIOD));
+
+    // The limited account may use 10% of the core, i.e., one job per period
+    WorkerPool::Account * limited = pool.addAccount("limited", 0.1);
+    WorkerPool::Account * unlimited = pool.addAccount("unlimited", 0);
+
+    WorkerPool::Job * limitedJob = pool.addJob(limited, [JOB_DURATION_NS] { spin(JOB_DURATION_NS); });
+    WorkerPool::Job * unlimitedJob = pool.addJob(unlimited, [JOB_DURATION_NS] { spin(JOB_DURATION_NS); });
+
+    ASSERT_TRUE(pool.start());
+
+    // Keep both jobs pending for ten periods
+    int64_t endNS = WorkerPool::now() + static_cast<int64_t>(10 * PERIOD * 1e9);
+    while (WorkerPool::now() < endNS)
+    {
+        limitedJob->submit();
+        unlimitedJob->submit();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    pool.stop();
+
+    WorkerPool::Statistics limitedStatistics = pool.getStatistics(limited, false);
+    WorkerPool::Statistics unlimitedStatistics = pool.getStatistics(unlimited, false);
+
+    EXPECT_GT(limitedStatistics.numThrottled, 0u);
+    EXPECT_LE(limitedStatistics.numJobs, 12u);
+    EXPECT_GT(unlimitedStatistics.numJobs, limitedStatistics.numJobs);
+    EXPECT_EQ(unlimitedStatistics.numThrottled, 0u);
+}
@@ -23,6 +23,8 @@
 
 #include <string>
 #include <sstream>
+#include <iostream>
+#include <cassert>
 
 // Assert with exception
 #define controlit_assert_msg(expr, msg)                                   \
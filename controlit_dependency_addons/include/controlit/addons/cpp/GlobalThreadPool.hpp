@@ -22,6 +22,8 @@
 #define __CONTROLIT_ADDONS_CPP_GLOBAL_THREAD_POOL_HPP__
 
 #include <functional>
+#include <thread>
+#include <vector>
 
 namespace controlit {
 namespace addons {
@@ -58,6 +60,12 @@ void unlock_thread_pool();
  */
 void queue_and_unlock_thread_pool(std::function<void()> job);
 
+/*! \brief Gets the threads of the global thread pool.
+ *	\return The native handles of the threads.
+ *	\note This function is not real-time safe.
+ */
+std::vector<std::thread::native_handle_type> get_thread_pool_native_handles();
+
 } // namespace cpp
 } // namespace addons
 } // namespace controlit
@@ -22,6 +22,7 @@
 #define __CONTROLIT_ADDONS_CPP_THREAD_POOL_HPP__
 
 #include <thread>
+#include <vector>
 #include <mutex>
 #include <queue>
 #include <functional>
@@ -52,6 +53,16 @@ public:
     // USE LOCK OR TRYLOCK FIRST BEFORE CALLING THIS FUNCTION!
     void addJobAndUnlock(Job_t);
 
+    // Pins worker i to CPU cpus[i % cpus.size()]. Returns false if any
+    // worker could not be pinned.
+    bool setAffinity(const std::vector<int> & cpus);
+
+    size_t size() const {return workers_.size();}
+
+    // Returns the native handles of the workers, e.g. to set their
+    // scheduling policies.
+    std::vector<std::thread::native_handle_type> getNativeHandles();
+
 private:
     void processQueue(size_t id);
 
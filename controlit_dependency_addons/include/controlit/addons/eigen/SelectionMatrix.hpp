@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_ADDONS_EIGEN_SELECTION_MATRIX__
+#define __CONTROLIT_ADDONS_EIGEN_SELECTION_MATRIX__
+
+#include <vector>
+#include <Eigen/Dense>
+#include <controlit/addons/cpp/Assert.hpp>
+
+namespace controlit {
+namespace addons {
+namespace eigen {
+
+/*!
+ * A selection matrix stored as an index map.  Row ii of the equivalent
+ * dense 0/1 matrix S contains a single one in column indices[ii].
+ * Multiplying by S is therefore a row or column gather, and multiplying
+ * by S^T is a scatter.  The functions below perform these operations
+ * directly so that no dense products with S are ever formed.
+ */
+typedef std::vector<int> SelectionIndices;
+
+/*!
+ * Fills a dense matrix with the selection matrix described by an index map.
+ *
+ * \param[in] indices The index map.  Its length is the number of rows of S.
+ * \param[in] numCols The number of columns of S.
+ * \param[out] S Where the dense selection matrix should be stored.
+ */
+template<typename DerivedS>
+void selectionToDense(const SelectionIndices & indices, int numCols,
+  Eigen::MatrixBase<DerivedS> & S)
+{
+    S.derived().setZero(indices.size(), numCols);
+    for (size_t ii = 0; ii < indices.size(); ii++)
+        S(ii, indices[ii]) = 1.0;
+}
+
+/*!
+ * Computes S * M by gathering the rows of M.
+ *
+ * \param[in] indices The index map of S.
+ * \param[in] M The matrix or vector being selected from.
+ * \param[out] result Where S * M is stored.  It must not alias M.
+ */
+template<typename DerivedM, typename DerivedR>
+void selectRows(const SelectionIndices & indices,
+  const Eigen::MatrixBase<DerivedM> & M, Eigen::MatrixBase<DerivedR> & result)
+{
+    controlit_assert_msg(result.rows() == (int)indices.size() && result.cols() == M.cols(),
+        "selectRows: result has invalid size (" << result.rows() << "x" << result.cols() << ")");
+
+    for (size_t ii = 0; ii < indices.size(); ii++)
+        result.row(ii) = M.row(indices[ii]);
+}
+
+/*!
+ * Computes M * S^T by gathering the columns of M.
+ *
+ * \param[in] M The matrix being selected from.
+ * \param[in] indices The index map of S.
+ * \param[out] result Where M * S^T is stored.  It must not alias M.
+ */
+template<typename DerivedM, typename DerivedR>
+void selectCols(const Eigen::MatrixBase<DerivedM> & M,
+  const SelectionIndices & indices, Eigen::MatrixBase<DerivedR> & result)
+{
+    controlit_assert_msg(result.rows() == M.rows() && result.cols() == (int)indices.size(),
+        "selectCols: result has invalid size (" << result.rows() << "x" << result.cols() << ")");
+
+    for (size_t jj = 0; jj < indices.size(); jj++)
+        result.col(jj) = M.col(indices[jj]);
+}
+
+/*!
+ * Computes S * M * S^T by gathering a principal sub-matrix of M.
+ *
+ * \param[in] indices The index map of S.
+ * \param[in] M A square matrix.
+ * \param[out] result Where S * M * S^T is stored.  It must not alias M.
+ */
+template<typename DerivedM, typename DerivedR>
+void selectRowsCols(const SelectionIndices & indices,
+  const Eigen::MatrixBase<DerivedM> & M, Eigen::MatrixBase<DerivedR> & result)
+{
+    controlit_assert_msg(result.rows() == (int)indices.size() && result.cols() == (int)indices.size(),
+        "selectRowsCols: result has invalid size (" << result.rows() << "x" << result.cols() << ")");
+
+    for (size_t jj = 0; jj < indices.size(); jj++)
+        for (size_t ii = 0; ii < indices.size(); ii++)
+            result(ii, jj) = M(indices[ii], indices[jj]);
+}
+
+/*!
+ * Computes S^T * v by scattering the elements of v.  Elements of the
+ * result that are not selected are set to zero.
+ *
+ * \param[in] indices The index map of S.
+ * \param[in] v A vector whose length equals the number of rows in S.
+ * \param[out] result Where S^T * v is stored.  Its length is the number of columns in S.
+ */
+template<typename DerivedV, typename DerivedR>
+void scatterRows(const SelectionIndices & indices,
+  const Eigen::MatrixBase<DerivedV> & v, Eigen::MatrixBase<DerivedR> & result)
+{
+    controlit_assert_msg(v.size() == (int)indices.size(),
+        "scatterRows: input has invalid size " << v.size() << ", expected " << indices.size());
+
+    result.setZero();
+    for (size_t ii = 0; ii < indices.size(); ii++)
+        result(indices[ii]) = v(ii);
+}
+
+} // namespace eigen
+} // namespace addons
+} // namespace controlit
+
+#endif // __CONTROLIT_ADDONS_EIGEN_SELECTION_MATRIX__
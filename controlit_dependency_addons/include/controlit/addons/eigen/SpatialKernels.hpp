@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_ADDONS_EIGEN_SPATIAL_KERNELS__
+#define __CONTROLIT_ADDONS_EIGEN_SPATIAL_KERNELS__
+
+#include <Eigen/Dense>
+#include <controlit/addons/cpp/Assert.hpp>
+
+namespace controlit {
+namespace addons {
+namespace eigen {
+
+/*!
+ * Kernels for the 3 x 3 by 3 x N products that dominate task Jacobian
+ * assembly, e.g., VectorCrossMatrix(x) * Jw and R^T * P * R * J.
+ *
+ * The 3 x 3 factors are always formed with fixed-size arithmetic first so
+ * that every product with a 3 x N Jacobian is done in a single pass without
+ * temporaries.  The 3 x N operands may be blocks of larger matrices, e.g.,
+ * rows 3 to 5 of a stacked 9 x N Jacobian.
+ */
+typedef Eigen::Matrix<double, 3, Eigen::Dynamic> Matrix3Xd;
+typedef Eigen::Ref<const Matrix3Xd, 0, Eigen::OuterStride<> > ConstJacobian3X;
+typedef Eigen::Ref<Matrix3Xd, 0, Eigen::OuterStride<> > Jacobian3X;
+
+/*!
+ * Returns the skew-symmetric matrix [v]x such that [v]x * w = v.cross(w).
+ * This is identical to RigidBodyDynamics::Math::VectorCrossMatrix.
+ *
+ * \param[in] v The vector.
+ * \return The 3 x 3 cross product matrix of v.
+ */
+inline Eigen::Matrix3d skewMatrix(const Eigen::Vector3d & v)
+{
+    Eigen::Matrix3d S;
+    S <<   0.0, -v(2),  v(1),
+          v(2),   0.0, -v(0),
+         -v(1),  v(0),   0.0;
+    return S;
+}
+
+/*!
+ * Returns R^T * P * R, the projection P expressed in the frame rotated by R.
+ *
+ * \param[in] R The rotation matrix.
+ * \param[in] P The projection matrix.
+ * \return R^T * P * R
+ */
+inline Eigen::Matrix3d rotateProjectRotate(const Eigen::Matrix3d & R, const Eigen::Matrix3d & P)
+{
+    Eigen::Matrix3d result;
+    result.noalias() = R.transpose() * (P * R);
+    return result;
+}
+
+namespace detail {
+
+/*!
+ * Computes out = M * J, or out += M * J if accumulate is true, where J and
+ * out are 3 x n column-major blocks whose columns start jStride and outStride
+ * doubles apart, respectively.
+ *
+ * The nine coefficients of M are hoisted into registers so that each column
+ * costs three loads, nine multiply-adds, and three stores.  At the sizes seen
+ * in task Jacobians (n of a few dozen) this beats both Eigen's generic
+ * dynamic product and an explicit AVX kernel, whose unaligned overlapping
+ * loads and per-call coefficient shuffling cost more than they save.
+ */
+inline void multiply3xN(const Eigen::Matrix3d & M, const double * J, int jStride,
+    double * out, int outStride, int n, bool accumulate)
+{
+    const double m00 = M(0, 0), m01 = M(0, 1), m02 = M(0, 2);
+    const double m10 = M(1, 0), m11 = M(1, 1), m12 = M(1, 2);
+    const double m20 = M(2, 0), m21 = M(2, 1), m22 = M(2, 2);
+
+    for (int jj = 0; jj < n; jj++, J += jStride, out += outStride)
+    {
+        const double x = J[0], y = J[1], z = J[2];
+        const double r0 = m00 * x + m01 * y + m02 * z;
+        const double r1 = m10 * x + m11 * y + m12 * z;
+        const double r2 = m20 * x + m21 * y + m22 * z;
+
+        if (accumulate)
+        {
+            out[0] += r0;
+            out[1] += r1;
+            out[2] += r2;
+        }
+        else
+        {
+            out[0] = r0;
+            out[1] = r1;
+            out[2] = r2;
+        }
+    }
+}
+
+/*!
+ * Checks the operands and runs the kernel on them.
+ */
+inline void multiply3xN(const Eigen::Matrix3d & M, const ConstJacobian3X & J,
+    Jacobian3X & result, bool accumulate)
+{
+    controlit_assert_msg(J.cols() == result.cols(),
+        "multiply3xN: dimension mismatch, J has " << J.cols() << " columns, result has " << result.cols());
+    controlit_assert_msg(J.data() != result.data(),
+        "multiply3xN: result must not alias J");
+
+    multiply3xN(M, J.data(), J.outerStride(), result.data(), result.outerStride(), J.cols(), accumulate);
+}
+
+} // namespace detail
+
+/*!
+ * Computes result = M * J.
+ *
+ * \param[in] M A 3 x 3 matrix.
+ * \param[in] J A 3 x N matrix, e.g., a linear or angular point Jacobian.
+ * \param[out] result Where M * J is stored.  It must be 3 x N and must not alias J.
+ */
+inline void multiply3xN(const Eigen::Matrix3d & M, const ConstJacobian3X & J, Jacobian3X result)
+{
+    detail::multiply3xN(M, J, result, false);
+}
+
+/*!
+ * Computes result += M * J.
+ *
+ * \param[in] M A 3 x 3 matrix.
+ * \param[in] J A 3 x N matrix.
+ * \param[in,out] result The 3 x N matrix being accumulated into.  It must not alias J.
+ */
+inline void multiplyAdd3xN(const Eigen::Matrix3d & M, const ConstJacobian3X & J, Jacobian3X result)
+{
+    detail::multiply3xN(M, J, result, true);
+}
+
+/*!
+ * Computes result = [v]x * J, i.e., the cross product of v with every column of J.
+ *
+ * \param[in] v The vector whose cross product matrix premultiplies J.
+ * \param[in] J A 3 x N matrix.
+ * \param[out] result Where [v]x * J is stored.  It must not alias J.
+ */
+inline void skewMultiply3xN(const Eigen::Vector3d & v, const ConstJacobian3X & J, Jacobian3X result)
+{
+    detail::multiply3xN(skewMatrix(v), J, result, false);
+}
+
+/*!
+ * Computes result += [v]x * J.
+ *
+ * \param[in] v The vector whose cross product matrix premultiplies J.
+ * \param[in] J A 3 x N matrix.
+ * \param[in,out] result The 3 x N matrix being accumulated into.  It must not alias J.
+ */
+inline void skewMultiplyAdd3xN(const Eigen::Vector3d & v, const ConstJacobian3X & J, Jacobian3X result)
+{
+    detail::multiply3xN(skewMatrix(v), J, result, true);
+}
+
+} // namespace eigen
+} // namespace addons
+} // namespace controlit
+
+#endif // __CONTROLIT_ADDONS_EIGEN_SPATIAL_KERNELS__
@@ -48,6 +48,11 @@ void queue_and_unlock_thread_pool(std::function<void()> job)
     gThreadPool.addJobAndUnlock(job);
 }
 
+std::vector<std::thread::native_handle_type> get_thread_pool_native_handles()
+{
+    return gThreadPool.getNativeHandles();
+}
+
 } // namespace cpp
 } // namespace addons
 } // namespace controlit
\ No newline at end of file
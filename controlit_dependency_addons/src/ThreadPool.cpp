@@ -20,6 +20,10 @@
 
 #include <controlit/addons/cpp/ThreadPool.hpp>
 
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+
 namespace controlit {
 namespace addons {
 namespace cpp {
@@ -80,6 +84,33 @@ void ThreadPool::addJobAndUnlock(ThreadPool::Job_t job)
     cv_.notify_one();
 }
 
+bool ThreadPool::setAffinity(const std::vector<int> & cpus)
+{
+    if (cpus.empty())
+        return true;
+
+    bool result = true;
+    for (size_t i = 0; i < workers_.size(); ++i)
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpus[i % cpus.size()], &cpuSet);
+
+        if (pthread_setaffinity_np(workers_[i].native_handle(), sizeof(cpu_set_t), &cpuSet) != 0)
+            result = false;
+    }
+
+    return result;
+}
+
+std::vector<std::thread::native_handle_type> ThreadPool::getNativeHandles()
+{
+    std::vector<std::thread::native_handle_type> handles;
+    for (auto & worker : workers_)
+        handles.push_back(worker.native_handle());
+    return handles;
+}
+
 void ThreadPool::processQueue(size_t id)
 {
     while (true)
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_EXEC_CONTROLIT_HOST_HPP__
+#define __CONTROLIT_EXEC_CONTROLIT_HOST_HPP__
+
+#include "ros/ros.h"
+#include <controlit/Coordinator.hpp>
+#include <controlit/WorkerPool.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace controlit {
+namespace exec {
+
+/*!
+ * Hosts several ControlIt! controllers in one process.  The model and
+ * task updates of all controllers, and the helpers that parallelize the
+ * model updates and task commands, run on one shared WorkerPool, which
+ * enforces each controller's CPU quota.  Controllers that use the
+ * ServoClockShared servo clock also share one servo thread.
+ *
+ * The following private parameters configure the host:
+ *
+ *   - ~controllers: The namespaces of the controllers (required).
+ *   - ~num_workers: The number of worker threads (default 1).
+ *   - ~worker_cores: The cores to which the workers are pinned (default none).
+ *   - ~accounting_period: The period in seconds over which the CPU quotas
+ *     are enforced (default 0.01).
+ */
+class ControlItHost
+{
+public:
+    /*!
+     * The default constructor.
+     */
+    ControlItHost();
+
+    /*!
+     * The destructor.
+     */
+    virtual ~ControlItHost();
+
+    /*!
+     * Initializes the worker pool and the controllers.
+     *
+     * \return Whether the initialization was successful.
+     */
+    bool init();
+
+    /*!
+     * Starts the worker pool and the controllers.
+     */
+    bool start();
+
+    /*!
+     * Stops the controllers and the worker pool.
+     */
+    bool stop();
+
+    /*!
+     * Publishes the worker pool statistics of each controller.
+     */
+    void publishStatistics();
+
+    /*!
+     * Returns a string representation of this class.
+     */
+    std::string toString(std::string const & prefix = "") const;
+
+private:
+
+    /*!
+     * Whether the instantiation of this class is initialized.
+     */
+    bool initialized;
+
+    /*!
+     * The namespaces of the controllers.
+     */
+    std::vector<std::string> controllerNames;
+
+    /*!
+     * The pool that runs the model and task updates of all controllers.
+     */
+    controlit::WorkerPool workerPool;
+
+    /*!
+     * The controllers.
+     */
+    std::vector<std::unique_ptr<controlit::Coordinator>> coordinators;
+
+    /*!
+     * Publish the worker pool statistics of each controller.
+     */
+    std::vector<ros::Publisher> statisticsPublishers;
+};
+
+} // namespace exec
+} // namespace controlit
+
+#endif // __CONTROLIT_EXEC_CONTROLIT_HOST_HPP__
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_EXEC_CONTROLIT_REPLAY_HPP__
+#define __CONTROLIT_EXEC_CONTROLIT_REPLAY_HPP__
+
+#include "ros/ros.h"
+#include <controlit/Coordinator.hpp>
+#include <controlit/exec/ReplaySession.hpp>
+#include <string>
+
+namespace controlit {
+namespace exec {
+
+/*!
+ * Replays a ROS bag recorded on the robot through a controller to
+ * reproduce its performance offline.
+ *
+ * The controller in the node's namespace runs in lockstep mode with the
+ * RobotInterfaceReplay robot interface, which supplies the recorded joint
+ * and odometry states.  Lockstep mode updates the model and the tasks
+ * within each servo cycle, so a recording always produces the same
+ * commands.  Before each servo cycle, the messages recorded on the topics
+ * of the controller's ROS input bindings are applied to the bound
+ * parameters.  The bag itself is replayed by a ReplaySession.
+ *
+ * After the replay, the time spent in each stage of the servo cycles is
+ * reported, along with the difference between the commanded efforts and
+ * those recorded on the command topic.  The latest recorded command at or
+ * before each servo cycle is compared with the command of that cycle.
+ *
+ * The bag is specified by parameter controlit/replay/bag.  The following
+ * private parameters configure the replay:
+ *
+ *   - ~real_time: Whether to pace the servo cycles by the wall clock
+ *     instead of running them as fast as possible (default false).
+ *   - ~command_topic: The topic of the recorded commands, of type
+ *     controlit_robot_interface_library/JointState or sensor_msgs/JointState
+ *     (default "command").
+ *   - ~report_file: A file to which the report is also written (optional).
+ *   - ~max_mean_servo_latency: The mean servo compute time in seconds
+ *     above which the replay fails (default 0, meaning no limit).
+ *   - ~max_rms_effort_error: The RMS effort error above which the replay
+ *     fails (default 0, meaning no limit).
+ */
+class ControlItReplay
+{
+public:
+    /*!
+     * The default constructor.
+     */
+    ControlItReplay();
+
+    /*!
+     * The destructor.
+     */
+    virtual ~ControlItReplay();
+
+    /*!
+     * Initializes the controller and opens the bag.
+     *
+     * \return Whether the initialization was successful.
+     */
+    bool init();
+
+    /*!
+     * Replays the bag through the controller.
+     *
+     * \return Whether the replay ran to the end of the bag.
+     */
+    bool run();
+
+    /*!
+     * Prints the report and writes it to the report file, if any.
+     *
+     * \return Whether the replay is within the configured limits.
+     */
+    bool report();
+
+    /*!
+     * Returns a string representation of this class.
+     */
+    std::string toString(std::string const & prefix = "") const;
+
+private:
+
+    /*!
+     * Finds the parameters that are bound to ROS topics.
+     */
+    void findBindings();
+
+    /*!
+     * Whether the instantiation of this class is initialized.
+     */
+    bool initialized;
+
+    /*!
+     * The controller being replayed.
+     */
+    controlit::Coordinator coordinator;
+
+    /*!
+     * The file to which the report is also written, if any.
+     */
+    std::string reportFile;
+
+    /*!
+     * Replays the bag and accounts for the results.
+     */
+    ReplaySession session;
+};
+
+} // namespace exec
+} // namespace controlit
+
+#endif // __CONTROLIT_EXEC_CONTROLIT_REPLAY_HPP__
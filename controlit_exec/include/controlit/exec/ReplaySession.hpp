@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_EXEC_REPLAY_SESSION_HPP__
+#define __CONTROLIT_EXEC_REPLAY_SESSION_HPP__
+
+#include <controlit/Parameter.hpp>
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <rosbag/bag.h>
+#include <rosbag/message_instance.h>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace controlit {
+namespace exec {
+
+using controlit::addons::eigen::Vector;
+
+/*!
+ * Replays the commands and the binding updates recorded in a ROS bag while
+ * stepping a controller, and accounts for the results of its servo cycles.
+ * This is the part of ControlItReplay that does not depend on a running
+ * controller, so it can be checked on its own.
+ *
+ * The servo cycles are due at multiples of the servo period from the start
+ * of the bag, i.e., from its earliest message on any topic, up to the end of
+ * the bag.  Before each servo cycle, the messages recorded on the bound
+ * topics up to that time are applied to the bound parameters.  After each
+ * servo cycle, the commanded efforts are compared with those of the latest
+ * recorded command, if one was recorded since the previous servo cycle.
+ */
+class ReplaySession
+{
+public:
+    /*!
+     * Runs a servo cycle.
+     *
+     * \param[in] period The time in seconds since the previous servo cycle,
+     * or zero for the first one.
+     * \param[out] latencies The time spent in each stage of the servo cycle,
+     * in the order returned by Coordinator::getServoLatencies(...).
+     * \param[out] effort The commanded efforts in the order of the actuated joints.
+     * \return Whether the servo cycle ran.
+     */
+    typedef std::function<bool(double period, Vector & latencies, Vector & effort)> StepFunction;
+
+    /*!
+     * The names of the stages of a servo cycle, in the order returned by
+     * Coordinator::getServoLatencies(...).
+     */
+    static const std::vector<std::string> STAGE_NAMES;
+
+    /*!
+     * The default constructor.
+     */
+    ReplaySession();
+
+    /*!
+     * Opens the bag and configures the replay.
+     *
+     * \param[in] bagPath The path of the bag.
+     * \param[in] servoPeriod The period of the servo cycles in seconds.
+     * \param[in] commandTopic The topic of the recorded commands, of type
+     * controlit_robot_interface_library/JointState or sensor_msgs/JointState.
+     * \param[in] actuatedJointNames The names of the actuated joints.
+     * \return Whether the initialization was successful.
+     */
+    bool init(const std::string & bagPath, double servoPeriod, const std::string & commandTopic,
+        const std::vector<std::string> & actuatedJointNames);
+
+    /*!
+     * Sets whether to pace the servo cycles by the wall clock instead of
+     * running them as fast as possible.
+     */
+    void setRealTime(bool realTime) { this->realTime = realTime; }
+
+    /*!
+     * Sets the limits above which report(...) fails.  A limit of zero means
+     * no limit.
+     *
+     * \param[in] maxMeanServoLatency The maximum mean servo compute time in seconds.
+     * \param[in] maxRMSEffortError The maximum RMS effort error.
+     */
+    void setLimits(double maxMeanServoLatency, double maxRMSEffortError);
+
+    /*!
+     * Binds a parameter to the messages recorded on a topic.
+     */
+    void addBinding(const std::string & topic, controlit::Parameter * param);
+
+    /*!
+     * Replays the bag.
+     *
+     * \param[in] step Runs a servo cycle.
+     * \return Whether the replay ran to the end of the bag.
+     */
+    bool run(StepFunction step);
+
+    /*!
+     * Writes the report of the replay.
+     *
+     * \param[in] os The stream to which to write the report.
+     * \return Whether the replay is within the configured limits.
+     */
+    bool report(std::ostream & os);
+
+    /*!
+     * Applies a recorded message to a bound parameter.  This mirrors the
+     * conversions done by the ROS input bindings.
+     *
+     * \return Whether the type of the message is supported.
+     */
+    static bool applyBinding(const rosbag::MessageInstance & m, controlit::Parameter * param);
+
+    /*!
+     * Accessors of the results of the replay.
+     */
+    size_t getNumCycles() const { return numCycles; }
+    size_t getNumBindingUpdates() const { return numBindingUpdates; }
+    size_t getNumIgnoredMessages() const { return numIgnoredMessages; }
+    size_t getNumComparedCommands() const { return numComparedCommands; }
+    double getRMSEffortError() const;
+    double getMaxEffortError() const { return maxEffortError; }
+
+    /*!
+     * Returns a string representation of this class.
+     */
+    std::string toString(std::string const & prefix = "") const;
+
+private:
+
+    /*!
+     * Applies a message recorded on the command topic or on a binding's topic.
+     */
+    void handleMessage(const rosbag::MessageInstance & m);
+
+    /*!
+     * Saves the recorded efforts of a command in the order of the actuated joints.
+     */
+    void saveRecordedEffort(const std::vector<std::string> & name, const std::vector<double> & effort);
+
+    /*!
+     * Saves the latencies of the latest servo cycle and compares its
+     * command with the latest recorded command.
+     */
+    void recordCycle(const Vector & cycleLatencies, const Vector & effort);
+
+    /*!
+     * The configuration of the replay.
+     */
+    std::string bagPath;
+    double servoPeriod;
+    std::string commandTopic;
+    std::vector<std::string> actuatedJointNames;
+    bool realTime;
+    double maxMeanServoLatency;
+    double maxRMSEffortError;
+
+    /*!
+     * The bag being replayed.
+     */
+    rosbag::Bag bag;
+
+    /*!
+     * The parameters that are bound to each ROS topic.
+     */
+    std::map<std::string, std::vector<controlit::Parameter *>> bindings;
+
+    /*!
+     * The latest recorded efforts in the order of the actuated joints, and
+     * whether they were recorded since the previous servo cycle.
+     */
+    Vector recordedEffort;
+    bool newRecordedEffort;
+
+    /*!
+     * The number of servo cycles run, the number of binding updates applied,
+     * and the number of recorded messages that could not be applied.
+     */
+    size_t numCycles;
+    size_t numBindingUpdates;
+    size_t numIgnoredMessages;
+
+    /*!
+     * The time spent in each stage of each servo cycle.
+     */
+    std::vector<std::vector<double>> latencies;
+
+    /*!
+     * Statistics of the differences between the commanded and recorded efforts.
+     */
+    size_t numComparedCommands;
+    size_t numComparedEfforts;
+    double sumSquaredEffortError;
+    double maxEffortError;
+
+    /*!
+     * The wall clock time spent replaying.
+     */
+    double replayDuration;
+};
+
+} // namespace exec
+} // namespace controlit
+
+#endif // __CONTROLIT_EXEC_REPLAY_SESSION_HPP__
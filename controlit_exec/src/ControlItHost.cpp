@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/exec/ControlItHost.hpp>
+#include <std_msgs/Float64MultiArray.h>
+
+namespace controlit {
+namespace exec {
+
+#define DEFAULT_NUM_WORKERS 1
+#define DEFAULT_ACCOUNTING_PERIOD 0.01
+#define SHARED_SERVO_CLOCK_TYPE "controlit_servo_clock/ServoClockShared"
+
+ControlItHost::ControlItHost() :
+  initialized(false)
+{
+}
+
+ControlItHost::~ControlItHost()
+{
+}
+
+bool ControlItHost::init()
+{
+    ros::NodeHandle privateNH("~");
+
+    if (!privateNH.getParam("controllers", controllerNames) || controllerNames.empty())
+    {
+        std::cerr << "ControlItHost: ERROR: Parameter \"" << privateNH.getNamespace()
+                  << "/controllers\" must list the namespaces of the controllers." << std::endl;
+        return false;
+    }
+
+    int numWorkers;
+    privateNH.param("num_workers", numWorkers, DEFAULT_NUM_WORKERS);
+
+    std::vector<int> workerCores;
+    privateNH.getParam("worker_cores", workerCores);
+
+    double accountingPeriod;
+    privateNH.param("accounting_period", accountingPeriod, DEFAULT_ACCOUNTING_PERIOD);
+
+    if (numWorkers < 1 || accountingPeriod <= 0)
+    {
+        std::cerr << "ControlItHost: ERROR: Invalid worker pool configuration: num_workers = "
+                  << numWorkers << ", accounting_period = " << accountingPeriod << std::endl;
+        return false;
+    }
+
+    if (!workerPool.init(numWorkers, workerCores, accountingPeriod))
+    {
+        std::cerr << "ControlItHost: ERROR: Failed to initialize the worker pool." << std::endl;
+        return false;
+    }
+
+    for (auto & name : controllerNames)
+    {
+        ros::NodeHandle nh(name);
+
+        std::string servoClockType;
+        if (nh.getParam("controlit/servo_clock_type", servoClockType) && servoClockType != SHARED_SERVO_CLOCK_TYPE)
+        {
+            std::cerr << "ControlItHost: WARNING: Controller \"" << nh.getNamespace() << "\" uses servo clock "
+                      << servoClockType << ".  Use " << SHARED_SERVO_CLOCK_TYPE
+                      << " to run its servo loop on the shared servo thread." << std::endl;
+        }
+
+        std::unique_ptr<controlit::Coordinator> coordinator(new controlit::Coordinator());
+        coordinator->setWorkerPool(&workerPool);
+
+        std::cout << "ControlItHost: Initializing controller \"" << nh.getNamespace() << "\"..." << std::endl;
+
+        if (!coordinator->init(nh))
+        {
+            std::cerr << "ControlItHost: ERROR: Failed to initialize controller \"" << nh.getNamespace() << "\"." << std::endl;
+            return false;
+        }
+
+        coordinators.push_back(std::move(coordinator));
+        statisticsPublishers.push_back(nh.advertise<std_msgs::Float64MultiArray>("diagnostics/workerPoolUsage", 1));
+    }
+
+    initialized = true;
+    return true;
+}
+
+bool ControlItHost::start()
+{
+    if (!workerPool.start())
+    {
+        std::cerr << "ControlItHost: ERROR: Failed to start the worker pool." << std::endl;
+        return false;
+    }
+
+    for (size_t ii = 0; ii < coordinators.size(); ii++)
+    {
+        if (!coordinators[ii]->start())
+        {
+            std::cerr << "ControlItHost: ERROR: Failed to start controller \"" << controllerNames[ii] << "\"." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ControlItHost::stop()
+{
+    bool result = true;
+
+    // The controllers must stop submitting jobs before the workers stop
+    for (auto & coordinator : coordinators)
+        result = coordinator->stop() && result;
+
+    workerPool.stop();
+    return result;
+}
+
+void ControlItHost::publishStatistics()
+{
+    for (size_t ii = 0; ii < coordinators.size(); ii++)
+    {
+        controlit::WorkerPool::Statistics stats = workerPool.getStatistics(coordinators[ii]->getWorkerAccount(), true);
+
+        std_msgs::Float64MultiArray msg;
+        msg.data.resize(7);
+        msg.data[0] = stats.numJobs;
+        msg.data[1] = stats.numJobs > 0 ? stats.totalQueueLatency / stats.numJobs : 0;
+        msg.data[2] = stats.maxQueueLatency;
+        msg.data[3] = stats.numJobs > 0 ? stats.totalRunTime / stats.numJobs : 0;
+        msg.data[4] = stats.maxRunTime;
+        msg.data[5] = stats.duration > 0 ? stats.totalRunTime / stats.duration : 0;
+        msg.data[6] = stats.numThrottled;
+
+        statisticsPublishers[ii].publish(msg);
+    }
+}
+
+std::string ControlItHost::toString(std::string const& prefix) const
+{
+    std::stringstream ss;
+    ss << prefix << "ControlItHost details:\n";
+    ss << prefix << "  - initialized: " << (initialized ? "true" : "false") << "\n";
+    ss << prefix << "  - controllers:";
+    for (auto & name : controllerNames)
+        ss << " " << name;
+
+    return ss.str();
+}
+
+} // namespace exec
+} // namespace controlit
+
+
+// This is the main method that starts everything.
+int main(int argc, char **argv)
+{
+    // Define usage
+    std::stringstream ss;
+    ss << "Usage: rosrun controlit_exec controlit_host [options]\n"
+       << "Valid options include:\n"
+       << "  -h: display this usage string\n"
+       << "Note: The controllers' namespaces are specified by private parameter ~controllers.";
+
+    ros::init(argc, argv, "ControlItHost");
+
+    if (argc != 1)
+    {
+        // Parse the command line arguments
+        int option_char;
+        while ((option_char = getopt(argc, argv, "h")) != -1)
+        {
+            switch (option_char)
+            {
+                case 'h':
+                    std::cout << ss.str() << std::endl;
+                    return 0;
+                    break;
+                default:
+                    std::cerr << "ControlItHost: ERROR: Unknown option " << option_char << ".  " << ss.str() << std::endl;
+                    return -1;
+            }
+        }
+    }
+
+    // Create and start a ControlItHost
+    controlit::exec::ControlItHost controlitHost;
+    if (controlitHost.init())
+    {
+        std::cout << controlitHost.toString() << std::endl;
+
+        if (controlitHost.start())
+        {
+            // Loop until someone hits ctrl+c, publishing the worker pool
+            // statistics once per second
+            ros::Rate loop_rate(1000);
+            ros::Time lastPublishTime = ros::Time::now();
+
+            while (ros::ok())
+            {
+                ros::spinOnce();
+
+                if ((ros::Time::now() - lastPublishTime).toSec() >= 1.0)
+                {
+                    controlitHost.publishStatistics();
+                    lastPublishTime = ros::Time::now();
+                }
+
+                loop_rate.sleep();
+            }
+        }
+        else
+        {
+            std::cerr << "ControlItHost: ERROR: Failed to start." << std::endl;
+        }
+
+        // Stop ControlItHost
+        controlitHost.stop();
+    }
+    else
+    {
+        std::cerr << "ControlItHost: ERROR: Failed to initialize." << std::endl;
+    }
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/exec/ControlItReplay.hpp>
+
+#include <controlit/Command.hpp>
+#include <controlit/CompoundTask.hpp>
+#include <controlit/servo_clock_library/ServoClockLockstep.hpp>
+
+#include <fstream>
+
+namespace controlit {
+namespace exec {
+
+using controlit::servo_clock_library::ServoClockLockstep;
+
+#define REPLAY_ROBOT_INTERFACE_TYPE "controlit_robot_interface/RobotInterfaceReplay"
+#define DEFAULT_COMMAND_TOPIC "command"
+
+ControlItReplay::ControlItReplay() :
+    initialized(false)
+{
+}
+
+ControlItReplay::~ControlItReplay()
+{
+}
+
+bool ControlItReplay::init()
+{
+    ros::NodeHandle nh;
+    ros::NodeHandle privateNH("~");
+
+    bool realTime;
+    std::string commandTopic;
+    double maxMeanServoLatency, maxRMSEffortError;
+
+    privateNH.param("real_time", realTime, false);
+    privateNH.param<std::string>("command_topic", commandTopic, DEFAULT_COMMAND_TOPIC);
+    privateNH.getParam("report_file", reportFile);
+    privateNH.param("max_mean_servo_latency", maxMeanServoLatency, 0.0);
+    privateNH.param("max_rms_effort_error", maxRMSEffortError, 0.0);
+
+    std::string bagPath;
+    if (!nh.getParam("controlit/replay/bag", bagPath))
+    {
+        std::cerr << "ControlItReplay: ERROR: Parameter \"" << nh.getNamespace()
+                  << "/controlit/replay/bag\" must specify the bag to replay." << std::endl;
+        return false;
+    }
+
+    double servoFrequency;
+    if (!nh.getParam("controlit/servo_frequency", servoFrequency) || servoFrequency <= 0)
+    {
+        std::cerr << "ControlItReplay: ERROR: Parameter \"" << nh.getNamespace()
+                  << "/controlit/servo_frequency\" must specify a positive servo frequency." << std::endl;
+        return false;
+    }
+
+    // Step the controller from this thread and feed it the recorded states
+    nh.setParam("controlit/lockstep", true);
+    nh.setParam("controlit/robot_interface_type", REPLAY_ROBOT_INTERFACE_TYPE);
+
+    if (!coordinator.init(nh))
+    {
+        std::cerr << "ControlItReplay: ERROR: Failed to initialize controller \"" << nh.getNamespace() << "\"." << std::endl;
+        return false;
+    }
+
+    if (!session.init(bagPath, 1.0 / servoFrequency, commandTopic, coordinator.getActuatedJointNames()))
+        return false;
+
+    session.setRealTime(realTime);
+    session.setLimits(maxMeanServoLatency, maxRMSEffortError);
+
+    findBindings();
+
+    initialized = true;
+    return true;
+}
+
+void ControlItReplay::findBindings()
+{
+    controlit::CompoundTask * compoundTask = coordinator.getCompoundTask();
+
+    for (auto const & bindingConfigParam : compoundTask->lookupParameters(controlit::PARAMETER_TYPE_BINDING))
+    {
+        controlit::BindingConfig const & config = *(bindingConfigParam->getBindingConfig());
+
+        if (config.getTransportType() != "ROSTopic" || config.getDirection() != controlit::BindingConfig::Input)
+            continue;
+
+        controlit::Parameter * param = compoundTask->lookupParameter(config.getParameter());
+        if (param != nullptr)
+            session.addBinding(config.getProperty("topic"), param);
+    }
+}
+
+bool ControlItReplay::run()
+{
+    if (!initialized)
+    {
+        std::cerr << "ControlItReplay: ERROR: Attempted to run without initializing." << std::endl;
+        return false;
+    }
+
+    if (!coordinator.start())
+    {
+        std::cerr << "ControlItReplay: ERROR: Failed to start the controller." << std::endl;
+        return false;
+    }
+
+    bool result = session.run([this](double period, Vector & latencies, Vector & effort)
+    {
+        if (!ros::ok() || ServoClockLockstep::step(period) != 1)
+            return false;
+
+        coordinator.getServoLatencies(latencies);
+        effort = coordinator.getLastCommand()->getEffortCmd();
+        return true;
+    });
+
+    coordinator.stop();
+    return result;
+}
+
+bool ControlItReplay::report()
+{
+    std::stringstream ss;
+    bool result = session.report(ss);
+
+    std::cout << ss.str();
+
+    if (!reportFile.empty())
+    {
+        std::ofstream file(reportFile);
+        file << ss.str();
+        if (!file)
+        {
+            std::cerr << "ControlItReplay: ERROR: Unable to write the report to \"" << reportFile << "\"." << std::endl;
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+std::string ControlItReplay::toString(std::string const& prefix) const
+{
+    ros::NodeHandle nh;
+
+    std::stringstream ss;
+    ss << prefix << "ControlItReplay details:\n";
+    ss << prefix << "  - initialized: " << (initialized ? "true" : "false") << "\n";
+    ss << prefix << "  - controller name: " << nh.getNamespace() << "\n";
+    ss << session.toString(prefix);
+
+    return ss.str();
+}
+
+} // namespace exec
+} // namespace controlit
+
+
+// This is the main method that starts everything.
+int main(int argc, char **argv)
+{
+    // Define usage
+    std::stringstream ss;
+    ss << "Usage: rosrun controlit_exec controlit_replay [options]\n"
+       << "Valid options include:\n"
+       << "  -h: display this usage string\n"
+       << "Note: The controller's name is specified by the ROS nodehandle's namespace\n"
+       << "and the bag by parameter controlit/replay/bag.";
+
+    ros::init(argc, argv, "ControlItReplay");
+
+    if (argc != 1)
+    {
+        // Parse the command line arguments
+        int option_char;
+        while ((option_char = getopt(argc, argv, "h")) != -1)
+        {
+            switch (option_char)
+            {
+                case 'h':
+                    std::cout << ss.str() << std::endl;
+                    return 0;
+                    break;
+                default:
+                    std::cerr << "ControlItReplay: ERROR: Unknown option " << option_char << ".  " << ss.str() << std::endl;
+                    return -1;
+            }
+        }
+    }
+
+    controlit::exec::ControlItReplay controlitReplay;
+    if (!controlitReplay.init())
+    {
+        std::cerr << "ControlItReplay: ERROR: Failed to initialize." << std::endl;
+        return 1;
+    }
+
+    std::cout << controlitReplay.toString() << std::endl;
+
+    bool replayed = controlitReplay.run();
+
+    // The exit status makes the replay usable as a regression check
+    bool withinLimits = controlitReplay.report();
+    return replayed && withinLimits ? 0 : 1;
+}
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/exec/ReplaySession.hpp>
+
+#include <controlit/addons/ros/ROSMsgEigenConversion.hpp>
+#include <controlit_robot_interface_library/JointState.h>
+#include <sensor_msgs/JointState.h>
+#include <std_msgs/Float64.h>
+#include <std_msgs/Float64MultiArray.h>
+#include <std_msgs/Int32.h>
+#include <std_msgs/String.h>
+#include <rosbag/view.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace controlit {
+namespace exec {
+
+using controlit::addons::ros::matrixMsgToEigen;
+using controlit::addons::eigen::Matrix;
+
+const std::vector<std::string> ReplaySession::STAGE_NAMES = {"read", "publish_odometry",
+    "model_update", "compute_command", "emit_events", "write", "servo"};
+
+/*!
+ * The percentile of the latencies that is reported.
+ */
+#define LATENCY_PERCENTILE 0.99
+
+ReplaySession::ReplaySession() :
+    servoPeriod(0),
+    realTime(false),
+    maxMeanServoLatency(0),
+    maxRMSEffortError(0),
+    newRecordedEffort(false),
+    numCycles(0),
+    numBindingUpdates(0),
+    numIgnoredMessages(0),
+    latencies(STAGE_NAMES.size()),
+    numComparedCommands(0),
+    numComparedEfforts(0),
+    sumSquaredEffortError(0),
+    maxEffortError(0),
+    replayDuration(0)
+{
+}
+
+bool ReplaySession::init(const std::string & bagPath, double servoPeriod, const std::string & commandTopic,
+    const std::vector<std::string> & actuatedJointNames)
+{
+    if (servoPeriod <= 0)
+    {
+        std::cerr << "ReplaySession: ERROR: The servo period must be positive, got " << servoPeriod << "." << std::endl;
+        return false;
+    }
+
+    try
+    {
+        bag.open(bagPath, rosbag::bagmode::Read);
+    }
+    catch (rosbag::BagException & e)
+    {
+        std::cerr << "ReplaySession: ERROR: Unable to open bag \"" << bagPath << "\": " << e.what() << std::endl;
+        return false;
+    }
+
+    this->bagPath = bagPath;
+    this->servoPeriod = servoPeriod;
+    this->commandTopic = commandTopic;
+    this->actuatedJointNames = actuatedJointNames;
+
+    recordedEffort.setZero(actuatedJointNames.size());
+
+    return true;
+}
+
+void ReplaySession::setLimits(double maxMeanServoLatency, double maxRMSEffortError)
+{
+    this->maxMeanServoLatency = maxMeanServoLatency;
+    this->maxRMSEffortError = maxRMSEffortError;
+}
+
+void ReplaySession::addBinding(const std::string & topic, controlit::Parameter * param)
+{
+    bindings[topic].push_back(param);
+}
+
+bool ReplaySession::run(StepFunction step)
+{
+    if (servoPeriod <= 0)
+    {
+        std::cerr << "ReplaySession: ERROR: Attempted to run without initializing." << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> topics;
+    topics.push_back(commandTopic);
+    for (auto & binding : bindings)
+        topics.push_back(binding.first);
+
+    // Times are measured from the start of the whole bag, as done by RobotInterfaceReplay.
+    rosbag::View bagView(bag);
+    ros::Time startTime = bagView.getBeginTime();
+    double bagDuration = (bagView.getEndTime() - startTime).toSec();
+
+    rosbag::View view(bag, rosbag::TopicQuery(topics));
+    rosbag::View::iterator nextMessage = view.begin();
+
+    auto wallStartTime = std::chrono::steady_clock::now();
+    bool result = true;
+
+    Vector cycleLatencies;
+    Vector effort;
+
+    for (size_t cycle = 0; cycle * servoPeriod <= bagDuration; cycle++)
+    {
+        double time = cycle * servoPeriod;
+
+        // Apply the messages recorded up to this servo cycle.
+        while (nextMessage != view.end() && (nextMessage->getTime() - startTime).toSec() <= time)
+        {
+            handleMessage(*nextMessage);
+            ++nextMessage;
+        }
+
+        if (realTime)
+            std::this_thread::sleep_until(wallStartTime + std::chrono::duration<double>(time));
+
+        // The first cycle is due when the controller starts.
+        if (!step(cycle == 0 ? 0 : servoPeriod, cycleLatencies, effort))
+        {
+            std::cerr << "ReplaySession: ERROR: Servo cycle " << cycle << " did not run." << std::endl;
+            result = false;
+            break;
+        }
+
+        if (static_cast<size_t>(cycleLatencies.size()) != STAGE_NAMES.size()
+            || effort.size() != recordedEffort.size())
+        {
+            std::cerr << "ReplaySession: ERROR: Servo cycle " << cycle << " returned " << cycleLatencies.size()
+                      << " latencies and " << effort.size() << " efforts, expected " << STAGE_NAMES.size()
+                      << " and " << recordedEffort.size() << "." << std::endl;
+            result = false;
+            break;
+        }
+
+        recordCycle(cycleLatencies, effort);
+    }
+
+    replayDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStartTime).count();
+
+    return result;
+}
+
+void ReplaySession::handleMessage(const rosbag::MessageInstance & m)
+{
+    if (m.getTopic() == commandTopic)
+    {
+        controlit_robot_interface_library::JointState::ConstPtr command
+            = m.instantiate<controlit_robot_interface_library::JointState>();
+        sensor_msgs::JointState::ConstPtr rosCommand = m.instantiate<sensor_msgs::JointState>();
+
+        if (command != nullptr)
+            saveRecordedEffort(command->name, command->effort);
+        else if (rosCommand != nullptr)
+            saveRecordedEffort(rosCommand->name, rosCommand->effort);
+        else
+            numIgnoredMessages++;
+    }
+
+    // A topic may be both the command topic and bound to parameters.
+    auto binding = bindings.find(m.getTopic());
+    if (binding != bindings.end())
+    {
+        for (auto param : binding->second)
+        {
+            if (applyBinding(m, param))
+                numBindingUpdates++;
+            else
+                numIgnoredMessages++;
+        }
+    }
+}
+
+void ReplaySession::saveRecordedEffort(const std::vector<std::string> & name, const std::vector<double> & effort)
+{
+    for (size_t ii = 0; ii < actuatedJointNames.size(); ii++)
+    {
+        size_t jj = std::find(name.begin(), name.end(), actuatedJointNames[ii]) - name.begin();
+        if (jj < effort.size())
+            recordedEffort[ii] = effort[jj];
+    }
+
+    newRecordedEffort = true;
+}
+
+bool ReplaySession::applyBinding(const rosbag::MessageInstance & m, controlit::Parameter * param)
+{
+    std_msgs::Float64::ConstPtr real = m.instantiate<std_msgs::Float64>();
+    if (real != nullptr && param->type() == controlit::PARAMETER_TYPE_REAL)
+        return param->set(real->data);
+
+    std_msgs::Int32::ConstPtr integer = m.instantiate<std_msgs::Int32>();
+    if (integer != nullptr && param->type() == controlit::PARAMETER_TYPE_INTEGER)
+        return param->set(integer->data);
+
+    std_msgs::String::ConstPtr text = m.instantiate<std_msgs::String>();
+    if (text != nullptr && param->type() == controlit::PARAMETER_TYPE_STRING)
+        return param->set(text->data);
+
+    std_msgs::Float64MultiArray::ConstPtr array = m.instantiate<std_msgs::Float64MultiArray>();
+    if (array != nullptr && !array->layout.dim.empty())
+    {
+        int rows = array->layout.dim[0].size;
+        int cols = array->layout.dim.size() > 1 ? array->layout.dim[1].size : 1;
+
+        if (cols == 1 && param->type() == controlit::PARAMETER_TYPE_VECTOR)
+        {
+            Vector v(rows);
+            matrixMsgToEigen(*array, v);
+            return param->set(v);
+        }
+        else if (param->type() == controlit::PARAMETER_TYPE_MATRIX)
+        {
+            Matrix mat(rows, cols);
+            matrixMsgToEigen(*array, mat);
+            return param->set(mat);
+        }
+    }
+
+    return false;
+}
+
+void ReplaySession::recordCycle(const Vector & cycleLatencies, const Vector & effort)
+{
+    numCycles++;
+
+    for (size_t ii = 0; ii < STAGE_NAMES.size(); ii++)
+        latencies[ii].push_back(cycleLatencies[ii]);
+
+    if (newRecordedEffort)
+    {
+        Vector error = effort - recordedEffort;
+
+        numComparedCommands++;
+        numComparedEfforts += error.size();
+        sumSquaredEffortError += error.squaredNorm();
+        if (error.size() > 0)
+            maxEffortError = std::max(maxEffortError, error.cwiseAbs().maxCoeff());
+
+        newRecordedEffort = false;
+    }
+}
+
+double ReplaySession::getRMSEffortError() const
+{
+    return numComparedEfforts > 0 ? std::sqrt(sumSquaredEffortError / numComparedEfforts) : 0;
+}
+
+bool ReplaySession::report(std::ostream & os)
+{
+    double meanServoLatency = 0;
+    double rmsEffortError = getRMSEffortError();
+
+    std::stringstream ss;
+    ss << "bag: " << bagPath << "\n"
+       << "servo_cycles: " << numCycles << "\n"
+       << "replay_duration: " << replayDuration << "\n"
+       << "cycles_per_second: " << (replayDuration > 0 ? numCycles / replayDuration : 0) << "\n"
+       << "binding_updates: " << numBindingUpdates << "\n"
+       << "ignored_messages: " << numIgnoredMessages << "\n"
+       << "latency:\n";
+
+    for (size_t ii = 0; ii < STAGE_NAMES.size(); ii++)
+    {
+        std::vector<double> & stage = latencies[ii];
+        if (stage.empty()) continue;
+
+        double mean = 0;
+        for (double latency : stage)
+            mean += latency;
+        mean /= stage.size();
+
+        if (ii == STAGE_NAMES.size() - 1)
+            meanServoLatency = mean;
+
+        std::sort(stage.begin(), stage.end());
+        size_t percentileIndex = std::min(stage.size() - 1, static_cast<size_t>(LATENCY_PERCENTILE * stage.size()));
+
+        ss << "  " << STAGE_NAMES[ii] << ": {mean: " << mean
+           << ", p99: " << stage[percentileIndex] << ", max: " << stage.back() << "}\n";
+    }
+
+    ss << "effort_error:\n"
+       << "  compared_commands: " << numComparedCommands << "\n"
+       << "  rms: " << rmsEffortError << "\n"
+       << "  max: " << maxEffortError << "\n";
+
+    bool result = true;
+
+    if (maxMeanServoLatency > 0 && meanServoLatency > maxMeanServoLatency)
+    {
+        ss << "FAILED: The mean servo latency " << meanServoLatency
+           << "s exceeds the limit of " << maxMeanServoLatency << "s.\n";
+        result = false;
+    }
+
+    if (maxRMSEffortError > 0 && rmsEffortError > maxRMSEffortError)
+    {
+        ss << "FAILED: The RMS effort error " << rmsEffortError
+           << " exceeds the limit of " << maxRMSEffortError << ".\n";
+        result = false;
+    }
+
+    os << ss.str();
+    return result;
+}
+
+std::string ReplaySession::toString(std::string const& prefix) const
+{
+    std::stringstream ss;
+    ss << prefix << "  - bag: " << bagPath << "\n";
+    ss << prefix << "  - real time: " << (realTime ? "true" : "false") << "\n";
+    ss << prefix << "  - command topic: " << commandTopic << "\n";
+    ss << prefix << "  - bound topics:";
+    for (auto & binding : bindings)
+        ss << " " << binding.first;
+
+    return ss.str();
+}
+
+} // namespace exec
+} // namespace controlit
@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <controlit/exec/ReplaySession.hpp>
+#include <controlit_robot_interface_library/JointState.h>
+#include <rosbag/bag.h>
+#include <sensor_msgs/JointState.h>
+#include <std_msgs/Float64.h>
+#include <std_msgs/Float64MultiArray.h>
+#include <std_msgs/Int32.h>
+#include <std_msgs/String.h>
+
+using controlit::exec::ReplaySession;
+using controlit::addons::eigen::Matrix;
+using controlit::addons::eigen::Vector;
+
+namespace {
+
+#define SERVO_PERIOD 0.25
+
+std_msgs::Float64MultiArray arrayMsg(int rows, int cols, std::vector<double> data)
+{
+    std_msgs::Float64MultiArray msg;
+    msg.layout.dim.resize(2);
+    msg.layout.dim[0].size = rows;
+    msg.layout.dim[1].size = cols;
+    msg.data = data;
+    return msg;
+}
+
+/*!
+ * Writes a small bag with two recorded commands for joints "a" and "b" and
+ * a message for each kind of bound parameter, and binds parameters to its
+ * topics.  The bag starts at 10s and ends at 11s, so it is replayed in five
+ * servo cycles.
+ */
+class ReplaySessionTest : public ::testing::Test
+{
+protected:
+    ReplaySessionTest() :
+        goal(0),
+        mode(0),
+        goalParam("goal", 0, &goal),
+        modeParam("mode", 0, &mode),
+        labelParam("label", 0, &label),
+        gainsParam("gains", 0, &gains),
+        stiffnessParam("stiffness", 0, &stiffness)
+    {
+    }
+
+    virtual void SetUp()
+    {
+        char path[] = "/tmp/ReplaySessionTestXXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        bagPath = std::string(path) + ".bag";
+        std::remove(path);
+
+        rosbag::Bag bag;
+        bag.open(bagPath, rosbag::bagmode::Write);
+
+        std_msgs::Float64 goalMsg;
+        goalMsg.data = 3.5;
+        bag.write("goal", ros::Time(10.0), goalMsg);
+
+        controlit_robot_interface_library::JointState command0;
+        command0.name = {"b", "a"};
+        command0.effort = {2, 1};
+        bag.write("command", ros::Time(10.0), command0);
+
+        std_msgs::Int32 modeMsg;
+        modeMsg.data = 7;
+        bag.write("mode", ros::Time(10.25), modeMsg);
+
+        std_msgs::String labelMsg;
+        labelMsg.data = "walk";
+        bag.write("label", ros::Time(10.25), labelMsg);
+
+        bag.write("gains", ros::Time(10.5), arrayMsg(2, 1, {1, 2}));
+        bag.write("stiffness", ros::Time(10.5), arrayMsg(2, 2, {1, 2, 3, 4}));
+
+        // Only joint "a" is recorded, so joint "b" keeps its recorded effort.
+        sensor_msgs::JointState command1;
+        command1.name = {"a"};
+        command1.effort = {4};
+        bag.write("command", ros::Time(10.5), command1);
+
+        // These messages have the wrong types and are ignored.
+        bag.write("goal", ros::Time(10.75), labelMsg);
+        bag.write("gains", ros::Time(10.75), arrayMsg(2, 2, {1, 2, 3, 4}));
+        bag.write("command", ros::Time(10.75), goalMsg);
+
+        // A message on a topic that is not replayed.
+        bag.write("unbound", ros::Time(11.0), goalMsg);
+
+        bag.close();
+
+        ASSERT_TRUE(session.init(bagPath, SERVO_PERIOD, "command", {"a", "b"}));
+        session.addBinding("goal", &goalParam);
+        session.addBinding("mode", &modeParam);
+        session.addBinding("label", &labelParam);
+        session.addBinding("gains", &gainsParam);
+        session.addBinding("stiffness", &stiffnessParam);
+    }
+
+    virtual void TearDown()
+    {
+        std::remove(bagPath.c_str());
+    }
+
+    /*!
+     * A servo cycle whose latencies and efforts only depend on the number
+     * of servo cycles run.  Stage ii of servo cycle kk takes
+     * (ii + 1) * (kk + 1) milliseconds and the efforts are [kk, -kk].
+     */
+    ReplaySession::StepFunction fakeStep(std::vector<double> & periods)
+    {
+        return [&periods](double period, Vector & latencies, Vector & effort)
+        {
+            double kk = periods.size();
+            periods.push_back(period);
+
+            latencies.resize(ReplaySession::STAGE_NAMES.size());
+            for (int ii = 0; ii < latencies.size(); ii++)
+                latencies[ii] = (ii + 1) * (kk + 1) * 1e-3;
+
+            effort.resize(2);
+            effort << kk, -kk;
+            return true;
+        };
+    }
+
+    /*!
+     * Returns the report without the lines that depend on the wall clock.
+     */
+    std::string deterministicReport(bool & result)
+    {
+        std::stringstream report;
+        result = session.report(report);
+
+        std::stringstream ss;
+        std::string line;
+        while (std::getline(report, line))
+        {
+            if (line.find("replay_duration:") != 0 && line.find("cycles_per_second:") != 0)
+                ss << line << "\n";
+        }
+        return ss.str();
+    }
+
+    std::string bagPath;
+    ReplaySession session;
+
+    double goal;
+    int mode;
+    std::string label;
+    Vector gains;
+    Matrix stiffness;
+
+    controlit::RealParameter goalParam;
+    controlit::IntegerParameter modeParam;
+    controlit::StringParameter labelParam;
+    controlit::VectorParameter gainsParam;
+    controlit::MatrixParameter stiffnessParam;
+};
+
+} // namespace
+
+TEST_F(ReplaySessionTest, AppliesBindings)
+{
+    std::vector<double> periods;
+    ASSERT_TRUE(session.run(fakeStep(periods)));
+
+    EXPECT_EQ(3.5, goal);
+    EXPECT_EQ(7, mode);
+    EXPECT_EQ("walk", label);
+
+    ASSERT_EQ(2, gains.size());
+    EXPECT_EQ(1, gains[0]);
+    EXPECT_EQ(2, gains[1]);
+
+    ASSERT_EQ(2, stiffness.rows());
+    ASSERT_EQ(2, stiffness.cols());
+    EXPECT_EQ(2, stiffness(0, 1));
+    EXPECT_EQ(3, stiffness(1, 0));
+
+    EXPECT_EQ(5u, session.getNumBindingUpdates());
+    EXPECT_EQ(3u, session.getNumIgnoredMessages());
+}
+
+TEST_F(ReplaySessionTest, StepsAtServoPeriod)
+{
+    std::vector<double> periods;
+    ASSERT_TRUE(session.run(fakeStep(periods)));
+
+    // The first cycle runs at the start of the bag and the last at its end.
+    ASSERT_EQ(5u, periods.size());
+    EXPECT_EQ(0, periods[0]);
+    for (size_t ii = 1; ii < periods.size(); ii++)
+        EXPECT_EQ(SERVO_PERIOD, periods[ii]);
+
+    EXPECT_EQ(5u, session.getNumCycles());
+}
+
+TEST_F(ReplaySessionTest, AccountsEffortErrors)
+{
+    std::vector<double> periods;
+    ASSERT_TRUE(session.run(fakeStep(periods)));
+
+    // Cycle 0 commands [0, 0] against the recorded [1, 2] and cycle 2
+    // commands [2, -2] against the recorded [4, 2].  The command recorded
+    // with the wrong type before cycle 3 is not compared.
+    EXPECT_EQ(2u, session.getNumComparedCommands());
+    EXPECT_DOUBLE_EQ(2.5, session.getRMSEffortError());
+    EXPECT_DOUBLE_EQ(4, session.getMaxEffortError());
+}
+
+TEST_F(ReplaySessionTest, ReportIsDeterministic)
+{
+    std::vector<double> periods;
+    ASSERT_TRUE(session.run(fakeStep(periods)));
+
+    bool result;
+    EXPECT_EQ(
+        "bag: " + bagPath + "\n"
+        "servo_cycles: 5\n"
+        "binding_updates: 5\n"
+        "ignored_messages: 3\n"
+        "latency:\n"
+        "  read: {mean: 0.003, p99: 0.005, max: 0.005}\n"
+        "  publish_odometry: {mean: 0.006, p99: 0.01, max: 0.01}\n"
+        "  model_update: {mean: 0.009, p99: 0.015, max: 0.015}\n"
+        "  compute_command: {mean: 0.012, p99: 0.02, max: 0.02}\n"
+        "  emit_events: {mean: 0.015, p99: 0.025, max: 0.025}\n"
+        "  write: {mean: 0.018, p99: 0.03, max: 0.03}\n"
+        "  servo: {mean: 0.021, p99: 0.035, max: 0.035}\n"
+        "effort_error:\n"
+        "  compared_commands: 2\n"
+        "  rms: 2.5\n"
+        "  max: 4\n",
+        deterministicReport(result));
+    EXPECT_TRUE(result);
+}
+
+TEST_F(ReplaySessionTest, ReportFailsAboveLimits)
+{
+    std::vector<double> periods;
+    ASSERT_TRUE(session.run(fakeStep(periods)));
+
+    bool result;
+
+    session.setLimits(0.021, 2.5);
+    deterministicReport(result);
+    EXPECT_TRUE(result);
+
+    session.setLimits(0.02, 0);
+    std::string report = deterministicReport(result);
+    EXPECT_FALSE(result);
+    EXPECT_NE(std::string::npos, report.find("FAILED: The mean servo latency"));
+    EXPECT_EQ(std::string::npos, report.find("FAILED: The RMS effort error"));
+
+    session.setLimits(0, 2);
+    report = deterministicReport(result);
+    EXPECT_FALSE(result);
+    EXPECT_EQ(std::string::npos, report.find("FAILED: The mean servo latency"));
+    EXPECT_NE(std::string::npos, report.find("FAILED: The RMS effort error"));
+}
+
+TEST_F(ReplaySessionTest, StopsWhenServoCycleFails)
+{
+    std::vector<double> periods;
+    ReplaySession::StepFunction step = fakeStep(periods);
+
+    EXPECT_FALSE(session.run([&](double period, Vector & latencies, Vector & effort)
+    {
+        return periods.size() < 2 && step(period, latencies, effort);
+    }));
+
+    EXPECT_EQ(2u, session.getNumCycles());
+}
+
+TEST_F(ReplaySessionTest, RejectsMismatchedEfforts)
+{
+    std::vector<double> periods;
+    ReplaySession::StepFunction step = fakeStep(periods);
+
+    EXPECT_FALSE(session.run([&](double period, Vector & latencies, Vector & effort)
+    {
+        step(period, latencies, effort);
+        effort.resize(3);
+        return true;
+    }));
+
+    EXPECT_EQ(0u, session.getNumCycles());
+}
+
+TEST(ReplaySessionInitTest, InvalidInit)
+{
+    ReplaySession session;
+
+    EXPECT_FALSE(session.run([](double, Vector &, Vector &) { return true; }));
+    EXPECT_FALSE(session.init("/nonexistent/ReplaySessionTest.bag", SERVO_PERIOD, "command", {"a"}));
+    EXPECT_FALSE(session.init("/nonexistent/ReplaySessionTest.bag", 0, "command", {"a"}));
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_ROBOT_INTERFACE_LIBRARY_REPLAY_SAMPLES_HPP__
+#define __CONTROLIT_ROBOT_INTERFACE_LIBRARY_REPLAY_SAMPLES_HPP__
+
+#include <controlit/addons/eigen/LinearAlgebra.hpp>
+#include <rosbag/bag.h>
+#include <string>
+#include <vector>
+
+namespace controlit {
+namespace robot_interface_library {
+
+using controlit::addons::eigen::Vector;
+
+/*!
+ * The joint states and odometry recorded in a ROS bag, and the selection of
+ * the samples to replay at a given time.  The times of the samples are
+ * measured from the start of the bag, i.e., from its earliest message on
+ * any topic, so that they match the times of the other replayed topics.
+ */
+class ReplaySamples
+{
+public:
+    /*!
+     * A recorded joint state in the order of the robot model's real joints.
+     */
+    struct JointStateSample
+    {
+        double time;
+        Vector position;
+        Vector velocity;
+        Vector effort;
+    };
+
+    /*!
+     * A recorded odometry state.  The pose is the position followed by the
+     * orientation quaternion [w, x, y, z].  The velocity is the linear
+     * velocity followed by the angular velocity.
+     */
+    struct OdometrySample
+    {
+        double time;
+        Vector pose;
+        Vector velocity;
+    };
+
+    /*!
+     * The constructor.
+     */
+    ReplaySamples();
+
+    /*!
+     * Discards the samples and sets the joints whose states are replayed.
+     *
+     * \param[in] jointNames The names of the robot model's real joints.
+     */
+    void init(const std::vector<std::string> & jointNames);
+
+    /*!
+     * Loads the recorded joint states and odometry from a bag.
+     *
+     * \param[in] bag The bag.
+     * \param[in] stateTopic The topic of the joint states, of type
+     * controlit_robot_interface_library/JointState or sensor_msgs/JointState.
+     * \param[in] odometryTopic The topic of the nav_msgs/Odometry messages,
+     * or an empty string if the odometry is not replayed.
+     * \return Whether any joint states were recorded.
+     */
+    bool load(rosbag::Bag & bag, const std::string & stateTopic, const std::string & odometryTopic);
+
+    /*!
+     * Saves a recorded joint state.  Joints that are missing from the
+     * message keep their previously recorded state, or zero if there is
+     * none.  Each of the arrays may be empty if it was not recorded.
+     *
+     * \return Whether all joints were in the message.
+     */
+    bool addJointState(double time, const std::vector<std::string> & name,
+        const std::vector<double> & position, const std::vector<double> & velocity,
+        const std::vector<double> & effort);
+
+    /*!
+     * Saves a recorded odometry state.
+     */
+    void addOdometry(double time, const Vector & pose, const Vector & velocity);
+
+    /*!
+     * Selects the latest joint state recorded at or before the specified
+     * time, or the first one if the time precedes it.  The times must not
+     * decrease between calls.  At least one joint state must be recorded.
+     *
+     * \param[in] time The time since the start of the bag in seconds.
+     * \return The selected joint state.
+     */
+    const JointStateSample & selectJointState(double time);
+
+    /*!
+     * Selects the latest odometry state recorded at or before the specified
+     * time, like selectJointState(...).
+     *
+     * \param[in] time The time since the start of the bag in seconds.
+     * \return The selected odometry state, or nullptr if none was recorded.
+     */
+    const OdometrySample * selectOdometry(double time);
+
+    const std::vector<JointStateSample> & getJointStates() const { return jointStateSamples; }
+    const std::vector<OdometrySample> & getOdometry() const { return odometrySamples; }
+
+private:
+
+    /*!
+     * Advances an index into a list of samples to the latest sample recorded
+     * at or before the specified time.
+     */
+    template<class Sample>
+    static void advance(const std::vector<Sample> & samples, double time, size_t & index)
+    {
+        while (index + 1 < samples.size() && samples[index + 1].time <= time)
+            index++;
+    }
+
+    /*!
+     * The names of the robot model's real joints.
+     */
+    std::vector<std::string> jointNames;
+
+    /*!
+     * The recorded states, in the order in which they were recorded.
+     */
+    std::vector<JointStateSample> jointStateSamples;
+    std::vector<OdometrySample> odometrySamples;
+
+    /*!
+     * The indices of the latest selected samples.
+     */
+    size_t jointStateIndex;
+    size_t odometryIndex;
+};
+
+} // namespace robot_interface_library
+} // namespace controlit
+
+#endif // __CONTROLIT_ROBOT_INTERFACE_LIBRARY_REPLAY_SAMPLES_HPP__
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_ROBOT_INTERFACE_LIBRARY_ROBOT_INTERFACE_REPLAY_HPP__
+#define __CONTROLIT_ROBOT_INTERFACE_LIBRARY_ROBOT_INTERFACE_REPLAY_HPP__
+
+#include <controlit/RobotInterface.hpp>
+#include <controlit/robot_interface_library/ReplaySamples.hpp>
+#include <string>
+
+namespace controlit {
+namespace robot_interface_library {
+
+/*!
+ * A robot interface that replays the joint states and odometry recorded in
+ * a ROS bag.  The state returned by read(...) is the latest one recorded at
+ * or before the current controller time, where the controller time is
+ * measured from the start of the bag.  Before the first recorded state, the
+ * first recorded state is returned.
+ *
+ * This is meant to run in lockstep mode, where the controller time only
+ * advances when the replay driver steps the controller, so that the same
+ * recording always produces the same commands.  The commands are only
+ * published on the diagnostics topics.
+ *
+ * The following parameters configure the replay:
+ *
+ *   - controlit/replay/bag: The path of the bag (required).
+ *   - controlit/replay/state_topic: The topic of the joint states, of type
+ *     controlit_robot_interface_library/JointState or sensor_msgs/JointState
+ *     (default "robot_state").
+ *   - controlit/odometry_topic: The topic of the nav_msgs/Odometry messages
+ *     that set the state of the robot's base (optional).
+ */
+class RobotInterfaceReplay : public controlit::RobotInterface
+{
+public:
+    /*!
+     * The constructor.
+     */
+    RobotInterfaceReplay();
+
+    /*!
+     * The destructor.
+     */
+    virtual ~RobotInterfaceReplay();
+
+    /*!
+     * Initializes this robot interface and loads the recorded states.
+     *
+     * \param[in] nh The ROS node handle to use during the initialization
+     * process.
+     * \param[in] model The robot model.
+     * \return Whether the initialization was successful.
+     */
+    virtual bool init(ros::NodeHandle & nh, RTControlModel * model);
+
+protected:
+
+    /*!
+     * Obtains the recorded state of the robot at the current controller time.
+     *
+     * \param[out] latestRobotState The variable in which to store the latest robot state.
+     * \param[in] block Not used since the recorded states are always available.
+     * \return Whether the read was successful.
+     */
+    virtual bool read(controlit::RobotState & latestRobotState, bool block = false);
+
+    /*!
+     * Publishes a command on the diagnostics topics.
+     *
+     * \param[in] command The command to send to the robot.
+     * \return Whether the write was successful.
+     */
+    virtual bool write(const controlit::Command & command);
+
+private:
+
+    /*!
+     * The topics that are replayed.
+     */
+    std::string stateTopic;
+    std::string odometryTopic;
+
+    /*!
+     * The recorded states.
+     */
+    ReplaySamples samples;
+};
+
+} // namespace robot_interface_library
+} // namespace controlit
+
+#endif // __CONTROLIT_ROBOT_INTERFACE_LIBRARY_ROBOT_INTERFACE_REPLAY_HPP__
@@ -80,6 +80,11 @@ public:
      * The callback method for receiving joint state information from the robot.
      */
     void jointStateCallback(sensor_msgs::JointState & msg);
+
+    /*!
+     * \return The event that is notified when a joint state message arrives.
+     */
+    virtual controlit::StateEvent * getStateEvent() { return &stateEvent; }
     // EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 protected:
@@ -108,6 +113,11 @@ private:
      */
     bool receivedRobotState;
 
+    /*!
+     * Notified by jointStateCallback(...) each time a joint state arrives.
+     */
+    controlit::StateEvent stateEvent;
+
     /*!
      * Writes a test command into shared memory.  The command
      * has a recognizable pattern.  Useful for debugging purposes.
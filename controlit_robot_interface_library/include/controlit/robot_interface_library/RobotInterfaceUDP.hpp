@@ -24,6 +24,7 @@
 #include <controlit/RobotInterface.hpp>
 // #include <controlit/robot_interface_library/comm_udp.h>
 #include <controlit_udp/TxRxUDP.hpp>
+#include <controlit_udp/TxRxUDPV2.hpp>
 #include <controlit/addons/ros/RealTimePublisher.hpp>
 #include <sensor_msgs/JointState.h>
 
@@ -56,6 +57,11 @@ public:
      */
     virtual bool init(ros::NodeHandle & nh, RTControlModel * model);
 
+    /*!
+     * \return The event that is notified when a state packet arrives, or
+     * nullptr if version 1 of the UDP protocol is used.
+     */
+    virtual controlit::StateEvent * getStateEvent();
 
     // EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -80,11 +86,39 @@ protected:
     virtual bool write(const controlit::Command & command);
 
 private:
+    /*!
+     * Implementations of read(...) and write(...) for version 2 of the UDP protocol.
+     */
+    bool readV2(controlit::RobotState & latestRobotState, bool block);
+    bool writeV2(const controlit::Command & command);
+
+    /*!
+     * The receive callback of udpV2.  Notifies the StateEvent pointed to by
+     * stateEvent.
+     */
+    static void notifyStateEvent(void * stateEvent);
+
+    /*!
+     * Notified by the UDP receive thread when a state packet arrives.
+     */
+    controlit::StateEvent stateEvent;
+
+    /*!
+     * The version of the UDP protocol, either 1 or 2.
+     */
+    int protocolVersion;
+
     /*!
      * UDP adapter for tx/rx robot state and commands
      */
     controlit_udp::TxCommandRxStateUDP UDP;
 
+    /*!
+     * UDP adapter for tx/rx robot state and commands using version 2 of
+     * the protocol.
+     */
+    controlit_udp::TxRxUDPV2 udpV2;
+
     /*!
      * Holds received messages.
      */
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/robot_interface_library/ReplaySamples.hpp>
+
+#include <controlit/logging/RealTimeLogging.hpp>
+#include <controlit_robot_interface_library/JointState.h>
+#include <nav_msgs/Odometry.h>
+#include <sensor_msgs/JointState.h>
+#include <rosbag/view.h>
+#include <algorithm>
+
+namespace controlit {
+namespace robot_interface_library {
+
+#define NUM_POSE_VALUES 7
+#define NUM_VELOCITY_VALUES 6
+
+ReplaySamples::ReplaySamples() :
+    jointStateIndex(0),
+    odometryIndex(0)
+{
+}
+
+void ReplaySamples::init(const std::vector<std::string> & jointNames)
+{
+    this->jointNames = jointNames;
+    jointStateSamples.clear();
+    odometrySamples.clear();
+    jointStateIndex = 0;
+    odometryIndex = 0;
+}
+
+bool ReplaySamples::load(rosbag::Bag & bag, const std::string & stateTopic, const std::string & odometryTopic)
+{
+    // Times are measured from the start of the whole bag so that they match
+    // the times of the other topics replayed by the driver.
+    ros::Time startTime = rosbag::View(bag).getBeginTime();
+
+    std::vector<std::string> topics;
+    topics.push_back(stateTopic);
+    if (!odometryTopic.empty()) topics.push_back(odometryTopic);
+
+    bool warnedMissingJoints = false;
+
+    rosbag::View view(bag, rosbag::TopicQuery(topics));
+    for (const rosbag::MessageInstance & m : view)
+    {
+        double time = (m.getTime() - startTime).toSec();
+        bool complete = true;
+
+        if (m.getTopic() == stateTopic)
+        {
+            controlit_robot_interface_library::JointState::ConstPtr state
+                = m.instantiate<controlit_robot_interface_library::JointState>();
+            sensor_msgs::JointState::ConstPtr rosState = m.instantiate<sensor_msgs::JointState>();
+
+            if (state != nullptr)
+                complete = addJointState(time, state->name, state->position, state->velocity, state->effort);
+            else if (rosState != nullptr)
+                complete = addJointState(time, rosState->name, rosState->position, rosState->velocity, rosState->effort);
+            else
+                CONTROLIT_WARN << "Ignoring message of unsupported type \"" << m.getDataType()
+                    << "\" on topic \"" << stateTopic << "\".";
+        }
+        else
+        {
+            nav_msgs::Odometry::ConstPtr odom = m.instantiate<nav_msgs::Odometry>();
+
+            if (odom != nullptr)
+            {
+                Vector pose(NUM_POSE_VALUES);
+                pose << odom->pose.pose.position.x, odom->pose.pose.position.y, odom->pose.pose.position.z,
+                    odom->pose.pose.orientation.w, odom->pose.pose.orientation.x,
+                    odom->pose.pose.orientation.y, odom->pose.pose.orientation.z;
+
+                Vector velocity(NUM_VELOCITY_VALUES);
+                velocity << odom->twist.twist.linear.x, odom->twist.twist.linear.y, odom->twist.twist.linear.z,
+                    odom->twist.twist.angular.x, odom->twist.twist.angular.y, odom->twist.twist.angular.z;
+
+                addOdometry(time, pose, velocity);
+            }
+            else
+                CONTROLIT_WARN << "Ignoring message of unsupported type \"" << m.getDataType()
+                    << "\" on topic \"" << odometryTopic << "\".";
+        }
+
+        if (!complete && !warnedMissingJoints)
+        {
+            CONTROLIT_WARN << "The joint states recorded at time " << time << "s do not include every joint.  "
+                << "The missing joints keep their previously recorded states.";
+            warnedMissingJoints = true;
+        }
+    }
+
+    return !jointStateSamples.empty();
+}
+
+bool ReplaySamples::addJointState(double time, const std::vector<std::string> & name,
+    const std::vector<double> & position, const std::vector<double> & velocity,
+    const std::vector<double> & effort)
+{
+    JointStateSample sample;
+    sample.time = time;
+
+    if (jointStateSamples.empty())
+    {
+        sample.position.setZero(jointNames.size());
+        sample.velocity.setZero(jointNames.size());
+        sample.effort.setZero(jointNames.size());
+    }
+    else
+    {
+        sample.position = jointStateSamples.back().position;
+        sample.velocity = jointStateSamples.back().velocity;
+        sample.effort = jointStateSamples.back().effort;
+    }
+
+    bool complete = true;
+
+    for (size_t ii = 0; ii < jointNames.size(); ii++)
+    {
+        size_t jj = std::find(name.begin(), name.end(), jointNames[ii]) - name.begin();
+
+        if (jj == name.size())
+        {
+            complete = false;
+            continue;
+        }
+
+        if (jj < position.size()) sample.position[ii] = position[jj];
+        if (jj < velocity.size()) sample.velocity[ii] = velocity[jj];
+        if (jj < effort.size()) sample.effort[ii] = effort[jj];
+    }
+
+    jointStateSamples.push_back(sample);
+    return complete;
+}
+
+void ReplaySamples::addOdometry(double time, const Vector & pose, const Vector & velocity)
+{
+    OdometrySample sample;
+    sample.time = time;
+    sample.pose = pose;
+    sample.velocity = velocity;
+    odometrySamples.push_back(sample);
+}
+
+const ReplaySamples::JointStateSample & ReplaySamples::selectJointState(double time)
+{
+    advance(jointStateSamples, time, jointStateIndex);
+    return jointStateSamples[jointStateIndex];
+}
+
+const ReplaySamples::OdometrySample * ReplaySamples::selectOdometry(double time)
+{
+    if (odometrySamples.empty())
+        return nullptr;
+
+    advance(odometrySamples, time, odometryIndex);
+    return &odometrySamples[odometryIndex];
+}
+
+} // namespace robot_interface_library
+} // namespace controlit
@@ -26,6 +26,7 @@
 #include <controlit/robot_interface_library/RobotInterfaceBenchmark.hpp>
 #include <controlit/robot_interface_library/RobotInterfaceUDP.hpp>
 #include <controlit/robot_interface_library/RobotInterfaceSM.hpp>
+#include <controlit/robot_interface_library/RobotInterfaceReplay.hpp>
 
 // Defined in /opt/ros/groovy/include/pluginlib/class_list_macros.h:
 //
@@ -36,3 +37,4 @@ PLUGINLIB_EXPORT_CLASS(controlit::robot_interface_library::RobotInterfaceROSTopi
 PLUGINLIB_EXPORT_CLASS(controlit::robot_interface_library::RobotInterfaceBenchmark, controlit::RobotInterface);
 PLUGINLIB_EXPORT_CLASS(controlit::robot_interface_library::RobotInterfaceUDP, controlit::RobotInterface);
 PLUGINLIB_EXPORT_CLASS(controlit::robot_interface_library::RobotInterfaceSM, controlit::RobotInterface);
+PLUGINLIB_EXPORT_CLASS(controlit::robot_interface_library::RobotInterfaceReplay, controlit::RobotInterface);
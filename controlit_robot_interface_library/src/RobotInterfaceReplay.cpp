@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/robot_interface_library/RobotInterfaceReplay.hpp>
+
+#include <controlit/Command.hpp>
+#include <controlit/ControllerClock.hpp>
+#include <controlit/RobotState.hpp>
+#include <controlit/RTControlModel.hpp>
+#include <controlit/logging/RealTimeLogging.hpp>
+
+namespace controlit {
+namespace robot_interface_library {
+
+// Uncomment one of the following lines to enable/disable detailed debug statements.
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+#define PRINT_DEBUG_STATEMENT_RT(ss)
+// #define PRINT_DEBUG_STATEMENT_RT(ss) CONTROLIT_DEBUG_RT << ss;
+
+#define PARAM_REPLAY_BAG "controlit/replay/bag"
+#define PARAM_REPLAY_STATE_TOPIC "controlit/replay/state_topic"
+#define PARAM_ODOMETRY_TOPIC "controlit/odometry_topic"
+
+#define DEFAULT_STATE_TOPIC "robot_state"
+
+RobotInterfaceReplay::RobotInterfaceReplay() :
+    RobotInterface() // Call super-class' constructor
+{
+}
+
+RobotInterfaceReplay::~RobotInterfaceReplay()
+{
+}
+
+bool RobotInterfaceReplay::init(ros::NodeHandle & nh, RTControlModel * model)
+{
+    // Initialize the parent class.  Abort if it fails to initialize.
+    if (!RobotInterface::init(nh, model)) return false;
+
+    std::string bagPath;
+    if (!nh.getParam(PARAM_REPLAY_BAG, bagPath))
+    {
+        CONTROLIT_ERROR << "ROS parameter '" << nh.getNamespace() << "/" << PARAM_REPLAY_BAG
+            << "' must specify the bag to replay.";
+        return false;
+    }
+
+    nh.param<std::string>(PARAM_REPLAY_STATE_TOPIC, stateTopic, DEFAULT_STATE_TOPIC);
+    nh.getParam(PARAM_ODOMETRY_TOPIC, odometryTopic);
+
+    samples.init(model->get()->getRealJointNamesVector());
+
+    rosbag::Bag bag;
+    try
+    {
+        bag.open(bagPath, rosbag::bagmode::Read);
+    }
+    catch (rosbag::BagException & e)
+    {
+        CONTROLIT_ERROR << "Unable to open bag \"" << bagPath << "\": " << e.what();
+        return false;
+    }
+
+    if (!samples.load(bag, stateTopic, odometryTopic))
+    {
+        CONTROLIT_ERROR << "Bag \"" << bagPath << "\" does not contain any joint states on topic \""
+            << stateTopic << "\".";
+        return false;
+    }
+
+    CONTROLIT_INFO << "Replaying " << samples.getJointStates().size() << " joint states from topic \""
+        << stateTopic << "\" and " << samples.getOdometry().size() << " odometry states from topic \""
+        << odometryTopic << "\" of bag \"" << bagPath << "\".";
+
+    return true;
+}
+
+bool RobotInterfaceReplay::read(controlit::RobotState & latestRobotState, bool block)
+{
+    latestRobotState.resetTimestamp();
+
+    double time = ControllerClock::getTime();
+
+    const ReplaySamples::JointStateSample & state = samples.selectJointState(time);
+
+    for (unsigned int ii = 0; ii < latestRobotState.getNumJoints(); ii++)
+    {
+        latestRobotState.setJointPosition(ii, state.position[ii]);
+        latestRobotState.setJointVelocity(ii, state.velocity[ii]);
+        latestRobotState.setJointEffort(ii, state.effort[ii]);
+    }
+
+    const ReplaySamples::OdometrySample * odometry = samples.selectOdometry(time);
+    if (odometry != nullptr)
+    {
+        Eigen::Vector3d x(odometry->pose[0], odometry->pose[1], odometry->pose[2]);
+        Eigen::Quaterniond q(odometry->pose[3], odometry->pose[4], odometry->pose[5], odometry->pose[6]);
+
+        if (!latestRobotState.setRobotBaseState(x, q, odometry->velocity))
+        {
+            CONTROLIT_ERROR_RT << "Unable to set the robot base state recorded at time " << odometry->time << "s.";
+            return false;
+        }
+    }
+
+    PRINT_DEBUG_STATEMENT_RT("Replayed the joint states recorded at time " << state.time << "s:\n"
+        " - q = " << latestRobotState.getJointPosition().transpose() << "\n"
+        " - q_dot = " << latestRobotState.getJointVelocity().transpose());
+
+    // Call the parent class' read method.  This causes the latest robot state
+    // to be published.
+    return controlit::RobotInterface::read(latestRobotState, block);
+}
+
+bool RobotInterfaceReplay::write(const controlit::Command & command)
+{
+    // Call the parent class' write method.  This causes the command to be published.
+    return controlit::RobotInterface::write(command);
+}
+
+} // namespace robot_interface_library
+} // namespace controlit
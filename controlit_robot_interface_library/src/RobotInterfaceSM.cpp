@@ -220,6 +220,8 @@ void RobotInterfaceSM::jointStateCallback(sensor_msgs::JointState & msg)
         rcvdJointState = true;
     
         jointStateMutex.unlock();
+
+        stateEvent.notify();
     }
 }
 
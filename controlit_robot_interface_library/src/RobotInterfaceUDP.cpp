@@ -24,6 +24,7 @@
 #include <chrono>
 #include <controlit/RTControlModel.hpp>
 #include <controlit/Command.hpp>
+#include <controlit/RealTimeConfig.hpp>
 #include <controlit/addons/ros/ROSParameterAccessor.hpp>
 #include <controlit/robot_interface_library/OdometryStateReceiverROSTopic.hpp>
 
@@ -41,7 +42,8 @@ namespace robot_interface_library {
 // #define PRINT_INFO_STATEMENT_RT_ALWAYS(ss) std::cout << ss << std::endl;
 
 RobotInterfaceUDP::RobotInterfaceUDP() :
-    RobotInterface() // Call super-class' constructor
+    RobotInterface(), // Call super-class' constructor
+    protocolVersion(1)
 {
 }
 
@@ -49,6 +51,20 @@ RobotInterfaceUDP::~RobotInterfaceUDP()
 {
 }
 
+controlit::StateEvent * RobotInterfaceUDP::getStateEvent()
+{
+    // Version 1 of the protocol busy-waits for state, so it does not signal arrivals
+    if (protocolVersion == PROTOCOL_V2_VERSION)
+        return &stateEvent;
+    else
+        return nullptr;
+}
+
+void RobotInterfaceUDP::notifyStateEvent(void * stateEvent)
+{
+    static_cast<controlit::StateEvent *>(stateEvent)->notify();
+}
+
 bool RobotInterfaceUDP::init(ros::NodeHandle & nh, RTControlModel * model)
 {
     //---------------------------------------------------------------------------------
@@ -95,19 +111,61 @@ bool RobotInterfaceUDP::init(ros::NodeHandle & nh, RTControlModel * model)
         return false;
     }
 
+    // Version 2 of the protocol supports any number of DOFs and batches of samples.
+    int maxSamplesPerPacket = 1;
+    nh.getParam("controlit/RobotInterfaceUDP/protocolVersion", protocolVersion);
+    nh.getParam("controlit/RobotInterfaceUDP/maxSamplesPerPacket", maxSamplesPerPacket);
+
+    if (protocolVersion != 1 && protocolVersion != PROTOCOL_V2_VERSION)
+    {
+        CONTROLIT_ERROR << "Unsupported UDP protocol version " << protocolVersion << ".  "
+            << "Parameter: " << nh.getNamespace() << "controlit/RobotInterfaceUDP/protocolVersion";
+        return false;
+    }
+
     CONTROLIT_INFO << "Creating UDP interface with the following properties:\n"
              << "  - address: " << address << "\n"
              << "  - cmdPort: " << cmdPort << "\n"
-             << "  - statePort: " << statePort;
+             << "  - statePort: " << statePort << "\n"
+             << "  - protocolVersion: " << protocolVersion << "\n"
+             << "  - maxSamplesPerPacket: " << maxSamplesPerPacket;
 
     //---------------------------------------------------------------------------------
     // Initialize the UDP interface.
     //---------------------------------------------------------------------------------
 
-    if (!UDP.init(&cmdMsg, &rsMsg, (uint32_t)cmdPort, (uint32_t)statePort, address))
+    if (protocolVersion == PROTOCOL_V2_VERSION)
     {
-        CONTROLIT_ERROR << "UDP initialization failed, returning false";
-        return false;
+        udpV2.setReceiveCallback(&RobotInterfaceUDP::notifyStateEvent, &stateEvent);
+
+        if (maxSamplesPerPacket < 1
+            || !udpV2.init(PROTOCOL_V2_TYPE_STATE, PROTOCOL_V2_TYPE_COMMAND,
+                model->get()->getRealJointNamesVector().size(),
+                (uint32_t)statePort, (uint32_t)cmdPort, address, (uint32_t)maxSamplesPerPacket))
+        {
+            CONTROLIT_ERROR << "UDP initialization failed, returning false";
+            return false;
+        }
+
+        RealTimeConfig::placeThread("udp_rx", udpV2.GetRxThread());
+    }
+    else
+    {
+        if (model->get()->getRealJointNamesVector().size() > DEFAULT_NUM_DOFS)
+        {
+            CONTROLIT_ERROR << "Version 1 of the UDP protocol supports at most " << DEFAULT_NUM_DOFS
+                << " DOFs, but the robot has " << model->get()->getRealJointNamesVector().size()
+                << ".  Set parameter " << nh.getNamespace() << "controlit/RobotInterfaceUDP/protocolVersion to 2.";
+            return false;
+        }
+
+        if (!UDP.init(&cmdMsg, &rsMsg, (uint32_t)cmdPort, (uint32_t)statePort, address))
+        {
+            CONTROLIT_ERROR << "UDP initialization failed, returning false";
+            return false;
+        }
+
+        RealTimeConfig::placeThread("udp_rx", UDP.GetRxThread());
     }
 
     //---------------------------------------------------------------------------------
@@ -122,6 +180,9 @@ bool RobotInterfaceUDP::init(ros::NodeHandle & nh, RTControlModel * model)
 
 bool RobotInterfaceUDP::read(controlit::RobotState & latestRobotState, bool block)
 {
+    if (protocolVersion == PROTOCOL_V2_VERSION)
+        return readV2(latestRobotState, block);
+
     //---------------------------------------------------------------------------------
     // Sanity check to ensure the number of DOFs received is correct.
     //---------------------------------------------------------------------------------
@@ -209,6 +270,9 @@ bool RobotInterfaceUDP::read(controlit::RobotState & latestRobotState, bool bloc
 
 bool RobotInterfaceUDP::write(const controlit::Command & command)
 {
+    if (protocolVersion == PROTOCOL_V2_VERSION)
+        return writeV2(command);
+
     // HACK: The number of DOFs is hard-coded
     assert(cmdMsg.command.num_dofs == command.getNumDOFs());
 
@@ -248,6 +312,95 @@ bool RobotInterfaceUDP::write(const controlit::Command & command)
     return controlit::RobotInterface::write(command);
 }
 
+bool RobotInterfaceUDP::readV2(controlit::RobotState & latestRobotState, bool block)
+{
+    //---------------------------------------------------------------------------------
+    // Get the newest state packet.  Block if necessary.
+    //---------------------------------------------------------------------------------
+
+    bool isNew;
+    controlit_udp::PacketV2 packet = udpV2.readLatest(isNew);
+
+    if (!packet.isValid())
+    {
+        if (!block)
+            return false;
+
+        // Wait until message is received
+        while (!packet.isValid())
+        {
+            PRINT_DEBUG_STATEMENT("Waiting " << WAIT_DURATION_MS << " ms for robot state.")
+            std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_DURATION_MS));
+            packet = udpV2.readLatest(isNew);
+        }
+    }
+
+    latestRobotState.resetTimestamp();
+
+    //---------------------------------------------------------------------------------
+    // Use the most recent sample in the packet.  The packet's DOF count was
+    // validated when it was received.
+    //---------------------------------------------------------------------------------
+
+    uint32_t sample = packet.latest();
+
+    if (seqno == packet.sample(sample)->seqno)
+    {
+        double latency = rttTimer->getTime();
+        publishCommLatency(latency);
+    }
+
+    const double * position = packet.position(sample);
+    const double * velocity = packet.velocity(sample);
+    const double * effort = packet.effort(sample);
+
+    for (unsigned int ii = 0; ii < latestRobotState.getNumJoints(); ii++)
+    {
+        latestRobotState.setJointPosition(ii, position[ii]);
+        latestRobotState.setJointVelocity(ii, velocity[ii]);
+        latestRobotState.setJointEffort(ii, effort[ii]);
+    }
+
+    if (!odometryStateReceiver->getOdometry(latestRobotState, block))
+        return false;
+
+    return controlit::RobotInterface::read(latestRobotState, block);
+}
+
+bool RobotInterfaceUDP::writeV2(const controlit::Command & command)
+{
+    assert(udpV2.getNumDOFs() == command.getNumDOFs());
+
+    if (sendSeqno)
+    {
+        sendSeqno = false;
+        rttTimer->start();
+        ++seqno;
+    }
+
+    const Vector & position = command.getPositionCmd();
+    const Vector & velocity = command.getVelocityCmd();
+
+    udpV2.queueSample(seqno,
+        (size_t) position.size() == command.getNumDOFs() ? position.data() : NULL,
+        (size_t) velocity.size() == command.getNumDOFs() ? velocity.data() : NULL,
+        command.getEffortCmd().data());
+    udpV2.flush();
+
+    // Publish the command if the lock is available
+    if(commandPublisher.trylock())
+    {
+        commandPublisher.msg_.header.stamp = ros::Time::now();
+        for (unsigned int ii = 0; ii < command.getNumDOFs(); ii++)
+        {
+            commandPublisher.msg_.effort[ii] = command.getEffortCmd()[ii];
+        }
+
+        commandPublisher.unlockAndPublish();
+    }
+
+    return controlit::RobotInterface::write(command);
+}
 
 } // namespace robot_interface_library
 } // namespace controlit
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <controlit/robot_interface_library/ReplaySamples.hpp>
+#include <controlit_robot_interface_library/JointState.h>
+#include <nav_msgs/Odometry.h>
+#include <rosbag/bag.h>
+#include <sensor_msgs/JointState.h>
+#include <std_msgs/Float64.h>
+
+using controlit::robot_interface_library::ReplaySamples;
+using controlit::addons::eigen::Vector;
+
+namespace {
+
+std::vector<std::string> jointNames()
+{
+    return std::vector<std::string>{"joint_a", "joint_b"};
+}
+
+/*!
+ * Writes a small bag that starts with a message on an unrelated topic one
+ * second before the first joint state.  The joint states alternate between
+ * the two supported message types, the second one only contains joint_b,
+ * and an odometry message is recorded between each pair of joint states.
+ */
+class ReplaySamplesBagTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        char path[] = "/tmp/ReplaySamplesTestXXXXXX";
+        int fd = mkstemp(path);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        bagPath = std::string(path) + ".bag";
+        std::remove(path);
+
+        rosbag::Bag bag;
+        bag.open(bagPath, rosbag::bagmode::Write);
+
+        std_msgs::Float64 goal;
+        goal.data = 1;
+        bag.write("goal", ros::Time(100.0), goal);
+
+        controlit_robot_interface_library::JointState state0;
+        state0.name = jointNames();
+        state0.position = {1, 2};
+        state0.velocity = {3, 4};
+        state0.effort = {5, 6};
+        bag.write("robot_state", ros::Time(101.0), state0);
+
+        bag.write("odometry", ros::Time(101.5), odometry(1));
+
+        sensor_msgs::JointState state1;
+        state1.name = {"joint_b"};
+        state1.position = {20};
+        state1.velocity = {40};
+        bag.write("robot_state", ros::Time(102.0), state1);
+
+        bag.write("odometry", ros::Time(102.5), odometry(2));
+
+        controlit_robot_interface_library::JointState state2;
+        state2.name = {"joint_b", "joint_a"};
+        state2.position = {200, 100};
+        state2.velocity = {400, 300};
+        state2.effort = {600, 500};
+        bag.write("robot_state", ros::Time(103.0), state2);
+
+        bag.close();
+    }
+
+    virtual void TearDown()
+    {
+        std::remove(bagPath.c_str());
+    }
+
+    static nav_msgs::Odometry odometry(double x)
+    {
+        nav_msgs::Odometry msg;
+        msg.pose.pose.position.x = x;
+        msg.pose.pose.orientation.w = 1;
+        msg.twist.twist.linear.x = 10 * x;
+        msg.twist.twist.angular.z = 100 * x;
+        return msg;
+    }
+
+    std::string bagPath;
+};
+
+} // namespace
+
+TEST(ReplaySamplesTest, PartialJointStatesKeepPreviousValues)
+{
+    ReplaySamples samples;
+    samples.init(jointNames());
+
+    EXPECT_FALSE(samples.addJointState(0, {"joint_b"}, {2}, {}, {}));
+    EXPECT_TRUE(samples.addJointState(1, {"joint_b", "joint_a", "other"}, {20, 10, 0}, {40, 30, 0}, {}));
+    EXPECT_FALSE(samples.addJointState(2, {"joint_a"}, {100}, {300}, {500}));
+
+    const std::vector<ReplaySamples::JointStateSample> & states = samples.getJointStates();
+    ASSERT_EQ(3u, states.size());
+
+    // Joints missing from the first message are zero.
+    EXPECT_EQ(0, states[0].position[0]);
+    EXPECT_EQ(2, states[0].position[1]);
+    EXPECT_EQ(0, states[0].velocity[1]);
+
+    // Arrays missing from a message keep their previous values.
+    EXPECT_EQ(10, states[1].position[0]);
+    EXPECT_EQ(20, states[1].position[1]);
+    EXPECT_EQ(30, states[1].velocity[0]);
+    EXPECT_EQ(0, states[1].effort[0]);
+
+    EXPECT_EQ(100, states[2].position[0]);
+    EXPECT_EQ(20, states[2].position[1]);
+    EXPECT_EQ(40, states[2].velocity[1]);
+    EXPECT_EQ(500, states[2].effort[0]);
+    EXPECT_EQ(0, states[2].effort[1]);
+}
+
+TEST(ReplaySamplesTest, SelectsLatestJointStateAtOrBeforeTime)
+{
+    ReplaySamples samples;
+    samples.init(jointNames());
+    samples.addJointState(1, jointNames(), {1, 1}, {}, {});
+    samples.addJointState(2, jointNames(), {2, 2}, {}, {});
+    samples.addJointState(3, jointNames(), {3, 3}, {}, {});
+
+    // Before the first sample, the first sample is selected.
+    EXPECT_EQ(1, samples.selectJointState(0).time);
+    EXPECT_EQ(1, samples.selectJointState(1).time);
+    EXPECT_EQ(1, samples.selectJointState(1.999).time);
+    EXPECT_EQ(2, samples.selectJointState(2).time);
+
+    // Several samples may be skipped at once.
+    samples.init(jointNames());
+    samples.addJointState(1, jointNames(), {1, 1}, {}, {});
+    samples.addJointState(2, jointNames(), {2, 2}, {}, {});
+    samples.addJointState(3, jointNames(), {3, 3}, {}, {});
+    EXPECT_EQ(3, samples.selectJointState(3).time);
+    EXPECT_EQ(3, samples.selectJointState(3).position[0]);
+
+    // After the last sample, the last sample is selected.
+    EXPECT_EQ(3, samples.selectJointState(100).time);
+}
+
+TEST(ReplaySamplesTest, SelectsOdometryIndependentlyOfJointStates)
+{
+    ReplaySamples samples;
+    samples.init(jointNames());
+    samples.addJointState(0, jointNames(), {0, 0}, {}, {});
+
+    EXPECT_EQ(nullptr, samples.selectOdometry(0));
+
+    Vector pose(7), velocity(6);
+    pose.setZero();
+    velocity.setZero();
+
+    for (int ii = 1; ii <= 3; ii++)
+    {
+        pose[0] = ii;
+        samples.addOdometry(ii + 0.5, pose, velocity);
+    }
+
+    EXPECT_EQ(0, samples.selectJointState(2).time);
+
+    const ReplaySamples::OdometrySample * odometry = samples.selectOdometry(2);
+    ASSERT_NE(nullptr, odometry);
+    EXPECT_EQ(1.5, odometry->time);
+    EXPECT_EQ(1, odometry->pose[0]);
+
+    odometry = samples.selectOdometry(3.5);
+    ASSERT_NE(nullptr, odometry);
+    EXPECT_EQ(3.5, odometry->time);
+    EXPECT_EQ(3, odometry->pose[0]);
+}
+
+TEST_F(ReplaySamplesBagTest, LoadsSamplesRelativeToBagStart)
+{
+    rosbag::Bag bag(bagPath);
+    ReplaySamples samples;
+    samples.init(jointNames());
+    ASSERT_TRUE(samples.load(bag, "robot_state", "odometry"));
+
+    const std::vector<ReplaySamples::JointStateSample> & states = samples.getJointStates();
+    ASSERT_EQ(3u, states.size());
+
+    // The times are measured from the goal message, not the first state.
+    EXPECT_DOUBLE_EQ(1, states[0].time);
+    EXPECT_DOUBLE_EQ(2, states[1].time);
+    EXPECT_DOUBLE_EQ(3, states[2].time);
+
+    EXPECT_EQ(1, states[0].position[0]);
+    EXPECT_EQ(6, states[0].effort[1]);
+
+    // The sensor_msgs/JointState only contains joint_b and no effort.
+    EXPECT_EQ(1, states[1].position[0]);
+    EXPECT_EQ(20, states[1].position[1]);
+    EXPECT_EQ(40, states[1].velocity[1]);
+    EXPECT_EQ(6, states[1].effort[1]);
+
+    // The names are matched regardless of their order.
+    EXPECT_EQ(100, states[2].position[0]);
+    EXPECT_EQ(200, states[2].position[1]);
+    EXPECT_EQ(500, states[2].effort[0]);
+
+    const std::vector<ReplaySamples::OdometrySample> & odometry = samples.getOdometry();
+    ASSERT_EQ(2u, odometry.size());
+    EXPECT_DOUBLE_EQ(1.5, odometry[0].time);
+    EXPECT_DOUBLE_EQ(2.5, odometry[1].time);
+    EXPECT_EQ(2, odometry[1].pose[0]);
+    EXPECT_EQ(1, odometry[1].pose[3]);
+    EXPECT_EQ(20, odometry[1].velocity[0]);
+    EXPECT_EQ(200, odometry[1].velocity[5]);
+
+    // Replay the bag at the servo cycles of a 4 Hz controller.
+    const double expectedStateTimes[] = {1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3};
+    const double expectedOdometryTimes[] = {1.5, 1.5, 1.5, 1.5, 1.5, 1.5, 1.5, 1.5, 1.5, 1.5, 2.5, 2.5, 2.5};
+
+    for (int cycle = 0; cycle < 13; cycle++)
+    {
+        double time = cycle * 0.25;
+        EXPECT_DOUBLE_EQ(expectedStateTimes[cycle], samples.selectJointState(time).time) << "time = " << time;
+        EXPECT_DOUBLE_EQ(expectedOdometryTimes[cycle], samples.selectOdometry(time)->time) << "time = " << time;
+    }
+}
+
+TEST_F(ReplaySamplesBagTest, IgnoresOdometryIfNoTopic)
+{
+    rosbag::Bag bag(bagPath);
+    ReplaySamples samples;
+    samples.init(jointNames());
+    ASSERT_TRUE(samples.load(bag, "robot_state", ""));
+
+    EXPECT_EQ(3u, samples.getJointStates().size());
+    EXPECT_TRUE(samples.getOdometry().empty());
+
+    // The times are still measured from the start of the bag.
+    EXPECT_DOUBLE_EQ(1, samples.getJointStates()[0].time);
+}
+
+TEST_F(ReplaySamplesBagTest, FailsWithoutJointStates)
+{
+    rosbag::Bag bag(bagPath);
+    ReplaySamples samples;
+    samples.init(jointNames());
+    EXPECT_FALSE(samples.load(bag, "missing", "odometry"));
+    EXPECT_EQ(2u, samples.getOdometry().size());
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_EVENT_HPP__
+#define __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_EVENT_HPP__
+
+#include <controlit/ServoClock.hpp>
+#include <controlit/addons/ros/RealTimePublisher.hpp>
+#include <std_msgs/Float64MultiArray.h>
+
+namespace controlit {
+namespace servo_clock_library {
+
+/*!
+ * A servo clock that starts each servo cycle as soon as a new robot state
+ * arrives, as signaled by ServoableClass::getStateEvent().  This removes the
+ * phase offset between the robot's state updates and a free-running servo
+ * clock, which otherwise adds up to one servo period of latency.
+ *
+ * If no state arrives within TIMEOUT_PERIODS servo periods, the clock falls
+ * back to running periodically at the servo frequency until states arrive
+ * again.  If the servoable class does not provide a state event, the clock
+ * always runs periodically.
+ *
+ * The distribution of the latency between the arrival of a state and the
+ * end of the servo cycle it triggered is published on topic
+ * "diagnostics/stateEventLatency".  See publishLatencies() for the format.
+ */
+class ServoClockEvent : public controlit::ServoClock
+{
+public:
+    /*!
+     * The constructor.
+     */
+    ServoClockEvent();
+
+    /*!
+     * The destructor.
+     */
+    virtual ~ServoClockEvent();
+
+protected:
+
+    /*!
+     * The implementation of the update loop.
+     */
+    virtual void updateLoopImpl();
+
+private:
+    /*!
+     * Adds a latency measurement to the current window.
+     *
+     * \param[in] latency The latency in seconds.
+     */
+    void recordLatency(double latency);
+
+    /*!
+     * Publishes the statistics of the current window and starts a new
+     * window.  If the publisher is busy, the window is extended instead.
+     *
+     * The published data starts with the summary
+     *
+     *   [# cycles, # event cycles, # timeouts, min, mean, p50, p90, p99, max]
+     *
+     * where latencies are in seconds and are computed over the event cycles.
+     * It is followed by NUM_LATENCY_BINS histogram counts.  Bin i counts the
+     * latencies in [i, i + 1) * LATENCY_BIN_WIDTH, except that the last bin
+     * also counts all larger latencies.
+     */
+    void publishLatencies();
+
+    /*!
+     * \return An upper bound on the given quantile of the latencies in the
+     * current window based on the histogram.
+     */
+    double getQuantile(double quantile) const;
+
+    /*!
+     * The number of histogram bins and their width in seconds.
+     */
+    static const int NUM_LATENCY_BINS = 100;
+    static constexpr double LATENCY_BIN_WIDTH = 10e-6;
+
+    /*!
+     * The number of summary values at the start of the published data.
+     */
+    static const int NUM_SUMMARY_VALUES = 9;
+
+    /*!
+     * The number of servo cycles per published window.
+     */
+    static const int CYCLES_PER_WINDOW = 1000;
+
+    /*!
+     * The number of servo periods without a new state after which the clock
+     * falls back to running periodically.
+     */
+    static constexpr double TIMEOUT_PERIODS = 1.5;
+
+    /*!
+     * The statistics of the current window.
+     */
+    int numCycles;
+    int numEventCycles;
+    int numTimeouts;
+    double minLatency;
+    double maxLatency;
+    double sumLatency;
+    int latencyHistogram[NUM_LATENCY_BINS];
+
+    /*!
+     * Publishes the latency distribution.
+     */
+    controlit::addons::ros::RealtimePublisher<std_msgs::Float64MultiArray>
+        latencyPublisher;
+};
+
+} // namespace servo_clock_library
+} // namespace controlit
+
+#endif // __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_EVENT_HPP__
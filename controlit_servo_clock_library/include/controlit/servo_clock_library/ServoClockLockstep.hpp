@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_LOCKSTEP_HPP__
+#define __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_LOCKSTEP_HPP__
+
+#include <controlit/ServoClock.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace controlit {
+namespace servo_clock_library {
+
+/*!
+ * A servo clock that runs the controller in lockstep with a simulator.
+ * It does not have its own thread and is not paced by the wall clock.
+ * Instead, the simulator calls step(...) after each of its own steps, which
+ * advances the simulated ControllerClock and runs the servo cycles that
+ * became due on the calling thread.  The controller should be configured
+ * with controlit/lockstep so that the model and task updates complete within
+ * each servo cycle.
+ *
+ * Since nothing depends on the wall clock or on thread scheduling, a
+ * simulation runs as fast as the servo cycles can be computed and produces
+ * the same results every time it is run.
+ */
+class ServoClockLockstep : public controlit::ServoClock
+{
+public:
+    /*!
+     * The constructor.
+     */
+    ServoClockLockstep();
+
+    /*!
+     * The destructor.
+     */
+    virtual ~ServoClockLockstep();
+
+    /*!
+     * Registers this clock so that it is run by step(...).  The first servo
+     * cycle is due at the current simulated time.
+     *
+     * \param[in] frequency The frequency at which the servo should execute
+     * in simulated time.
+     * \return Whether the servo clock was started.
+     */
+    virtual bool start(double frequency);
+
+    /*!
+     * Unregisters this clock.  This blocks until the current call to
+     * step(...), if any, returns.
+     */
+    virtual bool stop();
+
+    /*!
+     * Advances the simulated time and runs the servo cycles of every started
+     * lockstep clock in the process that become due.  The cycles are run
+     * one at a time in order of their due times.  Clocks with the same due
+     * time are run in the order in which they were started.  The simulated
+     * time is set to each cycle's due time while it runs.
+     *
+     * This must not be called from within a servo cycle.
+     *
+     * \param[in] duration The amount of simulated time to advance in seconds.
+     * \return The number of servo cycles that were run.
+     */
+    static size_t step(double duration);
+
+protected:
+
+    /*!
+     * Not used since this clock does not have its own thread.
+     */
+    virtual void updateLoopImpl() {}
+
+private:
+    /*!
+     * Executes one servo cycle on the calling thread.
+     */
+    void runCycle();
+
+    /*!
+     * Whether this clock is registered.
+     */
+    bool isRegistered;
+
+    /*!
+     * The servo period in nanoseconds of simulated time.
+     */
+    int64_t periodNS;
+
+    /*!
+     * The simulated time in nanoseconds at which the first cycle was due,
+     * and the number of cycles run since then.  The due time of the next
+     * cycle is computed from these so that rounding errors do not accumulate.
+     */
+    int64_t startTimeNS;
+    int64_t numCycles;
+};
+
+} // namespace servo_clock_library
+} // namespace controlit
+
+#endif // __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_LOCKSTEP_HPP__
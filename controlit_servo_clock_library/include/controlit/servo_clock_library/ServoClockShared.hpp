@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_SHARED_HPP__
+#define __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_SHARED_HPP__
+
+#include <controlit/ServoClock.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace controlit {
+namespace servo_clock_library {
+
+/*!
+ * A servo clock that does not have its own thread.  Instead, every
+ * ServoClockShared in the process is run by the same SharedServoScheduler
+ * thread.  This is intended for processes that host several controllers,
+ * which would otherwise have one servo thread each competing for the
+ * same cores.
+ */
+class ServoClockShared : public controlit::ServoClock
+{
+public:
+    /*!
+     * The constructor.
+     */
+    ServoClockShared();
+
+    /*!
+     * The destructor.
+     */
+    virtual ~ServoClockShared();
+
+    /*!
+     * Registers this clock with the shared scheduler.
+     *
+     * \param[in] frequency The frequency at which the servo should execute.
+     * \return Whether the servo clock was started.
+     */
+    virtual bool start(double frequency);
+
+    /*!
+     * Unregisters this clock from the shared scheduler.  This blocks until
+     * the current cycle of this clock, if any, finishes.
+     */
+    virtual bool stop();
+
+    /*!
+     * Executes one servo cycle.  This is called by the shared scheduler.
+     */
+    void runCycle();
+
+protected:
+
+    /*!
+     * Not used since this clock does not have its own thread.
+     */
+    virtual void updateLoopImpl() {}
+
+private:
+    /*!
+     * Whether this clock is registered with the shared scheduler.
+     */
+    bool isRegistered;
+};
+
+/*!
+ * Runs the cycles of all ServoClockShared instances in the process on a
+ * single thread.  Each cycle, the scheduler runs the clock with the
+ * earliest deadline.  The clocks' deadlines are staggered within their
+ * periods so that controllers running at the same frequency do not all
+ * become ready at the same instant.
+ */
+class SharedServoScheduler
+{
+public:
+    /*!
+     * \return The scheduler of this process.
+     */
+    static SharedServoScheduler & getInstance();
+
+    /*!
+     * Adds a clock to the schedule.  The scheduler thread is started when
+     * the first clock is added.
+     *
+     * \param[in] clock The clock to add.
+     * \param[in] frequency The frequency at which the clock should run.
+     */
+    void add(ServoClockShared * clock, double frequency);
+
+    /*!
+     * Removes a clock from the schedule.  This blocks until the clock's
+     * current cycle, if any, finishes, so it must not be called from
+     * within the cycle.
+     *
+     * \param[in] clock The clock to remove.
+     */
+    void remove(ServoClockShared * clock);
+
+    /*!
+     * \return The number of cycles that were skipped because a deadline
+     * was missed by more than one period.
+     */
+    uint64_t getNumSkippedCycles();
+
+private:
+    /*!
+     * The constructor and destructor are private since there is only one
+     * scheduler per process.
+     */
+    SharedServoScheduler();
+    ~SharedServoScheduler();
+
+    /*!
+     * The scheduler thread's loop.
+     */
+    void schedulerLoop();
+
+    /*!
+     * Restarts the schedule with the deadlines of the clocks spread evenly
+     * across their periods.  The mutex must be held.
+     */
+    void stagger();
+
+    /*!
+     * \return The current time in nanoseconds on the monotonic clock.
+     */
+    static int64_t now();
+
+    /*!
+     * A clock that is being scheduled.
+     */
+    struct Client
+    {
+        ServoClockShared * clock;
+        int64_t periodNS;
+        int64_t deadlineNS;
+    };
+
+    std::vector<Client> clients;
+
+    /*!
+     * Protects all members.  It is released while a cycle is running, so
+     * that clocks can be added and removed without waiting for the cycle.
+     */
+    std::mutex mutex;
+
+    /*!
+     * Notified when a clock is added or removed.
+     */
+    std::condition_variable clientsChanged;
+
+    /*!
+     * The clock whose cycle is running, or nullptr.
+     */
+    ServoClockShared * runningClock;
+
+    /*!
+     * Notified when a cycle finishes.
+     */
+    std::condition_variable cycleFinished;
+
+    std::thread schedulerThread;
+
+    bool keepRunning;
+
+    uint64_t numSkippedCycles;
+};
+
+} // namespace servo_clock_library
+} // namespace controlit
+
+#endif // __CONTROLIT_SERVO_CLOCK_LIBRARY_SERVO_CLOCK_SHARED_HPP__
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/servo_clock_library/ServoClockEvent.hpp>
+
+#include <controlit/logging/RealTimeLogging.hpp>
+#include <controlit/StateEvent.hpp>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+#include <unistd.h>
+
+namespace controlit {
+namespace servo_clock_library {
+
+// Uncomment one of the following lines to enable/disable detailed debug statements.
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+#define PRINT_DEBUG_STATEMENT_RT(ss)
+// #define PRINT_DEBUG_STATEMENT_RT(ss) CONTROLIT_DEBUG_RT << ss;
+
+const int ServoClockEvent::NUM_LATENCY_BINS;
+constexpr double ServoClockEvent::LATENCY_BIN_WIDTH;
+const int ServoClockEvent::NUM_SUMMARY_VALUES;
+const int ServoClockEvent::CYCLES_PER_WINDOW;
+constexpr double ServoClockEvent::TIMEOUT_PERIODS;
+
+ServoClockEvent::ServoClockEvent() :
+    ServoClock(), // Call super-class' constructor
+    numCycles(0),
+    numEventCycles(0),
+    numTimeouts(0),
+    minLatency(std::numeric_limits<double>::max()),
+    maxLatency(0),
+    sumLatency(0),
+    latencyPublisher("diagnostics/stateEventLatency", 1)
+{
+    std::fill(latencyHistogram, latencyHistogram + NUM_LATENCY_BINS, 0);
+
+    // Initialize the message so it does not need to be allocated by the servo thread
+    while (!latencyPublisher.trylock()) usleep(200);
+    latencyPublisher.msg_.layout.dim.resize(2);
+    latencyPublisher.msg_.layout.dim[0].label = "summary";
+    latencyPublisher.msg_.layout.dim[0].size = NUM_SUMMARY_VALUES;
+    latencyPublisher.msg_.layout.dim[0].stride = NUM_SUMMARY_VALUES;
+    latencyPublisher.msg_.layout.dim[1].label = "histogram";
+    latencyPublisher.msg_.layout.dim[1].size = NUM_LATENCY_BINS;
+    latencyPublisher.msg_.layout.dim[1].stride = NUM_LATENCY_BINS;
+    latencyPublisher.msg_.layout.data_offset = 0;
+    latencyPublisher.msg_.data.resize(NUM_SUMMARY_VALUES + NUM_LATENCY_BINS, 0);
+    latencyPublisher.unlock();
+
+    PRINT_DEBUG_STATEMENT("ServoClockEvent Created");
+}
+
+ServoClockEvent::~ServoClockEvent()
+{
+}
+
+void ServoClockEvent::updateLoopImpl()
+{
+    PRINT_DEBUG_STATEMENT_RT("Method called!");
+
+    if (callServoInit)
+    {
+        servoableClass->servoInit();
+        callServoInit = false;
+    }
+
+    StateEvent * stateEvent = servoableClass->getStateEvent();
+
+    if (stateEvent == nullptr)
+    {
+        CONTROLIT_WARN_RT << "The robot interface does not signal state arrivals.  "
+                          << "Running periodically at " << frequency << "Hz.";
+    }
+
+    double servoPeriod = 1 / frequency;
+    double timeout = TIMEOUT_PERIODS * servoPeriod;
+
+    // Whether the previous cycle was triggered by a state.  If not, the
+    // clock is in periodic mode.
+    bool eventMode = true;
+
+    double cycleStartTime = StateEvent::now();
+
+    while (continueRunning)
+    {
+        // In event mode, wait up to the timeout for the next state.  In
+        // periodic mode, wait until the next period but still start early
+        // if a state arrives.
+        double deadline = cycleStartTime + (eventMode ? timeout : servoPeriod);
+        double remaining = deadline - StateEvent::now();
+
+        bool triggered = false;
+
+        if (stateEvent != nullptr)
+        {
+            triggered = stateEvent->wait(remaining);
+
+            if (!triggered && eventMode)
+            {
+                CONTROLIT_WARN_RT << "No robot state arrived for " << timeout
+                                  << "s.  Running periodically until one arrives.";
+            }
+        }
+        else if (remaining > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds((long)(remaining * 1e9)));
+        }
+
+        if (!continueRunning) break;
+
+        if (stateEvent != nullptr && !triggered) numTimeouts++;
+        eventMode = triggered;
+
+        cycleStartTime = StateEvent::now();
+
+        servoableClass->servoUpdate();
+
+        if (triggered)
+            recordLatency(StateEvent::now() - stateEvent->getNotifyTime());
+
+        if (++numCycles >= CYCLES_PER_WINDOW)
+            publishLatencies();
+    }
+
+    PRINT_DEBUG_STATEMENT_RT("Method exiting.")
+}
+
+void ServoClockEvent::recordLatency(double latency)
+{
+    numEventCycles++;
+    sumLatency += latency;
+    if (latency < minLatency) minLatency = latency;
+    if (latency > maxLatency) maxLatency = latency;
+
+    int bin = static_cast<int>(latency / LATENCY_BIN_WIDTH);
+    latencyHistogram[std::max(0, std::min(bin, NUM_LATENCY_BINS - 1))]++;
+}
+
+double ServoClockEvent::getQuantile(double quantile) const
+{
+    if (numEventCycles == 0) return 0;
+
+    int target = static_cast<int>(quantile * numEventCycles);
+    int count = 0;
+
+    for (int bin = 0; bin < NUM_LATENCY_BINS - 1; bin++)
+    {
+        count += latencyHistogram[bin];
+        if (count > target)
+            return (bin + 1) * LATENCY_BIN_WIDTH;
+    }
+
+    // The quantile is in the overflow bin
+    return maxLatency;
+}
+
+void ServoClockEvent::publishLatencies()
+{
+    if (!latencyPublisher.trylock()) return;
+
+    std::vector<double> & data = latencyPublisher.msg_.data;
+
+    data[0] = numCycles;
+    data[1] = numEventCycles;
+    data[2] = numTimeouts;
+    data[3] = numEventCycles > 0 ? minLatency : 0;
+    data[4] = numEventCycles > 0 ? sumLatency / numEventCycles : 0;
+    data[5] = getQuantile(0.5);
+    data[6] = getQuantile(0.9);
+    data[7] = getQuantile(0.99);
+    data[8] = maxLatency;
+
+    for (int bin = 0; bin < NUM_LATENCY_BINS; bin++)
+        data[NUM_SUMMARY_VALUES + bin] = latencyHistogram[bin];
+
+    latencyPublisher.unlockAndPublish();
+
+    numCycles = 0;
+    numEventCycles = 0;
+    numTimeouts = 0;
+    minLatency = std::numeric_limits<double>::max();
+    maxLatency = 0;
+    sumLatency = 0;
+    std::fill(latencyHistogram, latencyHistogram + NUM_LATENCY_BINS, 0);
+}
+
+} // namespace servo_clock_library
+} // namespace controlit
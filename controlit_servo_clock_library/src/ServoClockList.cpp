@@ -23,8 +23,14 @@
 
 #include <controlit/servo_clock_library/ServoClockChrono.hpp>
 #include <controlit/servo_clock_library/ServoClockROS.hpp>
+#include <controlit/servo_clock_library/ServoClockEvent.hpp>
+#include <controlit/servo_clock_library/ServoClockShared.hpp>
+#include <controlit/servo_clock_library/ServoClockLockstep.hpp>
 
 // Defined in /opt/ros/groovy/include/pluginlib/class_list_macros.h:
 //
 PLUGINLIB_EXPORT_CLASS(controlit::servo_clock_library::ServoClockChrono, controlit::ServoClock);
 PLUGINLIB_EXPORT_CLASS(controlit::servo_clock_library::ServoClockROS, controlit::ServoClock);
+PLUGINLIB_EXPORT_CLASS(controlit::servo_clock_library::ServoClockEvent, controlit::ServoClock);
+PLUGINLIB_EXPORT_CLASS(controlit::servo_clock_library::ServoClockShared, controlit::ServoClock);
+PLUGINLIB_EXPORT_CLASS(controlit::servo_clock_library::ServoClockLockstep, controlit::ServoClock);
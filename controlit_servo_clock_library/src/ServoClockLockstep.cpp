@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/servo_clock_library/ServoClockLockstep.hpp>
+
+#include <controlit/ControllerClock.hpp>
+#include <controlit/logging/RealTimeLogging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace controlit {
+namespace servo_clock_library {
+
+// Uncomment one of the following lines to enable/disable detailed debug statements.
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+#define PRINT_DEBUG_STATEMENT_RT(ss)
+// #define PRINT_DEBUG_STATEMENT_RT(ss) CONTROLIT_DEBUG_RT << ss;
+
+namespace {
+
+/*!
+ * The started lockstep clocks in the order in which they were started.
+ * The mutex also serializes the calls to step(...).
+ */
+std::mutex clocksMutex;
+std::vector<ServoClockLockstep *> clocks;
+
+} // namespace
+
+ServoClockLockstep::ServoClockLockstep() :
+    ServoClock(), // Call super-class' constructor
+    isRegistered(false),
+    periodNS(0),
+    startTimeNS(0),
+    numCycles(0)
+{
+    PRINT_DEBUG_STATEMENT("ServoClockLockstep Created");
+}
+
+ServoClockLockstep::~ServoClockLockstep()
+{
+    if (isRegistered) stop();
+}
+
+bool ServoClockLockstep::start(double frequency)
+{
+    if (servoableClass == nullptr)
+    {
+        CONTROLIT_ERROR_RT << "Attempted to start without initializing.";
+        return false;
+    }
+
+    if (isRegistered)
+    {
+        CONTROLIT_ERROR_RT << "Attempted to start multiple times.";
+        return false;
+    }
+
+    if (frequency <= 0)
+    {
+        CONTROLIT_ERROR_RT << "Invalid servo frequency " << frequency << "Hz.";
+        return false;
+    }
+
+    if (!ControllerClock::isSimulated())
+    {
+        CONTROLIT_WARN_RT << "The controller is not using simulated time.  "
+                          << "Set parameter controlit/lockstep to true.";
+    }
+
+    std::lock_guard<std::mutex> lock(clocksMutex);
+
+    this->frequency = frequency;
+    periodNS = std::llround(1e9 / frequency);
+    startTimeNS = ControllerClock::getSimulatedTime();
+    numCycles = 0;
+    continueRunning = true;
+
+    clocks.push_back(this);
+    isRegistered = true;
+    return true;
+}
+
+bool ServoClockLockstep::stop()
+{
+    if (!isRegistered)
+    {
+        CONTROLIT_ERROR_RT << "Attempted to stop without initializing or clock was never started.";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(clocksMutex);
+
+    clocks.erase(std::find(clocks.begin(), clocks.end(), this));
+
+    continueRunning = false;
+    callServoInit = true;
+    isRegistered = false;
+    return true;
+}
+
+size_t ServoClockLockstep::step(double duration)
+{
+    std::lock_guard<std::mutex> lock(clocksMutex);
+
+    int64_t endTimeNS = ControllerClock::getSimulatedTime() + std::llround(duration * 1e9);
+    size_t numCyclesRun = 0;
+
+    while (true)
+    {
+        // Find the clock whose next cycle is due first.  Ties are broken by
+        // the order in which the clocks were started.
+        ServoClockLockstep * nextClock = nullptr;
+        int64_t nextTimeNS = endTimeNS;
+
+        for (size_t ii = 0; ii < clocks.size(); ii++)
+        {
+            int64_t dueTimeNS = clocks[ii]->startTimeNS + clocks[ii]->numCycles * clocks[ii]->periodNS;
+
+            if (dueTimeNS <= endTimeNS && (nextClock == nullptr || dueTimeNS < nextTimeNS))
+            {
+                nextClock = clocks[ii];
+                nextTimeNS = dueTimeNS;
+            }
+        }
+
+        if (nextClock == nullptr) break;
+
+        ControllerClock::setSimulatedTime(nextTimeNS);
+
+        nextClock->runCycle();
+        nextClock->numCycles++;
+        numCyclesRun++;
+    }
+
+    ControllerClock::setSimulatedTime(endTimeNS);
+
+    return numCyclesRun;
+}
+
+void ServoClockLockstep::runCycle()
+{
+    PRINT_DEBUG_STATEMENT_RT("Running cycle " << numCycles);
+
+    if (callServoInit)
+    {
+        servoableClass->servoInit();
+        callServoInit = false;
+    }
+
+    servoableClass->servoUpdate();
+}
+
+} // namespace servo_clock_library
+} // namespace controlit
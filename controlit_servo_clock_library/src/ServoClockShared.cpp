@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <controlit/servo_clock_library/ServoClockShared.hpp>
+
+#include <controlit/RealTimeConfig.hpp>
+#include <controlit/logging/RealTimeLogging.hpp>
+#include <algorithm>
+#include <chrono>
+
+namespace controlit {
+namespace servo_clock_library {
+
+// Uncomment one of the following lines to enable/disable detailed debug statements.
+#define PRINT_DEBUG_STATEMENT(ss)
+// #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_DEBUG << ss;
+
+#define PRINT_DEBUG_STATEMENT_RT(ss)
+// #define PRINT_DEBUG_STATEMENT_RT(ss) CONTROLIT_DEBUG_RT << ss;
+
+/*!
+ * How far in the future the first deadline of a restarted schedule is.
+ */
+#define STAGGER_DELAY_NS 1000000
+
+ServoClockShared::ServoClockShared() :
+    ServoClock(), // Call super-class' constructor
+    isRegistered(false)
+{
+    PRINT_DEBUG_STATEMENT("ServoClockShared Created");
+}
+
+ServoClockShared::~ServoClockShared()
+{
+    if (isRegistered) stop();
+}
+
+bool ServoClockShared::start(double frequency)
+{
+    if (servoableClass == nullptr)
+    {
+        CONTROLIT_ERROR_RT << "Attempted to start without initializing.";
+        return false;
+    }
+
+    if (isRegistered)
+    {
+        CONTROLIT_ERROR_RT << "Attempted to start multiple times.";
+        return false;
+    }
+
+    if (frequency <= 0)
+    {
+        CONTROLIT_ERROR_RT << "Invalid servo frequency " << frequency << "Hz.";
+        return false;
+    }
+
+    this->frequency = frequency;
+    continueRunning = true;
+    SharedServoScheduler::getInstance().add(this, frequency);
+    isRegistered = true;
+    return true;
+}
+
+bool ServoClockShared::stop()
+{
+    if (!isRegistered)
+    {
+        CONTROLIT_ERROR_RT << "Attempted to stop without initializing or clock was never started.";
+        return false;
+    }
+
+    continueRunning = false;
+    SharedServoScheduler::getInstance().remove(this);
+    callServoInit = true;
+    isRegistered = false;
+    return true;
+}
+
+void ServoClockShared::runCycle()
+{
+    if (callServoInit)
+    {
+        servoableClass->servoInit();
+        callServoInit = false;
+    }
+
+    servoableClass->servoUpdate();
+}
+
+SharedServoScheduler & SharedServoScheduler::getInstance()
+{
+    static SharedServoScheduler instance;
+    return instance;
+}
+
+SharedServoScheduler::SharedServoScheduler() :
+    runningClock(nullptr),
+    keepRunning(true),
+    numSkippedCycles(0)
+{
+}
+
+SharedServoScheduler::~SharedServoScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        keepRunning = false;
+    }
+
+    clientsChanged.notify_one();
+
+    if (schedulerThread.joinable())
+        schedulerThread.join();
+}
+
+void SharedServoScheduler::add(ServoClockShared * clock, double frequency)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Client client;
+        client.clock = clock;
+        client.periodNS = static_cast<int64_t>(1e9 / frequency);
+        client.deadlineNS = 0;
+        clients.push_back(client);
+
+        stagger();
+
+        if (!schedulerThread.joinable())
+            schedulerThread = std::thread(&SharedServoScheduler::schedulerLoop, this);
+    }
+
+    clientsChanged.notify_one();
+}
+
+void SharedServoScheduler::remove(ServoClockShared * clock)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        // The clock may be destroyed once this returns
+        while (runningClock == clock)
+            cycleFinished.wait(lock);
+
+        for (auto it = clients.begin(); it != clients.end(); ++it)
+        {
+            if (it->clock == clock)
+            {
+                clients.erase(it);
+                break;
+            }
+        }
+
+        stagger();
+    }
+
+    clientsChanged.notify_one();
+}
+
+uint64_t SharedServoScheduler::getNumSkippedCycles()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return numSkippedCycles;
+}
+
+void SharedServoScheduler::stagger()
+{
+    int64_t start = now() + STAGGER_DELAY_NS;
+
+    for (size_t ii = 0; ii < clients.size(); ii++)
+        clients[ii].deadlineNS = start + clients[ii].periodNS * ii / clients.size();
+}
+
+int64_t SharedServoScheduler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SharedServoScheduler::schedulerLoop()
+{
+    PRINT_DEBUG_STATEMENT_RT("Method called!");
+
+    RealTimeConfig::placeCurrentThread("servo");
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (keepRunning)
+    {
+        if (clients.empty())
+        {
+            clientsChanged.wait(lock);
+            continue;
+        }
+
+        // Find the clock with the earliest deadline
+        size_t next = 0;
+        for (size_t ii = 1; ii < clients.size(); ii++)
+        {
+            if (clients[ii].deadlineNS < clients[next].deadlineNS)
+                next = ii;
+        }
+
+        int64_t currTime = now();
+
+        // Wait for the deadline.  The wait ends early if a clock is added or
+        // removed, in which case the schedule is re-evaluated.
+        if (currTime < clients[next].deadlineNS)
+        {
+            clientsChanged.wait_until(lock, std::chrono::steady_clock::time_point(
+                std::chrono::nanoseconds(clients[next].deadlineNS)));
+            continue;
+        }
+
+        Client & client = clients[next];
+        client.deadlineNS += client.periodNS;
+
+        // If the deadline was missed by more than a period, skip the missed
+        // cycles rather than running them back-to-back.
+        if (client.deadlineNS <= currTime)
+        {
+            int64_t missed = (currTime - client.deadlineNS) / client.periodNS + 1;
+            client.deadlineNS += missed * client.periodNS;
+            numSkippedCycles += missed;
+        }
+
+        // Run the cycle without holding the mutex so that other threads can
+        // add or remove clocks meanwhile.  The client may be erased or moved
+        // while the mutex is released, so only the clock is kept.
+        ServoClockShared * clock = client.clock;
+        runningClock = clock;
+        lock.unlock();
+
+        clock->runCycle();
+
+        lock.lock();
+        runningClock = nullptr;
+        cycleFinished.notify_all();
+    }
+
+    PRINT_DEBUG_STATEMENT_RT("Method exiting.")
+}
+
+} // namespace servo_clock_library
+} // namespace controlit
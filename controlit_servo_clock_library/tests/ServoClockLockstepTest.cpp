@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <controlit/ControllerClock.hpp>
+#include <controlit/servo_clock_library/ServoClockLockstep.hpp>
+
+using controlit::ControllerClock;
+using controlit::servo_clock_library::ServoClockLockstep;
+
+namespace {
+
+/*!
+ * A servo cycle: the ID of the clock that ran it and the simulated time in
+ * nanoseconds at which it ran.
+ */
+typedef std::pair<int, int64_t> Cycle;
+
+/*!
+ * Records the servo cycles run by a clock.
+ */
+class RecordingServoable : public controlit::ServoableClass
+{
+public:
+    RecordingServoable(int id, std::vector<Cycle> & cycles) :
+        id(id),
+        numInits(0),
+        cycles(cycles)
+    {
+    }
+
+    virtual void servoInit() { numInits++; }
+
+    virtual void servoUpdate()
+    {
+        cycles.push_back(Cycle(id, ControllerClock::getSimulatedTime()));
+    }
+
+    int id;
+    int numInits;
+
+private:
+    std::vector<Cycle> & cycles;
+};
+
+/*!
+ * Steps a 1 kHz clock and a 3 kHz clock through a fixed schedule.  The
+ * period of the 3 kHz clock is not a whole number of nanoseconds.
+ *
+ * \param[out] cycles The servo cycles in the order in which they ran.
+ * \param[out] numCyclesRun The value returned by each call to step(...).
+ */
+void runSchedule(std::vector<Cycle> & cycles, std::vector<size_t> & numCyclesRun)
+{
+    ControllerClock::setSimulated(true);
+
+    RecordingServoable servoableA(0, cycles);
+    RecordingServoable servoableB(1, cycles);
+
+    ServoClockLockstep clockA, clockB;
+    ASSERT_TRUE(clockA.init(&servoableA));
+    ASSERT_TRUE(clockB.init(&servoableB));
+    ASSERT_TRUE(clockA.start(1000));
+    ASSERT_TRUE(clockB.start(3000));
+
+    numCyclesRun.push_back(ServoClockLockstep::step(0));
+    numCyclesRun.push_back(ServoClockLockstep::step(0.001));
+    numCyclesRun.push_back(ServoClockLockstep::step(0.0005));
+    numCyclesRun.push_back(ServoClockLockstep::step(0.0005));
+    numCyclesRun.push_back(ServoClockLockstep::step(0.0001));
+
+    EXPECT_EQ(2100000, ControllerClock::getSimulatedTime());
+
+    EXPECT_EQ(1, servoableA.numInits);
+    EXPECT_EQ(1, servoableB.numInits);
+
+    EXPECT_TRUE(clockA.stop());
+    EXPECT_TRUE(clockB.stop());
+
+    ControllerClock::setSimulated(false);
+}
+
+} // namespace
+
+TEST(ServoClockLockstepTest, RunsCyclesInOrderOfDueTime)
+{
+    std::vector<Cycle> cycles;
+    std::vector<size_t> numCyclesRun;
+    runSchedule(cycles, numCyclesRun);
+
+    // The 3 kHz period rounds to 333333 ns, so its third cycle is due 1 ns
+    // before the second cycle of the 1 kHz clock.  Cycles that are due at
+    // the same time run in the order in which the clocks were started.
+    std::vector<Cycle> expected = {
+        Cycle(0, 0), Cycle(1, 0),
+        Cycle(1, 333333), Cycle(1, 666666), Cycle(1, 999999), Cycle(0, 1000000),
+        Cycle(1, 1333332),
+        Cycle(1, 1666665), Cycle(1, 1999998), Cycle(0, 2000000)
+    };
+
+    EXPECT_EQ(expected, cycles);
+
+    // A cycle that is due exactly at the end of a step runs within it.
+    std::vector<size_t> expectedNumCyclesRun = {2, 4, 1, 3, 0};
+    EXPECT_EQ(expectedNumCyclesRun, numCyclesRun);
+}
+
+TEST(ServoClockLockstepTest, IsDeterministic)
+{
+    std::vector<Cycle> firstCycles, secondCycles;
+    std::vector<size_t> firstNumCyclesRun, secondNumCyclesRun;
+
+    runSchedule(firstCycles, firstNumCyclesRun);
+    runSchedule(secondCycles, secondNumCyclesRun);
+
+    EXPECT_EQ(firstCycles, secondCycles);
+    EXPECT_EQ(firstNumCyclesRun, secondNumCyclesRun);
+}
+
+TEST(ServoClockLockstepTest, StopsRunningStoppedClocks)
+{
+    std::vector<Cycle> cycles;
+    RecordingServoable servoable(0, cycles);
+
+    ControllerClock::setSimulated(true);
+
+    ServoClockLockstep clock;
+    ASSERT_TRUE(clock.init(&servoable));
+    ASSERT_TRUE(clock.start(1000));
+
+    EXPECT_EQ(3u, ServoClockLockstep::step(0.002));
+    EXPECT_TRUE(clock.stop());
+    EXPECT_EQ(0u, ServoClockLockstep::step(0.002));
+    EXPECT_EQ(3u, cycles.size());
+
+    ControllerClock::setSimulated(false);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <controlit/servo_clock_library/ServoClockShared.hpp>
+
+using controlit::servo_clock_library::ServoClockShared;
+using controlit::servo_clock_library::SharedServoScheduler;
+
+namespace {
+
+/*!
+ * Waits up to one second for a condition to become true.
+ */
+template<typename Condition>
+bool waitFor(Condition condition)
+{
+    for (int ii = 0; ii < 1000 && !condition(); ii++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return condition();
+}
+
+/*!
+ * Counts its servo cycles.  Its first cycle blocks until it is released.
+ */
+class BlockingServoable : public controlit::ServoableClass
+{
+public:
+    BlockingServoable() :
+        numCycles(0),
+        release(false)
+    {
+    }
+
+    virtual void servoInit() {}
+
+    virtual void servoUpdate()
+    {
+        numCycles++;
+        while (!release)
+            std::this_thread::yield();
+    }
+
+    std::atomic<int> numCycles;
+    std::atomic<bool> release;
+};
+
+} // namespace
+
+TEST(ServoClockSharedTest, OtherClocksAreScheduledDuringCycle)
+{
+    BlockingServoable blocking, other;
+    other.release = true;
+
+    ServoClockShared blockingClock, otherClock;
+    ASSERT_TRUE(blockingClock.init(&blocking));
+    ASSERT_TRUE(otherClock.init(&other));
+
+    ASSERT_TRUE(blockingClock.start(1000));
+    ASSERT_TRUE(waitFor([&blocking] { return blocking.numCycles == 1; }));
+
+    // The scheduler is inside the blocking clock's cycle.  Adding a clock
+    // and querying the scheduler must not wait for the cycle to finish.
+    std::atomic<bool> started(false);
+    std::thread starter([&]
+    {
+        EXPECT_TRUE(otherClock.start(1000));
+        SharedServoScheduler::getInstance().getNumSkippedCycles();
+        started = true;
+    });
+
+    EXPECT_TRUE(waitFor([&started] { return started.load(); }));
+    EXPECT_EQ(0, other.numCycles);
+
+    blocking.release = true;
+    starter.join();
+
+    EXPECT_TRUE(waitFor([&other] { return other.numCycles >= 3; }));
+
+    EXPECT_TRUE(otherClock.stop());
+    EXPECT_TRUE(blockingClock.stop());
+}
+
+TEST(ServoClockSharedTest, StopWaitsForRunningCycle)
+{
+    BlockingServoable blocking;
+
+    ServoClockShared clock;
+    ASSERT_TRUE(clock.init(&blocking));
+    ASSERT_TRUE(clock.start(1000));
+    ASSERT_TRUE(waitFor([&blocking] { return blocking.numCycles == 1; }));
+
+    std::atomic<bool> stopped(false);
+    std::thread stopper([&]
+    {
+        EXPECT_TRUE(clock.stop());
+        stopped = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(stopped);
+
+    blocking.release = true;
+    stopper.join();
+    EXPECT_TRUE(stopped);
+
+    // No cycle runs after the clock is stopped.
+    int numCycles = blocking.numCycles;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(numCycles, blocking.numCycles);
+}
@@ -136,7 +136,7 @@ protected:
     std::unique_ptr<PDController> controller;
 
 private:
-    Matrix JvFrame, JwFrame, Jcom, JtLoc;
+    Matrix JvFrame, JwFrame, Jcom;
     
     Matrix linkIndexMask;
     std::vector<unsigned int> linkIndexList;
@@ -152,7 +152,6 @@ private:
     Matrix JwBody;
     Matrix JvFrame;
     Matrix JwFrame;
-    Matrix JtLoc;
 
     Vector xCurWorld;
     Vector xCurFrameProjected;
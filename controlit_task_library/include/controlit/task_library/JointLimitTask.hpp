@@ -67,7 +67,13 @@ protected:
      */
     virtual bool updateStateImpl(ControlModel * model, TaskState * taskState);
   
-    void setActiveLimits(ControlModel& model);
+    /*!
+     * Stores the indices of the joints whose limits are active.
+     *
+     * \param[in] model The control model.
+     * \param[out] activeLimits Where the joint indices should be stored.
+     */
+    void setActiveLimits(ControlModel& model, std::vector<int> & activeLimits);
   
     // parameters
     Vector upperStopRad_;
@@ -75,28 +81,25 @@ protected:
     Vector lowerStopRad_;
     Vector lowerTriggerRad_;
   
-    // utility variables
-    std::vector<int> activeLimits;
+    /*!
+     * The active limits found by updateStateImpl(...) and getCommand(...).
+     * They are separate because the two methods run in different threads.
+     * Both have room for every limit, so they are never reallocated.
+     */
+    std::vector<int> updateLimits;
+    std::vector<int> commandLimits;
+
+    /*!
+     * The errors and commands of every joint.  They are zero for the joints
+     * whose limits are inactive.
+     */
     Vector errpos, errvel;
-    Vector curkd, curkp, curMaxVel;
-    Vector allKd, allKp, allMaxVel;
-  
-    bool gainStored;
+    Vector jointCommand;
   
     /*!
      * A PD controller
      */
     std::unique_ptr<PDController> controller;
-
-private:
-    /*!
-     * Persistent pointers to parameters.  These pointers are maintained to prevent
-     * having to call lookupParameter(...) every time getCommand(...) is called.
-     */
-    controlit::Parameter * paramKp;
-    controlit::Parameter * paramKd;
-    controlit::Parameter * paramMaxVel;
-
 };
 
 } // namespace task_library
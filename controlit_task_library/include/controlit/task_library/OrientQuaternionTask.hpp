@@ -124,7 +124,7 @@ private:
 
     Eigen::Quaternion<double> goalQuat, cpQuat, frameQuat, bodyQuat, curQuat, curInFrameQuat, desQuat, errQuat;
     Eigen::Quaternion<double>::Matrix3 goalRot, cpRot, frameRot, bodyRot, curRot, curInFrameRot, desRot;
-    Matrix JwBody, JwFrame, JtLoc, Je1, Je2, Je3;
+    Matrix JwBody, JwFrame;
     Vector e0, e0dot;
 
     /*!
@@ -105,7 +105,7 @@ private:
 
     void addDefaultBindings();
 
-    Matrix JwBody, JwFrame, Rframe, Jtloc;
+    Matrix JwBody, JwFrame, Rframe;
 
     /*
      * A rotation matrix that converts from the world coordinate frame into the
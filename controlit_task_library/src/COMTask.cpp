@@ -19,11 +19,17 @@
  */
 
 #include <controlit/task_library/COMTask.hpp>
+#include <controlit/addons/eigen/SpatialKernels.hpp>
 #include <RigidBodyDynamics/Extras/rbdl_extras.hpp>
 
 namespace controlit {
 namespace task_library {
 
+using controlit::addons::eigen::multiply3xN;
+using controlit::addons::eigen::multiplyAdd3xN;
+using controlit::addons::eigen::rotateProjectRotate;
+using controlit::addons::eigen::skewMatrix;
+
 // Uncomment one of the following lines to enable/disable detailed debug statements.
 #define PRINT_DEBUG_STATEMENT(ss)
 // #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_PR_DEBUG << ss;
@@ -70,7 +76,6 @@ bool COMTask::init(ControlModel & model)
     JvFrame.resize(3, model.getNumDOFs());
     JwFrame.resize(3, model.getNumDOFs());
     Jcom.resize(3, model.getNumDOFs());
-    JtLoc.resize(3, model.getNumDOFs());
     linkIndexMask.setZero(3, model.getNumDOFs());
   
     // Resize output/optional parameters
@@ -203,6 +208,8 @@ bool COMTask::updateStateImpl(ControlModel * model, TaskState * taskState)
   
     RigidBodyDynamics::Extras::calcRobotJvCOM(model->rbdlModel(), model->getQ(), linkIndexList, Jcom);
   
+    Matrix3d projection = projection_;
+
     if(frameId_ != -1) //NOT using world reference frame
     {
         if(!isLatched)
@@ -210,29 +217,32 @@ bool COMTask::updateStateImpl(ControlModel * model, TaskState * taskState)
             RFrame = RigidBodyDynamics::CalcBodyWorldOrientation(model->rbdlModel(), model->getQ(), frameId_, false);
             TFrame = RigidBodyDynamics::CalcBodyToBaseCoordinates(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), false);
       
-            Vector comPos = RigidBodyDynamics::Extras::calcRobotCOM(model->rbdlModel(), model->getQ());
+            Vector3d comPos = RigidBodyDynamics::Extras::calcRobotCOM(model->rbdlModel(), model->getQ());
       
             RigidBodyDynamics::CalcPointJacobian(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), JvFrame, false);
             RigidBodyDynamics::CalcPointJacobianW(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), JwFrame, false);
       
-            Vector ProjectedGoal = RFrame.transpose() * projection_ * goalPosition_;
-            Vector ProjectedCOM = RFrame.transpose() * projection_ * RFrame * comPos;
-            Vector ProjectedTFrame = RFrame.transpose() * projection_ * RFrame * TFrame;
-      
-            // Terms from time derivative of current location
-            taskJacobian = RigidBodyDynamics::Math::VectorCrossMatrix(ProjectedCOM - ProjectedTFrame) * JwFrame;
-            taskJacobian -= RFrame.transpose() * projection_ * RFrame * RigidBodyDynamics::Math::VectorCrossMatrix(goalPosition_ - TFrame) * JwFrame;
-            taskJacobian += RFrame.transpose() * projection_ * RFrame * (Jcom - JvFrame);
+            Matrix3d frameRotation = RFrame;
+            Matrix3d rotatedProjection = rotateProjectRotate(frameRotation, projection);
+
+            Vector3d ProjectedGoal = frameRotation.transpose() * (projection * goalPosition_);
+            Vector3d ProjectedCOM = rotatedProjection * comPos;
+            Vector3d ProjectedTFrame = rotatedProjection * TFrame;
       
-            // Terms from time derivative of goal
-            taskJacobian -= RigidBodyDynamics::Math::VectorCrossMatrix(ProjectedGoal) * JwFrame;
-            taskJacobian += JvFrame;
+            // Terms from time derivative of current location and of goal.
+            // The 3 x 3 factors that multiply JwFrame are combined first so
+            // that each Jacobian is visited only once.
+            multiply3xN(skewMatrix(ProjectedCOM - ProjectedTFrame)
+                - rotatedProjection * skewMatrix(goalPosition_ - TFrame)
+                - skewMatrix(ProjectedGoal), JwFrame, taskJacobian);
+            multiplyAdd3xN(rotatedProjection, Jcom, taskJacobian);
+            multiplyAdd3xN(Matrix3d::Identity() - rotatedProjection, JvFrame, taskJacobian);
         }
         else
-            taskJacobian = latchedRotation.transpose() * projection_ * latchedRotation * Jcom;
+            multiply3xN(rotateProjectRotate(latchedRotation, projection), Jcom, taskJacobian);
     }
     else
-        taskJacobian = projection_ * Jcom;
+        multiply3xN(projection, Jcom, taskJacobian);
   
     if(!linkIndexList.empty())
     {
@@ -20,11 +20,17 @@
 
 #include <limits>
 #include <controlit/task_library/CartesianPositionTask.hpp>
+#include <controlit/addons/eigen/SpatialKernels.hpp>
 #include <visualization_msgs/MarkerArray.h>
 
 namespace controlit {
 namespace task_library {
 
+using controlit::addons::eigen::multiply3xN;
+using controlit::addons::eigen::multiplyAdd3xN;
+using controlit::addons::eigen::rotateProjectRotate;
+using controlit::addons::eigen::skewMatrix;
+
 // Uncomment one of the following lines to enable/disable detailed debug statements.
 #define PRINT_DEBUG_STATEMENT(ss)
 // #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_PR_DEBUG << ss;
@@ -112,7 +118,6 @@ bool CartesianPositionTask::init(ControlModel & model)
     JwBody.setZero(3, model.getNumDOFs());
     JvFrame.setZero(3, model.getNumDOFs());
     JwFrame.setZero(3, model.getNumDOFs());
-    JtLoc.setZero(3, model.getNumDOFs());
     actualPosition_.resize(3);
     actualWorldPosition_.resize(3);
     actualVelocity_.resize(3);
@@ -204,10 +209,16 @@ bool CartesianPositionTask::updateStateImpl(ControlModel * model, TaskState * ta
     Vector3d bodyTranslation = RigidBodyDynamics::CalcBodyToBaseCoordinates(model->rbdlModel(), model->getQ(), bodyId_, Vector::Zero(3), false);
     Matrix3d bodyRotation =  RigidBodyDynamics::CalcBodyWorldOrientation(model->rbdlModel(), model->getQ(), bodyId_, false);
 
+    // The control point expressed in the world frame, relative to the body's origin
+    Vector3d controlPointWorld = bodyRotation.transpose() * controlPoint_;
+    Matrix3d projection = projection_;
+
     // The goal is specified relative to the fixed world frame
     if(frameId_ == -1)
     {
-        taskJacobian = projection_ * (-RigidBodyDynamics::Math::VectorCrossMatrix(bodyRotation.transpose() * controlPoint_) * JwBody + JvBody);
+        // taskJacobian = P * (-[c]x * JwBody + JvBody)
+        multiply3xN(-projection * skewMatrix(controlPointWorld), JwBody, taskJacobian);
+        multiplyAdd3xN(projection, JvBody, taskJacobian);
     }
     else // The goal is specified relative to a robot frame, either latched or not
     {
@@ -218,7 +229,11 @@ bool CartesianPositionTask::updateStateImpl(ControlModel * model, TaskState * ta
         {
             frameRotation = latchedRotation;
             frameTranslation = latchedTranslation;
-            taskJacobian = frameRotation.transpose() * projection_ * frameRotation * (-RigidBodyDynamics::Math::VectorCrossMatrix(bodyRotation.transpose() * controlPoint_) * JwBody + JvBody);
+
+            // taskJacobian = R^T * P * R * (-[c]x * JwBody + JvBody)
+            Matrix3d rotatedProjection = rotateProjectRotate(frameRotation, projection);
+            multiply3xN(-rotatedProjection * skewMatrix(controlPointWorld), JwBody, taskJacobian);
+            multiplyAdd3xN(rotatedProjection, JvBody, taskJacobian);
         }
         else
         {
@@ -228,13 +243,23 @@ bool CartesianPositionTask::updateStateImpl(ControlModel * model, TaskState * ta
             RigidBodyDynamics::CalcPointJacobian(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), JvFrame, false);
             RigidBodyDynamics::CalcPointJacobianW(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), JwFrame, false);
 
-            taskJacobian = frameRotation.transpose() * projection_ * frameRotation * (-RigidBodyDynamics::Math::VectorCrossMatrix(bodyRotation.transpose() * controlPoint_) * JwBody + JvBody - JvFrame);
-            Vector3d beta = bodyRotation.transpose() * controlPoint_ + bodyTranslation - frameTranslation;
-            Vector3d alpha = frameRotation.transpose() * projection_ * frameRotation * beta;
-            taskJacobian += (-RigidBodyDynamics::Math::VectorCrossMatrix(alpha)
-                   + frameRotation.transpose() * projection_ * frameRotation * RigidBodyDynamics::Math::VectorCrossMatrix(beta)
-                   + RigidBodyDynamics::Math::VectorCrossMatrix(frameRotation.transpose() * projection_ * goalPosition_)) * JwFrame;
-            taskJacobian -= JvFrame;
+            // With A = R^T * P * R, the task Jacobian is
+            //
+            //   A * (-[c]x * JwBody + JvBody - JvFrame)
+            //     + (-[A * beta]x + A * [beta]x + [R^T * P * goal]x) * JwFrame - JvFrame
+            //
+            // The 3 x 3 factors are combined first so that each Jacobian is
+            // visited only once.
+            Matrix3d rotatedProjection = rotateProjectRotate(frameRotation, projection);
+            Vector3d beta = controlPointWorld + bodyTranslation - frameTranslation;
+            Vector3d alpha = rotatedProjection * beta;
+            Vector3d projectedGoal = frameRotation.transpose() * (projection * goalPosition_);
+
+            multiply3xN(-rotatedProjection * skewMatrix(controlPointWorld), JwBody, taskJacobian);
+            multiplyAdd3xN(rotatedProjection, JvBody, taskJacobian);
+            multiplyAdd3xN(-skewMatrix(alpha) + rotatedProjection * skewMatrix(beta) + skewMatrix(projectedGoal),
+                JwFrame, taskJacobian);
+            multiplyAdd3xN(-rotatedProjection - Matrix3d::Identity(), JvFrame, taskJacobian);
         }
     }
     return true;
@@ -248,8 +273,6 @@ bool CartesianPositionTask::sense(ControlModel & model)
     bodyTranslation = RigidBodyDynamics::CalcBodyToBaseCoordinates(model.rbdlModel(), Q, bodyId_, Vector::Zero(3), false);
     bodyRotation =  RigidBodyDynamics::CalcBodyWorldOrientation(model.rbdlModel(), Q, bodyId_, false);
 
-    getJacobian(JtLoc);
-
     xCurWorld = bodyRotation.transpose() * controlPoint_ + bodyTranslation;
 
 
@@ -297,7 +320,7 @@ bool CartesianPositionTask::sense(ControlModel & model)
     // the error_dot calculation...have now switch back -JtLoc * Qd to
     // see if it works since we're still having strange behevior w/ velocity
     // update fixed.
-    eVel = -JtLoc * Qd;
+    eVel.noalias() = -getJacobianView() * Qd;
 
     if(goalVelocity_.norm() > 0)
     {
@@ -315,7 +338,7 @@ bool CartesianPositionTask::getCommand(ControlModel & model, TaskCommand & comma
     {
         CONTROLIT_INFO_RT << "Taring the goal position!";
         goalPosition_ = RigidBodyDynamics::CalcBodyToBaseCoordinates(model.rbdlModel(), model.getQ(),
-            bodyId_, controlPoint_, true);
+            bodyId_, controlPoint_, false);
         tare = 0;
     }
 
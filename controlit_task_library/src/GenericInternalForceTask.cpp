@@ -100,14 +100,11 @@ bool GenericInternalForceTask::getCommand(ControlModel & model, TaskCommand & co
 {
     PRINT_DEBUG_STATEMENT_RT("Method called!")
   
-    Matrix WintSensor;
-    Vector FrSensor;
-    model.virtualLinkageModel().getWintSensor(WintSensor);
-    model.virtualLinkageModel().getFrSensor(FrSensor);
+    const Matrix & WintSensor = model.virtualLinkageModel().getWintSensor();
+    const Vector & FrSensor = model.virtualLinkageModel().getFrSensor();
   
-    actualFint = WintSensor * FrSensor;
-    Vector errVec = goalFint_ - actualFint;
-    double error = errVec.norm();
+    actualFint.noalias() = WintSensor * FrSensor;
+    double error = (goalFint_ - actualFint).norm();
     double error_dot = abs(error - error_);
   
     // Publish parameters
@@ -19,6 +19,8 @@
  */
 
 #include <controlit/task_library/JointLimitTask.hpp>
+#include <controlit/ScratchArena.hpp>
+#include <controlit/AllocationCheck.hpp>
 
 namespace controlit {
 namespace task_library {
@@ -31,10 +33,7 @@ namespace task_library {
 // #define PRINT_DEBUG_STATEMENT_RT(ss) CONTROLIT_PR_DEBUG_RT << ss;
 
 JointLimitTask::JointLimitTask()
-    : controlit::Task("__UNNAMED_JOINT_LIMIT_TASK__", CommandType::ACCELERATION, new TaskState(), new TaskState()),
-    paramKp(NULL),
-    paramKd(NULL),
-    paramMaxVel(NULL)
+    : controlit::Task("__UNNAMED_JOINT_LIMIT_TASK__", CommandType::ACCELERATION, new TaskState(), new TaskState())
 {
     declareParameter("upperStopRad", &upperStopRad_);
     declareParameter("upperTriggerRad", &upperTriggerRad_);
@@ -46,8 +45,6 @@ JointLimitTask::JointLimitTask()
   
     // Add controller parameters to this task
     controller->declareParameters(this);
-  
-    gainStored = false;
 }
 
 bool JointLimitTask::init(ControlModel & model)
@@ -55,11 +52,18 @@ bool JointLimitTask::init(ControlModel & model)
     PRINT_DEBUG_STATEMENT("Method called!")
   
     int dofs = model.getNumDOFs();
+
+    // The controller computes the command of every joint so that its size
+    // does not change when a limit becomes active or inactive.
     controller->resize(dofs);
-  
-    allKd.resize(dofs);
-    allKp.resize(dofs);
-    allMaxVel.resize(dofs);
+
+    errpos.setZero(dofs);
+    errvel.setZero(dofs);
+    jointCommand.setZero(dofs);
+
+    // A joint is listed twice if both of its triggers are crossed
+    updateLimits.reserve(2 * dofs);
+    commandLimits.reserve(2 * dofs);
   
     if (upperStopRad_.rows() != dofs)
     {
@@ -85,18 +89,6 @@ bool JointLimitTask::init(ControlModel & model)
         return false;
     }
   
-    if(!gainStored)
-    {
-        allKd = *(this->lookupParameter("kd")->getVector());
-        allKp = *(this->lookupParameter("kp")->getVector());
-        allMaxVel = *(this->lookupParameter("maxVelocity")->getVector());
-        gainStored = true;
-    }
-  
-    paramKp = this->lookupParameter("kp");
-    paramKd = this->lookupParameter("kd");
-    paramMaxVel = this->lookupParameter("maxVelocity");
-  
     return Task::init(model);
 }
 
@@ -111,13 +103,13 @@ bool JointLimitTask::updateStateImpl(ControlModel * model, TaskState * taskState
   
     int numDOFs = model->getNumDOFs();
   
-    setActiveLimits(*model);
+    setActiveLimits(*model, updateLimits);
   
-    taskJacobian.resize(activeLimits.size(), numDOFs);
+    taskJacobian.resize(updateLimits.size(), numDOFs);
     taskJacobian.setZero();
   
-    for(unsigned int i = 0; i < activeLimits.size(); i++)
-        taskJacobian(i, activeLimits[i]) = 1.0;
+    for(unsigned int i = 0; i < updateLimits.size(); i++)
+        taskJacobian(i, updateLimits[i]) = 1.0;
   
     return true;
 }
@@ -126,53 +118,54 @@ bool JointLimitTask::updateStateImpl(ControlModel * model, TaskState * taskState
 bool JointLimitTask::getCommand(ControlModel& model, TaskCommand & u)
 {
     // Get the latest joint state information
-    Vector Q(model.getNumDOFs());
-    Vector Qd(model.getNumDOFs());
+    ScratchArena & arena = ScratchArena::getThreadArena();
+    ScratchArena::VectorMap Q = arena.getVector(model.getNumDOFs());
+    ScratchArena::VectorMap Qd = arena.getVector(model.getNumDOFs());
   
     model.getLatestFullState(Q, Qd);
   
-    setActiveLimits(model);
-    int nActiveLimits = activeLimits.size();
-    int jointIndex;
-    controller->resize(nActiveLimits);
-  
-    // std::cout<<"There are "<<nActiveLimits<<" active joint limits"<<std::endl;
-    errpos.resize(nActiveLimits);
-    errvel.resize(nActiveLimits);
-    curkp.resize(nActiveLimits);
-    curkd.resize(nActiveLimits);
-    curMaxVel.resize(nActiveLimits);
-    u.command.resize(nActiveLimits);
-  
+    setActiveLimits(model, commandLimits);
+    int nActiveLimits = commandLimits.size();
+
+    // The errors of the inactive joints are zero
+    errpos.setZero();
+    errvel.setZero();
+
     for(int i = 0; i < nActiveLimits; i++)
     {
-        jointIndex = activeLimits[i];
-    
-        curkp[i] = allKp[jointIndex];
-        curkd[i] = allKd[jointIndex];
-        curMaxVel[i] = allMaxVel[jointIndex];
+        int jointIndex = commandLimits[i];
+
         if(model.getQ()[jointIndex] < lowerTriggerRad_[jointIndex])
         {
-            errpos[i] = lowerStopRad_[jointIndex] - Q[jointIndex];
-            errvel[i] = -Qd[jointIndex];
+            errpos[jointIndex] = lowerStopRad_[jointIndex] - Q[jointIndex];
+            errvel[jointIndex] = -Qd[jointIndex];
         }
         if(Q[jointIndex] > upperTriggerRad_[jointIndex])
         {
-            errpos[i] = upperStopRad_[jointIndex] - Q[jointIndex];
-            errvel[i] = -Qd[jointIndex];
+            errpos[jointIndex] = upperStopRad_[jointIndex] - Q[jointIndex];
+            errvel[jointIndex] = -Qd[jointIndex];
         }
     }
-  
-    // Publish the parameters
-    paramKp->set(curkp);
-    paramKd->set(curkd);
-    paramMaxVel->set(curMaxVel);
-  
+
     // Set the command type
     u.type = commandType_;
-  
-    // Compute the command
-    controller->computeCommand(errpos, errvel, u.command, this);
+
+    // Compute the command of every joint.  The PD controller and its
+    // saturation policy work component-wise, so the commands of the active
+    // joints are the same as if only they were given to it.
+    controller->computeCommand(errpos, errvel, jointCommand, this);
+
+    // The command must match the rows of the Jacobian, so it is only
+    // reallocated when a limit becomes active or inactive.
+    if (u.command.size() != nActiveLimits)
+    {
+        AllowAllocationScope allowAllocation;
+        u.command.resize(nActiveLimits);
+    }
+
+    for(int i = 0; i < nActiveLimits; i++)
+        u.command[i] = jointCommand[commandLimits[i]];
+
     return true;
 }
 
@@ -181,7 +174,7 @@ bool JointLimitTask::getCommand(ControlModel& model, TaskCommand & u)
  * the activeLimits vector if its either above or below
  * the limit thresholds.
  */
-void JointLimitTask::setActiveLimits(ControlModel& model)
+void JointLimitTask::setActiveLimits(ControlModel& model, std::vector<int> & activeLimits)
 {
     activeLimits.clear();
   
@@ -20,10 +20,14 @@
 
 #include <rbdl/rbdl.h>
 #include <controlit/task_library/OrientQuaternionTask.hpp>
+#include <controlit/addons/eigen/SpatialKernels.hpp>
 
 namespace controlit {
 namespace task_library {
 
+using controlit::addons::eigen::skewMultiply3xN;
+using controlit::addons::eigen::skewMultiplyAdd3xN;
+
 // Uncomment one of the following lines to enable/disable detailed debug statements.
 #define PRINT_DEBUG_STATEMENT(ss)
 // #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_PR_DEBUG << ss;
@@ -127,12 +131,8 @@ bool OrientQuaternionTask::init(ControlModel & model)
     controller->resize(9);
     e0.resize(9);
     e0dot.resize(9);
-    Je1.resize(3, model.getNumDOFs());
-    Je2.resize(3, model.getNumDOFs());
-    Je3.resize(3, model.getNumDOFs());
     JwBody.resize(3, model.getNumDOFs());
     JwFrame.resize(3, model.getNumDOFs());
-    JtLoc.resize(9, model.getNumDOFs());
 
     //resize optional output parameter
     actualPosition_.resize(4);
@@ -293,11 +293,12 @@ bool OrientQuaternionTask::updateStateImpl(ControlModel * model, TaskState * tas
     // Convert the control point quaternion given in local coordinate frame into global coordinate frame
     curRot = bodyRot * cpQuat.toRotationMatrix().transpose();
 
-    // Convert the rotation Jacobian from local to global coordinate frame
-    Je1 = -RigidBodyDynamics::Math::VectorCrossMatrix(curRot.col(0)) * JwBody;
-    Je2 = -RigidBodyDynamics::Math::VectorCrossMatrix(curRot.col(1)) * JwBody;
-    Je3 = -RigidBodyDynamics::Math::VectorCrossMatrix(curRot.col(2)) * JwBody;
-
+    // Convert the rotation Jacobian from local to global coordinate frame.
+    // Each 3 x N block is written directly into the task Jacobian.
+    int numDOFs = model->getNumDOFs();
+    skewMultiply3xN(-curRot.col(0), JwBody, taskJacobian.block(0, 0, 3, numDOFs));
+    skewMultiply3xN(-curRot.col(1), JwBody, taskJacobian.block(3, 0, 3, numDOFs));
+    skewMultiply3xN(-curRot.col(2), JwBody, taskJacobian.block(6, 0, 3, numDOFs));
 
     if(frameId_ != -1 && !isLatched) // Working in a frame which is moving with the robot
     {
@@ -314,16 +315,11 @@ bool OrientQuaternionTask::updateStateImpl(ControlModel * model, TaskState * tas
         RigidBodyDynamics::CalcPointJacobianW(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), JwFrame, false);
         desRot = frameRot.transpose() * goalRot;
 
-        Je1 += RigidBodyDynamics::Math::VectorCrossMatrix(desRot.col(0)) * JwFrame;
-        Je2 += RigidBodyDynamics::Math::VectorCrossMatrix(desRot.col(1)) * JwFrame;
-        Je3 += RigidBodyDynamics::Math::VectorCrossMatrix(desRot.col(2)) * JwFrame;
+        skewMultiplyAdd3xN(desRot.col(0), JwFrame, taskJacobian.block(0, 0, 3, numDOFs));
+        skewMultiplyAdd3xN(desRot.col(1), JwFrame, taskJacobian.block(3, 0, 3, numDOFs));
+        skewMultiplyAdd3xN(desRot.col(2), JwFrame, taskJacobian.block(6, 0, 3, numDOFs));
     }
 
-    // Save the task Jacobian
-    taskJacobian.block(0, 0, 3, model->getNumDOFs()) = Je1;
-    taskJacobian.block(3, 0, 3, model->getNumDOFs()) = Je2;
-    taskJacobian.block(6, 0, 3, model->getNumDOFs()) = Je3;
-
     return true;
 }
 
@@ -332,8 +328,6 @@ bool OrientQuaternionTask::sense(ControlModel & model)
     // Get the latest joint state information
     model.getLatestFullState(Q, Qd);
 
-    getJacobian(JtLoc);
-
     // TO-DO: Move this into the TaskState object!...ALREADY UPDATED!!!!
     bodyRot = RigidBodyDynamics::CalcBodyWorldOrientation(model.rbdlModel(), Q, bodyId_, false).transpose();
     bodyQuat = bodyRot;
@@ -402,7 +396,7 @@ bool OrientQuaternionTask::getCommand(ControlModel & model, TaskCommand & u)
     u.type = commandType_;
 
     // Compute the orientation velocity error
-    e0dot = -JtLoc * Qd;
+    e0dot.noalias() = -getJacobianView() * Qd;
     if(goalVelocity_.norm() > 0)
     {
         e0dot.segment(0,3) -= frameRot.transpose() * RigidBodyDynamics::Math::VectorCrossMatrix(goalRot.col(0)) * goalVelocity_;
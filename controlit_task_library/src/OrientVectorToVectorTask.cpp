@@ -21,6 +21,7 @@
 #include <rbdl/rbdl.h>
 #include <rbdl/rbdl_mathutils.h>
 #include <controlit/task_library/OrientVectorToVectorTask.hpp>
+#include <controlit/addons/eigen/SpatialKernels.hpp>
 
 #include <geometry_msgs/Point.h>
 #include <visualization_msgs/Marker.h>
@@ -28,6 +29,9 @@
 namespace controlit {
 namespace task_library {
 
+using controlit::addons::eigen::skewMultiply3xN;
+using controlit::addons::eigen::skewMultiplyAdd3xN;
+
 // Uncomment one of the following lines to enable/disable detailed debug statements.
 #define PRINT_DEBUG_STATEMENT(ss)
 // #define PRINT_DEBUG_STATEMENT(ss) CONTROLIT_PR_DEBUG << ss;
@@ -97,7 +101,6 @@ bool OrientVectorToVectorTask::init(ControlModel & model)
     e0.resize(3);
     JwBody.resize(3, model.getNumDOFs());
     JwFrame.resize(3, model.getNumDOFs());
-    Jtloc.resize(3, model.getNumDOFs());
     Rbody.resize(3, 3);
     Rframe.resize(3, 3);
 
@@ -213,8 +216,8 @@ bool OrientVectorToVectorTask::updateStateImpl(ControlModel * model, TaskState *
     RigidBodyDynamics::CalcPointJacobianW(model->rbdlModel(), model->getQ(), bodyId_, Vector::Zero(3), JwBody, false);
     Rbody = RigidBodyDynamics::CalcBodyWorldOrientation(model->rbdlModel(), model->getQ(), bodyId_, false);
 
-    Vector RTeBody = Rbody.transpose() * bodyFrameVector_;
-    taskJacobian = -RigidBodyDynamics::Math::VectorCrossMatrix(RTeBody) * JwBody;
+    Vector3d RTeBody = Rbody.transpose() * bodyFrameVector_;
+    skewMultiply3xN(-RTeBody, JwBody, taskJacobian);
 
     if(frameId_ != -1) // Goal vector is in a robot reference frame, either latched or unlatched
     {
@@ -222,8 +225,8 @@ bool OrientVectorToVectorTask::updateStateImpl(ControlModel * model, TaskState *
         {
             RigidBodyDynamics::CalcPointJacobianW(model->rbdlModel(), model->getQ(), frameId_, Vector::Zero(3), JwFrame, false);
             Rframe = RigidBodyDynamics::CalcBodyWorldOrientation(model->rbdlModel(), model->getQ(), frameId_, false);
-            Vector goal = Rframe.transpose() * goalVector_;
-            taskJacobian += RigidBodyDynamics::Math::VectorCrossMatrix(goal) * JwFrame;
+            Vector3d goal = Rframe.transpose() * goalVector_;
+            skewMultiplyAdd3xN(goal, JwFrame, taskJacobian);
         }
     }
 
@@ -252,8 +255,6 @@ bool OrientVectorToVectorTask::sense(ControlModel & model)
     // Check if latched status has been updated
     updateLatch(&model);
 
-    getJacobian(Jtloc);
-
     // Compute the goal vector in the frameName_ coordinate frame
     // goalHeading = goalVector_;
     paramGoalHeading->set(goalVector_); // sets member variable "goalHeading"
@@ -300,8 +301,8 @@ bool OrientVectorToVectorTask::getCommand(ControlModel & model, TaskCommand & co
     command.type = commandType_;
 
     // Compute the command
-    // The goal velocity is zero, thus the velocity error is -Jtloc * Qd.
-    controller->computeCommand(e0, -Jtloc * Qd, command.command, this);
+    // The goal velocity is zero, thus the velocity error is -J * Qd.
+    controller->computeCommand(e0, -getJacobianView() * Qd, command.command, this);
 
     tran_BodyToBase = RigidBodyDynamics::CalcBodyToBaseCoordinates(model.rbdlModel(), Q, bodyId_, base_vector, false);
 
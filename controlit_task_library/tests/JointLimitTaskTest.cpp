@@ -27,6 +27,8 @@
 #include <controlit/task_library/JointLimitTask.hpp>
 #include <controlit/ControlModelLibrary.hpp>
 #include <controlit/RobotState.hpp>
+#include <controlit/AllocationCheck.hpp>
+#include <controlit/ScratchArena.hpp>
 
 namespace controlit {
 namespace task_library {
@@ -47,6 +49,66 @@ protected:
     myModel.reset();
   }
 
+  /*!
+   * Limits the last two joints to [-0.2, 0] and gives them a unit proportional gain.
+   */
+  void setLimitsAndGains(controlit::Task & task)
+  {
+    // Set the parameter upperStopRad to be all zeros
+    p = task.lookupParameter("upperStopRad");
+    EXPECT_TRUE(p) << "Unable to get upperStopRad parameter.";
+    Vector upperStopRad(8); upperStopRad.setZero();
+    EXPECT_TRUE(p->set(upperStopRad));
+
+    // Set the parameter upperTriggerRad to be a tolerance higher than the
+    // upperStopRad parameter.  In this case, we set it to be:
+    // <1e12, 1e12,  1e12, 1e12, 1e12, 1e12, 0.1, 0.1>
+    p = task.lookupParameter("upperTriggerRad");
+    EXPECT_TRUE(p) << "Unable to get upperTriggerRad parameter.";
+    Vector upperTriggerRad(8); upperTriggerRad.setZero();
+    upperTriggerRad(6) = 0.1; upperTriggerRad(7) = 0.1;
+    for(int i = 0; i < 6; i++)
+      upperTriggerRad(i) = 1e12;
+    EXPECT_TRUE(p->set(upperTriggerRad));
+
+    // Set the parameter lowerStopRad to be:
+    // <0, 0, 0, 0, 0, 0, -0.2, -0.2>
+    p = task.lookupParameter("lowerStopRad");
+    EXPECT_TRUE(p) << "Unable to get lowerStopRad parameter.";
+    Vector lowerStopRad(8); lowerStopRad.setZero();
+    lowerStopRad(6) = -0.2; lowerStopRad(7) = -0.2;
+    EXPECT_TRUE(p->set(lowerStopRad));
+
+    // Set the parameter lowerTriggerRad to be  a tolerance lower than the
+    // lowerStopRad parameter.  In this case, we set it to be:
+    // <-1e12, -1e12,  -1e12, -1e12, -1e12, -1e12, -0.3, -0.3>
+    p = task.lookupParameter("lowerTriggerRad");
+    EXPECT_TRUE(p) << "Unable to get lowerTriggerRad parameter.";
+    Vector lowerTriggerRad(8); lowerTriggerRad.setZero();
+    lowerTriggerRad(6) = -0.3; lowerTriggerRad(7) = -0.3;
+    for(int i = 0; i < 6; i++)
+      lowerTriggerRad(i) = -1e12;
+    EXPECT_TRUE(p->set(lowerTriggerRad));
+
+    // Set parameter kp to be ones
+    p = task.lookupParameter("kp");
+    EXPECT_TRUE(p) << "Unable to get kp parameter.";
+    Vector kp(8); kp.setOnes();
+    EXPECT_TRUE(p->set(kp));
+
+    // Set parameter kd to be zeros
+    p = task.lookupParameter("kd");
+    EXPECT_TRUE(p) << "Unable to get kd parameter.";
+    Vector kd(8); kd.setZero();
+    EXPECT_TRUE(p->set(kd));
+
+    // Set parameter maxVelocity to be zeros
+    p = task.lookupParameter("maxVelocity");
+    EXPECT_TRUE(p) << "Unable to get kd parameter.";
+    Vector maxVel(8); maxVel.setZero();
+    EXPECT_TRUE(p->set(maxVel));
+  }
+
   std::shared_ptr<controlit::RobotState> robotState;
   std::unique_ptr<controlit::ControlModel> myModel;
   controlit::Parameter * p; // A pointer to a parameter
@@ -61,59 +123,7 @@ TEST_F(JointLimitTaskTest, BasicTest)
   ASSERT_EQ(NactuatedJoints, 2) << "Incorrect number of actuated joints: Got "
     << NactuatedJoints << " expected 2";
 
-  // Set the parameter upperStopRad to be all zeros
-  p = task->lookupParameter("upperStopRad");
-  EXPECT_TRUE(p) << "Unable to get upperStopRad parameter.";
-  Vector upperStopRad(8); upperStopRad.setZero();
-  EXPECT_TRUE(p->set(upperStopRad));
-
-  // Set the parameter upperTriggerRad to be a tolerance higher than the
-  // upperStopRad parameter.  In this case, we set it to be:
-  // <1e12, 1e12,  1e12, 1e12, 1e12, 1e12, 0.1, 0.1>
-  p = task->lookupParameter("upperTriggerRad");
-  EXPECT_TRUE(p) << "Unable to get upperTriggerRad parameter.";
-  Vector upperTriggerRad(8); upperTriggerRad.setZero();
-  upperTriggerRad(6) = 0.1; upperTriggerRad(7) = 0.1;
-  for(int i = 0; i < 6; i++)
-    upperTriggerRad(i) = 1e12;
-  EXPECT_TRUE(p->set(upperTriggerRad));
-
-  // Set the parameter lowerStopRad to be:
-  // <0, 0, 0, 0, 0, 0, -0.2, -0.2>
-  p = task->lookupParameter("lowerStopRad");
-  EXPECT_TRUE(p) << "Unable to get lowerStopRad parameter.";
-  Vector lowerStopRad(8); lowerStopRad.setZero();
-  lowerStopRad(6) = -0.2; lowerStopRad(7) = -0.2;
-  EXPECT_TRUE(p->set(lowerStopRad));
-
-  // Set the parameter lowerTriggerRad to be  a tolerance lower than the
-  // lowerStopRad parameter.  In this case, we set it to be:
-  // <-1e12, -1e12,  -1e12, -1e12, -1e12, -1e12, -0.3, -0.3>
-  p = task->lookupParameter("lowerTriggerRad");
-  EXPECT_TRUE(p) << "Unable to get lowerTriggerRad parameter.";
-  Vector lowerTriggerRad(8); lowerTriggerRad.setZero();
-  lowerTriggerRad(6) = -0.3; lowerTriggerRad(7) = -0.3;
-  for(int i = 0; i < 6; i++)
-    lowerTriggerRad(i) = -1e12;
-  EXPECT_TRUE(p->set(lowerTriggerRad));
-
-  // Set parameter kp to be ones
-  p = task->lookupParameter("kp");
-  EXPECT_TRUE(p) << "Unable to get kp parameter.";
-  Vector kp(8); kp.setOnes();
-  EXPECT_TRUE(p->set(kp));
-
-  // Set parameter kd to be zeros
-  p = task->lookupParameter("kd");
-  EXPECT_TRUE(p) << "Unable to get kd parameter.";
-  Vector kd(8); kd.setZero();
-  EXPECT_TRUE(p->set(kd));
-
-  // Set parameter maxVelocity to be zeros
-  p = task->lookupParameter("maxVelocity");
-  EXPECT_TRUE(p) << "Unable to get kd parameter.";
-  Vector maxVel(8); maxVel.setZero();
-  EXPECT_TRUE(p->set(maxVel));
+  setLimitsAndGains(*task);
 
   // Initialize the robot model
   EXPECT_TRUE(task->init(*myModel));
@@ -185,5 +195,44 @@ TEST_F(JointLimitTaskTest, BasicTest)
   EXPECT_TRUE(command.type == CommandType::ACCELERATION);
 }
 
+TEST_F(JointLimitTaskTest, TogglingLimitDoesNotAllocate)
+{
+  std::unique_ptr<controlit::Task> task(new controlit::task_library::JointLimitTask);
+  setLimitsAndGains(*task);
+  EXPECT_TRUE(task->init(*myModel));
+
+  myModel->updateJointState();
+  myModel->update();
+
+  // Warm up the thread's scratch arena
+  TaskCommand command;
+  EXPECT_TRUE(task->getCommand(*myModel, command));
+  EXPECT_EQ(command.command.size(), 0);
+
+  // Move the last joint beyond its lower trigger and back.  The command of
+  // the active limit is kp times the distance to the stop.
+  double positions[] = {-0.4, 0, -0.35, 0};
+  int expectedSizes[] = {1, 0, 1, 0};
+
+  for (int ii = 0; ii < 4; ii++)
+  {
+    robotState->setJointPosition(1, positions[ii]);
+    myModel->updateJointState();
+    myModel->update();
+
+    for (int cycle = 0; cycle < 2; cycle++)
+    {
+      controlit::ScratchArena::getThreadArena().reset();
+
+      controlit::NoAllocationScope noAllocation;
+      EXPECT_TRUE(task->getCommand(*myModel, command));
+    }
+
+    ASSERT_EQ(command.command.size(), expectedSizes[ii]) << "at position " << positions[ii];
+    if (expectedSizes[ii] > 0)
+      EXPECT_NEAR(command.command[0], -0.2 - positions[ii], 1e-10);
+  }
+}
+
 } // namespace task_library
 } // namespace controlit
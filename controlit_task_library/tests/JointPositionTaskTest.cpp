@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <gtest/gtest.h>
+#include <rbdl/rbdl.h>
+
+#include <controlit/ControlModel.hpp>
+#include <controlit/ConstraintSet.hpp>
+#include <controlit/task_library/JointPositionTask.hpp>
+#include <controlit/ControlModelLibrary.hpp>
+#include <controlit/RobotState.hpp>
+
+namespace controlit {
+namespace task_library {
+
+class JointPositionTaskTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    ros::Time::init();
+    robotState.reset(new controlit::RobotState());
+    controlit::ControlModel * controlModel = controlit::ControlModelLibrary::getLegAndFootModel(robotState);
+    myModel.reset(controlModel);
+  }
+
+  virtual void TearDown()
+  {
+    myModel.reset();
+  }
+
+  /*!
+   * Sets every goal and gain of the task to a zero vector with one element
+   * per real DOF.
+   */
+  void setGoalsAndGains(controlit::Task & task)
+  {
+    Vector zero(myModel->getNumRealDOFs()); zero.setZero();
+
+    const char * names[] = {"goalPosition", "goalVelocity", "goalAcceleration", "kp", "kd"};
+    for (size_t ii = 0; ii < sizeof(names) / sizeof(names[0]); ii++)
+    {
+      p = task.lookupParameter(names[ii]);
+      ASSERT_TRUE(p) << "Unable to get " << names[ii] << " parameter.";
+      EXPECT_TRUE(p->set(zero));
+    }
+  }
+
+  std::shared_ptr<controlit::RobotState> robotState;
+  std::unique_ptr<controlit::ControlModel> myModel;
+  controlit::Parameter * p; // A pointer to a parameter
+};
+
+TEST_F(JointPositionTaskTest, JacobianVersionTest)
+{
+  std::unique_ptr<controlit::Task> task(new controlit::task_library::JointPositionTask);
+
+  setGoalsAndGains(*task);
+
+  EXPECT_TRUE(task->init(*myModel)) << "Problems initializing task";
+
+  unsigned long long initialVersion = task->getJacobianVersion();
+  EXPECT_NE(initialVersion, 0u) << "Initialized task should have a non-zero Jacobian version";
+
+  // The model did not change so neither should the Jacobian or its version
+  task->updateState(myModel.get());
+  EXPECT_TRUE(task->checkUpdatedState());
+  EXPECT_EQ(initialVersion, task->getJacobianVersion());
+
+  // The view should refer to the same Jacobian that getJacobian copies
+  Matrix Jtask;
+  task->getJacobian(Jtask);
+  EXPECT_TRUE(Jtask == task->getJacobianView());
+  EXPECT_EQ(Jtask.rows(), task->getJacobianRows());
+}
+
+} // namespace task_library
+} // namespace controlit
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <chrono>
+#include <iostream>
+
+#include <gtest/gtest.h>
+
+#include <controlit/addons/eigen/SpatialKernels.hpp>
+
+/*!
+ * Checks that the spatial kernels produce the same task Jacobians as the
+ * generic Eigen expressions they replaced, and reports the time per call
+ * of each for the Jacobian assembly done by each task type.
+ */
+
+using Eigen::Matrix3d;
+using Eigen::Vector3d;
+using Eigen::MatrixXd;
+
+using controlit::addons::eigen::skewMatrix;
+using controlit::addons::eigen::rotateProjectRotate;
+using controlit::addons::eigen::multiply3xN;
+using controlit::addons::eigen::multiplyAdd3xN;
+using controlit::addons::eigen::skewMultiply3xN;
+using controlit::addons::eigen::skewMultiplyAdd3xN;
+
+namespace {
+
+// Roughly the number of DOFs of a humanoid including the virtual DOFs.
+const int NUM_DOFS = 38;
+const int NUM_ITERATIONS = 20000;
+const double TOLERANCE = 1e-12;
+
+Matrix3d randomRotation()
+{
+    return Eigen::Quaterniond(Eigen::Vector4d::Random().normalized()).toRotationMatrix();
+}
+
+/*!
+ * Returns the average time in microseconds of calling fn.
+ */
+template<typename Function>
+double timeIt(Function fn)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (int ii = 0; ii < NUM_ITERATIONS; ii++)
+        fn();
+    std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / NUM_ITERATIONS;
+}
+
+void report(const std::string & taskType, double eigenTime, double kernelTime)
+{
+    std::cout << "  " << taskType << ": Eigen " << eigenTime << " us, kernels "
+              << kernelTime << " us, speedup " << eigenTime / kernelTime << "x" << std::endl;
+}
+
+} // namespace
+
+TEST(SpatialKernelsBenchmark, CartesianPositionTask)
+{
+    MatrixXd JvBody = MatrixXd::Random(3, NUM_DOFS), JwBody = MatrixXd::Random(3, NUM_DOFS);
+    MatrixXd JvFrame = MatrixXd::Random(3, NUM_DOFS), JwFrame = MatrixXd::Random(3, NUM_DOFS);
+    MatrixXd projection = Vector3d(1, 1, 0).asDiagonal();
+    Matrix3d frameRotation = randomRotation();
+    Vector3d controlPointWorld = Vector3d::Random(), beta = Vector3d::Random(), goal = Vector3d::Random();
+
+    MatrixXd expected(3, NUM_DOFS), actual(3, NUM_DOFS);
+
+    auto eigenVersion = [&]()
+    {
+        expected = frameRotation.transpose() * projection * frameRotation * (-skewMatrix(controlPointWorld) * JwBody + JvBody - JvFrame);
+        Vector3d alpha = frameRotation.transpose() * projection * frameRotation * beta;
+        expected += (-skewMatrix(alpha)
+               + frameRotation.transpose() * projection * frameRotation * skewMatrix(beta)
+               + skewMatrix(frameRotation.transpose() * projection * goal)) * JwFrame;
+        expected -= JvFrame;
+    };
+
+    auto kernelVersion = [&]()
+    {
+        Matrix3d P = projection;
+        Matrix3d A = rotateProjectRotate(frameRotation, P);
+        Vector3d alpha = A * beta;
+        Vector3d projectedGoal = frameRotation.transpose() * (P * goal);
+        multiply3xN(-A * skewMatrix(controlPointWorld), JwBody, actual);
+        multiplyAdd3xN(A, JvBody, actual);
+        multiplyAdd3xN(-skewMatrix(alpha) + A * skewMatrix(beta) + skewMatrix(projectedGoal), JwFrame, actual);
+        multiplyAdd3xN(-A - Matrix3d::Identity(), JvFrame, actual);
+    };
+
+    eigenVersion();
+    kernelVersion();
+    EXPECT_TRUE(actual.isApprox(expected, TOLERANCE)) << "expected:\n" << expected << "\nactual:\n" << actual;
+
+    report("CartesianPositionTask", timeIt(eigenVersion), timeIt(kernelVersion));
+}
+
+TEST(SpatialKernelsBenchmark, COMTask)
+{
+    MatrixXd Jcom = MatrixXd::Random(3, NUM_DOFS);
+    MatrixXd JvFrame = MatrixXd::Random(3, NUM_DOFS), JwFrame = MatrixXd::Random(3, NUM_DOFS);
+    MatrixXd projection = Vector3d(1, 1, 0).asDiagonal();
+    MatrixXd RFrame = randomRotation();
+    Vector3d comPos = Vector3d::Random(), TFrame = Vector3d::Random(), goal = Vector3d::Random();
+
+    MatrixXd expected(3, NUM_DOFS), actual(3, NUM_DOFS);
+
+    auto eigenVersion = [&]()
+    {
+        Vector3d ProjectedGoal = RFrame.transpose() * projection * goal;
+        Vector3d ProjectedCOM = RFrame.transpose() * projection * RFrame * comPos;
+        Vector3d ProjectedTFrame = RFrame.transpose() * projection * RFrame * TFrame;
+        expected = skewMatrix(ProjectedCOM - ProjectedTFrame) * JwFrame;
+        expected -= RFrame.transpose() * projection * RFrame * skewMatrix(goal - TFrame) * JwFrame;
+        expected += RFrame.transpose() * projection * RFrame * (Jcom - JvFrame);
+        expected -= skewMatrix(ProjectedGoal) * JwFrame;
+        expected += JvFrame;
+    };
+
+    auto kernelVersion = [&]()
+    {
+        Matrix3d P = projection;
+        Matrix3d R = RFrame;
+        Matrix3d A = rotateProjectRotate(R, P);
+        Vector3d ProjectedGoal = R.transpose() * (P * goal);
+        Vector3d ProjectedCOM = A * comPos;
+        Vector3d ProjectedTFrame = A * TFrame;
+        multiply3xN(skewMatrix(ProjectedCOM - ProjectedTFrame)
+            - A * skewMatrix(goal - TFrame)
+            - skewMatrix(ProjectedGoal), JwFrame, actual);
+        multiplyAdd3xN(A, Jcom, actual);
+        multiplyAdd3xN(Matrix3d::Identity() - A, JvFrame, actual);
+    };
+
+    eigenVersion();
+    kernelVersion();
+    EXPECT_TRUE(actual.isApprox(expected, TOLERANCE)) << "expected:\n" << expected << "\nactual:\n" << actual;
+
+    report("COMTask", timeIt(eigenVersion), timeIt(kernelVersion));
+}
+
+TEST(SpatialKernelsBenchmark, OrientQuaternionTask)
+{
+    MatrixXd JwBody = MatrixXd::Random(3, NUM_DOFS), JwFrame = MatrixXd::Random(3, NUM_DOFS);
+    Matrix3d curRot = randomRotation(), desRot = randomRotation();
+
+    MatrixXd expected(9, NUM_DOFS), actual(9, NUM_DOFS);
+    MatrixXd Je1(3, NUM_DOFS), Je2(3, NUM_DOFS), Je3(3, NUM_DOFS);
+
+    auto eigenVersion = [&]()
+    {
+        Je1 = -skewMatrix(curRot.col(0)) * JwBody;
+        Je2 = -skewMatrix(curRot.col(1)) * JwBody;
+        Je3 = -skewMatrix(curRot.col(2)) * JwBody;
+        Je1 += skewMatrix(desRot.col(0)) * JwFrame;
+        Je2 += skewMatrix(desRot.col(1)) * JwFrame;
+        Je3 += skewMatrix(desRot.col(2)) * JwFrame;
+        expected.block(0, 0, 3, NUM_DOFS) = Je1;
+        expected.block(3, 0, 3, NUM_DOFS) = Je2;
+        expected.block(6, 0, 3, NUM_DOFS) = Je3;
+    };
+
+    auto kernelVersion = [&]()
+    {
+        for (int ii = 0; ii < 3; ii++)
+        {
+            skewMultiply3xN(-curRot.col(ii), JwBody, actual.block(3 * ii, 0, 3, NUM_DOFS));
+            skewMultiplyAdd3xN(desRot.col(ii), JwFrame, actual.block(3 * ii, 0, 3, NUM_DOFS));
+        }
+    };
+
+    eigenVersion();
+    kernelVersion();
+    EXPECT_TRUE(actual.isApprox(expected, TOLERANCE)) << "expected:\n" << expected << "\nactual:\n" << actual;
+
+    report("OrientQuaternionTask", timeIt(eigenVersion), timeIt(kernelVersion));
+}
+
+TEST(SpatialKernelsBenchmark, OrientVectorToVectorTask)
+{
+    MatrixXd JwBody = MatrixXd::Random(3, NUM_DOFS), JwFrame = MatrixXd::Random(3, NUM_DOFS);
+    Vector3d RTeBody = Vector3d::Random(), goal = Vector3d::Random();
+
+    MatrixXd expected(3, NUM_DOFS), actual(3, NUM_DOFS);
+
+    auto eigenVersion = [&]()
+    {
+        expected = -skewMatrix(RTeBody) * JwBody;
+        expected += skewMatrix(goal) * JwFrame;
+    };
+
+    auto kernelVersion = [&]()
+    {
+        skewMultiply3xN(-RTeBody, JwBody, actual);
+        skewMultiplyAdd3xN(goal, JwFrame, actual);
+    };
+
+    eigenVersion();
+    kernelVersion();
+    EXPECT_TRUE(actual.isApprox(expected, TOLERANCE)) << "expected:\n" << expected << "\nactual:\n" << actual;
+
+    report("OrientVectorToVectorTask", timeIt(eigenVersion), timeIt(kernelVersion));
+}
+
+TEST(SpatialKernelsBenchmark, OddSizesAndStrides)
+{
+    // Exercise the head and tail handling of the vectorized kernel.
+    for (int numCols = 1; numCols < 16; numCols++)
+    {
+        Matrix3d M = Matrix3d::Random();
+        MatrixXd J = MatrixXd::Random(3, numCols);
+        MatrixXd initial = MatrixXd::Random(3, numCols);
+
+        MatrixXd result = initial;
+        multiplyAdd3xN(M, J, result);
+        EXPECT_TRUE(result.isApprox(initial + M * J, TOLERANCE)) << "numCols = " << numCols;
+
+        MatrixXd stacked = MatrixXd::Zero(9, numCols);
+        multiply3xN(M, J, stacked.block(3, 0, 3, numCols));
+        EXPECT_TRUE(stacked.block(3, 0, 3, numCols).isApprox(M * J, TOLERANCE)) << "numCols = " << numCols;
+        EXPECT_EQ(0, stacked.topRows(3).norm());
+        EXPECT_EQ(0, stacked.bottomRows(3).norm());
+    }
+}
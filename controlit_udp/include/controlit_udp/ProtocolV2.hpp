@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __TX_RX_UDP_PROTOCOL_V2_HPP__
+#define __TX_RX_UDP_PROTOCOL_V2_HPP__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Version 2 of the UDP protocol.  Unlike StateMsg and CommandMsg, a packet
+// may have any number of DOFs and may carry several samples, e.g., all of
+// the states measured since the last packet was sent.
+//
+// A packet consists of a PacketHeaderV2 followed by num_samples samples.
+// Each sample consists of a SampleHeaderV2 followed by num_dofs positions,
+// num_dofs velocities, and num_dofs efforts.  All fields are in host byte
+// order, as in version 1.
+
+#define PROTOCOL_V2_MAGIC               0x32504455 // "UDP2"
+#define PROTOCOL_V2_VERSION             2
+
+#define PROTOCOL_V2_TYPE_STATE          1
+#define PROTOCOL_V2_TYPE_COMMAND        2
+
+// Keep packets within a single datagram that does not need to be fragmented
+// on a network with jumbo frames.
+#define PROTOCOL_V2_MAX_PACKET_SIZE     8972
+
+namespace controlit_udp {
+
+typedef struct
+{
+	uint32_t    magic;
+	uint16_t    version;
+	uint16_t    type;
+	uint32_t    num_dofs;
+	uint32_t    num_samples;
+	// Incremented by the sender for every packet.  Used to detect lost
+	// and reordered packets.
+	uint32_t    packet_seqno;
+	uint32_t    reserved;
+	// CLOCK_REALTIME of the sender when the packet was sent.
+	uint64_t    send_time_ns;
+} PacketHeaderV2;
+
+typedef struct
+{
+	// CLOCK_REALTIME of the sender when the sample was taken.
+	uint64_t    sample_time_ns;
+	// Reflected by the robot to measure the round trip latency, see
+	// StateMsg::seqno and CommandMsg::seqno.
+	int32_t     seqno;
+	uint32_t    reserved;
+} SampleHeaderV2;
+
+static_assert(sizeof(PacketHeaderV2) == 32, "PacketHeaderV2 must not contain padding");
+static_assert(sizeof(SampleHeaderV2) == 16, "SampleHeaderV2 must not contain padding");
+
+inline size_t getSampleSizeV2(uint32_t numDOFs)
+{
+	return sizeof(SampleHeaderV2) + 3 * numDOFs * sizeof(double);
+}
+
+inline size_t getPacketSizeV2(uint32_t numDOFs, uint32_t numSamples)
+{
+	return sizeof(PacketHeaderV2) + numSamples * getSampleSizeV2(numDOFs);
+}
+
+// Provides access to the samples within a packet.
+class PacketV2
+{
+public:
+	PacketV2() : data(NULL) {}
+	explicit PacketV2(uint8_t * data) : data(data) {}
+
+	// Whether this refers to a packet.
+	bool isValid() const { return data != NULL; }
+
+	PacketHeaderV2 * header() const { return reinterpret_cast<PacketHeaderV2 *>(data); }
+
+	uint32_t getNumDOFs() const { return header()->num_dofs; }
+	uint32_t getNumSamples() const { return header()->num_samples; }
+
+	SampleHeaderV2 * sample(uint32_t index) const
+	{
+		return reinterpret_cast<SampleHeaderV2 *>(data + sizeof(PacketHeaderV2)
+			+ index * getSampleSizeV2(getNumDOFs()));
+	}
+
+	double * position(uint32_t index) const { return reinterpret_cast<double *>(sample(index) + 1); }
+	double * velocity(uint32_t index) const { return position(index) + getNumDOFs(); }
+	double * effort(uint32_t index) const { return position(index) + 2 * getNumDOFs(); }
+
+	// Returns the index of the most recent sample.
+	uint32_t latest() const { return getNumSamples() - 1; }
+
+	uint8_t * getData() const { return data; }
+
+private:
+	uint8_t * data;
+};
+
+} //namespace controlit_udp
+
+#endif //__TX_RX_UDP_PROTOCOL_V2_HPP__
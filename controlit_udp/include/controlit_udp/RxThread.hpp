@@ -33,6 +33,9 @@ namespace controlit_udp {
 		RxThread(){}
 		virtual ~RxThread(){}
 
+		//Returns the receive thread.  Only valid once the thread is started.
+		pthread_t GetRxThread() const { return t_; }
+
 	protected:
 		bool StartRxThread()
 		{
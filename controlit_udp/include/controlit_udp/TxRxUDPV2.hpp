@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#ifndef __TX_RX_UDP_V2_HPP__
+#define __TX_RX_UDP_V2_HPP__
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+#include <controlit_udp/RxThread.hpp>
+#include <controlit_udp/ProtocolV2.hpp>
+#include <controlit_udp/TxRxDataTypes.hpp>
+
+namespace controlit_udp {
+
+	// Sends and receives version 2 packets.  The controller receives states and
+	// sends commands, while the robot does the opposite.
+	//
+	// The receive thread blocks in epoll_wait until datagrams arrive, drains
+	// them with recvmmsg, and publishes the newest valid packet in a lock-free
+	// triple buffer.  Thus the reader always sees a complete packet, never
+	// waits for the receive thread, and never burns a core while idle.
+	class TxRxUDPV2 : public RxThread
+	{
+	public:
+
+		// Statistics about the received packets.
+		struct RxStatistics
+		{
+			uint64_t received;    // valid packets received
+			uint64_t lost;        // gaps in the packet sequence numbers
+			uint64_t reordered;   // packets older than one already received
+			uint64_t invalid;     // malformed packets and packets of the wrong type or size
+			uint64_t superseded;  // valid packets replaced by a newer one before they were read
+			uint64_t restarts;    // times the sender restarted its sequence numbers
+		};
+
+		TxRxUDPV2();
+		virtual ~TxRxUDPV2();
+
+		// rxType and txType are PROTOCOL_V2_TYPE_STATE or PROTOCOL_V2_TYPE_COMMAND.
+		// maxSamplesPerPacket limits both the received and the sent packets.
+		virtual bool init(uint16_t rxType,
+						  uint16_t txType,
+						  uint32_t numDOFs,
+						  uint32_t rxPort,
+						  uint32_t txPort,
+						  std::string address = DEFAULT_INET_ADDR,
+						  uint32_t maxSamplesPerPacket = 1);
+
+		// Sets a function that the receive thread calls each time it publishes
+		// a new packet, e.g., to wake up the thread that reads it.  It must be
+		// set before init(...) is called and must not block.
+		void setReceiveCallback(void (*callback)(void *), void * arg);
+
+		// Stops the receive thread.  This is called by the destructor.
+		void stop();
+
+		// Adds a sample to the next packet to be sent.  Any of the arrays may be
+		// NULL, in which case zeros are sent.  The packet is sent once it holds
+		// maxSamplesPerPacket samples.  Returns false if sending failed.
+		bool queueSample(int32_t seqno, const double * position,
+						 const double * velocity, const double * effort);
+
+		// Sends the queued samples, if any.  Returns false if sending failed.
+		bool flush();
+
+		// Returns the newest packet received, or an invalid PacketV2 if none was
+		// received yet.  The packet remains valid until the next call.  isNew
+		// indicates whether the packet was received since the previous call.
+		PacketV2 readLatest(bool & isNew);
+
+		// Returns the CLOCK_REALTIME at which the packet last returned by
+		// readLatest(...) was received.
+		uint64_t getReceiveTime() const;
+
+		RxStatistics getRxStatistics() const;
+
+		uint32_t getNumDOFs() const { return numDOFs; }
+
+		// Returns the current CLOCK_REALTIME in nanoseconds.
+		static uint64_t now();
+
+	protected:
+		// Code to be executed by thread goes here (i.e., revcfrom)
+		virtual void RxThreadEnterLoop();
+
+	private:
+		// Checks whether a received datagram is a valid packet.
+		bool isValid(const uint8_t * data, size_t size) const;
+
+		// Slots of the triple buffer.
+		struct Slot
+		{
+			std::vector<uint64_t> data;  // uint64_t for alignment
+			uint64_t receiveTime;
+		};
+
+		static const int NUM_SLOTS = 3;
+		static const uint8_t FRESH = 0x4;
+		static const int RX_BATCH_SIZE = 16;
+
+		// A packet more than this many sequence numbers older than the newest
+		// one received is not a reordered packet but the first packet of a
+		// sender that restarted.
+		static const int32_t RX_REORDER_WINDOW = 64;
+
+		uint16_t rxType;
+		uint16_t txType;
+		uint32_t numDOFs;
+		uint32_t maxSamplesPerPacket;
+
+		int s_recv_socket;
+		int s_send_socket;
+		int epollFd;
+		int stopFd;
+		bool rxThreadStarted;
+
+		// Called after a packet is published
+		void (*receiveCallback)(void *);
+		void * receiveCallbackArg;
+
+		sockaddr_in si_me;
+		sockaddr_in si_to;
+
+		// The triple buffer.  The receive thread owns slots[back], the reader
+		// owns slots[front], and middle holds the index of the third slot and
+		// whether it holds a packet the reader has not seen.
+		Slot slots[NUM_SLOTS];
+		std::atomic<uint8_t> middle;
+		uint8_t back;
+		uint8_t front;
+		bool received;
+
+		// Scratch space for recvmmsg.
+		std::vector<std::vector<uint64_t>> rxBuffers;
+
+		// The packet being assembled for sending.
+		std::vector<uint64_t> txBuffer;
+		PacketV2 txPacket;
+		uint32_t txSeqno;
+
+		bool rxSeqnoValid;
+		uint32_t lastRxSeqno;
+
+		std::atomic<uint64_t> numReceived;
+		std::atomic<uint64_t> numLost;
+		std::atomic<uint64_t> numReordered;
+		std::atomic<uint64_t> numInvalid;
+		std::atomic<uint64_t> numSuperseded;
+		std::atomic<uint64_t> numRestarts;
+	};
+
+}  //namespace controlit_udp
+#endif //__TX_RX_UDP_V2_HPP__
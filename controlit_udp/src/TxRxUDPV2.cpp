@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+#include <stdio.h>
+#include <string.h>  // for memset
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+#include "controlit_udp/TxRxUDPV2.hpp"
+
+using namespace controlit_udp;
+
+TxRxUDPV2::TxRxUDPV2() :
+    RxThread(),
+    rxType(0), txType(0), numDOFs(0), maxSamplesPerPacket(1),
+    s_recv_socket(-1), s_send_socket(-1), epollFd(-1), stopFd(-1), rxThreadStarted(false),
+    receiveCallback(NULL), receiveCallbackArg(NULL),
+    middle(1), back(2), front(0), received(false),
+    txSeqno(0), rxSeqnoValid(false), lastRxSeqno(0),
+    numReceived(0), numLost(0), numReordered(0), numInvalid(0), numSuperseded(0), numRestarts(0)
+{
+    memset((char *) &si_me, 0, sizeof(si_me));
+    memset((char *) &si_to, 0, sizeof(si_to));
+}
+
+TxRxUDPV2::~TxRxUDPV2()
+{
+    stop();
+
+    if (s_recv_socket != -1) close(s_recv_socket);
+    if (s_send_socket != -1) close(s_send_socket);
+    if (epollFd != -1) close(epollFd);
+    if (stopFd != -1) close(stopFd);
+}
+
+bool TxRxUDPV2::init(uint16_t rxType,
+                     uint16_t txType,
+                     uint32_t numDOFs,
+                     uint32_t rxPort,
+                     uint32_t txPort,
+                     std::string address,
+                     uint32_t maxSamplesPerPacket)
+{
+    if (maxSamplesPerPacket == 0 || getPacketSizeV2(numDOFs, maxSamplesPerPacket) > PROTOCOL_V2_MAX_PACKET_SIZE)
+    {
+        fprintf(stderr, "A packet with %u samples of %u DOFs does not fit in a datagram\n",
+            maxSamplesPerPacket, numDOFs);
+        return false;
+    }
+
+    this->rxType = rxType;
+    this->txType = txType;
+    this->numDOFs = numDOFs;
+    this->maxSamplesPerPacket = maxSamplesPerPacket;
+
+    // Allocate all buffers up front
+    size_t maxPacketWords = (getPacketSizeV2(numDOFs, maxSamplesPerPacket) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    for (int ii = 0; ii < NUM_SLOTS; ii++)
+    {
+        slots[ii].data.assign(maxPacketWords, 0);
+        slots[ii].receiveTime = 0;
+    }
+
+    // One extra word so that oversized datagrams are detected rather than truncated
+    rxBuffers.assign(RX_BATCH_SIZE, std::vector<uint64_t>(maxPacketWords + 1, 0));
+
+    txBuffer.assign(maxPacketWords, 0);
+    txPacket = PacketV2(reinterpret_cast<uint8_t *>(txBuffer.data()));
+    txPacket.header()->magic = PROTOCOL_V2_MAGIC;
+    txPacket.header()->version = PROTOCOL_V2_VERSION;
+    txPacket.header()->type = txType;
+    txPacket.header()->num_dofs = numDOFs;
+    txPacket.header()->num_samples = 0;
+
+    if((s_recv_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == -1)
+    {
+        fprintf(stderr, "Failed to initialize socket to receive packets \n");
+        return false;
+    }
+
+    if((s_send_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == -1)
+    {
+        fprintf(stderr, "Failed to initialize socket to send packets \n");
+        return false;
+    }
+
+    si_to.sin_family = AF_INET;
+    si_to.sin_port = htons(txPort);
+    si_to.sin_addr.s_addr = inet_addr(address.c_str());
+
+    si_me.sin_family = AF_INET;
+    si_me.sin_port = htons(rxPort);
+    si_me.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (bind(s_recv_socket, (struct sockaddr * ) & si_me, sizeof(si_me)) == -1)
+    {
+        fprintf(stderr, "Failed to bind to port %u: %s\n", rxPort, strerror(errno));
+        return false;
+    }
+
+    // The receive thread waits for either a datagram or a request to stop
+    epollFd = epoll_create1(0);
+    stopFd = eventfd(0, 0);
+
+    if (epollFd == -1 || stopFd == -1)
+    {
+        fprintf(stderr, "Failed to create the receive thread's event descriptors: %s\n", strerror(errno));
+        return false;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+
+    event.data.fd = s_recv_socket;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, s_recv_socket, &event) == -1)
+        return false;
+
+    event.data.fd = stopFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, stopFd, &event) == -1)
+        return false;
+
+    rxThreadStarted = StartRxThread();
+    return rxThreadStarted;
+}
+
+void TxRxUDPV2::stop()
+{
+    if (!rxThreadStarted) return;
+
+    uint64_t one = 1;
+    if (write(stopFd, &one, sizeof(one)) == sizeof(one))
+        WaitForRxThreadExit();
+
+    rxThreadStarted = false;
+}
+
+uint64_t TxRxUDPV2::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+bool TxRxUDPV2::isValid(const uint8_t * data, size_t size) const
+{
+    if (size < sizeof(PacketHeaderV2)) return false;
+
+    const PacketHeaderV2 * header = reinterpret_cast<const PacketHeaderV2 *>(data);
+
+    return header->magic == PROTOCOL_V2_MAGIC
+        && header->version == PROTOCOL_V2_VERSION
+        && header->type == rxType
+        && header->num_dofs == numDOFs
+        && header->num_samples > 0
+        && header->num_samples <= maxSamplesPerPacket
+        && size == getPacketSizeV2(numDOFs, header->num_samples);
+}
+
+void TxRxUDPV2::RxThreadEnterLoop()
+{
+    struct mmsghdr msgs[RX_BATCH_SIZE];
+    struct iovec iovecs[RX_BATCH_SIZE];
+
+    for (int ii = 0; ii < RX_BATCH_SIZE; ii++)
+    {
+        iovecs[ii].iov_base = rxBuffers[ii].data();
+        iovecs[ii].iov_len = rxBuffers[ii].size() * sizeof(uint64_t);
+    }
+
+    while(1)
+    {
+        struct epoll_event events[2];
+        int numEvents = epoll_wait(epollFd, events, 2, -1);
+
+        if (numEvents == -1)
+        {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "epoll_wait failed: %s\n", strerror(errno));
+            return;
+        }
+
+        for (int ii = 0; ii < numEvents; ii++)
+            if (events[ii].data.fd == stopFd) return;
+
+        // Drain all of the datagrams that are waiting
+        while(1)
+        {
+            memset(msgs, 0, sizeof(msgs));
+            for (int ii = 0; ii < RX_BATCH_SIZE; ii++)
+            {
+                msgs[ii].msg_hdr.msg_iov = &iovecs[ii];
+                msgs[ii].msg_hdr.msg_iovlen = 1;
+            }
+
+            int numMsgs = recvmmsg(s_recv_socket, msgs, RX_BATCH_SIZE, MSG_DONTWAIT, NULL);
+            if (numMsgs <= 0) break;
+
+            uint64_t receiveTime = now();
+
+            // Find the newest valid packet
+            int newest = -1;
+            for (int ii = 0; ii < numMsgs; ii++)
+            {
+                const uint8_t * data = reinterpret_cast<const uint8_t *>(rxBuffers[ii].data());
+
+                if (!isValid(data, msgs[ii].msg_len) || (msgs[ii].msg_hdr.msg_flags & MSG_TRUNC))
+                {
+                    numInvalid++;
+                    continue;
+                }
+
+                uint32_t seqno = reinterpret_cast<const PacketHeaderV2 *>(data)->packet_seqno;
+
+                if (rxSeqnoValid)
+                {
+                    int32_t gap = static_cast<int32_t>(seqno - lastRxSeqno);
+
+                    if (gap < -RX_REORDER_WINDOW)
+                    {
+                        // The sender restarted, so resynchronize to it
+                        numRestarts++;
+                    }
+                    else if (gap <= 0)
+                    {
+                        numReordered++;
+                        continue;
+                    }
+                    else
+                    {
+                        numLost += gap - 1;
+                    }
+                }
+
+                rxSeqnoValid = true;
+                lastRxSeqno = seqno;
+                numReceived++;
+
+                if (newest != -1) numSuperseded++;
+                newest = ii;
+            }
+
+            if (newest == -1) continue;
+
+            // Publish it
+            memcpy(slots[back].data.data(), rxBuffers[newest].data(), msgs[newest].msg_len);
+            slots[back].receiveTime = receiveTime;
+
+            uint8_t previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+            if (previous & FRESH) numSuperseded++;
+            back = previous & ~FRESH;
+
+            if (receiveCallback != NULL) receiveCallback(receiveCallbackArg);
+
+            if (numMsgs < RX_BATCH_SIZE) break;
+        }
+    }
+}
+
+void TxRxUDPV2::setReceiveCallback(void (*callback)(void *), void * arg)
+{
+    receiveCallback = callback;
+    receiveCallbackArg = arg;
+}
+
+PacketV2 TxRxUDPV2::readLatest(bool & isNew)
+{
+    isNew = false;
+
+    if (middle.load(std::memory_order_relaxed) & FRESH)
+    {
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+        received = true;
+        isNew = true;
+    }
+
+    if (!received) return PacketV2();
+
+    return PacketV2(reinterpret_cast<uint8_t *>(slots[front].data.data()));
+}
+
+uint64_t TxRxUDPV2::getReceiveTime() const
+{
+    return slots[front].receiveTime;
+}
+
+TxRxUDPV2::RxStatistics TxRxUDPV2::getRxStatistics() const
+{
+    RxStatistics statistics;
+    statistics.received = numReceived;
+    statistics.lost = numLost;
+    statistics.reordered = numReordered;
+    statistics.invalid = numInvalid;
+    statistics.superseded = numSuperseded;
+    statistics.restarts = numRestarts;
+    return statistics;
+}
+
+bool TxRxUDPV2::queueSample(int32_t seqno, const double * position,
+                            const double * velocity, const double * effort)
+{
+    uint32_t index = txPacket.header()->num_samples++;
+
+    SampleHeaderV2 * sample = txPacket.sample(index);
+    sample->sample_time_ns = now();
+    sample->seqno = seqno;
+    sample->reserved = 0;
+
+    size_t arraySize = numDOFs * sizeof(double);
+
+    if (position) memcpy(txPacket.position(index), position, arraySize);
+    else memset(txPacket.position(index), 0, arraySize);
+
+    if (velocity) memcpy(txPacket.velocity(index), velocity, arraySize);
+    else memset(txPacket.velocity(index), 0, arraySize);
+
+    if (effort) memcpy(txPacket.effort(index), effort, arraySize);
+    else memset(txPacket.effort(index), 0, arraySize);
+
+    if (txPacket.getNumSamples() == maxSamplesPerPacket)
+        return flush();
+
+    return true;
+}
+
+bool TxRxUDPV2::flush()
+{
+    PacketHeaderV2 * header = txPacket.header();
+
+    if (header->num_samples == 0) return true;
+
+    header->packet_seqno = txSeqno++;
+    header->send_time_ns = now();
+
+    size_t size = getPacketSizeV2(numDOFs, header->num_samples);
+    ssize_t sent = sendto(s_send_socket, txPacket.getData(), size, 0, (struct sockaddr *) & si_to, sizeof(si_to));
+
+    header->num_samples = 0;
+
+    return sent == static_cast<ssize_t>(size);
+}
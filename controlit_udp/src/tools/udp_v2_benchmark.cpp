@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2015 The University of Texas at Austin and the
+ * Institute of Human Machine Cognition. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version. See
+ * <http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html>
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * Measures the latency and integrity of version 2 of the UDP protocol over
+ * loopback.  A simulated robot sends state packets to a simulated
+ * controller, which echoes a command for the newest state sample back.
+ *
+ * Every value of a sample is set to the sample's sequence number so that
+ * the controller can detect torn reads.  The latency is measured from the
+ * time at which the robot took a sample to the time at which the robot
+ * received the command that echoes it.  Finally, the robot restarts and
+ * the controller must resume receiving its states.
+ */
+
+#include <controlit_udp/TxRxUDPV2.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using controlit_udp::TxRxUDPV2;
+using controlit_udp::PacketV2;
+
+namespace {
+
+struct Options
+{
+    Options() :
+        numDOFs(40), samplesPerPacket(4), numPackets(20000),
+        periodUs(1000), port(35000) {}
+
+    uint32_t numDOFs;
+    uint32_t samplesPerPacket;
+    uint32_t numPackets;
+    uint32_t periodUs;  // 0 sends as fast as possible
+    uint32_t port;
+};
+
+void usage()
+{
+    printf("Usage: udp_v2_benchmark [--dofs N] [--samples N] [--packets N] [--period_us N] [--port N]\n"
+           "  --period_us 0 floods the socket instead of pacing the packets.\n");
+}
+
+bool parseOptions(int argc, char ** argv, Options & options)
+{
+    for (int ii = 1; ii < argc; ii += 2)
+    {
+        if (ii + 1 >= argc) return false;
+
+        std::string name = argv[ii];
+        uint32_t value = static_cast<uint32_t>(strtoul(argv[ii + 1], NULL, 10));
+
+        if (name == "--dofs") options.numDOFs = value;
+        else if (name == "--samples") options.samplesPerPacket = value;
+        else if (name == "--packets") options.numPackets = value;
+        else if (name == "--period_us") options.periodUs = value;
+        else if (name == "--port") options.port = value;
+        else return false;
+    }
+
+    return options.numDOFs > 0 && options.samplesPerPacket > 0 && options.numPackets > 0;
+}
+
+double percentile(std::vector<double> & values, double fraction)
+{
+    if (values.empty()) return 0;
+
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+} // namespace
+
+int main(int argc, char ** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        usage();
+        return 1;
+    }
+
+    uint32_t statePort = options.port;
+    uint32_t commandPort = options.port + 1;
+    uint32_t numSamples = options.numPackets * options.samplesPerPacket;
+
+    TxRxUDPV2 robot, controller;
+
+    if (!robot.init(PROTOCOL_V2_TYPE_COMMAND, PROTOCOL_V2_TYPE_STATE, options.numDOFs,
+            commandPort, statePort, "127.0.0.1", options.samplesPerPacket)
+        || !controller.init(PROTOCOL_V2_TYPE_STATE, PROTOCOL_V2_TYPE_COMMAND, options.numDOFs,
+            statePort, commandPort, "127.0.0.1", options.samplesPerPacket))
+    {
+        fprintf(stderr, "Failed to initialize the UDP endpoints\n");
+        return 1;
+    }
+
+    // The time at which each sample was taken, indexed by its sequence number.
+    std::vector<uint64_t> sampleTimes(numSamples, 0);
+    std::vector<double> latencies;
+    latencies.reserve(numSamples);
+
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> tornReads(0);
+
+    // The controller echoes the newest state sample as a command.
+    std::thread controllerThread([&]()
+    {
+        std::vector<double> effort(options.numDOFs);
+
+        while (!done)
+        {
+            bool isNew;
+            PacketV2 state = controller.readLatest(isNew);
+
+            if (!isNew)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (uint32_t sample = 0; sample < state.getNumSamples(); sample++)
+            {
+                double expected = state.sample(sample)->seqno;
+                for (uint32_t dof = 0; dof < options.numDOFs; dof++)
+                {
+                    if (state.position(sample)[dof] != expected || state.velocity(sample)[dof] != expected
+                        || state.effort(sample)[dof] != expected)
+                    {
+                        tornReads++;
+                        sample = state.getNumSamples() - 1;
+                        break;
+                    }
+                }
+            }
+
+            uint32_t latest = state.latest();
+            std::fill(effort.begin(), effort.end(), state.sample(latest)->seqno);
+            controller.queueSample(state.sample(latest)->seqno, NULL, NULL, effort.data());
+            controller.flush();
+        }
+    });
+
+    std::vector<double> values(options.numDOFs);
+    uint64_t lastCommandSeqno = 0;
+    bool commandReceived = false;
+
+    auto receiveCommand = [&]()
+    {
+        bool isNew;
+        PacketV2 command = robot.readLatest(isNew);
+        if (!isNew) return;
+
+        int32_t seqno = command.sample(command.latest())->seqno;
+        if (seqno < 0 || static_cast<uint32_t>(seqno) >= numSamples) return;
+
+        if (!commandReceived || static_cast<uint64_t>(seqno) > lastCommandSeqno)
+        {
+            latencies.push_back((robot.getReceiveTime() - sampleTimes[seqno]) / 1000.0);
+            lastCommandSeqno = seqno;
+            commandReceived = true;
+        }
+    };
+
+    for (uint32_t seqno = 0; seqno < numSamples; seqno++)
+    {
+        std::fill(values.begin(), values.end(), seqno);
+        sampleTimes[seqno] = TxRxUDPV2::now();
+        robot.queueSample(seqno, values.data(), values.data(), values.data());
+
+        // Pace the packets, not the samples within a packet.
+        if ((seqno + 1) % options.samplesPerPacket == 0)
+        {
+            receiveCommand();
+
+            if (options.periodUs > 0)
+            {
+                uint64_t deadline = sampleTimes[seqno] + options.periodUs * 1000ull;
+                while (TxRxUDPV2::now() < deadline)
+                    receiveCommand();
+            }
+        }
+    }
+
+    // Wait for the last commands to arrive.
+    uint64_t deadline = TxRxUDPV2::now() + 100000000ull;
+    while (TxRxUDPV2::now() < deadline)
+        receiveCommand();
+
+    done = true;
+    controllerThread.join();
+
+    // Restart the robot: a new sender starts its packet sequence numbers at
+    // zero again, and the controller must resume receiving its states.
+    bool resumedAfterRestart = false;
+    {
+        TxRxUDPV2 restartedRobot;
+        if (!restartedRobot.init(PROTOCOL_V2_TYPE_COMMAND, PROTOCOL_V2_TYPE_STATE, options.numDOFs,
+                options.port + 2, statePort, "127.0.0.1", 1))
+        {
+            fprintf(stderr, "Failed to initialize the restarted robot\n");
+            return 1;
+        }
+
+        std::fill(values.begin(), values.end(), numSamples);
+
+        deadline = TxRxUDPV2::now() + 100000000ull;
+        while (!resumedAfterRestart && TxRxUDPV2::now() < deadline)
+        {
+            restartedRobot.queueSample(numSamples, values.data(), values.data(), values.data());
+            usleep(1000);
+
+            bool isNew;
+            PacketV2 state = controller.readLatest(isNew);
+            resumedAfterRestart = isNew
+                && static_cast<uint32_t>(state.sample(state.latest())->seqno) == numSamples;
+        }
+    }
+
+    TxRxUDPV2::RxStatistics stateStats = controller.getRxStatistics();
+    TxRxUDPV2::RxStatistics commandStats = robot.getRxStatistics();
+
+    printf("DOFs: %u, samples per packet: %u, packets: %u, period: %u us\n",
+        options.numDOFs, options.samplesPerPacket, options.numPackets, options.periodUs);
+    printf("State packets:   received %llu, lost %llu, reordered %llu, invalid %llu, superseded %llu, restarts %llu\n",
+        (unsigned long long)stateStats.received, (unsigned long long)stateStats.lost,
+        (unsigned long long)stateStats.reordered, (unsigned long long)stateStats.invalid,
+        (unsigned long long)stateStats.superseded, (unsigned long long)stateStats.restarts);
+    printf("Command packets: received %llu, lost %llu, reordered %llu, invalid %llu, superseded %llu, restarts %llu\n",
+        (unsigned long long)commandStats.received, (unsigned long long)commandStats.lost,
+        (unsigned long long)commandStats.reordered, (unsigned long long)commandStats.invalid,
+        (unsigned long long)commandStats.superseded, (unsigned long long)commandStats.restarts);
+    printf("Torn reads: %llu\n", (unsigned long long)tornReads.load());
+    printf("States after a robot restart: %s\n", resumedAfterRestart ? "resumed" : "frozen");
+
+    size_t numLatencies = latencies.size();
+    double median = percentile(latencies, 0.5);
+    double p99 = percentile(latencies, 0.99);
+    double maximum = latencies.empty() ? 0 : *std::max_element(latencies.begin(), latencies.end());
+
+    printf("Sample to echoed command latency over %zu commands: median %.1f us, p99 %.1f us, max %.1f us\n",
+        numLatencies, median, p99, maximum);
+
+    return (tornReads > 0 || !resumedAfterRestart) ? 1 : 0;
+}